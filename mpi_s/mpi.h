@@ -220,11 +220,29 @@ int MPI_Gather(void * sendbuf, int sendcount, MPI_Datatype sendtype,
 int MPI_Gatherv(const void * sendbuf, int sendcount, MPI_Datatype sendtype,
 		void * recvbuf, const int * recvcounts, const int * displ,
 		MPI_Datatype recvtype, int root, MPI_Comm comm);
+int MPI_Scatterv(const void * sendbuf, const int * sendcounts,
+		 const int * displs, MPI_Datatype sendtype, void * recvbuf,
+		 int recvcount, MPI_Datatype recvtype, int root, MPI_Comm comm);
 int MPI_Allgather(void * sendbuf, int sendcount, MPI_Datatype sendtype,
 		  void * recvbuf, int recvcount, MPI_Datatype recvtype,
 		  MPI_Comm comm);
 int MPI_Allreduce(void * send, void * recv, int count, MPI_Datatype type,
 		  MPI_Op op, MPI_Comm comm);
+int MPI_Allgatherv(const void * sendbuf, int sendcount, MPI_Datatype sendtype,
+		   void * recvbuf, const int * recvcounts, const int * displs,
+		   MPI_Datatype recvtype, MPI_Comm comm);
+int MPI_Alltoall(const void * sendbuf, int sendcount, MPI_Datatype sendtype,
+		 void * recvbuf, int recvcount, MPI_Datatype recvtype,
+		 MPI_Comm comm);
+int MPI_Alltoallv(const void * sendbuf, const int * sendcounts,
+		  const int * sdispls, MPI_Datatype sendtype, void * recvbuf,
+		  const int * recvcounts, const int * rdispls,
+		  MPI_Datatype recvtype, MPI_Comm comm);
+int MPI_Reduce_scatter(const void * sendbuf, void * recvbuf,
+		       const int * recvcounts, MPI_Datatype type, MPI_Op op,
+		       MPI_Comm comm);
+int MPI_Exscan(const void * sendbuf, void * recvbuf, int count,
+	       MPI_Datatype type, MPI_Op op, MPI_Comm comm);
 
 int MPI_Comm_split(MPI_Comm comm, int colour, int key, MPI_Comm * newcomm);
 int MPI_Comm_split_type(MPI_Comm comm, int split_type, int key,
@@ -281,6 +299,7 @@ int MPI_File_open(MPI_Comm comm, const char * filename, int amode,
 		  MPI_Info info, MPI_File * fh);
 int MPI_File_close(MPI_File * fh);
 int MPI_File_delete(const char * filename, MPI_Info info);
+int MPI_File_get_size(MPI_File fh, MPI_Offset * size);
 int MPI_Type_create_subarray(int ndims, const int * array_of_sizes,
 			     const int * array_of_subsizes,
 			     const int * array_of_starts,
@@ -299,6 +318,16 @@ int MPI_File_write_all(MPI_File fh, const void * buf, int count,
 int MPI_File_write_all_begin(MPI_File fh, const void * buf, int count,
 			     MPI_Datatype datatype);
 int MPI_File_write_all_end(MPI_File fh, const void * buf, MPI_Status * status);
+int MPI_File_read_at(MPI_File fh, MPI_Offset offset, void * buf, int count,
+		     MPI_Datatype datatype, MPI_Status * status);
+int MPI_File_write_at(MPI_File fh, MPI_Offset offset, const void * buf,
+		      int count, MPI_Datatype datatype, MPI_Status * status);
+int MPI_File_read_at_all(MPI_File fh, MPI_Offset offset, void * buf,
+			 int count, MPI_Datatype datatype,
+			 MPI_Status * status);
+int MPI_File_write_at_all(MPI_File fh, MPI_Offset offset, const void * buf,
+			  int count, MPI_Datatype datatype,
+			  MPI_Status * status);
 
 #ifdef __cplusplus
 }
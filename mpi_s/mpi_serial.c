@@ -620,6 +620,32 @@ int MPI_Gatherv(const void * sendbuf, int sendcount, MPI_Datatype sendtype,
   return MPI_SUCCESS;
 }
 
+/*****************************************************************************
+ *
+ *  MPI_Scatterv
+ *
+ *  Again, the assertions should be true in serial.
+ *
+ *****************************************************************************/
+
+int MPI_Scatterv(const void * sendbuf, const int * sendcounts,
+		 const int * displs, MPI_Datatype sendtype, void * recvbuf,
+		 int recvcount, MPI_Datatype recvtype, int root, MPI_Comm comm) {
+
+  assert(sendbuf);
+  assert(recvbuf);
+  assert(root == 0);
+  assert(sendtype == recvtype);
+  assert(sendcounts[0] == recvcount);
+
+  {
+    char * src = (char *) sendbuf + displs[0]*mpi_sizeof(sendtype);
+    mpi_copy(src, recvbuf, recvcount, recvtype);
+  }
+
+  return MPI_SUCCESS;
+}
+
 /*****************************************************************************
  *
  *  MPI_Allreduce
@@ -641,6 +667,121 @@ int MPI_Allreduce(void * sendbuf, void * recvbuf, int count, MPI_Datatype type,
   return MPI_SUCCESS;
 }
 
+/*****************************************************************************
+ *
+ *  MPI_Allgatherv
+ *
+ *****************************************************************************/
+
+int MPI_Allgatherv(const void * sendbuf, int sendcount, MPI_Datatype sendtype,
+		   void * recvbuf, const int * recvcounts, const int * displs,
+		   MPI_Datatype recvtype, MPI_Comm comm) {
+
+  assert(sendbuf);
+  assert(recvbuf);
+  assert(sendtype == recvtype);
+  assert(sendcount == recvcounts[0]);
+  assert(mpi_is_valid_comm(comm));
+
+  if (sendbuf != MPI_IN_PLACE) {
+    char * dst = (char *) recvbuf + displs[0]*mpi_sizeof(recvtype);
+    mpi_copy((void *) sendbuf, dst, sendcount, sendtype);
+  }
+
+  return MPI_SUCCESS;
+}
+
+/*****************************************************************************
+ *
+ *  MPI_Alltoall
+ *
+ *****************************************************************************/
+
+int MPI_Alltoall(const void * sendbuf, int sendcount, MPI_Datatype sendtype,
+		 void * recvbuf, int recvcount, MPI_Datatype recvtype,
+		 MPI_Comm comm) {
+
+  assert(sendbuf);
+  assert(recvbuf);
+  assert(sendtype == recvtype);
+  assert(sendcount == recvcount);
+  assert(mpi_is_valid_comm(comm));
+
+  mpi_copy((void *) sendbuf, recvbuf, sendcount, sendtype);
+
+  return MPI_SUCCESS;
+}
+
+/*****************************************************************************
+ *
+ *  MPI_Alltoallv
+ *
+ *****************************************************************************/
+
+int MPI_Alltoallv(const void * sendbuf, const int * sendcounts,
+		  const int * sdispls, MPI_Datatype sendtype, void * recvbuf,
+		  const int * recvcounts, const int * rdispls,
+		  MPI_Datatype recvtype, MPI_Comm comm) {
+
+  assert(sendbuf);
+  assert(recvbuf);
+  assert(sendtype == recvtype);
+  assert(sendcounts[0] == recvcounts[0]);
+  assert(mpi_is_valid_comm(comm));
+
+  {
+    char * src = (char *) sendbuf + sdispls[0]*mpi_sizeof(sendtype);
+    char * dst = (char *) recvbuf + rdispls[0]*mpi_sizeof(recvtype);
+    mpi_copy(src, dst, sendcounts[0], sendtype);
+  }
+
+  return MPI_SUCCESS;
+}
+
+/*****************************************************************************
+ *
+ *  MPI_Reduce_scatter
+ *
+ *****************************************************************************/
+
+int MPI_Reduce_scatter(const void * sendbuf, void * recvbuf,
+		       const int * recvcounts, MPI_Datatype type, MPI_Op op,
+		       MPI_Comm comm) {
+
+  assert(sendbuf);
+  assert(recvbuf);
+  assert(recvcounts[0] >= 0);
+  assert(op != MPI_OP_NULL);
+  assert(mpi_is_valid_comm(comm));
+
+  if (sendbuf != MPI_IN_PLACE) {
+    mpi_copy((void *) sendbuf, recvbuf, recvcounts[0], type);
+  }
+
+  return MPI_SUCCESS;
+}
+
+/*****************************************************************************
+ *
+ *  MPI_Exscan
+ *
+ *  The receive buffer at rank 0 is undefined by the standard, so it
+ *  is left untouched here.
+ *
+ *****************************************************************************/
+
+int MPI_Exscan(const void * sendbuf, void * recvbuf, int count,
+	       MPI_Datatype type, MPI_Op op, MPI_Comm comm) {
+
+  assert(sendbuf);
+  assert(recvbuf);
+  assert(count >= 0);
+  assert(op != MPI_OP_NULL);
+  assert(mpi_is_valid_comm(comm));
+
+  return MPI_SUCCESS;
+}
+
 /*****************************************************************************
  *
  *  MPI_Comm_split
@@ -1449,6 +1590,34 @@ int MPI_File_delete(const char * filename, MPI_Info info) {
   return MPI_SUCCESS;
 }
 
+/*****************************************************************************
+ *
+ *  MPI_File_get_size
+ *
+ *****************************************************************************/
+
+int MPI_File_get_size(MPI_File fh, MPI_Offset * size) {
+
+  FILE * fp = NULL;
+
+  assert(size);
+
+  fp = mpi_file_handle_to_fp(mpi_info, fh);
+
+  if (fp == NULL) {
+    printf("MPI_File_get_size: invalid file handle\n");
+    return MPI_ERR_FILE;
+  }
+  else {
+    long pos = ftell(fp);
+    fseek(fp, 0, SEEK_END);
+    *size = ftell(fp);
+    fseek(fp, pos, SEEK_SET);
+  }
+
+  return MPI_SUCCESS;
+}
+
 /*****************************************************************************
  *
  *  MPI_Type_create_subarray
@@ -1550,6 +1719,8 @@ int MPI_File_set_view(MPI_File fh, MPI_Offset disp, MPI_Datatype etype,
     /* Could demand "native" ... */
     strncpy(file->datarep, datarep, MPI_MAX_DATAREP_STRING-1);
     /* info is currently discarded */
+    /* The individual file pointer is reset to the start of the view */
+    fseek(fp, disp, SEEK_SET);
   }
 
   return MPI_SUCCESS;
@@ -1668,6 +1839,103 @@ int MPI_File_write_all_end(MPI_File fh, const void * buf, MPI_Status * status) {
   return 0;
 }
 
+/*****************************************************************************
+ *
+ *  MPI_File_read_at
+ *
+ *  The offset is in units of the etype of the current view (relative
+ *  to the displacement). Only contiguous file types are respected.
+ *
+ *****************************************************************************/
+
+int MPI_File_read_at(MPI_File fh, MPI_Offset offset, void * buf, int count,
+		     MPI_Datatype datatype, MPI_Status * status) {
+
+  FILE * fp = NULL;
+
+  assert(buf);
+
+  fp = mpi_file_handle_to_fp(mpi_info, fh);
+
+  if (fp == NULL) {
+    printf("MPI_File_read_at: invalid_file handle\n");
+    exit(0);
+  }
+  else {
+    file_t * file = &mpi_info->filelist[fh];
+    long pos = file->disp + offset*mpi_sizeof(file->etype);
+
+    if (fseek(fp, pos, SEEK_SET) != 0) {
+      perror("perror: ");
+      printf("MPI_File_read_at() fseek failed\n");
+      exit(0);
+    }
+  }
+
+  return MPI_File_read_all(fh, buf, count, datatype, status);
+}
+
+/*****************************************************************************
+ *
+ *  MPI_File_write_at
+ *
+ *****************************************************************************/
+
+int MPI_File_write_at(MPI_File fh, MPI_Offset offset, const void * buf,
+		      int count, MPI_Datatype datatype, MPI_Status * status) {
+
+  FILE * fp = NULL;
+
+  assert(buf);
+
+  fp = mpi_file_handle_to_fp(mpi_info, fh);
+
+  if (fp == NULL) {
+    printf("MPI_File_write_at: invalid_file handle\n");
+    exit(0);
+  }
+  else {
+    file_t * file = &mpi_info->filelist[fh];
+    long pos = file->disp + offset*mpi_sizeof(file->etype);
+
+    if (fseek(fp, pos, SEEK_SET) != 0) {
+      perror("perror: ");
+      printf("MPI_File_write_at() fseek failed\n");
+      exit(0);
+    }
+  }
+
+  return MPI_File_write_all(fh, buf, count, datatype, status);
+}
+
+/*****************************************************************************
+ *
+ *  MPI_File_read_at_all
+ *
+ *  Collective version is the same as MPI_File_read_at() in serial.
+ *
+ *****************************************************************************/
+
+int MPI_File_read_at_all(MPI_File fh, MPI_Offset offset, void * buf,
+			 int count, MPI_Datatype datatype,
+			 MPI_Status * status) {
+
+  return MPI_File_read_at(fh, offset, buf, count, datatype, status);
+}
+
+/*****************************************************************************
+ *
+ *  MPI_File_write_at_all
+ *
+ *****************************************************************************/
+
+int MPI_File_write_at_all(MPI_File fh, MPI_Offset offset, const void * buf,
+			  int count, MPI_Datatype datatype,
+			  MPI_Status * status) {
+
+  return MPI_File_write_at(fh, offset, buf, count, datatype, status);
+}
+
 #endif /* _DO_NOT_INCLUDE_MPI2_INTERFACE */
 
 /*****************************************************************************
@@ -1797,8 +2065,11 @@ static MPI_File mpi_file_handle_retain(mpi_info_t * mpi, FILE * fp) {
     exit(0);
   }
 
-  /* Record the pointer against the handle */
+  /* Record the pointer against the handle; the view is the default */
   mpi->filelist[fh].fp = fp;
+  mpi->filelist[fh].disp = 0;
+  mpi->filelist[fh].etype = MPI_BYTE;
+  mpi->filelist[fh].filetype = MPI_BYTE;
 
   return fh;
 }
@@ -30,9 +30,18 @@ static int test_mpi_type_create_struct(void);
 static int test_mpi_op_create(void);
 static int test_mpi_file_open(void);
 static int test_mpi_file_get_view(void);
+static int test_mpi_file_get_size(void);
 static int test_mpi_file_set_view(void);
 static int test_mpi_type_create_subarray(void);
 static int test_mpi_file_write_all(void);
+static int test_mpi_file_write_at(void);
+static int test_mpi_scatterv(void);
+static int test_mpi_allgatherv(void);
+static int test_mpi_alltoallv(void);
+static int test_mpi_reduce_scatter(void);
+static int test_mpi_alltoall(void);
+static int test_mpi_exscan(void);
+static int test_mpi_file_write_at_all(void);
 
 /* Utilities */
 
@@ -128,9 +137,18 @@ int main (int argc, char ** argv) {
 
   test_mpi_file_open();
   test_mpi_file_get_view();
+  test_mpi_file_get_size();
   test_mpi_file_set_view();
   test_mpi_type_create_subarray();
   test_mpi_file_write_all();
+  test_mpi_file_write_at();
+  test_mpi_scatterv();
+  test_mpi_allgatherv();
+  test_mpi_alltoallv();
+  test_mpi_reduce_scatter();
+  test_mpi_alltoall();
+  test_mpi_exscan();
+  test_mpi_file_write_at_all();
 
   ireturn = MPI_Finalize();
   assert(ireturn == MPI_SUCCESS);
@@ -512,6 +530,34 @@ static int test_mpi_file_get_view(void) {
   return 0;
 }
 
+/*****************************************************************************
+ *
+ *  test_mpi_file_get_size
+ *
+ *****************************************************************************/
+
+static int test_mpi_file_get_size(void) {
+
+  MPI_File fh = MPI_FILE_NULL;
+  MPI_Comm comm = MPI_COMM_WORLD;
+  MPI_Info info = MPI_INFO_NULL;
+  int wbuf[3] = {1, 2, 3};
+
+  MPI_File_open(comm, "mpif.dat", MPI_MODE_WRONLY+MPI_MODE_CREATE, info, &fh);
+  MPI_File_write_all(fh, wbuf, 3, MPI_INT, MPI_STATUS_IGNORE);
+
+  {
+    MPI_Offset size = 0;
+    MPI_File_get_size(fh, &size);
+    assert(size == 3*sizeof(int));
+  }
+
+  MPI_File_close(&fh);
+  unlink("mpif.dat");
+
+  return 0;
+}
+
 /*****************************************************************************
  *
  *  test_mpi_file_set_view
@@ -704,3 +750,218 @@ int test_mpi_comm_split_type(void) {
   return 0;
 }
 
+
+/*****************************************************************************
+ *
+ *  test_mpi_file_write_at
+ *
+ *  Write two blocks out of order at explicit offsets; read back
+ *  with MPI_File_read_at().
+ *
+ *****************************************************************************/
+
+int test_mpi_file_write_at(void) {
+
+  int ifail = 0;
+
+  const char * filename = "mpi-file-write-at.dat";
+  MPI_Comm comm = MPI_COMM_WORLD;
+  MPI_Info info = MPI_INFO_NULL;
+
+  int wbuf[8] = {0, 1, 2, 3, 4, 5, 6, 7};
+
+  {
+    MPI_File fh = MPI_FILE_NULL;
+    MPI_File_open(comm, filename, MPI_MODE_WRONLY+MPI_MODE_CREATE, info, &fh);
+    MPI_File_write_at(fh, 4*sizeof(int), wbuf + 4, 4, MPI_INT,
+		      MPI_STATUS_IGNORE);
+    MPI_File_write_at(fh, 0, wbuf, 4, MPI_INT, MPI_STATUS_IGNORE);
+    MPI_File_close(&fh);
+  }
+
+  {
+    MPI_File fh = MPI_FILE_NULL;
+    int rbuf[8] = {0};
+
+    MPI_File_open(comm, filename, MPI_MODE_RDONLY, info, &fh);
+    MPI_File_read_at(fh, 2*sizeof(int), rbuf + 2, 6, MPI_INT,
+		     MPI_STATUS_IGNORE);
+    MPI_File_read_at(fh, 0, rbuf, 2, MPI_INT, MPI_STATUS_IGNORE);
+    MPI_File_close(&fh);
+
+    for (int i = 0; i < 8; i++) {
+      assert(rbuf[i] == wbuf[i]);
+      if (rbuf[i] != wbuf[i]) ifail += 1;
+    }
+  }
+
+  unlink(filename);
+
+  return ifail;
+}
+
+/*****************************************************************************
+ *
+ *  test_mpi_scatterv
+ *
+ *****************************************************************************/
+
+int test_mpi_scatterv(void) {
+
+  int sendbuf[4] = {1, 2, 3, 4};
+  int recvbuf[2] = {0};
+  int counts[1] = {2};
+  int displs[1] = {1};
+
+  MPI_Scatterv(sendbuf, counts, displs, MPI_INT, recvbuf, 2, MPI_INT, 0,
+	       MPI_COMM_WORLD);
+  assert(recvbuf[0] == 2);
+  assert(recvbuf[1] == 3);
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  test_mpi_allgatherv
+ *
+ *****************************************************************************/
+
+int test_mpi_allgatherv(void) {
+
+  int sendbuf[2] = {1, 2};
+  int recvbuf[3] = {0};
+  int counts[1] = {2};
+  int displs[1] = {1};
+
+  MPI_Allgatherv(sendbuf, 2, MPI_INT, recvbuf, counts, displs, MPI_INT,
+		 MPI_COMM_WORLD);
+  assert(recvbuf[0] == 0);
+  assert(recvbuf[1] == 1);
+  assert(recvbuf[2] == 2);
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  test_mpi_alltoallv
+ *
+ *****************************************************************************/
+
+int test_mpi_alltoallv(void) {
+
+  double sendbuf[3] = {1.0, 2.0, 3.0};
+  double recvbuf[3] = {0};
+  int counts[1] = {2};
+  int sdispls[1] = {1};
+  int rdispls[1] = {0};
+
+  MPI_Alltoallv(sendbuf, counts, sdispls, MPI_DOUBLE, recvbuf, counts,
+		rdispls, MPI_DOUBLE, MPI_COMM_WORLD);
+  assert(util_double_same(recvbuf[0], 2.0));
+  assert(util_double_same(recvbuf[1], 3.0));
+  assert(util_double_same(recvbuf[2], 0.0));
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  test_mpi_reduce_scatter
+ *
+ *****************************************************************************/
+
+int test_mpi_reduce_scatter(void) {
+
+  double sendbuf[2] = {1.0, 2.0};
+  double recvbuf[2] = {0};
+  int counts[1] = {2};
+
+  MPI_Reduce_scatter(sendbuf, recvbuf, counts, MPI_DOUBLE, MPI_SUM,
+		     MPI_COMM_WORLD);
+  assert(util_double_same(recvbuf[0], 1.0));
+  assert(util_double_same(recvbuf[1], 2.0));
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  test_mpi_alltoall
+ *
+ *****************************************************************************/
+
+int test_mpi_alltoall(void) {
+
+  int sendbuf[2] = {1, 2};
+  int recvbuf[2] = {0};
+
+  MPI_Alltoall(sendbuf, 2, MPI_INT, recvbuf, 2, MPI_INT, MPI_COMM_WORLD);
+  assert(recvbuf[0] == 1);
+  assert(recvbuf[1] == 2);
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  test_mpi_exscan
+ *
+ *  Rank 0 receive buffer is undefined; we expect it to be unchanged.
+ *
+ *****************************************************************************/
+
+int test_mpi_exscan(void) {
+
+  int sendbuf = 3;
+  int recvbuf = -1;
+
+  MPI_Exscan(&sendbuf, &recvbuf, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+  assert(recvbuf == -1);
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  test_mpi_file_write_at_all
+ *
+ *****************************************************************************/
+
+int test_mpi_file_write_at_all(void) {
+
+  int ifail = 0;
+
+  const char * filename = "mpi-file-write-at-all.dat";
+  MPI_Comm comm = MPI_COMM_WORLD;
+  MPI_Info info = MPI_INFO_NULL;
+
+  double wbuf[4] = {1.0, 2.0, 3.0, 4.0};
+  double rbuf[4] = {0};
+
+  {
+    MPI_File fh = MPI_FILE_NULL;
+    MPI_File_open(comm, filename, MPI_MODE_WRONLY+MPI_MODE_CREATE, info, &fh);
+    MPI_File_write_at_all(fh, 2*sizeof(double), wbuf + 2, 2, MPI_DOUBLE,
+			  MPI_STATUS_IGNORE);
+    MPI_File_write_at_all(fh, 0, wbuf, 2, MPI_DOUBLE, MPI_STATUS_IGNORE);
+    MPI_File_close(&fh);
+  }
+
+  {
+    MPI_File fh = MPI_FILE_NULL;
+    MPI_File_open(comm, filename, MPI_MODE_RDONLY, info, &fh);
+    MPI_File_read_at_all(fh, 0, rbuf, 4, MPI_DOUBLE, MPI_STATUS_IGNORE);
+    MPI_File_close(&fh);
+
+    for (int i = 0; i < 4; i++) {
+      assert(util_double_same(rbuf[i], wbuf[i]));
+      if (!util_double_same(rbuf[i], wbuf[i])) ifail += 1;
+    }
+  }
+
+  unlink(filename);
+
+  return ifail;
+}
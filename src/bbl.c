@@ -32,6 +32,7 @@
 #include "bbl.h"
 #include "colloid.h"
 #include "colloids.h"
+#include "colloid_link_table.h"
 
 
 /* Ellipsoid update mechanism flag */
@@ -43,6 +44,44 @@ enum bbl_ellipsoid_update {
   BBL_ELLIPSOID_UPDATE_FD               /* using (I(t) - I(t - dt))/dt  */
 };
 
+/* Per-colloid quantities required by the link kernels, and the
+ * results of the segmented sums over each colloid's links. The
+ * index is that of the owner in the colloid link table. */
+
+typedef struct bbl_owner_s bbl_owner_t;
+
+struct bbl_owner_s {
+  int active;           /* Squirmer? */
+  int shape;            /* COLLOID_SHAPE_SPHERE etc */
+  double deltam;        /* Shape change correction (scaled by 1/sumw) */
+  double m[3];          /* Squirmer direction */
+  double b1;            /* Squirmer B_1 */
+  double b2;            /* Squirmer B_2 */
+  double ela;           /* Ellipsoid principal radius */
+  double elc;           /* Ellipsoid focal distance */
+  double ele;           /* Ellipsoid eccentricity */
+  double cbar[3];       /* Missing link correction (scaled) */
+  double rxcbar[3];     /* Missing link correction (scaled) */
+  double v[3];          /* Updated velocity (pass 2) */
+  double w[3];          /* Updated angular velocity (pass 2) */
+  double dms;           /* Missing link "squeeze" term (pass 2) */
+  double dgtm1;         /* Order parameter deficit previous step (pass 2) */
+  double sump;          /* Squirmer mass correction */
+  double f0[3];         /* Velocity-independent force */
+  double t0[3];         /* Velocity-independent torque */
+  double zeta[21];      /* Drag matrix elements */
+  double deltaphi;      /* Order parameter correction (pass 2) */
+  double stress[3][3];  /* Surface stress contribution (pass 2) */
+  int solve;            /* Velocity update solved on target (spheres) */
+  int iret;             /* Return code from the 6x6 solve */
+  int isfixedv[3];      /* Velocity components fixed? */
+  int isfixedw;         /* Angular velocity fixed? */
+  double mass;          /* Mass (spheres) */
+  double moment;        /* Moment of inertia (spheres) */
+  double dwall[3];      /* Wall lubrication correction (spheres) */
+  double xb[6];         /* Right-hand side on entry; new velocities on exit */
+};
+
 struct bbl_s {
   pe_t * pe;            /* Parallel environment */
   cs_t * cs;            /* Coordinate system */
@@ -52,22 +91,53 @@ struct bbl_s {
   double eta;           /* Dynamic viscosity for lubrication correction */
   double deltag;        /* Excess or deficit of phi between steps */
   double stress[3][3];  /* Surface stress diagnostic */
+
+  int nownermax;        /* Capacity of owner arrays */
+  int nlinkmax;         /* Capacity of link work array */
+  bbl_owner_t * owner;  /* Per-colloid quantities (host) */
+  bbl_owner_t * owner_target; /* Target copy */
+  double * work;        /* Per-link intermediate values (target) */
 };
 
 static int bbl_pass1(bbl_t * bbl, lb_t * lb, colloids_info_t * cinfo);
-static int bbl_pass2(bbl_t * bbl, lb_t * lb, colloids_info_t * cinfo);
+static int bbl_pass2(bbl_t * bbl, lb_t * lb, wall_t * wall,
+		     colloids_info_t * cinfo);
+static int bbl_update_apply(colloid_t * pc, const double xb[6]);
 static int bbl_active_conservation(bbl_t * bbl, lb_t * lb,
 				   colloids_info_t * cinfo);
 static int bbl_wall_lubrication_account(bbl_t * bbl, wall_t * wall,
 					colloids_info_t * cinfo);
 
+static int bbl_reserve(bbl_t * bbl, const colloid_link_table_t * ltable);
+static int bbl_owner_sphere(bbl_owner_t * owner, wall_t * wall,
+			    const colloid_t * pc, double rho0);
+static int bbl_update_sphere_rhs(wall_t * wall, const colloid_t * pc,
+				 double rho0, double * mass, double * moment,
+				 double dwall[3], double xb[6]);
+__host__ __device__ int bbl_update_sphere_solve(double mass, double moment,
+						const double zeta[21],
+						const double dwall[3],
+						double xb[6]);
+
 __global__ void bbl_pass0_kernel(kernel_3d_t k3d, cs_t * cs, lb_t * lb,
 				 colloids_info_t * cinfo);
+__global__ void bbl_pass1_link_kernel(colloid_link_table_t * ltable,
+				      lb_t * lb, const bbl_owner_t * owner,
+				      double * work, double rho0);
+__global__ void bbl_pass1_owner_kernel(colloid_link_table_t * ltable,
+				       bbl_owner_t * owner,
+				       const double * work);
+__global__ void bbl_update_owner_kernel(colloid_link_table_t * ltable,
+					bbl_owner_t * owner, double rho0);
+__global__ void bbl_pass2_link_kernel(colloid_link_table_t * ltable,
+				      lb_t * lb, const bbl_owner_t * owner,
+				      double * work, double rho0);
+__global__ void bbl_pass2_owner_kernel(colloid_link_table_t * ltable,
+				       bbl_owner_t * owner,
+				       const double * work);
 
 static __constant__ lb_collide_param_t lbp;
 
-int bbl_update_colloid_default(bbl_t * bbl, wall_t * wall, colloid_t * pc,
-			       double rho0, double xb[6]);
 int bbl_update_ellipsoid(bbl_t * bbl, wall_t * wall, colloid_t * pc,
 			 double rho0, double xb[6]);
 
@@ -131,6 +201,9 @@ int bbl_free(bbl_t * bbl) {
 
   assert(bbl);
 
+  if (bbl->owner_target != bbl->owner) tdpFree(bbl->owner_target);
+  if (bbl->work) tdpFree(bbl->work);
+  free(bbl->owner);
   free(bbl);
 
   return 0;
@@ -212,6 +285,15 @@ int bbl_active_set(bbl_t * bbl, colloids_info_t * cinfo) {
  *  (3) Do the actual BBL on distributions with the updated colloid
  *      velocity.
  *
+ *  The passes over links operate on the flat link table (built along
+ *  with the links in build_update_links()) and the distributions
+ *  remain on the target throughout. Per-colloid sums are formed
+ *  from the contiguous segment of links belonging to each colloid.
+ *
+ *  Steps (2) and (3) share one round trip of the per-colloid data:
+ *  the 6x6 velocity update for spheres is solved on the target in
+ *  a batch, immediately before the bounce-back.
+ *
  *****************************************************************************/
 
 __host__
@@ -233,10 +315,6 @@ int bounce_back_on_links(bbl_t * bbl, lb_t * lb, wall_t * wall,
   colloid_sums_halo(cinfo, COLLOID_SUM_STRUCTURE);
 
   bbl_pass0(bbl, lb, cinfo);
-
-  /* __NVCC__ TODO: remove */
-  lb_memcpy(lb, tdpMemcpyDeviceToHost);
-
   bbl_pass1(bbl, lb, cinfo);
 
   colloid_sums_halo(cinfo, COLLOID_SUM_DYNAMICS);
@@ -246,12 +324,7 @@ int bounce_back_on_links(bbl_t * bbl, lb_t * lb, wall_t * wall,
     colloid_sums_halo(cinfo, COLLOID_SUM_ACTIVE);
   }
 
-  bbl_update_colloids(bbl, wall, cinfo);
-
-  bbl_pass2(bbl, lb, cinfo);
-
-  /* __NVCC__ TODO: remove */
-  lb_memcpy(lb, tdpMemcpyHostToDevice);
+  bbl_pass2(bbl, lb, wall, cinfo);
 
   return 0;
 }
@@ -264,41 +337,43 @@ int bounce_back_on_links(bbl_t * bbl, lb_t * lb, wall_t * wall,
 
 static int bbl_active_conservation(bbl_t * bbl, lb_t * lb,
 				   colloids_info_t * cinfo) {
-  int ia;
-  double dm;
-  double c[3];
-  double rbxc[3];
-
-  colloid_t * pc;
-  colloid_link_t * p_link;
+  colloid_link_table_t * ltable = NULL;
 
   assert(bbl);
   assert(cinfo);
 
-  colloids_info_all_head(cinfo, &pc);
+  ltable = cinfo->ltable;
 
-  /* For each colloid in the list */
+  /* For each owner in the link table */
 
-  for ( ; pc; pc = pc->nextall) {
+  for (int k = 0; k < ltable->nowner; k++) {
+
+    colloid_t * pc = ltable->pc[k];
 
     if (pc->s.active == 0) continue;
 
     pc->sump /= pc->sumw;
-    p_link = pc->lnk;
 
-    for (; p_link; p_link = p_link->next) {
+    for (int n = ltable->start[k]; n < ltable->start[k+1]; n++) {
 
-      if (p_link->status != LINK_FLUID) continue;
+      int ij = ltable->p[n];
+      double dm = 0.0;
+      double c[3] = {0};
+      double rb[3] = {0};
+      double rbxc[3] = {0};
 
-      dm = -lb->model.wv[p_link->p]*pc->sump;
+      if (ltable->status[n] != LINK_FLUID) continue;
 
-      for (ia = 0; ia < 3; ia++) {
-	c[ia] = 1.0*lb->model.cv[p_link->p][ia];
+      dm = -lb->model.wv[ij]*pc->sump;
+
+      for (int ia = 0; ia < 3; ia++) {
+	c[ia] = 1.0*lb->model.cv[ij][ia];
+	rb[ia] = ltable->rb[addr_rank1(ltable->nlinkmax, 3, n, ia)];
       }
 
-      cross_product(p_link->rb, c, rbxc);
+      cross_product(rb, c, rbxc);
 
-      for (ia = 0; ia < 3; ia++) {
+      for (int ia = 0; ia < 3; ia++) {
 	pc->fc0[ia] += dm*c[ia];
 	pc->tc0[ia] += dm*rbxc[ia];
       }
@@ -418,7 +493,7 @@ __global__ void bbl_pass0_kernel(kernel_3d_t k3d, cs_t * cs, lb_t * lb,
 	}
 
 	lb->f[ LB_ADDR(lb->nsite, lb->ndist, lbp.nvel, index, LB_RHO, p) ]
-	  = lbp.wv[p]*(1.0 + rcs2*udotc + 0.5*rcs2*rcs2*sdotq);
+	  = lbp.wv[p]*(1.0 + rcs2*udotc + 0.5*rcs2*rcs2*sdotq) - lbp.fshift[p];
       }
     }
   }
@@ -426,39 +501,88 @@ __global__ void bbl_pass0_kernel(kernel_3d_t k3d, cs_t * cs, lb_t * lb,
   return;
 }
 
+/*****************************************************************************
+ *
+ *  bbl_reserve
+ *
+ *  Make sure the owner and link work arrays are large enough for the
+ *  current link table.
+ *
+ *****************************************************************************/
+
+static int bbl_reserve(bbl_t * bbl, const colloid_link_table_t * ltable) {
+
+  int ndevice = 0;
+
+  assert(bbl);
+  assert(ltable);
+
+  tdpGetDeviceCount(&ndevice);
+
+  if (bbl->owner == NULL || ltable->nowner > bbl->nownermax) {
+    int nmax = ltable->nownermax;
+    if (bbl->owner_target != bbl->owner) tdpFree(bbl->owner_target);
+    free(bbl->owner);
+    bbl->owner = (bbl_owner_t *) calloc(nmax + 1, sizeof(bbl_owner_t));
+    if (bbl->owner == NULL) pe_fatal(bbl->pe, "calloc(bbl_owner_t) failed\n");
+    bbl->owner_target = bbl->owner;
+    if (ndevice > 0) {
+      tdpAssert(tdpMalloc((void **) &bbl->owner_target,
+			  (nmax + 1)*sizeof(bbl_owner_t)));
+    }
+    bbl->nownermax = nmax;
+  }
+
+  if (bbl->work == NULL || ltable->nlink > bbl->nlinkmax) {
+    int nmax = ltable->nlinkmax;
+    if (bbl->work) tdpFree(bbl->work);
+    tdpAssert(tdpMalloc((void **) &bbl->work, 3*(nmax + 1)*sizeof(double)));
+    bbl->nlinkmax = nmax;
+  }
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  bbl_owner_memcpy
+ *
+ *****************************************************************************/
+
+static int bbl_owner_memcpy(bbl_t * bbl, int nowner, tdpMemcpyKind flag) {
+
+  assert(bbl);
+
+  if (bbl->owner_target != bbl->owner && nowner > 0) {
+    size_t nsz = nowner*sizeof(bbl_owner_t);
+    if (flag == tdpMemcpyHostToDevice) {
+      tdpAssert(tdpMemcpy(bbl->owner_target, bbl->owner, nsz, flag));
+    }
+    else {
+      tdpAssert(tdpMemcpy(bbl->owner, bbl->owner_target, nsz, flag));
+    }
+  }
+
+  return 0;
+}
+
 /*****************************************************************************
  *
  *  bbl_pass1
  *
  *  Work out the velocity independent terms before actual BBL takes place.
  *
+ *  The link kernel computes the momentum transfer for each link (and
+ *  makes the squirmer correction to the fluid distribution); the owner
+ *  kernel then forms the sums for each colloid in link order.
+ *
  *****************************************************************************/
 
 static int bbl_pass1(bbl_t * bbl, lb_t * lb, colloids_info_t * cinfo) {
 
-  int ia;
-  int i, j, ij, ji;
-
-  double dm;
-  double delta;
-  double rsumw;
-  double c[3];
-  double rbxc[3];
   double rho0;
-  double mod, rmod, cost, plegendre, sint;
-  double tans[3], vector1[3];
-  double fdist;
-  LB_RCS2_DOUBLE(rcs2);
-
-  double *elabc;
-  double elc;
-  double ele,ele2;
-  double ela,ela2;
-  double elz,elz2;
-
   physics_t * phys = NULL;
-  colloid_t * pc = NULL;
-  colloid_link_t * p_link = NULL;
+  colloid_link_table_t * ltable = NULL;
 
   assert(bbl);
   assert(lb);
@@ -467,19 +591,18 @@ static int bbl_pass1(bbl_t * bbl, lb_t * lb, colloids_info_t * cinfo) {
   physics_ref(&phys);
   physics_rho0(phys, &rho0);
 
-  /* All colloids, including halo */
+  ltable = cinfo->ltable;
+  bbl_reserve(bbl, ltable);
 
-  colloids_info_all_head(cinfo, &pc);
-
-  for ( ; pc; pc = pc->nextall) {
+  /* All colloids, including halo */
 
-    if (pc->s.bc != COLLOID_BC_BBL) continue;
+  for (int k = 0; k < ltable->nowner; k++) {
 
+    colloid_t * pc = ltable->pc[k];
+    bbl_owner_t * owner = bbl->owner + k;
 
-    elabc = pc->s.elabc;
-    elc = sqrt(elabc[0]*elabc[0] - elabc[1]*elabc[1]);
-    ele = elc/elabc[0];
-    ela = colloid_principal_radius(&pc->s);
+    double rsumw;
+    double * elabc = pc->s.elabc;
 
     /* Diagnostic record of f0 before additions are made. */
     /* Really, f0 should not be used for dual purposes... */
@@ -488,180 +611,317 @@ static int bbl_pass1(bbl_t * bbl, lb_t * lb, colloids_info_t * cinfo) {
     pc->diagnostic.fbuild[Y] = pc->f0[Y];
     pc->diagnostic.fbuild[Z] = pc->f0[Z];
 
-    p_link = pc->lnk;
-
-    for (i = 0; i < 21; i++) {
-      pc->zeta[i] = 0.0;
-    }
-
     /* We need to normalise link quantities by the sum of weights
      * over the particle. Note that sumw cannot be zero here during
      * correct operation (implies the particle has no links). */
 
     rsumw = 1.0 / pc->sumw;
-    for (ia = 0; ia < 3; ia++) {
+    for (int ia = 0; ia < 3; ia++) {
       pc->cbar[ia]   *= rsumw;
       pc->rxcbar[ia] *= rsumw;
     }
     pc->deltam   *= rsumw;
     pc->s.deltaphi *= rsumw;
 
-    /* Sum over the links */
+    owner->active = pc->s.active;
+    owner->shape  = pc->s.shape;
+    owner->deltam = pc->deltam;
+    owner->b1     = pc->s.b1;
+    owner->b2     = pc->s.b2;
+    owner->elc    = sqrt(elabc[0]*elabc[0] - elabc[1]*elabc[1]);
+    owner->ele    = owner->elc/elabc[0];
+    owner->ela    = colloid_principal_radius(&pc->s);
+    owner->sump   = pc->sump;
 
-    for (; p_link; p_link = p_link->next) {
+    for (int ia = 0; ia < 3; ia++) {
+      owner->m[ia]      = pc->s.m[ia];
+      owner->cbar[ia]   = pc->cbar[ia];
+      owner->rxcbar[ia] = pc->rxcbar[ia];
+      owner->f0[ia]     = pc->f0[ia];
+      owner->t0[ia]     = pc->t0[ia];
+    }
+  }
 
-      if (p_link->status == LINK_UNUSED) continue;
+  bbl_owner_memcpy(bbl, ltable->nowner, tdpMemcpyHostToDevice);
 
-      i = p_link->i;              /* index site i (outside) */
-      j = p_link->j;              /* index site j (inside) */
-      ij = p_link->p;             /* link velocity index i->j */
-      ji = lb->model.nvel - ij;   /* link velocity index j->i */
+  if (ltable->nlink > 0) {
+    dim3 nblk = {};
+    dim3 ntpb = {};
 
-      assert(ij > 0 && ij < lb->model.nvel);
+    tdpMemcpyToSymbol(tdpSymbol(lbp), lb->param, sizeof(lb_collide_param_t),
+		      0, tdpMemcpyHostToDevice);
 
-      /* For stationary link, the momentum transfer from the
-       * fluid to the colloid is "dm" */
+    kernel_launch_param(ltable->nlink, &nblk, &ntpb);
+    tdpLaunchKernel(bbl_pass1_link_kernel, nblk, ntpb, 0, 0,
+		    ltable->target, lb->target, bbl->owner_target, bbl->work,
+		    rho0);
+    tdpAssert(tdpPeekAtLastError());
+  }
 
-      if (p_link->status == LINK_FLUID) {
-	/* Bounce back of fluid on outside plus correction
-	 * arising from changes in shape at previous step.
-	 * Note minus sign. */
+  if (ltable->nowner > 0) {
+    dim3 nblk = {};
+    dim3 ntpb = {};
 
-	double dm_a = 0.0;
+    kernel_launch_param(ltable->nowner, &nblk, &ntpb);
+    tdpLaunchKernel(bbl_pass1_owner_kernel, nblk, ntpb, 0, 0,
+		    ltable->target, bbl->owner_target, bbl->work);
+    tdpAssert(tdpPeekAtLastError());
+    tdpAssert(tdpDeviceSynchronize());
+  }
 
-	lb_f(lb, i, ij, 0, &fdist);
-	dm =  2.0*fdist - lb->model.wv[ij]*pc->deltam;
-	delta = 2.0*rcs2*lb->model.wv[ij]*rho0;
+  bbl_owner_memcpy(bbl, ltable->nowner, tdpMemcpyDeviceToHost);
 
+  for (int k = 0; k < ltable->nowner; k++) {
 
-	/* Squirmer section */
+    colloid_t * pc = ltable->pc[k];
+    bbl_owner_t * owner = bbl->owner + k;
 
-	if (pc->s.active && pc->s.shape == COLLOID_SHAPE_SPHERE) {
+    for (int ia = 0; ia < 3; ia++) {
+      pc->f0[ia] = owner->f0[ia];
+      pc->t0[ia] = owner->t0[ia];
+    }
+    for (int i = 0; i < 21; i++) {
+      pc->zeta[i] = owner->zeta[i];
+    }
+    pc->sump = owner->sump;
+  }
 
-	  /* We expect s.m to be a unit vector, but for floating
-	   * point purposes, we must make sure here. */
+  return 0;
+}
 
-	  mod = modulus(p_link->rb)*modulus(pc->s.m);
-	  rmod = 0.0;
-	  if (mod != 0.0) rmod = 1.0/mod;
-	  cost = rmod*dot_product(p_link->rb, pc->s.m);
-	  if (cost*cost > 1.0) cost = 1.0;
-	  assert(cost*cost <= 1.0);
-	  sint = sqrt(1.0 - cost*cost);
+/*****************************************************************************
+ *
+ *  bbl_pass1_link_kernel
+ *
+ *  For each link, compute the momentum transfer dm, the drag matrix
+ *  weight delta, and any squirmer correction dm_a, which are stored
+ *  in work[3*n + 0..2].
+ *
+ *****************************************************************************/
 
-	  cross_product(p_link->rb, pc->s.m, vector1);
-	  cross_product(vector1, p_link->rb, tans);
+__global__ void bbl_pass1_link_kernel(colloid_link_table_t * ltable,
+				      lb_t * lb, const bbl_owner_t * owner,
+				      double * work, double rho0) {
+  int n = 0;
+  LB_RCS2_DOUBLE(rcs2);
 
-	  mod = modulus(tans);
-	  rmod = 0.0;
-	  if (mod != 0.0) rmod = 1.0/mod;
-	  plegendre = -sint*(pc->s.b2*cost + pc->s.b1);
+  assert(ltable);
+  assert(lb);
+  assert(owner);
+  assert(work);
 
-	  /* Compute correction to bbl for a sphere: */
-	  dm_a = 0.0;
-	  for (ia = 0; ia < 3; ia++) {
-	    dm_a += -delta*plegendre*rmod*tans[ia]*lb->model.cv[ij][ia];
-	  }
-	}
+  for_simt_parallel(n, ltable->nlink, 1) {
 
-	/* Ellipsoidal squirmer */
-
-	if (pc->s.active && pc->s.shape == COLLOID_SHAPE_ELLIPSOID) {
-	  double elr, sdotez;
-	  double *elbz;
-	  double denom, term1, term2;
-	  double elrho[3], xi1, xi2, xi;
-	  double diff1, diff2, gridin[3], elzin;
-
-	  /* This is the tangent calculation, which might be replaced
-	   * by the surface_tanget function ... to be confirmed ... */
-	  elbz = pc->s.m;
-	  elz = dot_product(p_link->rb, elbz);
-	  for (ia = 0; ia < 3; ia++) {
-	    elrho[ia] = p_link->rb[ia] - elz*elbz[ia];
-	  }
+    int i  = ltable->i[n];         /* index site i (outside) */
+    int j  = ltable->j[n];         /* index site j (inside) */
+    int ij = ltable->p[n];         /* link velocity index i->j */
+    int ji = lbp.nvel - ij;        /* link velocity index j->i */
 
-	  elr = modulus(elrho);
-	  rmod = 0.0;
-	  if (elr != 0.0) rmod = 1.0/elr;
-	  for (ia = 0; ia < 3; ia++) {
-	    elrho[ia] = elrho[ia]*rmod;
-	  }
-	  ela2 = ela*ela;
-	  elz2 = elz*elz;
-	  ele2 = ele*ele;
-	  diff1 = ela2-elz2;
-	  diff2 = ela2-ele2*elz2;
-
-	  /* Taking care of the unusual circumstances in which the grid
-	   * point lies outside the particle and elz > ela. Then the
-	   * tangent vector is calculated for the neighbouring grid
-	   * point inside*/
-
-	  if (diff1 < 0.0) {
-	    for (ia = 0; ia < 3; ia++) {
-	      gridin[ia] = p_link->rb[ia]+lb->model.cv[ij][ia];
-	      elzin = dot_product(gridin, elbz);
-	      elz2 = elzin*elzin;
-	      diff1 = ela2-elz2;
-	    }
-	    /* diff1 is a more stringent criterion */
-	    if (diff2 < 0.0) diff2 = ela2 - ele2*elz2;
-	  }
-	  denom = sqrt(diff2);
-	  term1 = -sqrt(diff1)/denom;
-	  term2 = sqrt(1.0-ele*ele)*elz/denom;
-	  for (ia = 0; ia < 3; ia++) {
-	    tans[ia] = term1*elbz[ia] + term2*elrho[ia];
-	  }
-	  sdotez = dot_product(tans, elbz);
-	  xi1 = sqrt(elr*elr+(elz+elc)*(elz+elc));
-	  xi2 = sqrt(elr*elr+(elz-elc)*(elz-elc));
-	  xi = (xi1 - xi2)/(2.0*elc);
+    const bbl_owner_t * pc = owner + ltable->owner[n];
+
+    double dm = 0.0;
+    double dm_a = 0.0;
+    double delta = 0.0;
+    double fdist = 0.0;
+    double rb[3] = {0};
+
+    assert(ij > 0 && ij < lbp.nvel);
+
+    for (int ia = 0; ia < 3; ia++) {
+      rb[ia] = ltable->rb[addr_rank1(ltable->nlinkmax, 3, n, ia)];
+    }
+
+    /* For stationary link, the momentum transfer from the
+     * fluid to the colloid is "dm" */
+
+    if (ltable->status[n] == LINK_FLUID) {
+      /* Bounce back of fluid on outside plus correction
+       * arising from changes in shape at previous step.
+       * Note minus sign. */
+
+      double mod, rmod, cost, plegendre, sint;
+      double tans[3], vector1[3];
+
+      lb_f(lb, i, ij, 0, &fdist);
+      dm =  2.0*fdist - lbp.wv[ij]*pc->deltam;
+      delta = 2.0*rcs2*lbp.wv[ij]*rho0;
+
+      /* Squirmer section */
 
-	  plegendre = -(pc->s.b1)*sdotez - (pc->s.b2)*xi*sdotez;
+      if (pc->active && pc->shape == COLLOID_SHAPE_SPHERE) {
+
+	/* We expect s.m to be a unit vector, but for floating
+	 * point purposes, we must make sure here. */
+
+	mod = modulus(rb)*modulus(pc->m);
+	rmod = 0.0;
+	if (mod != 0.0) rmod = 1.0/mod;
+	cost = rmod*dot_product(rb, pc->m);
+	if (cost*cost > 1.0) cost = 1.0;
+	assert(cost*cost <= 1.0);
+	sint = sqrt(1.0 - cost*cost);
+
+	cross_product(rb, pc->m, vector1);
+	cross_product(vector1, rb, tans);
+
+	mod = modulus(tans);
+	rmod = 0.0;
+	if (mod != 0.0) rmod = 1.0/mod;
+	plegendre = -sint*(pc->b2*cost + pc->b1);
+
+	/* Compute correction to bbl for a sphere: */
+	dm_a = 0.0;
+	for (int ia = 0; ia < 3; ia++) {
+	  dm_a += -delta*plegendre*rmod*tans[ia]*lbp.cv[ij][ia];
+	}
+      }
 
-	  mod = modulus(tans);
-	  rmod = 0.0;
-	  if (mod != 0.0) rmod = 1.0/mod;
+      /* Ellipsoidal squirmer */
+
+      if (pc->active && pc->shape == COLLOID_SHAPE_ELLIPSOID) {
+	double elr, sdotez;
+	const double * elbz;
+	double denom, term1, term2;
+	double elrho[3], xi1, xi2, xi;
+	double diff1, diff2, gridin[3], elzin;
+	double elz, elz2, ela2, ele2;
+	double ela = pc->ela;
+	double elc = pc->elc;
+	double ele = pc->ele;
+
+	/* This is the tangent calculation, which might be replaced
+	 * by the surface_tanget function ... to be confirmed ... */
+	elbz = pc->m;
+	elz = dot_product(rb, elbz);
+	for (int ia = 0; ia < 3; ia++) {
+	  elrho[ia] = rb[ia] - elz*elbz[ia];
+	}
 
-	  /* Compute contribution to bbl - dm_a - for an ellipsoid */
-	  dm_a = 0.0;
-	  for (ia = 0; ia < 3; ia++) {
-	    dm_a += -delta*plegendre*rmod*tans[ia]*lb->model.cv[ij][ia];
+	elr = modulus(elrho);
+	rmod = 0.0;
+	if (elr != 0.0) rmod = 1.0/elr;
+	for (int ia = 0; ia < 3; ia++) {
+	  elrho[ia] = elrho[ia]*rmod;
+	}
+	ela2 = ela*ela;
+	elz2 = elz*elz;
+	ele2 = ele*ele;
+	diff1 = ela2-elz2;
+	diff2 = ela2-ele2*elz2;
+
+	/* Taking care of the unusual circumstances in which the grid
+	 * point lies outside the particle and elz > ela. Then the
+	 * tangent vector is calculated for the neighbouring grid
+	 * point inside*/
+
+	if (diff1 < 0.0) {
+	  for (int ia = 0; ia < 3; ia++) {
+	    gridin[ia] = rb[ia]+lbp.cv[ij][ia];
+	    elzin = dot_product(gridin, elbz);
+	    elz2 = elzin*elzin;
+	    diff1 = ela2-elz2;
 	  }
+	  /* diff1 is a more stringent criterion */
+	  if (diff2 < 0.0) diff2 = ela2 - ele2*elz2;
+	}
+	denom = sqrt(diff2);
+	term1 = -sqrt(diff1)/denom;
+	term2 = sqrt(1.0-ele*ele)*elz/denom;
+	for (int ia = 0; ia < 3; ia++) {
+	  tans[ia] = term1*elbz[ia] + term2*elrho[ia];
 	}
+	sdotez = dot_product(tans, elbz);
+	xi1 = sqrt(elr*elr+(elz+elc)*(elz+elc));
+	xi2 = sqrt(elr*elr+(elz-elc)*(elz-elc));
+	xi = (xi1 - xi2)/(2.0*elc);
 
-	lb_f(lb, i, ij, 0, &fdist);
-	fdist += dm_a;
-	lb_f_set(lb, i, ij, 0, fdist);
+	plegendre = -(pc->b1)*sdotez - (pc->b2)*xi*sdotez;
 
-	dm += dm_a;
+	mod = modulus(tans);
+	rmod = 0.0;
+	if (mod != 0.0) rmod = 1.0/mod;
 
-	/* needed for mass conservation   */
-	pc->sump += dm_a;
-      }
-      else {
-	/* Virtual momentum transfer for solid->solid links,
-	 * but no contribution to drag maxtrix */
-
-	lb_f(lb, i, ij, 0, &fdist);
-	dm = fdist;
-	lb_f(lb, j, ji, 0, &fdist);
-	dm += fdist;
-	delta = 0.0;
+	/* Compute contribution to bbl - dm_a - for an ellipsoid */
+	dm_a = 0.0;
+	for (int ia = 0; ia < 3; ia++) {
+	  dm_a += -delta*plegendre*rmod*tans[ia]*lbp.cv[ij][ia];
+	}
       }
 
-      for (ia = 0; ia < 3; ia++) {
-	c[ia] = 1.0*lb->model.cv[ij][ia];
+      lb_f(lb, i, ij, 0, &fdist);
+      fdist += dm_a;
+      lb_f_set(lb, i, ij, 0, fdist);
+
+      dm += dm_a;
+    }
+    else {
+      /* Virtual momentum transfer for solid->solid links,
+       * but no contribution to drag maxtrix */
+
+      lb_f(lb, i, ij, 0, &fdist);
+      dm = fdist;
+      lb_f(lb, j, ji, 0, &fdist);
+      dm += fdist;
+      delta = 0.0;
+    }
+
+    work[3*n + 0] = dm;
+    work[3*n + 1] = delta;
+    work[3*n + 2] = dm_a;
+  }
+
+  return;
+}
+
+/*****************************************************************************
+ *
+ *  bbl_pass1_owner_kernel
+ *
+ *  Sum over the links of each colloid (in order) to obtain the
+ *  velocity-independent force and torque, and the drag matrix.
+ *
+ *****************************************************************************/
+
+__global__ void bbl_pass1_owner_kernel(colloid_link_table_t * ltable,
+				       bbl_owner_t * owner,
+				       const double * work) {
+  int k = 0;
+
+  assert(ltable);
+  assert(owner);
+  assert(work);
+
+  for_simt_parallel(k, ltable->nowner, 1) {
+
+    bbl_owner_t * pc = owner + k;
+
+    for (int i = 0; i < 21; i++) {
+      pc->zeta[i] = 0.0;
+    }
+
+    for (int n = ltable->start[k]; n < ltable->start[k+1]; n++) {
+
+      int ij = ltable->p[n];
+      double dm    = work[3*n + 0];
+      double delta = work[3*n + 1];
+      double c[3];
+      double rb[3];
+      double rbxc[3];
+
+      /* needed for mass conservation   */
+      if (ltable->status[n] == LINK_FLUID) pc->sump += work[3*n + 2];
+
+      for (int ia = 0; ia < 3; ia++) {
+	c[ia] = 1.0*lbp.cv[ij][ia];
+	rb[ia] = ltable->rb[addr_rank1(ltable->nlinkmax, 3, n, ia)];
       }
 
-      cross_product(p_link->rb, c, rbxc);
+      cross_product(rb, c, rbxc);
 
       /* Now add contribution to the sums required for
        * self-consistent evaluation of new velocities. */
 
-      for (ia = 0; ia < 3; ia++) {
+      for (int ia = 0; ia < 3; ia++) {
 	pc->f0[ia] += dm*c[ia];
 	pc->t0[ia] += dm*rbxc[ia];
 	/* Corrections when links are missing (close to contact) */
@@ -697,19 +957,25 @@ static int bbl_pass1(bbl_t * bbl, lb_t * lb, colloids_info_t * cinfo) {
       pc->zeta[19] += delta*rbxc[Y]*rbxc[Z];
 
       pc->zeta[20] += delta*rbxc[Z]*rbxc[Z];
-
     }
   }
 
-  return 0;
+  return;
 }
 
 /*****************************************************************************
  *
  *  bbl_pass2
  *
- *  Implement bounce-back on links having updated the colloid
- *  velocities via the implicit method.
+ *  Update the colloid velocities via the implicit method and then
+ *  implement bounce-back on links with the updated velocities.
+ *
+ *  For spheres, the host forms only the right-hand side (and the
+ *  mass, moment and wall correction); the 6x6 systems are solved
+ *  by the update kernel for all colloids together. Ellipsoids,
+ *  which also require the quaternion update, are solved on the
+ *  host as before. The results are applied to the colloids, as
+ *  per bbl_update_colloids(), after the bounce-back.
  *
  *  The surface stress is also accumulated here (and it really must
  *  done between the colloid velcoity update and the actual bbl).
@@ -717,160 +983,143 @@ static int bbl_pass1(bbl_t * bbl, lb_t * lb, colloids_info_t * cinfo) {
  *
  *****************************************************************************/
 
-static int bbl_pass2(bbl_t * bbl, lb_t * lb, colloids_info_t * cinfo) {
+static int bbl_pass2(bbl_t * bbl, lb_t * lb, wall_t * wall,
+		     colloids_info_t * cinfo) {
 
-  int i, j, ij, ji;
-  int ia;
-  int ndist;
-
-  double dm;
-  double vdotc;
-  double dms;
-  double df, dg;
-  double fdist;
-  double wxrb[3];
-
-  double dgtm1;
   double rho0;
-  LB_RCS2_DOUBLE(rcs2);
+  double rho0_colloid;
 
   physics_t * phys = NULL;
-  colloid_t * pc = NULL;
-  colloid_link_t * p_link;
-
+  colloid_link_table_t * ltable = NULL;
 
   assert(bbl);
   assert(lb);
+  assert(wall);
   assert(cinfo);
 
   physics_ref(&phys);
   physics_rho0(phys, &rho0);
+  colloids_info_rho0(cinfo, &rho0_colloid);
 
-  ndist=lb->ndist;
+  ltable = cinfo->ltable;
 
   /* Account the current phi deficit */
   bbl->deltag = 0.0;
 
   /* Zero the surface stress */
 
-  for (i = 0; i < 3; i++) {
-    for (j = 0; j < 3; j++) {
+  for (int i = 0; i < 3; i++) {
+    for (int j = 0; j < 3; j++) {
       bbl->stress[i][j] = 0.0;
     }
   }
 
   /* All colloids, including halo */
 
-  colloids_info_all_head(cinfo, &pc);
-
-  for ( ; pc; pc = pc->nextall) {
+  for (int k = 0; k < ltable->nowner; k++) {
 
-    if (pc->s.bc != COLLOID_BC_BBL) continue;
+    colloid_t * pc = ltable->pc[k];
+    bbl_owner_t * owner = bbl->owner + k;
 
-    /* Set correction for phi arising from previous step */
+    owner->solve = 0;
+    owner->iret = 0;
 
-    dgtm1 = pc->s.deltaphi;
-    pc->s.deltaphi = 0.0;
-
-    /* Correction to the bounce-back for this particle if it is
-     * without full complement of links */
-
-    dms = 0.0;
-
-    for (ia = 0; ia < 3; ia++) {
-      dms += pc->s.v[ia]*pc->cbar[ia];
-      dms += pc->s.w[ia]*pc->rxcbar[ia];
+    if (pc->s.shape == COLLOID_SHAPE_SPHERE) {
+      bbl_owner_sphere(owner, wall, pc, rho0_colloid);
     }
 
-    dms = 2.0*rcs2*rho0*dms;
-
-    /* Run through the links */
+    if (pc->s.shape == COLLOID_SHAPE_ELLIPSOID) {
+      owner->iret = bbl_update_ellipsoid(bbl, wall, pc, rho0_colloid,
+					 owner->xb);
+    }
 
-    p_link = pc->lnk;
+    /* Set correction for phi arising from previous step */
 
-    for ( ; p_link; p_link = p_link->next) {
+    owner->dgtm1 = pc->s.deltaphi;
+    pc->s.deltaphi = 0.0;
 
-      i = p_link->i;              /* index site i (outside) */
-      j = p_link->j;              /* index site j (inside) */
-      ij = p_link->p;             /* link velocity index i->j */
-      ji = lb->model.nvel - ij;   /* link velocity index j->i */
+    owner->deltam = pc->deltam;
+    owner->sump = pc->sump;
+    owner->isfixedw = pc->s.isfixedw;
 
-      if (p_link->status == LINK_FLUID) {
+    for (int ia = 0; ia < 3; ia++) {
+      owner->isfixedv[ia] = pc->s.isfixedvxyz[ia];
+      owner->v[ia] = pc->s.v[ia];
+      owner->w[ia] = pc->s.w[ia];
+    }
+  }
 
-	lb_f(lb, i, ij, 0, &fdist);
-	dm =  2.0*fdist - lb->model.wv[ij]*pc->deltam;
+  bbl_owner_memcpy(bbl, ltable->nowner, tdpMemcpyHostToDevice);
 
-	/* Compute the self-consistent boundary velocity,
-	 * and add the correction term for changes in shape. */
+  if (ltable->nowner > 0) {
+    dim3 nblk = {};
+    dim3 ntpb = {};
 
-	cross_product(pc->s.w, p_link->rb, wxrb);
+    kernel_launch_param(ltable->nowner, &nblk, &ntpb);
+    tdpLaunchKernel(bbl_update_owner_kernel, nblk, ntpb, 0, 0,
+		    ltable->target, bbl->owner_target, rho0);
+    tdpAssert(tdpPeekAtLastError());
+  }
 
-	vdotc = 0.0;
-	for (ia = 0; ia < 3; ia++) {
-	  vdotc += (pc->s.v[ia] + wxrb[ia])*lb->model.cv[ij][ia];
-	}
-	vdotc = 2.0*rcs2*lb->model.wv[ij]*vdotc;
-	df = rho0*vdotc + lb->model.wv[ij]*pc->deltam;
+  if (ltable->nlink > 0) {
+    dim3 nblk = {};
+    dim3 ntpb = {};
 
-	/* Contribution to mass conservation from squirmer */
+    kernel_launch_param(ltable->nlink, &nblk, &ntpb);
+    tdpLaunchKernel(bbl_pass2_link_kernel, nblk, ntpb, 0, 0,
+		    ltable->target, lb->target, bbl->owner_target, bbl->work,
+		    rho0);
+    tdpAssert(tdpPeekAtLastError());
+  }
 
-	df += lb->model.wv[ij]*pc->sump;
+  if (ltable->nowner > 0) {
+    dim3 nblk = {};
+    dim3 ntpb = {};
 
-	/* Correction owing to missing links "squeeze term" */
+    kernel_launch_param(ltable->nowner, &nblk, &ntpb);
+    tdpLaunchKernel(bbl_pass2_owner_kernel, nblk, ntpb, 0, 0,
+		    ltable->target, bbl->owner_target, bbl->work);
+    tdpAssert(tdpPeekAtLastError());
+    tdpAssert(tdpDeviceSynchronize());
+  }
 
-	df -= lb->model.wv[ij]*dms;
+  bbl_owner_memcpy(bbl, ltable->nowner, tdpMemcpyDeviceToHost);
 
-	/* The outside site actually undergoes BBL. */
+  for (int k = 0; k < ltable->nowner; k++) {
 
-	lb_f(lb, i, ij, LB_RHO, &fdist);
-	fdist = fdist - df;
-	lb_f_set(lb, j, ji, LB_RHO, fdist);
+    colloid_t * pc = ltable->pc[k];
+    bbl_owner_t * owner = bbl->owner + k;
 
-	/* This is slightly clunky. If the order parameter is
-	 * via LB, bounce back with correction. */
+    if (owner->iret != 0) {
+      pe_fatal(bbl->pe, "Gaussian elimination failed in bbl_update\n");
+    }
 
-	if (ndist > 1) {
-	  lb_0th_moment(lb, i, LB_PHI, &dg);
-	  dg *= vdotc;
-	  pc->s.deltaphi += dg;
-	  dg -= lb->model.wv[ij]*dgtm1;
+    bbl_update_apply(pc, owner->xb);
 
-	  lb_f(lb, i, ij, LB_PHI, &fdist);
-	  fdist = fdist - dg;
-	  lb_f_set(lb, j, ji, LB_PHI, fdist);
-	}
+    pc->s.deltaphi = owner->deltaphi;
 
-	/* The stress is r_b f_b */
-	for (ia = 0; ia < 3; ia++) {
-	  bbl->stress[ia][X] += p_link->rb[X]*(dm - df)*lb->model.cv[ij][ia];
-	  bbl->stress[ia][Y] += p_link->rb[Y]*(dm - df)*lb->model.cv[ij][ia];
-	  bbl->stress[ia][Z] += p_link->rb[Z]*(dm - df)*lb->model.cv[ij][ia];
-	}
+    for (int ia = 0; ia < 3; ia++) {
+      for (int ib = 0; ib < 3; ib++) {
+	bbl->stress[ia][ib] += owner->stress[ia][ib];
       }
-      else if (p_link->status == LINK_COLLOID) {
+    }
+  }
 
-	/* The stress should include the solid->solid term */
+  /* As the lubrication force is based on the updated velocity, but
+   * the old position, we can account for the total momentum here. */
 
-	lb_f(lb, i, ij, 0, &fdist);
-	dm = fdist;
-	lb_f(lb, j, ji, 0, &fdist);
-	dm += fdist;
+  bbl_wall_lubrication_account(bbl, wall, cinfo);
 
-	for (ia = 0; ia < 3; ia++) {
-	  bbl->stress[ia][X] += p_link->rb[X]*dm*lb->model.cv[ij][ia];
-	  bbl->stress[ia][Y] += p_link->rb[Y]*dm*lb->model.cv[ij][ia];
-	  bbl->stress[ia][Z] += p_link->rb[Z]*dm*lb->model.cv[ij][ia];
-	}
-      }
-      /* Next link */
-    }
+  for (int k = 0; k < ltable->nowner; k++) {
+
+    colloid_t * pc = ltable->pc[k];
 
     /* Reset factors required for change of shape, etc */
 
     pc->deltam = 0.0;
     pc->sump = 0.0;
 
-    for (ia = 0; ia < 3; ia++) {
+    for (int ia = 0; ia < 3; ia++) {
       pc->f0[ia] = 0.0;
       pc->t0[ia] = 0.0;
       pc->fc0[ia] = 0.0;
@@ -880,10 +1129,245 @@ static int bbl_pass2(bbl_t * bbl, lb_t * lb, colloids_info_t * cinfo) {
     bbl->deltag += pc->s.deltaphi;
   }
 
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  bbl_owner_sphere
+ *
+ *  Owner data for the velocity update of a sphere on the target.
+ *
+ *****************************************************************************/
+
+static int bbl_owner_sphere(bbl_owner_t * owner, wall_t * wall,
+			    const colloid_t * pc, double rho0) {
+  assert(owner);
+  assert(pc);
+
+  owner->solve = 1;
+  bbl_update_sphere_rhs(wall, pc, rho0, &owner->mass, &owner->moment,
+			owner->dwall, owner->xb);
+
+  for (int i = 0; i < 21; i++) {
+    owner->zeta[i] = pc->zeta[i];
+  }
 
   return 0;
 }
 
+/*****************************************************************************
+ *
+ *  bbl_update_owner_kernel
+ *
+ *  Solve the 6x6 velocity update for each sphere (the ellipsoids
+ *  arrive already solved), and set the new velocities and the
+ *  missing link correction required by the bounce-back.
+ *
+ *  The system is that of bbl_update_colloid_default() (see
+ *  bbl_update_sphere_rhs() and bbl_update_sphere_solve()).
+ *
+ *****************************************************************************/
+
+__global__ void bbl_update_owner_kernel(colloid_link_table_t * ltable,
+					bbl_owner_t * owner, double rho0) {
+  int k = 0;
+  LB_RCS2_DOUBLE(rcs2);
+
+  assert(ltable);
+  assert(owner);
+
+  for_simt_parallel(k, ltable->nowner, 1) {
+
+    bbl_owner_t * pc = owner + k;
+    double dms = 0.0;
+
+    if (pc->solve) {
+      pc->iret = bbl_update_sphere_solve(pc->mass, pc->moment, pc->zeta,
+					 pc->dwall, pc->xb);
+    }
+
+    /* New velocities (unless fixed) */
+
+    for (int ia = 0; ia < 3; ia++) {
+      if (pc->isfixedv[ia] == 0) pc->v[ia] = pc->xb[ia];
+      if (pc->isfixedw == 0) pc->w[ia] = pc->xb[3+ia];
+    }
+
+    /* Correction to the bounce-back for this particle if it is
+     * without full complement of links */
+
+    for (int ia = 0; ia < 3; ia++) {
+      dms += pc->v[ia]*pc->cbar[ia];
+      dms += pc->w[ia]*pc->rxcbar[ia];
+    }
+
+    pc->dms = 2.0*rcs2*rho0*dms;
+  }
+
+  return;
+}
+
+/*****************************************************************************
+ *
+ *  bbl_pass2_link_kernel
+ *
+ *  Bounce back for each link. The weight for the surface stress is
+ *  stored in work[3*n + 0] and the order parameter correction (if
+ *  any) in work[3*n + 1].
+ *
+ *****************************************************************************/
+
+__global__ void bbl_pass2_link_kernel(colloid_link_table_t * ltable,
+				      lb_t * lb, const bbl_owner_t * owner,
+				      double * work, double rho0) {
+  int n = 0;
+  LB_RCS2_DOUBLE(rcs2);
+
+  assert(ltable);
+  assert(lb);
+  assert(owner);
+  assert(work);
+
+  for_simt_parallel(n, ltable->nlink, 1) {
+
+    int i  = ltable->i[n];         /* index site i (outside) */
+    int j  = ltable->j[n];         /* index site j (inside) */
+    int ij = ltable->p[n];         /* link velocity index i->j */
+    int ji = lbp.nvel - ij;        /* link velocity index j->i */
+
+    const bbl_owner_t * pc = owner + ltable->owner[n];
+
+    double dm = 0.0;
+    double dg = 0.0;
+    double fdist = 0.0;
+
+    work[3*n + 0] = 0.0;
+    work[3*n + 1] = 0.0;
+
+    if (ltable->status[n] == LINK_FLUID) {
+
+      double vdotc = 0.0;
+      double df;
+      double rb[3];
+      double wxrb[3];
+
+      for (int ia = 0; ia < 3; ia++) {
+	rb[ia] = ltable->rb[addr_rank1(ltable->nlinkmax, 3, n, ia)];
+      }
+
+      lb_f(lb, i, ij, 0, &fdist);
+      dm =  2.0*fdist - lbp.wv[ij]*pc->deltam;
+
+      /* Compute the self-consistent boundary velocity,
+       * and add the correction term for changes in shape. */
+
+      cross_product(pc->w, rb, wxrb);
+
+      for (int ia = 0; ia < 3; ia++) {
+	vdotc += (pc->v[ia] + wxrb[ia])*lbp.cv[ij][ia];
+      }
+      vdotc = 2.0*rcs2*lbp.wv[ij]*vdotc;
+      df = rho0*vdotc + lbp.wv[ij]*pc->deltam;
+
+      /* Contribution to mass conservation from squirmer */
+
+      df += lbp.wv[ij]*pc->sump;
+
+      /* Correction owing to missing links "squeeze term" */
+
+      df -= lbp.wv[ij]*pc->dms;
+
+      /* The outside site actually undergoes BBL. */
+
+      lb_f(lb, i, ij, LB_RHO, &fdist);
+      fdist = fdist - df;
+      lb_f_set(lb, j, ji, LB_RHO, fdist);
+
+      /* This is slightly clunky. If the order parameter is
+       * via LB, bounce back with correction. */
+
+      if (lb->ndist > 1) {
+	lb_0th_moment(lb, i, LB_PHI, &dg);
+	dg *= vdotc;
+	work[3*n + 1] = dg;
+	dg -= lbp.wv[ij]*pc->dgtm1;
+
+	lb_f(lb, i, ij, LB_PHI, &fdist);
+	fdist = fdist - dg;
+	lb_f_set(lb, j, ji, LB_PHI, fdist);
+      }
+
+      work[3*n + 0] = dm - df;
+    }
+    else if (ltable->status[n] == LINK_COLLOID) {
+
+      /* The stress should include the solid->solid term */
+
+      lb_f(lb, i, ij, 0, &fdist);
+      dm = fdist;
+      lb_f(lb, j, ji, 0, &fdist);
+      dm += fdist;
+
+      work[3*n + 0] = dm;
+    }
+  }
+
+  return;
+}
+
+/*****************************************************************************
+ *
+ *  bbl_pass2_owner_kernel
+ *
+ *  Order parameter correction and surface stress for each colloid.
+ *
+ *****************************************************************************/
+
+__global__ void bbl_pass2_owner_kernel(colloid_link_table_t * ltable,
+				       bbl_owner_t * owner,
+				       const double * work) {
+  int k = 0;
+
+  assert(ltable);
+  assert(owner);
+  assert(work);
+
+  for_simt_parallel(k, ltable->nowner, 1) {
+
+    bbl_owner_t * pc = owner + k;
+
+    pc->deltaphi = 0.0;
+    for (int ia = 0; ia < 3; ia++) {
+      for (int ib = 0; ib < 3; ib++) {
+	pc->stress[ia][ib] = 0.0;
+      }
+    }
+
+    for (int n = ltable->start[k]; n < ltable->start[k+1]; n++) {
+
+      int ij = ltable->p[n];
+      int status = ltable->status[n];
+      double dm = work[3*n + 0];
+      const double * rb = ltable->rb;
+      int nmax = ltable->nlinkmax;
+
+      if (status != LINK_FLUID && status != LINK_COLLOID) continue;
+
+      if (status == LINK_FLUID) pc->deltaphi += work[3*n + 1];
+
+      /* The stress is r_b f_b */
+      for (int ia = 0; ia < 3; ia++) {
+	pc->stress[ia][X] += rb[addr_rank1(nmax, 3, n, X)]*dm*lbp.cv[ij][ia];
+	pc->stress[ia][Y] += rb[addr_rank1(nmax, 3, n, Y)]*dm*lbp.cv[ij][ia];
+	pc->stress[ia][Z] += rb[addr_rank1(nmax, 3, n, Z)]*dm*lbp.cv[ij][ia];
+      }
+    }
+  }
+
+  return;
+}
+
 /*****************************************************************************
  *
  *  bbl_update_colloids
@@ -927,33 +1411,133 @@ int bbl_update_colloids(bbl_t * bbl, wall_t * wall, colloids_info_t * cinfo) {
       pe_fatal(bbl->pe, "Gaussian elimination failed in bbl_update\n");
     }
 
-    /* Set the position update, but don't actually move
-     * the particles. This is deferred until the next
-     * call to coll_update() and associated cell list
-     * update.
-     * We use mean of old and new velocity. */
+    bbl_update_apply(pc, xb);
+
+    /* Next colloid */
+  }
+
+  /* As the lubrication force is based on the updated velocity, but
+   * the old position, we can account for the total momentum here. */
+
+  bbl_wall_lubrication_account(bbl, wall, cinfo);
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  bbl_update_colloids_target
+ *
+ *  As bbl_update_colloids() for spheres, but with the velocity update
+ *  solved by bbl_update_owner_kernel() as in the bounce-back. Other
+ *  shapes are not updated, and there is no bounce-back. The link
+ *  table must be current.
+ *
+ *****************************************************************************/
+
+int bbl_update_colloids_target(bbl_t * bbl, wall_t * wall,
+			       colloids_info_t * cinfo) {
+  double rho0;
+  double rho0_colloid;
+  physics_t * phys = NULL;
+  colloid_link_table_t * ltable = NULL;
+
+  assert(bbl);
+  assert(cinfo);
+
+  physics_ref(&phys);
+  physics_rho0(phys, &rho0);
+  colloids_info_rho0(cinfo, &rho0_colloid);
+
+  ltable = cinfo->ltable;
+  bbl_reserve(bbl, ltable);
+
+  for (int k = 0; k < ltable->nowner; k++) {
+
+    colloid_t * pc = ltable->pc[k];
+    bbl_owner_t * owner = bbl->owner + k;
+
+    owner->solve = 0;
+    owner->iret = 0;
+    owner->isfixedw = pc->s.isfixedw;
+
+    if (pc->s.shape == COLLOID_SHAPE_SPHERE) {
+      bbl_owner_sphere(owner, wall, pc, rho0_colloid);
+    }
 
     for (int ia = 0; ia < 3; ia++) {
-      if (pc->s.isfixedrxyz[ia] == 0) pc->s.dr[ia] = 0.5*(pc->s.v[ia] + xb[ia]);
-      if (pc->s.isfixedvxyz[ia] == 0) pc->s.v[ia] = xb[ia];
-      if (pc->s.isfixedw == 0) pc->s.w[ia] = xb[3+ia];
+      owner->isfixedv[ia] = pc->s.isfixedvxyz[ia];
+      owner->v[ia] = pc->s.v[ia];
+      owner->w[ia] = pc->s.w[ia];
+      owner->cbar[ia] = 0.0;
+      owner->rxcbar[ia] = 0.0;
     }
+  }
+
+  bbl_owner_memcpy(bbl, ltable->nowner, tdpMemcpyHostToDevice);
 
-    if (pc->s.isfixeds == 0) {
-      rotate_vector(pc->s.m, xb + 3);
-      rotate_vector(pc->s.s, xb + 3);
+  if (ltable->nowner > 0) {
+    dim3 nblk = {};
+    dim3 ntpb = {};
+
+    kernel_launch_param(ltable->nowner, &nblk, &ntpb);
+    tdpLaunchKernel(bbl_update_owner_kernel, nblk, ntpb, 0, 0,
+		    ltable->target, bbl->owner_target, rho0);
+    tdpAssert(tdpPeekAtLastError());
+    tdpAssert(tdpDeviceSynchronize());
+  }
+
+  bbl_owner_memcpy(bbl, ltable->nowner, tdpMemcpyDeviceToHost);
+
+  for (int k = 0; k < ltable->nowner; k++) {
+
+    colloid_t * pc = ltable->pc[k];
+    bbl_owner_t * owner = bbl->owner + k;
+
+    if (owner->solve == 0) continue;
+
+    if (owner->iret != 0) {
+      pe_fatal(bbl->pe, "Gaussian elimination failed in bbl_update\n");
     }
 
-    /* Record the actual hydrodynamic force on the particle */
-    record_force_torque(pc);
+    bbl_update_apply(pc, owner->xb);
+  }
 
-    /* Next colloid */
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  bbl_update_apply
+ *
+ *  Given the solution xb[6] of the velocity update, set the new
+ *  velocities and the position update.
+ *
+ *****************************************************************************/
+
+static int bbl_update_apply(colloid_t * pc, const double xb[6]) {
+
+  assert(pc);
+
+  /* Set the position update, but don't actually move
+   * the particles. This is deferred until the next
+   * call to coll_update() and associated cell list
+   * update.
+   * We use mean of old and new velocity. */
+
+  for (int ia = 0; ia < 3; ia++) {
+    if (pc->s.isfixedrxyz[ia] == 0) pc->s.dr[ia] = 0.5*(pc->s.v[ia] + xb[ia]);
+    if (pc->s.isfixedvxyz[ia] == 0) pc->s.v[ia] = xb[ia];
+    if (pc->s.isfixedw == 0) pc->s.w[ia] = xb[3+ia];
   }
 
-  /* As the lubrication force is based on the updated velocity, but
-   * the old position, we can account for the total momentum here. */
+  if (pc->s.isfixeds == 0) {
+    rotate_vector(pc->s.m, xb + 3);
+    rotate_vector(pc->s.s, xb + 3);
+  }
 
-  bbl_wall_lubrication_account(bbl, wall, cinfo);
+  /* Record the actual hydrodynamic force on the particle */
+  record_force_torque(pc);
 
   return 0;
 }
@@ -969,54 +1553,101 @@ int bbl_update_colloids(bbl_t * bbl, wall_t * wall, colloids_info_t * cinfo) {
 int bbl_update_colloid_default(bbl_t * bbl, wall_t * wall, colloid_t * pc,
 			       double rho0, double xb[6]) {
 
-  int ia;
-  int iret = 0;
-
-  double mass;    /* Assumes (4/3) rho pi r^3 */
-  double moment;  /* also assumes (2/5) mass r^2 for sphere */
-  double dwall[3];
-  double a[6][6];
-
-  PI_DOUBLE(pi);
+  double mass = 0.0;
+  double moment = 0.0;
+  double dwall[3] = {0};
 
   assert(bbl);
   assert(wall);
   assert(pc);
 
-  /* Set up the matrix problem and solve it here. */
+  bbl_update_sphere_rhs(wall, pc, rho0, &mass, &moment, dwall, xb);
+
+  return bbl_update_sphere_solve(mass, moment, pc->zeta, dwall, xb);
+}
+
+/*****************************************************************************
+ *
+ *  bbl_update_sphere_rhs
+ *
+ *  Mass, moment of inertia, wall lubrication correction and the
+ *  right-hand side xb[6] of the velocity update for a sphere.
+ *
+ *****************************************************************************/
+
+static int bbl_update_sphere_rhs(wall_t * wall, const colloid_t * pc,
+				 double rho0, double * mass, double * moment,
+				 double dwall[3], double xb[6]) {
+  PI_DOUBLE(pi);
+
+  assert(pc);
 
   /* Mass and moment of inertia are those of a hard sphere
    * with the input radius */
 
-  mass = (4.0/3.0)*pi*rho0*pow(pc->s.a0, 3);
-  moment = (2.0/5.0)*mass*pow(pc->s.a0, 2);
+  *mass = (4.0/3.0)*pi*rho0*pow(pc->s.a0, 3);
+  *moment = (2.0/5.0)*(*mass)*pow(pc->s.a0, 2);
 
   /* Wall lubrication correction */
   wall_lubr_sphere(wall, pc->s.ah, pc->s.r, dwall);
 
+  /* Form the right-hand side */
+
+  for (int ia = 0; ia < 3; ia++) {
+    xb[ia] = (*mass)*pc->s.v[ia] + pc->f0[ia] + pc->force[ia];
+    xb[3+ia] = (*moment)*pc->s.w[ia] + pc->t0[ia] + pc->torque[ia];
+  }
+
+  /* Contribution to mass conservation from squirmer */
+
+  for (int ia = 0; ia < 3; ia++) {
+    xb[ia] += pc->fc0[ia];
+    xb[3+ia] += pc->tc0[ia];
+  }
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  bbl_update_sphere_solve
+ *
+ *  Assemble the 6x6 matrix for a sphere from the drag matrix zeta
+ *  (upper triangle), the inertia, and the wall correction, and solve
+ *  with rhs xb[6]. The solution overwrites xb. This is the same on
+ *  host and target.
+ *
+ *****************************************************************************/
+
+__host__ __device__ int bbl_update_sphere_solve(double mass, double moment,
+						const double zeta[21],
+						const double dwall[3],
+						double xb[6]) {
+  double a[6][6];
+
   /* Add inertial terms to diagonal elements */
 
-  a[0][0] = mass +   pc->zeta[0] - dwall[X];
-  a[0][1] =          pc->zeta[1];
-  a[0][2] =          pc->zeta[2];
-  a[0][3] =          pc->zeta[3];
-  a[0][4] =          pc->zeta[4];
-  a[0][5] =          pc->zeta[5];
-  a[1][1] = mass +   pc->zeta[6] - dwall[Y];
-  a[1][2] =          pc->zeta[7];
-  a[1][3] =          pc->zeta[8];
-  a[1][4] =          pc->zeta[9];
-  a[1][5] =          pc->zeta[10];
-  a[2][2] = mass +   pc->zeta[11] - dwall[Z];
-  a[2][3] =          pc->zeta[12];
-  a[2][4] =          pc->zeta[13];
-  a[2][5] =          pc->zeta[14];
-  a[3][3] = moment + pc->zeta[15];
-  a[3][4] =          pc->zeta[16];
-  a[3][5] =          pc->zeta[17];
-  a[4][4] = moment + pc->zeta[18];
-  a[4][5] =          pc->zeta[19];
-  a[5][5] = moment + pc->zeta[20];
+  a[0][0] = mass +   zeta[0] - dwall[X];
+  a[0][1] =          zeta[1];
+  a[0][2] =          zeta[2];
+  a[0][3] =          zeta[3];
+  a[0][4] =          zeta[4];
+  a[0][5] =          zeta[5];
+  a[1][1] = mass +   zeta[6] - dwall[Y];
+  a[1][2] =          zeta[7];
+  a[1][3] =          zeta[8];
+  a[1][4] =          zeta[9];
+  a[1][5] =          zeta[10];
+  a[2][2] = mass +   zeta[11] - dwall[Z];
+  a[2][3] =          zeta[12];
+  a[2][4] =          zeta[13];
+  a[2][5] =          zeta[14];
+  a[3][3] = moment + zeta[15];
+  a[3][4] =          zeta[16];
+  a[3][5] =          zeta[17];
+  a[4][4] = moment + zeta[18];
+  a[4][5] =          zeta[19];
+  a[5][5] = moment + zeta[20];
 
   /* Lower triangle */
 
@@ -1036,23 +1667,7 @@ int bbl_update_colloid_default(bbl_t * bbl, wall_t * wall, colloid_t * pc,
   a[5][3] = a[3][5];
   a[5][4] = a[4][5];
 
-  /* Form the right-hand side */
-
-  for (ia = 0; ia < 3; ia++) {
-    xb[ia] = mass*pc->s.v[ia] + pc->f0[ia] + pc->force[ia];
-    xb[3+ia] = moment*pc->s.w[ia] + pc->t0[ia] + pc->torque[ia];
-  }
-
-  /* Contribution to mass conservation from squirmer */
-
-  for (ia = 0; ia < 3; ia++) {
-    xb[ia] += pc->fc0[ia];
-    xb[3+ia] += pc->tc0[ia];
-  }
-
-  iret = bbl_6x6_gaussian_elimination(a, xb);
-
-  return iret;
+  return bbl_6x6_gaussian_elimination(a, xb);
 }
 
 /*****************************************************************************
@@ -1297,10 +1912,11 @@ void bbl_ladd_ellipsoid(bbl_t * bbl, colloid_t * pc, wall_t * wall,
  *  a[6][6] is destroyed on exit
  *  xb[6] is the rhs on entry and the solution on successful exit.
  *
- *  Returns 0 on success.
+ *  Returns 0 on success. This may be called on host or target.
  *
  *****************************************************************************/
 
+__host__ __device__
 int bbl_6x6_gaussian_elimination(double a[6][6], double xb[6]) {
 
   int ipivot[6];
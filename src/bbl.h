@@ -5,7 +5,7 @@
  *  Edinburgh Soft Matter and Statistical Physics Group and
  *  Edinburgh Parallel Computing Centre
  *
- *  (c) 2010-2023 The University of Edinburgh
+ *  (c) 2010-2024 The University of Edinburgh
  *
  *  Kevin Stratford (kevin@epcc.ed.ac.uk)
  *
@@ -31,6 +31,11 @@ int bbl_pass0(bbl_t * bbl, lb_t * lb, colloids_info_t * cinfo);
 int bbl_active_set(bbl_t * bbl, colloids_info_t * cinfo);
 int bbl_didt_method_set(bbl_t * bbl, int ellipsoid_didt);
 int bbl_update_colloids(bbl_t * bbl, wall_t * wall, colloids_info_t * cinfo);
+int bbl_update_colloids_target(bbl_t * bbl, wall_t * wall,
+			       colloids_info_t * cinfo);
+int bbl_update_colloid_default(bbl_t * bbl, wall_t * wall, colloid_t * pc,
+			       double rho0, double xb[6]);
+__host__ __device__
 int bbl_6x6_gaussian_elimination(double a[6][6], double xb[6]);
 
 int bbl_surface_stress(bbl_t * bbl, double slocal[3][3]);
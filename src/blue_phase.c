@@ -1663,64 +1663,29 @@ __host__ int fe_lc_active_stress(fe_lc_t * fe) {
  *
  *  fe_lc_mol_field_v
  *
+ *  The computation is via the compact Q_ab; h is expanded at the end.
+ *
  *****************************************************************************/
 
 __host__ __device__
 void fe_lc_mol_field_v(fe_lc_t * fe, int index, double h[3][3][NSIMDVL]) {
 
-  int ia, iv;
-
-  double q[3][3][NSIMDVL];
-  double dq[3][3][3][NSIMDVL];
-  double dsq[3][3][NSIMDVL];
-
-  double * __restrict__ data;
-  double * __restrict__ grad;
-  double * __restrict__ delsq;
+  int iv;
+  double h5[NQAB][NSIMDVL];
 
   assert(fe);
- 
-  data = fe->q->data;
-  grad = fe->dq->grad;
-  delsq = fe->dq->delsq;
-
-  /* Expand various tensors */
-
-  for_simd_v(iv, NSIMDVL) q[X][X][iv] = data[addr_rank1(fe->q->nsites,NQAB,index+iv,XX)];
-  for_simd_v(iv, NSIMDVL) q[X][Y][iv] = data[addr_rank1(fe->q->nsites,NQAB,index+iv,XY)];
-  for_simd_v(iv, NSIMDVL) q[X][Z][iv] = data[addr_rank1(fe->q->nsites,NQAB,index+iv,XZ)];
-  for_simd_v(iv, NSIMDVL) q[Y][X][iv] = q[X][Y][iv];
-  for_simd_v(iv, NSIMDVL) q[Y][Y][iv] = data[addr_rank1(fe->q->nsites,NQAB,index+iv,YY)];
-  for_simd_v(iv, NSIMDVL) q[Y][Z][iv] = data[addr_rank1(fe->q->nsites,NQAB,index+iv,YZ)];
-  for_simd_v(iv, NSIMDVL) q[Z][X][iv] = q[X][Z][iv];
-  for_simd_v(iv, NSIMDVL) q[Z][Y][iv] = q[Y][Z][iv];
-  for_simd_v(iv, NSIMDVL) q[Z][Z][iv] = 0.0 - q[X][X][iv] - q[Y][Y][iv];
-
-
-  for (ia = 0; ia < NVECTOR; ia++) {
-    for_simd_v(iv, NSIMDVL) dq[ia][X][X][iv] = grad[addr_rank2(fe->q->nsites,NQAB,NVECTOR,index+iv,XX,ia)];
-    for_simd_v(iv, NSIMDVL) dq[ia][X][Y][iv] = grad[addr_rank2(fe->q->nsites,NQAB,NVECTOR,index+iv,XY,ia)];
-    for_simd_v(iv, NSIMDVL) dq[ia][X][Z][iv] = grad[addr_rank2(fe->q->nsites,NQAB,NVECTOR,index+iv,XZ,ia)];
-    for_simd_v(iv, NSIMDVL) dq[ia][Y][X][iv] = dq[ia][X][Y][iv];
-    for_simd_v(iv, NSIMDVL) dq[ia][Y][Y][iv] = grad[addr_rank2(fe->q->nsites,NQAB,NVECTOR,index+iv,YY,ia)];
-    for_simd_v(iv, NSIMDVL) dq[ia][Y][Z][iv] = grad[addr_rank2(fe->q->nsites,NQAB,NVECTOR,index+iv,YZ,ia)];
-    for_simd_v(iv, NSIMDVL) dq[ia][Z][X][iv] = dq[ia][X][Z][iv];
-    for_simd_v(iv, NSIMDVL) dq[ia][Z][Y][iv] = dq[ia][Y][Z][iv];
-    for_simd_v(iv, NSIMDVL) dq[ia][Z][Z][iv] = 0.0 - dq[ia][X][X][iv] - dq[ia][Y][Y][iv];
-  }
-
-  for_simd_v(iv, NSIMDVL) dsq[X][X][iv] = delsq[addr_rank1(fe->q->nsites,NQAB,index+iv,XX)];
-  for_simd_v(iv, NSIMDVL) dsq[X][Y][iv] = delsq[addr_rank1(fe->q->nsites,NQAB,index+iv,XY)];
-  for_simd_v(iv, NSIMDVL) dsq[X][Z][iv] = delsq[addr_rank1(fe->q->nsites,NQAB,index+iv,XZ)];
-  for_simd_v(iv, NSIMDVL) dsq[Y][X][iv] = dsq[X][Y][iv];
-  for_simd_v(iv, NSIMDVL) dsq[Y][Y][iv] = delsq[addr_rank1(fe->q->nsites,NQAB,index+iv,YY)];
-  for_simd_v(iv, NSIMDVL) dsq[Y][Z][iv] = delsq[addr_rank1(fe->q->nsites,NQAB,index+iv,YZ)];
-  for_simd_v(iv, NSIMDVL) dsq[Z][X][iv] = dsq[X][Z][iv];
-  for_simd_v(iv, NSIMDVL) dsq[Z][Y][iv] = dsq[Y][Z][iv];
-  for_simd_v(iv, NSIMDVL) dsq[Z][Z][iv] = 0.0 - dsq[X][X][iv] - dsq[Y][Y][iv];
 
+  fe_lc_mol_field5_v(fe, index, h5);
 
-  fe_lc_compute_h_v(fe, q, dq, dsq, h);
+  for_simd_v(iv, NSIMDVL) h[X][X][iv] = h5[XX][iv];
+  for_simd_v(iv, NSIMDVL) h[X][Y][iv] = h5[XY][iv];
+  for_simd_v(iv, NSIMDVL) h[X][Z][iv] = h5[XZ][iv];
+  for_simd_v(iv, NSIMDVL) h[Y][X][iv] = h5[XY][iv];
+  for_simd_v(iv, NSIMDVL) h[Y][Y][iv] = h5[YY][iv];
+  for_simd_v(iv, NSIMDVL) h[Y][Z][iv] = h5[YZ][iv];
+  for_simd_v(iv, NSIMDVL) h[Z][X][iv] = h5[XZ][iv];
+  for_simd_v(iv, NSIMDVL) h[Z][Y][iv] = h5[YZ][iv];
+  for_simd_v(iv, NSIMDVL) h[Z][Z][iv] = 0.0 - h5[XX][iv] - h5[YY][iv];
 
   return;
 }
@@ -1731,65 +1696,29 @@ void fe_lc_mol_field_v(fe_lc_t * fe, int index, double h[3][3][NSIMDVL]) {
  *
  *  Vectorised version of fe_lc_stress
  *
+ *  The molecular field and stress are computed from the compact
+ *  (five component) Q_ab and its gradient without expansion.
+ *
  *****************************************************************************/
 
 __host__ __device__
-void fe_lc_stress_v(fe_lc_t * fe, int index, double s[3][3][NSIMDVL]) { 
+void fe_lc_stress_v(fe_lc_t * fe, int index, double s[3][3][NSIMDVL]) {
 
   int iv;
-  int ia;
- 
-  double q[3][3][NSIMDVL];
-  double h[3][3][NSIMDVL];
-  double dq[3][3][3][NSIMDVL];
-  double dsq[3][3][NSIMDVL];
 
-  double * __restrict__ data;
-  double * __restrict__ grad;
-  double * __restrict__ delsq;
+  double q[NQAB][NSIMDVL];
+  double h[NQAB][NSIMDVL];
+  double dq[NVECTOR][NQAB][NSIMDVL];
+  double dsq[NQAB][NSIMDVL];
 
   assert(fe);
 
-  data = fe->q->data;
-  grad = fe->dq->grad;
-  delsq = fe->dq->delsq;
+  fe_lc_q5_v(fe, index, q, dq, dsq);
+  fe_lc_compute_h5_v(fe, q, dq, dsq, h);
 
-  for_simd_v(iv, NSIMDVL) q[X][X][iv] = data[addr_rank1(fe->q->nsites,NQAB,index+iv,XX)];
-  for_simd_v(iv, NSIMDVL) q[X][Y][iv] = data[addr_rank1(fe->q->nsites,NQAB,index+iv,XY)];
-  for_simd_v(iv, NSIMDVL) q[X][Z][iv] = data[addr_rank1(fe->q->nsites,NQAB,index+iv,XZ)];
-  for_simd_v(iv, NSIMDVL) q[Y][X][iv] = q[X][Y][iv];
-  for_simd_v(iv, NSIMDVL) q[Y][Y][iv] = data[addr_rank1(fe->q->nsites,NQAB,index+iv,YY)];
-  for_simd_v(iv, NSIMDVL) q[Y][Z][iv] = data[addr_rank1(fe->q->nsites,NQAB,index+iv,YZ)];
-  for_simd_v(iv, NSIMDVL) q[Z][X][iv] = q[X][Z][iv];
-  for_simd_v(iv, NSIMDVL) q[Z][Y][iv] = q[Y][Z][iv];
-  for_simd_v(iv, NSIMDVL) q[Z][Z][iv] = 0.0 - q[X][X][iv] - q[Y][Y][iv];
-
-  for (ia = 0; ia < NVECTOR; ia++) {
-    for_simd_v(iv, NSIMDVL) dq[ia][X][X][iv] = grad[addr_rank2(fe->q->nsites,NQAB,3,index+iv,XX,ia)];
-    for_simd_v(iv, NSIMDVL) dq[ia][X][Y][iv] = grad[addr_rank2(fe->q->nsites,NQAB,3,index+iv,XY,ia)];
-    for_simd_v(iv, NSIMDVL) dq[ia][X][Z][iv] = grad[addr_rank2(fe->q->nsites,NQAB,3,index+iv,XZ,ia)];
-    for_simd_v(iv, NSIMDVL) dq[ia][Y][X][iv] = dq[ia][X][Y][iv];
-    for_simd_v(iv, NSIMDVL) dq[ia][Y][Y][iv] = grad[addr_rank2(fe->q->nsites,NQAB,3,index+iv,YY,ia)];
-    for_simd_v(iv, NSIMDVL) dq[ia][Y][Z][iv] = grad[addr_rank2(fe->q->nsites,NQAB,3,index+iv,YZ,ia)];
-    for_simd_v(iv, NSIMDVL) dq[ia][Z][X][iv] = dq[ia][X][Z][iv];
-    for_simd_v(iv, NSIMDVL) dq[ia][Z][Y][iv] = dq[ia][Y][Z][iv];
-    for_simd_v(iv, NSIMDVL) dq[ia][Z][Z][iv] = 0.0 - dq[ia][X][X][iv] - dq[ia][Y][Y][iv];
-  }
-
-  for_simd_v(iv, NSIMDVL) dsq[X][X][iv] = delsq[addr_rank1(fe->q->nsites,NQAB,index+iv,XX)];
-  for_simd_v(iv, NSIMDVL) dsq[X][Y][iv] = delsq[addr_rank1(fe->q->nsites,NQAB,index+iv,XY)];
-  for_simd_v(iv, NSIMDVL) dsq[X][Z][iv] = delsq[addr_rank1(fe->q->nsites,NQAB,index+iv,XZ)];
-  for_simd_v(iv, NSIMDVL) dsq[Y][X][iv] = dsq[X][Y][iv];
-  for_simd_v(iv, NSIMDVL) dsq[Y][Y][iv] = delsq[addr_rank1(fe->q->nsites,NQAB,index+iv,YY)];
-  for_simd_v(iv, NSIMDVL) dsq[Y][Z][iv] = delsq[addr_rank1(fe->q->nsites,NQAB,index+iv,YZ)];
-  for_simd_v(iv, NSIMDVL) dsq[Z][X][iv] = dsq[X][Z][iv];
-  for_simd_v(iv, NSIMDVL) dsq[Z][Y][iv] = dsq[Y][Z][iv];
-  for_simd_v(iv, NSIMDVL) dsq[Z][Z][iv] = 0.0 - dsq[X][X][iv] - dsq[Y][Y][iv];
-
-  fe_lc_compute_h_v(fe, q, dq, dsq, h);
 #ifndef AMD_GPU_WORKAROUND
   /* Standard computation. */
-  fe_lc_compute_stress_v(fe, q, dq, h, s);
+  fe_lc_compute_stress5_v(fe, q, dq, h, s);
 #else
   {
     /* This is avoiding what appears to be a spurious memory access
@@ -1803,15 +1732,11 @@ void fe_lc_stress_v(fe_lc_t * fe, int index, double s[3][3][NSIMDVL]) {
     double s1[3][3];
 
     for (iv = 0; iv < NSIMDVL; iv++) {
-      for (ia = 0; ia < 3; ia++) {
-	for (ib = 0; ib < 3; ib++) {
-	  q1[ia][ib] = q[ia][ib][iv];
-	  dq1[0][ia][ib] = dq[0][ia][ib][iv];
-	  dq1[1][ia][ib] = dq[1][ia][ib][iv];
-	  dq1[2][ia][ib] = dq[2][ia][ib][iv];
-	  h1[ia][ib] = h[ia][ib][iv];
-	}
-      }
+      fe_lc_q5_tensor(q, iv, q1);
+      fe_lc_q5_tensor(dq[X], iv, dq1[X]);
+      fe_lc_q5_tensor(dq[Y], iv, dq1[Y]);
+      fe_lc_q5_tensor(dq[Z], iv, dq1[Z]);
+      fe_lc_q5_tensor(h, iv, h1);
       fe_lc_compute_stress(fe, q1, dq1, h1, s1);
       for (ia = 0; ia < 3; ia++) {
 	for (ib = 0; ib < 3; ib++) {
@@ -1823,17 +1748,13 @@ void fe_lc_stress_v(fe_lc_t * fe, int index, double s[3][3][NSIMDVL]) {
 #endif
 
   if (fe->param->is_active) {
-    int ib;
+    int ia, ib;
     double dp[3][3];
     double sa[3][3];
     double q1[3][3];
     for (iv = 0; iv < NSIMDVL; iv++) {
       field_grad_vector_grad(fe->dp, index + iv, dp);
-      for (ia = 0; ia < 3; ia++) {
-	for (ib = 0; ib < 3; ib++) {
-	  q1[ia][ib] = q[ia][ib][iv];
-	}
-      }
+      fe_lc_q5_tensor(q, iv, q1);
       fe_lc_compute_stress_active(fe, q1, dp, sa);
       for (ia = 0; ia < 3; ia++) {
 	for (ib = 0; ib < 3; ib++) {
@@ -2774,3 +2695,681 @@ void fe_lc_compute_stress_v(fe_lc_t * fe,
   return;
 }
 
+
+/*****************************************************************************
+ *
+ *  fe_lc_q5_v
+ *
+ *  Load the compact (symmetric, traceless) Q_ab, its gradient, and
+ *  its Laplacian as stored: five components each, in the order
+ *  XX, XY, XZ, YY, YZ, and dq[ia][n] is d_ia Q_n.
+ *
+ *****************************************************************************/
+
+__host__ __device__
+void fe_lc_q5_v(fe_lc_t * fe, int index,
+		double q[NQAB][NSIMDVL],
+		double dq[NVECTOR][NQAB][NSIMDVL],
+		double dsq[NQAB][NSIMDVL]) {
+  int iv;
+  int nsites;
+
+  double * __restrict__ data;
+  double * __restrict__ grad;
+  double * __restrict__ delsq;
+
+  assert(fe);
+
+  nsites = fe->q->nsites;
+  data = fe->q->data;
+  grad = fe->dq->grad;
+  delsq = fe->dq->delsq;
+
+  for (int n = 0; n < NQAB; n++) {
+    for_simd_v(iv, NSIMDVL) {
+      q[n][iv] = data[addr_rank1(nsites, NQAB, index + iv, n)];
+    }
+    for_simd_v(iv, NSIMDVL) {
+      dq[X][n][iv] = grad[addr_rank2(nsites, NQAB, NVECTOR, index + iv, n, X)];
+    }
+    for_simd_v(iv, NSIMDVL) {
+      dq[Y][n][iv] = grad[addr_rank2(nsites, NQAB, NVECTOR, index + iv, n, Y)];
+    }
+    for_simd_v(iv, NSIMDVL) {
+      dq[Z][n][iv] = grad[addr_rank2(nsites, NQAB, NVECTOR, index + iv, n, Z)];
+    }
+    for_simd_v(iv, NSIMDVL) {
+      dsq[n][iv] = delsq[addr_rank1(nsites, NQAB, index + iv, n)];
+    }
+  }
+
+  return;
+}
+
+/*****************************************************************************
+ *
+ *  fe_lc_q5_tensor
+ *
+ *  Expand lane iv of a compact symmetric, traceless, tensor.
+ *
+ *****************************************************************************/
+
+__host__ __device__
+void fe_lc_q5_tensor(double a5[NQAB][NSIMDVL], int iv, double a[3][3]) {
+
+  a[X][X] = a5[XX][iv];
+  a[X][Y] = a5[XY][iv];
+  a[X][Z] = a5[XZ][iv];
+  a[Y][X] = a5[XY][iv];
+  a[Y][Y] = a5[YY][iv];
+  a[Y][Z] = a5[YZ][iv];
+  a[Z][X] = a5[XZ][iv];
+  a[Z][Y] = a5[YZ][iv];
+  a[Z][Z] = 0.0 - a5[XX][iv] - a5[YY][iv];
+
+  return;
+}
+
+/*****************************************************************************
+ *
+ *  fe_lc_mol_field5_v
+ *
+ *  The five independent components of the molecular field at
+ *  index + iv computed directly from the compact Q_ab.
+ *
+ *****************************************************************************/
+
+__host__ __device__
+void fe_lc_mol_field5_v(fe_lc_t * fe, int index, double h[NQAB][NSIMDVL]) {
+
+  double q[NQAB][NSIMDVL];
+  double dq[NVECTOR][NQAB][NSIMDVL];
+  double dsq[NQAB][NSIMDVL];
+
+  assert(fe);
+
+  fe_lc_q5_v(fe, index, q, dq, dsq);
+  fe_lc_compute_h5_v(fe, q, dq, dsq, h);
+
+  return;
+}
+
+/*****************************************************************************
+ *
+ *  fe_lc_compute_fed5_v
+ *
+ *  As fe_lc_compute_fed_v(), but from the compact Q_ab and gradient.
+ *  Only the Q_zz components are reconstructed (from the trace).
+ *
+ *****************************************************************************/
+
+__host__ __device__
+void fe_lc_compute_fed5_v(fe_lc_t * fe,
+			  double q[NQAB][NSIMDVL],
+			  double dq[NVECTOR][NQAB][NSIMDVL],
+			  double fed[NSIMDVL]) {
+  int iv;
+  double q0;
+  double kappa0;
+  double kappa1;
+  double ea[3];
+  const double r3 = 1.0/3.0;
+
+  assert(fe);
+
+  /* Redshifted values */
+  q0 = fe->param->rredshift*fe->param->q0;
+  kappa0 = fe->param->redshift*fe->param->redshift*fe->param->kappa0;
+  kappa1 = kappa0;
+
+  for (int ia = 0; ia < 3; ia++) {
+    ea[ia] = fe->param->e0[ia]*fe->param->coswt;
+  }
+
+  for_simd_v(iv, NSIMDVL) {
+
+    double qzz = 0.0 - q[XX][iv] - q[YY][iv];
+    double dqzz[3];
+    double qq[NQAB];
+    double q2, q3, dq0, dq1, efield, sum;
+
+    dqzz[X] = 0.0 - dq[X][XX][iv] - dq[X][YY][iv];
+    dqzz[Y] = 0.0 - dq[Y][XX][iv] - dq[Y][YY][iv];
+    dqzz[Z] = 0.0 - dq[Z][XX][iv] - dq[Z][YY][iv];
+
+    /* Q_ab^2 */
+
+    q2 = q[XX][iv]*q[XX][iv] + q[YY][iv]*q[YY][iv] + qzz*qzz
+      + 2.0*(q[XY][iv]*q[XY][iv] + q[XZ][iv]*q[XZ][iv]
+	     + q[YZ][iv]*q[YZ][iv]);
+
+    /* Q_ab Q_bc Q_ca via (QQ)_ab Q_ab */
+
+    qq[XX] = q[XX][iv]*q[XX][iv] + q[XY][iv]*q[XY][iv]
+      + q[XZ][iv]*q[XZ][iv];
+    qq[XY] = q[XX][iv]*q[XY][iv] + q[XY][iv]*q[YY][iv]
+      + q[XZ][iv]*q[YZ][iv];
+    qq[XZ] = q[XX][iv]*q[XZ][iv] + q[XY][iv]*q[YZ][iv] + q[XZ][iv]*qzz;
+    qq[YY] = q[XY][iv]*q[XY][iv] + q[YY][iv]*q[YY][iv]
+      + q[YZ][iv]*q[YZ][iv];
+    qq[YZ] = q[XY][iv]*q[XZ][iv] + q[YY][iv]*q[YZ][iv] + q[YZ][iv]*qzz;
+
+    q3 = qq[XX]*q[XX][iv] + qq[YY]*q[YY][iv]
+      + (0.0 - qq[XX] - qq[YY] + q2)*qzz
+      + 2.0*(qq[XY]*q[XY][iv] + qq[XZ]*q[XZ][iv] + qq[YZ]*q[YZ][iv]);
+
+    /* (d_b Q_ab)^2 */
+
+    sum = dq[X][XX][iv] + dq[Y][XY][iv] + dq[Z][XZ][iv];
+    dq0 = sum*sum;
+    sum = dq[X][XY][iv] + dq[Y][YY][iv] + dq[Z][YZ][iv];
+    dq0 += sum*sum;
+    sum = dq[X][XZ][iv] + dq[Y][YZ][iv] + dqzz[Z];
+    dq0 += sum*sum;
+
+    /* (e_acd d_c Q_db + 2q_0 Q_ab)^2 */
+
+    sum = dq[Y][XZ][iv] - dq[Z][XY][iv] + 2.0*q0*q[XX][iv];
+    dq1 = sum*sum;
+    sum = dq[Y][YZ][iv] - dq[Z][YY][iv] + 2.0*q0*q[XY][iv];
+    dq1 += sum*sum;
+    sum = dqzz[Y] - dq[Z][YZ][iv] + 2.0*q0*q[XZ][iv];
+    dq1 += sum*sum;
+    sum = dq[Z][XX][iv] - dq[X][XZ][iv] + 2.0*q0*q[XY][iv];
+    dq1 += sum*sum;
+    sum = dq[Z][XY][iv] - dq[X][YZ][iv] + 2.0*q0*q[YY][iv];
+    dq1 += sum*sum;
+    sum = dq[Z][XZ][iv] - dqzz[X] + 2.0*q0*q[YZ][iv];
+    dq1 += sum*sum;
+    sum = dq[X][XY][iv] - dq[Y][XX][iv] + 2.0*q0*q[XZ][iv];
+    dq1 += sum*sum;
+    sum = dq[X][YY][iv] - dq[Y][XY][iv] + 2.0*q0*q[YZ][iv];
+    dq1 += sum*sum;
+    sum = dq[X][YZ][iv] - dq[Y][XZ][iv] + 2.0*q0*qzz;
+    dq1 += sum*sum;
+
+    /* Electric field term (epsilon_ includes the factor 1/12pi) */
+
+    efield = ea[X]*q[XX][iv]*ea[X] + ea[Y]*q[YY][iv]*ea[Y]
+      + ea[Z]*qzz*ea[Z]
+      + 2.0*(ea[X]*q[XY][iv]*ea[Y] + ea[X]*q[XZ][iv]*ea[Z]
+	     + ea[Y]*q[YZ][iv]*ea[Z]);
+
+    fed[iv] = 0.5*fe->param->a0*(1.0 - r3*fe->param->gamma)*q2
+      - r3*fe->param->a0*fe->param->gamma*q3
+      + 0.25*fe->param->a0*fe->param->gamma*q2*q2
+      + 0.5*kappa0*dq0 + 0.5*kappa1*dq1
+      - fe->param->epsilon*efield;
+  }
+
+  return;
+}
+
+/*****************************************************************************
+ *
+ *  fe_lc_compute_h5_v
+ *
+ *  As fe_lc_compute_h_v(), but from the compact Q_ab, gradient, and
+ *  Laplacian; the result is the compact molecular field (which is
+ *  symmetric and traceless).
+ *
+ *  The term in e_abc d_a Q_bc on the diagonal of fe_lc_compute_h_v()
+ *  vanishes identically for symmetric Q_bc and is omitted.
+ *
+ *****************************************************************************/
+
+__host__ __device__
+void fe_lc_compute_h5_v(fe_lc_t * fe,
+			double q[NQAB][NSIMDVL],
+			double dq[NVECTOR][NQAB][NSIMDVL],
+			double dsq[NQAB][NSIMDVL],
+			double h[NQAB][NSIMDVL]) {
+  int iv;
+  double q0;
+  double gamma;
+  double kappa0;
+  double kappa1;
+  double a0;
+  double ea[3];
+  double e2;
+
+  const double r3 = (1.0/3.0);
+
+  /* Redshifted values */
+  q0 = fe->param->rredshift*fe->param->q0;
+  kappa0 = fe->param->redshift*fe->param->redshift*fe->param->kappa0;
+  kappa1 = kappa0;
+
+  gamma = fe->param->gamma;
+  a0 = fe->param->a0;
+
+  e2 = 0.0;
+  for (int ia = 0; ia < 3; ia++) {
+    ea[ia] = fe->param->e0[ia]*fe->param->coswt;
+    e2 += ea[ia]*ea[ia];
+  }
+
+  for_simd_v(iv, NSIMDVL) {
+
+    double qzz = 0.0 - q[XX][iv] - q[YY][iv];
+    double dqzz[3];
+    double q2;
+    double sum;
+
+    dqzz[X] = 0.0 - dq[X][XX][iv] - dq[X][YY][iv];
+    dqzz[Y] = 0.0 - dq[Y][XX][iv] - dq[Y][YY][iv];
+
+    q2 = q[XX][iv]*q[XX][iv] + q[YY][iv]*q[YY][iv] + qzz*qzz
+      + 2.0*(q[XY][iv]*q[XY][iv] + q[XZ][iv]*q[XZ][iv]
+	     + q[YZ][iv]*q[YZ][iv]);
+
+    /* Bulk terms, with sum = (QQ)_ab */
+
+    sum = q[XX][iv]*q[XX][iv] + q[XY][iv]*q[XY][iv] + q[XZ][iv]*q[XZ][iv];
+    h[XX][iv] = - a0*(1.0 - r3*gamma)*q[XX][iv]
+      + a0*gamma*(sum - r3*q2) - a0*gamma*q2*q[XX][iv];
+
+    sum = q[XX][iv]*q[XY][iv] + q[XY][iv]*q[YY][iv] + q[XZ][iv]*q[YZ][iv];
+    h[XY][iv] = - a0*(1.0 - r3*gamma)*q[XY][iv]
+      + a0*gamma*sum - a0*gamma*q2*q[XY][iv];
+
+    sum = q[XX][iv]*q[XZ][iv] + q[XY][iv]*q[YZ][iv] + q[XZ][iv]*qzz;
+    h[XZ][iv] = - a0*(1.0 - r3*gamma)*q[XZ][iv]
+      + a0*gamma*sum - a0*gamma*q2*q[XZ][iv];
+
+    sum = q[XY][iv]*q[XY][iv] + q[YY][iv]*q[YY][iv] + q[YZ][iv]*q[YZ][iv];
+    h[YY][iv] = - a0*(1.0 - r3*gamma)*q[YY][iv]
+      + a0*gamma*(sum - r3*q2) - a0*gamma*q2*q[YY][iv];
+
+    sum = q[XY][iv]*q[XZ][iv] + q[YY][iv]*q[YZ][iv] + q[YZ][iv]*qzz;
+    h[YZ][iv] = - a0*(1.0 - r3*gamma)*q[YZ][iv]
+      + a0*gamma*sum - a0*gamma*q2*q[YZ][iv];
+
+    /* Gradient terms, with sum = e_acd d_c Q_db + e_bcd d_c Q_da */
+
+    sum = 2.0*(dq[Y][XZ][iv] - dq[Z][XY][iv]);
+    h[XX][iv] += kappa0*dsq[XX][iv] - 2.0*kappa1*q0*sum
+      - 4.0*kappa1*q0*q0*q[XX][iv];
+
+    sum = dq[Y][YZ][iv] - dq[X][XZ][iv] + dq[Z][XX][iv] - dq[Z][YY][iv];
+    h[XY][iv] += kappa0*dsq[XY][iv] - 2.0*kappa1*q0*sum
+      - 4.0*kappa1*q0*q0*q[XY][iv];
+
+    sum = dq[X][XY][iv] - dq[Y][XX][iv] + dqzz[Y] - dq[Z][YZ][iv];
+    h[XZ][iv] += kappa0*dsq[XZ][iv] - 2.0*kappa1*q0*sum
+      - 4.0*kappa1*q0*q0*q[XZ][iv];
+
+    sum = 2.0*(dq[Z][XY][iv] - dq[X][YZ][iv]);
+    h[YY][iv] += kappa0*dsq[YY][iv] - 2.0*kappa1*q0*sum
+      - 4.0*kappa1*q0*q0*q[YY][iv];
+
+    sum = dq[X][YY][iv] - dqzz[X] - dq[Y][XY][iv] + dq[Z][XZ][iv];
+    h[YZ][iv] += kappa0*dsq[YZ][iv] - 2.0*kappa1*q0*sum
+      - 4.0*kappa1*q0*q0*q[YZ][iv];
+
+    /* Electric field term */
+
+    h[XX][iv] += fe->param->epsilon*(ea[X]*ea[X] - r3*e2);
+    h[XY][iv] += fe->param->epsilon*(ea[X]*ea[Y]);
+    h[XZ][iv] += fe->param->epsilon*(ea[X]*ea[Z]);
+    h[YY][iv] += fe->param->epsilon*(ea[Y]*ea[Y] - r3*e2);
+    h[YZ][iv] += fe->param->epsilon*(ea[Y]*ea[Z]);
+  }
+
+  return;
+}
+
+/*****************************************************************************
+ *
+ *  fe_lc_compute_stress5_v
+ *
+ *  As fe_lc_compute_stress_v(), but from the compact Q_ab, gradient,
+ *  and molecular field. The stress itself is not symmetric, so all
+ *  nine components are returned.
+ *
+ *  The contractions (hQ)_ab and d_b Q_ab are formed once per site.
+ *  The remainder is generated following fe_lc_compute_stress().
+ *
+ *****************************************************************************/
+
+__host__ __device__
+void fe_lc_compute_stress5_v(fe_lc_t * fe,
+			     double q[NQAB][NSIMDVL],
+			     double dq[NVECTOR][NQAB][NSIMDVL],
+			     double h[NQAB][NSIMDVL],
+			     double s[3][3][NSIMDVL]) {
+  int iv;
+
+  double kappa0;
+  double kappa1;
+  double q0;
+  double xi;
+  double p0[NSIMDVL];
+
+  const double r3 = (1.0/3.0);
+
+  /* Redshifted values */
+
+  q0 = fe->param->q0*fe->param->rredshift;
+  kappa0 = fe->param->kappa0*fe->param->redshift*fe->param->redshift;
+  kappa1 = fe->param->kappa1*fe->param->redshift*fe->param->redshift;
+
+  xi = fe->param->xi;
+
+  /* We have ignored the rho T term at the moment, assumed to be zero
+     (in particular, it has no divergence if rho = const). */
+
+  fe_lc_compute_fed5_v(fe, q, dq, p0);
+
+  for_simd_v(iv, NSIMDVL) p0[iv] = 0.0 - p0[iv];
+
+  for_simd_v(iv, NSIMDVL) {
+
+    double qzz = 0.0 - q[XX][iv] - q[YY][iv];
+    double hzz = 0.0 - h[XX][iv] - h[YY][iv];
+    double dqzz[3];
+    double divq[3];
+    double hq[3][3];
+    double qh;
+    double sth;
+
+    dqzz[X] = 0.0 - dq[X][XX][iv] - dq[X][YY][iv];
+    dqzz[Y] = 0.0 - dq[Y][XX][iv] - dq[Y][YY][iv];
+    dqzz[Z] = 0.0 - dq[Z][XX][iv] - dq[Z][YY][iv];
+
+    /* The contraction Q_ab H_ab */
+
+    qh = q[XX][iv]*h[XX][iv] + q[YY][iv]*h[YY][iv] + qzz*hzz
+      + 2.0*(q[XY][iv]*h[XY][iv] + q[XZ][iv]*h[XZ][iv]
+	     + q[YZ][iv]*h[YZ][iv]);
+
+    /* d_b Q_ab */
+
+    divq[X] = dq[X][XX][iv] + dq[Y][XY][iv] + dq[Z][XZ][iv];
+    divq[Y] = dq[X][XY][iv] + dq[Y][YY][iv] + dq[Z][YZ][iv];
+    divq[Z] = dq[X][XZ][iv] + dq[Y][YZ][iv] + dqzz[Z];
+
+    /* (hQ)_ab = H_ac Q_cb */
+
+    hq[X][X] = h[XX][iv]*q[XX][iv] + h[XY][iv]*q[XY][iv] + h[XZ][iv]*q[XZ][iv];
+    hq[X][Y] = h[XX][iv]*q[XY][iv] + h[XY][iv]*q[YY][iv] + h[XZ][iv]*q[YZ][iv];
+    hq[X][Z] = h[XX][iv]*q[XZ][iv] + h[XY][iv]*q[YZ][iv] + h[XZ][iv]*qzz;
+    hq[Y][X] = h[XY][iv]*q[XX][iv] + h[YY][iv]*q[XY][iv] + h[YZ][iv]*q[XZ][iv];
+    hq[Y][Y] = h[XY][iv]*q[XY][iv] + h[YY][iv]*q[YY][iv] + h[YZ][iv]*q[YZ][iv];
+    hq[Y][Z] = h[XY][iv]*q[XZ][iv] + h[YY][iv]*q[YZ][iv] + h[YZ][iv]*qzz;
+    hq[Z][X] = h[XZ][iv]*q[XX][iv] + h[YZ][iv]*q[XY][iv] + hzz*q[XZ][iv];
+    hq[Z][Y] = h[XZ][iv]*q[XY][iv] + h[YZ][iv]*q[YY][iv] + hzz*q[YZ][iv];
+    hq[Z][Z] = h[XZ][iv]*q[XZ][iv] + h[YZ][iv]*q[YZ][iv] + hzz*qzz;
+
+    /* The stress: the sign at the end is the minus sign */
+
+    /* XX */
+    sth = 2.0*xi*(q[XX][iv] + r3)*qh - p0[iv]
+      - 2.0*xi*hq[X][X] - 2.0*r3*xi*h[XX][iv]
+      - kappa0*(dq[X][XX][iv]*divq[X]
+	       + dq[X][XY][iv]*divq[Y]
+	       + dq[X][XZ][iv]*divq[Z])
+      - kappa1*(dq[X][XX][iv]*dq[X][XX][iv]
+	       + dq[X][YY][iv]*dq[X][YY][iv]
+	       + dqzz[X]*dqzz[X]
+	       + 2.0*(dq[X][XY][iv]*dq[X][XY][iv]
+		     + dq[X][XZ][iv]*dq[X][XZ][iv]
+		     + dq[X][YZ][iv]*dq[X][YZ][iv]))
+      + kappa1*(dq[X][XX][iv]*dq[X][XX][iv]
+	       + dq[X][XY][iv]*dq[X][XY][iv]
+	       + dq[X][XZ][iv]*dq[X][XZ][iv]
+	       + dq[X][XY][iv]*dq[Y][XX][iv]
+	       + dq[X][YY][iv]*dq[Y][XY][iv]
+	       + dq[X][YZ][iv]*dq[Y][XZ][iv]
+	       + dq[X][XZ][iv]*dq[Z][XX][iv]
+	       + dq[X][YZ][iv]*dq[Z][XY][iv]
+	       + dqzz[X]*dq[Z][XZ][iv])
+      - 2.0*kappa1*q0*(dq[X][XY][iv]*q[XZ][iv]
+		      + dq[X][YY][iv]*q[YZ][iv]
+		      + dq[X][YZ][iv]*qzz
+		      - dq[X][XZ][iv]*q[XY][iv]
+		      - dq[X][YZ][iv]*q[YY][iv]
+		      - dqzz[X]*q[YZ][iv]);
+    s[X][X][iv] = -sth;
+
+    /* XY */
+    sth = 2.0*xi*(q[XY][iv])*qh
+      - xi*(hq[X][Y] + hq[Y][X]) - 2.0*r3*xi*h[XY][iv]
+      + hq[Y][X] - hq[X][Y]
+      - kappa0*(dq[X][XY][iv]*divq[X]
+	       + dq[X][YY][iv]*divq[Y]
+	       + dq[X][YZ][iv]*divq[Z])
+      - kappa1*(dq[X][XX][iv]*dq[Y][XX][iv]
+	       + dq[X][YY][iv]*dq[Y][YY][iv]
+	       + dqzz[X]*dqzz[Y]
+	       + 2.0*(dq[X][XY][iv]*dq[Y][XY][iv]
+		     + dq[X][XZ][iv]*dq[Y][XZ][iv]
+		     + dq[X][YZ][iv]*dq[Y][YZ][iv]))
+      + kappa1*(dq[X][XX][iv]*dq[X][XY][iv]
+	       + dq[X][XY][iv]*dq[X][YY][iv]
+	       + dq[X][XZ][iv]*dq[X][YZ][iv]
+	       + dq[X][XY][iv]*dq[Y][XY][iv]
+	       + dq[X][YY][iv]*dq[Y][YY][iv]
+	       + dq[X][YZ][iv]*dq[Y][YZ][iv]
+	       + dq[X][XZ][iv]*dq[Z][XY][iv]
+	       + dq[X][YZ][iv]*dq[Z][YY][iv]
+	       + dqzz[X]*dq[Z][YZ][iv])
+      - 2.0*kappa1*q0*(- dq[X][XX][iv]*q[XZ][iv]
+		      - dq[X][XY][iv]*q[YZ][iv]
+		      - dq[X][XZ][iv]*qzz
+		      + dq[X][XZ][iv]*q[XX][iv]
+		      + dq[X][YZ][iv]*q[XY][iv]
+		      + dqzz[X]*q[XZ][iv]);
+    s[X][Y][iv] = -sth;
+
+    /* XZ */
+    sth = 2.0*xi*(q[XZ][iv])*qh
+      - xi*(hq[X][Z] + hq[Z][X]) - 2.0*r3*xi*h[XZ][iv]
+      + hq[Z][X] - hq[X][Z]
+      - kappa0*(dq[X][XZ][iv]*divq[X]
+	       + dq[X][YZ][iv]*divq[Y]
+	       + dqzz[X]*divq[Z])
+      - kappa1*(dq[X][XX][iv]*dq[Z][XX][iv]
+	       + dq[X][YY][iv]*dq[Z][YY][iv]
+	       + dqzz[X]*dqzz[Z]
+	       + 2.0*(dq[X][XY][iv]*dq[Z][XY][iv]
+		     + dq[X][XZ][iv]*dq[Z][XZ][iv]
+		     + dq[X][YZ][iv]*dq[Z][YZ][iv]))
+      + kappa1*(dq[X][XX][iv]*dq[X][XZ][iv]
+	       + dq[X][XY][iv]*dq[X][YZ][iv]
+	       + dq[X][XZ][iv]*dqzz[X]
+	       + dq[X][XY][iv]*dq[Y][XZ][iv]
+	       + dq[X][YY][iv]*dq[Y][YZ][iv]
+	       + dq[X][YZ][iv]*dqzz[Y]
+	       + dq[X][XZ][iv]*dq[Z][XZ][iv]
+	       + dq[X][YZ][iv]*dq[Z][YZ][iv]
+	       + dqzz[X]*dqzz[Z])
+      - 2.0*kappa1*q0*(dq[X][XX][iv]*q[XY][iv]
+		      + dq[X][XY][iv]*q[YY][iv]
+		      + dq[X][XZ][iv]*q[YZ][iv]
+		      - dq[X][XY][iv]*q[XX][iv]
+		      - dq[X][YY][iv]*q[XY][iv]
+		      - dq[X][YZ][iv]*q[XZ][iv]);
+    s[X][Z][iv] = -sth;
+
+    /* YX */
+    sth = 2.0*xi*(q[XY][iv])*qh
+      - xi*(hq[Y][X] + hq[X][Y]) - 2.0*r3*xi*h[XY][iv]
+      + hq[X][Y] - hq[Y][X]
+      - kappa0*(dq[Y][XX][iv]*divq[X]
+	       + dq[Y][XY][iv]*divq[Y]
+	       + dq[Y][XZ][iv]*divq[Z])
+      - kappa1*(dq[Y][XX][iv]*dq[X][XX][iv]
+	       + dq[Y][YY][iv]*dq[X][YY][iv]
+	       + dqzz[Y]*dqzz[X]
+	       + 2.0*(dq[Y][XY][iv]*dq[X][XY][iv]
+		     + dq[Y][XZ][iv]*dq[X][XZ][iv]
+		     + dq[Y][YZ][iv]*dq[X][YZ][iv]))
+      + kappa1*(dq[Y][XX][iv]*dq[X][XX][iv]
+	       + dq[Y][XY][iv]*dq[X][XY][iv]
+	       + dq[Y][XZ][iv]*dq[X][XZ][iv]
+	       + dq[Y][XY][iv]*dq[Y][XX][iv]
+	       + dq[Y][YY][iv]*dq[Y][XY][iv]
+	       + dq[Y][YZ][iv]*dq[Y][XZ][iv]
+	       + dq[Y][XZ][iv]*dq[Z][XX][iv]
+	       + dq[Y][YZ][iv]*dq[Z][XY][iv]
+	       + dqzz[Y]*dq[Z][XZ][iv])
+      - 2.0*kappa1*q0*(dq[Y][XY][iv]*q[XZ][iv]
+		      + dq[Y][YY][iv]*q[YZ][iv]
+		      + dq[Y][YZ][iv]*qzz
+		      - dq[Y][XZ][iv]*q[XY][iv]
+		      - dq[Y][YZ][iv]*q[YY][iv]
+		      - dqzz[Y]*q[YZ][iv]);
+    s[Y][X][iv] = -sth;
+
+    /* YY */
+    sth = 2.0*xi*(q[YY][iv] + r3)*qh - p0[iv]
+      - 2.0*xi*hq[Y][Y] - 2.0*r3*xi*h[YY][iv]
+      - kappa0*(dq[Y][XY][iv]*divq[X]
+	       + dq[Y][YY][iv]*divq[Y]
+	       + dq[Y][YZ][iv]*divq[Z])
+      - kappa1*(dq[Y][XX][iv]*dq[Y][XX][iv]
+	       + dq[Y][YY][iv]*dq[Y][YY][iv]
+	       + dqzz[Y]*dqzz[Y]
+	       + 2.0*(dq[Y][XY][iv]*dq[Y][XY][iv]
+		     + dq[Y][XZ][iv]*dq[Y][XZ][iv]
+		     + dq[Y][YZ][iv]*dq[Y][YZ][iv]))
+      + kappa1*(dq[Y][XX][iv]*dq[X][XY][iv]
+	       + dq[Y][XY][iv]*dq[X][YY][iv]
+	       + dq[Y][XZ][iv]*dq[X][YZ][iv]
+	       + dq[Y][XY][iv]*dq[Y][XY][iv]
+	       + dq[Y][YY][iv]*dq[Y][YY][iv]
+	       + dq[Y][YZ][iv]*dq[Y][YZ][iv]
+	       + dq[Y][XZ][iv]*dq[Z][XY][iv]
+	       + dq[Y][YZ][iv]*dq[Z][YY][iv]
+	       + dqzz[Y]*dq[Z][YZ][iv])
+      - 2.0*kappa1*q0*(- dq[Y][XX][iv]*q[XZ][iv]
+		      - dq[Y][XY][iv]*q[YZ][iv]
+		      - dq[Y][XZ][iv]*qzz
+		      + dq[Y][XZ][iv]*q[XX][iv]
+		      + dq[Y][YZ][iv]*q[XY][iv]
+		      + dqzz[Y]*q[XZ][iv]);
+    s[Y][Y][iv] = -sth;
+
+    /* YZ */
+    sth = 2.0*xi*(q[YZ][iv])*qh
+      - xi*(hq[Y][Z] + hq[Z][Y]) - 2.0*r3*xi*h[YZ][iv]
+      + hq[Z][Y] - hq[Y][Z]
+      - kappa0*(dq[Y][XZ][iv]*divq[X]
+	       + dq[Y][YZ][iv]*divq[Y]
+	       + dqzz[Y]*divq[Z])
+      - kappa1*(dq[Y][XX][iv]*dq[Z][XX][iv]
+	       + dq[Y][YY][iv]*dq[Z][YY][iv]
+	       + dqzz[Y]*dqzz[Z]
+	       + 2.0*(dq[Y][XY][iv]*dq[Z][XY][iv]
+		     + dq[Y][XZ][iv]*dq[Z][XZ][iv]
+		     + dq[Y][YZ][iv]*dq[Z][YZ][iv]))
+      + kappa1*(dq[Y][XX][iv]*dq[X][XZ][iv]
+	       + dq[Y][XY][iv]*dq[X][YZ][iv]
+	       + dq[Y][XZ][iv]*dqzz[X]
+	       + dq[Y][XY][iv]*dq[Y][XZ][iv]
+	       + dq[Y][YY][iv]*dq[Y][YZ][iv]
+	       + dq[Y][YZ][iv]*dqzz[Y]
+	       + dq[Y][XZ][iv]*dq[Z][XZ][iv]
+	       + dq[Y][YZ][iv]*dq[Z][YZ][iv]
+	       + dqzz[Y]*dqzz[Z])
+      - 2.0*kappa1*q0*(dq[Y][XX][iv]*q[XY][iv]
+		      + dq[Y][XY][iv]*q[YY][iv]
+		      + dq[Y][XZ][iv]*q[YZ][iv]
+		      - dq[Y][XY][iv]*q[XX][iv]
+		      - dq[Y][YY][iv]*q[XY][iv]
+		      - dq[Y][YZ][iv]*q[XZ][iv]);
+    s[Y][Z][iv] = -sth;
+
+    /* ZX */
+    sth = 2.0*xi*(q[XZ][iv])*qh
+      - xi*(hq[Z][X] + hq[X][Z]) - 2.0*r3*xi*h[XZ][iv]
+      + hq[X][Z] - hq[Z][X]
+      - kappa0*(dq[Z][XX][iv]*divq[X]
+	       + dq[Z][XY][iv]*divq[Y]
+	       + dq[Z][XZ][iv]*divq[Z])
+      - kappa1*(dq[Z][XX][iv]*dq[X][XX][iv]
+	       + dq[Z][YY][iv]*dq[X][YY][iv]
+	       + dqzz[Z]*dqzz[X]
+	       + 2.0*(dq[Z][XY][iv]*dq[X][XY][iv]
+		     + dq[Z][XZ][iv]*dq[X][XZ][iv]
+		     + dq[Z][YZ][iv]*dq[X][YZ][iv]))
+      + kappa1*(dq[Z][XX][iv]*dq[X][XX][iv]
+	       + dq[Z][XY][iv]*dq[X][XY][iv]
+	       + dq[Z][XZ][iv]*dq[X][XZ][iv]
+	       + dq[Z][XY][iv]*dq[Y][XX][iv]
+	       + dq[Z][YY][iv]*dq[Y][XY][iv]
+	       + dq[Z][YZ][iv]*dq[Y][XZ][iv]
+	       + dq[Z][XZ][iv]*dq[Z][XX][iv]
+	       + dq[Z][YZ][iv]*dq[Z][XY][iv]
+	       + dqzz[Z]*dq[Z][XZ][iv])
+      - 2.0*kappa1*q0*(dq[Z][XY][iv]*q[XZ][iv]
+		      + dq[Z][YY][iv]*q[YZ][iv]
+		      + dq[Z][YZ][iv]*qzz
+		      - dq[Z][XZ][iv]*q[XY][iv]
+		      - dq[Z][YZ][iv]*q[YY][iv]
+		      - dqzz[Z]*q[YZ][iv]);
+    s[Z][X][iv] = -sth;
+
+    /* ZY */
+    sth = 2.0*xi*(q[YZ][iv])*qh
+      - xi*(hq[Z][Y] + hq[Y][Z]) - 2.0*r3*xi*h[YZ][iv]
+      + hq[Y][Z] - hq[Z][Y]
+      - kappa0*(dq[Z][XY][iv]*divq[X]
+	       + dq[Z][YY][iv]*divq[Y]
+	       + dq[Z][YZ][iv]*divq[Z])
+      - kappa1*(dq[Z][XX][iv]*dq[Y][XX][iv]
+	       + dq[Z][YY][iv]*dq[Y][YY][iv]
+	       + dqzz[Z]*dqzz[Y]
+	       + 2.0*(dq[Z][XY][iv]*dq[Y][XY][iv]
+		     + dq[Z][XZ][iv]*dq[Y][XZ][iv]
+		     + dq[Z][YZ][iv]*dq[Y][YZ][iv]))
+      + kappa1*(dq[Z][XX][iv]*dq[X][XY][iv]
+	       + dq[Z][XY][iv]*dq[X][YY][iv]
+	       + dq[Z][XZ][iv]*dq[X][YZ][iv]
+	       + dq[Z][XY][iv]*dq[Y][XY][iv]
+	       + dq[Z][YY][iv]*dq[Y][YY][iv]
+	       + dq[Z][YZ][iv]*dq[Y][YZ][iv]
+	       + dq[Z][XZ][iv]*dq[Z][XY][iv]
+	       + dq[Z][YZ][iv]*dq[Z][YY][iv]
+	       + dqzz[Z]*dq[Z][YZ][iv])
+      - 2.0*kappa1*q0*(- dq[Z][XX][iv]*q[XZ][iv]
+		      - dq[Z][XY][iv]*q[YZ][iv]
+		      - dq[Z][XZ][iv]*qzz
+		      + dq[Z][XZ][iv]*q[XX][iv]
+		      + dq[Z][YZ][iv]*q[XY][iv]
+		      + dqzz[Z]*q[XZ][iv]);
+    s[Z][Y][iv] = -sth;
+
+    /* ZZ */
+    sth = 2.0*xi*(qzz + r3)*qh - p0[iv]
+      - 2.0*xi*hq[Z][Z] - 2.0*r3*xi*hzz
+      - kappa0*(dq[Z][XZ][iv]*divq[X]
+	       + dq[Z][YZ][iv]*divq[Y]
+	       + dqzz[Z]*divq[Z])
+      - kappa1*(dq[Z][XX][iv]*dq[Z][XX][iv]
+	       + dq[Z][YY][iv]*dq[Z][YY][iv]
+	       + dqzz[Z]*dqzz[Z]
+	       + 2.0*(dq[Z][XY][iv]*dq[Z][XY][iv]
+		     + dq[Z][XZ][iv]*dq[Z][XZ][iv]
+		     + dq[Z][YZ][iv]*dq[Z][YZ][iv]))
+      + kappa1*(dq[Z][XX][iv]*dq[X][XZ][iv]
+	       + dq[Z][XY][iv]*dq[X][YZ][iv]
+	       + dq[Z][XZ][iv]*dqzz[X]
+	       + dq[Z][XY][iv]*dq[Y][XZ][iv]
+	       + dq[Z][YY][iv]*dq[Y][YZ][iv]
+	       + dq[Z][YZ][iv]*dqzz[Y]
+	       + dq[Z][XZ][iv]*dq[Z][XZ][iv]
+	       + dq[Z][YZ][iv]*dq[Z][YZ][iv]
+	       + dqzz[Z]*dqzz[Z])
+      - 2.0*kappa1*q0*(dq[Z][XX][iv]*q[XY][iv]
+		      + dq[Z][XY][iv]*q[YY][iv]
+		      + dq[Z][XZ][iv]*q[YZ][iv]
+		      - dq[Z][XY][iv]*q[XX][iv]
+		      - dq[Z][YY][iv]*q[XY][iv]
+		      - dq[Z][YZ][iv]*q[XZ][iv]);
+    s[Z][Z][iv] = -sth;
+  }
+
+  return;
+}
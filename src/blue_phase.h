@@ -150,6 +150,11 @@ void fe_lc_str_symm_v(fe_lc_t * fe, int index, double s[3][3][NSIMDVL]);
 __host__ __device__
 void fe_lc_str_anti_v(fe_lc_t * fe, int index, double s[3][3][NSIMDVL]);
 
+__host__ __device__
+void fe_lc_compute_fed_v(fe_lc_t * fe,
+			 double q[3][3][NSIMDVL],
+			 double dq[3][3][3][NSIMDVL],
+			 double fed[NSIMDVL]);
 __host__ __device__
 void fe_lc_compute_h_v(fe_lc_t * fe,
 		       double q[3][3][NSIMDVL],
@@ -163,6 +168,39 @@ void fe_lc_compute_stress_v(fe_lc_t * fe,
 			    double h[3][3][NSIMDVL],
 			    double s[3][3][NSIMDVL]);
 
+
+/* Compact kernels: the five independent components of Q_ab (and
+ * those of its gradient, Laplacian, and the molecular field) are
+ * held in storage order XX, XY, XZ, YY, YZ, and Q_zz = -Q_xx - Q_yy
+ * is reconstructed only where it is needed. */
+
+__host__ __device__
+void fe_lc_q5_v(fe_lc_t * fe, int index,
+		double q[NQAB][NSIMDVL],
+		double dq[NVECTOR][NQAB][NSIMDVL],
+		double dsq[NQAB][NSIMDVL]);
+__host__ __device__
+void fe_lc_q5_tensor(double a5[NQAB][NSIMDVL], int iv, double a[3][3]);
+__host__ __device__
+void fe_lc_mol_field5_v(fe_lc_t * fe, int index, double h[NQAB][NSIMDVL]);
+__host__ __device__
+void fe_lc_compute_fed5_v(fe_lc_t * fe,
+			  double q[NQAB][NSIMDVL],
+			  double dq[NVECTOR][NQAB][NSIMDVL],
+			  double fed[NSIMDVL]);
+__host__ __device__
+void fe_lc_compute_h5_v(fe_lc_t * fe,
+			double q[NQAB][NSIMDVL],
+			double dq[NVECTOR][NQAB][NSIMDVL],
+			double dsq[NQAB][NSIMDVL],
+			double h[NQAB][NSIMDVL]);
+__host__ __device__
+void fe_lc_compute_stress5_v(fe_lc_t * fe,
+			     double q[NQAB][NSIMDVL],
+			     double dq[NVECTOR][NQAB][NSIMDVL],
+			     double h[NQAB][NSIMDVL],
+			     double s[3][3][NSIMDVL]);
+
 __host__ __device__
 int fe_lc_bulk_stress(fe_lc_t * fe, int index, double sbulk[3][3]);
 
@@ -21,6 +21,18 @@
  *  the final term renders the whole thing traceless.
  *  xi is defined with the free energy.
  *
+ *  The relaxational part -Gamma H_ab may optionally be advanced with
+ *  its own time step dt_q (the hydrodynamic terms keep the lattice
+ *  Boltzmann time step). To allow dt_q larger than the explicit
+ *  stability limit, the local linear part of the molecular field,
+ *  -lambda Q_ab, is treated implicitly at each site, i.e.,
+ *
+ *  Q^{n+1} = Q^n + dt (S - div.(uQ)) + dt_q Gamma H^n/(1 + dt_q Gamma lambda)
+ *
+ *  which is stable for the elastic (diffusive) term if lambda includes
+ *  the diagonal of the Laplacian stencil. With dt_q = 1 and lambda = 0
+ *  (the default) this is the usual Euler forward step.
+ *
  *  The noise term xi_ab is treated following Bhattacharjee et al.
  *  J. Chem. Phys. 133 044112 (2010). We need to define five constant
  *  matrices T_ab; these are used in association with five random
@@ -87,6 +99,9 @@ struct beris_edw_s {
   advflux_t * flux;                /* Advective fluxes */
   int nall;                        /* Allocated sites */
   double * h;                      /* Molecular Field */
+  int h_external;                  /* Molecular field supplied elsewhere */
+  double dt_q;                     /* Time step for relaxational part */
+  double lambda;                   /* Linear relaxation rate (implicit) */
 
   beris_edw_t * target;            /* Target memory */
 };
@@ -139,6 +154,8 @@ __host__ int beris_edw_create(pe_t * pe, cs_t * cs, lees_edw_t * le,
   obj->cs = cs;
   obj->le = le;
   obj->flux = flx;
+  obj->dt_q = 1.0;
+  obj->lambda = 0.0;
 
   beris_edw_tmatrix(obj->param->tmatrix);
 
@@ -168,6 +185,10 @@ __host__ int beris_edw_create(pe_t * pe, cs_t * cs, lees_edw_t * le,
 
     tdpAssert(tdpMemcpy(&obj->target->nall, &obj->nall, sizeof(int),
 			tdpMemcpyHostToDevice));
+    tdpAssert(tdpMemcpy(&obj->target->dt_q, &obj->dt_q, sizeof(double),
+			tdpMemcpyHostToDevice));
+    tdpAssert(tdpMemcpy(&obj->target->lambda, &obj->lambda, sizeof(double),
+			tdpMemcpyHostToDevice));
     tdpAssert(tdpMalloc((void **) &htmp, nsites*NQAB*sizeof(double)));
     tdpAssert(tdpMemcpy(&obj->target->h, &htmp, sizeof(double *),
 			tdpMemcpyHostToDevice));
@@ -249,6 +270,78 @@ __host__ int beris_edw_param_set(beris_edw_t * be, beris_edw_param_t * vals) {
   return 0;
 }
 
+/*****************************************************************************
+ *
+ *  beris_edw_relaxation_set
+ *
+ *  Time step dt_q for the relaxational term -Gamma H_ab, and the rate
+ *  lambda of the linear part of -H_ab to be treated implicitly (see
+ *  the comment at the top of the file). Requires dt_q > 0 and
+ *  lambda >= 0.
+ *
+ *****************************************************************************/
+
+__host__ int beris_edw_relaxation_set(beris_edw_t * be, double dt_q,
+				      double lambda) {
+  assert(be);
+
+  if (dt_q <= 0.0) return -1;
+  if (lambda < 0.0) return -1;
+
+  be->dt_q = dt_q;
+  be->lambda = lambda;
+
+  if (be->target != be) {
+    tdpAssert(tdpMemcpy(&be->target->dt_q, &be->dt_q, sizeof(double),
+			tdpMemcpyHostToDevice));
+    tdpAssert(tdpMemcpy(&be->target->lambda, &be->lambda, sizeof(double),
+			tdpMemcpyHostToDevice));
+  }
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  beris_edw_h_external_set
+ *
+ *  If flag is set, the molecular field is not computed at the update,
+ *  but must have been supplied via beris_edw_h_set() for each local
+ *  site beforehand (see blue_phase_fused.c). Host only.
+ *
+ *****************************************************************************/
+
+__host__ int beris_edw_h_external_set(beris_edw_t * be, int flag) {
+
+  assert(be);
+  assert(be->target == be);
+
+  be->h_external = flag;
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  beris_edw_h_set
+ *
+ *  Store the molecular field h_ab (independent components) at index.
+ *
+ *****************************************************************************/
+
+__host__ void beris_edw_h_set(beris_edw_t * be, int index, double h[3][3]) {
+
+  assert(be);
+
+  be->h[addr_rank1(be->nall, NQAB, index, XX)] = h[X][X];
+  be->h[addr_rank1(be->nall, NQAB, index, XY)] = h[X][Y];
+  be->h[addr_rank1(be->nall, NQAB, index, XZ)] = h[X][Z];
+  be->h[addr_rank1(be->nall, NQAB, index, YY)] = h[Y][Y];
+  be->h[addr_rank1(be->nall, NQAB, index, YZ)] = h[Y][Z];
+
+  return;
+}
+
 /*****************************************************************************
  *
  *  beris_edw_update
@@ -282,7 +375,7 @@ __host__ int beris_edw_update(beris_edw_t * be,
     advection_bcs_no_normal_flux(be->flux, map);
   }
 
-  beris_edw_h_driver(be, fe);
+  if (be->h_external == 0) beris_edw_h_driver(be, fe);
   beris_edw_update_driver(be, fq, fq_grad, hydro, map, noise);
 
   return 0;
@@ -570,6 +663,10 @@ __global__ void beris_edw_kernel_v(kernel_3d_v_t k3v, beris_edw_t * be,
     double chi[NQAB], chi_qab[3][3][NSIMDVL];
     double tr[NSIMDVL];
 
+    /* Relaxation with time step dt_q, linear part implicit */
+    double gammaq = be->param->gamma*be->dt_q
+      /(1.0 + be->dt_q*be->param->gamma*be->lambda);
+
     index = k3v.kindex0 + kindex;
     kernel_3d_v_coords(&k3v, kindex, ic, jc, kc);
     kernel_3d_v_mask(&k3v, ic, jc, kc, maskv);
@@ -757,7 +854,7 @@ __global__ void beris_edw_kernel_v(kernel_3d_v_t k3v, beris_edw_t * be,
       q[X][X][iv] += dt*
 	(s[X][X][iv]
 	 + chi_qab[X][X][iv]
-	 + be->param->gamma*be->h[addr_rank1(be->nall, NQAB, index+iv, XX)]
+	 + gammaq*be->h[addr_rank1(be->nall, NQAB, index+iv, XX)]
 	 - flux->fe[addr_rank1(flux->nsite,NQAB,index + iv,XX)]
 	 + flux->fw[addr_rank1(flux->nsite,NQAB,index + iv,XX)]
 	 - flux->fy[addr_rank1(flux->nsite,NQAB,index + iv,XX)]
@@ -772,7 +869,7 @@ __global__ void beris_edw_kernel_v(kernel_3d_v_t k3v, beris_edw_t * be,
       q[X][Y][iv] += dt*
 	(s[X][Y][iv]
 	 + chi_qab[X][Y][iv]
-	 + be->param->gamma*be->h[addr_rank1(be->nall, NQAB, index+iv, XY)]
+	 + gammaq*be->h[addr_rank1(be->nall, NQAB, index+iv, XY)]
 	 - flux->fe[addr_rank1(flux->nsite,NQAB,index + iv,XY)]
 	 + flux->fw[addr_rank1(flux->nsite,NQAB,index + iv,XY)]
 	 - flux->fy[addr_rank1(flux->nsite,NQAB,index + iv,XY)]
@@ -787,7 +884,7 @@ __global__ void beris_edw_kernel_v(kernel_3d_v_t k3v, beris_edw_t * be,
       q[X][Z][iv] += dt*
 	(s[X][Z][iv]
 	 + chi_qab[X][Z][iv]
-	 + be->param->gamma*be->h[addr_rank1(be->nall, NQAB, index+iv, XZ)]
+	 + gammaq*be->h[addr_rank1(be->nall, NQAB, index+iv, XZ)]
 	 - flux->fe[addr_rank1(flux->nsite,NQAB,index + iv,XZ)]
 	 + flux->fw[addr_rank1(flux->nsite,NQAB,index + iv,XZ)]
 	 - flux->fy[addr_rank1(flux->nsite,NQAB,index + iv,XZ)]
@@ -802,7 +899,7 @@ __global__ void beris_edw_kernel_v(kernel_3d_v_t k3v, beris_edw_t * be,
       q[Y][Y][iv] += dt*
 	(s[Y][Y][iv]
 	 + chi_qab[Y][Y][iv]
-	 + be->param->gamma*be->h[addr_rank1(be->nall, NQAB, index+iv, YY)]
+	 + gammaq*be->h[addr_rank1(be->nall, NQAB, index+iv, YY)]
 	 - flux->fe[addr_rank1(flux->nsite,NQAB,index + iv,YY)]
 	 + flux->fw[addr_rank1(flux->nsite,NQAB,index + iv,YY)]
 	 - flux->fy[addr_rank1(flux->nsite,NQAB,index + iv,YY)]
@@ -817,7 +914,7 @@ __global__ void beris_edw_kernel_v(kernel_3d_v_t k3v, beris_edw_t * be,
       q[Y][Z][iv] += dt*
 	(s[Y][Z][iv]
 	 + chi_qab[Y][Z][iv]
-	 + be->param->gamma*be->h[addr_rank1(be->nall, NQAB, index+iv, YZ)]
+	 + gammaq*be->h[addr_rank1(be->nall, NQAB, index+iv, YZ)]
 	 - flux->fe[addr_rank1(flux->nsite,NQAB,index + iv,YZ)]
 	 + flux->fw[addr_rank1(flux->nsite,NQAB,index + iv,YZ)]
 	 - flux->fy[addr_rank1(flux->nsite,NQAB,index + iv,YZ)]
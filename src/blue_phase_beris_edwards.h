@@ -48,6 +48,11 @@ __host__ int beris_edw_update(beris_edw_t * be, fe_t * fe, field_t * fq,
 			      colloids_info_t * cinfo,
 			      map_t * map, noise_t * noise);
 
+__host__ int beris_edw_relaxation_set(beris_edw_t * be, double dt_q,
+				     double lambda);
+__host__ int beris_edw_h_external_set(beris_edw_t * be, int flag);
+__host__ void beris_edw_h_set(beris_edw_t * be, int index, double h[3][3]);
+
 __host__ __device__ int beris_edw_tmatrix(double t[3][3][NQAB]);
 
 #endif
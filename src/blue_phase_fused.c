@@ -0,0 +1,394 @@
+/*****************************************************************************
+ *
+ *  blue_phase_fused.c
+ *
+ *  Molecular field and thermodynamic force for the liquid crystal
+ *  free energy in a single pass over the lattice.
+ *
+ *  The standard route makes a number of full lattice passes each
+ *  time step: the gradients of Q_ab are computed and stored
+ *  (field_grad_t), the molecular field is computed and stored for
+ *  the Beris-Edwards update, the stress is computed and stored
+ *  (pth_t), and the force on the fluid is then computed as the
+ *  divergence of the stored stress.
+ *
+ *  Here the local domain is split into tiles. For each tile plus one
+ *  point all round, the gradient and Laplacian (3d 7-point stencil),
+ *  the molecular field, and the stress are computed directly from
+ *  Q_ab; the stress is held only in a small per-thread buffer. The
+ *  divergence is then taken for the tile interior. Only the molecular
+ *  field (interior sites) and the force are written to the lattice.
+ *
+ *  The arithmetic is exactly that of the standard route, so the
+ *  results should agree bit-for-bit.
+ *
+ *  Restrictions: fluid only (no walls, porous media, colloids, or
+ *  Lees-Edwards planes), the 3d_7pt_fluid gradient, the full stress
+ *  divergence, and host execution (the tiles are shared between
+ *  OpenMP threads).
+ *
+ *  Edinburgh Soft Matter and Statistical Physics Group and
+ *  Edinburgh Parallel Computing Centre
+ *
+ *  (c) 2024 The University of Edinburgh
+ *
+ *  Contributing authors:
+ *    Kevin Stratford (kevin@epcc.ed.ac.uk)
+ *
+ *****************************************************************************/
+
+#include <assert.h>
+#include <stdlib.h>
+
+#include "util.h"
+#include "timer.h"
+#include "blue_phase_fused.h"
+
+static int fe_lc_fused_tile(fe_lc_fused_t * fused, hydro_t * hydro,
+			    const cs_limits_t * lim, double * sbuf);
+static void fe_lc_fused_q_v(fe_lc_t * fe, const int index[NSIMDVL],
+			    int xs, int ys,
+			    double q[NQAB][NSIMDVL],
+			    double dq[NVECTOR][NQAB][NSIMDVL],
+			    double dsq[NQAB][NSIMDVL]);
+
+/*****************************************************************************
+ *
+ *  fe_lc_fused_create
+ *
+ *  The tile extent is clipped to the local domain at each compute.
+ *
+ *****************************************************************************/
+
+__host__ int fe_lc_fused_create(pe_t * pe, cs_t * cs, fe_lc_t * fe,
+				beris_edw_t * be, const int tile[3],
+				fe_lc_fused_t ** fused) {
+
+  int ndevice = 0;
+  int nhalo = 0;
+  fe_lc_fused_t * obj = NULL;
+
+  assert(pe);
+  assert(cs);
+  assert(fe);
+  assert(be);
+  assert(fused);
+
+  tdpGetDeviceCount(&ndevice);
+  if (ndevice > 0) pe_fatal(pe, "fe_lc_fused: host execution only\n");
+
+  cs_nhalo(cs, &nhalo);
+  if (nhalo < 2) pe_fatal(pe, "fe_lc_fused: require nhalo >= 2\n");
+
+  if (tile[X] < 1 || tile[Y] < 1 || tile[Z] < 1) {
+    pe_fatal(pe, "fe_lc_fused: tile extent must be at least 1\n");
+  }
+
+  obj = (fe_lc_fused_t *) calloc(1, sizeof(fe_lc_fused_t));
+  assert(obj);
+  if (obj == NULL) pe_fatal(pe, "calloc(fe_lc_fused_t) failed\n");
+
+  obj->pe = pe;
+  obj->cs = cs;
+  obj->fe = fe;
+  obj->be = be;
+  obj->tile[X] = tile[X];
+  obj->tile[Y] = tile[Y];
+  obj->tile[Z] = tile[Z];
+
+  beris_edw_h_external_set(be, 1);
+
+  *fused = obj;
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  fe_lc_fused_free
+ *
+ *  The Beris-Edwards object reverts to computing its own field.
+ *
+ *****************************************************************************/
+
+__host__ int fe_lc_fused_free(fe_lc_fused_t * fused) {
+
+  assert(fused);
+
+  beris_edw_h_external_set(fused->be, 0);
+  free(fused);
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  fe_lc_fused_q_grad_required
+ *
+ *  Returns 1 if the stored gradients of Q_ab are still required
+ *  at each step (by the active stress or the redshift update).
+ *
+ *****************************************************************************/
+
+__host__ int fe_lc_fused_q_grad_required(fe_lc_fused_t * fused) {
+
+  fe_lc_param_t * param = NULL;
+
+  assert(fused);
+
+  param = fused->fe->param;
+
+  return (param->is_active || param->is_redshift_updated);
+}
+
+/*****************************************************************************
+ *
+ *  fe_lc_fused_compute
+ *
+ *  Compute the molecular field (for the Beris-Edwards update) and,
+ *  if hydro is present, add the divergence of the stress to the
+ *  body force. The halo of Q_ab must be up-to-date.
+ *
+ *****************************************************************************/
+
+__host__ int fe_lc_fused_compute(fe_lc_fused_t * fused, hydro_t * hydro) {
+
+  int nlocal[3] = {0};
+  int tile[3] = {0};
+  int ntile[3] = {0};
+  int ntiles = 0;
+
+  assert(fused);
+
+  cs_nlocal(fused->cs, nlocal);
+
+  for (int ia = 0; ia < 3; ia++) {
+    tile[ia] = imin(fused->tile[ia], nlocal[ia]);
+    ntile[ia] = (nlocal[ia] + tile[ia] - 1)/tile[ia];
+  }
+  ntiles = ntile[X]*ntile[Y]*ntile[Z];
+
+  /* Time-dependent parameters (electric field) as fe_lc_target() */
+  fe_lc_param_commit(fused->fe);
+
+  TIMER_start(TIMER_PHI_FORCE_CALC);
+
+  #pragma omp parallel
+  {
+    /* Stress for one tile plus one point all round */
+    int nsbuf = (tile[X] + 2)*(tile[Y] + 2)*(tile[Z] + 2);
+    double * sbuf = (double *) malloc(9*nsbuf*sizeof(double));
+
+    assert(sbuf);
+    if (sbuf == NULL) pe_fatal(fused->pe, "malloc(fused stress) failed\n");
+
+    #pragma omp for schedule(dynamic)
+    for (int it = 0; it < ntiles; it++) {
+      int itx = it/(ntile[Y]*ntile[Z]);
+      int ity = (it - itx*ntile[Y]*ntile[Z])/ntile[Z];
+      int itz = it - (itx*ntile[Y] + ity)*ntile[Z];
+      cs_limits_t lim = {
+	.imin = 1 + itx*tile[X], .imax = imin((itx + 1)*tile[X], nlocal[X]),
+	.jmin = 1 + ity*tile[Y], .jmax = imin((ity + 1)*tile[Y], nlocal[Y]),
+	.kmin = 1 + itz*tile[Z], .kmax = imin((itz + 1)*tile[Z], nlocal[Z])
+      };
+
+      fe_lc_fused_tile(fused, hydro, &lim, sbuf);
+    }
+
+    free(sbuf);
+  }
+
+  TIMER_stop(TIMER_PHI_FORCE_CALC);
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  fe_lc_fused_tile
+ *
+ *  One tile with interior lim. The stress buffer sbuf holds the
+ *  region lim extended by one point in each direction.
+ *
+ *  The z-direction is taken NSIMDVL sites at a time; indices beyond
+ *  the end of a row are clamped to the last site, and the results
+ *  for those lanes discarded.
+ *
+ *****************************************************************************/
+
+static int fe_lc_fused_tile(fe_lc_fused_t * fused, hydro_t * hydro,
+			    const cs_limits_t * lim, double * sbuf) {
+
+  int xs = 0;
+  int ys = 0;
+  int zs = 0;
+
+  fe_lc_t * fe = fused->fe;
+  cs_t * cs = fused->cs;
+
+  /* Buffer strides (x and y; z is unit stride) */
+  int bsy = lim->kmax - lim->kmin + 3;
+  int bsx = bsy*(lim->jmax - lim->jmin + 3);
+
+  assert(sbuf);
+
+  cs_strides(cs, &xs, &ys, &zs);
+  assert(zs == 1);
+
+  /* Gradients, molecular field, and stress */
+
+  for (int ic = lim->imin - 1; ic <= lim->imax + 1; ic++) {
+    for (int jc = lim->jmin - 1; jc <= lim->jmax + 1; jc++) {
+      for (int kc = lim->kmin - 1; kc <= lim->kmax + 1; kc += NSIMDVL) {
+
+	int iv = 0;
+	int index[NSIMDVL];
+	double q[NQAB][NSIMDVL];
+	double dq[NVECTOR][NQAB][NSIMDVL];
+	double dsq[NQAB][NSIMDVL];
+	double h[NQAB][NSIMDVL];
+	double s[3][3][NSIMDVL];
+
+	for_simd_v(iv, NSIMDVL) {
+	  index[iv] = cs_index(cs, ic, jc, imin(kc + iv, lim->kmax + 1));
+	}
+
+	fe_lc_fused_q_v(fe, index, xs, ys, q, dq, dsq);
+	fe_lc_compute_h5_v(fe, q, dq, dsq, h);
+	fe_lc_compute_stress5_v(fe, q, dq, h, s);
+
+	if (fe->param->is_active) {
+	  double dp[3][3];
+	  double sa[3][3];
+	  double q1[3][3];
+	  for (iv = 0; iv < NSIMDVL; iv++) {
+	    field_grad_vector_grad(fe->dp, index[iv], dp);
+	    fe_lc_q5_tensor(q, iv, q1);
+	    fe_lc_compute_stress_active(fe, q1, dp, sa);
+	    for (int ia = 0; ia < 3; ia++) {
+	      for (int ib = 0; ib < 3; ib++) {
+		s[ia][ib][iv] += sa[ia][ib];
+	      }
+	    }
+	  }
+	}
+
+	for (iv = 0; iv < NSIMDVL; iv++) {
+	  int k = kc + iv;
+	  int n = 0;
+	  if (k > lim->kmax + 1) break;
+	  n = (ic - lim->imin + 1)*bsx + (jc - lim->jmin + 1)*bsy
+	    + (k - lim->kmin + 1);
+	  for (int ia = 0; ia < 3; ia++) {
+	    for (int ib = 0; ib < 3; ib++) {
+	      sbuf[9*n + 3*ia + ib] = s[ia][ib][iv];
+	    }
+	  }
+
+	  /* Molecular field at interior sites only */
+	  if (ic < lim->imin || ic > lim->imax) continue;
+	  if (jc < lim->jmin || jc > lim->jmax) continue;
+	  if (k  < lim->kmin || k  > lim->kmax) continue;
+	  {
+	    double h1[3][3];
+	    fe_lc_q5_tensor(h, iv, h1);
+	    beris_edw_h_set(fused->be, index[iv], h1);
+	  }
+	}
+      }
+    }
+  }
+
+  if (hydro == NULL) return 0;
+
+  /* Force F_a = d_b P_ab (as pth_force_fluid_kernel_v) */
+
+  for (int ic = lim->imin; ic <= lim->imax; ic++) {
+    for (int jc = lim->jmin; jc <= lim->jmax; jc++) {
+      for (int kc = lim->kmin; kc <= lim->kmax; kc++) {
+
+	int index = cs_index(cs, ic, jc, kc);
+	int n = (ic - lim->imin + 1)*bsx + (jc - lim->jmin + 1)*bsy
+	      + (kc - lim->kmin + 1);
+	const double * p0 = sbuf + 9*n;
+	const double * p1 = NULL;
+	double force[3] = {0};
+
+	p1 = sbuf + 9*(n + bsx);
+	for (int ia = 0; ia < 3; ia++) {
+	  force[ia] = -0.5*(p1[3*ia + X] + p0[3*ia + X]);
+	}
+	p1 = sbuf + 9*(n - bsx);
+	for (int ia = 0; ia < 3; ia++) {
+	  force[ia] += 0.5*(p1[3*ia + X] + p0[3*ia + X]);
+	}
+	p1 = sbuf + 9*(n + bsy);
+	for (int ia = 0; ia < 3; ia++) {
+	  force[ia] -= 0.5*(p1[3*ia + Y] + p0[3*ia + Y]);
+	}
+	p1 = sbuf + 9*(n - bsy);
+	for (int ia = 0; ia < 3; ia++) {
+	  force[ia] += 0.5*(p1[3*ia + Y] + p0[3*ia + Y]);
+	}
+	p1 = sbuf + 9*(n + 1);
+	for (int ia = 0; ia < 3; ia++) {
+	  force[ia] -= 0.5*(p1[3*ia + Z] + p0[3*ia + Z]);
+	}
+	p1 = sbuf + 9*(n - 1);
+	for (int ia = 0; ia < 3; ia++) {
+	  force[ia] += 0.5*(p1[3*ia + Z] + p0[3*ia + Z]);
+	}
+
+	for (int ia = 0; ia < 3; ia++) {
+	  hydro->force->data[addr_rank1(hydro->nsite, NHDIM, index, ia)]
+	    += force[ia];
+	}
+      }
+    }
+  }
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  fe_lc_fused_q_v
+ *
+ *  The compact Q_ab, and its gradient and Laplacian, for the sites
+ *  index[]. This is the 3d_7pt_fluid stencil, in the storage order
+ *  used by fe_lc_q5_v().
+ *
+ *****************************************************************************/
+
+static void fe_lc_fused_q_v(fe_lc_t * fe, const int index[NSIMDVL],
+			    int xs, int ys,
+			    double q[NQAB][NSIMDVL],
+			    double dq[NVECTOR][NQAB][NSIMDVL],
+			    double dsq[NQAB][NSIMDVL]) {
+  int iv = 0;
+  int nsites = fe->q->nsites;
+  const double * __restrict__ data = fe->q->data;
+
+  for (int n = 0; n < NQAB; n++) {
+    for_simd_v(iv, NSIMDVL) {
+      int i0 = index[iv];
+      q[n][iv] = data[addr_rank1(nsites, NQAB, i0, n)];
+      dq[X][n][iv] = 0.5*(data[addr_rank1(nsites, NQAB, i0 + xs, n)] -
+			  data[addr_rank1(nsites, NQAB, i0 - xs, n)]);
+      dq[Y][n][iv] = 0.5*(data[addr_rank1(nsites, NQAB, i0 + ys, n)] -
+			  data[addr_rank1(nsites, NQAB, i0 - ys, n)]);
+      dq[Z][n][iv] = 0.5*(data[addr_rank1(nsites, NQAB, i0 + 1, n)] -
+			  data[addr_rank1(nsites, NQAB, i0 - 1, n)]);
+      dsq[n][iv] = data[addr_rank1(nsites, NQAB, i0 + xs, n)]
+	         + data[addr_rank1(nsites, NQAB, i0 - xs, n)]
+	         + data[addr_rank1(nsites, NQAB, i0 + ys, n)]
+	         + data[addr_rank1(nsites, NQAB, i0 - ys, n)]
+	         + data[addr_rank1(nsites, NQAB, i0 + 1, n)]
+	         + data[addr_rank1(nsites, NQAB, i0 - 1, n)]
+	         - 6.0*data[addr_rank1(nsites, NQAB, i0, n)];
+    }
+  }
+
+  return;
+}
@@ -0,0 +1,41 @@
+/*****************************************************************************
+ *
+ *  blue_phase_fused.h
+ *
+ *  Edinburgh Soft Matter and Statistical Physics Group and
+ *  Edinburgh Parallel Computing Centre
+ *
+ *  (c) 2024 The University of Edinburgh
+ *
+ *  Contributing authors:
+ *    Kevin Stratford (kevin@epcc.ed.ac.uk)
+ *
+ *****************************************************************************/
+
+#ifndef LUDWIG_BLUE_PHASE_FUSED_H
+#define LUDWIG_BLUE_PHASE_FUSED_H
+
+#include "pe.h"
+#include "coords.h"
+#include "blue_phase.h"
+#include "blue_phase_beris_edwards.h"
+#include "hydro.h"
+
+typedef struct fe_lc_fused_s fe_lc_fused_t;
+
+struct fe_lc_fused_s {
+  pe_t * pe;                  /* Parallel environment */
+  cs_t * cs;                  /* Coordinate system */
+  fe_lc_t * fe;               /* Liquid crystal free energy */
+  beris_edw_t * be;           /* Receives the molecular field */
+  int tile[3];                /* Tile extent (local sites) */
+};
+
+__host__ int fe_lc_fused_create(pe_t * pe, cs_t * cs, fe_lc_t * fe,
+				beris_edw_t * be, const int tile[3],
+				fe_lc_fused_t ** fused);
+__host__ int fe_lc_fused_free(fe_lc_fused_t * fused);
+__host__ int fe_lc_fused_compute(fe_lc_fused_t * fused, hydro_t * hydro);
+__host__ int fe_lc_fused_q_grad_required(fe_lc_fused_t * fused);
+
+#endif
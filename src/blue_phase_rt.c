@@ -402,6 +402,42 @@ __host__ int blue_phase_init_rt(pe_t * pe, rt_t *rt,
 	    (be_param.noise == 0) ? "off" : "on");
   }
 
+  /* Relaxational update: explicit (default) or semi-implicit with
+   * a Q time step lc_q_timestep. The linear part of H_ab treated
+   * implicitly is from the bulk term (if stabilising), the chiral
+   * term, and the diagonal of the 7-point Laplacian. */
+
+  {
+    char integrator[BUFSIZ] = "explicit";
+    double dt_q = 1.0;
+
+    rt_string_parameter(rt, "lc_q_integrator", integrator, BUFSIZ);
+    n = rt_double_parameter(rt, "lc_q_timestep", &dt_q);
+
+    if (strcmp(integrator, "semi_implicit") == 0) {
+      double r = fe_param.redshift;
+      double lambda = 6.0*fe_param.kappa0*r*r
+	+ 4.0*fe_param.kappa1*fe_param.q0*fe_param.q0
+	+ fmax(0.0, fe_param.a0*(1.0 - fe_param.gamma/3.0));
+
+      if (be_param.noise) {
+	pe_fatal(pe, "lc_q_integrator semi_implicit requires lc_noise 0\n");
+      }
+      if (dt_q <= 0.0) pe_fatal(pe, "lc_q_timestep must be positive\n");
+
+      beris_edw_relaxation_set(be, dt_q, lambda);
+      pe_info(pe, "Q integrator               =  %s\n", integrator);
+      pe_info(pe, "Q time step                = %14.7e\n", dt_q);
+      pe_info(pe, "Implicit relaxation rate   = %14.7e\n", lambda);
+    }
+    else if (strcmp(integrator, "explicit") == 0) {
+      if (n == 1) pe_fatal(pe, "lc_q_timestep requires semi_implicit\n");
+    }
+    else {
+      pe_fatal(pe, "lc_q_integrator must be explicit or semi_implicit\n");
+    }
+  }
+
   return 0;
 }
 
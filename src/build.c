@@ -25,6 +25,8 @@
 #include "coords.h"
 #include "physics.h"
 #include "colloid_sums.h"
+#include "colloid_cell_table.h"
+#include "colloid_link_table.h"
 #include "psi_colloid.h"
 #include "util.h"
 #include "util_ellipsoid.h"
@@ -58,6 +60,26 @@ static void build_link_mean(colloid_t * pc, double wv, const int8_t cv[3],
 static int build_colloid_wall_links(cs_t * cs, colloids_info_t * cinfo,
 				    colloid_t * pc, map_t * map,
 				    const lb_model_t * model);
+static int build_update_map_all(cs_t * cs, colloids_info_t * cinfo,
+				map_t * map);
+static int build_update_map_delta(cs_t * cs, colloids_info_t * cinfo,
+				  map_t * map);
+static int build_map_colloid(cs_t * cs, colloids_info_t * cinfo, map_t * map,
+			     colloid_t * pc, int record);
+static int build_map_clear(cs_t * cs, colloids_info_t * cinfo, map_t * map,
+			   const colloid_t * pc, const int box[2][3]);
+static int build_map_state_changed(const colloid_state_t * s0,
+				   const colloid_state_t * s1);
+static int build_map_box(cs_t * cs, const colloid_t * pc, int box[2][3]);
+static int build_map_sites_unchanged(cs_t * cs, colloids_info_t * cinfo,
+				     const colloid_t * pc);
+static int build_remove_replace_site(fe_t * fe, colloids_info_t * cinfo,
+				     lb_t * lb, field_t * phi, field_t * p,
+				     field_t * q, psi_t * psi, map_t * map,
+				     int index, int is_halo);
+static int build_relink_flag(cs_t * cs, colloids_info_t * cinfo,
+			     const lb_model_t * model);
+static int build_index_cmp(const void * a, const void * b);
 
 int build_conservation_phi(colloids_info_t * cinfo, field_t * phi,
 			   const lb_model_t * model);
@@ -72,29 +94,57 @@ int build_conservation_psi(colloids_info_t * cinfo, psi_t * psi,
  *  of all nodes in the presence on colloids. This must be complete
  *  before attempting to build the colloid links.
  *
+ *  The first update examines the whole lattice. Subsequent updates
+ *  are incremental: only colloids whose position, shape, orientation,
+ *  or wetting properties have changed since the last update are
+ *  examined. If a colloid has moved, but covers the same set of
+ *  lattice sites as before, the map is left alone (its links are
+ *  still reset). Otherwise, its old sites are cleared and new sites
+ *  set. The sites which change are recorded (see
+ *  colloids_info_map_changed_add()) for use in build_remove_replace()
+ *  and build_update_links().
+ *
  ****************************************************************************/
 
 int build_update_map(cs_t * cs, colloids_info_t * cinfo, map_t * map) {
 
+  assert(cs);
+  assert(cinfo);
+  assert(map);
+
+  assert(map->ndata <= 2);
+
+  if (cinfo->map_nupdate == 0) {
+    build_update_map_all(cs, cinfo, map);
+  }
+  else {
+    build_update_map_delta(cs, cinfo, map);
+  }
+
+  cinfo->map_nupdate += 1;
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  build_update_map_all
+ *
+ *  Reset all colloid sites to fluid and set the sites for every colloid.
+ *
+ *****************************************************************************/
+
+static int build_update_map_all(cs_t * cs, colloids_info_t * cinfo,
+				map_t * map) {
   int nlocal[3];
-  int noffset[3];
   int ncell[3];
   int ic, jc, kc;
-
-  int i, j, k;
-  int i_min, i_max, j_min, j_max, k_min, k_max;
   int index;
   int nhalo;
   int status;
 
   colloid_t * p_colloid = NULL;
-
-  double  r0[3];
-  double  rsite0[3];
-  double  rsep[3];
-
-  double   largestdimn;
-  double   cosine, mod;
+  colloid_cell_table_t * ct = NULL;
 
   /* To set the wetting data in the map, we assume C, H zero at moment */
   double wet[2];
@@ -103,10 +153,7 @@ int build_update_map(cs_t * cs, colloids_info_t * cinfo, map_t * map) {
   assert(cinfo);
   assert(map);
 
-  assert(map->ndata <= 2);
-
   cs_nlocal(cs, nlocal);
-  cs_nlocal_offset(cs, noffset);
   cs_nhalo(cs, &nhalo);
 
   colloids_info_ncell(cinfo, ncell);
@@ -134,93 +181,336 @@ int build_update_map(cs_t * cs, colloids_info_t * cinfo, map_t * map) {
 
   colloids_info_map_update(cinfo);
 
-  /* Loop through all cells (including the halo cells) */
+  /* All colloids in all cells (including the halo cells) */
+
+  colloids_info_cell_table(cinfo, &ct);
+
+  for (int n = 0; n < ct->nall; n++) {
+
+    /* For each colloid, check solid/fluid status */
+
+    p_colloid = ct->pc[n];
+    p_colloid->build.mapped = 0;
+    if (p_colloid->s.bc != COLLOID_BC_BBL) continue;
+    build_map_colloid(cs, cinfo, map, p_colloid, 0);
+  }
+
+  /* All changes are not recorded, so map_old must be taken as a whole */
+
+  cinfo->nvacant = 0;
+  cinfo->nchanged = 0;
+  cinfo->map_isdelta = 0;
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  build_update_map_delta
+ *
+ *  Incremental update. map_old becomes the current map, which is
+ *  then amended in place for colloids which have been removed, or
+ *  which have changed since the last update.
+ *
+ *****************************************************************************/
+
+static int build_update_map_delta(cs_t * cs, colloids_info_t * cinfo,
+				  map_t * map) {
+
+  colloid_cell_table_t * ct = NULL;
+
+  assert(cs);
+  assert(cinfo);
+  assert(map);
+
+  colloids_info_map_sync(cinfo);
+
+  /* Sites of colloids which no longer exist */
+
+  for (int n = 0; n < cinfo->nvacant; n++) {
+    int box[2][3] = {0};
+    for (int ia = 0; ia < 3; ia++) {
+      box[0][ia] = cinfo->vacant_box[6*n + ia];
+      box[1][ia] = cinfo->vacant_box[6*n + 3 + ia];
+    }
+    build_map_clear(cs, cinfo, map, cinfo->vacant[n], box);
+  }
+  cinfo->nvacant = 0;
+
+  /* Colloids which have changed (or are new) */
+
+  colloids_info_cell_table(cinfo, &ct);
+
+  for (int n = 0; n < ct->nall; n++) {
+
+    colloid_t * pc = ct->pc[n];
+    int ischanged = build_map_state_changed(&pc->build.s, &pc->s);
+
+    if (pc->build.mapped && ischanged == 0) continue;
+
+    if (pc->build.mapped && build_map_sites_unchanged(cs, cinfo, pc)) {
+      /* No lattice site boundary crossed: only the links move */
+      pc->build.relink = 1;
+      pc->build.s = pc->s;
+      continue;
+    }
+
+    if (pc->build.mapped) {
+      build_map_clear(cs, cinfo, map, pc, pc->build.box);
+      pc->build.mapped = 0;
+    }
 
-  for (ic = 0; ic <= ncell[X] + 1; ic++) {
-    for (jc = 0; jc <= ncell[Y] + 1; jc++) {
-      for (kc = 0; kc <= ncell[Z] + 1; kc++) {
+    if (pc->s.bc != COLLOID_BC_BBL) continue;
+    build_map_colloid(cs, cinfo, map, pc, 1);
+  }
 
-	/* Set the cell index */
+  cinfo->map_isdelta = 1;
 
-	colloids_info_cell_list_head(cinfo, ic, jc, kc, &p_colloid);
+  return 0;
+}
 
-	/* For each colloid in this cell, check solid/fluid status */
+/*****************************************************************************
+ *
+ *  build_map_colloid
+ *
+ *  Set the map for sites inside the colloid pc, and record the range
+ *  of sites examined and the state used. If record is set, sites
+ *  which change are recorded.
+ *
+ *****************************************************************************/
 
-	for ( ; p_colloid; p_colloid = p_colloid->next) {
+static int build_map_colloid(cs_t * cs, colloids_info_t * cinfo, map_t * map,
+			     colloid_t * p_colloid, int record) {
+  int noffset[3];
+  int i, j, k;
+  int box[2][3] = {0};
+  int index;
 
-	  if (p_colloid->s.bc != COLLOID_BC_BBL) continue;
+  double  r0[3];
+  double  rsite0[3];
+  double  rsep[3];
 
-	  /* Set actual position and size of the cube to be checked */
+  double   cosine, mod;
 
-	  largestdimn = colloid_principal_radius(&p_colloid->s);
+  /* To set the wetting data in the map, we assume C, H zero at moment */
+  double wet[2];
 
-	  /* Need to translate the colloid position to "local"
-	   * coordinates, so that the correct range of lattice
-	   * nodes is found */
+  assert(cs);
+  assert(cinfo);
+  assert(map);
+  assert(p_colloid);
 
-	  r0[X] = p_colloid->s.r[X] - 1.0*noffset[X];
-	  r0[Y] = p_colloid->s.r[Y] - 1.0*noffset[Y];
-	  r0[Z] = p_colloid->s.r[Z] - 1.0*noffset[Z];
+  cs_nlocal_offset(cs, noffset);
 
-	  /* Compute appropriate range of sites that require checks, i.e.,
-	   * a cubic box around the centre of the colloid. However, this
-	   * should not extend beyond the boundary of the current domain
-	   * (but include halos). */
+  /* Need to translate the colloid position to "local"
+   * coordinates, so that the correct range of lattice
+   * nodes is found */
 
-	  i_min = imax(1 - nhalo,         (int) floor(r0[X] - largestdimn));
-	  i_max = imin(nlocal[X] + nhalo, (int) ceil (r0[X] + largestdimn));
-	  j_min = imax(1 - nhalo,         (int) floor(r0[Y] - largestdimn));
-	  j_max = imin(nlocal[Y] + nhalo, (int) ceil (r0[Y] + largestdimn));
-	  k_min = imax(1 - nhalo,         (int) floor(r0[Z] - largestdimn));
-	  k_max = imin(nlocal[Z] + nhalo, (int) ceil (r0[Z] + largestdimn));
+  r0[X] = p_colloid->s.r[X] - 1.0*noffset[X];
+  r0[Y] = p_colloid->s.r[Y] - 1.0*noffset[Y];
+  r0[Z] = p_colloid->s.r[Z] - 1.0*noffset[Z];
 
-	  /* Check each site to see whether it is inside or not */
+  build_map_box(cs, p_colloid, box);
 
-	  for (i = i_min; i <= i_max; i++)
-	    for (j = j_min; j <= j_max; j++)
-	      for (k = k_min; k <= k_max; k++) {
+  /* Check each site to see whether it is inside or not */
 
-		/* rsite0 is the coordinate position of the site */
+  for (i = box[0][X]; i <= box[1][X]; i++)
+    for (j = box[0][Y]; j <= box[1][Y]; j++)
+      for (k = box[0][Z]; k <= box[1][Z]; k++) {
 
-		rsite0[X] = 1.0*i;
-		rsite0[Y] = 1.0*j;
-		rsite0[Z] = 1.0*k;
-		cs_minimum_distance(cs, rsite0, r0, rsep);
+	/* rsite0 is the coordinate position of the site */
 
-		/* Are we inside? */
+	rsite0[X] = 1.0*i;
+	rsite0[Y] = 1.0*j;
+	rsite0[Z] = 1.0*k;
+	cs_minimum_distance(cs, rsite0, r0, rsep);
 
-		if (colloid_r_inside(&p_colloid->s, rsep)) {
+	/* Are we inside? */
 
-		  /* Set index */
-		  index = cs_index(cs, i, j, k);
+	if (colloid_r_inside(&p_colloid->s, rsep)) {
 
-		  colloids_info_map_set(cinfo, index, p_colloid);
-		  map_status_set(map, index, MAP_COLLOID);
+	  colloid_t * pcold = NULL;
 
-		  /* Janus particles have h = h_0 cos (theta)
-		   * with s[3] pointing to the 'north pole' */
+	  /* Set index */
+	  index = cs_index(cs, i, j, k);
 
-		  cosine = 1.0;
+	  colloids_info_map(cinfo, index, &pcold);
+	  if (record && pcold != p_colloid) {
+	    colloids_info_map_changed_add(cinfo, index);
+	  }
+	  colloids_info_map_set(cinfo, index, p_colloid);
+	  map_status_set(map, index, MAP_COLLOID);
 
-		  if (p_colloid->s.attr & COLLOID_ATTR_JANUS) {
-		    mod = modulus(rsep);
-		    if (mod > 0.0) {
-		      cosine = dot_product(p_colloid->s.s, rsep)/mod;
-		    }
-		  }
+	  /* Janus particles have h = h_0 cos (theta)
+	   * with s[3] pointing to the 'north pole' */
 
-		  wet[0] = p_colloid->s.c;
-		  wet[1] = cosine*p_colloid->s.h;
+	  cosine = 1.0;
 
-		  map_data_set(map, index, wet);
-		}
-		/* Next site */
-	      }
+	  if (p_colloid->s.attr & COLLOID_ATTR_JANUS) {
+	    mod = modulus(rsep);
+	    if (mod > 0.0) {
+	      cosine = dot_product(p_colloid->s.s, rsep)/mod;
+	    }
+	  }
 
-	  /* Next colloid */
+	  wet[0] = p_colloid->s.c;
+	  wet[1] = cosine*p_colloid->s.h;
+
+	  map_data_set(map, index, wet);
 	}
+	/* Next site */
+      }
+
+  /* Remember what has been done */
+
+  p_colloid->build.mapped = 1;
+  p_colloid->build.relink = 1;
+  for (int ia = 0; ia < 3; ia++) {
+    p_colloid->build.box[0][ia] = box[0][ia];
+    p_colloid->build.box[1][ia] = box[1][ia];
+  }
+  p_colloid->build.s = p_colloid->s;
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  build_map_box
+ *
+ *  The range of sites that require checks for colloid pc, i.e., a
+ *  cubic box around the centre of the colloid. However, this should
+ *  not extend beyond the boundary of the current domain (but include
+ *  halos).
+ *
+ *****************************************************************************/
+
+static int build_map_box(cs_t * cs, const colloid_t * pc, int box[2][3]) {
+
+  int nlocal[3] = {0};
+  int noffset[3] = {0};
+  int nhalo = 0;
+  double largestdimn = 0.0;
+
+  assert(cs);
+  assert(pc);
+
+  cs_nlocal(cs, nlocal);
+  cs_nlocal_offset(cs, noffset);
+  cs_nhalo(cs, &nhalo);
+
+  largestdimn = colloid_principal_radius(&pc->s);
+
+  for (int ia = 0; ia < 3; ia++) {
+    double r0 = pc->s.r[ia] - 1.0*noffset[ia];
+    box[0][ia] = imax(1 - nhalo,          (int) floor(r0 - largestdimn));
+    box[1][ia] = imin(nlocal[ia] + nhalo, (int) ceil (r0 + largestdimn));
+  }
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  build_map_sites_unchanged
+ *
+ *  A colloid which has moved (or rotated) since the last map update
+ *  may still cover exactly the same set of lattice sites. If so, and
+ *  no property other than the position and orientation has changed,
+ *  return 1: the map need not be touched.
+ *
+ *  Janus particles have wetting data which depend on the orientation
+ *  at each site, so always return 0.
+ *
+ *****************************************************************************/
+
+static int build_map_sites_unchanged(cs_t * cs, colloids_info_t * cinfo,
+				     const colloid_t * pc) {
+  int noffset[3] = {0};
+  int box[2][3] = {0};
+  const colloid_state_t * s0 = &pc->build.s;
+  const colloid_state_t * s1 = &pc->s;
+
+  assert(cs);
+  assert(cinfo);
+  assert(pc);
 
-	/* Next cell */
+  if (s0->bc != s1->bc || s0->shape != s1->shape) return 0;
+  if (s0->attr != s1->attr || (s1->attr & COLLOID_ATTR_JANUS)) return 0;
+  if (s0->a0 != s1->a0 || s0->c != s1->c || s0->h != s1->h) return 0;
+  if (s1->bc != COLLOID_BC_BBL) return 0;
+
+  /* A different box means a boundary crossing (or a move near the
+   * edge of the local domain). */
+
+  build_map_box(cs, pc, box);
+
+  for (int ia = 0; ia < 3; ia++) {
+    if (box[0][ia] != pc->build.box[0][ia]) return 0;
+    if (box[1][ia] != pc->build.box[1][ia]) return 0;
+  }
+
+  /* Same box: every site must be inside now iff it is mapped to pc */
+
+  cs_nlocal_offset(cs, noffset);
+
+  for (int ic = box[0][X]; ic <= box[1][X]; ic++) {
+    for (int jc = box[0][Y]; jc <= box[1][Y]; jc++) {
+      for (int kc = box[0][Z]; kc <= box[1][Z]; kc++) {
+	int index = cs_index(cs, ic, jc, kc);
+	double r0[3] = {s1->r[X] - 1.0*noffset[X],
+			s1->r[Y] - 1.0*noffset[Y],
+			s1->r[Z] - 1.0*noffset[Z]};
+	double rsite[3] = {1.0*ic, 1.0*jc, 1.0*kc};
+	double rsep[3] = {0};
+	colloid_t * pcmap = NULL;
+
+	cs_minimum_distance(cs, rsite, r0, rsep);
+	colloids_info_map(cinfo, index, &pcmap);
+	if (colloid_r_inside(s1, rsep) != (pcmap == pc)) return 0;
+      }
+    }
+  }
+
+  return 1;
+}
+
+/*****************************************************************************
+ *
+ *  build_map_clear
+ *
+ *  Return the sites in the box which are currently set for colloid pc
+ *  to fluid, and record them as changed. The colloid pointer may refer
+ *  to a colloid which has been freed; it is used as a value only.
+ *
+ *****************************************************************************/
+
+static int build_map_clear(cs_t * cs, colloids_info_t * cinfo, map_t * map,
+			   const colloid_t * pc, const int box[2][3]) {
+  assert(cs);
+  assert(cinfo);
+  assert(map);
+
+  for (int ic = box[0][X]; ic <= box[1][X]; ic++) {
+    for (int jc = box[0][Y]; jc <= box[1][Y]; jc++) {
+      for (int kc = box[0][Z]; kc <= box[1][Z]; kc++) {
+
+	int index = cs_index(cs, ic, jc, kc);
+	int status = MAP_FLUID;
+	colloid_t * pcmap = NULL;
+
+	colloids_info_map(cinfo, index, &pcmap);
+	if (pcmap != pc) continue;
+
+	colloids_info_map_changed_add(cinfo, index);
+	colloids_info_map_set(cinfo, index, NULL);
+
+	map_status(map, index, &status);
+	if (status == MAP_COLLOID) {
+	  double wet[2] = {0.0, 0.0};
+	  map_status_set(map, index, MAP_FLUID);
+	  map_data_set(map, index, wet);
+	}
       }
     }
   }
@@ -228,11 +518,51 @@ int build_update_map(cs_t * cs, colloids_info_t * cinfo, map_t * map) {
   return 0;
 }
 
+/*****************************************************************************
+ *
+ *  build_map_state_changed
+ *
+ *  Has anything which affects the map changed between s0 and s1?
+ *
+ *****************************************************************************/
+
+static int build_map_state_changed(const colloid_state_t * s0,
+				   const colloid_state_t * s1) {
+  int ischanged = 0;
+
+  assert(s0);
+  assert(s1);
+
+  ischanged += (s0->bc != s1->bc);
+  ischanged += (s0->shape != s1->shape);
+  ischanged += (s0->attr != s1->attr);
+  ischanged += (s0->a0 != s1->a0);
+  ischanged += (s0->c != s1->c);
+  ischanged += (s0->h != s1->h);
+
+  for (int ia = 0; ia < 3; ia++) {
+    ischanged += (s0->r[ia] != s1->r[ia]);
+    ischanged += (s0->s[ia] != s1->s[ia]);
+    ischanged += (s0->elabc[ia] != s1->elabc[ia]);
+  }
+  for (int iq = 0; iq < 4; iq++) {
+    ischanged += (s0->quat[iq] != s1->quat[iq]);
+  }
+
+  return ischanged;
+}
+
 /*****************************************************************************
  *
  *  build_update_links
  *
  *  Reconstruct or reset the boundary links for each colloid as necessary.
+ *  The flat link table (colloid_link_table.h) is then rebuilt.
+ *
+ *  After an incremental map update, colloids which have not changed,
+ *  and which have no link to a site which has changed, retain their
+ *  existing links; the local link sums are restored from those
+ *  recorded at the last reset.
  *
  *****************************************************************************/
 
@@ -240,54 +570,120 @@ int build_update_links(cs_t * cs, colloids_info_t * cinfo, wall_t * wall,
 		       map_t * map, const lb_model_t * model) {
 
   int ia;
-  int ic, jc, kc;
-  int ncell[3];
-  int nhalo;
-  colloid_t * pc;
+  colloid_cell_table_t * ct = NULL;
 
   assert(cs);
   assert(cinfo);
   assert(map);
   assert(model);
 
-  colloids_info_ncell(cinfo, ncell);
-  colloids_info_nhalo(cinfo, &nhalo);
+  if (cinfo->map_isdelta) build_relink_flag(cs, cinfo, model);
 
-  for (ic = 1 - nhalo; ic <= ncell[X] + nhalo; ic++) {
-    for (jc = 1 - nhalo; jc <= ncell[Y] + nhalo; jc++) {
-      for (kc = 1 - nhalo; kc <= ncell[Z] + nhalo; kc++) {
+  colloids_info_cell_table(cinfo, &ct);
 
-	colloids_info_cell_list_head(cinfo, ic, jc, kc, &pc);
+  for (int n = 0; n < ct->nall; n++) {
 
-	for (; pc; pc = pc->next) {
+    colloid_t * pc = ct->pc[n];
+    int relink = (pc->build.relink || cinfo->map_isdelta == 0);
 
-	  if (pc->s.bc != COLLOID_BC_BBL) continue;
+    if (pc->s.bc != COLLOID_BC_BBL) continue;
 
-	  pc->sumw   = 0.0;
-	  for (ia = 0; ia < 3; ia++) {
-	    pc->cbar[ia] = 0.0;
-	    pc->rxcbar[ia] = 0.0;
-	  }
+    if (pc->s.rebuild == 0 && relink == 0) {
+      /* Nothing has changed: links are as before */
+      pc->sumw = pc->build.sumw;
+      for (ia = 0; ia < 3; ia++) {
+	pc->cbar[ia] = pc->build.cbar[ia];
+	pc->rxcbar[ia] = pc->build.rxcbar[ia];
+      }
+      pc->s.sa = pc->build.sa;
+      pc->s.saf = pc->build.saf;
+      continue;
+    }
 
-	  if (pc->s.rebuild) {
-	    /* The shape has changed, so need to reconstruct */
-	    build_reconstruct_links(cs, cinfo, pc, map, model);
-	    if (wall) build_colloid_wall_links(cs, cinfo, pc, map, model);
-	  }
-	  else {
-	    /* Shape unchanged, so just reset existing links */
-	    build_reset_links(cs, pc, map, model);
-	  }
+    pc->sumw   = 0.0;
+    for (ia = 0; ia < 3; ia++) {
+      pc->cbar[ia] = 0.0;
+      pc->rxcbar[ia] = 0.0;
+    }
 
-	  build_count_faces_local(pc, model, &pc->s.sa, &pc->s.saf);
+    if (pc->s.rebuild) {
+      /* The shape has changed, so need to reconstruct */
+      build_reconstruct_links(cs, cinfo, pc, map, model);
+      if (wall) build_colloid_wall_links(cs, cinfo, pc, map, model);
+    }
+    else {
+      /* Shape unchanged, so just reset existing links */
+      build_reset_links(cs, pc, map, model);
+    }
 
-	  /* Next colloid */
+    build_count_faces_local(pc, model, &pc->s.sa, &pc->s.saf);
 
-	  pc->s.rebuild = 0;
-	}
+    /* Record the local sums; next colloid */
 
-	/* Next cell */
-      }
+    pc->build.sumw = pc->sumw;
+    for (ia = 0; ia < 3; ia++) {
+      pc->build.cbar[ia] = pc->cbar[ia];
+      pc->build.rxcbar[ia] = pc->rxcbar[ia];
+    }
+    pc->build.sa = pc->s.sa;
+    pc->build.saf = pc->s.saf;
+
+    pc->s.rebuild = 0;
+    pc->build.relink = 0;
+  }
+
+  /* Flat copy of the links for bbl */
+
+  colloid_link_table_build(cinfo->ltable, cinfo);
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  build_relink_flag
+ *
+ *  Any colloid with a link to a site whose status has changed at the
+ *  last (incremental) map update must have its links reset. Such a
+ *  colloid occupies a neighbouring site of the changed site.
+ *
+ *****************************************************************************/
+
+static int build_relink_flag(cs_t * cs, colloids_info_t * cinfo,
+			     const lb_model_t * model) {
+  int nlocal[3];
+  int nhalo;
+
+  assert(cs);
+  assert(cinfo);
+  assert(model);
+
+  cs_nlocal(cs, nlocal);
+  cs_nhalo(cs, &nhalo);
+
+  for (int n = 0; n < cinfo->nchanged; n++) {
+
+    int index = cinfo->map_changed[n];
+    int ijk[3] = {0};
+    colloid_t * pcold = NULL;
+    colloid_t * pcnew = NULL;
+
+    colloids_info_map_old(cinfo, index, &pcold);
+    colloids_info_map(cinfo, index, &pcnew);
+    if ((pcold == NULL) == (pcnew == NULL)) continue;
+
+    cs_index_to_ijk(cs, index, ijk);
+
+    for (int p = 1; p < model->nvel; p++) {
+      int ic = ijk[X] + model->cv[p][X];
+      int jc = ijk[Y] + model->cv[p][Y];
+      int kc = ijk[Z] + model->cv[p][Z];
+      colloid_t * pc = NULL;
+      if (ic < 1 - nhalo || ic > nlocal[X] + nhalo) continue;
+      if (jc < 1 - nhalo || jc > nlocal[Y] + nhalo) continue;
+      if (kc < 1 - nhalo || kc > nlocal[Z] + nhalo) continue;
+      colloids_info_map(cinfo, cs_index(cs, ic, jc, kc), &pc);
+      if (pc) pc->build.relink = 1;
     }
   }
 
@@ -582,8 +978,6 @@ int build_remove_replace(fe_t * fe, colloids_info_t * cinfo, lb_t * lb,
   int is_halo;
   int nlocal[3];
   int nhalo;
-  colloid_t * pcold;
-  colloid_t * pcnew;
 
   assert(lb);
   assert(cinfo);
@@ -591,43 +985,107 @@ int build_remove_replace(fe_t * fe, colloids_info_t * cinfo, lb_t * lb,
   cs_nlocal(lb->cs, nlocal);
   cs_nhalo(lb->cs, &nhalo);
 
+  if (cinfo->map_isdelta) {
+
+    /* Only the sites recorded as changed need be examined; these are
+     * taken in the same (index) order as the full loop below. */
+
+    int nunique = 0;
+
+    qsort(cinfo->map_changed, cinfo->nchanged, sizeof(int), build_index_cmp);
+
+    for (int n = 0; n < cinfo->nchanged; n++) {
+      if (n > 0 && cinfo->map_changed[n] == cinfo->map_changed[n-1]) continue;
+      cinfo->map_changed[nunique++] = cinfo->map_changed[n];
+    }
+    cinfo->nchanged = nunique;
+
+    for (int n = 0; n < cinfo->nchanged; n++) {
+      int ijk[3] = {0};
+      index = cinfo->map_changed[n];
+      cs_index_to_ijk(lb->cs, index, ijk);
+      is_halo = (ijk[X] < 1 || ijk[Y] < 1 || ijk[Z] < 1 ||
+		 ijk[X] > nlocal[X] || ijk[Y] > nlocal[Y] || ijk[Z] > nlocal[Z]);
+      build_remove_replace_site(fe, cinfo, lb, phi, p, q, psi, map, index,
+				is_halo);
+    }
+
+    return 0;
+  }
+
   for (ic = 1 - nhalo; ic <= nlocal[X] + nhalo; ic++) {
     for (jc = 1 - nhalo; jc <= nlocal[Y] + nhalo; jc++) {
       for (kc = 1 - nhalo; kc <= nlocal[Z] + nhalo; kc++) {
 
 	index = cs_index(lb->cs, ic, jc, kc);
 
-	colloids_info_map_old(cinfo, index, &pcold);
-	colloids_info_map(cinfo, index, &pcnew);
-
 	is_halo = (ic < 1 || jc < 1 || kc < 1 ||
 		   ic > nlocal[X] || jc > nlocal[Y] || kc > nlocal[Z]);
 
-	if (pcold == NULL && pcnew != NULL) {
+	build_remove_replace_site(fe, cinfo, lb, phi, p, q, psi, map, index,
+				  is_halo);
+      }
+    }
+  }
 
-	  pcnew->s.rebuild = 1;
+  return 0;
+}
 
-	  if (!is_halo) {
-	    build_remove_fluid(lb, index, pcnew);
-	    if (phi) build_remove_order_parameter(lb, phi, index, pcnew);
-	    if (psi)  psi_colloid_remove_charge(psi, pcnew, index);
-	  }
-	}
+/*****************************************************************************
+ *
+ *  build_index_cmp
+ *
+ *  Ascending order of site index for qsort().
+ *
+ *****************************************************************************/
 
-	if (pcold != NULL && pcnew == NULL) {
+static int build_index_cmp(const void * a, const void * b) {
 
-	  pcold->s.rebuild = 1;
+  int ia = *((const int *) a);
+  int ib = *((const int *) b);
 
-	  if (!is_halo) {
-	    build_replace_fluid(lb, cinfo, index, pcold, map);
-	    if (phi) build_replace_order_parameter(fe, lb, cinfo, phi, index, pcold, map);
-	    if (p) build_replace_order_parameter(fe, lb, cinfo, p, index, pcold, map);
-	    if (q) build_replace_order_parameter(fe, lb, cinfo, q, index, pcold, map);
-	    if (psi) psi_colloid_replace_charge(psi, cinfo, pcold, index);
-	  }
-	}
+  return (ia > ib) - (ia < ib);
+}
 
-      }
+/*****************************************************************************
+ *
+ *  build_remove_replace_site
+ *
+ *  Act on any change at the given site.
+ *
+ *****************************************************************************/
+
+static int build_remove_replace_site(fe_t * fe, colloids_info_t * cinfo,
+				     lb_t * lb, field_t * phi, field_t * p,
+				     field_t * q, psi_t * psi, map_t * map,
+				     int index, int is_halo) {
+  colloid_t * pcold = NULL;
+  colloid_t * pcnew = NULL;
+
+  colloids_info_map_old(cinfo, index, &pcold);
+  colloids_info_map(cinfo, index, &pcnew);
+
+  if (pcold == NULL && pcnew != NULL) {
+
+    pcnew->s.rebuild = 1;
+
+    if (!is_halo) {
+      build_remove_fluid(lb, index, pcnew);
+      if (phi) build_remove_order_parameter(lb, phi, index, pcnew);
+      if (psi)  psi_colloid_remove_charge(psi, pcnew, index);
+    }
+  }
+
+  if (pcold != NULL && pcnew == NULL) {
+
+    pcold->s.rebuild = 1;
+
+    if (!is_halo) {
+      build_replace_fluid(lb, cinfo, index, pcold, map);
+      if (phi) build_replace_order_parameter(fe, lb, cinfo, phi, index, pcold, map);
+      if (p) build_replace_order_parameter(fe, lb, cinfo, p, index, pcold, map);
+      if (q) build_replace_order_parameter(fe, lb, cinfo, q, index, pcold, map);
+      if (psi) psi_colloid_replace_charge(psi, cinfo, pcold, index);
     }
   }
 
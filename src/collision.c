@@ -34,6 +34,7 @@
 #include "control.h"
 #include "collision.h"
 #include "kernel.h"
+#include "propagation.h"
 #include "timer.h"
 
 #include "symmetric.h"
@@ -41,6 +42,21 @@
 __global__ void lb_collision_mrt1(kernel_3d_v_t k3v, lb_t * lb,
 				  hydro_t * hydro,
 				  map_t * map, noise_t * noise, fe_t * fe);
+__global__ void lb_collision_mrt1_fused(kernel_3d_v_t k3v, lb_t * lb,
+					hydro_t * hydro, map_t * map,
+					noise_t * noise, fe_t * fe);
+__global__ void lb_collision_mrt1_aa(kernel_3d_v_t k3v, lb_t * lb,
+				     hydro_t * hydro, map_t * map,
+				     noise_t * noise, fe_t * fe, int odd);
+__global__ void lb_collision_mrt1_masked(kernel_3d_v_t k3v, lb_t * lb,
+					 hydro_t * hydro, map_t * map,
+					 noise_t * noise, fe_t * fe);
+__global__ void lb_collision_mrt1_list(int nblock, lb_t * lb,
+				       hydro_t * hydro, map_t * map,
+				       noise_t * noise, fe_t * fe);
+__global__ void lb_collision_mrt1_sparse(int nblock, lb_t * lb,
+					 hydro_t * hydro, map_t * map,
+					 noise_t * noise, fe_t * fe);
 __global__ void lb_collision_mrt2(kernel_3d_v_t k3d, lb_t * lb,
 				  hydro_t * hydro,
 				  fe_symm_t * fe, noise_t * noise);
@@ -57,9 +73,21 @@ void lb_collision_fluctuations(lb_t * lb, noise_t * noise, int index,
 int lb_collision_noise_var_set(lb_t * lb, noise_t * noise);
 static __host__ int lb_collision_parameters_commit(lb_t * lb, visc_t * visc);
 
+/* Addresses for collision combined with streaming. */
+
+typedef struct lb_collide_stream_s lb_collide_stream_t;
+
+struct lb_collide_stream_s {
+  int update[NSIMDVL];      /* 0 if site is to be left alone entirely */
+  int ain[NVEL][NSIMDVL];   /* LB_ADDR() in f of (pre-collision) f_p */
+  int aout[NVEL][NSIMDVL];  /* LB_ADDR() in fout of (post-collision) f_p */
+  lb_float_t * fout;        /* lb->fprime or lb->f (in-place) */
+};
+
 static __device__
 void lb_collision_mrt1_site(lb_t * lb, hydro_t * hydro, map_t * map,
-			    noise_t * noise, fe_t * fe, const int index0);
+			    noise_t * noise, fe_t * fe, const int index0,
+			    const lb_collide_stream_t * strm);
 static __device__
 void lb_collision_mrt2_site(lb_t * lb, hydro_t * hydro, fe_symm_t * fe,
 			    noise_t * noise, const int index0);
@@ -72,7 +100,7 @@ __device__ void d3q19_mode2f_phi(double jdotc[NSIMDVL],
 				 double sphi[3][3][NSIMDVL],
 				 double phi[NSIMDVL],
 				 double jphi[3][NSIMDVL],
-				 double * f, int baseIndex);
+				 lb_float_t * f, int baseIndex);
 
 /* Additional file scope collide time constants */
 
@@ -90,6 +118,7 @@ struct collide_param_s {
 
 static __constant__ lb_collide_param_t _lbp;
 static __constant__ collide_param_t _cp;
+static __constant__ cs_param_t _csp;
 
 /* Todo. Better unit tests required for these functions. */
 
@@ -138,6 +167,10 @@ __host__ __device__ int lb_relaxation_time_ghosts_v(lb_t * lb,
  *
  *  We allow hydro to be NULL, in which case there is no hydrodynamics!
  *
+ *  If a propagation has been deferred (see lb_propagation_defer()),
+ *  the single fluid collision will stream and collide in one pass;
+ *  the result is then the usual post-collision state.
+ *
  *****************************************************************************/
 
 __host__
@@ -156,12 +189,60 @@ int lb_collide(lb_t * lb, hydro_t * hydro, map_t * map, noise_t * noise,
   lb_collision_noise_var_set(lb, noise);
   lb_collide_param_commit(lb);
 
+  assert(ndist == 1 || lb->fpending == 0);
+
   if (ndist == 1) lb_collision_mrt(lb, hydro, map, noise, fe, visc);
   if (ndist == 2) lb_collision_binary(lb, hydro, noise, (fe_symm_t *) fe, visc);
 
   return 0;
 }
 
+/*****************************************************************************
+ *
+ *  lb_collision_mrt_launch
+ *
+ *  Launch the appropriate single fluid collision kernel for the
+ *  sites in lim (part or all of the local domain).
+ *
+ *****************************************************************************/
+
+static __host__ int lb_collision_mrt_launch(lb_t * lb, hydro_t * hydro,
+					    map_t * map, noise_t * noise,
+					    fe_t * fe, cs_limits_t lim) {
+  dim3 nblk = {};
+  dim3 ntpb = {};
+  kernel_3d_v_t k3v = kernel_3d_v(lb->cs, lim, NSIMDVL);
+
+  kernel_3d_launch_param(k3v.kiterations, &nblk, &ntpb);
+
+  if (lb->opts.schedule == LB_SCHEDULE_AA) {
+    int odd = lb->fpending;
+    tdpLaunchKernel(lb_collision_mrt1_aa, nblk, ntpb, 0, 0,
+		    k3v, lb->target, hydro->target, map->target,
+		    noise, fe, odd);
+  }
+  else if (lb->opts.schedule == LB_SCHEDULE_OVERLAP) {
+    tdpLaunchKernel(lb_collision_mrt1_masked, nblk, ntpb, 0, 0,
+		    k3v, lb->target, hydro->target, map->target,
+		    noise, fe);
+  }
+  else if (lb->fpending == 0) {
+    tdpLaunchKernel(lb_collision_mrt1, nblk, ntpb, 0, 0,
+		    k3v, lb->target, hydro->target, map->target,
+		    noise, fe);
+  }
+  else {
+    tdpLaunchKernel(lb_collision_mrt1_fused, nblk, ntpb, 0, 0,
+		    k3v, lb->target, hydro->target, map->target,
+		    noise, fe);
+  }
+
+  tdpAssert(tdpPeekAtLastError());
+  tdpAssert(tdpDeviceSynchronize());
+
+  return 0;
+}
+
 /*****************************************************************************
  *
  *  lb_collision_mrt_site
@@ -182,31 +263,79 @@ __host__ int lb_collision_mrt(lb_t * lb, hydro_t * hydro, map_t * map,
 
   cs_nlocal(lb->cs, nlocal);
 
-  /* Local extent */
-  {
-    dim3 nblk = {};
-    dim3 ntpb = {};
-    cs_limits_t lim = {1, nlocal[X], 1, nlocal[Y], 1, nlocal[Z]};
-    kernel_3d_v_t k3v = kernel_3d_v(lb->cs, lim, NSIMDVL);
+  lb_collision_parameters_commit(lb, visc);
+  if (fe) fe->func->target(fe, &fetarget);
+  if (noise) noisetarget = noise->target;
 
-    kernel_3d_launch_param(k3v.kiterations, &nblk, &ntpb);
+  TIMER_start(TIMER_COLLIDE_KERNEL);
 
-    lb_collision_parameters_commit(lb, visc);
-    if (fe) fe->func->target(fe, &fetarget);
-    if (noise) noisetarget = noise->target;
+  tdpMemcpyToSymbol(tdpSymbol(_csp), lb->cs->param, sizeof(cs_param_t),
+		    0, tdpMemcpyHostToDevice);
+
+  if (lb->opts.schedule == LB_SCHEDULE_OVERLAP) {
+    /* Collide the outermost layer of sites first, post the halo
+     * exchange, and then collide the interior while messages are
+     * in flight. Completion is lb_halo_wait(). */
+    cs_limits_t lim = {1, nlocal[X], 1, nlocal[Y], 1, nlocal[Z]};
+    cs_limits_t interior = cs_limits_interior(lim, 1);
+    cs_limits_t shell[6] = {0};
+    int nshell = cs_limits_shell(lim, 1, shell);
 
+    for (int n = 0; n < nshell; n++) {
+      lb_collision_mrt_launch(lb, hydro, map, noisetarget, fetarget,
+			      shell[n]);
+    }
+
+    TIMER_stop(TIMER_COLLIDE_KERNEL);
+    lb_halo_post(lb, &lb->h);
     TIMER_start(TIMER_COLLIDE_KERNEL);
 
-    tdpLaunchKernel(lb_collision_mrt1, nblk, ntpb, 0, 0,
-		    k3v, lb->target, hydro->target, map->target,
+    if (interior.imin <= interior.imax && interior.jmin <= interior.jmax &&
+	interior.kmin <= interior.kmax) {
+      lb_collision_mrt_launch(lb, hydro, map, noisetarget, fetarget,
+			      interior);
+    }
+
+    TIMER_stop(TIMER_COLLIDE_KERNEL);
+    lb_halo_wait(lb, &lb->h);
+  }
+  else if (lb->block && lb->fpending == 0) {
+    /* Fluid blocks only */
+    dim3 nblk = {};
+    dim3 ntpb = {};
+    void (* kernel) (int, lb_t *, hydro_t *, map_t *, noise_t *, fe_t *);
+
+    kernel = lb_collision_mrt1_list;
+    if (lb->slot) kernel = lb_collision_mrt1_sparse;
+
+    kernel_3d_launch_param(lb->nblock, &nblk, &ntpb);
+
+    tdpLaunchKernel(kernel, nblk, ntpb, 0, 0,
+		    lb->nblock, lb->target, hydro->target, map->target,
 		    noisetarget, fetarget);
 
     tdpAssert(tdpPeekAtLastError());
     tdpAssert(tdpDeviceSynchronize());
-
+    TIMER_stop(TIMER_COLLIDE_KERNEL);
+  }
+  else {
+    /* Local extent */
+    cs_limits_t lim = {1, nlocal[X], 1, nlocal[Y], 1, nlocal[Z]};
+    lb_collision_mrt_launch(lb, hydro, map, noisetarget, fetarget, lim);
     TIMER_stop(TIMER_COLLIDE_KERNEL);
   }
 
+  if (lb->opts.schedule == LB_SCHEDULE_AA) {
+    /* Even steps leave propagation pending; odd steps complete it
+     * (subject to lb_halo_reverse()). */
+    lb->fpending = 1 - lb->fpending;
+  }
+  else if (lb->fpending) {
+    /* Result is in fprime */
+    lb_model_swapf(lb);
+    lb->fpending = 0;
+  }
+
   return 0;
 }
 
@@ -226,7 +355,234 @@ __global__ void lb_collision_mrt1(kernel_3d_v_t k3v, lb_t * lb,
 
   for_simt_parallel(kindex, k3v.kiterations, NSIMDVL) {
     int index0 = k3v.kindex0 + kindex;
-    lb_collision_mrt1_site(lb, hydro, map, noise, fe, index0);
+    lb_collision_mrt1_site(lb, hydro, map, noise, fe, index0, NULL);
+  }
+
+  return;
+}
+
+/*****************************************************************************
+ *
+ *  lb_collision_mrt1_list
+ *
+ *  As lb_collision_mrt1(), but visiting only the SIMD blocks in
+ *  the fluid list lb->block (see lb_data_fluid_list()).
+ *
+ *****************************************************************************/
+
+__global__ void lb_collision_mrt1_list(int nblock, lb_t * lb,
+				       hydro_t * hydro, map_t * map,
+				       noise_t * noise, fe_t * fe) {
+  int ib = 0;
+
+  for_simt_parallel(ib, nblock, 1) {
+    int index0 = lb->block[ib];
+    lb_collision_mrt1_site(lb, hydro, map, noise, fe, index0, NULL);
+  }
+
+  return;
+}
+
+/*****************************************************************************
+ *
+ *  lb_collision_mrt1_sparse
+ *
+ *  As lb_collision_mrt1_list(), but for sparse storage (see
+ *  lb_data_sparse()). The update is in place at the stored location;
+ *  lanes which are not local fluid sites are left alone, and just
+ *  load a harmless (valid) address.
+ *
+ *****************************************************************************/
+
+__global__ void lb_collision_mrt1_sparse(int nblock, lb_t * lb,
+					 hydro_t * hydro, map_t * map,
+					 noise_t * noise, fe_t * fe) {
+  int ib = 0;
+
+  for_simt_parallel(ib, nblock, 1) {
+
+    int iv = 0;
+    int index0 = lb->block[ib];
+    lb_collide_stream_t strm = {.fout = lb->f};
+
+    for_simd_v(iv, NSIMDVL) {
+      int is = lb->slot[index0 + iv];
+      strm.update[iv] = (0 <= is && is < lb->nfluid);
+    }
+
+    for (int p = 0; p < NVEL; p++) {
+      for_simd_v(iv, NSIMDVL) {
+	int is = (strm.update[iv]) ? lb->slot[index0 + iv] : 0;
+	strm.ain[p][iv]  = LB_ADDR(lb->nslot, 1, NVEL, is, LB_RHO, p);
+	strm.aout[p][iv] = strm.ain[p][iv];
+      }
+    }
+
+    lb_collision_mrt1_site(lb, hydro, map, noise, fe, index0, &strm);
+  }
+
+  return;
+}
+
+/*****************************************************************************
+ *
+ *  lb_collision_mrt1_masked
+ *
+ *  As lb_collision_mrt1(), but sites in the SIMD vector which fall
+ *  outside k3v.lim are left alone entirely. This allows the local
+ *  domain to be updated in separate parts (see the overlap schedule)
+ *  without any site being collided twice.
+ *
+ *****************************************************************************/
+
+__global__ void lb_collision_mrt1_masked(kernel_3d_v_t k3v, lb_t * lb,
+					 hydro_t * hydro, map_t * map,
+					 noise_t * noise, fe_t * fe) {
+  int kindex = 0;
+
+  for_simt_parallel(kindex, k3v.kiterations, NSIMDVL) {
+
+    int iv = 0;
+    int ic[NSIMDVL];
+    int jc[NSIMDVL];
+    int kc[NSIMDVL];
+    int maskv[NSIMDVL];
+    int index0 = k3v.kindex0 + kindex;
+    lb_collide_stream_t strm = {.fout = lb->f};
+
+    kernel_3d_v_coords(&k3v, kindex, ic, jc, kc);
+    kernel_3d_v_mask(&k3v, ic, jc, kc, maskv);
+
+    for_simd_v(iv, NSIMDVL) strm.update[iv] = maskv[iv];
+
+    for (int p = 0; p < NVEL; p++) {
+      for_simd_v(iv, NSIMDVL) {
+	int index = index0 + iv;
+	strm.ain[p][iv]  = LB_ADDR(_lbp.nsite, 1, NVEL, index, LB_RHO, p);
+	strm.aout[p][iv] = strm.ain[p][iv];
+      }
+    }
+
+    lb_collision_mrt1_site(lb, hydro, map, noise, fe, index0, &strm);
+  }
+
+  return;
+}
+
+/*****************************************************************************
+ *
+ *  lb_collision_mrt1_fused
+ *
+ *  As lb_collision_mrt1(), but the distributions are first pulled
+ *  from the neighbouring sites (i.e., propagation of the previous
+ *  post-collision state), and the result is written to fprime.
+ *  The caller is responsible for swapping f and fprime.
+ *
+ *  The pull is the same as lb_propagation_kernel(): halo sites
+ *  appearing in a SIMD vector are masked and just copied.
+ *
+ *****************************************************************************/
+
+__global__ void lb_collision_mrt1_fused(kernel_3d_v_t k3v, lb_t * lb,
+					hydro_t * hydro, map_t * map,
+					noise_t * noise, fe_t * fe) {
+  int kindex = 0;
+
+  for_simt_parallel(kindex, k3v.kiterations, NSIMDVL) {
+
+    int iv = 0;
+    int ic[NSIMDVL];
+    int jc[NSIMDVL];
+    int kc[NSIMDVL];
+    int maskv[NSIMDVL];
+    int index0 = k3v.kindex0 + kindex;
+    lb_collide_stream_t strm = {.fout = lb->fprime};
+
+    kernel_3d_v_coords(&k3v, kindex, ic, jc, kc);
+    kernel_3d_v_mask(&k3v, ic, jc, kc, maskv);
+
+    for_simd_v(iv, NSIMDVL) strm.update[iv] = 1;
+
+    for (int p = 0; p < NVEL; p++) {
+      int dp = _lbp.cv[p][X]*_csp.str[X] + _lbp.cv[p][Y]*_csp.str[Y]
+	     + _lbp.cv[p][Z]*_csp.str[Z];
+      for_simd_v(iv, NSIMDVL) {
+	int indexp = index0 + iv - maskv[iv]*dp;
+	strm.ain[p][iv]  = LB_ADDR(_lbp.nsite, 1, NVEL, indexp, LB_RHO, p);
+	strm.aout[p][iv] = LB_ADDR(_lbp.nsite, 1, NVEL, index0 + iv, LB_RHO, p);
+      }
+    }
+
+    lb_collision_mrt1_site(lb, hydro, map, noise, fe, index0, &strm);
+  }
+
+  return;
+}
+
+/*****************************************************************************
+ *
+ *  lb_collision_mrt1_aa
+ *
+ *  In-place streaming ("AA pattern") with no second copy fprime.
+ *
+ *  Even steps: read f_p at the current site x, collide, and write
+ *  the result back to x, but in the slot of the opposite velocity
+ *  -p. There is no propagation.
+ *
+ *  Odd steps: read f_p from slot -p at x - c_p (the post-collision
+ *  value from the even step, so propagating in), collide, and
+ *  write to slot p at x + c_p (propagating out). The locations
+ *  read and written by one site are the same, so the update is
+ *  safe in place. Halo sites appearing in the SIMD vector are not
+ *  touched; contributions written to the halo must be returned
+ *  to the owning process via lb_halo_reverse().
+ *
+ *  After an odd step, f is in the usual order and propagated.
+ *
+ *****************************************************************************/
+
+__global__ void lb_collision_mrt1_aa(kernel_3d_v_t k3v, lb_t * lb,
+				     hydro_t * hydro, map_t * map,
+				     noise_t * noise, fe_t * fe, int odd) {
+  int kindex = 0;
+
+  for_simt_parallel(kindex, k3v.kiterations, NSIMDVL) {
+
+    int iv = 0;
+    int ic[NSIMDVL];
+    int jc[NSIMDVL];
+    int kc[NSIMDVL];
+    int maskv[NSIMDVL];
+    int index0 = k3v.kindex0 + kindex;
+    lb_collide_stream_t strm = {.fout = lb->f};
+
+    kernel_3d_v_coords(&k3v, kindex, ic, jc, kc);
+    kernel_3d_v_mask(&k3v, ic, jc, kc, maskv);
+
+    for_simd_v(iv, NSIMDVL) strm.update[iv] = (odd) ? maskv[iv] : 1;
+
+    for (int p = 0; p < NVEL; p++) {
+      int pbar = (p == 0) ? 0 : _lbp.nvel - p;
+      int dp = _lbp.cv[p][X]*_csp.str[X] + _lbp.cv[p][Y]*_csp.str[Y]
+	     + _lbp.cv[p][Z]*_csp.str[Z];
+      if (odd) {
+	for_simd_v(iv, NSIMDVL) {
+	  int indexin  = index0 + iv - maskv[iv]*dp;
+	  int indexout = index0 + iv + maskv[iv]*dp;
+	  strm.ain[p][iv]  = LB_ADDR(_lbp.nsite, 1, NVEL, indexin, LB_RHO, pbar);
+	  strm.aout[p][iv] = LB_ADDR(_lbp.nsite, 1, NVEL, indexout, LB_RHO, p);
+	}
+      }
+      else {
+	for_simd_v(iv, NSIMDVL) {
+	  int index = index0 + iv;
+	  strm.ain[p][iv]  = LB_ADDR(_lbp.nsite, 1, NVEL, index, LB_RHO, p);
+	  strm.aout[p][iv] = LB_ADDR(_lbp.nsite, 1, NVEL, index, LB_RHO, pbar);
+	}
+      }
+    }
+
+    lb_collision_mrt1_site(lb, hydro, map, noise, fe, index0, &strm);
   }
 
   return;
@@ -249,11 +605,17 @@ __global__ void lb_collision_mrt1(kernel_3d_v_t k3v, lb_t * lb,
  *  body force present). The stress modes, and ghost modes, are
  *  relaxed toward their equilibrium values.
  *
+ *  If strm is NULL, the distributions are read from, and written
+ *  back to, f at the current sites. Otherwise, strm provides the
+ *  addresses to combine the collision with propagation. Non-fluid
+ *  sites are then propagated without collision.
+ *
  *****************************************************************************/
 
 static __device__
 void lb_collision_mrt1_site(lb_t * lb, hydro_t * hydro, map_t * map,
-			    noise_t * noise, fe_t * fe, const int index0) {
+			    noise_t * noise, fe_t * fe, const int index0,
+			    const lb_collide_stream_t * strm) {
 
   int p, m;                               /* velocity index */
   int ia, ib;                             /* indices ("alphabeta") */
@@ -298,6 +660,15 @@ void lb_collision_mrt1_site(lb_t * lb, hydro_t * hydro, map_t * map,
     }
   }
 
+  if (strm) {
+    for_simd_v(iv, NSIMDVL) {
+      if (strm->update[iv] == 0) {
+	includeSite[iv] = 0;
+	fullchunk = 0;
+      }
+    }
+  }
+
   for (ia = 0; ia < 3; ia++) {
     for_simd_v(iv, NSIMDVL) u[ia][iv] = 0.0;
   }
@@ -316,9 +687,28 @@ void lb_collision_mrt1_site(lb_t * lb, hydro_t * hydro, map_t * map,
 
   /* Load SIMD vectors for distribution and force */
 
-  for (p = 0; p < NVEL; p++) {
-    for_simd_v(iv, NSIMDVL) fchunk[p*NSIMDVL+iv] =
-      lb->f[ LB_ADDR(_lbp.nsite, 1, NVEL, index0 + iv, LB_RHO, p) ];
+  if (strm == NULL) {
+    for (p = 0; p < NVEL; p++) {
+      for_simd_v(iv, NSIMDVL) fchunk[p*NSIMDVL+iv] = _lbp.fshift[p] +
+	lb->f[ LB_ADDR(_lbp.nsite, 1, NVEL, index0 + iv, LB_RHO, p) ];
+    }
+  }
+  else {
+    for (p = 0; p < NVEL; p++) {
+      for_simd_v(iv, NSIMDVL) fchunk[p*NSIMDVL+iv] = _lbp.fshift[p] +
+	lb->f[strm->ain[p][iv]];
+    }
+    /* Sites with no collision are propagated now, as the locations
+     * may be overwritten for in-place update. */
+    if (fullchunk == 0) {
+      for_simd_v(iv, NSIMDVL) {
+	if (includeSite[iv] == 0 && strm->update[iv]) {
+	  for (p = 0; p < NVEL; p++) {
+	    strm->fout[strm->aout[p][iv]] = fchunk[p*NSIMDVL+iv] - _lbp.fshift[p];
+	  }
+	}
+      }
+    }
   }
 
   for (ia = 0; ia < 3; ia++) {
@@ -557,9 +947,19 @@ void lb_collision_mrt1_site(lb_t * lb, hydro_t * hydro, map_t * map,
 
   if (fullchunk) {
     /* distribution */
-    for (p = 0; p < NVEL; p++) {
-      for_simd_v(iv, NSIMDVL) {
-	lb->f[LB_ADDR(_lbp.nsite, _lbp.ndist, NVEL, index0+iv, LB_RHO, p)] = fchunk[p*NSIMDVL+iv];
+    if (strm == NULL) {
+      for (p = 0; p < NVEL; p++) {
+	for_simd_v(iv, NSIMDVL) {
+	  lb->f[LB_ADDR(_lbp.nsite, _lbp.ndist, NVEL, index0+iv, LB_RHO, p)] =
+	    fchunk[p*NSIMDVL+iv] - _lbp.fshift[p];
+	}
+      }
+    }
+    else {
+      for (p = 0; p < NVEL; p++) {
+	for_simd_v(iv, NSIMDVL) {
+	  strm->fout[strm->aout[p][iv]] = fchunk[p*NSIMDVL+iv] - _lbp.fshift[p];
+	}
       }
     }
     /* density */
@@ -578,8 +978,13 @@ void lb_collision_mrt1_site(lb_t * lb, hydro_t * hydro, map_t * map,
       if (includeSite[iv]) {
 	/* distribution */
 	for (p = 0; p < NVEL; p++) {
-	  lb->f[LB_ADDR(_lbp.nsite, _lbp.ndist, NVEL, index0 + iv, LB_RHO, p)]
-	    = fchunk[p*NSIMDVL+iv];
+	  int laddr = LB_ADDR(_lbp.nsite, _lbp.ndist, NVEL, index0 + iv, LB_RHO, p);
+	  if (strm == NULL) {
+	    lb->f[laddr] = fchunk[p*NSIMDVL+iv] - _lbp.fshift[p];
+	  }
+	  else {
+	    strm->fout[strm->aout[p][iv]] = fchunk[p*NSIMDVL+iv] - _lbp.fshift[p];
+	  }
 	}
 	/* velocity */
 	for (ia = 0; ia < 3; ia++) {
@@ -2860,7 +3265,7 @@ __device__ void d3q19_mode2f_phi(double jdotc[NSIMDVL],
 				 double sphi[3][3][NSIMDVL],
 				 double phi[NSIMDVL],
 				 double jphi[3][NSIMDVL],
-				 double * f, int baseIndex){
+				 lb_float_t * f, int baseIndex){
 
   int iv=0;
   LB_RCS2_DOUBLE(rcs2);
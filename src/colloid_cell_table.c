@@ -0,0 +1,205 @@
+/*****************************************************************************
+ *
+ *  colloid_cell_table.c
+ *
+ *  A flat copy of the colloid cell list. Pointers to the colloids
+ *  (including those in halo cells) are held contiguously in order of
+ *  linear cell index, and in the order of the linked list within each
+ *  cell, so traversal order is exactly that of the cell list. The
+ *  colloids in cell n are pc[start[n]] to pc[start[n+1] - 1].
+ *
+ *  The colloid_t objects themselves are not moved (their addresses
+ *  are held by the map, bonds and lists), so a consumer which needs
+ *  more than the table holds still dereferences each colloid. Copies
+ *  of the index, the hydrodynamic radius, and the position are held
+ *  alongside, so that searches over neighbouring cells (the pair list)
+ *  can stream through memory without reference to the colloid_t.
+ *
+ *  The other consumers (map and link construction in build.c, the
+ *  sums in colloid_sums.c, and the halo exchange) read and write most
+ *  of the colloid state, so they use the table for traversal order
+ *  only, and the colloid data are not held contiguously for them.
+ *
+ *  The linked lists remain the primary data structure: the table
+ *  is rebuilt from them when the cell list version has changed,
+ *  which is checked by colloids_info_cell_table(). Positions are
+ *  only refreshed on a rebuild, or an explicit call to
+ *  colloid_cell_table_positions().
+ *
+ *  Edinburgh Soft Matter and Statistical Physics Group and
+ *  Edinburgh Parallel Computing Centre
+ *
+ *  (c) 2024 The University of Edinburgh
+ *
+ *  Kevin Stratford (kevin@epcc.ed.ac.uk)
+ *
+ *****************************************************************************/
+
+#include <assert.h>
+#include <stdlib.h>
+
+#include "colloid_cell_table.h"
+
+static int colloid_cell_table_reserve(colloid_cell_table_t * table,
+				      int nall);
+
+/*****************************************************************************
+ *
+ *  colloid_cell_table_create
+ *
+ *****************************************************************************/
+
+__host__ int colloid_cell_table_create(pe_t * pe, int ncells,
+				       colloid_cell_table_t ** table) {
+
+  colloid_cell_table_t * obj = NULL;
+
+  assert(pe);
+  assert(ncells > 0);
+  assert(table);
+
+  obj = (colloid_cell_table_t *) calloc(1, sizeof(colloid_cell_table_t));
+  assert(obj);
+  if (obj == NULL) pe_fatal(pe, "calloc(colloid_cell_table_t) failed\n");
+
+  obj->start = (int *) calloc(ncells + 1, sizeof(int));
+  assert(obj->start);
+  if (obj->start == NULL) pe_fatal(pe, "calloc(cell table start) failed\n");
+
+  obj->pe = pe;
+  obj->ncells = ncells;
+
+  *table = obj;
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  colloid_cell_table_free
+ *
+ *****************************************************************************/
+
+__host__ void colloid_cell_table_free(colloid_cell_table_t * table) {
+
+  assert(table);
+
+  free(table->r);
+  free(table->ah);
+  free(table->index);
+  free(table->pc);
+  free(table->start);
+  free(table);
+
+  return;
+}
+
+/*****************************************************************************
+ *
+ *  colloid_cell_table_reserve
+ *
+ *  Make sure there is room for at least nall colloids. Existing
+ *  contents are not retained if the table is reallocated.
+ *
+ *****************************************************************************/
+
+static int colloid_cell_table_reserve(colloid_cell_table_t * table,
+				      int nall) {
+  assert(table);
+
+  if (table->pc == NULL || nall > table->nallmax) {
+    int nmax = nall + nall/4 + 1;
+
+    free(table->r);
+    free(table->ah);
+    free(table->index);
+    free(table->pc);
+
+    table->pc    = (colloid_t **) malloc(nmax*sizeof(colloid_t *));
+    table->index = (int *) malloc(nmax*sizeof(int));
+    table->ah    = (double *) malloc(nmax*sizeof(double));
+    table->r     = (double *) malloc(3*nmax*sizeof(double));
+
+    if (table->pc == NULL || table->index == NULL || table->ah == NULL ||
+	table->r == NULL) {
+      pe_fatal(table->pe, "malloc(colloid_cell_table_t) failed\n");
+    }
+
+    table->nallmax = nmax;
+  }
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  colloid_cell_table_update
+ *
+ *  Rebuild the table if the cell list has changed since the last
+ *  build. Cells are visited in order of linear index.
+ *
+ *****************************************************************************/
+
+__host__ int colloid_cell_table_update(colloid_cell_table_t * table,
+				       colloids_info_t * cinfo) {
+  int nall = 0;
+
+  assert(table);
+  assert(cinfo);
+  assert(table->ncells == cinfo->ncells);
+
+  if (table->nbuild > 0 && table->version == cinfo->clist_version) {
+    return 0;
+  }
+
+  for (int n = 0; n < cinfo->ncells; n++) {
+    for (colloid_t * pc = cinfo->clist[n]; pc; pc = pc->next) nall += 1;
+  }
+
+  colloid_cell_table_reserve(table, nall);
+
+  nall = 0;
+
+  for (int n = 0; n < cinfo->ncells; n++) {
+    table->start[n] = nall;
+    for (colloid_t * pc = cinfo->clist[n]; pc; pc = pc->next) {
+      table->pc[nall] = pc;
+      table->index[nall] = pc->s.index;
+      table->ah[nall] = pc->s.ah;
+      nall += 1;
+    }
+  }
+  table->start[cinfo->ncells] = nall;
+  table->nall = nall;
+
+  colloid_cell_table_positions(table);
+
+  table->version = cinfo->clist_version;
+  table->nbuild += 1;
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  colloid_cell_table_positions
+ *
+ *  Refresh the copy of the positions (which change at each step
+ *  without necessarily changing the cell list).
+ *
+ *****************************************************************************/
+
+__host__ int colloid_cell_table_positions(colloid_cell_table_t * table) {
+
+  assert(table);
+
+  #pragma omp parallel for
+  for (int n = 0; n < table->nall; n++) {
+    const colloid_t * pc = table->pc[n];
+    table->r[3*n + X] = pc->s.r[X];
+    table->r[3*n + Y] = pc->s.r[Y];
+    table->r[3*n + Z] = pc->s.r[Z];
+  }
+
+  return 0;
+}
@@ -0,0 +1,47 @@
+/*****************************************************************************
+ *
+ *  colloid_cell_table.h
+ *
+ *  Edinburgh Soft Matter and Statistical Physics Group and
+ *  Edinburgh Parallel Computing Centre
+ *
+ *  (c) 2024 The University of Edinburgh
+ *
+ *  Kevin Stratford (kevin@epcc.ed.ac.uk)
+ *
+ *****************************************************************************/
+
+#ifndef LUDWIG_COLLOID_CELL_TABLE_H
+#define LUDWIG_COLLOID_CELL_TABLE_H
+
+#include "pe.h"
+#include "colloids.h"
+
+typedef struct colloid_cell_table_s colloid_cell_table_t;
+
+struct colloid_cell_table_s {
+
+  int ncells;                     /* Number of cells (including halo) */
+  int nall;                       /* Number of colloids (including halo) */
+  int nallmax;                    /* Capacity (colloids) */
+
+  int * start;                    /* Cell n has start[n]..[n+1]-1 */
+  colloid_t ** pc;                /* Pointers in cell list order */
+  int * index;                    /* Colloid index */
+  double * ah;                    /* Hydrodynamic radius */
+  double * r;                     /* Position r[3*n + ia] at last sync */
+
+  unsigned int version;           /* Cell list version at last build */
+  int nbuild;                     /* Number of builds */
+
+  pe_t * pe;                      /* Parallel environment */
+};
+
+__host__ int colloid_cell_table_create(pe_t * pe, int ncells,
+				       colloid_cell_table_t ** table);
+__host__ void colloid_cell_table_free(colloid_cell_table_t * table);
+__host__ int colloid_cell_table_update(colloid_cell_table_t * table,
+				       colloids_info_t * cinfo);
+__host__ int colloid_cell_table_positions(colloid_cell_table_t * table);
+
+#endif
@@ -4,6 +4,21 @@
  *
  *  Colloid parallel I/O driver.
  *
+ *  The default is one file per I/O group, with the ranks in each group
+ *  aggregating to the group root which writes.
+ *
+ *  If the "mpiio" format is selected, all ranks write their own
+ *  records directly to a single binary file using a collective
+ *  MPI_File_write_at_all(): the file offset for each rank is the
+ *  prefix sum of the local number of colloids. The file layout is
+ *  the same as the "binary" format with a single file (an int header
+ *  with the total number of colloids followed by the colloid_state_t
+ *  records), so it can also be read by the "binary_serial" input.
+ *  A json metadata file is written alongside.
+ *
+ *  The matching read has each rank read a contiguous block of records,
+ *  followed by a redistribution to the owning rank based on position.
+ *
  *  Edinburgh Soft Matter and Statistical Physics Group and
  *  Edinburgh Parallel Computing Centre
  *
@@ -15,6 +30,7 @@
  *****************************************************************************/
 
 #include <assert.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -22,7 +38,10 @@
 #include "pe.h"
 #include "coords.h"
 #include "colloid_io.h"
+#include "io_element.h"
+#include "util.h"
 #include "util_fopen.h"
+#include "util_json.h"
 
 struct colloid_io_s {
   int n_io;                      /* Number of parallel IO group */
@@ -30,6 +49,8 @@ struct colloid_io_s {
   int index;                     /* Index of current IO group */
   int rank;                      /* Rank of PE in IO group */
   int single_file_read;          /* 'serial' input flag */
+  int mpiio_read;                /* Collective MPI-IO input flag */
+  int mpiio_write;               /* Collective MPI-IO output flag */
   int nd[3];                     /* Cartesian dimensions */
   int coords[3];                 /* Cartesian position of this group */
 
@@ -67,6 +88,13 @@ static int colloid_io_write_list_binary(colloid_io_t * cio,
 static int colloid_io_filename(colloid_io_t * cio, char * filename,
 			       const char * stub);
 static int colloid_io_check_read(colloid_io_t * cio, int ngroup);
+static int colloid_io_write_mpiio(colloid_io_t * cio, const char * filename);
+static int colloid_io_read_mpiio(colloid_io_t * cio, const char * filename,
+				 int * ntotal);
+static int colloid_io_write_metadata(colloid_io_t * cio, const char * stub,
+				     int ntotal);
+static int colloid_io_redistribute(colloid_io_t * cio, int nc,
+				   colloid_state_t * buf);
 
 /*****************************************************************************
  *
@@ -196,6 +224,8 @@ int colloid_io_info(colloid_io_t * cio) {
   strcpy(fout, "unset");
   if (cio->f_header_write == colloid_io_write_header_ascii) strcpy(fout, "ascii");
   if (cio->f_header_write == colloid_io_write_header_binary) strcpy(fout, "binary");
+  if (cio->mpiio_read) strcpy(fin, "mpiio (binary single file)");
+  if (cio->mpiio_write) strcpy(fout, "mpiio (binary single file)");
 
   pe_info(cio->pe, "\n");
   pe_info(cio->pe, "Colloid I/O settings\n");
@@ -263,6 +293,8 @@ int colloid_io_write(colloid_io_t * cio, const char * filename) {
   colloids_info_ntotal(cio->info, &ntotal);
   if (ntotal == 0) return 0;
 
+  if (cio->mpiio_write) return colloid_io_write_mpiio(cio, filename);
+
   assert(cio->f_header_write);
   assert(cio->f_buffer_write);
 
@@ -438,34 +470,42 @@ int colloid_io_read(colloid_io_t * cio, const char * filename) {
   assert(cio->f_header_read);
   assert(cio->f_list_read);
 
-  /* Set the filename from the stub and the extension */
-
-  colloid_io_filename(cio, filename_io, filename);
-
-  if (cio->single_file_read) {
-    /* All groups read for single 'serial' file */
-    snprintf(filename_io, FILENAME_MAX-1, "%s.%3.3d-%3.3d", filename, 1, 1);
-    pe_info(cio->pe, "colloid_io_read: reading from single file %s\n",
-	    filename_io);
+  if (cio->mpiio_read) {
+    colloid_io_read_mpiio(cio, filename, &ngroup);
   }
   else {
-    pe_info(cio->pe, "colloid_io_read: reading from %s etc\n", filename_io);
-  }
 
-  /* Open the file and read the information */
+    /* Set the filename from the stub and the extension */
 
-  fp_state = util_fopen(filename_io, "r");
-  if (fp_state == NULL) pe_fatal(cio->pe, "Failed to open %s\n", filename_io);
+    colloid_io_filename(cio, filename_io, filename);
 
-  cio->f_header_read(fp_state, &ngroup);
-  cio->f_list_read(cio, ngroup, fp_state);
+    if (cio->single_file_read) {
+      /* All groups read for single 'serial' file */
+      snprintf(filename_io, FILENAME_MAX-1, "%s.%3.3d-%3.3d", filename, 1, 1);
+      pe_info(cio->pe, "colloid_io_read: reading from single file %s\n",
+	      filename_io);
+    }
+    else {
+      pe_info(cio->pe, "colloid_io_read: reading from %s etc\n", filename_io);
+    }
 
-  if (ferror(fp_state)) {
-    perror("perror: ");
-    pe_fatal(cio->pe, "Error on reading %s\n", filename_io);
-  }
+    /* Open the file and read the information */
 
-  fclose(fp_state);
+    fp_state = util_fopen(filename_io, "r");
+    if (fp_state == NULL) {
+      pe_fatal(cio->pe, "Failed to open %s\n", filename_io);
+    }
+
+    cio->f_header_read(fp_state, &ngroup);
+    cio->f_list_read(cio, ngroup, fp_state);
+
+    if (ferror(fp_state)) {
+      perror("perror: ");
+      pe_fatal(cio->pe, "Error on reading %s\n", filename_io);
+    }
+
+    fclose(fp_state);
+  }
 
   colloid_io_check_read(cio, ngroup);
   {
@@ -678,6 +718,7 @@ int colloid_io_format_input_ascii_set(colloid_io_t * cio) {
 
   assert(cio);
 
+  cio->mpiio_read    = 0;
   cio->f_header_read = colloid_io_read_header_ascii;
   cio->f_list_read   = colloid_io_read_list_ascii;
 
@@ -694,6 +735,7 @@ int colloid_io_format_input_binary_set(colloid_io_t * cio) {
 
   assert(cio);
 
+  cio->mpiio_read    = 0;
   cio->f_header_read = colloid_io_read_header_binary;
   cio->f_list_read   = colloid_io_read_list_binary;
 
@@ -715,6 +757,24 @@ int colloid_io_format_input_serial_set(colloid_io_t * cio) {
   return 0;
 }
 
+/*****************************************************************************
+ *
+ *  colloid_io_format_input_mpiio_set
+ *
+ *  Collective read from a single binary file.
+ *
+ *****************************************************************************/
+
+int colloid_io_format_input_mpiio_set(colloid_io_t * cio) {
+
+  assert(cio);
+
+  colloid_io_format_input_binary_set(cio);
+  cio->mpiio_read = 1;
+
+  return 0;
+}
+
 /*****************************************************************************
  *
  *  colloid_io_format_output_ascii_set
@@ -725,6 +785,7 @@ int colloid_io_format_output_ascii_set(colloid_io_t * cio) {
 
   assert(cio);
 
+  cio->mpiio_write    = 0;
   cio->f_buffer_write = colloid_io_write_buffer_ascii;
   cio->f_header_write = colloid_io_write_header_ascii;
   cio->f_list_write   = colloid_io_write_list_ascii;
@@ -740,6 +801,9 @@ int colloid_io_format_output_ascii_set(colloid_io_t * cio) {
 
 int colloid_io_format_output_binary_set(colloid_io_t * cio) {
 
+  assert(cio);
+
+  cio->mpiio_write    = 0;
   cio->f_buffer_write = colloid_io_write_buffer_binary;
   cio->f_header_write = colloid_io_write_header_binary;
   cio->f_list_write   = colloid_io_write_list_binary;
@@ -747,6 +811,24 @@ int colloid_io_format_output_binary_set(colloid_io_t * cio) {
   return 0;
 }
 
+/*****************************************************************************
+ *
+ *  colloid_io_format_output_mpiio_set
+ *
+ *  Collective write to a single binary file.
+ *
+ *****************************************************************************/
+
+int colloid_io_format_output_mpiio_set(colloid_io_t * cio) {
+
+  assert(cio);
+
+  colloid_io_format_output_binary_set(cio);
+  cio->mpiio_write = 1;
+
+  return 0;
+}
+
 /*****************************************************************************
  *
  *  colloid_io_filename
@@ -795,7 +877,7 @@ static int colloid_io_check_read(colloid_io_t * cio, int ngroup) {
 
   MPI_Reduce(&nlocal, &ntotal, 1, MPI_INT, MPI_SUM, 0, cio->comm);
 
-  if (cio->single_file_read) {
+  if (cio->single_file_read || cio->mpiio_read) {
     /* Only the global total can be compared (ngroup is ntotal). */
     nlocal = ntotal;
     MPI_Allreduce(&nlocal, &ntotal, 1, MPI_INT, MPI_SUM, cio->xcomm);
@@ -815,3 +897,356 @@ static int colloid_io_check_read(colloid_io_t * cio, int ngroup) {
 
   return 0;
 }
+
+/*****************************************************************************
+ *
+ *  colloid_io_write_mpiio
+ *
+ *  All ranks write their local colloids to a single file. The offset
+ *  for each rank is the exclusive prefix sum of the local count; rank
+ *  zero also writes the header (the total).
+ *
+ *****************************************************************************/
+
+static int colloid_io_write_mpiio(colloid_io_t * cio, const char * filename) {
+
+  int ifail = 0;
+  int rank = -1;
+  int nlocal = 0;
+  int ntotal = 0;
+  int64_t nc = 0;
+  int64_t nstart = 0;
+  char filename_io[FILENAME_MAX] = {0};
+
+  colloid_state_t * cbuf = NULL;
+  MPI_Comm comm = MPI_COMM_NULL;
+  MPI_Datatype record = MPI_DATATYPE_NULL;
+  MPI_File fh = MPI_FILE_NULL;
+  MPI_Info info = MPI_INFO_NULL;
+  MPI_Offset disp = 0;
+
+  assert(cio);
+  assert(filename);
+
+  cs_cart_comm(cio->cs, &comm);
+  MPI_Comm_rank(comm, &rank);
+
+  colloids_info_nlocal(cio->info, &nlocal);
+  MPI_Allreduce(&nlocal, &ntotal, 1, MPI_INT, MPI_SUM, comm);
+
+  /* Offset of this rank's first record (zero at rank 0) */
+
+  nc = nlocal;
+  MPI_Exscan(&nc, &nstart, 1, MPI_INT64_T, MPI_SUM, comm);
+  if (rank == 0) nstart = 0;
+
+  snprintf(filename_io, FILENAME_MAX-1, "%s.%3.3d-%3.3d", filename, 1, 1);
+
+  pe_info(cio->pe, "\n");
+  pe_info(cio->pe, "colloid_io_write:\n");
+  pe_info(cio->pe, "writing colloid information to %s (mpiio)\n",
+	  filename_io);
+
+  cbuf = (colloid_state_t *) malloc((1 + nlocal)*sizeof(colloid_state_t));
+  assert(cbuf);
+  if (cbuf == NULL) pe_fatal(cio->pe, "malloc(cbuf) failed\n");
+
+  colloid_io_pack_buffer(cio, nlocal, cbuf);
+
+  MPI_Type_contiguous(sizeof(colloid_state_t), MPI_BYTE, &record);
+  MPI_Type_commit(&record);
+
+  /* Equivalent of fopen() with mode "w" (see io_impl_mpio.c) */
+
+  MPI_File_open(comm, filename_io,
+		MPI_MODE_CREATE | MPI_MODE_DELETE_ON_CLOSE | MPI_MODE_WRONLY,
+		info, &fh);
+  MPI_File_close(&fh);
+
+  ifail = MPI_File_open(comm, filename_io, MPI_MODE_CREATE | MPI_MODE_WRONLY,
+			info, &fh);
+  if (ifail != MPI_SUCCESS) pe_fatal(cio->pe, "Failed to open %s\n",
+				     filename_io);
+
+  if (rank == 0) {
+    ifail = MPI_File_write_at(fh, 0, &ntotal, 1, MPI_INT, MPI_STATUS_IGNORE);
+  }
+  MPI_Allreduce(MPI_IN_PLACE, &ifail, 1, MPI_INT, MPI_MAX, comm);
+
+  if (ifail == MPI_SUCCESS) {
+    disp = sizeof(int) + nstart*sizeof(colloid_state_t);
+    ifail = MPI_File_write_at_all(fh, disp, cbuf, nlocal, record,
+				  MPI_STATUS_IGNORE);
+  }
+
+  MPI_File_close(&fh);
+  MPI_Type_free(&record);
+  free(cbuf);
+
+  if (ifail != MPI_SUCCESS) {
+    pe_fatal(cio->pe, "Error on writing file %s\n", filename_io);
+  }
+
+  colloid_io_write_metadata(cio, filename, ntotal);
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  colloid_io_write_metadata
+ *
+ *  Description of the single file in the same style as io_metadata,
+ *  i.e., "stub-metadata.001-001". Written by rank zero only.
+ *
+ *****************************************************************************/
+
+static int colloid_io_write_metadata(colloid_io_t * cio, const char * stub,
+				     int ntotal) {
+  int ifail = 0;
+  int rank = -1;
+  int nrank = 0;
+  char filename[FILENAME_MAX] = {0};
+  MPI_Comm comm = MPI_COMM_NULL;
+
+  assert(cio);
+  assert(stub);
+
+  cs_cart_comm(cio->cs, &comm);
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &nrank);
+
+  snprintf(filename, FILENAME_MAX-1, "%s-metadata.%3.3d-%3.3d", stub, 1, 1);
+
+  if (rank == 0) {
+    cJSON * json = cJSON_CreateObject();
+    cJSON * jcoords = NULL;
+    cJSON * jcio = cJSON_CreateObject();
+
+    cs_to_json(cio->cs, &jcoords);
+    cJSON_AddItemToObject(json, "coords", jcoords);
+
+    cJSON_AddStringToObject(jcio, "Format", "binary");
+    cJSON_AddNumberToObject(jcio, "Header size (bytes)", sizeof(int));
+    cJSON_AddNumberToObject(jcio, "Record size (bytes)",
+			    sizeof(colloid_state_t));
+    cJSON_AddNumberToObject(jcio, "Number of colloids", ntotal);
+    cJSON_AddNumberToObject(jcio, "Number of writers", nrank);
+    cJSON_AddStringToObject(jcio, "Endianness",
+			    io_endian_to_string(io_endianness()));
+    cJSON_AddItemToObject(json, "colloid_io", jcio);
+
+    ifail = util_json_to_file(filename, json);
+    cJSON_Delete(json);
+  }
+
+  MPI_Bcast(&ifail, 1, MPI_INT, 0, comm);
+  if (ifail != 0) pe_fatal(cio->pe, "Error on writing file %s\n", filename);
+
+  return ifail;
+}
+
+/*****************************************************************************
+ *
+ *  colloid_io_read_mpiio
+ *
+ *  Each rank reads an (almost) equal contiguous block of records from
+ *  the single file, independent of where the colloids live. The total
+ *  in the file is returned.
+ *
+ *****************************************************************************/
+
+static int colloid_io_read_mpiio(colloid_io_t * cio, const char * filename,
+				 int * ntotal) {
+  int ifail = 0;
+  int rank = -1;
+  int nrank = 0;
+  int nfile = 0;
+  int nread = 0;
+  int64_t nstart = 0;
+  char filename_io[FILENAME_MAX] = {0};
+
+  colloid_state_t * buf = NULL;
+  MPI_Comm comm = MPI_COMM_NULL;
+  MPI_Datatype record = MPI_DATATYPE_NULL;
+  MPI_File fh = MPI_FILE_NULL;
+  MPI_Offset disp = 0;
+
+  assert(cio);
+  assert(filename);
+  assert(ntotal);
+
+  cs_cart_comm(cio->cs, &comm);
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &nrank);
+
+  snprintf(filename_io, FILENAME_MAX-1, "%s.%3.3d-%3.3d", filename, 1, 1);
+  pe_info(cio->pe, "colloid_io_read: reading from single file %s (mpiio)\n",
+	  filename_io);
+
+  ifail = MPI_File_open(comm, filename_io, MPI_MODE_RDONLY, MPI_INFO_NULL,
+			&fh);
+  if (ifail != MPI_SUCCESS) pe_fatal(cio->pe, "Failed to open %s\n",
+				     filename_io);
+
+  ifail = MPI_File_read_at_all(fh, 0, &nfile, 1, MPI_INT, MPI_STATUS_IGNORE);
+  if (ifail != MPI_SUCCESS || nfile < 0) {
+    pe_fatal(cio->pe, "Error on reading %s\n", filename_io);
+  }
+
+  /* Block decomposition of the records */
+
+  nread  = nfile/nrank + (rank < nfile % nrank);
+  nstart = (int64_t) rank*(nfile/nrank) + imin(rank, nfile % nrank);
+
+  buf = (colloid_state_t *) malloc((1 + nread)*sizeof(colloid_state_t));
+  assert(buf);
+  if (buf == NULL) pe_fatal(cio->pe, "malloc(buf) failed\n");
+
+  MPI_Type_contiguous(sizeof(colloid_state_t), MPI_BYTE, &record);
+  MPI_Type_commit(&record);
+
+  disp = sizeof(int) + nstart*sizeof(colloid_state_t);
+  ifail = MPI_File_read_at_all(fh, disp, buf, nread, record,
+			       MPI_STATUS_IGNORE);
+  MPI_File_close(&fh);
+
+  if (ifail != MPI_SUCCESS) {
+    pe_fatal(cio->pe, "Error on reading %s\n", filename_io);
+  }
+
+  colloid_io_redistribute(cio, nread, buf);
+
+  MPI_Type_free(&record);
+  free(buf);
+
+  *ntotal = nfile;
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  colloid_io_redistribute
+ *
+ *  Send each of the nc states in buf to the rank which owns the
+ *  position, and add the colloids received locally. The owner is
+ *  identified via the cell list coordinates, so the decision is
+ *  the same as that made by colloids_info_add_local().
+ *
+ *  A position outside the system is not sent anywhere; the loss is
+ *  reported by colloid_io_check_read().
+ *
+ *****************************************************************************/
+
+static int colloid_io_redistribute(colloid_io_t * cio, int nc,
+				   colloid_state_t * buf) {
+  int nrank = 0;
+  int nrecv = 0;
+  int ncell[3] = {0};
+  int cartsz[3] = {0};
+  int cartcoords[3] = {0};
+
+  int * dest = NULL;
+  int * scount = NULL;
+  int * sdispl = NULL;
+  int * rcount = NULL;
+  int * rdispl = NULL;
+  colloid_state_t * sbuf = NULL;
+  colloid_state_t * rbuf = NULL;
+
+  MPI_Comm comm = MPI_COMM_NULL;
+  MPI_Datatype record = MPI_DATATYPE_NULL;
+
+  assert(cio);
+  assert(buf);
+
+  cs_cart_comm(cio->cs, &comm);
+  cs_cartsz(cio->cs, cartsz);
+  cs_cart_coords(cio->cs, cartcoords);
+  MPI_Comm_size(comm, &nrank);
+  colloids_info_ncell(cio->info, ncell);
+
+  dest   = (int *) malloc((1 + nc)*sizeof(int));
+  scount = (int *) calloc(nrank, sizeof(int));
+  sdispl = (int *) calloc(nrank, sizeof(int));
+  rcount = (int *) calloc(nrank, sizeof(int));
+  rdispl = (int *) calloc(nrank, sizeof(int));
+  sbuf   = (colloid_state_t *) malloc((1 + nc)*sizeof(colloid_state_t));
+
+  if (dest == NULL || scount == NULL || sdispl == NULL || rcount == NULL ||
+      rdispl == NULL || sbuf == NULL) {
+    pe_fatal(cio->pe, "malloc(colloid_io_redistribute) failed\n");
+  }
+
+  /* Destination ranks */
+
+  for (int n = 0; n < nc; n++) {
+    int isvalid = 1;
+    int icell[3] = {0};
+    int coords[3] = {0};
+    colloids_info_cell_coords(cio->info, buf[n].r, icell);
+    for (int ia = 0; ia < 3; ia++) {
+      /* Global cell index (from 0) and hence Cartesian coordinate */
+      int ig = icell[ia] - 1 + cartcoords[ia]*ncell[ia];
+      if (ig < 0 || ig >= cartsz[ia]*ncell[ia]) isvalid = 0;
+      coords[ia] = (isvalid) ? ig/ncell[ia] : 0;
+    }
+    dest[n] = -1;
+    if (isvalid) MPI_Cart_rank(comm, coords, dest + n);
+    if (dest[n] >= 0) scount[dest[n]] += 1;
+  }
+
+  for (int ir = 1; ir < nrank; ir++) {
+    sdispl[ir] = sdispl[ir-1] + scount[ir-1];
+  }
+
+  {
+    /* Pack in order of destination rank (counts are reset on the way) */
+    for (int ir = 0; ir < nrank; ir++) scount[ir] = 0;
+    for (int n = 0; n < nc; n++) {
+      if (dest[n] < 0) continue;
+      sbuf[sdispl[dest[n]] + scount[dest[n]]] = buf[n];
+      scount[dest[n]] += 1;
+    }
+  }
+
+  MPI_Alltoall(scount, 1, MPI_INT, rcount, 1, MPI_INT, comm);
+
+  nrecv = rcount[0];
+  for (int ir = 1; ir < nrank; ir++) {
+    rdispl[ir] = rdispl[ir-1] + rcount[ir-1];
+    nrecv += rcount[ir];
+  }
+
+  rbuf = (colloid_state_t *) malloc((1 + nrecv)*sizeof(colloid_state_t));
+  assert(rbuf);
+  if (rbuf == NULL) pe_fatal(cio->pe, "malloc(rbuf) failed\n");
+
+  MPI_Type_contiguous(sizeof(colloid_state_t), MPI_BYTE, &record);
+  MPI_Type_commit(&record);
+
+  MPI_Alltoallv(sbuf, scount, sdispl, record, rbuf, rcount, rdispl, record,
+		comm);
+
+  for (int n = 0; n < nrecv; n++) {
+    colloid_t * pc = NULL;
+    colloids_info_add_local(cio->info, rbuf[n].index, rbuf[n].r, &pc);
+    if (pc) {
+      /* As colloid_state_read_binary(), always set the rebuild flag */
+      pc->s = rbuf[n];
+      pc->s.rebuild = 1;
+    }
+  }
+
+  MPI_Type_free(&record);
+  free(rbuf);
+  free(sbuf);
+  free(rdispl);
+  free(rcount);
+  free(sdispl);
+  free(scount);
+  free(dest);
+
+  return 0;
+}
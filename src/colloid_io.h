@@ -32,7 +32,9 @@ int colloid_io_write(colloid_io_t * cio, const char * filename);
 int colloid_io_format_input_ascii_set(colloid_io_t * cio);
 int colloid_io_format_input_binary_set(colloid_io_t * cio);
 int colloid_io_format_input_serial_set(colloid_io_t * cio);
+int colloid_io_format_input_mpiio_set(colloid_io_t * cio);
 int colloid_io_format_output_ascii_set(colloid_io_t * cio);
 int colloid_io_format_output_binary_set(colloid_io_t * cio);
+int colloid_io_format_output_mpiio_set(colloid_io_t * cio);
 
 #endif
@@ -80,6 +80,11 @@ int colloid_io_run_time(pe_t * pe, rt_t * rt, cs_t * cs,
     colloid_io_format_output_binary_set(cio);
   }
 
+  if (strncmp("MPIIO", tmp, 5) == 0 || strncmp("mpiio", tmp, 5) == 0) {
+    colloid_io_format_input_mpiio_set(cio);
+    colloid_io_format_output_mpiio_set(cio);
+  }
+
   rt_string_parameter(rt, "colloid_io_format_input", tmp, BUFSIZ);
 
   if (strncmp("ASCII",  tmp, 5) == 0 || strncmp("ascii", tmp, 5) == 0) {
@@ -102,6 +107,10 @@ int colloid_io_run_time(pe_t * pe, rt_t * rt, cs_t * cs,
     colloid_io_format_input_serial_set(cio);
   }
 
+  if (strncmp("MPIIO", tmp, 5) == 0 || strncmp("mpiio", tmp, 5) == 0) {
+    colloid_io_format_input_mpiio_set(cio);
+  }
+
   rt_string_parameter(rt, "colloid_io_format_output", tmp, BUFSIZ);
 
   if (strncmp("ASCII",  tmp, 5) == 0 || strncmp("ascii", tmp, 5) == 0) {
@@ -112,6 +121,10 @@ int colloid_io_run_time(pe_t * pe, rt_t * rt, cs_t * cs,
     colloid_io_format_output_binary_set(cio);
   }
 
+  if (strncmp("MPIIO", tmp, 5) == 0 || strncmp("mpiio", tmp, 5) == 0) {
+    colloid_io_format_output_mpiio_set(cio);
+  }
+
   colloid_io_info(cio);
 
   *pcio = cio;
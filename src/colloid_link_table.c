@@ -0,0 +1,348 @@
+/*****************************************************************************
+ *
+ *  colloid_link_table.c
+ *
+ *  A flat (structure of arrays) copy of the boundary links of all
+ *  colloids using bounce-back on links, including those in the halo.
+ *
+ *  The links of each owning colloid are contiguous in the table,
+ *  and appear in the same order as in the colloid's linked list.
+ *  Owners appear in cell list order. This allows data parallel
+ *  operations over links, while per-colloid quantities can be formed
+ *  as segmented sums (owner k has links in the range start[k] to
+ *  start[k+1] - 1).
+ *
+ *  The table is rebuilt from the linked lists via build_update_links()
+ *  on every occasion the links change. Links with status LINK_UNUSED
+ *  are not included.
+ *
+ *  Edinburgh Soft Matter and Statistical Physics Group and
+ *  Edinburgh Parallel Computing Centre
+ *
+ *  (c) 2024 The University of Edinburgh
+ *
+ *  Kevin Stratford (kevin@epcc.ed.ac.uk)
+ *
+ *****************************************************************************/
+
+#include <assert.h>
+#include <stdlib.h>
+
+#include "memory.h"
+#include "colloid_cell_table.h"
+#include "colloid_link_table.h"
+
+static int colloid_link_table_reserve(colloid_link_table_t * table,
+				      int nlink, int nowner);
+static int colloid_link_table_walk(colloid_link_table_t * table,
+				   colloids_info_t * cinfo, int fill,
+				   int * nlink, int * nowner);
+
+/*****************************************************************************
+ *
+ *  colloid_link_table_create
+ *
+ *****************************************************************************/
+
+__host__ int colloid_link_table_create(pe_t * pe,
+				       colloid_link_table_t ** table) {
+
+  int ndevice = 0;
+  colloid_link_table_t * obj = NULL;
+
+  assert(pe);
+  assert(table);
+
+  obj = (colloid_link_table_t *) calloc(1, sizeof(colloid_link_table_t));
+  assert(obj);
+  if (obj == NULL) pe_fatal(pe, "calloc(colloid_link_table_t) failed\n");
+
+  obj->pe = pe;
+
+  tdpGetDeviceCount(&ndevice);
+
+  if (ndevice == 0) {
+    obj->target = obj;
+  }
+  else {
+    tdpAssert(tdpMalloc((void **) &obj->target,
+			sizeof(colloid_link_table_t)));
+    tdpAssert(tdpMemset(obj->target, 0, sizeof(colloid_link_table_t)));
+  }
+
+  *table = obj;
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  colloid_link_table_free
+ *
+ *****************************************************************************/
+
+__host__ void colloid_link_table_free(colloid_link_table_t * table) {
+
+  assert(table);
+
+  if (table->target != table) {
+    colloid_link_table_t tmp = {0};
+    tdpAssert(tdpMemcpy(&tmp, table->target, sizeof(colloid_link_table_t),
+			tdpMemcpyDeviceToHost));
+    tdpFree(tmp.rb);
+    tdpFree(tmp.start);
+    tdpFree(tmp.owner);
+    tdpFree(tmp.status);
+    tdpFree(tmp.p);
+    tdpFree(tmp.j);
+    tdpFree(tmp.i);
+    tdpAssert(tdpFree(table->target));
+  }
+
+  free(table->pc);
+  free(table->rb);
+  free(table->start);
+  free(table->owner);
+  free(table->status);
+  free(table->p);
+  free(table->j);
+  free(table->i);
+  free(table);
+
+  return;
+}
+
+/*****************************************************************************
+ *
+ *  colloid_link_table_reserve
+ *
+ *  Make sure there is room for at least nlink links and nowner owners.
+ *  Existing contents are not retained if the table is reallocated.
+ *
+ *****************************************************************************/
+
+static int colloid_link_table_reserve(colloid_link_table_t * table,
+				      int nlink, int nowner) {
+  int ndevice = 0;
+
+  assert(table);
+
+  tdpGetDeviceCount(&ndevice);
+
+  if (nlink > table->nlinkmax) {
+
+    int nmax = nlink + nlink/4 + 1;    /* Some headroom */
+
+    free(table->rb);
+    free(table->owner);
+    free(table->status);
+    free(table->p);
+    free(table->j);
+    free(table->i);
+
+    table->nlinkmax = nmax;
+    table->i      = (int *) malloc(nmax*sizeof(int));
+    table->j      = (int *) malloc(nmax*sizeof(int));
+    table->p      = (int *) malloc(nmax*sizeof(int));
+    table->status = (int *) malloc(nmax*sizeof(int));
+    table->owner  = (int *) malloc(nmax*sizeof(int));
+    table->rb     = (double *) malloc(3*nmax*sizeof(double));
+
+    if (table->i == NULL || table->j == NULL || table->p == NULL ||
+	table->status == NULL || table->owner == NULL || table->rb == NULL) {
+      pe_fatal(table->pe, "malloc(colloid_link_table_t) links failed\n");
+    }
+
+    if (ndevice > 0) {
+      colloid_link_table_t tmp = {0};
+      tdpAssert(tdpMemcpy(&tmp, table->target, sizeof(colloid_link_table_t),
+			  tdpMemcpyDeviceToHost));
+      tdpFree(tmp.rb);
+      tdpFree(tmp.owner);
+      tdpFree(tmp.status);
+      tdpFree(tmp.p);
+      tdpFree(tmp.j);
+      tdpFree(tmp.i);
+      tdpAssert(tdpMalloc((void **) &tmp.i, nmax*sizeof(int)));
+      tdpAssert(tdpMalloc((void **) &tmp.j, nmax*sizeof(int)));
+      tdpAssert(tdpMalloc((void **) &tmp.p, nmax*sizeof(int)));
+      tdpAssert(tdpMalloc((void **) &tmp.status, nmax*sizeof(int)));
+      tdpAssert(tdpMalloc((void **) &tmp.owner, nmax*sizeof(int)));
+      tdpAssert(tdpMalloc((void **) &tmp.rb, 3*nmax*sizeof(double)));
+      tmp.nlinkmax = nmax;
+      tdpAssert(tdpMemcpy(table->target, &tmp, sizeof(colloid_link_table_t),
+			  tdpMemcpyHostToDevice));
+    }
+  }
+
+  if (table->start == NULL || nowner > table->nownermax) {
+
+    int nmax = nowner + nowner/4 + 1;
+
+    free(table->pc);
+    free(table->start);
+
+    table->nownermax = nmax;
+    table->start = (int *) malloc((nmax + 1)*sizeof(int));
+    table->pc = (colloid_t **) malloc(nmax*sizeof(colloid_t *));
+
+    if (table->start == NULL || table->pc == NULL) {
+      pe_fatal(table->pe, "malloc(colloid_link_table_t) owners failed\n");
+    }
+
+    if (ndevice > 0) {
+      colloid_link_table_t tmp = {0};
+      tdpAssert(tdpMemcpy(&tmp, table->target, sizeof(colloid_link_table_t),
+			  tdpMemcpyDeviceToHost));
+      tdpFree(tmp.start);
+      tdpAssert(tdpMalloc((void **) &tmp.start, (nmax + 1)*sizeof(int)));
+      tmp.nownermax = nmax;
+      tdpAssert(tdpMemcpy(table->target, &tmp, sizeof(colloid_link_table_t),
+			  tdpMemcpyHostToDevice));
+    }
+  }
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  colloid_link_table_build
+ *
+ *  Flatten the current linked lists for all colloids with
+ *  COLLOID_BC_BBL (local and halo). The target copy is also updated.
+ *
+ *****************************************************************************/
+
+__host__ int colloid_link_table_build(colloid_link_table_t * table,
+				      colloids_info_t * cinfo) {
+  int nlink = 0;
+  int nowner = 0;
+
+  assert(table);
+  assert(cinfo);
+
+  /* Count, then fill */
+
+  colloid_link_table_walk(table, cinfo, 0, &nlink, &nowner);
+  colloid_link_table_reserve(table, nlink, nowner);
+  colloid_link_table_walk(table, cinfo, 1, &nlink, &nowner);
+
+  table->nlink = nlink;
+  table->nowner = nowner;
+
+  colloid_link_table_memcpy(table, tdpMemcpyHostToDevice);
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  colloid_link_table_walk
+ *
+ *  Visit the colloids in cell list order (as build_update_links()) and
+ *  count the owners and links; if fill is set, also store them.
+ *
+ *****************************************************************************/
+
+static int colloid_link_table_walk(colloid_link_table_t * table,
+				   colloids_info_t * cinfo, int fill,
+				   int * nlink, int * nowner) {
+  int nl = 0;
+  int no = 0;
+  colloid_cell_table_t * ct = NULL;
+
+  assert(table);
+  assert(cinfo);
+
+  colloids_info_cell_table(cinfo, &ct);
+
+  for (int n = 0; n < ct->nall; n++) {
+
+    colloid_t * pc = ct->pc[n];
+
+    if (pc->s.bc != COLLOID_BC_BBL) continue;
+
+    if (fill) {
+      table->pc[no] = pc;
+      table->start[no] = nl;
+    }
+
+    for (colloid_link_t * link = pc->lnk; link; link = link->next) {
+      if (link->status == LINK_UNUSED) continue;
+      if (fill) {
+	table->i[nl]      = link->i;
+	table->j[nl]      = link->j;
+	table->p[nl]      = link->p;
+	table->status[nl] = link->status;
+	table->owner[nl]  = no;
+	for (int ia = 0; ia < 3; ia++) {
+	  int iaddr = addr_rank1(table->nlinkmax, 3, nl, ia);
+	  table->rb[iaddr] = link->rb[ia];
+	}
+      }
+      nl += 1;
+    }
+    no += 1;
+  }
+
+  if (fill) table->start[no] = nl;
+
+  *nlink = nl;
+  *nowner = no;
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  colloid_link_table_memcpy
+ *
+ *  Only host to device is relevant at the moment; the table is not
+ *  changed on the target.
+ *
+ *****************************************************************************/
+
+__host__ int colloid_link_table_memcpy(colloid_link_table_t * table,
+				       tdpMemcpyKind flag) {
+  int ndevice = 0;
+
+  assert(table);
+
+  tdpGetDeviceCount(&ndevice);
+
+  if (ndevice == 0) {
+    assert((table->target == table));
+  }
+  else {
+    colloid_link_table_t tmp = {0};
+    size_t nl = table->nlink;
+    size_t nsz = nl*sizeof(int);
+
+    assert(flag == tdpMemcpyHostToDevice);
+
+    tdpAssert(tdpMemcpy(&tmp, table->target, sizeof(colloid_link_table_t),
+			tdpMemcpyDeviceToHost));
+    assert(tmp.nlinkmax == table->nlinkmax);
+
+    tdpAssert(tdpMemcpy(tmp.i, table->i, nsz, flag));
+    tdpAssert(tdpMemcpy(tmp.j, table->j, nsz, flag));
+    tdpAssert(tdpMemcpy(tmp.p, table->p, nsz, flag));
+    tdpAssert(tdpMemcpy(tmp.status, table->status, nsz, flag));
+    tdpAssert(tdpMemcpy(tmp.owner, table->owner, nsz, flag));
+    tdpAssert(tdpMemcpy(tmp.rb, table->rb,
+			3*table->nlinkmax*sizeof(double), flag));
+    tdpAssert(tdpMemcpy(tmp.start, table->start,
+			(table->nowner + 1)*sizeof(int), flag));
+
+    tmp.nlink = table->nlink;
+    tmp.nowner = table->nowner;
+    tmp.pc = NULL;
+    tmp.pe = NULL;
+    tmp.target = NULL;
+    tdpAssert(tdpMemcpy(table->target, &tmp, sizeof(colloid_link_table_t),
+			tdpMemcpyHostToDevice));
+  }
+
+  return 0;
+}
@@ -0,0 +1,51 @@
+/*****************************************************************************
+ *
+ *  colloid_link_table.h
+ *
+ *  Edinburgh Soft Matter and Statistical Physics Group and
+ *  Edinburgh Parallel Computing Centre
+ *
+ *  (c) 2024 The University of Edinburgh
+ *
+ *  Kevin Stratford (kevin@epcc.ed.ac.uk)
+ *
+ *****************************************************************************/
+
+#ifndef LUDWIG_COLLOID_LINK_TABLE_H
+#define LUDWIG_COLLOID_LINK_TABLE_H
+
+#include "pe.h"
+#include "colloids.h"
+
+typedef struct colloid_link_table_s colloid_link_table_t;
+
+struct colloid_link_table_s {
+
+  int nlink;                      /* Number of links in the table */
+  int nlinkmax;                   /* Capacity (links) */
+  int nowner;                     /* Number of owning colloids */
+  int nownermax;                  /* Capacity (owners) */
+
+  int * i;                        /* Site outside colloid */
+  int * j;                        /* Site inside colloid */
+  int * p;                        /* Velocity i -> j */
+  int * status;                   /* Link status (enum link_status) */
+  int * owner;                    /* Owner index for each link */
+  int * start;                    /* Owner k has links start[k]..[k+1]-1 */
+  double * rb;                    /* rb[addr_rank1(nlinkmax, 3, n, ia)] */
+
+  colloid_t ** pc;                /* Owner colloid (host only) */
+
+  pe_t * pe;                      /* Parallel environment */
+  colloid_link_table_t * target;  /* Target copy */
+};
+
+__host__ int colloid_link_table_create(pe_t * pe,
+				       colloid_link_table_t ** table);
+__host__ void colloid_link_table_free(colloid_link_table_t * table);
+__host__ int colloid_link_table_build(colloid_link_table_t * table,
+				      colloids_info_t * cinfo);
+__host__ int colloid_link_table_memcpy(colloid_link_table_t * table,
+				       tdpMemcpyKind flag);
+
+#endif
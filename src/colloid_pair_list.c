@@ -0,0 +1,500 @@
+/*****************************************************************************
+ *
+ *  colloid_pair_list.c
+ *
+ *  A Verlet neighbour list of colloid pairs shared by all the pairwise
+ *  interactions (pair potentials, lubrication corrections).
+ *
+ *  The pairs are those found by the usual walk over the cell list:
+ *  the first colloid is in a local cell, the second is in the same or
+ *  a neighbouring cell (possibly halo), and pc1->s.index < pc2->s.index.
+ *  Only pairs with surface-surface separation h <= hc + skin, or
+ *  centre-centre separation r <= rc + skin, are retained, and they
+ *  appear in the same order as the cell list walk.
+ *
+ *  The list is rebuilt only if
+ *    - the ownership of colloids has changed (a copy has been added
+ *      or removed, or has moved between a local and a halo cell),
+ *      which may invalidate pointers or the local/halo distinction.
+ *      A move between cells on the same side is harmless;
+ *    - the maximum displacement since the last build exceeds skin/2;
+ *    - the range of the interactions has changed;
+ *    - a "full" list is requested (no range restriction), which is
+ *      used for statistics steps so that minimum separations are
+ *      reported for all neighbours as before.
+ *  Otherwise only the current separations r12 are recomputed.
+ *
+ *  The cell list should be sized for the list range including the
+ *  skin (see colloids_rt.c). Where that is not possible, the effective
+ *  skin is limited so that the list range never exceeds the cell width
+ *  (the walk cannot see further).
+ *
+ *  Threads. The computes may evaluate the pairs in parallel if each
+ *  writes the force on pc1 for pair n to f12[3*n] (the force on pc2
+ *  being equal and opposite). colloid_pair_list_force_add() then adds
+ *  these to the colloids, in parallel over colloids, each colloid
+ *  taking its contributions in pair order. The result is therefore
+ *  the same as a serial loop over the pairs, independent of the
+ *  number of threads.
+ *
+ *  Edinburgh Soft Matter and Statistical Physics Group and
+ *  Edinburgh Parallel Computing Centre
+ *
+ *  (c) 2024 The University of Edinburgh
+ *
+ *  Kevin Stratford (kevin@epcc.ed.ac.uk)
+ *
+ *****************************************************************************/
+
+#include <assert.h>
+#include <float.h>
+#include <math.h>
+#include <stdlib.h>
+
+#include "util.h"
+#include "colloid_cell_table.h"
+#include "colloid_pair_list.h"
+
+static int colloid_pair_list_build(colloid_pair_list_t * list,
+				   colloids_info_t * cinfo, double hc,
+				   double rc, int isfull);
+static int colloid_pair_list_stale(colloid_pair_list_t * list);
+static int colloid_pair_list_append(colloid_pair_list_t * list,
+				    colloid_t * pc1, colloid_t * pc2,
+				    int i1, int i2, const double r12[3]);
+static int colloid_pair_list_ref(colloid_pair_list_t * list,
+				 colloid_t * pc);
+static int colloid_pair_list_nbr(colloid_pair_list_t * list);
+
+/*****************************************************************************
+ *
+ *  colloid_pair_list_create
+ *
+ *****************************************************************************/
+
+int colloid_pair_list_create(pe_t * pe, cs_t * cs,
+			     colloid_pair_list_t ** list) {
+
+  colloid_pair_list_t * obj = NULL;
+
+  assert(pe);
+  assert(cs);
+  assert(list);
+
+  obj = (colloid_pair_list_t *) calloc(1, sizeof(colloid_pair_list_t));
+  assert(obj);
+  if (obj == NULL) pe_fatal(pe, "calloc(colloid_pair_list_t) failed\n");
+
+  obj->pe = pe;
+  obj->cs = cs;
+
+  *list = obj;
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  colloid_pair_list_free
+ *
+ *****************************************************************************/
+
+void colloid_pair_list_free(colloid_pair_list_t * list) {
+
+  assert(list);
+
+  free(list->nbr);
+  free(list->nbrstart);
+  free(list->rref);
+  free(list->pcref);
+  free(list->f12);
+  free(list->pair);
+  free(list);
+
+  return;
+}
+
+/*****************************************************************************
+ *
+ *  colloid_pair_list_skin_set
+ *
+ *  A skin of zero means the list is rebuilt every time.
+ *
+ *****************************************************************************/
+
+int colloid_pair_list_skin_set(colloid_pair_list_t * list, double skin) {
+
+  assert(list);
+
+  if (skin < 0.0) return -1;
+
+  list->skin = skin;
+  list->nbuild = 0;
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  colloid_pair_list_skin_effective
+ *
+ *  The skin available for a list of range rlist with cells of width
+ *  lcell: the list range cannot exceed the cell width.
+ *
+ *****************************************************************************/
+
+int colloid_pair_list_skin_effective(const colloid_pair_list_t * list,
+				     const double lcell[3], double rlist,
+				     double * skineff) {
+  double skin = 0.0;
+
+  assert(list);
+  assert(skineff);
+
+  skin = list->skin;
+  skin = dmin(skin, lcell[X] - rlist);
+  skin = dmin(skin, lcell[Y] - rlist);
+  skin = dmin(skin, lcell[Z] - rlist);
+
+  *skineff = dmax(0.0, skin);
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  colloid_pair_list_update
+ *
+ *  Make sure the list is valid for the current positions, and for
+ *  interactions with surface-surface range hc and centre-centre
+ *  range rc. If isfull is set, all neighbour pairs are included.
+ *
+ *****************************************************************************/
+
+int colloid_pair_list_update(colloid_pair_list_t * list,
+			     colloids_info_t * cinfo, double hc, double rc,
+			     int isfull) {
+  int rebuild = 0;
+
+  assert(list);
+  assert(cinfo);
+
+  list->nupdate += 1;
+
+  rebuild = (list->nbuild == 0);
+  rebuild = rebuild || (list->version != cinfo->owner_version);
+  rebuild = rebuild || (isfull != list->isfull);
+  rebuild = rebuild || (hc != list->hc) || (rc != list->rc);
+  rebuild = rebuild || colloid_pair_list_stale(list);
+
+  if (rebuild) {
+    colloid_pair_list_build(list, cinfo, hc, rc, isfull);
+  }
+  else {
+    #pragma omp parallel for
+    for (int n = 0; n < list->npair; n++) {
+      colloid_pair_t * p = list->pair + n;
+      cs_minimum_distance(list->cs, p->pc1->s.r, p->pc2->s.r, p->r12);
+    }
+  }
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  colloid_pair_list_stale
+ *
+ *  Has any colloid moved more than skin/2 since the last build?
+ *
+ *****************************************************************************/
+
+static int colloid_pair_list_stale(colloid_pair_list_t * list) {
+
+  double drmax2 = 0.0;
+
+  assert(list);
+
+  if (list->isfull) return 0;
+
+  #pragma omp parallel for reduction(max: drmax2)
+  for (int n = 0; n < list->nref; n++) {
+    const double * r = list->pcref[n]->s.r;
+    double dr[3] = {r[X] - list->rref[3*n + X],
+		    r[Y] - list->rref[3*n + Y],
+		    r[Z] - list->rref[3*n + Z]};
+    double dr2 = dr[X]*dr[X] + dr[Y]*dr[Y] + dr[Z]*dr[Z];
+    if (dr2 > drmax2) drmax2 = dr2;
+  }
+
+  /* Two colloids may approach by twice the maximum displacement */
+
+  return (2.0*sqrt(drmax2) > list->skineff);
+}
+
+/*****************************************************************************
+ *
+ *  colloid_pair_list_build
+ *
+ *****************************************************************************/
+
+static int colloid_pair_list_build(colloid_pair_list_t * list,
+				   colloids_info_t * cinfo, double hc,
+				   double rc, int isfull) {
+  int ncell[3] = {0};
+  double ahmax = 0.0;
+  double lcell[3] = {0};
+  double rlist = 0.0;
+  colloid_cell_table_t * ct = NULL;
+
+  assert(list);
+  assert(cinfo);
+
+  colloids_info_ncell(cinfo, ncell);
+  colloids_info_lcell(cinfo, lcell);
+
+  list->npair = 0;
+  list->nref = 0;
+
+  /* The cell table holds all the colloids which may appear, in cell
+   * order, so pcref[] has the same order (and the same index). The
+   * search below uses the table copies of index, radius, position. */
+
+  colloids_info_cell_table(cinfo, &ct);
+  colloid_cell_table_positions(ct);
+
+  for (int n = 0; n < ct->nall; n++) {
+    colloid_pair_list_ref(list, ct->pc[n]);
+    ahmax = dmax(ahmax, ct->ah[n]);
+  }
+
+  rlist = dmax(2.0*ahmax + hc, rc);
+  colloid_pair_list_skin_effective(list, lcell, rlist, &list->skineff);
+
+  /* Pairs */
+
+  for (int ic1 = 1; ic1 <= ncell[X]; ic1++) {
+    int di[2] = {0};
+    colloids_info_climits(cinfo, X, ic1, di);
+    for (int jc1 = 1; jc1 <= ncell[Y]; jc1++) {
+      int dj[2] = {0};
+      colloids_info_climits(cinfo, Y, jc1, dj);
+      for (int kc1 = 1; kc1 <= ncell[Z]; kc1++) {
+	int dk[2] = {0};
+	int c1 = colloids_info_cell_index(cinfo, ic1, jc1, kc1);
+	colloids_info_climits(cinfo, Z, kc1, dk);
+
+	for (int i1 = ct->start[c1]; i1 < ct->start[c1 + 1]; i1++) {
+
+	  const double * r1 = ct->r + 3*i1;
+
+	  for (int ic2 = di[0]; ic2 <= di[1]; ic2++) {
+	    for (int jc2 = dj[0]; jc2 <= dj[1]; jc2++) {
+	      for (int kc2 = dk[0]; kc2 <= dk[1]; kc2++) {
+
+		int c2 = colloids_info_cell_index(cinfo, ic2, jc2, kc2);
+
+		for (int i2 = ct->start[c2]; i2 < ct->start[c2 + 1]; i2++) {
+
+		  double r12[3] = {0};
+		  double r, h;
+
+		  if (ct->index[i1] >= ct->index[i2]) continue;
+
+		  cs_minimum_distance(list->cs, r1, ct->r + 3*i2, r12);
+
+		  if (isfull == 0) {
+		    r = sqrt(r12[X]*r12[X] + r12[Y]*r12[Y] + r12[Z]*r12[Z]);
+		    h = r - ct->ah[i1] - ct->ah[i2];
+		    if (h > hc + list->skineff && r > rc + list->skineff) {
+		      continue;
+		    }
+		  }
+
+		  colloid_pair_list_append(list, ct->pc[i1], ct->pc[i2],
+					   i1, i2, r12);
+		}
+	      }
+	    }
+	  }
+	}
+      }
+    }
+  }
+
+  colloid_pair_list_nbr(list);
+
+  list->hc = hc;
+  list->rc = rc;
+  list->isfull = isfull;
+  list->version = cinfo->owner_version;
+  list->nbuild += 1;
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  colloid_pair_list_append
+ *
+ *****************************************************************************/
+
+static int colloid_pair_list_append(colloid_pair_list_t * list,
+				    colloid_t * pc1, colloid_t * pc2,
+				    int i1, int i2, const double r12[3]) {
+  assert(list);
+
+  if (list->npair == list->npairmax) {
+    int nmax = 2*list->npairmax + 16;
+    colloid_pair_t * tmp = NULL;
+    double * ftmp = NULL;
+    int * ntmp = NULL;
+    tmp = (colloid_pair_t *) realloc(list->pair, nmax*sizeof(colloid_pair_t));
+    if (tmp == NULL) pe_fatal(list->pe, "realloc(colloid_pair_t) failed\n");
+    list->pair = tmp;
+    ftmp = (double *) realloc(list->f12, 3*nmax*sizeof(double));
+    if (ftmp == NULL) pe_fatal(list->pe, "realloc(f12) failed\n");
+    list->f12 = ftmp;
+    ntmp = (int *) realloc(list->nbr, 2*nmax*sizeof(int));
+    if (ntmp == NULL) pe_fatal(list->pe, "realloc(nbr) failed\n");
+    list->nbr = ntmp;
+    list->npairmax = nmax;
+  }
+
+  {
+    colloid_pair_t * p = list->pair + list->npair;
+    p->pc1 = pc1;
+    p->pc2 = pc2;
+    p->i1 = i1;
+    p->i2 = i2;
+    p->r12[X] = r12[X];
+    p->r12[Y] = r12[Y];
+    p->r12[Z] = r12[Z];
+  }
+
+  list->npair += 1;
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  colloid_pair_list_ref
+ *
+ *  Record the colloid and its current position.
+ *
+ *****************************************************************************/
+
+static int colloid_pair_list_ref(colloid_pair_list_t * list,
+				 colloid_t * pc) {
+  assert(list);
+  assert(pc);
+
+  if (list->nref == list->nrefmax) {
+    int nmax = 2*list->nrefmax + 16;
+    colloid_t ** tmp = NULL;
+    double * rtmp = NULL;
+    int * ntmp = NULL;
+    tmp = (colloid_t **) realloc(list->pcref, nmax*sizeof(colloid_t *));
+    if (tmp == NULL) pe_fatal(list->pe, "realloc(colloid_t *) failed\n");
+    list->pcref = tmp;
+    rtmp = (double *) realloc(list->rref, 3*nmax*sizeof(double));
+    if (rtmp == NULL) pe_fatal(list->pe, "realloc(rref) failed\n");
+    list->rref = rtmp;
+    ntmp = (int *) realloc(list->nbrstart, (nmax + 1)*sizeof(int));
+    if (ntmp == NULL) pe_fatal(list->pe, "realloc(nbrstart) failed\n");
+    list->nbrstart = ntmp;
+    list->nrefmax = nmax;
+  }
+
+  list->pcref[list->nref] = pc;
+  list->rref[3*list->nref + X] = pc->s.r[X];
+  list->rref[3*list->nref + Y] = pc->s.r[Y];
+  list->rref[3*list->nref + Z] = pc->s.r[Z];
+  list->nref += 1;
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  colloid_pair_list_nbr
+ *
+ *  For each colloid, the list of pairs in which it appears (in pair
+ *  order). Entry 2n refers to pair n as pc1, 2n + 1 as pc2.
+ *
+ *****************************************************************************/
+
+static int colloid_pair_list_nbr(colloid_pair_list_t * list) {
+
+  assert(list);
+
+  if (list->nbrstart == NULL) {
+    /* No colloids have been recorded */
+    list->nbrstart = (int *) calloc(1, sizeof(int));
+    if (list->nbrstart == NULL) pe_fatal(list->pe, "calloc(nbr) failed\n");
+  }
+
+  for (int k = 0; k <= list->nref; k++) {
+    list->nbrstart[k] = 0;
+  }
+
+  for (int n = 0; n < list->npair; n++) {
+    list->nbrstart[list->pair[n].i1 + 1] += 1;
+    list->nbrstart[list->pair[n].i2 + 1] += 1;
+  }
+
+  for (int k = 0; k < list->nref; k++) {
+    list->nbrstart[k + 1] += list->nbrstart[k];
+  }
+
+  /* Fill, using nbrstart[k] as the current position for colloid k,
+   * and then shift back. */
+
+  for (int n = 0; n < list->npair; n++) {
+    list->nbr[list->nbrstart[list->pair[n].i1]++] = 2*n;
+    list->nbr[list->nbrstart[list->pair[n].i2]++] = 2*n + 1;
+  }
+
+  for (int k = list->nref; k > 0; k--) {
+    list->nbrstart[k] = list->nbrstart[k - 1];
+  }
+  list->nbrstart[0] = 0;
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  colloid_pair_list_force_add
+ *
+ *  Add the pair forces f12[] to the colloids: pc1 += f12, pc2 -= f12.
+ *  Each colloid receives its contributions in pair order, so this is
+ *  bit-for-bit the same as the equivalent serial loop over pairs.
+ *
+ *****************************************************************************/
+
+int colloid_pair_list_force_add(colloid_pair_list_t * list) {
+
+  assert(list);
+
+  #pragma omp parallel for
+  for (int k = 0; k < list->nref; k++) {
+    colloid_t * pc = list->pcref[k];
+    for (int p = list->nbrstart[k]; p < list->nbrstart[k + 1]; p++) {
+      const double * f12 = list->f12 + 3*(list->nbr[p]/2);
+      if (list->nbr[p] % 2 == 0) {
+	pc->force[X] += f12[X];
+	pc->force[Y] += f12[Y];
+	pc->force[Z] += f12[Z];
+      }
+      else {
+	pc->force[X] -= f12[X];
+	pc->force[Y] -= f12[Y];
+	pc->force[Z] -= f12[Z];
+      }
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,72 @@
+/*****************************************************************************
+ *
+ *  colloid_pair_list.h
+ *
+ *  Edinburgh Soft Matter and Statistical Physics Group and
+ *  Edinburgh Parallel Computing Centre
+ *
+ *  (c) 2024 The University of Edinburgh
+ *
+ *  Kevin Stratford (kevin@epcc.ed.ac.uk)
+ *
+ *****************************************************************************/
+
+#ifndef LUDWIG_COLLOID_PAIR_LIST_H
+#define LUDWIG_COLLOID_PAIR_LIST_H
+
+#include "pe.h"
+#include "coords.h"
+#include "colloids.h"
+
+typedef struct colloid_pair_s colloid_pair_t;
+typedef struct colloid_pair_list_s colloid_pair_list_t;
+
+struct colloid_pair_s {
+  colloid_t * pc1;                /* Colloid in a local cell */
+  colloid_t * pc2;                /* Neighbour with larger index */
+  int i1;                         /* Position of pc1 in pcref[] */
+  int i2;                         /* Position of pc2 in pcref[] */
+  double r12[3];                  /* Current minimum distance 1->2 */
+};
+
+struct colloid_pair_list_s {
+
+  int npair;                      /* Number of pairs in list */
+  int npairmax;                   /* Capacity (pairs) */
+  colloid_pair_t * pair;          /* Pairs (in cell list order) */
+  double * f12;                   /* Force on pc1 per pair [3*npairmax] */
+
+  int nref;                       /* Number of colloids at last build */
+  int nrefmax;                    /* Capacity (colloids) */
+  colloid_t ** pcref;             /* Colloids at last build */
+  double * rref;                  /* Positions at last build [3*nref] */
+  int * nbrstart;                 /* Pairs for each colloid [nref + 1] */
+  int * nbr;                      /* 2*pair (+1 if pc2) [2*npair] */
+
+  double skin;                    /* Requested skin */
+  double skineff;                 /* Skin used at last build */
+  double hc;                      /* Surface-surface range at last build */
+  double rc;                      /* Centre-centre range at last build */
+  int isfull;                     /* Last build had no range restriction */
+  unsigned int version;           /* Ownership version at last build */
+
+  int nbuild;                     /* Number of builds */
+  int nupdate;                    /* Number of updates */
+
+  pe_t * pe;                      /* Parallel environment */
+  cs_t * cs;                      /* Coordinate system */
+};
+
+int colloid_pair_list_create(pe_t * pe, cs_t * cs,
+			     colloid_pair_list_t ** list);
+void colloid_pair_list_free(colloid_pair_list_t * list);
+int colloid_pair_list_skin_set(colloid_pair_list_t * list, double skin);
+int colloid_pair_list_skin_effective(const colloid_pair_list_t * list,
+				     const double lcell[3], double rlist,
+				     double * skineff);
+int colloid_pair_list_update(colloid_pair_list_t * list,
+			     colloids_info_t * cinfo, double hc, double rc,
+			     int isfull);
+int colloid_pair_list_force_add(colloid_pair_list_t * list);
+
+#endif
@@ -14,11 +14,15 @@
  *       function pointer.
  *    5. Write a test for colloids_sums_halo(cinfo, COLLOID_SUM_NEW)!
  *
+ *  Independent sums may be combined with colloid_sums_halo_batch(),
+ *  in which case there is one message per direction with a single
+ *  record per colloid holding each type in turn.
+ *
  *
  *  Edinburgh Soft Matter and Statistical Physics Group and
  *  Edinburgh Parallel Computing Centre
  *
- *  (c) 2010-2022 The University of Edinburgh
+ *  (c) 2010-2024 The University of Edinburgh
  *
  *  Contributing authors:
  *  Kevin Stratford (kevin@epcc.ed.ac.uk)
@@ -33,6 +37,7 @@
 #include "coords.h"
 #include "colloids.h"
 #include "colloid_sums.h"
+#include "colloid_cell_table.h"
 
 /*****************************************************************************
  *
@@ -66,16 +71,21 @@ struct colloid_sum_s {
   int mtype;                              /* Current message type */
   int mload;                              /* Load / unload flag */
   int msize;                              /* Current message size */
+  int ntype;                              /* Number of types in message */
+  int moff;                               /* Offset of current type */
+  colloid_sum_enum_t mtypes[COLLOID_SUM_MAX]; /* Types in message */
   int ncount[2];                          /* forward / backward */
   double * send;                          /* Send buffer */
   double * recv;                          /* Receive buffer */
 };
 
 static int colloid_sums_count(colloid_sum_t * sum, const int dim);
+static int colloid_sums_exchange(colloid_sum_t * sum, int dim);
 static int colloid_sums_irecv(colloid_sum_t * sum, int dim, MPI_Request rq[2]);
 static int colloid_sums_isend(colloid_sum_t * sum, int dim, MPI_Request rq[2]);
 static int colloid_sums_process(colloid_sum_t * sum, int dim);
 
+static int colloid_sums_mcell(colloid_sum_t * sum, int, int, int, int);
 static int colloid_sums_m0(colloid_sum_t * sum, int, int, int, int);
 static int colloid_sums_m1(colloid_sum_t * sum, int, int, int, int);
 static int colloid_sums_m2(colloid_sum_t * sum, int, int, int, int);
@@ -147,9 +157,27 @@ void colloid_sums_free(colloid_sum_t * sum) {
 
 int colloid_sums_halo(colloids_info_t * cinfo, colloid_sum_enum_t mtype) {
 
+  return colloid_sums_halo_batch(cinfo, 1, &mtype);
+}
+
+/*****************************************************************************
+ *
+ *  colloid_sums_halo_batch
+ *
+ *  As colloid_sums_halo(), but for ntype different sums in the same
+ *  messages. The sums must be independent, i.e., no quantity in one
+ *  may depend on the result of another.
+ *
+ *****************************************************************************/
+
+int colloid_sums_halo_batch(colloids_info_t * cinfo, int ntype,
+			    const colloid_sum_enum_t * mtype) {
+
   colloid_sum_t * sum = NULL;
 
   assert(cinfo);
+  assert(0 < ntype && ntype < COLLOID_SUM_MAX);
+  assert(mtype);
 
   sum = (colloid_sum_t * ) calloc(1, sizeof(colloid_sum_t));
   assert(sum);
@@ -158,12 +186,19 @@ int colloid_sums_halo(colloids_info_t * cinfo, colloid_sum_enum_t mtype) {
   sum->pe = cinfo->pe;
   sum->cs = cinfo->cs;
   sum->cinfo = cinfo;
-  sum->mtype = mtype;
-  sum->msize = msize_[mtype];
+  sum->ntype = ntype;
+  sum->mtype = mtype[0];
+  sum->msize = 0;
+
+  for (int n = 0; n < ntype; n++) {
+    assert(COLLOID_SUM_NULL < mtype[n] && mtype[n] < COLLOID_SUM_MAX);
+    sum->mtypes[n] = mtype[n];
+    sum->msize += msize_[mtype[n]];
+  }
 
-  colloid_sums_1d(sum, X, mtype);
-  colloid_sums_1d(sum, Y, mtype);
-  colloid_sums_1d(sum, Z, mtype);
+  colloid_sums_exchange(sum, X);
+  colloid_sums_exchange(sum, Y);
+  colloid_sums_exchange(sum, Z);
 
   free(sum);
 
@@ -178,6 +213,27 @@ int colloid_sums_halo(colloids_info_t * cinfo, colloid_sum_enum_t mtype) {
 
 int colloid_sums_1d(colloid_sum_t * sum, int dim, colloid_sum_enum_t mtype) {
 
+  assert(sum);
+  assert(mtype < COLLOID_SUM_MAX);
+
+  sum->ntype = 1;
+  sum->mtype = mtype;
+  sum->mtypes[0] = mtype;
+  sum->msize = msize_[mtype];
+
+  return colloid_sums_exchange(sum, dim);
+}
+
+/*****************************************************************************
+ *
+ *  colloid_sums_exchange
+ *
+ *  Exchange in one dimension for the current message type(s).
+ *
+ *****************************************************************************/
+
+static int colloid_sums_exchange(colloid_sum_t * sum, int dim) {
+
   int n;
  
   MPI_Request recv_req[2];
@@ -186,20 +242,17 @@ int colloid_sums_1d(colloid_sum_t * sum, int dim, colloid_sum_enum_t mtype) {
 
   assert(sum);
   assert(sum->cinfo);
-  assert(mtype < COLLOID_SUM_MAX);
 
   /* Count how many colloids are relevant */
 
-  sum->mtype = mtype;
-  sum->msize = msize_[mtype];
   colloid_sums_count(sum, dim);
 
   /* Allocate send and receive buffer */
 
   n = sum->ncount[BACKWARD] + sum->ncount[FORWARD];
 
-  sum->send = (double *) malloc(n*msize_[mtype]*sizeof(double));
-  sum->recv = (double *) malloc(n*msize_[mtype]*sizeof(double));
+  sum->send = (double *) malloc(n*sum->msize*sizeof(double));
+  sum->recv = (double *) malloc(n*sum->msize*sizeof(double));
  
   if (sum->send == NULL) pe_fatal(sum->pe, "malloc(sum->send) failed\n");
   if (sum->recv == NULL) pe_fatal(sum->pe, "malloc(sum->recv) failed\n");
@@ -386,15 +439,7 @@ static int colloid_sums_process(colloid_sum_t * sum, int dim) {
 
   colloids_info_ncell(sum->cinfo, ncell);
 
-  if (sum->mtype == COLLOID_SUM_STRUCTURE) mloader_forw = colloid_sums_m1;
-  if (sum->mtype == COLLOID_SUM_DYNAMICS) mloader_forw = colloid_sums_m2;
-  if (sum->mtype == COLLOID_SUM_ACTIVE) mloader_forw = colloid_sums_m3;
-  if (sum->mtype == COLLOID_SUM_SUBGRID) mloader_forw = colloid_sums_m4;
-  if (sum->mtype == COLLOID_SUM_CONSERVATION) mloader_forw = colloid_sums_m5;
-  if (sum->mtype == COLLOID_SUM_FORCE_EXT_ONLY) mloader_forw = colloid_sums_m6;
-  if (sum->mtype == COLLOID_SUM_DIAGNOSTIC) mloader_forw = colloid_sums_m7;
-
-  assert(mloader_forw);
+  mloader_forw = colloid_sums_mcell;
   mloader_back = mloader_forw;
 
   if (sum->mload == MESSAGE_LOAD) {
@@ -462,6 +507,43 @@ static int colloid_sums_process(colloid_sum_t * sum, int dim) {
   return 0;
 }
 
+/*****************************************************************************
+ *
+ *  colloid_sums_mcell
+ *
+ *  Load or unload each message type in turn for one cell list. The
+ *  offset moff locates the current type in each colloid's record.
+ *
+ *****************************************************************************/
+
+static int colloid_sums_mcell(colloid_sum_t * sum, int ic, int jc, int kc,
+			      int noff) {
+  int npart = 0;
+
+  sum->moff = 0;
+
+  for (int n = 0; n < sum->ntype; n++) {
+
+    int (* mloader)(colloid_sum_t *, int, int, int, int) = NULL;
+
+    sum->mtype = sum->mtypes[n];
+
+    if (sum->mtype == COLLOID_SUM_STRUCTURE) mloader = colloid_sums_m1;
+    if (sum->mtype == COLLOID_SUM_DYNAMICS) mloader = colloid_sums_m2;
+    if (sum->mtype == COLLOID_SUM_ACTIVE) mloader = colloid_sums_m3;
+    if (sum->mtype == COLLOID_SUM_SUBGRID) mloader = colloid_sums_m4;
+    if (sum->mtype == COLLOID_SUM_CONSERVATION) mloader = colloid_sums_m5;
+    if (sum->mtype == COLLOID_SUM_FORCE_EXT_ONLY) mloader = colloid_sums_m6;
+    if (sum->mtype == COLLOID_SUM_DIAGNOSTIC) mloader = colloid_sums_m7;
+
+    assert(mloader);
+    npart = mloader(sum, ic, jc, kc, noff);
+    sum->moff += msize_[sum->mtype];
+  }
+
+  return npart;
+}
+
 /*****************************************************************************
  *
  *  colloid_sums_m0
@@ -483,7 +565,8 @@ static int colloid_sums_m0(colloid_sum_t * sum, int ic, int jc, int kc,
  *  'Structure' messages cbar, rxcbar etc
  *
  *  The supplied offset for the start of the message is number of
- *  particles, so must take account of the size of the message.
+ *  particles, so must take account of the size of the message
+ *  (the total for all types) and the offset of this type in it.
  *
  *****************************************************************************/
 
@@ -491,15 +574,21 @@ static int colloid_sums_m1(colloid_sum_t * sum, int ic, int jc, int kc,
 			   int noff) {
 
   int n, npart;
+  int icell;
   int ia;
   int index;
-  colloid_t * pc;
+  colloid_t * pc = NULL;
+  colloid_cell_table_t * ct = NULL;
 
-  n = sum->msize*noff;
   npart = 0;
-  colloids_info_cell_list_head(sum->cinfo, ic, jc, kc, &pc);
+  colloids_info_cell_table(sum->cinfo, &ct);
+  icell = colloids_info_cell_index(sum->cinfo, ic, jc, kc);
+
+  for (int ip = ct->start[icell]; ip < ct->start[icell + 1]; ip++) {
+
+    pc = ct->pc[ip];
 
-  while (pc) {
+    n = sum->msize*(noff + npart) + sum->moff;
 
     if (sum->mload == MESSAGE_LOAD) {
       sum->send[n++] = 1.0*pc->s.index;
@@ -511,7 +600,8 @@ static int colloid_sums_m1(colloid_sum_t * sum, int ic, int jc, int kc,
       sum->send[n++] = pc->deltam;
       sum->send[n++] = pc->s.deltaphi;
 
-      assert(n == (noff + npart + 1)*sum->msize);
+      assert(n == sum->msize*(noff + npart) + sum->moff
+	     + msize_[COLLOID_SUM_STRUCTURE]);
     }
     else {
       /* unload and check incoming index (a fatal error) */
@@ -528,11 +618,11 @@ static int colloid_sums_m1(colloid_sum_t * sum, int ic, int jc, int kc,
       }
       pc->deltam += sum->recv[n++];
       pc->s.deltaphi += sum->recv[n++];
-      assert(n == (noff + npart + 1)*sum->msize);
+      assert(n == sum->msize*(noff + npart) + sum->moff
+	     + msize_[COLLOID_SUM_STRUCTURE]);
     }
 
     npart++;
-    pc = pc->next;
   }
 
   return npart;
@@ -550,15 +640,21 @@ static int colloid_sums_m2(colloid_sum_t * sum, int ic, int jc, int kc,
 			   int noff) {
 
   int n, npart;
+  int icell;
   int ia;
   int index;
   colloid_t * pc = NULL;
+  colloid_cell_table_t * ct = NULL;
 
-  n = sum->msize*noff;
   npart = 0;
-  colloids_info_cell_list_head(sum->cinfo, ic, jc, kc, &pc);
+  colloids_info_cell_table(sum->cinfo, &ct);
+  icell = colloids_info_cell_index(sum->cinfo, ic, jc, kc);
 
-  while (pc) {
+  for (int ip = ct->start[icell]; ip < ct->start[icell + 1]; ip++) {
+
+    pc = ct->pc[ip];
+
+    n = sum->msize*(noff + npart) + sum->moff;
 
     if (sum->mload == MESSAGE_LOAD) {
       sum->send[n++] = 1.0*pc->s.index;
@@ -572,7 +668,8 @@ static int colloid_sums_m2(colloid_sum_t * sum, int ic, int jc, int kc,
       for (ia = 0; ia < 21; ia++) {
 	sum->send[n++] = pc->zeta[ia];
       }
-      assert(n == (noff + npart + 1)*sum->msize);
+      assert(n == sum->msize*(noff + npart) + sum->moff
+	     + msize_[COLLOID_SUM_DYNAMICS]);
     }
     else {
       /* unload and check incoming index (a fatal error) */
@@ -591,11 +688,11 @@ static int colloid_sums_m2(colloid_sum_t * sum, int ic, int jc, int kc,
       for (ia = 0; ia < 21; ia++) {
 	pc->zeta[ia] += sum->recv[n++];
       }
-      assert(n == (noff + npart + 1)*sum->msize);
+      assert(n == sum->msize*(noff + npart) + sum->moff
+	     + msize_[COLLOID_SUM_DYNAMICS]);
     }
 
     npart++;
-    pc = pc->next;
   }
 
   return npart;
@@ -613,15 +710,21 @@ static int colloid_sums_m3(colloid_sum_t * sum, int ic, int jc, int kc,
 			   int noff) {
 
   int n, npart;
+  int icell;
   int ia;
   int index;
-  colloid_t * pc;
+  colloid_t * pc = NULL;
+  colloid_cell_table_t * ct = NULL;
 
-  n = sum->msize*noff;
   npart = 0;
-  colloids_info_cell_list_head(sum->cinfo, ic, jc, kc, &pc);
+  colloids_info_cell_table(sum->cinfo, &ct);
+  icell = colloids_info_cell_index(sum->cinfo, ic, jc, kc);
+
+  for (int ip = ct->start[icell]; ip < ct->start[icell + 1]; ip++) {
+
+    pc = ct->pc[ip];
 
-  while (pc) {
+    n = sum->msize*(noff + npart) + sum->moff;
 
     if (sum->mload == MESSAGE_LOAD) {
       sum->send[n++] = 1.0*pc->s.index;
@@ -629,7 +732,8 @@ static int colloid_sums_m3(colloid_sum_t * sum, int ic, int jc, int kc,
 	sum->send[n++] = pc->fc0[ia];
 	sum->send[n++] = pc->tc0[ia];
       }
-      assert(n == (noff + npart + 1)*sum->msize);
+      assert(n == sum->msize*(noff + npart) + sum->moff
+	     + msize_[COLLOID_SUM_ACTIVE]);
     }
     else {
       /* unload and check incoming index (a fatal error) */
@@ -642,11 +746,11 @@ static int colloid_sums_m3(colloid_sum_t * sum, int ic, int jc, int kc,
 	pc->fc0[ia] += sum->recv[n++];
 	pc->tc0[ia] += sum->recv[n++];
       }
-      assert(n == (noff + npart + 1)*sum->msize);
+      assert(n == sum->msize*(noff + npart) + sum->moff
+	     + msize_[COLLOID_SUM_ACTIVE]);
     }
 
     npart++;
-    pc = pc->next;
   }
 
   return npart;
@@ -664,22 +768,29 @@ static int colloid_sums_m4(colloid_sum_t * sum, int ic, int jc, int kc,
 			   int noff) {
 
   int n, npart;
+  int icell;
   int ia;
   int index;
-  colloid_t * pc;
+  colloid_t * pc = NULL;
+  colloid_cell_table_t * ct = NULL;
 
-  n = sum->msize*noff;
   npart = 0;
-  colloids_info_cell_list_head(sum->cinfo, ic, jc, kc, &pc);
+  colloids_info_cell_table(sum->cinfo, &ct);
+  icell = colloids_info_cell_index(sum->cinfo, ic, jc, kc);
+
+  for (int ip = ct->start[icell]; ip < ct->start[icell + 1]; ip++) {
 
-  for (; pc; pc = pc->next) {
+    pc = ct->pc[ip];
+
+    n = sum->msize*(noff + npart) + sum->moff;
 
     if (sum->mload == MESSAGE_LOAD) {
       sum->send[n++] = 1.0*pc->s.index;
       for (ia = 0; ia < 3; ia++) {
 	sum->send[n++] = pc->fsub[ia];
       }
-      assert(n == (noff + npart + 1)*sum->msize);
+      assert(n == sum->msize*(noff + npart) + sum->moff
+	     + msize_[COLLOID_SUM_SUBGRID]);
     }
     else {
       /* unload and check incoming index (a fatal error) */
@@ -691,7 +802,8 @@ static int colloid_sums_m4(colloid_sum_t * sum, int ic, int jc, int kc,
       for (ia = 0; ia < 3; ia++) {
 	pc->fsub[ia] += sum->recv[n++];
       }
-      assert(n == (noff + npart + 1)*sum->msize);
+      assert(n == sum->msize*(noff + npart) + sum->moff
+	     + msize_[COLLOID_SUM_SUBGRID]);
     }
 
     npart++;
@@ -716,14 +828,20 @@ static int colloid_sums_m5(colloid_sum_t * sum, int ic, int jc, int kc,
 			   int noff) {
 
   int n, npart;
+  int icell;
   int index;
-  colloid_t * pc;
+  colloid_t * pc = NULL;
+  colloid_cell_table_t * ct = NULL;
 
-  n = msize_[sum->mtype]*noff;
   npart = 0;
-  colloids_info_cell_list_head(sum->cinfo, ic, jc, kc, &pc);
+  colloids_info_cell_table(sum->cinfo, &ct);
+  icell = colloids_info_cell_index(sum->cinfo, ic, jc, kc);
 
-  while (pc) {
+  for (int ip = ct->start[icell]; ip < ct->start[icell + 1]; ip++) {
+
+    pc = ct->pc[ip];
+
+    n = sum->msize*(noff + npart) + sum->moff;
 
     if (sum->mload == MESSAGE_LOAD) {
       sum->send[n++] = 1.0*pc->s.index;
@@ -733,7 +851,8 @@ static int colloid_sums_m5(colloid_sum_t * sum, int ic, int jc, int kc,
       sum->send[n++] = pc->s.sa;
       sum->send[n++] = pc->s.saf;
 
-      assert(n == (noff + npart + 1)*msize_[sum->mtype]);
+      assert(n == sum->msize*(noff + npart) + sum->moff
+	     + msize_[COLLOID_SUM_CONSERVATION]);
     }
     else {
 
@@ -749,11 +868,11 @@ static int colloid_sums_m5(colloid_sum_t * sum, int ic, int jc, int kc,
       pc->s.sa       += sum->recv[n++];
       pc->s.saf      += sum->recv[n++];
 
-      assert(n == (noff + npart + 1)*msize_[sum->mtype]);
+      assert(n == sum->msize*(noff + npart) + sum->moff
+	     + msize_[COLLOID_SUM_CONSERVATION]);
     }
 
     npart++;
-    pc = pc->next;
   }
 
   return npart;
@@ -771,15 +890,21 @@ static int colloid_sums_m6(colloid_sum_t * sum, int ic, int jc, int kc,
 			   int noff) {
 
   int n, npart;
+  int icell;
   int ia;
   int index;
-  colloid_t * pc;
+  colloid_t * pc = NULL;
+  colloid_cell_table_t * ct = NULL;
 
-  n = sum->msize*noff;
   npart = 0;
-  colloids_info_cell_list_head(sum->cinfo, ic, jc, kc, &pc);
+  colloids_info_cell_table(sum->cinfo, &ct);
+  icell = colloids_info_cell_index(sum->cinfo, ic, jc, kc);
+
+  for (int ip = ct->start[icell]; ip < ct->start[icell + 1]; ip++) {
 
-  for (; pc; pc = pc->next) {
+    pc = ct->pc[ip];
+
+    n = sum->msize*(noff + npart) + sum->moff;
 
     if (sum->mload == MESSAGE_LOAD) {
       sum->send[n++] = 1.0*pc->s.index;
@@ -787,7 +912,8 @@ static int colloid_sums_m6(colloid_sum_t * sum, int ic, int jc, int kc,
 	sum->send[n++] = pc->fex[ia];
 	sum->send[n++] = pc->tex[ia];
       }
-      assert(n == (noff + npart + 1)*sum->msize);
+      assert(n == sum->msize*(noff + npart) + sum->moff
+	     + msize_[COLLOID_SUM_FORCE_EXT_ONLY]);
     }
     else {
       /* unload and check incoming index (a fatal error) */
@@ -800,7 +926,8 @@ static int colloid_sums_m6(colloid_sum_t * sum, int ic, int jc, int kc,
 	pc->fex[ia] += sum->recv[n++];
 	pc->tex[ia] += sum->recv[n++];
       }
-      assert(n == (noff + npart + 1)*sum->msize);
+      assert(n == sum->msize*(noff + npart) + sum->moff
+	     + msize_[COLLOID_SUM_FORCE_EXT_ONLY]);
     }
 
     npart++;
@@ -825,15 +952,21 @@ static int colloid_sums_m7(colloid_sum_t * sum, int ic, int jc, int kc,
 			   int noff) {
 
   int n, npart;
+  int icell;
   int ia;
   int index;
-  colloid_t * pc;
+  colloid_t * pc = NULL;
+  colloid_cell_table_t * ct = NULL;
 
-  n = sum->msize*noff;
   npart = 0;
-  colloids_info_cell_list_head(sum->cinfo, ic, jc, kc, &pc);
+  colloids_info_cell_table(sum->cinfo, &ct);
+  icell = colloids_info_cell_index(sum->cinfo, ic, jc, kc);
+
+  for (int ip = ct->start[icell]; ip < ct->start[icell + 1]; ip++) {
+
+    pc = ct->pc[ip];
 
-  for (; pc; pc = pc->next) {
+    n = sum->msize*(noff + npart) + sum->moff;
 
     if (sum->mload == MESSAGE_LOAD) {
       sum->send[n++] = 1.0*pc->s.index;
@@ -843,7 +976,8 @@ static int colloid_sums_m7(colloid_sum_t * sum, int ic, int jc, int kc,
 	sum->send[n++] = pc->diagnostic.fschem[ia];
 	sum->send[n++] = pc->diagnostic.fbuild[ia];
       }
-      assert(n == (noff + npart + 1)*sum->msize);
+      assert(n == sum->msize*(noff + npart) + sum->moff
+	     + msize_[COLLOID_SUM_DIAGNOSTIC]);
     }
     else {
       /* unload and check incoming index (a fatal error) */
@@ -858,7 +992,8 @@ static int colloid_sums_m7(colloid_sum_t * sum, int ic, int jc, int kc,
 	pc->diagnostic.fschem[ia] += sum->recv[n++];
 	pc->diagnostic.fbuild[ia] += sum->recv[n++];
       }
-      assert(n == (noff + npart + 1)*sum->msize);
+      assert(n == sum->msize*(noff + npart) + sum->moff
+	     + msize_[COLLOID_SUM_DIAGNOSTIC]);
     }
 
     npart++;
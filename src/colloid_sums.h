@@ -10,7 +10,7 @@
  *  Edinburgh Soft Matter and Statistical Physics Group and
  *  Edinburgh Parallel Computing Centre
  *
- *  (c) 2010-2022 The University of Edinburgh
+ *  (c) 2010-2024 The University of Edinburgh
  *
  *  Contributing authors:
  *  Kevin Stratford (kevin@epcc.ed.ac.uk)
@@ -38,6 +38,8 @@ typedef enum colloid_sum_enum_type {
 int colloid_sums_create(colloids_info_t * cinfo, colloid_sum_t ** psum);
 void colloid_sums_free(colloid_sum_t * sum);
 int colloid_sums_halo(colloids_info_t * cinfo, colloid_sum_enum_t type);
+int colloid_sums_halo_batch(colloids_info_t * cinfo, int ntype,
+			    const colloid_sum_enum_t * type);
 int colloid_sums_1d(colloid_sum_t * sum, int dim, colloid_sum_enum_t type);
 
 #endif
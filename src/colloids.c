@@ -27,6 +27,10 @@
 #include "util_vector.h"
 #include "util_ellipsoid.h"
 #include "colloids.h"
+#include "colloid_cell_table.h"
+#include "colloid_link_table.h"
+#include "colloid_pair_list.h"
+#include "colloids_halo.h"
 
 #define RHO_DEFAULT 1.0
 #define DRMAX_DEFAULT 0.8
@@ -34,6 +38,8 @@
 
 __host__ int colloid_create(colloids_info_t * cinfo, colloid_t ** pc);
 __host__ void colloid_free(colloids_info_t * cinfo, colloid_t * pc);
+static int colloids_info_cell_local(colloids_info_t * cinfo,
+				    int ic, int jc, int kc);
 
 /*****************************************************************************
  *
@@ -81,6 +87,11 @@ __host__ int colloids_info_create(pe_t * pe, cs_t * cs, int ncell[3],
   obj->rho0 = RHO_DEFAULT;
   obj->drmax = DRMAX_DEFAULT;
 
+  colloid_cell_table_create(pe, nlist, &obj->ctable);
+  colloid_link_table_create(pe, &obj->ltable);
+  colloid_pair_list_create(pe, cs, &obj->plist);
+  colloid_pair_list_skin_set(obj->plist, obj->drmax);
+
   tdpGetDeviceCount(&ndevice);
 
   if (ndevice == 0) {
@@ -112,6 +123,15 @@ __host__ void colloids_info_free(colloids_info_t * info) {
   if (info->map_old) free(info->map_old);
   if (info->map_new) free(info->map_new);
 
+  colloid_cell_table_free(info->ctable);
+  colloid_link_table_free(info->ltable);
+  colloid_pair_list_free(info->plist);
+  if (info->halo) colloids_halo_free(info->halo);
+
+  free(info->map_changed);
+  free(info->vacant_box);
+  free(info->vacant);
+
   if (info->target != info) tdpAssert(tdpFree(info->target));
 
   free(info);
@@ -165,6 +185,8 @@ __host__ int colloids_info_recreate(int newcell[3], colloids_info_t ** pinfo) {
   colloids_info_ntotal_set(newinfo);
   assert(newinfo->ntotal == (*pinfo)->ntotal);
 
+  colloid_pair_list_skin_set(newinfo->plist, oldinfo->plist->skin);
+
   colloids_info_free(*pinfo);
   *pinfo = newinfo;
 
@@ -376,6 +398,23 @@ __host__ int colloids_info_cell_index(colloids_info_t * cinfo, int ic, int jc, i
   return index;
 }
 
+/*****************************************************************************
+ *
+ *  colloids_info_cell_local
+ *
+ *  Is cell (ic, jc, kc) local (1) or in the halo (0)?
+ *
+ *****************************************************************************/
+
+static int colloids_info_cell_local(colloids_info_t * cinfo,
+				    int ic, int jc, int kc) {
+  assert(cinfo);
+
+  return (ic >= 1 && ic <= cinfo->ncell[X] &&
+	  jc >= 1 && jc <= cinfo->ncell[Y] &&
+	  kc >= 1 && kc <= cinfo->ncell[Z]);
+}
+
 /*****************************************************************************
  *
  *  colloids_info_map
@@ -434,6 +473,66 @@ __host__ int colloids_info_map_set(colloids_info_t * cinfo, int index, colloid_t
   return 0;
 }
 
+/*****************************************************************************
+ *
+ *  colloids_info_map_changed_add
+ *
+ *  Record that map_new[index] has changed at the current update.
+ *
+ *****************************************************************************/
+
+__host__ int colloids_info_map_changed_add(colloids_info_t * cinfo,
+					   int index) {
+  assert(cinfo);
+  assert(index >= 0);
+  assert(index < cinfo->nsites);
+
+  if (cinfo->nchanged == cinfo->nchangedmax) {
+    int nmax = 2*cinfo->nchangedmax + 64;
+    int * tmp = (int *) realloc(cinfo->map_changed, nmax*sizeof(int));
+    if (tmp == NULL) pe_fatal(cinfo->pe, "realloc(map_changed) failed\n");
+    cinfo->map_changed = tmp;
+    cinfo->nchangedmax = nmax;
+  }
+
+  cinfo->map_changed[cinfo->nchanged] = index;
+  cinfo->nchanged += 1;
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  colloids_info_map_sync
+ *
+ *  The alternative to colloids_info_map_update() for an incremental
+ *  update: map_old becomes a copy of map_new, and map_new is retained
+ *  to be amended in place. Only the sites which changed at the last
+ *  update are copied, if these are known.
+ *
+ *****************************************************************************/
+
+__host__ int colloids_info_map_sync(colloids_info_t * cinfo) {
+
+  assert(cinfo);
+
+  if (cinfo->map_isdelta) {
+    for (int n = 0; n < cinfo->nchanged; n++) {
+      int index = cinfo->map_changed[n];
+      cinfo->map_old[index] = cinfo->map_new[index];
+    }
+  }
+  else {
+    for (int index = 0; index < cinfo->nsites; index++) {
+      cinfo->map_old[index] = cinfo->map_new[index];
+    }
+  }
+
+  cinfo->nchanged = 0;
+
+  return 0;
+}
+
 /*****************************************************************************
  *
  *  colloids_info_map_update
@@ -487,22 +586,21 @@ __host__ int colloids_info_nhalo(colloids_info_t * cinfo, int * nhalo) {
 
 __host__ int colloids_info_nlocal(colloids_info_t * cinfo, int * nlocal) {
 
-  int ic, jc, kc;
-  colloid_t * pc = NULL;
+  colloid_cell_table_t * ct = NULL;
 
   assert(cinfo);
   assert(nlocal);
 
   *nlocal = 0;
+  colloids_info_cell_table(cinfo, &ct);
 
-  for (ic = 1; ic <= cinfo->ncell[X]; ic++) {
-    for (jc = 1; jc <= cinfo->ncell[Y]; jc++) {
-      for (kc = 1; kc <= cinfo->ncell[Z]; kc++) {
-
-	colloids_info_cell_list_head(cinfo, ic, jc, kc, &pc);
-	for (; pc; pc = pc->next) *nlocal += 1;
+  /* Cells (ic, jc, 1) to (ic, jc, ncell[Z]) are contiguous */
 
-      }
+  for (int ic = 1; ic <= cinfo->ncell[X]; ic++) {
+    for (int jc = 1; jc <= cinfo->ncell[Y]; jc++) {
+      int n0 = colloids_info_cell_index(cinfo, ic, jc, 1);
+      int n1 = colloids_info_cell_index(cinfo, ic, jc, cinfo->ncell[Z]);
+      *nlocal += ct->start[n1 + 1] - ct->start[n0];
     }
   }
 
@@ -551,6 +649,27 @@ __host__ int colloids_info_cell_list_head(colloids_info_t * cinfo,
   return 0;
 }
 
+/*****************************************************************************
+ *
+ *  colloids_info_cell_table
+ *
+ *  Return the flat copy of the cell list, rebuilt if the cell list
+ *  has changed. The table must not be retained across any change
+ *  to the cell list (insertion or removal of colloids).
+ *
+ *****************************************************************************/
+
+__host__ int colloids_info_cell_table(colloids_info_t * cinfo,
+				      colloid_cell_table_t ** ct) {
+  assert(cinfo);
+  assert(ct);
+
+  colloid_cell_table_update(cinfo->ctable, cinfo);
+  *ct = cinfo->ctable;
+
+  return 0;
+}
+
 /*****************************************************************************
  *
  *  colloids_info_cell_coords
@@ -614,6 +733,7 @@ int colloids_info_insert_colloid(colloids_info_t * cinfo, colloid_t * coll) {
 
   colloids_info_cell_coords(cinfo, coll->s.r, newcell);
   index = colloids_info_cell_index(cinfo, newcell[X], newcell[Y], newcell[Z]);
+  cinfo->clist_version += 1;
 
   p_current = cinfo->clist[index];
   p_previous = p_current;
@@ -756,6 +876,12 @@ __host__ int colloids_info_update_cell_list(colloids_info_t * cinfo) {
 
 	      colloids_info_insert_colloid(cinfo, p_colloid);
 
+	      /* A move between a local and a halo cell changes ownership */
+	      if (colloids_info_cell_local(cinfo, ic, jc, kc) !=
+		  colloids_info_cell_local(cinfo, cell[X], cell[Y], cell[Z])) {
+		cinfo->owner_version += 1;
+	      }
+
 	      p_colloid = tmp;
 	    }
 	  }
@@ -840,6 +966,7 @@ __host__ int colloids_info_add(colloids_info_t * cinfo, int index,
   (*pc)->s.rebuild = 1;
 
   colloids_info_insert_colloid(cinfo, *pc);
+  cinfo->owner_version += 1;
 
   return 0;
 }
@@ -886,10 +1013,33 @@ __host__ void colloid_free(colloids_info_t * cinfo, colloid_t * pc) {
   assert(cinfo);
   assert(pc);
 
+  if (pc->build.mapped) {
+    /* Record the sites which must be cleared at the next map update */
+    if (cinfo->nvacant == cinfo->nvacantmax) {
+      int nmax = 2*cinfo->nvacantmax + 8;
+      colloid_t ** tmp = NULL;
+      int * btmp = NULL;
+      tmp = (colloid_t **) realloc(cinfo->vacant, nmax*sizeof(colloid_t *));
+      btmp = (int *) realloc(cinfo->vacant_box, 6*nmax*sizeof(int));
+      if (tmp) cinfo->vacant = tmp;
+      if (btmp) cinfo->vacant_box = btmp;
+      if (tmp == NULL || btmp == NULL) pe_fatal(cinfo->pe, "realloc(vacant)\n");
+      cinfo->nvacantmax = nmax;
+    }
+    cinfo->vacant[cinfo->nvacant] = pc;
+    for (int ia = 0; ia < 3; ia++) {
+      cinfo->vacant_box[6*cinfo->nvacant + ia]     = pc->build.box[0][ia];
+      cinfo->vacant_box[6*cinfo->nvacant + 3 + ia] = pc->build.box[1][ia];
+    }
+    cinfo->nvacant += 1;
+  }
+
   colloid_link_free_list(pc->lnk);
   tdpAssert(tdpFree(pc));
 
   cinfo->nallocated -= 1;
+  cinfo->clist_version += 1;
+  cinfo->owner_version += 1;
 
   return;
 }
@@ -982,14 +1132,15 @@ int colloids_info_v_local(colloids_info_t * cinfo, double * v) {
 __host__ int colloids_info_cell_count(colloids_info_t * cinfo, int ic, int jc, int kc,
 			     int * ncount) {
 
-  colloid_t * pc = NULL;
+  int index = 0;
+  colloid_cell_table_t * ct = NULL;
 
   assert(cinfo);
   assert(ncount);
 
-  *ncount = 0;
-  colloids_info_cell_list_head(cinfo, ic, jc, kc, &pc);
-  for (; pc; pc = pc->next) *ncount += 1;
+  colloids_info_cell_table(cinfo, &ct);
+  index = colloids_info_cell_index(cinfo, ic, jc, kc);
+  *ncount = ct->start[index + 1] - ct->start[index];
 
   return 0;
 }
@@ -1113,40 +1264,18 @@ __host__ int colloids_info_update_lists(colloids_info_t * cinfo) {
 
 __host__ int colloids_info_list_all_build(colloids_info_t * cinfo) {
 
-  int n;
-  colloid_t * pc;
-  colloid_t * lastcell = NULL;  /* Last colloid, last cell */
+  colloid_cell_table_t * ct = NULL;
 
   assert(cinfo);
 
-  /* Nullify the entire list and locate the first colloid. */
-
-  cinfo->headall = NULL;
+  colloids_info_cell_table(cinfo, &ct);
 
-  for (n = 0; n < cinfo->ncells; n++) {
-    for (pc = cinfo->clist[n]; pc; pc = pc->next) {
-      if (cinfo->headall == NULL) cinfo->headall = pc;
-      pc->nextall = NULL;
-    }
-  }
+  /* The table is already in the required order */
 
-  /* Now link up the all the individual cell lists via nextall */
+  cinfo->headall = (ct->nall > 0) ? ct->pc[0] : NULL;
 
-  for (n = 0; n < cinfo->ncells; n++) {
-
-    for (pc = cinfo->clist[n]; pc; pc = pc->next) {
-      if (lastcell) {
-	lastcell->nextall = pc;
-	lastcell = NULL;
-      }
-
-      if (pc->next) {
-	pc->nextall = pc->next;
-      }
-      else {
-	lastcell = pc;
-      }
-    }
+  for (int n = 0; n < ct->nall; n++) {
+    ct->pc[n]->nextall = (n + 1 < ct->nall) ? ct->pc[n + 1] : NULL;
   }
 
   return 0;
@@ -1162,54 +1291,28 @@ __host__ int colloids_info_list_all_build(colloids_info_t * cinfo) {
 
 __host__ int colloids_info_list_local_build(colloids_info_t * cinfo) {
 
-  int ic, jc, kc;
-  colloid_t * pc;
   colloid_t * lastcell = NULL;
+  colloid_cell_table_t * ct = NULL;
 
   assert(cinfo);
 
-  /* Find first local colloid; nullify any existing list */
-
-  cinfo->headlocal = NULL;
-
-  for (ic = 1; ic <= cinfo->ncell[X]; ic++) {
-    for (jc = 1; jc <= cinfo->ncell[Y]; jc++) {
-      for (kc = 1; kc <= cinfo->ncell[Z]; kc++) {
-
-	colloids_info_cell_list_head(cinfo, ic, jc, kc, &pc);
-
-	for (; pc; pc = pc->next) {
-	  if (cinfo->headlocal == NULL) cinfo->headlocal = pc;
-	  pc->nextlocal = NULL;
-	}
-      }
-    }
-  }
+  colloids_info_cell_table(cinfo, &ct);
 
-  /* Now link up the list via nextlocal */
+  /* Link up the local cells (ic, jc, 1..ncell[Z]) via nextlocal */
 
-  lastcell = NULL;
-
-  for (ic = 1; ic <= cinfo->ncell[X]; ic++) {
-    for (jc = 1; jc <= cinfo->ncell[Y]; jc++) {
-      for (kc = 1; kc <= cinfo->ncell[Z]; kc++) {
-
-	colloids_info_cell_list_head(cinfo, ic, jc, kc, &pc);
-
-	for (; pc; pc = pc->next) {
-	  if (lastcell) {
-	    lastcell->nextlocal = pc;
-	    lastcell = NULL;
-	  }
+  cinfo->headlocal = NULL;
 
-	  if (pc->next) {
-	    pc->nextlocal = pc->next;
-	  }
-	  else {
-	    lastcell = pc;
-	  }
-	}
+  for (int ic = 1; ic <= cinfo->ncell[X]; ic++) {
+    for (int jc = 1; jc <= cinfo->ncell[Y]; jc++) {
+      int n0 = colloids_info_cell_index(cinfo, ic, jc, 1);
+      int n1 = colloids_info_cell_index(cinfo, ic, jc, cinfo->ncell[Z]);
 
+      for (int n = ct->start[n0]; n < ct->start[n1 + 1]; n++) {
+	colloid_t * pc = ct->pc[n];
+	if (cinfo->headlocal == NULL) cinfo->headlocal = pc;
+	if (lastcell) lastcell->nextlocal = pc;
+	pc->nextlocal = NULL;
+	lastcell = pc;
       }
     }
   }
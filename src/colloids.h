@@ -44,6 +44,22 @@ struct colloid_diagnostic_s {
    * hydrodynamic contribution. */
 };
 
+/* Auxiliary for incremental map and link updates (see build.c) */
+
+typedef struct colloid_build_s colloid_build_t;
+
+struct colloid_build_s {
+  int mapped;           /* Sites of this colloid are set in the map */
+  int relink;           /* Links require reset at next link update */
+  int box[2][3];        /* Range of sites examined at last map update */
+  colloid_state_t s;    /* State at last map update */
+  double sumw;          /* Local link sums at last link update ... */
+  double cbar[3];
+  double rxcbar[3];
+  double sa;            /* ... and surface areas */
+  double saf;
+};
+
 /* Colloid structure */
 
 typedef struct colloid colloid_t;
@@ -78,6 +94,10 @@ struct colloid {
 
   colloid_diagnostic_t diagnostic;
 
+  /* Map and link bookkeeping between rebuilds */
+
+  colloid_build_t build;
+
   /* Pointers */
 
   colloid_link_t * lnk; /* Pointer to the list of links defining surface */
@@ -106,6 +126,9 @@ struct colloids_info_s {
   int nsubgrid;               /* Total number of subgrid particles */
   int rebuild_freq;           /* Rebuild shape every so many steps */
 
+  unsigned int clist_version; /* Incremented on any cell list change */
+  unsigned int owner_version; /* Incremented on any change in ownership */
+
   double rho0;                /* Mean density (usually matches fluid) */
   double drmax;               /* Maximum movement per time step */
 
@@ -120,6 +143,21 @@ struct colloids_info_s {
   colloid_t * headall;        /* All colloid list (incl. halo) head */
   colloid_t * headlocal;      /* Local list (excl. halo) head */
 
+  int map_nupdate;            /* Number of map updates */
+  int map_isdelta;            /* map_changed[] has all changes at last update */
+  int nchanged;               /* Number of map sites changed ... */
+  int nchangedmax;
+  int * map_changed;          /* ... at last update (site indices) */
+  int nvacant;                /* Colloids freed with sites in the map */
+  int nvacantmax;
+  colloid_t ** vacant;        /* Freed colloid (pointer value only) */
+  int * vacant_box;           /* Sites set by freed colloid [6*nvacant] */
+
+  struct colloid_cell_table_s * ctable; /* Flat copy of cell list */
+  struct colloid_link_table_s * ltable; /* Flat boundary link table */
+  struct colloid_pair_list_s * plist;   /* Verlet list of pairs */
+  struct colloid_halo_s * halo;         /* Persistent halo lists (or NULL) */
+
   pe_t * pe;                  /* Parallel environment */
   cs_t * cs;                  /* Coordinate system */
   colloids_info_t * target;   /* Copy of this structure on target */
@@ -150,6 +188,8 @@ __host__ int colloids_info_all_head(colloids_info_t * cinfo, colloid_t ** pc);
 __host__ int colloids_info_local_head(colloids_info_t * cinfo, colloid_t ** pc);
 __host__ int colloids_info_cell_list_head(colloids_info_t * info,
 				 int ic, int jc, int kc, colloid_t ** pc);
+__host__ int colloids_info_cell_table(colloids_info_t * cinfo,
+				      struct colloid_cell_table_s ** ct);
 __host__ int colloids_info_cell_coords(colloids_info_t * cinfo, const double r[3],
 			      int icell[3]);
 __host__ int colloids_info_add_local(colloids_info_t * cinfo, int index,
@@ -166,6 +206,8 @@ __host__ int colloids_info_map_update(colloids_info_t * cinfo);
 __host__ int colloids_info_position_update(colloids_info_t * cinfo);
 __host__ int colloids_info_map_set(colloids_info_t * cinfo, int index,
 			      colloid_t * pc);
+__host__ int colloids_info_map_changed_add(colloids_info_t * cinfo, int index);
+__host__ int colloids_info_map_sync(colloids_info_t * cinfo);
 __host__ int colloids_info_update_lists(colloids_info_t * cinfo);
 __host__ int colloids_info_list_all_build(colloids_info_t * cinfo);
 __host__ int colloids_info_list_local_build(colloids_info_t * cinfo);
@@ -4,10 +4,22 @@
  *
  *  Halo exchange of colloid state information.
  *
+ *  By default, the full state of each colloid in the boundary cells
+ *  is sent at every exchange, and the receiving side searches the
+ *  cell list for an existing copy.
+ *
+ *  If persistent lists are requested (colloids_halo_persistent_set()),
+ *  the colloids sent and received in each direction are retained
+ *  between exchanges. While the cell list is unchanged on both sides
+ *  of a given message (no colloid has changed cell, arrived or left),
+ *  only the part of the state which may change at each step is sent,
+ *  and is unloaded directly via the stored list. Otherwise, the full
+ *  state is sent as before and the lists are rebuilt.
+ *
  *  Edinburgh Soft Matter and Statistical Physics Group and
  *  Edinburgh Parallel Computing Centre
  *
- *  (c) 2010-2021 The University of Edinburgh
+ *  (c) 2010-2024 The University of Edinburgh
  *
  *  Contributing authors:
  *  Kevin Stratford (kevin@epcc.ed.ac.uk)
@@ -23,8 +35,40 @@
 #include "coords.h"
 #include "colloids.h"
 #include "colloids_halo.h"
+#include "colloid_cell_table.h"
 #include "util.h"
 
+typedef struct colloid_halo_list_s colloid_halo_list_t;
+typedef struct colloid_halo_msg_s colloid_halo_msg_t;
+
+struct colloid_halo_list_s {
+  int n;                   /* Number of colloids in list */
+  int nmax;                /* Capacity */
+  colloid_t ** pc;         /* Colloids in message order */
+};
+
+/* Compact message: the part of the state which may change at each step.
+ * The remaining components are fixed once the halo copy is created. */
+
+struct colloid_halo_msg_s {
+  int index;
+  int rebuild;
+  int rng;
+  int ipad;
+  double r[3];
+  double v[3];
+  double w[3];
+  double s[3];
+  double m[3];
+  double dr[3];
+  double sa;
+  double saf;
+  double deltaq0;
+  double deltaq1;
+  double quat[4];
+  double quatold[4];
+};
+
 struct colloid_halo_s {
   pe_t * pe;               /* Parallel environment */
   cs_t * cs;               /* Coordinate system */
@@ -33,19 +77,43 @@ struct colloid_halo_s {
   colloid_state_t * recv;
   int nsend[2];
   int nrecv[2];
+
+  /* Persistent lists only */
+  int persistent;                  /* Retain lists between exchanges */
+  int valid;                       /* Lists are consistent with cell list */
+  int built;                       /* At least one exchange has taken place */
+  unsigned int version;            /* cinfo->clist_version after exchange */
+  int fast[2];                     /* Compact message flag by direction */
+  int nbufmax;                     /* Capacity of message buffers */
+  colloid_halo_msg_t * csend;      /* Compact send buffer */
+  colloid_halo_msg_t * crecv;      /* Compact receive buffer */
+  colloid_halo_list_t slist[3][2]; /* Send lists [dim][direction] */
+  colloid_halo_list_t rlist[3][2]; /* Receive lists [dim][direction] */
 };
 
 static const int tagf_ = 1061;
 static const int tagb_ = 1062;
 
 static int colloids_halo_load(colloid_halo_t * halo, int dim);
-static int colloids_halo_unload(colloid_halo_t * halo, int nrecv);
+static int colloids_halo_unload(colloid_halo_t * halo, int noff, int nrecv,
+				colloid_halo_list_t * list);
 static int colloids_halo_number(colloid_halo_t * halo, int dim);
 static int colloids_halo_irecv(colloid_halo_t * halo, int dim, MPI_Request req[2]);
 static int colloids_halo_isend(colloid_halo_t * halo, int dim, MPI_Request req[2]);
 static int colloids_halo_load_list(colloid_halo_t * halo,
 				   int ic, int jc, int kc,
-				   const double rperiod[3], int noff);
+				   const double rperiod[3], int noff,
+				   colloid_halo_list_t * list);
+static int colloids_halo_rperiod(colloid_halo_t * halo, int dim,
+				 double rback[3], double rforw[3]);
+static int colloids_halo_dim_persistent(colloid_halo_t * halo, int dim);
+static int colloids_halo_header(colloid_halo_t * halo, int dim);
+static int colloids_halo_reserve(colloid_halo_t * halo);
+static int colloids_halo_pack(colloid_halo_t * halo, int dim);
+static int colloids_halo_unpack(colloid_halo_t * halo, int noff, int nrecv,
+				colloid_halo_list_t * list);
+static int colloids_halo_list_reserve(colloid_halo_t * halo,
+				      colloid_halo_list_t * list, int n);
 
 /*****************************************************************************
  *
@@ -86,11 +154,51 @@ void colloids_halo_free(colloid_halo_t * halo) {
 
   assert(halo);
 
+  for (int ia = 0; ia < 3; ia++) {
+    for (int p = 0; p < 2; p++) {
+      free(halo->slist[ia][p].pc);
+      free(halo->rlist[ia][p].pc);
+    }
+  }
+
+  if (halo->persistent) {
+    free(halo->send);
+    free(halo->recv);
+    free(halo->csend);
+    free(halo->crecv);
+  }
+
   free(halo);
 
   return;
 }
 
+/*****************************************************************************
+ *
+ *  colloids_halo_persistent_set
+ *
+ *  Switch persistent lists on (persistent != 0) or off for the state
+ *  exchange colloids_halo_state(). The lists are held by cinfo.
+ *
+ *****************************************************************************/
+
+int colloids_halo_persistent_set(colloids_info_t * cinfo, int persistent) {
+
+  assert(cinfo);
+
+  if (cinfo->halo) {
+    colloids_halo_free(cinfo->halo);
+    cinfo->halo = NULL;
+  }
+
+  if (persistent) {
+    colloids_halo_create(cinfo, &cinfo->halo);
+    cinfo->halo->persistent = 1;
+  }
+
+  return 0;
+}
+
 /*****************************************************************************
  *
  *  colloids_halo_state
@@ -110,6 +218,22 @@ int colloids_halo_state(colloids_info_t * cinfo) {
 
   assert(cinfo);
 
+  if (cinfo->halo) {
+    /* The lists are valid if there has been no change in the cell
+     * list since the end of the last exchange. */
+    halo = cinfo->halo;
+    halo->valid = (halo->built && halo->version == cinfo->clist_version);
+
+    colloids_halo_dim(halo, X);
+    colloids_halo_dim(halo, Y);
+    colloids_halo_dim(halo, Z);
+
+    halo->built = 1;
+    halo->version = cinfo->clist_version;
+
+    return 0;
+  }
+
   halo = (colloid_halo_t *) calloc(1, sizeof(colloid_halo_t));
   assert(halo);
   if (halo == NULL) pe_fatal(cinfo->pe, "calloc(colloid_halo_t) failed\n");
@@ -146,6 +270,8 @@ int colloids_halo_dim(colloid_halo_t * halo, int dim) {
   assert(halo);
   assert(halo->cinfo);
 
+  if (halo->persistent) return colloids_halo_dim_persistent(halo, dim);
+
   /* Work out how many are currently in the 'send' region, and
    * communicate the information to work out recv count */
 
@@ -175,7 +301,7 @@ int colloids_halo_dim(colloid_halo_t * halo, int dim) {
   /* Wait for the receives, unload the recv buffer, and finish */
 
   MPI_Waitall(2, request_recv, status);
-  colloids_halo_unload(halo, n);
+  colloids_halo_unload(halo, 0, n, NULL);
   free(halo->recv);
 
   MPI_Waitall(2, request_send, status);
@@ -184,6 +310,78 @@ int colloids_halo_dim(colloid_halo_t * halo, int dim) {
   return 0;
 }
 
+/*****************************************************************************
+ *
+ *  colloids_halo_dim_persistent
+ *
+ *  As colloids_halo_dim(), but using the persistent lists where the
+ *  two sides of a message agree they are valid. Any change in the
+ *  cell list here (new halo copies) invalidates the lists for the
+ *  remaining dimensions.
+ *
+ *****************************************************************************/
+
+static int colloids_halo_dim_persistent(colloid_halo_t * halo, int dim) {
+
+  unsigned int version;
+
+  MPI_Request request_send[2];
+  MPI_Request request_recv[2];
+  MPI_Status  status[2];
+
+  assert(halo);
+  assert(halo->persistent);
+
+  version = halo->cinfo->clist_version;
+
+  if (halo->valid) {
+    halo->nsend[BACKWARD] = halo->slist[dim][BACKWARD].n;
+    halo->nsend[FORWARD]  = halo->slist[dim][FORWARD].n;
+  }
+  else {
+    colloids_halo_send_count(halo, dim, NULL);
+  }
+
+  colloids_halo_header(halo, dim);
+  colloids_halo_reserve(halo);
+
+  colloids_halo_irecv(halo, dim, request_recv);
+
+  /* A full load rebuilds both send lists; compact messages use them */
+
+  if (halo->fast[BACKWARD] == 0 || halo->fast[FORWARD] == 0) {
+    colloids_halo_load(halo, dim);
+  }
+  colloids_halo_pack(halo, dim);
+  colloids_halo_isend(halo, dim, request_send);
+
+  MPI_Waitall(2, request_recv, status);
+
+  if (halo->fast[FORWARD]) {
+    colloids_halo_unpack(halo, 0, halo->nrecv[FORWARD],
+			 &halo->rlist[dim][FORWARD]);
+  }
+  else {
+    colloids_halo_unload(halo, 0, halo->nrecv[FORWARD],
+			 &halo->rlist[dim][FORWARD]);
+  }
+
+  if (halo->fast[BACKWARD]) {
+    colloids_halo_unpack(halo, halo->nrecv[FORWARD], halo->nrecv[BACKWARD],
+			 &halo->rlist[dim][BACKWARD]);
+  }
+  else {
+    colloids_halo_unload(halo, halo->nrecv[FORWARD], halo->nrecv[BACKWARD],
+			 &halo->rlist[dim][BACKWARD]);
+  }
+
+  MPI_Waitall(2, request_send, status);
+
+  if (halo->cinfo->clist_version != version) halo->valid = 0;
+
+  return 0;
+}
+
 /*****************************************************************************
  *
  *  colloids_halo_send_count
@@ -256,7 +454,6 @@ int colloids_halo_send_count(colloid_halo_t * halo, int dim, int * nreturn) {
 
 static int colloids_halo_load(colloid_halo_t * halo, int dim) {
 
-  int p;
   int ic, jc, kc;
   int noff;         /* Offset in the send buffer to fill */
   int nsent_forw;   /* Counter for particles put into send forw buffer */
@@ -264,6 +461,8 @@ static int colloids_halo_load(colloid_halo_t * halo, int dim) {
   int ncell[3];
   double rforw[3];
   double rback[3];
+  colloid_halo_list_t * sback = NULL;
+  colloid_halo_list_t * sforw = NULL;
 
   assert(halo);
 
@@ -272,29 +471,28 @@ static int colloids_halo_load(colloid_halo_t * halo, int dim) {
   nsent_forw = 0;
   nsent_back = 0;
 
-  for (p = 0; p < 3; p++) {
-    rback[p] = 0.0;
-    rforw[p] = 0.0;
-  }
+  colloids_halo_rperiod(halo, dim, rback, rforw);
 
-  /* The factor (1-epsilon) here is to prevent problems associated
-   * with a colloid position *exactly* on a cell boundary. */
+  /* Persistent lists are rebuilt at the same time */
 
-  p = halo->cs->param->mpi_cartcoords[dim];
-  if (p == 0) {
-    rback[dim] = (1.0-DBL_EPSILON)*halo->cs->param->ntotal[dim];
-  }
-  if (p == halo->cs->param->mpi_cartsz[dim] - 1) {
-    rforw[dim] = -1.0*halo->cs->param->ntotal[dim];
+  if (halo->persistent) {
+    sback = &halo->slist[dim][BACKWARD];
+    sforw = &halo->slist[dim][FORWARD];
+    colloids_halo_list_reserve(halo, sback, halo->nsend[BACKWARD]);
+    colloids_halo_list_reserve(halo, sforw, halo->nsend[FORWARD]);
+    sback->n = 0;
+    sforw->n = 0;
   }
 
   if (dim == X) {
     for (jc = 1; jc <= ncell[Y]; jc++) {
       for (kc = 1; kc <= ncell[Z]; kc++) {
 	noff = nsent_back;
-	nsent_back += colloids_halo_load_list(halo, 1, jc, kc, rback, noff);
+	nsent_back += colloids_halo_load_list(halo, 1, jc, kc, rback, noff,
+					      sback);
 	noff = halo->nsend[BACKWARD] + nsent_forw;
-	nsent_forw += colloids_halo_load_list(halo, ncell[X], jc, kc, rforw, noff);
+	nsent_forw += colloids_halo_load_list(halo, ncell[X], jc, kc, rforw,
+					      noff, sforw);
       }
     }
   }
@@ -303,9 +501,11 @@ static int colloids_halo_load(colloid_halo_t * halo, int dim) {
     for (ic = 0; ic <= ncell[X] + 1; ic++) {
       for (kc = 1; kc <= ncell[Z]; kc++) {
 	noff = nsent_back;
-	nsent_back += colloids_halo_load_list(halo, ic, 1, kc, rback, noff);
+	nsent_back += colloids_halo_load_list(halo, ic, 1, kc, rback, noff,
+					      sback);
 	noff = halo->nsend[BACKWARD] + nsent_forw;
-	nsent_forw += colloids_halo_load_list(halo, ic, ncell[Y], kc, rforw, noff); 
+	nsent_forw += colloids_halo_load_list(halo, ic, ncell[Y], kc, rforw,
+					      noff, sforw);
       }
     }
   }
@@ -314,9 +514,11 @@ static int colloids_halo_load(colloid_halo_t * halo, int dim) {
     for (ic = 0; ic <= ncell[X] + 1; ic++) {
       for (jc = 0; jc <= ncell[Y] + 1; jc++) {
 	noff = nsent_back;
-	nsent_back += colloids_halo_load_list(halo, ic, jc, 1, rback, noff);
+	nsent_back += colloids_halo_load_list(halo, ic, jc, 1, rback, noff,
+					      sback);
 	noff = halo->nsend[BACKWARD] + nsent_forw;
-	nsent_forw += colloids_halo_load_list(halo, ic, jc, ncell[Z], rforw, noff); 
+	nsent_forw += colloids_halo_load_list(halo, ic, jc, ncell[Z], rforw,
+					      noff, sforw);
       }
     }
   }
@@ -335,22 +537,28 @@ static int colloids_halo_load(colloid_halo_t * halo, int dim) {
  *  periodic boundary conditions to the copy before it leaves.
  *  noff is the offset in the buffer for this cell list.
  *
+ *  If list is not NULL, the colloids are also appended to the list.
+ *
  *  Return the number of particles loaded.
  *
  *****************************************************************************/
 
 static int colloids_halo_load_list(colloid_halo_t * halo,
 				   int ic, int jc, int kc,
-				   const double rperiod[3], int noff) {
+				   const double rperiod[3], int noff,
+				   colloid_halo_list_t * list) {
   int n;
-  colloid_t * pc = NULL;
+  int icell;
+  colloid_cell_table_t * ct = NULL;
 
   assert(halo);
 
   n = 0;
-  colloids_info_cell_list_head(halo->cinfo, ic, jc, kc, &pc);
+  colloids_info_cell_table(halo->cinfo, &ct);
+  icell = colloids_info_cell_index(halo->cinfo, ic, jc, kc);
 
-  while (pc) {
+  for (int ip = ct->start[icell]; ip < ct->start[icell + 1]; ip++) {
+    colloid_t * pc = ct->pc[ip];
     halo->send[noff + n] = pc->s;
     halo->send[noff + n].r[X] = pc->s.r[X] + rperiod[X];
     halo->send[noff + n].r[Y] = pc->s.r[Y] + rperiod[Y];
@@ -358,8 +566,8 @@ static int colloids_halo_load_list(colloid_halo_t * halo,
     /* Because delta phi is accumulated across copies at each time step,
      * we must zero the outgoing copy here to avoid overcounting */
     halo->send[noff + n].deltaphi = 0.0;
+    if (list) list->pc[list->n++] = pc;
     n++;
-    pc = pc->next;
   }
 
   return n;
@@ -374,19 +582,29 @@ static int colloids_halo_load_list(colloid_halo_t * halo,
  *  if it's already present, make a copy of the state; if it's new,
  *  add the incoming particle to the list.
  *
+ *  The nrecv entries start at offset noff in the receive buffer.
+ *  If list is not NULL, it is rebuilt with the local copies.
+ *
  *****************************************************************************/
 
-static int colloids_halo_unload(colloid_halo_t * halo, int nrecv) {
+static int colloids_halo_unload(colloid_halo_t * halo, int noff, int nrecv,
+				colloid_halo_list_t * list) {
 
   int n;
   int exists;
   int index;
   int cell[3];
   colloid_t * pc = NULL;
+  colloid_t * pcopy = NULL;
 
   assert(halo);
 
-  for (n = 0; n < nrecv; n++) {
+  if (list) {
+    colloids_halo_list_reserve(halo, list, nrecv);
+    list->n = nrecv;
+  }
+
+  for (n = noff; n < noff + nrecv; n++) {
 
     exists = 0;
     index = halo->recv[n].index;
@@ -401,6 +619,7 @@ static int colloids_halo_unload(colloid_halo_t * halo, int nrecv) {
 	phi = pc->s.deltaphi;
 	pc->s = halo->recv[n];
 	pc->s.deltaphi = phi;
+	pcopy = pc;
 	exists = 1;
       }
 
@@ -412,7 +631,10 @@ static int colloids_halo_unload(colloid_halo_t * halo, int nrecv) {
       assert(pc);
       pc->s = halo->recv[n];
       pc->s.rebuild = 1;
+      pcopy = pc;
     }
+
+    if (list) list->pc[n - noff] = pcopy;
   }
 
   return 0;
@@ -442,12 +664,25 @@ static int colloids_halo_irecv(colloid_halo_t * halo, int dim,
     pforw = halo->cs->mpi_cart_neighbours[CS_FORW][dim];
     pback = halo->cs->mpi_cart_neighbours[CS_BACK][dim];
 
-    n = halo->nrecv[CS_FORW]*sizeof(colloid_state_t);
-    MPI_Irecv(halo->recv, n, MPI_BYTE, pforw, tagb_, comm, req);
+    if (halo->fast[CS_FORW]) {
+      n = halo->nrecv[CS_FORW]*sizeof(colloid_halo_msg_t);
+      MPI_Irecv(halo->crecv, n, MPI_BYTE, pforw, tagb_, comm, req);
+    }
+    else {
+      n = halo->nrecv[CS_FORW]*sizeof(colloid_state_t);
+      MPI_Irecv(halo->recv, n, MPI_BYTE, pforw, tagb_, comm, req);
+    }
 
-    n = halo->nrecv[CS_BACK]*sizeof(colloid_state_t);
-    MPI_Irecv(halo->recv + halo->nrecv[CS_FORW], n, MPI_BYTE, pback, tagf_,
-	      comm, req + 1);
+    if (halo->fast[CS_BACK]) {
+      n = halo->nrecv[CS_BACK]*sizeof(colloid_halo_msg_t);
+      MPI_Irecv(halo->crecv + halo->nrecv[CS_FORW], n, MPI_BYTE, pback,
+		tagf_, comm, req + 1);
+    }
+    else {
+      n = halo->nrecv[CS_BACK]*sizeof(colloid_state_t);
+      MPI_Irecv(halo->recv + halo->nrecv[CS_FORW], n, MPI_BYTE, pback,
+		tagf_, comm, req + 1);
+    }
   }
 
   return 0;
@@ -473,9 +708,17 @@ static int colloids_halo_isend(colloid_halo_t * halo, int dim,
 
   if (halo->cs->param->mpi_cartsz[dim] == 1) {
 
+    /* Both directions are the same message here */
+    assert(halo->fast[CS_FORW] == halo->fast[CS_BACK]);
+
     if (halo->cs->param->periodic[dim]) {
       n = halo->nsend[CS_FORW] + halo->nsend[CS_BACK];
-      memcpy(halo->recv, halo->send, n*sizeof(colloid_state_t));
+      if (halo->fast[CS_FORW]) {
+	memcpy(halo->crecv, halo->csend, n*sizeof(colloid_halo_msg_t));
+      }
+      else {
+	memcpy(halo->recv, halo->send, n*sizeof(colloid_state_t));
+      }
     }
 
     req[0] = MPI_REQUEST_NULL;
@@ -487,12 +730,25 @@ static int colloids_halo_isend(colloid_halo_t * halo, int dim,
     pforw = halo->cs->mpi_cart_neighbours[CS_FORW][dim];
     pback = halo->cs->mpi_cart_neighbours[CS_BACK][dim];
 
-    n = halo->nsend[CS_FORW]*sizeof(colloid_state_t);
-    MPI_Issend(halo->send + halo->nsend[CS_BACK], n, MPI_BYTE, pforw, tagf_,
-	       comm, req);
+    if (halo->fast[CS_FORW]) {
+      n = halo->nsend[CS_FORW]*sizeof(colloid_halo_msg_t);
+      MPI_Issend(halo->csend + halo->nsend[CS_BACK], n, MPI_BYTE, pforw,
+		 tagf_, comm, req);
+    }
+    else {
+      n = halo->nsend[CS_FORW]*sizeof(colloid_state_t);
+      MPI_Issend(halo->send + halo->nsend[CS_BACK], n, MPI_BYTE, pforw,
+		 tagf_, comm, req);
+    }
 
-    n = halo->nsend[CS_BACK]*sizeof(colloid_state_t);
-    MPI_Issend(halo->send, n, MPI_BYTE, pback, tagb_, comm, req + 1);
+    if (halo->fast[CS_BACK]) {
+      n = halo->nsend[CS_BACK]*sizeof(colloid_halo_msg_t);
+      MPI_Issend(halo->csend, n, MPI_BYTE, pback, tagb_, comm, req + 1);
+    }
+    else {
+      n = halo->nsend[CS_BACK]*sizeof(colloid_state_t);
+      MPI_Issend(halo->send, n, MPI_BYTE, pback, tagb_, comm, req + 1);
+    }
   }
 
   return 0;
@@ -546,3 +802,275 @@ static int colloids_halo_number(colloid_halo_t * halo, int dim) {
 
   return 0;
 }
+
+/*****************************************************************************
+ *
+ *  colloids_halo_rperiod
+ *
+ *  Periodic shift for backward and forward going copies.
+ *
+ *****************************************************************************/
+
+static int colloids_halo_rperiod(colloid_halo_t * halo, int dim,
+				 double rback[3], double rforw[3]) {
+  int p;
+
+  assert(halo);
+
+  for (p = 0; p < 3; p++) {
+    rback[p] = 0.0;
+    rforw[p] = 0.0;
+  }
+
+  /* The factor (1-epsilon) here is to prevent problems associated
+   * with a colloid position *exactly* on a cell boundary. */
+
+  p = halo->cs->param->mpi_cartcoords[dim];
+  if (p == 0) {
+    rback[dim] = (1.0-DBL_EPSILON)*halo->cs->param->ntotal[dim];
+  }
+  if (p == halo->cs->param->mpi_cartsz[dim] - 1) {
+    rforw[dim] = -1.0*halo->cs->param->ntotal[dim];
+  }
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  colloids_halo_header
+ *
+ *  Replaces colloids_halo_number() for persistent lists. Each side
+ *  sends {valid, number to send, number in receive list} so that both
+ *  ends of a message can decide whether the compact form is used:
+ *  both lists must be valid and the counts must match.
+ *
+ *****************************************************************************/
+
+static int colloids_halo_header(colloid_halo_t * halo, int dim) {
+
+  int p;
+  int hsend[2][3] = {0};
+  int hrecv[2][3] = {0};
+
+  assert(halo);
+
+  for (p = 0; p < 2; p++) {
+    hsend[p][0] = halo->valid;
+    hsend[p][1] = halo->nsend[p];
+    hsend[p][2] = halo->rlist[dim][p].n;
+  }
+
+  if (halo->cs->param->mpi_cartsz[dim] == 1) {
+    if (halo->cs->param->periodic[dim]) {
+      for (p = 0; p < 3; p++) {
+	hrecv[CS_FORW][p] = hsend[CS_BACK][p];
+	hrecv[CS_BACK][p] = hsend[CS_FORW][p];
+      }
+    }
+  }
+  else {
+    int pforw = halo->cs->mpi_cart_neighbours[CS_FORW][dim];
+    int pback = halo->cs->mpi_cart_neighbours[CS_BACK][dim];
+    MPI_Comm comm = halo->cs->commcart;
+    MPI_Request request[4];
+
+    MPI_Irecv(hrecv[CS_FORW], 3, MPI_INT, pforw, tagb_, comm, request);
+    MPI_Irecv(hrecv[CS_BACK], 3, MPI_INT, pback, tagf_, comm, request + 1);
+    MPI_Issend(hsend[CS_FORW], 3, MPI_INT, pforw, tagf_, comm, request + 2);
+    MPI_Issend(hsend[CS_BACK], 3, MPI_INT, pback, tagb_, comm, request + 3);
+
+    MPI_Waitall(4, request, MPI_STATUSES_IGNORE);
+  }
+
+  for (p = 0; p < 2; p++) {
+    halo->nrecv[p] = hrecv[p][1];
+    halo->fast[p] = (halo->valid && hrecv[p][0]
+		     && halo->nsend[p] == hrecv[p][2]
+		     && halo->rlist[dim][p].n == hrecv[p][1]);
+  }
+
+  /* Non periodic boundaries receive no particles */
+
+  if (halo->cs->param->periodic[dim] == 0) {
+    if (halo->cs->param->mpi_cartcoords[dim] == 0) {
+      halo->nrecv[CS_BACK] = 0;
+      halo->fast[CS_BACK] = 0;
+    }
+    if (halo->cs->param->mpi_cartcoords[dim]
+	== halo->cs->param->mpi_cartsz[dim] - 1) {
+      halo->nrecv[CS_FORW] = 0;
+      halo->fast[CS_FORW] = 0;
+    }
+  }
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  colloids_halo_reserve
+ *
+ *  Ensure the persistent message buffers are large enough.
+ *
+ *****************************************************************************/
+
+static int colloids_halo_reserve(colloid_halo_t * halo) {
+
+  int n;
+
+  assert(halo);
+
+  n = imax(halo->nsend[FORWARD] + halo->nsend[BACKWARD],
+	   halo->nrecv[FORWARD] + halo->nrecv[BACKWARD]);
+
+  if (n > halo->nbufmax) {
+    int nmax = imax(n, 2*halo->nbufmax);
+    size_t msize = sizeof(colloid_halo_msg_t);
+
+    free(halo->send);
+    free(halo->recv);
+    free(halo->csend);
+    free(halo->crecv);
+
+    halo->send = (colloid_state_t *) malloc(nmax*sizeof(colloid_state_t));
+    halo->recv = (colloid_state_t *) malloc(nmax*sizeof(colloid_state_t));
+    halo->csend = (colloid_halo_msg_t *) malloc(nmax*msize);
+    halo->crecv = (colloid_halo_msg_t *) malloc(nmax*msize);
+
+    if (halo->send == NULL) pe_fatal(halo->pe, "halo malloc(send) failed\n");
+    if (halo->recv == NULL) pe_fatal(halo->pe, "halo malloc(recv) failed\n");
+    if (halo->csend == NULL) pe_fatal(halo->pe, "halo malloc(csend) failed\n");
+    if (halo->crecv == NULL) pe_fatal(halo->pe, "halo malloc(crecv) failed\n");
+
+    halo->nbufmax = nmax;
+  }
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  colloids_halo_list_reserve
+ *
+ *****************************************************************************/
+
+static int colloids_halo_list_reserve(colloid_halo_t * halo,
+				      colloid_halo_list_t * list, int n) {
+  assert(halo);
+  assert(list);
+
+  if (n > list->nmax) {
+    int nmax = imax(n, 2*list->nmax);
+    colloid_t ** tmp = (colloid_t **) realloc(list->pc,
+					      nmax*sizeof(colloid_t *));
+    if (tmp == NULL) pe_fatal(halo->pe, "halo realloc(list) failed\n");
+    list->pc = tmp;
+    list->nmax = nmax;
+  }
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  colloids_halo_pack
+ *
+ *  Load the compact message for each direction which uses it from
+ *  the send list. The periodic shift is as colloids_halo_load().
+ *
+ *****************************************************************************/
+
+static int colloids_halo_pack(colloid_halo_t * halo, int dim) {
+
+  double rback[3];
+  double rforw[3];
+
+  assert(halo);
+
+  colloids_halo_rperiod(halo, dim, rback, rforw);
+
+  for (int p = 0; p < 2; p++) {
+
+    const double * rperiod = (p == BACKWARD) ? rback : rforw;
+    int noff = (p == BACKWARD) ? 0 : halo->nsend[BACKWARD];
+    colloid_halo_list_t * list = &halo->slist[dim][p];
+
+    if (halo->fast[p] == 0) continue;
+    assert(list->n == halo->nsend[p]);
+
+    for (int n = 0; n < list->n; n++) {
+      const colloid_state_t * s = &list->pc[n]->s;
+      colloid_halo_msg_t * msg = halo->csend + noff + n;
+
+      msg->index   = s->index;
+      msg->rebuild = s->rebuild;
+      msg->rng     = s->rng;
+      msg->ipad    = 0;
+      for (int ia = 0; ia < 3; ia++) {
+	msg->r[ia]  = s->r[ia] + rperiod[ia];
+	msg->v[ia]  = s->v[ia];
+	msg->w[ia]  = s->w[ia];
+	msg->s[ia]  = s->s[ia];
+	msg->m[ia]  = s->m[ia];
+	msg->dr[ia] = s->dr[ia];
+      }
+      msg->sa      = s->sa;
+      msg->saf     = s->saf;
+      msg->deltaq0 = s->deltaq0;
+      msg->deltaq1 = s->deltaq1;
+      for (int ia = 0; ia < 4; ia++) {
+	msg->quat[ia]    = s->quat[ia];
+	msg->quatold[ia] = s->quatold[ia];
+      }
+    }
+  }
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  colloids_halo_unpack
+ *
+ *  Compact messages are unloaded directly to the copies in the
+ *  receive list; the order must agree (a fatal error if not).
+ *
+ *****************************************************************************/
+
+static int colloids_halo_unpack(colloid_halo_t * halo, int noff, int nrecv,
+				colloid_halo_list_t * list) {
+  assert(halo);
+  assert(list);
+  assert(list->n == nrecv);
+
+  for (int n = 0; n < nrecv; n++) {
+    const colloid_halo_msg_t * msg = halo->crecv + noff + n;
+    colloid_state_t * s = &list->pc[n]->s;
+
+    if (msg->index != s->index) {
+      pe_fatal(halo->pe, "Colloid halo list mismatch (%d)\n", msg->index);
+    }
+
+    s->rebuild = msg->rebuild;
+    s->rng     = msg->rng;
+    for (int ia = 0; ia < 3; ia++) {
+      s->r[ia]  = msg->r[ia];
+      s->v[ia]  = msg->v[ia];
+      s->w[ia]  = msg->w[ia];
+      s->s[ia]  = msg->s[ia];
+      s->m[ia]  = msg->m[ia];
+      s->dr[ia] = msg->dr[ia];
+    }
+    s->sa      = msg->sa;
+    s->saf     = msg->saf;
+    s->deltaq0 = msg->deltaq0;
+    s->deltaq1 = msg->deltaq1;
+    for (int ia = 0; ia < 4; ia++) {
+      s->quat[ia]    = msg->quat[ia];
+      s->quatold[ia] = msg->quatold[ia];
+    }
+  }
+
+  return 0;
+}
@@ -24,6 +24,7 @@ void colloids_halo_free(colloid_halo_t * halo);
 int colloids_halo_state(colloids_info_t * cinfo);
 int colloids_halo_dim(colloid_halo_t * halo, int dim);
 int colloids_halo_send_count(colloid_halo_t * halo, int dim, int * nreturn);
+int colloids_halo_persistent_set(colloids_info_t * cinfo, int persistent);
 
 #endif
  
@@ -42,6 +42,8 @@
 #include "colloids_init.h"
 #include "colloid_io_rt.h"
 #include "colloids_rt.h"
+#include "colloid_pair_list.h"
+#include "ewald_spme.h"
 
 #include "build.h"
 
@@ -154,6 +156,19 @@ int colloids_init_rt(pe_t * pe, rt_t * rt, cs_t * cs, colloids_info_t ** pinfo,
 
   wall_ss_cut_init(pe, cs, rt, wall, *interact);
 
+  /* Verlet list skin for pairwise interactions: this is required
+   * before the cell list is sized, and is reported there. */
+
+  {
+    double skin = 0.0;
+
+    if (rt_double_parameter(rt, "colloid_pair_list_skin", &skin)) {
+      if (colloid_pair_list_skin_set((*pinfo)->plist, skin) != 0) {
+	pe_fatal(pe, "colloid_pair_list_skin must be >= 0.0\n");
+      }
+    }
+  }
+
   colloids_rt_cell_list_checks(pe, cs, pinfo, *interact);
   colloids_init_halo_range_check(pe, cs, *pinfo);
   if (nc > 1) interact_range_check(*interact, *pinfo);
@@ -186,6 +201,13 @@ int colloids_init_rt(pe_t * pe, rt_t * rt, cs_t * cs, colloids_info_t ** pinfo,
     }
   }
 
+  /* Persistent neighbour lists for the state halo exchange */
+
+  if (rt_switch(rt, "colloid_halo_persistent")) {
+    colloids_halo_persistent_set(*pinfo, 1);
+    pe_info(pe, "Colloid halo lists:           persistent\n");
+  }
+
   pe_info(pe, "\n");
 
   return 0;
@@ -790,9 +812,11 @@ int colloids_rt_cell_list_checks(pe_t * pe, cs_t * cs,
   int nbest[3];
   int nhalo;
 
+  int ispair = 0;       /* Pairwise interactions use the pair list */
   double a0max, ahmax;  /* maximum radii */
   double rcmax, hcmax;  /* Interaction ranges */
   double rmax;          /* Maximum interaction range */
+  double rlist = 0.0;   /* Pair list range (excluding skin) */
   double wcell[3];      /* Final cell widths */
 
   assert(pe);
@@ -832,6 +856,16 @@ int colloids_rt_cell_list_checks(pe_t * pe, cs_t * cs,
     interact_rcmax(interact, &rcmax);
     interact_hcmax(interact, &hcmax);
     rmax = dmax(2.0*ahmax + hcmax, rcmax);
+
+    /* The pair list can only retain its skin if the cells allow */
+    {
+      double hc = 0.0;
+      double rc = 0.0;
+      interact_pairwise_range(interact, &ispair, &hc, &rc);
+      rlist = dmax(2.0*ahmax + hc, rc);
+      if (ispair) rmax = dmax(rmax, rlist + (*pinfo)->plist->skin);
+    }
+
     rmax = dmax(rmax, 1.5);                  /* subgrid particles again */
     rmax = dmax(rmax, a0max + nhalo - 0.5);  /* halo, as above */
     nbest[X] = (int) floor(1.0*nlocal[X] / rmax);
@@ -855,6 +889,13 @@ int colloids_rt_cell_list_checks(pe_t * pe, cs_t * cs,
   pe_info(pe, "Final cell lengths:          %14.7e %14.7e %14.7e\n",
        wcell[X], wcell[Y], wcell[Z]);
 
+  if (ispair) {
+    double skineff = 0.0;
+    colloid_pair_list_skin_effective((*pinfo)->plist, wcell, rlist, &skineff);
+    pe_info(pe, "Pair list skin requested:    %14.7e\n", (*pinfo)->plist->skin);
+    pe_info(pe, "Pair list skin effective:    %14.7e\n", skineff);
+  }
+
 
   return 0;
 }
@@ -891,6 +932,32 @@ int colloids_init_ewald_rt(pe_t * pe, rt_t * rt, cs_t * cs,
 
     ewald_create(pe, cs, mu, rc, cinfo, pewald);
     assert(*pewald);
+
+    /* Fourier space method: "direct" (default) or "spme" */
+    {
+      char method[BUFSIZ] = "direct";
+      rt_string_parameter(rt, "ewald_method", method, BUFSIZ);
+
+      if (strcmp(method, "spme") == 0) {
+	int order = EWALD_SPME_ORDER_DEFAULT;
+	int nmesh = 0;
+	int ngrid[3] = {0};
+	rt_int_parameter(rt, "ewald_spme_order", &order);
+	rt_int_parameter(rt, "ewald_spme_grid", &nmesh);
+	ngrid[X] = nmesh; ngrid[Y] = nmesh; ngrid[Z] = nmesh;
+	if (ewald_spme_set(*pewald, order, ngrid) != 0) {
+	  pe_info(pe, "ewald_spme_order must be %d-%d (default %d)\n",
+		  EWALD_SPME_ORDER_MIN, EWALD_SPME_ORDER_MAX,
+		  EWALD_SPME_ORDER_DEFAULT);
+	  pe_info(pe, "ewald_spme_grid must be a power of two >= order\n");
+	  pe_fatal(pe, "Please check and try again\n");
+	}
+      }
+      else if (strcmp(method, "direct") != 0) {
+	pe_fatal(pe, "ewald_method must be direct or spme (not %s)\n", method);
+      }
+    }
+
     ewald_info(*pewald);
   }
 
@@ -14,7 +14,7 @@
  *  Edinburgh Soft Matter and Statistical Physics Group and
  *  Edinburgh Parallel Computing Centre
  *
- *  (c) 2022 The University of Edinburgh
+ *  (c) 2022-2024 The University of Edinburgh
  *
  *  Kevin Stratford (kevin@epcc.ed.ac.uk)
  *
@@ -156,4 +156,80 @@ static inline int cs_limits_index(cs_limits_t lim, int ic, int jc, int kc) {
   return iflat;
 }
 
+/*****************************************************************************
+ *
+ *  cs_limits_interior
+ *
+ *  The region remaining when a shell of width nw is removed from
+ *  each face. This may be empty (imin > imax etc).
+ *
+ *****************************************************************************/
+
+static inline cs_limits_t cs_limits_interior(cs_limits_t lim, int nw) {
+
+  cs_limits_t interior = {lim.imin + nw, lim.imax - nw,
+                          lim.jmin + nw, lim.jmax - nw,
+                          lim.kmin + nw, lim.kmax - nw};
+  assert(nw >= 0);
+
+  return interior;
+}
+
+/*****************************************************************************
+ *
+ *  cs_limits_shell
+ *
+ *  Decompose the shell of width nw at the faces of lim into (at most)
+ *  six non-overlapping rectangular slabs. The slabs and the interior
+ *  together cover lim exactly once. Returns the number of (non-empty)
+ *  slabs placed in shell[].
+ *
+ *****************************************************************************/
+
+static inline int cs_limits_shell(cs_limits_t lim, int nw,
+				  cs_limits_t shell[6]) {
+
+  int nshell = 0;
+  cs_limits_t inner = lim;    /* Remaining region as slabs are removed */
+
+  assert(nw >= 0);
+
+  if (nw == 0) return 0;
+
+  /* x-faces full extent; y-faces what remains in x; z-faces the rest */
+
+  for (int dim = 0; dim < 3; dim++) {
+    int * rmin = (dim == 0) ? &inner.imin
+               : ((dim == 1) ? &inner.jmin : &inner.kmin);
+    int * rmax = (dim == 0) ? &inner.imax
+               : ((dim == 1) ? &inner.jmax : &inner.kmax);
+    int n = 1 + *rmax - *rmin;
+    int nlo = (n < nw) ? n : nw;
+    int nhi = (n - nlo < nw) ? n - nlo : nw;
+
+    if (inner.imin > inner.imax) break;
+    if (inner.jmin > inner.jmax) break;
+    if (inner.kmin > inner.kmax) break;
+
+    if (nlo > 0) {
+      cs_limits_t slab = inner;
+      if (dim == 0) slab.imax = slab.imin + nlo - 1;
+      if (dim == 1) slab.jmax = slab.jmin + nlo - 1;
+      if (dim == 2) slab.kmax = slab.kmin + nlo - 1;
+      shell[nshell++] = slab;
+    }
+    if (nhi > 0) {
+      cs_limits_t slab = inner;
+      if (dim == 0) slab.imin = slab.imax - nhi + 1;
+      if (dim == 1) slab.jmin = slab.jmax - nhi + 1;
+      if (dim == 2) slab.kmin = slab.kmax - nhi + 1;
+      shell[nshell++] = slab;
+    }
+    *rmin += nlo;
+    *rmax -= nhi;
+  }
+
+  return nshell;
+}
+
 #endif
@@ -125,6 +125,10 @@ int lb_run_time(pe_t * pe, cs_t * cs, rt_t * rt, lb_t ** lb) {
  *  -----------------------------------------
  *  "distribution_io_grid"            {1,1,1}
  *  "distribution_io_format_input"    "binary"
+ *  "lb_schedule"                     "split"
+ *  "lb_data_shifted"                 no
+ *  "lb_fluid_list"                   no
+ *  "lb_sparse_storage"               no
  *
  *  "rho_io_wanted"                   false
  *  "rho_io_grid"                     {1,1,1}
@@ -183,11 +187,59 @@ int lb_run_time_prev(pe_t * pe, cs_t * cs, rt_t * rt, lb_t ** lb) {
       if (ndevice > 0) options.halo = LB_HALO_TARGET;
     }
 
+    /* Collision/propagation schedule */
+    {
+      char stype[BUFSIZ] = {0};
+      int havestype = rt_string_parameter(rt, "lb_schedule", stype, BUFSIZ);
+      if (strcmp(stype, "split") == 0) {
+	options.schedule = LB_SCHEDULE_SPLIT;
+      }
+      else if (strcmp(stype, "fused") == 0) {
+	options.schedule = LB_SCHEDULE_FUSED;
+      }
+      else if (strcmp(stype, "aa") == 0) {
+	int ndevice = 0;
+	tdpGetDeviceCount(&ndevice);
+	if (ndevice > 0) pe_fatal(pe, "lb_schedule aa is host only\n");
+	options.schedule = LB_SCHEDULE_AA;
+      }
+      else if (strcmp(stype, "overlap") == 0) {
+	int ndevice = 0;
+	tdpGetDeviceCount(&ndevice);
+	if (ndevice > 0) pe_fatal(pe, "lb_schedule overlap is host only\n");
+	options.schedule = LB_SCHEDULE_OVERLAP;
+	/* Requires the host halo; default to full if not specified */
+	if (havetype == 0) options.halo = LB_HALO_OPENMP_FULL;
+      }
+      else if (havestype) {
+	pe_fatal(pe, "lb_schedule not recognised "
+		 "(use split, fused, aa or overlap)\n");
+      }
+    }
+
+    /* Shifted storage f_p - wv[p]*rho0 (the reference density
+     * is the mean fluid density) */
+    options.shifted = rt_switch(rt, "lb_data_shifted");
+    rt_double_parameter(rt, "fluid_rho0", &options.rho0);
+
+    /* Collision and propagation visit only blocks containing fluid */
+    options.fluidlist = rt_switch(rt, "lb_fluid_list");
+
+    /* Distributions stored at fluid sites only (host halo only) */
+    options.sparse = rt_switch(rt, "lb_sparse_storage");
+    if (options.sparse) {
+      int ndevice = 0;
+      tdpGetDeviceCount(&ndevice);
+      if (ndevice > 0) pe_fatal(pe, "lb_sparse_storage is host only\n");
+      if (havetype == 0) options.halo = LB_HALO_OPENMP_FULL;
+    }
+
     options.reportimbalance = rt_switch(rt, "lb_halo_report_imbalance");
     options.usefirsttouch   = rt_switch(rt, "lb_data_use_first_touch");
 
     if (lb_data_options_valid(&options) == 0) {
-      pe_fatal(pe, "lb_data_options are invalid. Please check halo.\n");
+      pe_fatal(pe, "lb_data_options are invalid. "
+	       "Please check halo/schedule/storage.\n");
     }
   }
 
@@ -224,6 +276,27 @@ int lb_run_time_prev(pe_t * pe, cs_t * cs, rt_t * rt, lb_t ** lb) {
   if (options.halo == LB_HALO_OPENMP_REDUCED) {
     pe_info(pe, "Halo type:        %s\n", "lb_halo_openmp_reduced (host)");
   }
+  if (options.schedule == LB_SCHEDULE_FUSED) {
+    pe_info(pe, "Schedule:         %s\n", "fused collision/propagation");
+  }
+  if (options.schedule == LB_SCHEDULE_AA) {
+    pe_info(pe, "Schedule:         %s\n", "in-place (AA) streaming");
+  }
+  if (options.schedule == LB_SCHEDULE_OVERLAP) {
+    pe_info(pe, "Schedule:         %s\n", "overlapped collision/halo");
+  }
+  if (sizeof(lb_float_t) != sizeof(double)) {
+    pe_info(pe, "Storage:          %s\n", "single precision");
+  }
+  if (options.shifted) {
+    pe_info(pe, "Storage shifted:  f - w rho0 (rho0 = %12.5e)\n", options.rho0);
+  }
+  if (options.fluidlist) {
+    pe_info(pe, "Fluid site list:  %s\n", "requested");
+  }
+  if (options.sparse) {
+    pe_info(pe, "Sparse storage:   %s\n", "requested");
+  }
   if (options.reportimbalance) {
     pe_info(pe, "Imbalance time:   %s\n", "reported");
   }
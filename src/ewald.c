@@ -7,6 +7,9 @@
  *
  *  See, for example, Allen and Tildesley, Computer Simulation of Liquids.
  *
+ *  The Fourier space part may be computed directly (the default), or
+ *  by smooth particle mesh Ewald (see ewald_spme.c).
+ *
  *  Edinburgh Soft Matter and Statistical Physics Group and
  *  Edinburgh Parallel Computing Centre
  *
@@ -26,6 +29,7 @@
 #include "coords.h"
 #include "colloids.h"
 #include "ewald.h"
+#include "ewald_spme.h"
 #include "timer.h"
 #include "util.h"
 
@@ -51,6 +55,7 @@ struct ewald_s {
   pe_t * pe;                 /* Parallel environment */
   cs_t * cs;                 /* Coordinate system */
   colloids_info_t * cinfo;   /* Retain a reference to colloids_info_t */
+  ewald_spme_t * spme;       /* Particle mesh (if NULL, direct sum) */
 };
 
 static int ewald_sum_sin_cos_terms(ewald_t * ewald);
@@ -136,6 +141,8 @@ int ewald_free(ewald_t * ewald) {
 
   assert(ewald);
 
+  if (ewald->spme) ewald_spme_free(ewald->spme);
+
   free(sinx_);
   free(cosx_);
   free(sinkr_);
@@ -174,9 +181,61 @@ int ewald_info(ewald_t * ewald) {
   pe_info(ewald->pe, "Max. term retained in Fourier space sum:  %d\n", nkmax_);
   pe_info(ewald->pe, "Total terms kept in Fourier space sum:    %d\n\n", nktot_);
 
+  if (ewald->spme) {
+    int order = 0;
+    int ngrid[3] = {0};
+    ewald_spme_order(ewald->spme, &order);
+    ewald_spme_ngrid(ewald->spme, ngrid);
+    pe_info(ewald->pe, "Fourier space method:                     %s\n", "spme");
+    pe_info(ewald->pe, "Particle mesh B-spline order:             %d\n", order);
+    pe_info(ewald->pe, "Particle mesh size:                       %d %d %d\n\n",
+	    ngrid[X], ngrid[Y], ngrid[Z]);
+  }
+
   return 0;
 }
 
+/*****************************************************************************
+ *
+ *  ewald_spme_set
+ *
+ *  Use smooth particle mesh Ewald for the Fourier space sum with
+ *  B-spline order and mesh size ngrid. If ngrid[] is zero, the
+ *  default is the smallest power of two of at least 2(nk + 1),
+ *  which retains all the wavevectors of the direct sum.
+ *
+ *  Returns non-zero if the order or mesh size is not valid.
+ *
+ *****************************************************************************/
+
+int ewald_spme_set(ewald_t * ewald, int order, const int ngrid[3]) {
+
+  int ifail = 0;
+  int nmesh[3] = {0};
+  ewald_spme_t * spme = NULL;
+
+  assert(ewald);
+
+  for (int ia = 0; ia < 3; ia++) {
+    nmesh[ia] = ngrid[ia];
+    if (nmesh[ia] <= 0) {
+      nmesh[ia] = 1;
+      while (nmesh[ia] < 2*(nk_[ia] + 1)) nmesh[ia] *= 2;
+      if (nmesh[ia] < order) nmesh[ia] = order;
+    }
+  }
+
+  ifail = ewald_spme_create(ewald->pe, ewald->cs, order, nmesh, mu_, kappa_,
+			    &spme);
+
+  if (ifail == 0) {
+    if (ewald->spme) ewald_spme_free(ewald->spme);
+    ewald->spme = spme;
+  }
+
+  return ifail;
+}
+
 /*****************************************************************************
  *
  *  ewald_kappa
@@ -296,6 +355,10 @@ int ewald_fourier_space_energy(ewald_t * ewald, double * ef) {
 
   assert(ewald);
 
+  if (ewald->spme) {
+    return ewald_spme_compute(ewald->spme, ewald->cinfo, 0, ef);
+  }
+
   cs_ltot(ewald->cs, ltot);
   ewald_sum_sin_cos_terms(ewald);
 
@@ -658,6 +721,12 @@ int ewald_fourier_space_sum(ewald_t * ewald) {
 
   assert(ewald);
 
+  if (ewald->spme) {
+    ewald_spme_compute(ewald->spme, ewald->cinfo, 1, &efourier_);
+    TIMER_stop(TIMER_EWALD_FOURIER_SPACE);
+    return 0;
+  }
+
   cs_ltot(ewald->cs, ltot);
   ewald_sum_sin_cos_terms(ewald);
 
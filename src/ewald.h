@@ -29,6 +29,7 @@ int ewald_create(pe_t * pe, cs_t * cs, double mu, double rc,
 int ewald_free(ewald_t * ewald);
 int ewald_info(ewald_t * ewald);
 int ewald_kappa(ewald_t * ewald, double * kappa);
+int ewald_spme_set(ewald_t * ewald, int order, const int ngrid[3]);
 int ewald_sum(ewald_t * ewald);
 int ewald_real_space_sum(ewald_t * ewald);
 int ewald_fourier_space_sum(ewald_t * ewald);
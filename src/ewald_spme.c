@@ -0,0 +1,1205 @@
+/*****************************************************************************
+ *
+ *  ewald_spme.c
+ *
+ *  Smooth particle mesh Ewald (SPME) for the Fourier space part of
+ *  the Ewald sum for magnetic dipoles.
+ *
+ *  The dipoles are spread onto a regular mesh using cardinal B-splines
+ *  of a given order, the mesh is convolved with the Ewald influence
+ *  function using an FFT, and the resulting potential is interpolated
+ *  back to give the force and torque on each dipole. The cost is
+ *  O(N order^3 + K log K) for N dipoles and K mesh points, compared
+ *  with O(N K) for the direct sum.
+ *
+ *  If the mesh charge is Q(l) = \sum_i u_i.grad_i W_i(l), where W_i(l)
+ *  is the product of B-splines for dipole i at mesh point l, then the
+ *  energy is E = (1/2) \sum_m theta(m) |Q(m)|^2, with the influence
+ *  function theta(m) = (4 pi mu^2/V) exp(-k^2/4kappa^2)/k^2 |b(m)|^2.
+ *  See Essmann et al., J. Chem. Phys. 103, 8577 (1995).
+ *
+ *  The three dimensional FFT is distributed by slabs: each rank holds
+ *  a range of x-planes for the transforms in y and z, and a range of
+ *  y-planes (all x) for the transform in x. The transforms themselves
+ *  are a local radix-2 FFT, so the mesh size must be a power of two
+ *  in each dimension.
+ *
+ *  The spreading and interpolation are also done by x-slab. Each
+ *  dipole is sent to the rank holding the x-plane at the top of its
+ *  stencil, so the stencil falls within the local x-planes plus
+ *  (order - 1) ghost planes below them. After spreading, the ghost
+ *  planes are summed into the ranks which own them; before the
+ *  interpolation, the potential is copied back to the ghost planes.
+ *  The force and torque are returned to the rank holding the colloid.
+ *  Only the ghost planes (and the FFT transposes) are communicated.
+ *
+ *  Edinburgh Soft Matter and Statistical Physics Group and
+ *  Edinburgh Parallel Computing Centre
+ *
+ *  (c) 2024 The University of Edinburgh
+ *
+ *  Contributing authors:
+ *  Kevin Stratford (kevin@epcc.ed.ac.uk)
+ *
+ *****************************************************************************/
+
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+#include "util.h"
+#include "ewald_spme.h"
+
+struct ewald_spme_s {
+  pe_t * pe;                 /* Parallel environment */
+  cs_t * cs;                 /* Coordinate system */
+  MPI_Comm comm;             /* Cartesian communicator */
+  int nrank;                 /* Number of ranks */
+  int rank;                  /* This rank */
+
+  int order;                 /* B-spline order */
+  int ngrid[3];              /* Mesh size (power of two) */
+  double mu;                 /* Dipole strength */
+  double kappa;              /* Ewald parameter */
+
+  int nxlocal;               /* Local x-planes (real space) */
+  int nylocal;               /* Local y-planes (Fourier space) */
+  int nghost;                /* Ghost x-planes (order - 1) */
+  int * xcount;              /* x-planes per rank */
+  int * xoffset;             /* First x-plane per rank */
+  int * ycount;              /* y-planes per rank */
+  int * yoffset;             /* First y-plane per rank */
+  int * scount;              /* Alltoallv send counts ... */
+  int * sdispl;              /* ... and displacements */
+  int * rcount;              /* Alltoallv receive counts ... */
+  int * rdispl;              /* ... and displacements */
+  int * hcount;              /* Ghost planes by owning rank ... */
+  int * hdispl;              /* ... and displacements */
+  int * ocount;              /* Local planes by rank holding ghost ... */
+  int * odispl;              /* ... and displacements */
+  int * dcount;              /* Dipoles sent per rank ... */
+  int * ddispl;              /* ... and displacements */
+  int * ncount;              /* Dipoles received per rank ... */
+  int * ndispl;              /* ... and displacements */
+
+  double * bmod[3];          /* |b(m)|^2 for each dimension */
+  double * wtab[3];          /* Twiddle factors exp(2 pi i j/K) */
+  double * theta;            /* Influence function [K0*nylocal*K2] */
+  double * qlocal;           /* Real x-slab with ghost planes */
+  double * slab;             /* Complex x-slab [x][y][z] */
+  double * pencil;           /* Complex y-slab [y][x][z] */
+  double * sbuf;             /* Send buffer for transpose */
+  double * rbuf;             /* Receive buffer for transpose */
+  double * hsbuf;            /* Send buffer for ghost planes */
+  double * hrbuf;            /* Receive buffer for ghost planes */
+  double * line;             /* Workspace for 1-d transform */
+};
+
+/* Position and orientation (or force and torque) per dipole message */
+
+#define EWALD_SPME_NDATA 6
+
+static int ewald_spme_bmod(ewald_spme_t * spme, int ia);
+static int ewald_spme_theta(ewald_spme_t * spme);
+static int ewald_spme_halo_counts(ewald_spme_t * spme);
+static int ewald_spme_halo(ewald_spme_t * spme, int reverse);
+static int ewald_spme_xowner(const ewald_spme_t * spme, int ix);
+static int ewald_spme_xghost(const ewald_spme_t * spme, int n, int ig);
+static int ewald_spme_spread(ewald_spme_t * spme, int ndipole,
+			     const double * rs);
+static int ewald_spme_interpolate(ewald_spme_t * spme, int ndipole,
+				  const double * rs, double * ft);
+static int ewald_spme_convolve(ewald_spme_t * spme, double * energy);
+static int ewald_spme_slab_fft(ewald_spme_t * spme, int sign);
+static int ewald_spme_pencil_fft(ewald_spme_t * spme, int sign);
+static int ewald_spme_transpose(ewald_spme_t * spme, int forward);
+static int ewald_spme_weights(ewald_spme_t * spme, const double r[3],
+			      int l0[3], double m[3][EWALD_SPME_ORDER_MAX],
+			      double dm[3][EWALD_SPME_ORDER_MAX],
+			      double d2m[3][EWALD_SPME_ORDER_MAX]);
+static void ewald_spme_fft1d(int n, const double * wtab, int sign,
+			     double * data);
+
+/*****************************************************************************
+ *
+ *  ewald_spme_create
+ *
+ *  The mesh size must be a power of two (and at least the order)
+ *  in each dimension. Returns non-zero for invalid arguments.
+ *
+ *****************************************************************************/
+
+int ewald_spme_create(pe_t * pe, cs_t * cs, int order, const int ngrid[3],
+		      double mu, double kappa, ewald_spme_t ** pspme) {
+
+  int nmax = 0;
+  size_t nslab = 0;
+  size_t npencil = 0;
+  size_t nbuf = 0;
+  size_t nhalo = 0;
+  size_t nlocal = 0;
+  ewald_spme_t * spme = NULL;
+
+  assert(pe);
+  assert(cs);
+  assert(pspme);
+
+  if (order < EWALD_SPME_ORDER_MIN || order > EWALD_SPME_ORDER_MAX) return -1;
+  if (kappa <= 0.0) return -1;
+
+  for (int ia = 0; ia < 3; ia++) {
+    if (ngrid[ia] < order) return -1;
+    if (ngrid[ia] & (ngrid[ia] - 1)) return -1;
+    if (ngrid[ia] > nmax) nmax = ngrid[ia];
+  }
+
+  spme = (ewald_spme_t *) calloc(1, sizeof(ewald_spme_t));
+  assert(spme);
+  if (spme == NULL) pe_fatal(pe, "calloc(ewald_spme_t) failed\n");
+
+  spme->pe = pe;
+  spme->cs = cs;
+  spme->order = order;
+  spme->mu = mu;
+  spme->kappa = kappa;
+  for (int ia = 0; ia < 3; ia++) {
+    spme->ngrid[ia] = ngrid[ia];
+  }
+
+  cs_cart_comm(cs, &spme->comm);
+  MPI_Comm_size(spme->comm, &spme->nrank);
+  MPI_Comm_rank(spme->comm, &spme->rank);
+
+  /* Slab decomposition: as even as possible (some ranks may have none) */
+
+  spme->xcount  = (int *) calloc(spme->nrank, sizeof(int));
+  spme->xoffset = (int *) calloc(spme->nrank, sizeof(int));
+  spme->ycount  = (int *) calloc(spme->nrank, sizeof(int));
+  spme->yoffset = (int *) calloc(spme->nrank, sizeof(int));
+  spme->scount  = (int *) calloc(spme->nrank, sizeof(int));
+  spme->sdispl  = (int *) calloc(spme->nrank, sizeof(int));
+  spme->rcount  = (int *) calloc(spme->nrank, sizeof(int));
+  spme->rdispl  = (int *) calloc(spme->nrank, sizeof(int));
+  spme->hcount  = (int *) calloc(spme->nrank, sizeof(int));
+  spme->hdispl  = (int *) calloc(spme->nrank, sizeof(int));
+  spme->ocount  = (int *) calloc(spme->nrank, sizeof(int));
+  spme->odispl  = (int *) calloc(spme->nrank, sizeof(int));
+  spme->dcount  = (int *) calloc(spme->nrank, sizeof(int));
+  spme->ddispl  = (int *) calloc(spme->nrank, sizeof(int));
+  spme->ncount  = (int *) calloc(spme->nrank, sizeof(int));
+  spme->ndispl  = (int *) calloc(spme->nrank, sizeof(int));
+
+  if (spme->xcount == NULL || spme->xoffset == NULL ||
+      spme->ycount == NULL || spme->yoffset == NULL ||
+      spme->scount == NULL || spme->sdispl == NULL ||
+      spme->rcount == NULL || spme->rdispl == NULL ||
+      spme->hcount == NULL || spme->hdispl == NULL ||
+      spme->ocount == NULL || spme->odispl == NULL ||
+      spme->dcount == NULL || spme->ddispl == NULL ||
+      spme->ncount == NULL || spme->ndispl == NULL) {
+    pe_fatal(pe, "calloc(ewald_spme_t counts) failed\n");
+  }
+
+  for (int n = 0; n < spme->nrank; n++) {
+    int nx = ngrid[X]/spme->nrank;
+    int ny = ngrid[Y]/spme->nrank;
+    int rx = ngrid[X] % spme->nrank;
+    int ry = ngrid[Y] % spme->nrank;
+    spme->xcount[n]  = nx + (n < rx);
+    spme->xoffset[n] = n*nx + imin(n, rx);
+    spme->ycount[n]  = ny + (n < ry);
+    spme->yoffset[n] = n*ny + imin(n, ry);
+  }
+
+  spme->nxlocal = spme->xcount[spme->rank];
+  spme->nylocal = spme->ycount[spme->rank];
+  spme->nghost  = order - 1;
+
+  nslab   = (size_t) spme->nxlocal*ngrid[Y]*ngrid[Z];
+  npencil = (size_t) ngrid[X]*spme->nylocal*ngrid[Z];
+  nbuf    = (nslab > npencil) ? nslab : npencil;
+  nhalo   = ewald_spme_halo_counts(spme);
+  nlocal  = (size_t) (spme->nghost + spme->nxlocal)*ngrid[Y]*ngrid[Z];
+
+  spme->qlocal = (double *) calloc(nlocal + 1, sizeof(double));
+  spme->slab   = (double *) calloc(2*nslab + 1, sizeof(double));
+  spme->pencil = (double *) calloc(2*npencil + 1, sizeof(double));
+  spme->theta  = (double *) calloc(npencil + 1, sizeof(double));
+  spme->sbuf   = (double *) calloc(2*nbuf + 1, sizeof(double));
+  spme->rbuf   = (double *) calloc(2*nbuf + 1, sizeof(double));
+  spme->hsbuf  = (double *) calloc(nhalo + 1, sizeof(double));
+  spme->hrbuf  = (double *) calloc(nhalo + 1, sizeof(double));
+  spme->line   = (double *) calloc(2*nmax, sizeof(double));
+
+  if (spme->qlocal == NULL || spme->slab == NULL || spme->pencil == NULL ||
+      spme->theta == NULL || spme->sbuf == NULL || spme->rbuf == NULL ||
+      spme->hsbuf == NULL || spme->hrbuf == NULL || spme->line == NULL) {
+    pe_fatal(pe, "calloc(ewald_spme_t mesh) failed\n");
+  }
+
+  for (int ia = 0; ia < 3; ia++) {
+    PI_DOUBLE(pi);
+    int nk = ngrid[ia];
+    spme->bmod[ia] = (double *) calloc(nk, sizeof(double));
+    spme->wtab[ia] = (double *) calloc(nk, sizeof(double));
+    if (spme->bmod[ia] == NULL) pe_fatal(pe, "calloc(spme->bmod) failed\n");
+    if (spme->wtab[ia] == NULL) pe_fatal(pe, "calloc(spme->wtab) failed\n");
+
+    for (int j = 0; j < nk/2; j++) {
+      spme->wtab[ia][2*j    ] = cos(2.0*pi*j/nk);
+      spme->wtab[ia][2*j + 1] = sin(2.0*pi*j/nk);
+    }
+    ewald_spme_bmod(spme, ia);
+  }
+
+  ewald_spme_theta(spme);
+
+  *pspme = spme;
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  ewald_spme_free
+ *
+ *****************************************************************************/
+
+int ewald_spme_free(ewald_spme_t * spme) {
+
+  assert(spme);
+
+  for (int ia = 0; ia < 3; ia++) {
+    free(spme->wtab[ia]);
+    free(spme->bmod[ia]);
+  }
+
+  free(spme->line);
+  free(spme->hrbuf);
+  free(spme->hsbuf);
+  free(spme->rbuf);
+  free(spme->sbuf);
+  free(spme->theta);
+  free(spme->pencil);
+  free(spme->slab);
+  free(spme->qlocal);
+
+  free(spme->ndispl);
+  free(spme->ncount);
+  free(spme->ddispl);
+  free(spme->dcount);
+  free(spme->odispl);
+  free(spme->ocount);
+  free(spme->hdispl);
+  free(spme->hcount);
+  free(spme->rdispl);
+  free(spme->rcount);
+  free(spme->sdispl);
+  free(spme->scount);
+  free(spme->yoffset);
+  free(spme->ycount);
+  free(spme->xoffset);
+  free(spme->xcount);
+
+  free(spme);
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  ewald_spme_order
+ *
+ *****************************************************************************/
+
+int ewald_spme_order(const ewald_spme_t * spme, int * order) {
+
+  assert(spme);
+  assert(order);
+
+  *order = spme->order;
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  ewald_spme_ngrid
+ *
+ *****************************************************************************/
+
+int ewald_spme_ngrid(const ewald_spme_t * spme, int ngrid[3]) {
+
+  assert(spme);
+
+  ngrid[X] = spme->ngrid[X];
+  ngrid[Y] = spme->ngrid[Y];
+  ngrid[Z] = spme->ngrid[Z];
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  ewald_spme_compute
+ *
+ *  Compute the Fourier space energy (the same on all ranks), and,
+ *  if iforce is set, accumulate the force and torque on each local
+ *  magnetic colloid.
+ *
+ *****************************************************************************/
+
+int ewald_spme_compute(ewald_spme_t * spme, colloids_info_t * cinfo,
+		       int iforce, double * energy) {
+
+  int ndipole = 0;
+  int nslab = 0;
+  int * dest = NULL;
+  double elocal = 0.0;
+  double * rs = NULL;
+  double * rsslab = NULL;
+  double * ftslab = NULL;
+  colloid_t * pc = NULL;
+  colloid_t ** plist = NULL;
+
+  assert(spme);
+  assert(cinfo);
+  assert(energy);
+
+  /* Local magnetic colloids, ordered by the rank holding the x-plane
+   * at the top of the stencil (counts are in doubles). */
+
+  colloids_info_local_head(cinfo, &pc);
+  for ( ; pc; pc = pc->nextlocal) {
+    if (pc->s.magnetic) ndipole += 1;
+  }
+
+  dest  = (int *) calloc(ndipole + 1, sizeof(int));
+  plist = (colloid_t **) calloc(ndipole + 1, sizeof(colloid_t *));
+  rs    = (double *) calloc(EWALD_SPME_NDATA*ndipole + 1, sizeof(double));
+  if (dest == NULL || plist == NULL || rs == NULL) {
+    pe_fatal(spme->pe, "calloc(ewald_spme dipoles) failed\n");
+  }
+
+  for (int n = 0; n < spme->nrank; n++) {
+    spme->dcount[n] = 0;
+  }
+
+  colloids_info_local_head(cinfo, &pc);
+  for (int id = 0; pc; pc = pc->nextlocal) {
+    int l0[3] = {0};
+    double m[3][EWALD_SPME_ORDER_MAX];
+    double dm[3][EWALD_SPME_ORDER_MAX];
+    double d2m[3][EWALD_SPME_ORDER_MAX];
+    if (pc->s.magnetic == 0) continue;
+    ewald_spme_weights(spme, pc->s.r, l0, m, dm, d2m);
+    dest[id] = ewald_spme_xowner(spme, l0[X]);
+    spme->dcount[dest[id]] += EWALD_SPME_NDATA;
+    plist[id++] = pc;
+  }
+
+  for (int n = 0; n < spme->nrank; n++) {
+    spme->ddispl[n] = (n == 0) ? 0 : spme->ddispl[n-1] + spme->dcount[n-1];
+    spme->scount[n] = 0;
+  }
+
+  {
+    /* Counting sort by destination (scount is used as workspace) */
+    colloid_t ** ptmp = (colloid_t **) calloc(ndipole + 1, sizeof(colloid_t *));
+    if (ptmp == NULL) pe_fatal(spme->pe, "calloc(ewald_spme ptmp) failed\n");
+
+    for (int id = 0; id < ndipole; id++) {
+      int n = dest[id];
+      int ip = (spme->ddispl[n] + spme->scount[n])/EWALD_SPME_NDATA;
+      ptmp[ip] = plist[id];
+      spme->scount[n] += EWALD_SPME_NDATA;
+    }
+    for (int id = 0; id < ndipole; id++) {
+      plist[id] = ptmp[id];
+      for (int ia = 0; ia < 3; ia++) {
+	rs[EWALD_SPME_NDATA*id + ia    ] = plist[id]->s.r[ia];
+	rs[EWALD_SPME_NDATA*id + 3 + ia] = plist[id]->s.s[ia];
+      }
+    }
+    free(ptmp);
+  }
+
+  MPI_Alltoall(spme->dcount, 1, MPI_INT, spme->ncount, 1, MPI_INT,
+	       spme->comm);
+
+  for (int n = 0; n < spme->nrank; n++) {
+    spme->ndispl[n] = (n == 0) ? 0 : spme->ndispl[n-1] + spme->ncount[n-1];
+    nslab += spme->ncount[n]/EWALD_SPME_NDATA;
+  }
+
+  rsslab = (double *) calloc(EWALD_SPME_NDATA*nslab + 1, sizeof(double));
+  ftslab = (double *) calloc(EWALD_SPME_NDATA*nslab + 1, sizeof(double));
+  if (rsslab == NULL || ftslab == NULL) {
+    pe_fatal(spme->pe, "calloc(ewald_spme slab dipoles) failed\n");
+  }
+
+  MPI_Alltoallv(rs, spme->dcount, spme->ddispl, MPI_DOUBLE,
+		rsslab, spme->ncount, spme->ndispl, MPI_DOUBLE, spme->comm);
+
+  /* Spread, and sum the ghost planes into their owners */
+
+  ewald_spme_spread(spme, nslab, rsslab);
+  ewald_spme_halo(spme, 1);
+
+  ewald_spme_convolve(spme, &elocal);
+  MPI_Allreduce(&elocal, energy, 1, MPI_DOUBLE, MPI_SUM, spme->comm);
+
+  if (iforce) {
+    /* Potential to the ghost planes; force and torque back to owners */
+    ewald_spme_halo(spme, 0);
+    ewald_spme_interpolate(spme, nslab, rsslab, ftslab);
+
+    MPI_Alltoallv(ftslab, spme->ncount, spme->ndispl, MPI_DOUBLE,
+		  rs, spme->dcount, spme->ddispl, MPI_DOUBLE, spme->comm);
+
+    for (int id = 0; id < ndipole; id++) {
+      for (int ia = 0; ia < 3; ia++) {
+	plist[id]->force[ia]  += rs[EWALD_SPME_NDATA*id + ia];
+	plist[id]->torque[ia] += rs[EWALD_SPME_NDATA*id + 3 + ia];
+      }
+    }
+  }
+
+  free(ftslab);
+  free(rsslab);
+  free(rs);
+  free(plist);
+  free(dest);
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  ewald_spme_bspline
+ *
+ *  Cardinal B-spline of given order M_n(w + k), with first and second
+ *  derivatives, for k = 0, ..., order - 1 and 0 <= w < 1. The mesh
+ *  point associated with k is floor(u) - k for scaled coordinate u.
+ *
+ *  M_1(x) = 1 for 0 <= x < 1, and
+ *  M_n(x) = [x M_{n-1}(x) + (n - x) M_{n-1}(x - 1)]/(n - 1),
+ *  M_n'(x) = M_{n-1}(x) - M_{n-1}(x - 1).
+ *
+ *****************************************************************************/
+
+int ewald_spme_bspline(int order, double w, double * m, double * dm,
+		       double * d2m) {
+
+  double a[EWALD_SPME_ORDER_MAX + 2] = {0};   /* M_{n-2}, offset by 2 */
+  double b[EWALD_SPME_ORDER_MAX + 1] = {0};   /* M_{n-1}, offset by 1 */
+  double c[EWALD_SPME_ORDER_MAX]     = {0};   /* M_n */
+
+  assert(order >= EWALD_SPME_ORDER_MIN);
+  assert(order <= EWALD_SPME_ORDER_MAX);
+  assert(0.0 <= w && w < 1.0);
+
+  c[0] = 1.0;
+
+  for (int n = 2; n <= order; n++) {
+    if (n == order - 1) {
+      for (int k = 0; k < order; k++) a[k + 2] = c[k];
+    }
+    if (n == order) {
+      for (int k = 0; k < order; k++) b[k + 1] = c[k];
+    }
+    /* In place from the top: c[n-1] is currently zero */
+    for (int k = n - 1; k > 0; k--) {
+      c[k] = ((w + k)*c[k] + (n - w - k)*c[k-1])/(n - 1);
+    }
+    c[0] = w*c[0]/(n - 1);
+  }
+
+  for (int k = 0; k < order; k++) {
+    m[k]   = c[k];
+    dm[k]  = b[k + 1] - b[k];
+    d2m[k] = a[k + 2] - 2.0*a[k + 1] + a[k];
+  }
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  ewald_spme_bmod
+ *
+ *  |b(m)|^2 = 1/|\sum_{k=0}^{n-2} M_n(k+1) exp(2 pi i m k/K)|^2
+ *
+ *  For odd order, the sum vanishes at m = K/2; the neighbouring
+ *  values are averaged.
+ *
+ *****************************************************************************/
+
+static int ewald_spme_bmod(ewald_spme_t * spme, int ia) {
+
+  int nk = spme->ngrid[ia];
+  double m[EWALD_SPME_ORDER_MAX] = {0};
+  double dm[EWALD_SPME_ORDER_MAX] = {0};
+  double d2m[EWALD_SPME_ORDER_MAX] = {0};
+  PI_DOUBLE(pi);
+
+  ewald_spme_bspline(spme->order, 0.0, m, dm, d2m);
+
+  for (int mk = 0; mk < nk; mk++) {
+    double sr = 0.0;
+    double si = 0.0;
+    for (int k = 0; k < spme->order - 1; k++) {
+      double arg = 2.0*pi*mk*k/nk;
+      sr += m[k + 1]*cos(arg);
+      si += m[k + 1]*sin(arg);
+    }
+    spme->bmod[ia][mk] = sr*sr + si*si;
+  }
+
+  for (int mk = 0; mk < nk; mk++) {
+    if (spme->bmod[ia][mk] < 1.0e-10) {
+      int mm = (mk - 1 + nk) % nk;
+      int mp = (mk + 1) % nk;
+      spme->bmod[ia][mk] = 0.5*(spme->bmod[ia][mm] + spme->bmod[ia][mp]);
+    }
+  }
+
+  for (int mk = 0; mk < nk; mk++) {
+    spme->bmod[ia][mk] = 1.0/spme->bmod[ia][mk];
+  }
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  ewald_spme_theta
+ *
+ *  Influence function for the local y-planes, in pencil order.
+ *  The k = 0 term is excluded (conducting boundary conditions).
+ *
+ *****************************************************************************/
+
+static int ewald_spme_theta(ewald_spme_t * spme) {
+
+  int ny0 = spme->yoffset[spme->rank];
+  double ltot[3];
+  double b0, r4kappasq;
+  PI_DOUBLE(pi);
+
+  cs_ltot(spme->cs, ltot);
+
+  b0 = (4.0*pi/(ltot[X]*ltot[Y]*ltot[Z]))*spme->mu*spme->mu;
+  r4kappasq = 1.0/(4.0*spme->kappa*spme->kappa);
+
+  for (int yl = 0; yl < spme->nylocal; yl++) {
+    for (int ix = 0; ix < spme->ngrid[X]; ix++) {
+      for (int iz = 0; iz < spme->ngrid[Z]; iz++) {
+	int iy = ny0 + yl;
+	int mx = (ix <= spme->ngrid[X]/2) ? ix : ix - spme->ngrid[X];
+	int my = (iy <= spme->ngrid[Y]/2) ? iy : iy - spme->ngrid[Y];
+	int mz = (iz <= spme->ngrid[Z]/2) ? iz : iz - spme->ngrid[Z];
+	double kx = 2.0*pi*mx/ltot[X];
+	double ky = 2.0*pi*my/ltot[Y];
+	double kz = 2.0*pi*mz/ltot[Z];
+	double ksq = kx*kx + ky*ky + kz*kz;
+	size_t ip = ((size_t) yl*spme->ngrid[X] + ix)*spme->ngrid[Z] + iz;
+
+	spme->theta[ip] = 0.0;
+	if (ksq > 0.0) {
+	  spme->theta[ip] = b0*exp(-r4kappasq*ksq)/ksq
+	    *spme->bmod[X][ix]*spme->bmod[Y][iy]*spme->bmod[Z][iz];
+	}
+      }
+    }
+  }
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  ewald_spme_weights
+ *
+ *  B-spline weights for position r; l0 is the mesh point for k = 0.
+ *  The derivatives are with respect to r (not the scaled coordinate).
+ *
+ *****************************************************************************/
+
+static int ewald_spme_weights(ewald_spme_t * spme, const double r[3],
+			      int l0[3], double m[3][EWALD_SPME_ORDER_MAX],
+			      double dm[3][EWALD_SPME_ORDER_MAX],
+			      double d2m[3][EWALD_SPME_ORDER_MAX]) {
+  double ltot[3];
+
+  cs_ltot(spme->cs, ltot);
+
+  for (int ia = 0; ia < 3; ia++) {
+    double c = spme->ngrid[ia]/ltot[ia];
+    double u = c*(r[ia] - 0.5);
+    double fl = floor(u);
+    double w = u - fl;
+
+    if (w >= 1.0) w = 0.0; /* Round off */
+
+    ewald_spme_bspline(spme->order, w, m[ia], dm[ia], d2m[ia]);
+
+    for (int k = 0; k < spme->order; k++) {
+      dm[ia][k]  *= c;
+      d2m[ia][k] *= c*c;
+    }
+
+    l0[ia] = ((int) fl) % spme->ngrid[ia];
+    if (l0[ia] < 0) l0[ia] += spme->ngrid[ia];
+  }
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  ewald_spme_spread
+ *
+ *  Q(l) = \sum_i u_i . grad W_i(l) for the dipoles rs[] (position and
+ *  orientation) held by this x-slab. The local x-plane index includes
+ *  the ghost planes.
+ *
+ *****************************************************************************/
+
+static int ewald_spme_spread(ewald_spme_t * spme, int ndipole,
+			     const double * rs) {
+  int p = spme->order;
+  int ny = spme->ngrid[Y];
+  int nz = spme->ngrid[Z];
+  int nxoff = spme->xoffset[spme->rank] - spme->nghost;
+  size_t nlocal = (size_t) (spme->nghost + spme->nxlocal)*ny*nz;
+
+  for (size_t n = 0; n < nlocal; n++) {
+    spme->qlocal[n] = 0.0;
+  }
+
+  for (int id = 0; id < ndipole; id++) {
+
+    int l0[3] = {0};
+    double m[3][EWALD_SPME_ORDER_MAX];
+    double dm[3][EWALD_SPME_ORDER_MAX];
+    double d2m[3][EWALD_SPME_ORDER_MAX];
+    const double * r = rs + EWALD_SPME_NDATA*id;
+    const double * s = rs + EWALD_SPME_NDATA*id + 3;
+
+    ewald_spme_weights(spme, r, l0, m, dm, d2m);
+    assert(ewald_spme_xowner(spme, l0[X]) == spme->rank);
+
+    for (int i = 0; i < p; i++) {
+      int ix = l0[X] - nxoff - i;
+      for (int j = 0; j < p; j++) {
+	int iy = (l0[Y] - j + ny) % ny;
+	for (int k = 0; k < p; k++) {
+	  int iz = (l0[Z] - k + nz) % nz;
+	  double q = s[X]*dm[X][i]*m[Y][j]*m[Z][k]
+	           + s[Y]*m[X][i]*dm[Y][j]*m[Z][k]
+	           + s[Z]*m[X][i]*m[Y][j]*dm[Z][k];
+	  spme->qlocal[((size_t) ix*ny + iy)*nz + iz] += q;
+	}
+      }
+    }
+  }
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  ewald_spme_interpolate
+ *
+ *  With the potential phi(l) in qlocal (including the ghost planes),
+ *  the force on dipole i is f = - \sum_l phi(l) grad (u_i . grad W_i(l)),
+ *  and the torque is -u_i x g, where g = \sum_l phi(l) grad W_i(l).
+ *  The results are ft[] (force and torque) in the order of rs[].
+ *
+ *****************************************************************************/
+
+static int ewald_spme_interpolate(ewald_spme_t * spme, int ndipole,
+				  const double * rs, double * ft) {
+  int p = spme->order;
+  int ny = spme->ngrid[Y];
+  int nz = spme->ngrid[Z];
+  int nxoff = spme->xoffset[spme->rank] - spme->nghost;
+
+  for (int id = 0; id < ndipole; id++) {
+
+    int l0[3] = {0};
+    double m[3][EWALD_SPME_ORDER_MAX];
+    double dm[3][EWALD_SPME_ORDER_MAX];
+    double d2m[3][EWALD_SPME_ORDER_MAX];
+    double f[3] = {0};
+    double g[3] = {0};
+    const double * r = rs + EWALD_SPME_NDATA*id;
+    const double * s = rs + EWALD_SPME_NDATA*id + 3;
+    double * fid = ft + EWALD_SPME_NDATA*id;
+
+    ewald_spme_weights(spme, r, l0, m, dm, d2m);
+
+    for (int i = 0; i < p; i++) {
+      int ix = l0[X] - nxoff - i;
+      for (int j = 0; j < p; j++) {
+	int iy = (l0[Y] - j + ny) % ny;
+	for (int k = 0; k < p; k++) {
+	  int iz = (l0[Z] - k + nz) % nz;
+	  double phi = spme->qlocal[((size_t) ix*ny + iy)*nz + iz];
+	  double hxx = d2m[X][i]*m[Y][j]*m[Z][k];
+	  double hyy = m[X][i]*d2m[Y][j]*m[Z][k];
+	  double hzz = m[X][i]*m[Y][j]*d2m[Z][k];
+	  double hxy = dm[X][i]*dm[Y][j]*m[Z][k];
+	  double hxz = dm[X][i]*m[Y][j]*dm[Z][k];
+	  double hyz = m[X][i]*dm[Y][j]*dm[Z][k];
+
+	  f[X] -= phi*(hxx*s[X] + hxy*s[Y] + hxz*s[Z]);
+	  f[Y] -= phi*(hxy*s[X] + hyy*s[Y] + hyz*s[Z]);
+	  f[Z] -= phi*(hxz*s[X] + hyz*s[Y] + hzz*s[Z]);
+
+	  g[X] += phi*dm[X][i]*m[Y][j]*m[Z][k];
+	  g[Y] += phi*m[X][i]*dm[Y][j]*m[Z][k];
+	  g[Z] += phi*m[X][i]*m[Y][j]*dm[Z][k];
+	}
+      }
+    }
+
+    fid[X] = f[X];
+    fid[Y] = f[Y];
+    fid[Z] = f[Z];
+
+    fid[3 + X] = -(s[Y]*g[Z] - s[Z]*g[Y]);
+    fid[3 + Y] = -(s[Z]*g[X] - s[X]*g[Z]);
+    fid[3 + Z] = -(s[X]*g[Y] - s[Y]*g[X]);
+  }
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  ewald_spme_xowner
+ *
+ *  Rank holding global x-plane ix.
+ *
+ *****************************************************************************/
+
+static int ewald_spme_xowner(const ewald_spme_t * spme, int ix) {
+
+  int owner = -1;
+
+  for (int n = 0; n < spme->nrank; n++) {
+    if (ix >= spme->xoffset[n] && ix < spme->xoffset[n] + spme->xcount[n]) {
+      owner = n;
+      break;
+    }
+  }
+
+  assert(owner >= 0);
+
+  return owner;
+}
+
+/*****************************************************************************
+ *
+ *  ewald_spme_xghost
+ *
+ *  Global x-plane for ghost plane ig (0 <= ig < nghost) of rank n.
+ *
+ *****************************************************************************/
+
+static int ewald_spme_xghost(const ewald_spme_t * spme, int n, int ig) {
+
+  int nx = spme->ngrid[X];
+
+  return (spme->xoffset[n] - spme->nghost + ig + nx) % nx;
+}
+
+/*****************************************************************************
+ *
+ *  ewald_spme_halo_counts
+ *
+ *  hcount[m] is the size of the ghost planes of this rank owned by
+ *  rank m; ocount[n] is the size of the local planes which are ghost
+ *  planes for rank n. Ranks with no x-planes have no ghosts. Returns
+ *  the buffer size required (in doubles).
+ *
+ *****************************************************************************/
+
+static int ewald_spme_halo_counts(ewald_spme_t * spme) {
+
+  int nplane = spme->ngrid[Y]*spme->ngrid[Z];
+  int nhalo = 0;
+  int nowned = 0;
+
+  for (int n = 0; n < spme->nrank; n++) {
+    spme->hcount[n] = 0;
+    spme->ocount[n] = 0;
+  }
+
+  for (int ig = 0; spme->nxlocal > 0 && ig < spme->nghost; ig++) {
+    int ix = ewald_spme_xghost(spme, spme->rank, ig);
+    spme->hcount[ewald_spme_xowner(spme, ix)] += nplane;
+    nhalo += nplane;
+  }
+
+  for (int n = 0; n < spme->nrank; n++) {
+    for (int ig = 0; spme->xcount[n] > 0 && ig < spme->nghost; ig++) {
+      int ix = ewald_spme_xghost(spme, n, ig);
+      if (ewald_spme_xowner(spme, ix) != spme->rank) continue;
+      spme->ocount[n] += nplane;
+      nowned += nplane;
+    }
+  }
+
+  for (int n = 0; n < spme->nrank; n++) {
+    spme->hdispl[n] = (n == 0) ? 0 : spme->hdispl[n-1] + spme->hcount[n-1];
+    spme->odispl[n] = (n == 0) ? 0 : spme->odispl[n-1] + spme->ocount[n-1];
+  }
+
+  return imax(nhalo, nowned);
+}
+
+/*****************************************************************************
+ *
+ *  ewald_spme_halo
+ *
+ *  reverse: the ghost planes are added to the planes of the owning
+ *  rank (after spreading). Otherwise, the ghost planes are set from
+ *  the owning rank (before interpolation). Messages hold the planes
+ *  in order of increasing ghost index.
+ *
+ *****************************************************************************/
+
+static int ewald_spme_halo(ewald_spme_t * spme, int reverse) {
+
+  int nplane = spme->ngrid[Y]*spme->ngrid[Z];
+  int nxoff = spme->xoffset[spme->rank] - spme->nghost;
+
+  /* Ghost side: pack (reverse) or unpack (forward) */
+
+  for (int n = 0; reverse && n < spme->nrank; n++) {
+    double * buf = spme->hsbuf + spme->hdispl[n];
+    for (int ig = 0; spme->nxlocal > 0 && ig < spme->nghost; ig++) {
+      int ix = ewald_spme_xghost(spme, spme->rank, ig);
+      if (ewald_spme_xowner(spme, ix) != n) continue;
+      for (int ip = 0; ip < nplane; ip++) {
+	*buf++ = spme->qlocal[(size_t) ig*nplane + ip];
+      }
+    }
+  }
+
+  /* Owning side: pack (forward) */
+
+  for (int n = 0; !reverse && n < spme->nrank; n++) {
+    double * buf = spme->hsbuf + spme->odispl[n];
+    for (int ig = 0; spme->xcount[n] > 0 && ig < spme->nghost; ig++) {
+      int ix = ewald_spme_xghost(spme, n, ig);
+      if (ewald_spme_xowner(spme, ix) != spme->rank) continue;
+      for (int ip = 0; ip < nplane; ip++) {
+	*buf++ = spme->qlocal[(size_t) (ix - nxoff)*nplane + ip];
+      }
+    }
+  }
+
+  if (reverse) {
+    MPI_Alltoallv(spme->hsbuf, spme->hcount, spme->hdispl, MPI_DOUBLE,
+		  spme->hrbuf, spme->ocount, spme->odispl, MPI_DOUBLE,
+		  spme->comm);
+  }
+  else {
+    MPI_Alltoallv(spme->hsbuf, spme->ocount, spme->odispl, MPI_DOUBLE,
+		  spme->hrbuf, spme->hcount, spme->hdispl, MPI_DOUBLE,
+		  spme->comm);
+  }
+
+  /* Owning side: accumulate (reverse) */
+
+  for (int n = 0; reverse && n < spme->nrank; n++) {
+    const double * buf = spme->hrbuf + spme->odispl[n];
+    for (int ig = 0; spme->xcount[n] > 0 && ig < spme->nghost; ig++) {
+      int ix = ewald_spme_xghost(spme, n, ig);
+      if (ewald_spme_xowner(spme, ix) != spme->rank) continue;
+      for (int ip = 0; ip < nplane; ip++) {
+	spme->qlocal[(size_t) (ix - nxoff)*nplane + ip] += *buf++;
+      }
+    }
+  }
+
+  /* Ghost side: unpack (forward) */
+
+  for (int n = 0; !reverse && n < spme->nrank; n++) {
+    const double * buf = spme->hrbuf + spme->hdispl[n];
+    for (int ig = 0; spme->nxlocal > 0 && ig < spme->nghost; ig++) {
+      int ix = ewald_spme_xghost(spme, spme->rank, ig);
+      if (ewald_spme_xowner(spme, ix) != n) continue;
+      for (int ip = 0; ip < nplane; ip++) {
+	spme->qlocal[(size_t) ig*nplane + ip] = *buf++;
+      }
+    }
+  }
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  ewald_spme_convolve
+ *
+ *  On entry the local x-planes of qlocal hold the charge mesh; on exit
+ *  they hold the potential. The local contribution to the energy is
+ *  returned.
+ *
+ *****************************************************************************/
+
+static int ewald_spme_convolve(ewald_spme_t * spme, double * energy) {
+
+  size_t nslab = (size_t) spme->nxlocal*spme->ngrid[Y]*spme->ngrid[Z];
+  size_t npencil = (size_t) spme->ngrid[X]*spme->nylocal*spme->ngrid[Z];
+  size_t nghost = (size_t) spme->nghost*spme->ngrid[Y]*spme->ngrid[Z];
+  double * q = spme->qlocal + nghost;
+  double e = 0.0;
+
+  for (size_t n = 0; n < nslab; n++) {
+    spme->slab[2*n    ] = q[n];
+    spme->slab[2*n + 1] = 0.0;
+  }
+
+  ewald_spme_slab_fft(spme, +1);
+  ewald_spme_transpose(spme, 1);
+  ewald_spme_pencil_fft(spme, +1);
+
+  for (size_t n = 0; n < npencil; n++) {
+    double re = spme->pencil[2*n];
+    double im = spme->pencil[2*n + 1];
+    e += 0.5*spme->theta[n]*(re*re + im*im);
+    spme->pencil[2*n    ] = spme->theta[n]*re;
+    spme->pencil[2*n + 1] = spme->theta[n]*im;
+  }
+
+  ewald_spme_pencil_fft(spme, -1);
+  ewald_spme_transpose(spme, 0);
+  ewald_spme_slab_fft(spme, -1);
+
+  for (size_t n = 0; n < nslab; n++) {
+    q[n] = spme->slab[2*n];
+  }
+
+  *energy = e;
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  ewald_spme_slab_fft
+ *
+ *  Transforms in z and y for the local x-planes.
+ *
+ *****************************************************************************/
+
+static int ewald_spme_slab_fft(ewald_spme_t * spme, int sign) {
+
+  int ny = spme->ngrid[Y];
+  int nz = spme->ngrid[Z];
+
+  for (int xl = 0; xl < spme->nxlocal; xl++) {
+    double * plane = spme->slab + 2*(size_t) xl*ny*nz;
+
+    for (int iy = 0; iy < ny; iy++) {
+      ewald_spme_fft1d(nz, spme->wtab[Z], sign, plane + 2*iy*nz);
+    }
+
+    for (int iz = 0; iz < nz; iz++) {
+      for (int iy = 0; iy < ny; iy++) {
+	spme->line[2*iy    ] = plane[2*(iy*nz + iz)    ];
+	spme->line[2*iy + 1] = plane[2*(iy*nz + iz) + 1];
+      }
+      ewald_spme_fft1d(ny, spme->wtab[Y], sign, spme->line);
+      for (int iy = 0; iy < ny; iy++) {
+	plane[2*(iy*nz + iz)    ] = spme->line[2*iy    ];
+	plane[2*(iy*nz + iz) + 1] = spme->line[2*iy + 1];
+      }
+    }
+  }
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  ewald_spme_pencil_fft
+ *
+ *  Transform in x for the local y-planes.
+ *
+ *****************************************************************************/
+
+static int ewald_spme_pencil_fft(ewald_spme_t * spme, int sign) {
+
+  int nx = spme->ngrid[X];
+  int nz = spme->ngrid[Z];
+
+  for (int yl = 0; yl < spme->nylocal; yl++) {
+    double * plane = spme->pencil + 2*(size_t) yl*nx*nz;
+
+    for (int iz = 0; iz < nz; iz++) {
+      for (int ix = 0; ix < nx; ix++) {
+	spme->line[2*ix    ] = plane[2*(ix*nz + iz)    ];
+	spme->line[2*ix + 1] = plane[2*(ix*nz + iz) + 1];
+      }
+      ewald_spme_fft1d(nx, spme->wtab[X], sign, spme->line);
+      for (int ix = 0; ix < nx; ix++) {
+	plane[2*(ix*nz + iz)    ] = spme->line[2*ix    ];
+	plane[2*(ix*nz + iz) + 1] = spme->line[2*ix + 1];
+      }
+    }
+  }
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  ewald_spme_transpose
+ *
+ *  forward: x-slab [x][y][z] to y-slab [y][x][z]; otherwise reverse.
+ *  The block exchanged between ranks r (x-slab) and s (y-slab) is
+ *  ordered [x in r][y in s][z] in the message.
+ *
+ *****************************************************************************/
+
+static int ewald_spme_transpose(ewald_spme_t * spme, int forward) {
+
+  int nx = spme->ngrid[X];
+  int ny = spme->ngrid[Y];
+  int nz = spme->ngrid[Z];
+  int * xslab_count = NULL;
+  int * xslab_displ = NULL;
+  int * yslab_count = NULL;
+  int * yslab_displ = NULL;
+
+  /* Counts for the x-slab side (by y-slab rank) and y-slab side */
+
+  xslab_count = forward ? spme->scount : spme->rcount;
+  xslab_displ = forward ? spme->sdispl : spme->rdispl;
+  yslab_count = forward ? spme->rcount : spme->scount;
+  yslab_displ = forward ? spme->rdispl : spme->sdispl;
+
+  for (int n = 0; n < spme->nrank; n++) {
+    xslab_count[n] = 2*spme->nxlocal*spme->ycount[n]*nz;
+    yslab_count[n] = 2*spme->xcount[n]*spme->nylocal*nz;
+    xslab_displ[n] = (n == 0) ? 0 : xslab_displ[n-1] + xslab_count[n-1];
+    yslab_displ[n] = (n == 0) ? 0 : yslab_displ[n-1] + yslab_count[n-1];
+  }
+
+  if (forward) {
+    for (int n = 0; n < spme->nrank; n++) {
+      double * buf = spme->sbuf + spme->sdispl[n];
+      for (int xl = 0; xl < spme->nxlocal; xl++) {
+	for (int yl = 0; yl < spme->ycount[n]; yl++) {
+	  int iy = spme->yoffset[n] + yl;
+	  const double * src = spme->slab + 2*((size_t) xl*ny + iy)*nz;
+	  for (int iz = 0; iz < 2*nz; iz++) *buf++ = src[iz];
+	}
+      }
+    }
+  }
+  else {
+    for (int n = 0; n < spme->nrank; n++) {
+      double * buf = spme->sbuf + spme->sdispl[n];
+      for (int xl = 0; xl < spme->xcount[n]; xl++) {
+	for (int yl = 0; yl < spme->nylocal; yl++) {
+	  int ix = spme->xoffset[n] + xl;
+	  const double * src = spme->pencil + 2*((size_t) yl*nx + ix)*nz;
+	  for (int iz = 0; iz < 2*nz; iz++) *buf++ = src[iz];
+	}
+      }
+    }
+  }
+
+  MPI_Alltoallv(spme->sbuf, spme->scount, spme->sdispl, MPI_DOUBLE,
+		spme->rbuf, spme->rcount, spme->rdispl, MPI_DOUBLE,
+		spme->comm);
+
+  if (forward) {
+    for (int n = 0; n < spme->nrank; n++) {
+      const double * buf = spme->rbuf + spme->rdispl[n];
+      for (int xl = 0; xl < spme->xcount[n]; xl++) {
+	for (int yl = 0; yl < spme->nylocal; yl++) {
+	  int ix = spme->xoffset[n] + xl;
+	  double * dst = spme->pencil + 2*((size_t) yl*nx + ix)*nz;
+	  for (int iz = 0; iz < 2*nz; iz++) dst[iz] = *buf++;
+	}
+      }
+    }
+  }
+  else {
+    for (int n = 0; n < spme->nrank; n++) {
+      const double * buf = spme->rbuf + spme->rdispl[n];
+      for (int xl = 0; xl < spme->nxlocal; xl++) {
+	for (int yl = 0; yl < spme->ycount[n]; yl++) {
+	  int iy = spme->yoffset[n] + yl;
+	  double * dst = spme->slab + 2*((size_t) xl*ny + iy)*nz;
+	  for (int iz = 0; iz < 2*nz; iz++) dst[iz] = *buf++;
+	}
+      }
+    }
+  }
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  ewald_spme_fft1d
+ *
+ *  In-place radix-2 complex transform of length n (a power of two)
+ *  data[2*j] + i data[2*j+1] -> \sum_j data_j exp(sign 2 pi i j k/n).
+ *  No normalisation is applied. wtab holds exp(2 pi i j/n) for
+ *  j < n/2.
+ *
+ *****************************************************************************/
+
+static void ewald_spme_fft1d(int n, const double * wtab, int sign,
+			     double * data) {
+
+  /* Bit reversal permutation */
+
+  for (int i = 1, j = 0; i < n; i++) {
+    int bit = n >> 1;
+    for ( ; j & bit; bit >>= 1) j ^= bit;
+    j ^= bit;
+    if (i < j) {
+      double tr = data[2*i];
+      double ti = data[2*i + 1];
+      data[2*i    ] = data[2*j];
+      data[2*i + 1] = data[2*j + 1];
+      data[2*j    ] = tr;
+      data[2*j + 1] = ti;
+    }
+  }
+
+  /* Butterflies */
+
+  for (int len = 2; len <= n; len <<= 1) {
+    int half = len/2;
+    int step = n/len;
+    for (int i = 0; i < n; i += len) {
+      for (int j = 0; j < half; j++) {
+	double wr = wtab[2*j*step];
+	double wi = sign*wtab[2*j*step + 1];
+	int a = i + j;
+	int b = i + j + half;
+	double tr = wr*data[2*b] - wi*data[2*b + 1];
+	double ti = wr*data[2*b + 1] + wi*data[2*b];
+	data[2*b    ] = data[2*a    ] - tr;
+	data[2*b + 1] = data[2*a + 1] - ti;
+	data[2*a    ] += tr;
+	data[2*a + 1] += ti;
+      }
+    }
+  }
+
+  return;
+}
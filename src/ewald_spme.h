@@ -0,0 +1,41 @@
+/*****************************************************************************
+ *
+ *  ewald_spme.h
+ *
+ *  Smooth particle mesh Ewald for the Fourier space part of the
+ *  dipolar Ewald sum.
+ *
+ *  Edinburgh Soft Matter and Statistical Physics Group and
+ *  Edinburgh Parallel Computing Centre
+ *
+ *  (c) 2024 The University of Edinburgh
+ *
+ *  Contributing authors:
+ *  Kevin Stratford (kevin@epcc.ed.ac.uk)
+ *
+ *****************************************************************************/
+
+#ifndef LUDWIG_EWALD_SPME_H
+#define LUDWIG_EWALD_SPME_H
+
+#include "pe.h"
+#include "coords.h"
+#include "colloids.h"
+
+#define EWALD_SPME_ORDER_MIN     4
+#define EWALD_SPME_ORDER_MAX    12
+#define EWALD_SPME_ORDER_DEFAULT 6
+
+typedef struct ewald_spme_s ewald_spme_t;
+
+int ewald_spme_create(pe_t * pe, cs_t * cs, int order, const int ngrid[3],
+		      double mu, double kappa, ewald_spme_t ** spme);
+int ewald_spme_free(ewald_spme_t * spme);
+int ewald_spme_order(const ewald_spme_t * spme, int * order);
+int ewald_spme_ngrid(const ewald_spme_t * spme, int ngrid[3]);
+int ewald_spme_compute(ewald_spme_t * spme, colloids_info_t * cinfo,
+		       int iforce, double * energy);
+int ewald_spme_bspline(int order, double w, double * m, double * dm,
+		       double * d2m);
+
+#endif
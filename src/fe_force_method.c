@@ -62,6 +62,9 @@ fe_force_method_enum_t fe_force_method_to_enum(const char * method) {
   else if (strcmp(method, "relaxation_antisymmetric") == 0) {
     imethod = FE_FORCE_METHOD_RELAXATION_ANTI;
   }
+  else if (strcmp(method, "stress_divergence_recompute") == 0) {
+    imethod = FE_FORCE_METHOD_STRESS_RECOMPUTE;
+  }
 
   return imethod;
 }
@@ -95,6 +98,9 @@ const char * fe_force_method_to_string(fe_force_method_enum_t method) {
   case (FE_FORCE_METHOD_RELAXATION_ANTI):
     mstring = "relaxation_antisymmetric";
     break;
+  case (FE_FORCE_METHOD_STRESS_RECOMPUTE):
+    mstring = "stress_divergence_recompute";
+    break;
   default:
     mstring = "Not found";
   }
@@ -25,6 +25,7 @@ typedef enum {
   FE_FORCE_METHOD_PHI_GRADMU_CORRECTION,      /* Version with conservation */
   FE_FORCE_METHOD_RELAXATION_SYMM,            /* Via LB collision */
   FE_FORCE_METHOD_RELAXATION_ANTI,            /* Antisymmetric case */
+  FE_FORCE_METHOD_STRESS_RECOMPUTE,           /* Divergence, no storage */
   FE_FORCE_METHOD_MAX
 } fe_force_method_enum_t;
 
@@ -177,6 +177,9 @@ __host__ int field_free(field_t * obj) {
     tdpFree(obj->target);
   }
 
+  /* Complete any asynchronous write in progress */
+  io_impl_async_free(&obj->iowrite);
+
   if (obj->data) free(obj->data);
 
   field_halo_free(&obj->h);
@@ -1659,7 +1662,14 @@ int field_io_write(field_t * field, int timestep, io_event_t * event) {
   }
 
   io_subfile_name(&meta->subfile, field->name, timestep, filename, BUFSIZ);
-  ifail = io_impl_create(meta, &io);
+
+  if (meta->options.asynchronous) {
+    /* Pack into the idle one of two buffers; completes later */
+    ifail = io_impl_async_buffer(&field->iowrite, meta, &io);
+  }
+  else {
+    ifail = io_impl_create(meta, &io);
+  }
   assert(ifail == 0);
 
   if (ifail == 0) {
@@ -1668,13 +1678,19 @@ int field_io_write(field_t * field, int timestep, io_event_t * event) {
     field_io_aggr_pack(field, io->aggr);
 
     io_event_record(event, IO_EVENT_WRITE);
-    io->impl->write(io, filename);
-
-    if (meta->options.report) {
-      pe_info(field->pe, "MPIIO wrote to %s\n", filename);
+    if (meta->options.asynchronous) {
+      io_impl_async_write_begin(&field->iowrite, filename);
+      if (meta->options.report) {
+	pe_info(field->pe, "MPIIO writing to %s (asynchronous)\n", filename);
+      }
+    }
+    else {
+      io->impl->write(io, filename);
+      if (meta->options.report) {
+	pe_info(field->pe, "MPIIO wrote to %s\n", filename);
+      }
+      io->impl->free(&io);
     }
-
-    io->impl->free(&io);
     io_event_report(event, meta, field->name);
   }
 
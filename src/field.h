@@ -80,6 +80,7 @@ struct field_s {
 
   io_metadata_t iometadata_in;  /* Input details */
   io_metadata_t iometadata_out; /* Output details */
+  io_impl_async_t iowrite;      /* Asynchronous output buffers */
 
   field_halo_t h;               /* Host halo */
   field_options_t opts;         /* Options */
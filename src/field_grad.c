@@ -7,7 +7,7 @@
  *  Edinburgh Soft Matter and Statistical Physics Group and
  *  Edinburgh Parallel Computing Centre
  *
- *  (c) 2012-2023 The University of Edinburgh
+ *  (c) 2012-2024 The University of Edinburgh
  *
  *  Contributing authors:
  *  Kevin Stratford (kevin@epcc.ed.ac.uk)
@@ -22,9 +22,12 @@
 #include "pe.h"
 #include "coords.h"
 #include "leesedwards.h"
+#include "timer.h"
+#include "util.h"
 #include "field_grad.h"
 
 static int field_grad_init(field_grad_t * obj);
+static int field_grad_compute_higher(field_grad_t * obj);
 
 /*****************************************************************************
  *
@@ -322,6 +325,23 @@ int field_grad_compute(field_grad_t * obj) {
 
   obj->d2(obj);
 
+  field_grad_compute_higher(obj);
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  field_grad_compute_higher
+ *
+ *  Derivatives beyond d2, which require d2 complete at all sites.
+ *
+ *****************************************************************************/
+
+static int field_grad_compute_higher(field_grad_t * obj) {
+
+  assert(obj);
+
   if (obj->level == 3) {
     assert(obj->dab);
     obj->dab(obj);
@@ -335,6 +355,138 @@ int field_grad_compute(field_grad_t * obj) {
   return 0;
 }
 
+/*****************************************************************************
+ *
+ *  field_grad_halo_compute
+ *
+ *  Halo swap for the field followed by the gradient computation.
+ *
+ *  If the d2 method allows it (obj->overlap), and there are no
+ *  Lees-Edwards planes, the d2 stencil is applied to the interior
+ *  sites while the halo exchange is in flight. The remaining shell
+ *  of sites is computed once the exchange is complete. The interior
+ *  is the local domain less a layer of width nhcomm, which must be
+ *  at least the stencil width.
+ *
+ *  Otherwise, this is field_halo() then field_grad_compute().
+ *
+ *****************************************************************************/
+
+__host__ int field_grad_halo_compute(field_grad_t * obj) {
+
+  int nplane = 0;
+  field_t * field = NULL;
+
+  assert(obj);
+  assert(obj->d2);
+  assert(obj->field);
+
+  field = obj->field;
+  if (field->le) nplane = lees_edw_nplane_total(field->le);
+
+  if (obj->overlap == 0 || nplane > 0) {
+    TIMER_start(TIMER_PHI_HALO);
+    field_halo(field);
+    TIMER_stop(TIMER_PHI_HALO);
+    field_grad_compute(obj);
+  }
+  else {
+    int nhalo = 0;
+    int nlocal[3] = {0};
+    int nshell = 0;
+    cs_limits_t shell[6] = {0};
+    cs_limits_t interior = {0};
+
+    cs_nhalo(field->cs, &nhalo);
+    cs_nlocal(field->cs, nlocal);
+
+    {
+      /* Interior of local domain; the shell is everything else */
+      cs_limits_t lim = {1, nlocal[X], 1, nlocal[Y], 1, nlocal[Z]};
+      cs_limits_t all = {1 - nhalo, nlocal[X] + nhalo,
+                         1 - nhalo, nlocal[Y] + nhalo,
+                         1 - nhalo, nlocal[Z] + nhalo};
+      interior = cs_limits_interior(lim, field->nhcomm);
+      nshell = cs_limits_shell(all, nhalo + field->nhcomm, shell);
+    }
+
+    TIMER_start(TIMER_PHI_HALO);
+    field_halo_post(field, &field->h);
+    TIMER_stop(TIMER_PHI_HALO);
+
+    obj->lim = &interior;
+    obj->d2(obj);
+
+    TIMER_start(TIMER_PHI_HALO);
+    field_halo_wait(field, &field->h);
+    TIMER_stop(TIMER_PHI_HALO);
+
+    for (int n = 0; n < nshell; n++) {
+      obj->lim = shell + n;
+      obj->d2(obj);
+    }
+    obj->lim = NULL;
+
+    field_grad_compute_higher(obj);
+  }
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  field_grad_overlap_set
+ *
+ *  Only d2 methods which respect obj->lim (via field_grad_limits())
+ *  should set overlap.
+ *
+ *****************************************************************************/
+
+__host__ int field_grad_overlap_set(field_grad_t * obj, int overlap) {
+
+  assert(obj);
+
+  obj->overlap = overlap;
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  field_grad_limits
+ *
+ *  The extent of the d2 computation for a method working to nextra
+ *  points into the halo, restricted to obj->lim if present.
+ *  Returns zero if the resulting region is empty.
+ *
+ *****************************************************************************/
+
+__host__ int field_grad_limits(const field_grad_t * obj, int nextra,
+			       cs_limits_t * lim) {
+  int nlocal[3] = {0};
+
+  assert(obj);
+  assert(lim);
+
+  cs_nlocal(obj->field->cs, nlocal);
+
+  lim->imin = 1 - nextra; lim->imax = nlocal[X] + nextra;
+  lim->jmin = 1 - nextra; lim->jmax = nlocal[Y] + nextra;
+  lim->kmin = 1 - nextra; lim->kmax = nlocal[Z] + nextra;
+
+  if (obj->lim) {
+    lim->imin = imax(lim->imin, obj->lim->imin);
+    lim->imax = imin(lim->imax, obj->lim->imax);
+    lim->jmin = imax(lim->jmin, obj->lim->jmin);
+    lim->jmax = imin(lim->jmax, obj->lim->jmax);
+    lim->kmin = imax(lim->kmin, obj->lim->kmin);
+    lim->kmax = imin(lim->kmax, obj->lim->kmax);
+  }
+
+  return (lim->imin <= lim->imax && lim->jmin <= lim->jmax &&
+	  lim->kmin <= lim->kmax);
+}
+
 /*****************************************************************************
  *
  *  field_grad_scalar_grad
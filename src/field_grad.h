@@ -5,7 +5,7 @@
  *  Edinburgh Soft Matter and Statistical Physics Group and
  *  Edinburgh Parallel Computing Centre
  *
- *  (c) 2012-2021 The University of Edinburgh
+ *  (c) 2012-2024 The University of Edinburgh
  *
  *  Contributing authors:
  *  Kevin Stratford (kevin@epcc.ed.ac.uk)
@@ -35,6 +35,9 @@ struct field_grad_s {
 
   field_grad_t * target;    /* copy of this structure on target */ 
 
+  int overlap;              /* d2 respects lim: halo may be overlapped */
+  const cs_limits_t * lim;  /* If non-NULL, restrict d2 to lim (host) */
+
   int (* d2)  (field_grad_t * fgrad);
   int (* d4)  (field_grad_t * fgrad);
   int (* dab) (field_grad_t * fgrad);
@@ -47,6 +50,10 @@ __host__ void field_grad_free(field_grad_t * obj);
 __host__ int field_grad_set(field_grad_t * obj, grad_ft d2, grad_ft d4);
 __host__ int field_grad_dab_set(field_grad_t * obj, grad_ft dab);
 __host__ int field_grad_compute(field_grad_t * obj);
+__host__ int field_grad_halo_compute(field_grad_t * obj);
+__host__ int field_grad_overlap_set(field_grad_t * obj, int overlap);
+__host__ int field_grad_limits(const field_grad_t * obj, int nextra,
+			       cs_limits_t * lim);
 __host__ int field_grad_memcpy(field_grad_t * obj, tdpMemcpyKind flag);
 
 __host__ __device__ int field_grad_scalar_grad(field_grad_t * obj, int index, double grad[3]);
@@ -177,22 +177,19 @@ __host__ int grad_3d_27pt_fluid_dab(field_grad_t * fgrad) {
 __host__ int grad_3d_27pt_fluid_operator(cs_t * cs, lees_edw_t * le,
 					 field_grad_t * fg,
 					 int nextra, grad_enum_t type) {
-  int nlocal[3];
   int xs, ys, zs;
+  cs_limits_t lim = {0};
   lees_edw_t * letarget = NULL;
 
-  lees_edw_nlocal(le, nlocal);
+  /* Extent (possibly restricted to fg->lim) may be empty */
+  if (field_grad_limits(fg, nextra, &lim) == 0) return 0;
+
   lees_edw_strides(le, &xs, &ys, &zs);
   lees_edw_target(le, &letarget);
 
   {
     dim3 nblk = {};
     dim3 ntpb = {};
-    cs_limits_t lim = {
-      .imin = 1 - nextra, .imax = nlocal[X] + nextra,
-      .jmin = 1 - nextra, .jmax = nlocal[Y] + nextra,
-      .kmin = 1 - nextra, .kmax = nlocal[Z] + nextra
-    };
     kernel_3d_t k3d = kernel_3d(cs, lim);
 
     kernel_3d_launch_param(k3d.kiterations, &nblk, &ntpb);
@@ -83,6 +83,7 @@ int gradient_rt_init(pe_t * pe, rt_t * rt, const char * fieldname,
       f2 = grad_3d_7pt_fluid_d2;
       f4 = grad_3d_7pt_fluid_d4;
       field_grad_dab_set(grad, grad_3d_7pt_fluid_dab);
+      field_grad_overlap_set(grad, 1);
     }
     else if (strcmp(keyvalue, "3d_7pt_solid") == 0) {
       pe_info(pe, "3d_7pt_solid\n");
@@ -96,6 +97,7 @@ int gradient_rt_init(pe_t * pe, rt_t * rt, const char * fieldname,
       f2 = grad_3d_27pt_fluid_d2;
       f4 = grad_3d_27pt_fluid_d4;
       field_grad_dab_set(grad, grad_3d_27pt_fluid_dab);
+      field_grad_overlap_set(grad, 1);
     }
     else if (strcmp(keyvalue, "3d_27pt_solid") == 0) {
       pe_info(pe, "3d_27pt_solid\n");
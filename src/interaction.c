@@ -36,6 +36,7 @@
 #include "stats_colloid.h"
 #include "driven_colloid.h"
 #include "interaction.h"
+#include "colloid_pair_list.h"
 
 struct interact_s {
   pe_t * pe;
@@ -52,6 +53,8 @@ struct interact_s {
   void * abstr[INTERACT_MAX];        /* Abstract interaction types */
   compute_ft compute[INTERACT_MAX];  /* Corresponding compute functions */
   stat_ft stats[INTERACT_MAX];       /* Statistics functions */
+
+  int isfull;                        /* Full pair list (statistics step) */
 };
 
 /*****************************************************************************
@@ -203,6 +206,8 @@ int interact_compute(interact_t * interact, colloids_info_t * cinfo,
     interact_wall(interact, cinfo);
 
     if (nc > 1) {
+      /* Minimum separations are reported for all neighbours */
+      interact->isfull = is_statistics_step();
       interact_pairwise(interact, cinfo);
       interact_bonds(interact, cinfo);
       interact_angles(interact, cinfo);
@@ -581,6 +586,9 @@ int colloids_update_forces_fluid_driven(colloids_info_t * cinfo,
  *
  *  interact_pairwise
  *
+ *  The pair list is updated (rebuilt only if required) before the
+ *  lubrication and pair potential computations, which both use it.
+ *
  *****************************************************************************/
 
 int interact_pairwise(interact_t * obj, colloids_info_t * cinfo) {
@@ -590,6 +598,18 @@ int interact_pairwise(interact_t * obj, colloids_info_t * cinfo) {
   assert(obj);
   assert(cinfo);
 
+  if (obj->abstr[INTERACT_LUBR] || obj->abstr[INTERACT_PAIR]) {
+
+    /* Update the pair list shared by all pairwise interactions */
+
+    int ispair = 0;
+    double hc = 0.0;
+    double rc = 0.0;
+
+    interact_pairwise_range(obj, &ispair, &hc, &rc);
+    colloid_pair_list_update(cinfo->plist, cinfo, hc, rc, obj->isfull);
+  }
+
   intr = obj->abstr[INTERACT_LUBR];
   if (intr) obj->compute[INTERACT_LUBR](cinfo, intr);
 
@@ -783,6 +803,35 @@ int interact_rcmax(interact_t * obj, double * rcmax) {
   return 0;
 }
 
+/*****************************************************************************
+ *
+ *  interact_pairwise_range
+ *
+ *  Ranges hc, rc of the pairwise interactions (pair potential and
+ *  lubrication) which use the colloid pair list; ispair is set if
+ *  there are any such interactions.
+ *
+ *****************************************************************************/
+
+int interact_pairwise_range(interact_t * obj, int * ispair, double * hc,
+			    double * rc) {
+  assert(obj);
+  assert(ispair);
+  assert(hc);
+  assert(rc);
+
+  *ispair = (obj->abstr[INTERACT_LUBR] || obj->abstr[INTERACT_PAIR]);
+  *hc = 0.0;
+  *rc = 0.0;
+
+  if (obj->hcset[INTERACT_LUBR]) *hc = dmax(*hc, obj->hc[INTERACT_LUBR]);
+  if (obj->hcset[INTERACT_PAIR]) *hc = dmax(*hc, obj->hc[INTERACT_PAIR]);
+  if (obj->rcset[INTERACT_LUBR]) *rc = dmax(*rc, obj->rc[INTERACT_LUBR]);
+  if (obj->rcset[INTERACT_PAIR]) *rc = dmax(*rc, obj->rc[INTERACT_PAIR]);
+
+  return 0;
+}
+
 /*****************************************************************************
  *
  *  interaact_hcmax
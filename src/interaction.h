@@ -63,6 +63,8 @@ int interact_find_bonds_all(interact_t * obj, colloids_info_t * cinfo, int nx);
 int interact_stats(interact_t * obj, colloids_info_t * cinfo);
 int interact_hcmax(interact_t * obj, double * hcmax);
 int interact_rcmax(interact_t * obj, double * rcmax);
+int interact_pairwise_range(interact_t * obj, int * ispair, double * hc,
+			    double * rc);
 
 /* One can question whether these body-force contributions really
  * belong here, or elsewhere. The change in names reflects this uncertainty. */
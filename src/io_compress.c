@@ -0,0 +1,279 @@
+/*****************************************************************************
+ *
+ *  io_compress.c
+ *
+ *  A simple, self-contained, lossless codec for i/o buffers.
+ *
+ *  The buffer is first "shuffled": for elements of size szelement
+ *  bytes, all the first bytes are stored together, then all the
+ *  second bytes, and so on. For double precision data this tends to
+ *  produce long runs in the sign/exponent bytes. The result is then
+ *  run-length encoded using the PackBits convention:
+ *
+ *    control byte c <  128: a literal run of (c + 1) bytes follows;
+ *    control byte c >= 128: the next byte is repeated (c - 126) times.
+ *
+ *  The worst case expansion is one byte in 128 (plus one).
+ *
+ *  There is no external dependency; the compression level is only
+ *  relevant in that level 0 means no compression. The shuffle is
+ *  omitted for a level of 1 (or szelement = 1, e.g., ASCII data).
+ *
+ *  Edinburgh Soft Matter and Statistical Physics Group and
+ *  Edinburgh Parallel Computing Centre
+ *
+ *  (c) 2024 The University of Edinburgh
+ *
+ *  Kevin Stratford (kevin@epcc.ed.ac.uk)
+ *
+ *****************************************************************************/
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "io_compress.h"
+
+#define IO_COMPRESS_RUN_MIN     3    /* Shortest repeat worth encoding */
+#define IO_COMPRESS_RUN_MAX   129    /* Longest repeat (c = 255) */
+#define IO_COMPRESS_LIT_MAX   128    /* Longest literal (c = 127) */
+
+static void io_shuffle(size_t sz, const char * src, size_t n, char * dst);
+static void io_unshuffle(size_t sz, const char * src, size_t n, char * dst);
+static size_t io_rle_encode(const unsigned char * src, size_t n,
+			    unsigned char * dst);
+static int io_rle_decode(const unsigned char * src, size_t n,
+			 unsigned char * dst, size_t ndst);
+
+/*****************************************************************************
+ *
+ *  io_compress_bound
+ *
+ *  Maximum size of compressed output for nbytes input.
+ *
+ *****************************************************************************/
+
+size_t io_compress_bound(size_t nbytes) {
+
+  return nbytes + nbytes/IO_COMPRESS_LIT_MAX + 1;
+}
+
+/*****************************************************************************
+ *
+ *  io_compress
+ *
+ *  The destination dst must be at least io_compress_bound(nsrc) bytes.
+ *  The actual compressed size is returned in ndst. The level must
+ *  be at least 1.
+ *
+ *****************************************************************************/
+
+int io_compress(int level, size_t szelement, const char * src, size_t nsrc,
+		char * dst, size_t * ndst) {
+
+  int ifail = 0;
+
+  assert(level > 0);
+  assert(szelement > 0);
+  assert(src);
+  assert(dst);
+  assert(ndst);
+
+  if (level == 1 || szelement == 1) {
+    *ndst = io_rle_encode((const unsigned char *) src, nsrc,
+			  (unsigned char *) dst);
+  }
+  else {
+    char * tmp = (char *) malloc(nsrc*sizeof(char));
+
+    if (tmp == NULL) {
+      ifail = -1;
+    }
+    else {
+      io_shuffle(szelement, src, nsrc, tmp);
+      *ndst = io_rle_encode((const unsigned char *) tmp, nsrc,
+			    (unsigned char *) dst);
+      free(tmp);
+    }
+  }
+
+  return ifail;
+}
+
+/*****************************************************************************
+ *
+ *  io_decompress
+ *
+ *  The expected size of the uncompressed data ndst must be known.
+ *  The level is not required, but szelement must be as for the
+ *  compression (use szelement = 1 for level 1).
+ *
+ *  Returns zero on success, or non-zero if the compressed stream
+ *  is inconsistent with ndst.
+ *
+ *****************************************************************************/
+
+int io_decompress(size_t szelement, const char * src, size_t nsrc,
+		  char * dst, size_t ndst) {
+
+  int ifail = 0;
+
+  assert(szelement > 0);
+  assert(src);
+  assert(dst);
+
+  if (szelement == 1) {
+    ifail = io_rle_decode((const unsigned char *) src, nsrc,
+			  (unsigned char *) dst, ndst);
+  }
+  else {
+    char * tmp = (char *) malloc(ndst*sizeof(char));
+
+    if (tmp == NULL) {
+      ifail = -1;
+    }
+    else {
+      ifail = io_rle_decode((const unsigned char *) src, nsrc,
+			    (unsigned char *) tmp, ndst);
+      if (ifail == 0) io_unshuffle(szelement, tmp, ndst, dst);
+      free(tmp);
+    }
+  }
+
+  return ifail;
+}
+
+/*****************************************************************************
+ *
+ *  io_shuffle
+ *
+ *  Any trailing bytes (n not a multiple of sz) are copied as-is.
+ *
+ *****************************************************************************/
+
+static void io_shuffle(size_t sz, const char * src, size_t n, char * dst) {
+
+  size_t nel = n/sz;
+
+  for (size_t ib = 0; ib < sz; ib++) {
+    for (size_t iel = 0; iel < nel; iel++) {
+      dst[ib*nel + iel] = src[iel*sz + ib];
+    }
+  }
+
+  memcpy(dst + nel*sz, src + nel*sz, n - nel*sz);
+
+  return;
+}
+
+/*****************************************************************************
+ *
+ *  io_unshuffle
+ *
+ *****************************************************************************/
+
+static void io_unshuffle(size_t sz, const char * src, size_t n, char * dst) {
+
+  size_t nel = n/sz;
+
+  for (size_t ib = 0; ib < sz; ib++) {
+    for (size_t iel = 0; iel < nel; iel++) {
+      dst[iel*sz + ib] = src[ib*nel + iel];
+    }
+  }
+
+  memcpy(dst + nel*sz, src + nel*sz, n - nel*sz);
+
+  return;
+}
+
+/*****************************************************************************
+ *
+ *  io_rle_encode
+ *
+ *  Returns the number of bytes written to dst.
+ *
+ *****************************************************************************/
+
+static size_t io_rle_encode(const unsigned char * src, size_t n,
+			    unsigned char * dst) {
+
+  size_t nout = 0;
+  size_t i = 0;
+  size_t nlit = 0;       /* length of pending literal run */
+  size_t ilit = 0;       /* start of pending literal run */
+
+  while (i < n) {
+
+    /* Length of repeat at position i */
+    size_t nrun = 1;
+    while (i + nrun < n && nrun < IO_COMPRESS_RUN_MAX
+	   && src[i + nrun] == src[i]) nrun += 1;
+
+    if (nrun >= IO_COMPRESS_RUN_MIN) {
+      /* Flush any literal, then the run */
+      if (nlit > 0) {
+	dst[nout++] = (unsigned char) (nlit - 1);
+	memcpy(dst + nout, src + ilit, nlit);
+	nout += nlit;
+	nlit = 0;
+      }
+      dst[nout++] = (unsigned char) (nrun + 126);
+      dst[nout++] = src[i];
+      i += nrun;
+    }
+    else {
+      if (nlit == 0) ilit = i;
+      nlit += 1;
+      i += 1;
+      if (nlit == IO_COMPRESS_LIT_MAX) {
+	dst[nout++] = (unsigned char) (nlit - 1);
+	memcpy(dst + nout, src + ilit, nlit);
+	nout += nlit;
+	nlit = 0;
+      }
+    }
+  }
+
+  if (nlit > 0) {
+    dst[nout++] = (unsigned char) (nlit - 1);
+    memcpy(dst + nout, src + ilit, nlit);
+    nout += nlit;
+  }
+
+  return nout;
+}
+
+/*****************************************************************************
+ *
+ *  io_rle_decode
+ *
+ *  Returns zero if exactly ndst bytes are decoded from n bytes.
+ *
+ *****************************************************************************/
+
+static int io_rle_decode(const unsigned char * src, size_t n,
+			 unsigned char * dst, size_t ndst) {
+
+  size_t i = 0;
+  size_t nout = 0;
+
+  while (i < n) {
+    size_t c = src[i++];
+    if (c < 128) {
+      size_t nlit = c + 1;
+      if (i + nlit > n || nout + nlit > ndst) return -1;
+      memcpy(dst + nout, src + i, nlit);
+      i += nlit;
+      nout += nlit;
+    }
+    else {
+      size_t nrun = c - 126;
+      if (i >= n || nout + nrun > ndst) return -1;
+      memset(dst + nout, src[i++], nrun);
+      nout += nrun;
+    }
+  }
+
+  return (nout == ndst) ? 0 : -1;
+}
@@ -0,0 +1,25 @@
+/*****************************************************************************
+ *
+ *  io_compress.h
+ *
+ *  Edinburgh Soft Matter and Statistical Physics Group and
+ *  Edinburgh Parallel Computing Centre
+ *
+ *  (c) 2024 The University of Edinburgh
+ *
+ *  Kevin Stratford (kevin@epcc.ed.ac.uk)
+ *
+ *****************************************************************************/
+
+#ifndef LUDWIG_IO_COMPRESS_H
+#define LUDWIG_IO_COMPRESS_H
+
+#include <stddef.h>
+
+size_t io_compress_bound(size_t nbytes);
+int io_compress(int level, size_t szelement, const char * src, size_t nsrc,
+		char * dst, size_t * ndst);
+int io_decompress(size_t szelement, const char * src, size_t nsrc,
+		  char * dst, size_t ndst);
+
+#endif
@@ -2,7 +2,8 @@
  *
  *  io_impl.c
  *
- *  A factory method to choose a real implementation.
+ *  A factory method to choose a real implementation, and the
+ *  double-buffered asynchronous write built on top of it.
  *
  *
  *  Edinburgh Soft Matter and Statistical Physics Group and
@@ -18,6 +19,7 @@
 
 #include "io_impl.h"
 #include "io_impl_mpio.h"
+#include "io_impl_node.h"
 
 int io_impl_create(const io_metadata_t * metadata, io_impl_t ** io) {
 
@@ -33,5 +35,127 @@ int io_impl_create(const io_metadata_t * metadata, io_impl_t ** io) {
     *io = (io_impl_t *) mpio;
   }
 
+  if (metadata->options.mode == IO_MODE_NODE) {
+    io_impl_node_t * node = NULL;
+    ifail = io_impl_node_create(metadata, &node);
+    *io = (io_impl_t *) node;
+  }
+
+  return ifail;
+}
+
+/*****************************************************************************
+ *
+ *  io_impl_async_buffer
+ *
+ *  Return the implementation (and so aggregator buffer) to be packed
+ *  for the next asynchronous write. It is created on first use and
+ *  retained thereafter. The buffer is never the one with a write
+ *  in progress.
+ *
+ *****************************************************************************/
+
+int io_impl_async_buffer(io_impl_async_t * async, const io_metadata_t * meta,
+			 io_impl_t ** io) {
+  int ifail = 0;
+
+  assert(async);
+  assert(meta);
+  assert(io);
+
+  if (async->io[async->ibuf] == NULL) {
+    ifail = io_impl_create(meta, &async->io[async->ibuf]);
+  }
+
+  *io = async->io[async->ibuf];
+
+  return ifail;
+}
+
+/*****************************************************************************
+ *
+ *  io_impl_async_write_begin
+ *
+ *  Complete any write still in progress, and start the write of the
+ *  current buffer to filename. Control returns without waiting for
+ *  the data to reach the file; completion is at the next call to
+ *  this function, io_impl_async_write_end(), or io_impl_async_free().
+ *
+ *  If the implementation has no asynchronous write, the write is
+ *  synchronous.
+ *
+ *****************************************************************************/
+
+int io_impl_async_write_begin(io_impl_async_t * async, const char * filename) {
+
+  int ifail = 0;
+  io_impl_t * io = NULL;
+
+  assert(async);
+  assert(filename);
+
+  io = async->io[async->ibuf];
+  assert(io);
+
+  io_impl_async_write_end(async);
+
+  if (io->impl->write_begin == NULL || io->impl->write_end == NULL) {
+    ifail = io->impl->write(io, filename);
+  }
+  else {
+    ifail = io->impl->write_begin(io, filename);
+    async->pending = 1;
+    async->ibuf = 1 - async->ibuf;
+  }
+
+  return ifail;
+}
+
+/*****************************************************************************
+ *
+ *  io_impl_async_write_end
+ *
+ *  Complete the write in progress, if there is one.
+ *
+ *****************************************************************************/
+
+int io_impl_async_write_end(io_impl_async_t * async) {
+
+  int ifail = 0;
+
+  assert(async);
+
+  if (async->pending) {
+    io_impl_t * io = async->io[1 - async->ibuf];
+    assert(io);
+    ifail = io->impl->write_end(io);
+    async->pending = 0;
+  }
+
+  return ifail;
+}
+
+/*****************************************************************************
+ *
+ *  io_impl_async_free
+ *
+ *  Complete any write in progress and release both buffers.
+ *
+ *****************************************************************************/
+
+int io_impl_async_free(io_impl_async_t * async) {
+
+  int ifail = 0;
+
+  assert(async);
+
+  ifail = io_impl_async_write_end(async);
+
+  for (int ib = 0; ib < 2; ib++) {
+    if (async->io[ib]) async->io[ib]->impl->free(&async->io[ib]);
+  }
+
+  *async = (io_impl_async_t) {0};
+
   return ifail;
 }
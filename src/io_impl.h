@@ -59,4 +59,21 @@ struct io_impl_s {
 
 int io_impl_create(const io_metadata_t * metadata, io_impl_t ** io);
 
+/* Asynchronous write with two persistent buffers: the next write may
+ * be packed while the previous one is still in progress. */
+
+typedef struct io_impl_async_s io_impl_async_t;
+
+struct io_impl_async_s {
+  io_impl_t * io[2];                    /* Two implementations (buffers) */
+  int ibuf;                             /* Buffer to use for next write */
+  int pending;                          /* Write in progress (other buffer) */
+};
+
+int io_impl_async_buffer(io_impl_async_t * async, const io_metadata_t * meta,
+			 io_impl_t ** io);
+int io_impl_async_write_begin(io_impl_async_t * async, const char * filename);
+int io_impl_async_write_end(io_impl_async_t * async);
+int io_impl_async_free(io_impl_async_t * async);
+
 #endif
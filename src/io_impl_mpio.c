@@ -9,6 +9,24 @@
  *  some phaff at each MPI_File_open() to retain the expected
  *  behaviour.
  *
+ *  If the compression level is non-zero, each rank's aggregated
+ *  buffer is compressed as a single block (see io_compress.c). The
+ *  file then has a header of int64_t values:
+ *
+ *    magic              IO_IMPL_MPIO_ZMAGIC
+ *    level              compression level used for the write
+ *    szshuffle          shuffle element size used by the codec
+ *    nblock             number of blocks (ranks in the communicator)
+ *    cartsz[3]          decomposition used for the write
+ *    nblock x {offset, compressed size, uncompressed size}
+ *
+ *  followed by the blocks. Offsets are relative to the end of the
+ *  header. Each rank can then read its own block independently.
+ *
+ *  On read, the file itself determines whether it is compressed, so
+ *  the current compression level is irrelevant. The decomposition
+ *  must, however, match that used to write a compressed file; a
+ *  mismatch is reported and the read fails.
  *
  *  Edinburgh Soft Matter and Statistical Physics Group and
  *  Edinburgh Parallel Computing Centre
@@ -21,6 +39,7 @@
 
 #include <assert.h>
 
+#include "io_compress.h"
 #include "io_impl_mpio.h"
 
 /* Function table */
@@ -32,7 +51,15 @@ static io_impl_vt_t vt_ = {
   (io_impl_write_end_ft)    io_impl_mpio_write_end
 };
 
+/* Compressed file header: first value, and number of leading values */
+#define IO_IMPL_MPIO_ZMAGIC   0x4c5544574947005aLL
+#define IO_IMPL_MPIO_NZHEADER 7
+
 static int io_impl_mpio_types_create(io_impl_mpio_t * io);
+static int io_impl_mpio_zwrite_header(io_impl_mpio_t * io);
+static int io_impl_mpio_zprobe(io_impl_mpio_t * io, int * compressed);
+static int io_impl_mpio_zread(io_impl_mpio_t * io);
+static int io_impl_mpio_ifail_all(MPI_Comm comm, int ifail);
 
 /*****************************************************************************
  *
@@ -105,6 +132,12 @@ int io_impl_mpio_initialise(const io_metadata_t * metadata,
   io->fh = MPI_FILE_NULL;
   io_impl_mpio_types_create(io);
 
+  if (ifail == 0 && metadata->options.compression_levl > 0) {
+    io->szzbuf = io_compress_bound(io->super.aggr->szbuf);
+    io->zbuf = (char *) malloc(io->szzbuf*sizeof(char));
+    if (io->zbuf == NULL) ifail = -1;
+  }
+
   return ifail;
 }
 
@@ -122,6 +155,7 @@ int io_impl_mpio_finalise(io_impl_mpio_t * io) {
   MPI_Type_free(&io->array);
   MPI_Type_free(&io->element);
   io_aggregator_free(&io->super.aggr);
+  free(io->zbuf);
 
   *io = (io_impl_mpio_t) {0};
 
@@ -197,6 +231,17 @@ int io_impl_mpio_write(io_impl_mpio_t * io, const char * filename) {
     /* Now the actual file ... */
     ifail = MPI_File_open(comm, filename, MPI_MODE_CREATE | MPI_MODE_WRONLY,
 		  info, &io->fh); if (ifail != MPI_SUCCESS) goto err;
+
+    if (io->metadata->options.compression_levl > 0) {
+      ifail = io_impl_mpio_zwrite_header(io);
+      if (ifail != MPI_SUCCESS) goto err;
+      ifail = MPI_File_write_all(io->fh, io->zbuf, (int) io->nzblock,
+				 MPI_BYTE, &io->status);
+      if (ifail != MPI_SUCCESS) goto err;
+      MPI_File_close(&io->fh);
+      return ifail;
+    }
+
     ifail = MPI_File_set_view(io->fh, disp, io->element, io->file, "native",
 			      info); if (ifail != MPI_SUCCESS) goto err;
     ifail = MPI_File_write_all(io->fh, io->super.aggr->buf, count, io->array,
@@ -231,8 +276,20 @@ int io_impl_mpio_read(io_impl_mpio_t * io, const char * filename) {
     MPI_Offset disp = 0;
     int count = 1;
 
+    int compressed = 0;
+
     ifail = MPI_File_open(comm, filename, MPI_MODE_RDONLY, info, &io->fh);
+    if (ifail != MPI_SUCCESS) return ifail;
+
+    ifail = io_impl_mpio_zprobe(io, &compressed);
     if (ifail != MPI_SUCCESS) goto err;
+
+    if (compressed) {
+      ifail = io_impl_mpio_zread(io);
+      MPI_File_close(&io->fh);
+      return ifail;
+    }
+
     ifail = MPI_File_set_view(io->fh, disp, io->element, io->file, "native",
 			      info);
     if (ifail != MPI_SUCCESS) goto err;
@@ -274,6 +331,18 @@ int io_impl_mpio_write_begin(io_impl_mpio_t * io, const char * filename) {
     MPI_File_open(comm, filename, MPI_MODE_CREATE | MPI_MODE_WRONLY,
 		  info, &io->fh);
 
+    if (io->metadata->options.compression_levl > 0) {
+      /* Header is written synchronously; the compressed block is not. */
+      int ifail = io_impl_mpio_zwrite_header(io);
+      if (ifail != MPI_SUCCESS) {
+	/* All ranks fail together; write_end then has nothing to do */
+	MPI_File_close(&io->fh);
+	return ifail;
+      }
+      MPI_File_write_all_begin(io->fh, io->zbuf, (int) io->nzblock, MPI_BYTE);
+      return 0;
+    }
+
     MPI_File_set_view(io->fh, disp, io->element, io->file, "native", info);
     MPI_File_write_all_begin(io->fh, io->super.aggr->buf, count, io->array);
   }
@@ -291,8 +360,277 @@ int io_impl_mpio_write_end(io_impl_mpio_t * io) {
 
   assert(io);
 
-  MPI_File_write_all_end(io->fh, io->super.aggr->buf, &io->status);
+  if (io->fh == MPI_FILE_NULL) return -1;
+
+  if (io->metadata->options.compression_levl > 0) {
+    MPI_File_write_all_end(io->fh, io->zbuf, &io->status);
+  }
+  else {
+    MPI_File_write_all_end(io->fh, io->super.aggr->buf, &io->status);
+  }
   MPI_File_close(&io->fh);
 
   return 0;
 }
+
+/*****************************************************************************
+ *
+ *  io_impl_mpio_szshuffle
+ *
+ *  Shuffle element size for the codec: level 1 is no shuffle.
+ *
+ *****************************************************************************/
+
+static size_t io_impl_mpio_szshuffle(const io_impl_mpio_t * io) {
+
+  size_t sz = io->metadata->element.datasize;
+
+  if (io->metadata->options.compression_levl == 1) sz = 1;
+
+  return sz;
+}
+
+/*****************************************************************************
+ *
+ *  io_impl_mpio_ifail_all
+ *
+ *  Combine a local error code across the communicator, so that
+ *  all ranks can take the same route through collective calls.
+ *  Returns zero only if all ranks have ifail = 0.
+ *
+ *****************************************************************************/
+
+static int io_impl_mpio_ifail_all(MPI_Comm comm, int ifail) {
+
+  int ilocal = (ifail != 0);
+  int iall = 0;
+
+  MPI_Allreduce(&ilocal, &iall, 1, MPI_INT, MPI_MAX, comm);
+
+  return (iall == 0) ? MPI_SUCCESS : -1;
+}
+
+/*****************************************************************************
+ *
+ *  io_impl_mpio_zwrite_header
+ *
+ *  Compress the local buffer, write the header (rank 0 in the file
+ *  communicator) and set the view ready for the compressed block
+ *  to be written (MPI_BYTE) by the caller.
+ *
+ *  If the compression fails on any rank, all ranks return an error.
+ *
+ *****************************************************************************/
+
+static int io_impl_mpio_zwrite_header(io_impl_mpio_t * io) {
+
+  int ifail = 0;
+  int rank = -1;
+  int nblock = 0;
+  int cartsz[3] = {0};
+  size_t nz = 0;
+  size_t szshuffle = io_impl_mpio_szshuffle(io);
+  MPI_Comm comm = io->metadata->comm;
+  MPI_Info info = MPI_INFO_NULL;
+
+  int64_t sizes[2] = {0};
+  int64_t * header = NULL;
+  int64_t * rsizes = NULL;
+
+  assert(io);
+  assert(io->zbuf);
+
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &nblock);
+  cs_cartsz(io->metadata->cs, cartsz);
+
+  ifail = io_compress(io->metadata->options.compression_levl, szshuffle,
+		      io->super.aggr->buf, io->super.aggr->szbuf,
+		      io->zbuf, &nz);
+  ifail = io_impl_mpio_ifail_all(comm, ifail);
+  if (ifail != MPI_SUCCESS) return ifail;
+
+  io->nzblock = nz;
+  sizes[0] = nz;
+  sizes[1] = io->super.aggr->szbuf;
+
+  header = (int64_t *) calloc(IO_IMPL_MPIO_NZHEADER + 3*nblock,
+			      sizeof(int64_t));
+  rsizes = (int64_t *) calloc(2*nblock, sizeof(int64_t));
+  assert(header);
+  assert(rsizes);
+  if (header == NULL || rsizes == NULL) MPI_Abort(comm, -1);
+
+  MPI_Allgather(sizes, 2, MPI_INT64_T, rsizes, 2, MPI_INT64_T, comm);
+
+  header[0] = IO_IMPL_MPIO_ZMAGIC;
+  header[1] = io->metadata->options.compression_levl;
+  header[2] = szshuffle;
+  header[3] = nblock;
+  header[4] = cartsz[X];
+  header[5] = cartsz[Y];
+  header[6] = cartsz[Z];
+
+  {
+    int64_t * block = header + IO_IMPL_MPIO_NZHEADER;
+    for (int ib = 0; ib < nblock; ib++) {
+      int64_t offset = (ib == 0) ? 0 : block[3*(ib-1)] + rsizes[2*(ib-1)];
+      block[3*ib] = offset;
+      block[3*ib + 1] = rsizes[2*ib];
+      block[3*ib + 2] = rsizes[2*ib + 1];
+    }
+  }
+
+  {
+    int nheader = IO_IMPL_MPIO_NZHEADER + 3*nblock;
+    int count = (rank == 0) ? nheader : 0;
+    MPI_Offset disp = nheader*sizeof(int64_t)
+      + header[IO_IMPL_MPIO_NZHEADER + 3*rank];
+
+    ifail = MPI_File_set_view(io->fh, 0, MPI_INT64_T, MPI_INT64_T, "native",
+			      info);
+    if (ifail == MPI_SUCCESS) {
+      ifail = MPI_File_write_all(io->fh, header, count, MPI_INT64_T,
+				 &io->status);
+    }
+    if (ifail == MPI_SUCCESS) {
+      ifail = MPI_File_set_view(io->fh, disp, MPI_BYTE, MPI_BYTE, "native",
+				info);
+    }
+  }
+
+  free(rsizes);
+  free(header);
+
+  return ifail;
+}
+
+/*****************************************************************************
+ *
+ *  io_impl_mpio_zprobe
+ *
+ *  Is the open file a compressed file? All ranks in the communicator
+ *  read the first value and compare with the magic number.
+ *
+ *****************************************************************************/
+
+static int io_impl_mpio_zprobe(io_impl_mpio_t * io, int * compressed) {
+
+  int ifail = 0;
+  int count = 0;
+  int64_t magic = 0;
+  MPI_Offset size = 0;
+
+  assert(io);
+  assert(compressed);
+
+  *compressed = 0;
+
+  ifail = MPI_File_get_size(io->fh, &size);
+  if (ifail != MPI_SUCCESS) return ifail;
+
+  count = (size >= (MPI_Offset) sizeof(int64_t));
+
+  ifail = MPI_File_set_view(io->fh, 0, MPI_INT64_T, MPI_INT64_T, "native",
+			    MPI_INFO_NULL);
+  if (ifail != MPI_SUCCESS) return ifail;
+  ifail = MPI_File_read_all(io->fh, &magic, count, MPI_INT64_T, &io->status);
+  if (ifail != MPI_SUCCESS) return ifail;
+
+  *compressed = (count == 1 && magic == IO_IMPL_MPIO_ZMAGIC);
+
+  return ifail;
+}
+
+/*****************************************************************************
+ *
+ *  io_impl_mpio_zread
+ *
+ *  Read header and then local compressed block from open file.
+ *  The decomposition must match that used to write the file.
+ *  The codec (shuffle) is taken from the file, and the compressed
+ *  buffer is allocated if the current options did not require it.
+ *
+ *  All ranks return the same result.
+ *
+ *****************************************************************************/
+
+static int io_impl_mpio_zread(io_impl_mpio_t * io) {
+
+  int ifail = 0;
+  int rank = -1;
+  int nblock = 0;
+  int cartsz[3] = {0};
+  int64_t hdr[IO_IMPL_MPIO_NZHEADER] = {0};
+  int64_t index[3] = {0};
+  int64_t * all = NULL;
+  pe_t * pe = io->metadata->cs->pe;
+  MPI_Comm comm = io->metadata->comm;
+  MPI_Info info = MPI_INFO_NULL;
+
+  assert(io);
+
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &nblock);
+  cs_cartsz(io->metadata->cs, cartsz);
+
+  ifail = MPI_File_set_view(io->fh, 0, MPI_INT64_T, MPI_INT64_T, "native",
+			    info);
+  if (ifail != MPI_SUCCESS) return ifail;
+  ifail = MPI_File_read_all(io->fh, hdr, IO_IMPL_MPIO_NZHEADER, MPI_INT64_T,
+			    &io->status);
+  if (ifail != MPI_SUCCESS) return ifail;
+
+  /* The header is the same for all ranks, so this is consistent */
+
+  if (hdr[3] != nblock || hdr[4] != cartsz[X] || hdr[5] != cartsz[Y]
+      || hdr[6] != cartsz[Z]) {
+    pe_info(pe, "Compressed file was written with decomposition "
+	    "%ld %ld %ld (%ld blocks)\n", (long) hdr[4], (long) hdr[5],
+	    (long) hdr[6], (long) hdr[3]);
+    pe_info(pe, "Current decomposition is %d %d %d (%d blocks)\n",
+	    cartsz[X], cartsz[Y], cartsz[Z], nblock);
+    pe_info(pe, "Compressed files must be read with the same decomposition\n");
+    return -1;
+  }
+
+  if (io->zbuf == NULL) {
+    io->szzbuf = io_compress_bound(io->super.aggr->szbuf);
+    io->zbuf = (char *) malloc(io->szzbuf*sizeof(char));
+  }
+
+  all = (int64_t *) calloc(3*nblock, sizeof(int64_t));
+  assert(all);
+  if (all == NULL || io->zbuf == NULL) MPI_Abort(comm, -1);
+
+  ifail = MPI_File_read_all(io->fh, all, 3*nblock, MPI_INT64_T, &io->status);
+
+  if (ifail == MPI_SUCCESS) {
+    index[0] = all[3*rank];
+    index[1] = all[3*rank + 1];
+    index[2] = all[3*rank + 2];
+    if (index[1] > (int64_t) io->szzbuf) ifail = -1;
+    if (index[2] != (int64_t) io->super.aggr->szbuf) ifail = -1;
+  }
+  free(all);
+
+  ifail = io_impl_mpio_ifail_all(comm, ifail);
+
+  if (ifail == MPI_SUCCESS) {
+    MPI_Offset disp = (IO_IMPL_MPIO_NZHEADER + 3*nblock)*sizeof(int64_t)
+      + index[0];
+    ifail = MPI_File_set_view(io->fh, disp, MPI_BYTE, MPI_BYTE, "native",
+			      info);
+  }
+  if (ifail == MPI_SUCCESS) {
+    ifail = MPI_File_read_all(io->fh, io->zbuf, (int) index[1], MPI_BYTE,
+			      &io->status);
+  }
+  if (ifail == MPI_SUCCESS) {
+    ifail = io_decompress(hdr[2], io->zbuf, index[1], io->super.aggr->buf,
+			  io->super.aggr->szbuf);
+    ifail = io_impl_mpio_ifail_all(comm, ifail);
+  }
+
+  return ifail;
+}
@@ -14,6 +14,8 @@
 #ifndef LUDWIG_IO_IMPL_MPIO_H
 #define LUDWIG_IO_IMPL_MPIO_H
 
+#include <stdint.h>
+
 #include "io_impl.h"
 #include "io_metadata.h"
 
@@ -29,6 +31,11 @@ struct io_impl_mpio_s {
   MPI_Datatype element;                  /* element type */
   MPI_Datatype array;                    /* subarray type */
   MPI_Datatype file;                     /* file type */
+
+  /* Compressed blocks (if compression_levl > 0) */
+  char * zbuf;                           /* compressed block */
+  size_t szzbuf;                         /* size of zbuf (bytes) */
+  int64_t nzblock;                       /* actual compressed size */
 };
 
 int io_impl_mpio_create(const io_metadata_t * meta, io_impl_mpio_t ** io);
@@ -0,0 +1,438 @@
+/*****************************************************************************
+ *
+ *  io_impl_node.c
+ *
+ *  Two-level i/o: ranks in the file communicator are grouped (one
+ *  group per shared memory node by default, or groups of a fixed
+ *  number of ranks via io_options_t iogroup). The aggregated buffers
+ *  of each group are gathered to one writer, which rearranges them
+ *  into file order and issues a small number of large contiguous
+ *  independent writes via MPI_File_write_at(). Reads are the reverse.
+ *
+ *  The file format is identical to that of io_impl_mpio.c, so files
+ *  may be written with one implementation and read with the other.
+ *
+ *  This avoids the collective buffering of MPI_File_write_all(),
+ *  which can be expensive at large rank counts on parallel file
+ *  systems. There is no asynchronous write, and compression is not
+ *  supported here (the metadata always records compression level 0;
+ *  see io_metadata_initialise()).
+ *
+ *  Edinburgh Soft Matter and Statistical Physics Group and
+ *  Edinburgh Parallel Computing Centre
+ *
+ *  (c) 2024 The University of Edinburgh
+ *
+ *  Kevin Stratford (kevin@epcc.ed.ac.uk)
+ *
+ *****************************************************************************/
+
+#include <assert.h>
+#include <limits.h>
+#include <string.h>
+
+#include "io_impl_node.h"
+
+/* Function table */
+static io_impl_vt_t vt_ = {
+  (io_impl_free_ft)         io_impl_node_free,
+  (io_impl_read_ft)         io_impl_node_read,
+  (io_impl_write_ft)        io_impl_node_write,
+  (io_impl_write_begin_ft)  NULL,
+  (io_impl_write_end_ft)    NULL
+};
+
+/* Largest single write/read (bytes) */
+#define IO_IMPL_NODE_CHUNK_MAX (1 << 30)
+
+static int io_impl_node_runs_create(io_impl_node_t * io, const int * info);
+static int io_impl_node_open(io_impl_node_t * io, const char * filename,
+			     int amode);
+static int io_line_compare(const void * a, const void * b);
+
+/*****************************************************************************
+ *
+ *  io_impl_node_create
+ *
+ *****************************************************************************/
+
+int io_impl_node_create(const io_metadata_t * metadata,
+			io_impl_node_t ** io) {
+
+  int ifail = 0;
+  io_impl_node_t * node = NULL;
+
+  node = (io_impl_node_t *) calloc(1, sizeof(io_impl_node_t));
+  if (node == NULL) goto err;
+
+  ifail = io_impl_node_initialise(metadata, node);
+  if (ifail != 0) goto err;
+
+  *io = node;
+
+  return 0;
+
+ err:
+  if (node) free(node);
+
+  return -1;
+}
+
+/*****************************************************************************
+ *
+ *  io_impl_node_free
+ *
+ *****************************************************************************/
+
+int io_impl_node_free(io_impl_node_t ** io) {
+
+  assert(io);
+  assert(*io);
+
+  io_impl_node_finalise(*io);
+  free(*io);
+  *io = NULL;
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  io_impl_node_initialise
+ *
+ *  Collective in metadata->node. Each member sends its position and
+ *  size in the file to the writer, which computes the file layout.
+ *
+ *****************************************************************************/
+
+int io_impl_node_initialise(const io_metadata_t * metadata,
+			    io_impl_node_t * io) {
+  int ifail = 0;
+  int noderank = -1;
+  int info[7] = {0};
+  int * allinfo = NULL;
+
+  assert(metadata);
+  assert(io);
+  assert(metadata->options.mode == IO_MODE_NODE);
+
+  *io = (io_impl_node_t) {0};
+
+  io->super.impl = &vt_;
+  ifail = io_aggregator_create(metadata->element, metadata->limits,
+			       &io->super.aggr);
+  io->metadata = metadata;
+  io->fh = MPI_FILE_NULL;
+  if (ifail != 0) return ifail;
+
+  MPI_Comm_rank(metadata->node, &noderank);
+  MPI_Comm_size(metadata->node, &io->nmember);
+
+  {
+    /* Offset in the file, local size, and size in bytes */
+    const io_subfile_t * subfile = &metadata->subfile;
+    int nlocal[3] = {0};
+    int offset[3] = {0};
+    cs_nlocal(metadata->cs, nlocal);
+    cs_nlocal_offset(metadata->cs, offset);
+
+    assert(io->super.aggr->szbuf <= INT_MAX);
+
+    info[0] = offset[X] - subfile->offset[X];
+    info[1] = offset[Y] - subfile->offset[Y];
+    info[2] = offset[Z] - subfile->offset[Z];
+    info[3] = nlocal[X];
+    info[4] = nlocal[Y];
+    info[5] = nlocal[Z];
+    info[6] = io->super.aggr->szbuf;
+  }
+
+  if (noderank == 0) {
+    allinfo = (int *) calloc(7*io->nmember, sizeof(int));
+    assert(allinfo);
+    if (allinfo == NULL) MPI_Abort(metadata->node, -1);
+  }
+
+  MPI_Gather(info, 7, MPI_INT, allinfo, 7, MPI_INT, 0, metadata->node);
+
+  if (noderank == 0) {
+    ifail = io_impl_node_runs_create(io, allinfo);
+    free(allinfo);
+  }
+
+  return ifail;
+}
+
+/*****************************************************************************
+ *
+ *  io_impl_node_finalise
+ *
+ *****************************************************************************/
+
+int io_impl_node_finalise(io_impl_node_t * io) {
+
+  assert(io);
+
+  free(io->runs);
+  free(io->lines);
+  free(io->fbuf);
+  free(io->gbuf);
+  free(io->displs);
+  free(io->counts);
+  io_aggregator_free(&io->super.aggr);
+
+  *io = (io_impl_node_t) {0};
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  io_impl_node_runs_create
+ *
+ *  Writer only. Each member buffer is a set of contiguous lines in
+ *  z (C order, no halo) which appear at known offsets in the file.
+ *  Sort the lines into file order, and merge lines which are
+ *  adjacent in the file to form the runs actually written.
+ *
+ *****************************************************************************/
+
+static int io_impl_node_runs_create(io_impl_node_t * io, const int * info) {
+
+  const io_subfile_t * subfile = &io->metadata->subfile;
+  size_t szel = io->super.aggr->szelement;
+  size_t sztotal = 0;
+  int64_t * sort = NULL;
+
+  assert(io);
+  assert(info);
+
+  io->counts = (int *) calloc(io->nmember, sizeof(int));
+  io->displs = (int *) calloc(io->nmember, sizeof(int));
+  if (io->counts == NULL || io->displs == NULL) return -1;
+
+  io->nline = 0;
+  for (int m = 0; m < io->nmember; m++) {
+    io->counts[m] = info[7*m + 6];
+    io->displs[m] = sztotal;
+    sztotal += io->counts[m];
+    io->nline += info[7*m + 3]*info[7*m + 4];
+    assert(sztotal <= INT_MAX);
+  }
+
+  io->gbuf = (char *) malloc(sztotal*sizeof(char));
+  io->fbuf = (char *) malloc(sztotal*sizeof(char));
+  sort = (int64_t *) calloc(3*io->nline, sizeof(int64_t));
+  if (io->gbuf == NULL || io->fbuf == NULL || sort == NULL) {
+    free(sort);
+    return -1;
+  }
+
+  /* {file offset, gbuf offset, length} for each line */
+  {
+    int il = 0;
+    for (int m = 0; m < io->nmember; m++) {
+      const int * s = info + 7*m;        /* starts, */
+      const int * n = info + 7*m + 3;    /* and sizes */
+      for (int ic = 0; ic < n[X]; ic++) {
+	for (int jc = 0; jc < n[Y]; jc++) {
+	  int64_t ifile = ((int64_t) (s[X] + ic)*subfile->sizes[Y]
+			   + (s[Y] + jc))*subfile->sizes[Z] + s[Z];
+	  int64_t ibuf = (int64_t) (ic*n[Y] + jc)*n[Z];
+	  sort[3*il + 0] = ifile*szel;
+	  sort[3*il + 1] = io->displs[m] + ibuf*szel;
+	  sort[3*il + 2] = n[Z]*szel;
+	  il += 1;
+	}
+      }
+    }
+    assert(il == io->nline);
+  }
+
+  qsort(sort, io->nline, 3*sizeof(int64_t), io_line_compare);
+
+  io->lines = (int64_t *) calloc(2*io->nline, sizeof(int64_t));
+  io->runs  = (int64_t *) calloc(2*io->nline, sizeof(int64_t));
+  if (io->lines == NULL || io->runs == NULL) {
+    free(sort);
+    return -1;
+  }
+
+  io->nrun = 0;
+  for (int il = 0; il < io->nline; il++) {
+    int64_t ifile = sort[3*il + 0];
+    io->lines[2*il + 0] = sort[3*il + 1];
+    io->lines[2*il + 1] = sort[3*il + 2];
+    if (io->nrun > 0 &&
+	io->runs[2*(io->nrun-1)] + io->runs[2*(io->nrun-1) + 1] == ifile) {
+      io->runs[2*(io->nrun-1) + 1] += sort[3*il + 2];
+    }
+    else {
+      io->runs[2*io->nrun + 0] = ifile;
+      io->runs[2*io->nrun + 1] = sort[3*il + 2];
+      io->nrun += 1;
+    }
+  }
+
+  free(sort);
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  io_impl_node_write
+ *
+ *****************************************************************************/
+
+int io_impl_node_write(io_impl_node_t * io, const char * filename) {
+
+  int ifail = 0;
+  int noderank = -1;
+  const io_metadata_t * meta = NULL;
+
+  assert(io);
+  assert(filename);
+
+  meta = io->metadata;
+  MPI_Comm_rank(meta->node, &noderank);
+
+  MPI_Gatherv(io->super.aggr->buf, io->super.aggr->szbuf, MPI_BYTE,
+	      io->gbuf, io->counts, io->displs, MPI_BYTE, 0, meta->node);
+
+  if (noderank == 0) {
+
+    /* Rearrange to file order */
+    size_t ib = 0;
+    for (int il = 0; il < io->nline; il++) {
+      memcpy(io->fbuf + ib, io->gbuf + io->lines[2*il], io->lines[2*il + 1]);
+      ib += io->lines[2*il + 1];
+    }
+
+    ifail = io_impl_node_open(io, filename, MPI_MODE_CREATE|MPI_MODE_WRONLY);
+
+    if (ifail == MPI_SUCCESS) {
+      ib = 0;
+      for (int ir = 0; ir < io->nrun; ir++) {
+	int64_t nb = io->runs[2*ir + 1];
+	for (int64_t nw = 0; nw < nb; nw += IO_IMPL_NODE_CHUNK_MAX) {
+	  int count = (nb - nw < IO_IMPL_NODE_CHUNK_MAX)
+	    ? nb - nw : IO_IMPL_NODE_CHUNK_MAX;
+	  int ierr = MPI_File_write_at(io->fh, io->runs[2*ir] + nw,
+				       io->fbuf + ib + nw, count, MPI_BYTE,
+				       &io->status);
+	  if (ierr != MPI_SUCCESS) ifail = ierr;
+	}
+	ib += nb;
+      }
+      MPI_File_close(&io->fh);
+    }
+  }
+
+  MPI_Bcast(&ifail, 1, MPI_INT, 0, meta->node);
+
+  return ifail;
+}
+
+/*****************************************************************************
+ *
+ *  io_impl_node_read
+ *
+ *****************************************************************************/
+
+int io_impl_node_read(io_impl_node_t * io, const char * filename) {
+
+  int ifail = 0;
+  int noderank = -1;
+  const io_metadata_t * meta = NULL;
+
+  assert(io);
+  assert(filename);
+
+  meta = io->metadata;
+  MPI_Comm_rank(meta->node, &noderank);
+
+  if (noderank == 0) {
+
+    ifail = io_impl_node_open(io, filename, MPI_MODE_RDONLY);
+
+    if (ifail == MPI_SUCCESS) {
+      size_t ib = 0;
+      for (int ir = 0; ir < io->nrun; ir++) {
+	int64_t nb = io->runs[2*ir + 1];
+	for (int64_t nr = 0; nr < nb; nr += IO_IMPL_NODE_CHUNK_MAX) {
+	  int count = (nb - nr < IO_IMPL_NODE_CHUNK_MAX)
+	    ? nb - nr : IO_IMPL_NODE_CHUNK_MAX;
+	  int ierr = MPI_File_read_at(io->fh, io->runs[2*ir] + nr,
+				      io->fbuf + ib + nr, count, MPI_BYTE,
+				      &io->status);
+	  if (ierr != MPI_SUCCESS) ifail = ierr;
+	}
+	ib += nb;
+      }
+      MPI_File_close(&io->fh);
+
+      /* File order back to member order */
+      ib = 0;
+      for (int il = 0; il < io->nline; il++) {
+	memcpy(io->gbuf + io->lines[2*il], io->fbuf + ib, io->lines[2*il + 1]);
+	ib += io->lines[2*il + 1];
+      }
+    }
+  }
+
+  MPI_Bcast(&ifail, 1, MPI_INT, 0, meta->node);
+
+  if (ifail == MPI_SUCCESS) {
+    MPI_Scatterv(io->gbuf, io->counts, io->displs, MPI_BYTE,
+		 io->super.aggr->buf, io->super.aggr->szbuf, MPI_BYTE, 0,
+		 meta->node);
+  }
+
+  return ifail;
+}
+
+/*****************************************************************************
+ *
+ *  io_impl_node_open
+ *
+ *  Writers only. For writing, any existing file is removed first
+ *  (cf. io_impl_mpio.c).
+ *
+ *****************************************************************************/
+
+static int io_impl_node_open(io_impl_node_t * io, const char * filename,
+			     int amode) {
+  int ifail = 0;
+  MPI_Comm comm = io->metadata->writers;
+  MPI_Info info = MPI_INFO_NULL;
+
+  assert(comm != MPI_COMM_NULL);
+
+  if (amode & MPI_MODE_WRONLY) {
+    MPI_File_open(comm, filename,
+		  MPI_MODE_CREATE | MPI_MODE_DELETE_ON_CLOSE | MPI_MODE_WRONLY,
+		  info, &io->fh);
+    MPI_File_close(&io->fh);
+  }
+
+  ifail = MPI_File_open(comm, filename, amode, info, &io->fh);
+
+  return ifail;
+}
+
+/*****************************************************************************
+ *
+ *  io_line_compare
+ *
+ *  Order {file offset, ...} by file offset for qsort().
+ *
+ *****************************************************************************/
+
+static int io_line_compare(const void * a, const void * b) {
+
+  int64_t ia = ((const int64_t *) a)[0];
+  int64_t ib = ((const int64_t *) b)[0];
+
+  return (ia > ib) - (ia < ib);
+}
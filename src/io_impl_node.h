@@ -0,0 +1,51 @@
+/*****************************************************************************
+ *
+ *  io_impl_node.h
+ *
+ *  Edinburgh Soft Matter and Statistical Physics Group and
+ *  Edinburgh Parallel Computing Centre
+ *
+ *  (c) 2024 The University of Edinburgh
+ *
+ *  Kevin Stratford (kevin@epcc.ed.ac.uk)
+ *
+ *****************************************************************************/
+
+#ifndef LUDWIG_IO_IMPL_NODE_H
+#define LUDWIG_IO_IMPL_NODE_H
+
+#include <stdint.h>
+
+#include "io_impl.h"
+#include "io_metadata.h"
+
+typedef struct io_impl_node_s io_impl_node_t;
+
+struct io_impl_node_s {
+  io_impl_t super;                       /* superclass block */
+  const io_metadata_t * metadata;        /* options, element type, ... */
+
+  /* Node implementation state (writer rank only) */
+  MPI_File fh;                           /* file handle (writers) */
+  MPI_Status status;                     /* last status */
+  int nmember;                           /* ranks in node group */
+  int * counts;                          /* bytes per member */
+  int * displs;                          /* displacements in gbuf */
+  char * gbuf;                           /* member buffers as gathered */
+  char * fbuf;                           /* the same in file order */
+  int nline;                             /* z-lines (all members) */
+  int64_t * lines;                       /* {gbuf offset, length} */
+  int nrun;                              /* contiguous runs in file */
+  int64_t * runs;                        /* {file offset, length} */
+};
+
+int io_impl_node_create(const io_metadata_t * meta, io_impl_node_t ** io);
+int io_impl_node_free(io_impl_node_t ** io);
+
+int io_impl_node_initialise(const io_metadata_t * meta, io_impl_node_t * io);
+int io_impl_node_finalise(io_impl_node_t * io);
+
+int io_impl_node_write(io_impl_node_t * io, const char * filename);
+int io_impl_node_read(io_impl_node_t * io, const char * filename);
+
+#endif
@@ -114,6 +114,11 @@ int io_metadata_initialise(cs_t * cs,
   meta->options = *options;
   meta->element = *element;
 
+  /* Compression is not implemented for IO_MODE_NODE, so the level
+   * must be recorded as zero to describe the file correctly. */
+
+  if (options->mode == IO_MODE_NODE) meta->options.compression_levl = 0;
+
   {
     /* Must have a decomposition... */
     int ifail = io_subfile_create(cs, options->iogrid, &meta->subfile);
@@ -128,6 +133,29 @@ int io_metadata_initialise(cs_t * cs,
     MPI_Comm_split(meta->parent, meta->subfile.index, rank, &meta->comm);
   }
 
+  /* For IO_MODE_NODE, ranks in the file communicator are grouped
+   * either per shared memory node, or in groups of options->iogroup
+   * consecutive ranks. Rank 0 in each group is the writer. */
+
+  meta->node = MPI_COMM_NULL;
+  meta->writers = MPI_COMM_NULL;
+
+  if (options->mode == IO_MODE_NODE) {
+    int rank = -1;
+    int noderank = -1;
+    MPI_Comm_rank(meta->comm, &rank);
+    if (options->iogroup > 0) {
+      MPI_Comm_split(meta->comm, rank/options->iogroup, rank, &meta->node);
+    }
+    else {
+      MPI_Comm_split_type(meta->comm, MPI_COMM_TYPE_SHARED, rank,
+			  MPI_INFO_NULL, &meta->node);
+    }
+    MPI_Comm_rank(meta->node, &noderank);
+    MPI_Comm_split(meta->comm, (noderank == 0) ? 0 : MPI_UNDEFINED, rank,
+		   &meta->writers);
+  }
+
   return 0;
 }
 
@@ -141,6 +169,10 @@ int io_metadata_finalise(io_metadata_t * meta) {
 
   assert(meta);
 
+  if (meta->options.mode == IO_MODE_NODE) {
+    if (meta->writers != MPI_COMM_NULL) MPI_Comm_free(&meta->writers);
+    if (meta->node != MPI_COMM_NULL) MPI_Comm_free(&meta->node);
+  }
   if (meta->comm) MPI_Comm_free(&meta->comm);
   *meta = (io_metadata_t) {0};
   meta->comm = MPI_COMM_NULL;
@@ -30,6 +30,8 @@ struct io_metadata_s {
   cs_limits_t limits;                /* Always local size with no halo */
   MPI_Comm parent;                   /* Cartesian communicator */
   MPI_Comm comm;                     /* Cartesian sub-communicator */
+  MPI_Comm node;                     /* Ranks sharing a writer (node) */
+  MPI_Comm writers;                  /* Writers only (node) */
   int iswriten;                      /* updated to true if file is written */
 
   io_options_t options;
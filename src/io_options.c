@@ -30,6 +30,7 @@
 #define IO_REPORT_DEFAULT()           0
 #define IO_ASYNCHRONOUS_DEFAULT()     0
 #define IO_COMPRESSION_LEVL_DEFAULT() 0
+#define IO_GROUP_DEFAULT()            0
 #define IO_GRID_DEFAULT()             {1, 1, 1}
 #define IO_OPTIONS_DEFAULT()         {IO_MODE_DEFAULT(), \
                                       IO_RECORD_FORMAT_DEFAULT(), \
@@ -37,6 +38,7 @@
                                       IO_REPORT_DEFAULT(), \
                                       IO_ASYNCHRONOUS_DEFAULT(),     \
                                       IO_COMPRESSION_LEVL_DEFAULT(), \
+                                      IO_GROUP_DEFAULT(),            \
                                       IO_GRID_DEFAULT()}
 
 /*****************************************************************************
@@ -119,6 +121,7 @@ __host__ int io_options_mode_valid(io_mode_enum_t mode) {
   int valid = 0;
 
   valid += (mode == IO_MODE_MPIIO);
+  valid += (mode == IO_MODE_NODE);
 
   return valid;
 }
@@ -159,7 +162,7 @@ __host__ int io_options_metadata_version_valid(const io_options_t * options) {
   /* Should be consistent with mode */
 
   if (options->metadata_version == IO_METADATA_V2) {
-    valid = (options->mode == IO_MODE_MPIIO);
+    valid = (options->mode == IO_MODE_MPIIO || options->mode == IO_MODE_NODE);
   }
 
   return valid;
@@ -177,13 +180,14 @@ __host__ io_options_t io_options_with_mode(io_mode_enum_t mode) {
 
   io_options_t options = io_options_default();
 
-  if (mode == IO_MODE_MPIIO) {
-    options.mode             = IO_MODE_MPIIO;
+  if (mode == IO_MODE_MPIIO || mode == IO_MODE_NODE) {
+    options.mode             = mode;
     options.iorformat        = IO_RECORD_BINARY;
     options.metadata_version = IO_METADATA_V2;
     options.report           = 1;
     options.asynchronous     = 0;
     options.compression_levl = 0;
+    options.iogroup          = 0;
   }
   else {
     /* User error ... */
@@ -245,6 +249,7 @@ __host__ const char * io_mode_to_string(io_mode_enum_t mode) {
   str = "invalid";
 
   if (mode == IO_MODE_MPIIO) str = "mpiio";
+  if (mode == IO_MODE_NODE)  str = "node";
 
   return str;
 }
@@ -266,6 +271,7 @@ __host__ io_mode_enum_t io_mode_from_string(const char * str) {
   util_str_tolower(value, strlen(value));
 
   if (strcmp(value, "mpiio")    == 0) mode = IO_MODE_MPIIO;
+  if (strcmp(value, "node")     == 0) mode = IO_MODE_NODE;
 
   return mode;
 }
@@ -331,7 +337,7 @@ __host__ int io_options_to_json(const io_options_t * opts, cJSON ** json) {
   }
   else {
 
-    /* Seven key/value pairs */
+    /* Eight key/value pairs */
     cJSON * myjson = cJSON_CreateObject();
     cJSON * iogrid = cJSON_CreateIntArray(opts->iogrid, 3);
 
@@ -344,6 +350,7 @@ __host__ int io_options_to_json(const io_options_t * opts, cJSON ** json) {
     cJSON_AddBoolToObject(myjson, "Asynchronous", opts->asynchronous);
     cJSON_AddNumberToObject(myjson, "Compression level",
 			    opts->compression_levl);
+    cJSON_AddNumberToObject(myjson, "I/O group", opts->iogroup);
     cJSON_AddItemToObject(myjson, "I/O grid", iogrid);
 
     *json = myjson;
@@ -374,6 +381,7 @@ __host__ int io_options_from_json(const cJSON * json, io_options_t * opts) {
     cJSON * async = cJSON_GetObjectItemCaseSensitive(json, "Asynchronous");
     cJSON * level= cJSON_GetObjectItemCaseSensitive(json, "Compression level");
     cJSON * iogrid = cJSON_GetObjectItemCaseSensitive(json, "I/O grid");
+    cJSON * group  = cJSON_GetObjectItemCaseSensitive(json, "I/O group");
 
     if (mode) {
       char * str = cJSON_GetStringValue(mode);
@@ -391,6 +399,7 @@ __host__ int io_options_from_json(const cJSON * json, io_options_t * opts) {
     if (report) opts->report = cJSON_IsTrue(report);
     if (async)  opts->asynchronous = cJSON_IsTrue(async);
     if (level)  opts->compression_levl = cJSON_GetNumberValue(level);
+    if (group)  opts->iogroup = cJSON_GetNumberValue(group);
 
     /* Errors */
     if (mode   == NULL) ifail += 1;
@@ -400,6 +409,7 @@ __host__ int io_options_from_json(const cJSON * json, io_options_t * opts) {
     if (async  == NULL) ifail += 16;
     if (level  == NULL) ifail += 32;
     if (3 != util_json_to_int_array(iogrid, opts->iogrid, 3)) ifail += 64;
+    /* "I/O group" is optional (absent in earlier files) */
   }
 
   return ifail;
@@ -25,9 +25,10 @@
  *  I/O Modes:
  *
  *  IO_MODE_MPIO       MPIO-IO implementation
+ *  IO_MODE_NODE       Two-level: gather to one writer per node (or group)
  */
 
-enum io_mode_enum {IO_MODE_INVALID, IO_MODE_MPIIO};
+enum io_mode_enum {IO_MODE_INVALID, IO_MODE_MPIIO, IO_MODE_NODE};
 
 /* Record formats: */
 
@@ -55,6 +56,7 @@ struct io_options_s {
   int                        report;           /* Switch reporting on/off */
   int                        asynchronous;     /* Asynchronous i/o */
   int                        compression_levl; /* Compression 0-9 */
+  int                        iogroup;          /* Ranks per writer (node) */
   int                        iogrid[3];        /* i/o decomposition */
 };
 
@@ -30,6 +30,9 @@
  *    default_io_mode
  *    default_io_format
  *    default_io_report
+ *    default_io_asynchronous
+ *    default_io_compression
+ *    default_io_group
  *
  *  The options returned are defaults, or valid user input.
  *
@@ -63,6 +66,20 @@ __host__ int io_options_rt(rt_t * rt, rt_enum_t lv, const char * keystub,
   sprintf(key, "%s_io_report", keystub);
   io_options_rt_report(rt, lv, key, &options->report);
 
+  sprintf(key, "%s_io_asynchronous", keystub);
+  io_options_rt_asynchronous(rt, lv, key, &options->asynchronous);
+
+  sprintf(key, "%s_io_compression", keystub);
+  io_options_rt_compression(rt, lv, key, &options->compression_levl);
+
+  if (options->mode == IO_MODE_NODE && options->compression_levl > 0) {
+    rt_vinfo(rt, lv, "%s is not available with io_mode node\n", key);
+    rt_vinfo(rt, lv, "Output for %s will not be compressed\n", keystub);
+  }
+
+  sprintf(key, "%s_io_group", keystub);
+  io_options_rt_group(rt, lv, key, &options->iogroup);
+
   return 0;
 }
 
@@ -98,7 +115,7 @@ __host__ int io_options_rt_mode(rt_t * rt, rt_enum_t lv, const char * key,
       rt_vinfo(rt, lv, "I/O mode key present but value not recognised\n");
       rt_vinfo(rt, lv, "key:   %s\n", key);
       rt_vinfo(rt, lv, "value: %s\n", value);
-      rt_vinfo(rt, lv, "Should be either 'single', 'multiple' or 'mpiio'\n");
+      rt_vinfo(rt, lv, "Should be either 'mpiio' or 'node'\n");
       rt_fatal(rt, lv, "Please check the input file and try again!\n");
       ifail = RT_KEY_INVALID;
     }
@@ -175,3 +192,109 @@ __host__ int io_options_rt_report(rt_t * rt, rt_enum_t lv, const char * key,
 
   return ifail;
 }
+
+/*****************************************************************************
+ *
+ *  io_options_rt_asynchronous
+ *
+ *  Update asynchronous if the switch "key" is present.
+ *  Return RT_KEY_OK or RT_KEY_MISSING.
+ *
+ *****************************************************************************/
+
+__host__ int io_options_rt_asynchronous(rt_t * rt, rt_enum_t lv,
+					const char * key, int * asynchronous) {
+
+  int ifail = RT_KEY_MISSING;
+
+  assert(rt);
+  assert(key);
+  assert(asynchronous);
+
+  if (rt_key_present(rt, key)) {
+    ifail = RT_KEY_OK;
+    *asynchronous = rt_switch(rt, key);
+  }
+
+  return ifail;
+}
+
+/*****************************************************************************
+ *
+ *  io_options_rt_compression
+ *
+ *  Compression level is an integer 0-9 (0 is no compression).
+ *  Only the MPI-IO implementation acts on a non-zero level.
+ *
+ *  The level affects output only: on input, a compressed file is
+ *  recognised from its header. A compressed file must be read with
+ *  the same decomposition as was used to write it.
+ *
+ *****************************************************************************/
+
+__host__ int io_options_rt_compression(rt_t * rt, rt_enum_t lv,
+				       const char * key, int * level) {
+
+  int ifail = RT_KEY_MISSING;
+  int ival = 0;
+
+  assert(rt);
+  assert(key);
+  assert(level);
+
+  if (rt_int_parameter(rt, key, &ival)) {
+    if (0 <= ival && ival <= 9) {
+      ifail = RT_KEY_OK;
+      *level = ival;
+    }
+    else {
+      ifail = RT_KEY_INVALID;
+      rt_vinfo(rt, lv, "I/O compression level present but out of range\n");
+      rt_vinfo(rt, lv, "key:   %s\n", key);
+      rt_vinfo(rt, lv, "value: %d\n", ival);
+      rt_vinfo(rt, lv, "Should be an integer in the range 0-9\n");
+      rt_vinfo(rt, lv, "(0 is no compression; compressed files must be "
+	       "read using the\nsame decomposition as was used to "
+	       "write them)\n");
+      rt_fatal(rt, lv, "Please check the input file and try again!\n");
+    }
+  }
+
+  return ifail;
+}
+
+/*****************************************************************************
+ *
+ *  io_options_rt_group
+ *
+ *  Number of ranks per writer for mode "node". Zero (the default)
+ *  means one writer per shared memory node.
+ *
+ *****************************************************************************/
+
+__host__ int io_options_rt_group(rt_t * rt, rt_enum_t lv, const char * key,
+				 int * iogroup) {
+
+  int ifail = RT_KEY_MISSING;
+  int ival = 0;
+
+  assert(rt);
+  assert(key);
+  assert(iogroup);
+
+  if (rt_int_parameter(rt, key, &ival)) {
+    if (ival >= 0) {
+      ifail = RT_KEY_OK;
+      *iogroup = ival;
+    }
+    else {
+      ifail = RT_KEY_INVALID;
+      rt_vinfo(rt, lv, "I/O group size must be non-negative\n");
+      rt_vinfo(rt, lv, "key:   %s\n", key);
+      rt_vinfo(rt, lv, "value: %d\n", ival);
+      rt_fatal(rt, lv, "Please check the input file and try again!\n");
+    }
+  }
+
+  return ifail;
+}
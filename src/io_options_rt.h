@@ -30,4 +30,10 @@ __host__ int io_options_rt_record_format(rt_t * rt, rt_enum_t lv,
 					 io_record_format_enum_t * options);
 __host__ int io_options_rt_report(rt_t * rt, rt_enum_t lv, const char * key,
 				  int * report);
+__host__ int io_options_rt_asynchronous(rt_t * rt, rt_enum_t lv,
+					const char * key, int * asynchronous);
+__host__ int io_options_rt_compression(rt_t * rt, rt_enum_t lv,
+				       const char * key, int * level);
+__host__ int io_options_rt_group(rt_t * rt, rt_enum_t lv, const char * key,
+				 int * iogroup);
 #endif
@@ -26,6 +26,7 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "kernel.h"
 #include "lb_data.h"
 
 #include "timer.h"
@@ -38,6 +39,8 @@ static int lb_data_touch(lb_t * lb);
 
 int lb_halo_dequeue_recv(lb_t * lb, const lb_halo_t * h, int irreq);
 int lb_halo_enqueue_send(const lb_t * lb, lb_halo_t * h, int irreq);
+static int lb_halo_reverse_pack(const lb_t * lb, lb_halo_t * h, int ireq);
+static int lb_halo_reverse_unpack(lb_t * lb, const lb_halo_t * h, int ireq);
 
 static __constant__ lb_collide_param_t static_param;
 
@@ -101,22 +104,29 @@ int lb_data_create(pe_t * pe, cs_t * cs, const lb_data_options_t * options,
       /* ... or will overflow indexing */
       pe_exit(pe, "Local system size overflows INT_MAX in distributions\n");
     }
+    else if (options->sparse) {
+      /* Allocation is deferred until the map is known; see
+       * lb_data_sparse(). */
+    }
     else {
-      size_t sz = sizeof(double)*obj->nsite*obj->ndist*obj->nvel;
+      size_t sz = sizeof(lb_float_t)*obj->nsite*obj->ndist*obj->nvel;
       assert(sz > 0); /* Should not overflow in size_t I hope! */
-      obj->f      = (double *) mem_aligned_malloc(MEM_PAGESIZE, sz);
-      obj->fprime = (double *) mem_aligned_malloc(MEM_PAGESIZE, sz);
+      obj->f      = (lb_float_t *) mem_aligned_malloc(MEM_PAGESIZE, sz);
       assert(obj->f);
-      assert(obj->fprime);
       if (obj->f      == NULL) pe_fatal(pe, "malloc(lb->f) failed\n");
-      if (obj->fprime == NULL) pe_fatal(pe, "malloc(lb->fprime) failed\n");
+      /* In-place streaming (AA) does not require fprime */
+      if (options->schedule != LB_SCHEDULE_AA) {
+	obj->fprime = (lb_float_t *) mem_aligned_malloc(MEM_PAGESIZE, sz);
+	assert(obj->fprime);
+	if (obj->fprime == NULL) pe_fatal(pe, "malloc(lb->fprime) failed\n");
+      }
       if (options->usefirsttouch) {
 	lb_data_touch(obj);
 	pe_info(pe, "Host data:        first touch\n");
       }
       else {
 	memset(obj->f, 0, sz);
-	memset(obj->fprime, 0, sz);
+	if (obj->fprime) memset(obj->fprime, 0, sz);
       }
     }
   }
@@ -141,8 +151,8 @@ int lb_data_create(pe_t * pe, cs_t * cs, const lb_data_options_t * options,
     };
 
     io_element_t binary = {
-      .datatype = MPI_DOUBLE,
-      .datasize = sizeof(double),
+      .datatype = MPI_LB_FLOAT,
+      .datasize = sizeof(lb_float_t),
       .count    = obj->nvel*obj->ndist,
       .endian   = io_endianness()
     };
@@ -185,28 +195,42 @@ int lb_data_create(pe_t * pe, cs_t * cs, const lb_data_options_t * options,
 __host__ int lb_free(lb_t * lb) {
 
   int ndevice;
-  double * tmp;
+  lb_float_t * tmp;
 
   assert(lb);
 
   tdpGetDeviceCount(&ndevice);
 
   if (ndevice > 0) {
-    tdpMemcpy(&tmp, &lb->target->f, sizeof(double *), tdpMemcpyDeviceToHost);
+    tdpMemcpy(&tmp, &lb->target->f, sizeof(lb_float_t *),
+	      tdpMemcpyDeviceToHost);
     tdpFree(tmp);
 
-    tdpMemcpy(&tmp, &lb->target->fprime, sizeof(double *),
+    tdpMemcpy(&tmp, &lb->target->fprime, sizeof(lb_float_t *),
 	      tdpMemcpyDeviceToHost);
-    tdpFree(tmp);
+    if (tmp) tdpFree(tmp);
+
+    if (lb->block) {
+      int * block = NULL;
+      tdpMemcpy(&block, &lb->target->block, sizeof(int *),
+		tdpMemcpyDeviceToHost);
+      tdpFree(block);
+    }
     tdpFree(lb->target);
   }
 
+  /* Complete any asynchronous write in progress */
+  io_impl_async_free(&lb->iowrite);
+
   io_metadata_finalise(&lb->input);
   io_metadata_finalise(&lb->output);
 
   if (lb->halo) halo_swap_free(lb->halo);
   if (lb->f) free(lb->f);
   if (lb->fprime) free(lb->fprime);
+  if (lb->block) free(lb->block);
+  if (lb->slot) free(lb->slot);
+  if (lb->nbr) free(lb->nbr);
 
   lb_halo_free(lb, &lb->h);
   lb_model_free(&lb->model);
@@ -226,7 +250,7 @@ __host__ int lb_free(lb_t * lb) {
 __host__ int lb_memcpy(lb_t * lb, tdpMemcpyKind flag) {
 
   int ndevice;
-  double * tmpf = NULL;
+  lb_float_t * tmpf = NULL;
 
   assert(lb);
 
@@ -238,11 +262,12 @@ __host__ int lb_memcpy(lb_t * lb, tdpMemcpyKind flag) {
   }
   else {
 
-    size_t nsz = (size_t) lb->model.nvel*lb->nsite*lb->ndist*sizeof(double);
+    size_t nsz = (size_t) lb->model.nvel*lb->nsite*lb->ndist*sizeof(lb_float_t);
 
     assert(lb->target);
 
-    tdpMemcpy(&tmpf, &lb->target->f, sizeof(double *), tdpMemcpyDeviceToHost);
+    tdpMemcpy(&tmpf, &lb->target->f, sizeof(lb_float_t *),
+	      tdpMemcpyDeviceToHost);
 
     switch (flag) {
     case tdpMemcpyHostToDevice:
@@ -280,7 +305,7 @@ static int lb_init(lb_t * lb) {
   int ndata;
   int nhalo;
   int ndevice;
-  double * tmp;
+  lb_float_t * tmp;
 
   assert(lb);
 
@@ -307,15 +332,18 @@ static int lb_init(lb_t * lb) {
     tdpMalloc((void **) &lb->target, sizeof(lb_t));
     tdpMemset(lb->target, 0, sizeof(lb_t));
 
-    tdpMalloc((void **) &tmp, ndata*sizeof(double));
-    tdpMemset(tmp, 0, ndata*sizeof(double));
-    tdpMemcpy(&lb->target->f, &tmp, sizeof(double *), tdpMemcpyHostToDevice);
-
-    tdpMalloc((void **) &tmp, ndata*sizeof(double));
-    tdpMemset(tmp, 0, ndata*sizeof(double));
-    tdpMemcpy(&lb->target->fprime, &tmp, sizeof(double *),
+    tdpMalloc((void **) &tmp, ndata*sizeof(lb_float_t));
+    tdpMemset(tmp, 0, ndata*sizeof(lb_float_t));
+    tdpMemcpy(&lb->target->f, &tmp, sizeof(lb_float_t *),
 	      tdpMemcpyHostToDevice);
 
+    if (lb->opts.schedule != LB_SCHEDULE_AA) {
+      tdpMalloc((void **) &tmp, ndata*sizeof(lb_float_t));
+      tdpMemset(tmp, 0, ndata*sizeof(lb_float_t));
+      tdpMemcpy(&lb->target->fprime, &tmp, sizeof(lb_float_t *),
+		tdpMemcpyHostToDevice);
+    }
+
     tdpGetSymbolAddress((void **) &ptmp, tdpSymbol(static_param));
     tdpMemcpy(&lb->target->param, &ptmp, sizeof(lb_collide_param_t *),
 	      tdpMemcpyHostToDevice);
@@ -367,6 +395,8 @@ static int lb_model_param_init(lb_t * lb) {
 
   for (p = 0; p < lb->model.nvel; p++) {
     lb->param->wv[p] = lb->model.wv[p];
+    lb->param->fshift[p] = 0.0;
+    if (lb->opts.shifted) lb->param->fshift[p] = lb->opts.rho0*lb->model.wv[p];
     for (ia = 0; ia < 3; ia++) {
       lb->param->cv[p][ia] = lb->model.cv[p][ia];
     }
@@ -387,6 +417,222 @@ static int lb_model_param_init(lb_t * lb) {
   return 0;
 }
 
+/*****************************************************************************
+ *
+ *  lb_data_fluid_list
+ *
+ *  Build the list of SIMD blocks of the local domain (as seen by
+ *  kernel_3d_v() for the local limits) which contain at least one
+ *  fluid site in the current map. Collision and propagation may
+ *  then visit only these blocks.
+ *
+ *  The distributions at sites in blocks with no fluid are then not
+ *  maintained. This is appropriate only if the map does not change
+ *  thereafter (e.g., porous media, but not colloids); the list
+ *  must be rebuilt if it does.
+ *
+ *****************************************************************************/
+
+__host__ int lb_data_fluid_list(lb_t * lb, const map_t * map) {
+
+  int nlocal[3] = {0};
+  int nblock = 0;
+  int * block = NULL;
+
+  assert(lb);
+  assert(map);
+
+  cs_nlocal(lb->cs, nlocal);
+
+  {
+    cs_limits_t lim = {1, nlocal[X], 1, nlocal[Y], 1, nlocal[Z]};
+    kernel_3d_v_t k3v = kernel_3d_v(lb->cs, lim, NSIMDVL);
+    int nmax = k3v.kiterations/NSIMDVL + 1;
+
+    block = (int *) malloc(nmax*sizeof(int));
+    assert(block);
+    if (block == NULL) pe_fatal(lb->pe, "malloc(lb->block) failed\n");
+
+    for (int kindex = 0; kindex < k3v.kiterations; kindex += NSIMDVL) {
+      int nfluid = 0;
+      int ic[NSIMDVL];
+      int jc[NSIMDVL];
+      int kc[NSIMDVL];
+      int maskv[NSIMDVL];
+      int index0 = k3v.kindex0 + kindex;
+
+      kernel_3d_v_coords(&k3v, kindex, ic, jc, kc);
+      kernel_3d_v_mask(&k3v, ic, jc, kc, maskv);
+
+      for (int iv = 0; iv < NSIMDVL; iv++) {
+	int status = MAP_BOUNDARY;
+	map_status(map, index0 + iv, &status);
+	if (maskv[iv] && status == MAP_FLUID) nfluid += 1;
+      }
+      if (nfluid > 0) block[nblock++] = index0;
+    }
+  }
+
+  if (lb->block) free(lb->block);
+  lb->nblock = nblock;
+  lb->block = block;
+
+  {
+    int ndevice = 0;
+    tdpGetDeviceCount(&ndevice);
+
+    if (ndevice > 0) {
+      int * tmp = NULL;
+      tdpAssert(tdpMemcpy(&tmp, &lb->target->block, sizeof(int *),
+			  tdpMemcpyDeviceToHost));
+      if (tmp) tdpAssert(tdpFree(tmp));
+      tdpAssert(tdpMalloc((void **) &tmp, imax(1, nblock)*sizeof(int)));
+      tdpAssert(tdpMemcpy(tmp, block, nblock*sizeof(int),
+			  tdpMemcpyHostToDevice));
+      tdpAssert(tdpMemcpy(&lb->target->block, &tmp, sizeof(int *),
+			  tdpMemcpyHostToDevice));
+      tdpAssert(tdpMemcpy(&lb->target->nblock, &nblock, sizeof(int),
+			  tdpMemcpyHostToDevice));
+    }
+  }
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  lb_data_sparse
+ *
+ *  Allocate the distributions for sparse storage: only fluid sites
+ *  in the map (including fluid sites in the halo) are stored. The
+ *  local fluid sites occupy slots 0..nfluid-1, followed by the halo.
+ *  Solid sites cost no distribution storage; lb_data_addr() returns
+ *  -1 for them, and lb_f() etc. see zero there.
+ *
+ *  Propagation uses the table lb->nbr, which holds for each local
+ *  fluid site and velocity p the address of the distribution to be
+ *  pulled: f_p at x - c_p if that site is fluid, or otherwise
+ *  f_pbar at x itself (stationary bounce-back on links, which is
+ *  what wall_bbl() would have provided via the solid site).
+ *
+ *  Host only. The map must be static thereafter.
+ *
+ *****************************************************************************/
+
+__host__ int lb_data_sparse(lb_t * lb, const map_t * map) {
+
+  int nhalo = 0;
+  int nlocal[3] = {0};
+  int nslot = 0;
+  int nfluid = 0;
+  int * slot = NULL;
+  int * nbr = NULL;
+
+  assert(lb);
+  assert(map);
+  assert(lb->opts.sparse);
+  assert(lb->ndist == 1);
+  assert(lb->f == NULL);
+
+  {
+    int ndevice = 0;
+    tdpGetDeviceCount(&ndevice);
+    if (ndevice > 0) pe_fatal(lb->pe, "lb_data_sparse() is host only\n");
+  }
+
+  cs_nhalo(lb->cs, &nhalo);
+  cs_nlocal(lb->cs, nlocal);
+
+  slot = (int *) malloc(lb->nsite*sizeof(int));
+  assert(slot);
+  if (slot == NULL) pe_fatal(lb->pe, "malloc(lb->slot) failed\n");
+
+  for (int index = 0; index < lb->nsite; index++) {
+    slot[index] = -1;
+  }
+
+  /* Local fluid sites, then fluid sites in the halo */
+
+  for (int ic = 1; ic <= nlocal[X]; ic++) {
+    for (int jc = 1; jc <= nlocal[Y]; jc++) {
+      for (int kc = 1; kc <= nlocal[Z]; kc++) {
+	int index = cs_index(lb->cs, ic, jc, kc);
+	int status = MAP_BOUNDARY;
+	map_status(map, index, &status);
+	if (status == MAP_FLUID) slot[index] = nslot++;
+      }
+    }
+  }
+
+  nfluid = nslot;
+
+  for (int ic = 1 - nhalo; ic <= nlocal[X] + nhalo; ic++) {
+    for (int jc = 1 - nhalo; jc <= nlocal[Y] + nhalo; jc++) {
+      for (int kc = 1 - nhalo; kc <= nlocal[Z] + nhalo; kc++) {
+	int index = cs_index(lb->cs, ic, jc, kc);
+	int status = MAP_BOUNDARY;
+	if (slot[index] >= 0) continue;
+	map_status(map, index, &status);
+	if (status == MAP_FLUID) slot[index] = nslot++;
+      }
+    }
+  }
+
+  /* Distributions */
+
+  {
+    size_t sz = sizeof(lb_float_t)*imax(1, nslot)*lb->ndist*lb->nvel;
+
+    lb->f = (lb_float_t *) mem_aligned_malloc(MEM_PAGESIZE, sz);
+    assert(lb->f);
+    if (lb->f == NULL) pe_fatal(lb->pe, "malloc(lb->f) failed\n");
+    lb->fprime = (lb_float_t *) mem_aligned_malloc(MEM_PAGESIZE, sz);
+    assert(lb->fprime);
+    if (lb->fprime == NULL) pe_fatal(lb->pe, "malloc(lb->fprime) failed\n");
+    memset(lb->f, 0, sz);
+    memset(lb->fprime, 0, sz);
+  }
+
+  /* Propagation sources */
+
+  nbr = (int *) malloc(imax(1, nfluid)*lb->nvel*sizeof(int));
+  assert(nbr);
+  if (nbr == NULL) pe_fatal(lb->pe, "malloc(lb->nbr) failed\n");
+
+  for (int ic = 1; ic <= nlocal[X]; ic++) {
+    for (int jc = 1; jc <= nlocal[Y]; jc++) {
+      for (int kc = 1; kc <= nlocal[Z]; kc++) {
+	int index = cs_index(lb->cs, ic, jc, kc);
+	int is = slot[index];
+	if (is < 0) continue;
+	for (int p = 0; p < lb->nvel; p++) {
+	  int indexp = cs_index(lb->cs, ic - lb->model.cv[p][X],
+				jc - lb->model.cv[p][Y],
+				kc - lb->model.cv[p][Z]);
+	  int isp = slot[indexp];
+	  int naddr = addr_rank1(nfluid, lb->nvel, is, p);
+	  if (isp >= 0) {
+	    nbr[naddr] = LB_ADDR(nslot, 1, lb->nvel, isp, LB_RHO, p);
+	  }
+	  else {
+	    nbr[naddr] = LB_ADDR(nslot, 1, lb->nvel, is, LB_RHO, lb->nvel - p);
+	  }
+	}
+      }
+    }
+  }
+
+  lb->nslot = nslot;
+  lb->nfluid = nfluid;
+  lb->slot = slot;
+  lb->nbr = nbr;
+
+  /* Collision visits only the SIMD blocks with fluid */
+  lb_data_fluid_list(lb, map);
+
+  return 0;
+}
+
 /*****************************************************************************
  *
  *  lb_init_rest_f
@@ -430,6 +676,9 @@ static int lb_mpi_init(lb_t * lb) {
 
   assert(lb);
 
+  /* The target halo swap is for double precision storage only */
+  if (sizeof(lb_float_t) != sizeof(double)) return 0;
+
   halo_swap_create_r2(lb->pe, lb->cs, 1, lb->nsite, lb->ndist, lb->nvel,
 		      &lb->halo);
   halo_swap_handlers_set(lb->halo, halo_swap_pack_rank1, halo_swap_unpack_rank1);
@@ -466,7 +715,7 @@ __host__ void lb_data_touch_kernel(cs_limits_t lim, lb_t * lb) {
       for (int n = 0; n < lb->ndist; n++) {
 	int lindex = LB_ADDR(lb->nsite, lb->ndist, lb->nvel, index, n, p);
 	lb->f[lindex] = 0.0;
-	lb->fprime[lindex] = 0.0;
+	if (lb->fprime) lb->fprime[lindex] = 0.0;
       }
     }
   }
@@ -522,14 +771,18 @@ __host__ int lb_halo(lb_t * lb) {
 
 __host__ int lb_halo_swap(lb_t * lb, lb_halo_enum_t flag) {
 
-  double * data;
-
   assert(lb);
 
   switch (flag) {
   case LB_HALO_TARGET:
-    tdpMemcpy(&data, &lb->target->f, sizeof(double *), tdpMemcpyDeviceToHost);
-    halo_swap_packed(lb->halo, data);
+    {
+      /* Not available for single precision storage (see options) */
+      double * data = NULL;
+      assert(sizeof(lb_float_t) == sizeof(double));
+      assert(lb->halo);
+      tdpMemcpy(&data, &lb->target->f, sizeof(double *), tdpMemcpyDeviceToHost);
+      halo_swap_packed(lb->halo, data);
+    }
     break;
   case LB_HALO_OPENMP_FULL:
     lb_halo_post(lb, &lb->h);
@@ -581,7 +834,10 @@ int lb_f(lb_t * lb, int index, int p, int n, double * f) {
   assert(p >= 0 && p < lb->nvel);
   assert(n >= 0 && n < lb->ndist);
 
-  *f = lb->f[LB_ADDR(lb->nsite, lb->ndist, lb->nvel, index, n, p)];
+  {
+    int laddr = lb_data_addr(lb, index, n, p);
+    *f = (laddr < 0) ? 0.0 : lb->f[laddr] + lb->param->fshift[p];
+  }
 
   return 0;
 }
@@ -602,7 +858,10 @@ int lb_f_set(lb_t * lb, int index, int p, int n, double fvalue) {
   assert(p >= 0 && p < lb->nvel);
   assert(n >= 0 && n < lb->ndist);
 
-  lb->f[LB_ADDR(lb->nsite, lb->ndist, lb->nvel, index, n, p)] = fvalue;
+  {
+    int laddr = lb_data_addr(lb, index, n, p);
+    if (laddr >= 0) lb->f[laddr] = fvalue - lb->param->fshift[p];
+  }
 
   return 0;
 }
@@ -626,7 +885,8 @@ int lb_0th_moment(lb_t * lb, int index, lb_dist_enum_t nd, double * rho) {
   *rho = 0.0;
 
   for (int p = 0; p < lb->nvel; p++) {
-    *rho += lb->f[LB_ADDR(lb->nsite, lb->ndist, lb->nvel, index, nd, p)];
+    int laddr = lb_data_addr(lb, index, nd, p);
+    if (laddr >= 0) *rho += lb->f[laddr] + lb->param->fshift[p];
   }
 
   return 0;
@@ -656,9 +916,10 @@ int lb_1st_moment(lb_t * lb, int index, lb_dist_enum_t nd, double g[3]) {
   }
 
   for (p = 0; p < lb->model.nvel; p++) {
+    int laddr = lb_data_addr(lb, index, nd, p);
+    if (laddr < 0) continue;
     for (n = 0; n < lb->model.ndim; n++) {
-      g[n] += lb->model.cv[p][n]
-	*lb->f[LB_ADDR(lb->nsite, lb->ndist, lb->nvel, index, nd, p)];
+      g[n] += lb->model.cv[p][n]*(lb->f[laddr] + lb->param->fshift[p]);
     }
   }
 
@@ -689,12 +950,14 @@ int lb_2nd_moment(lb_t * lb, int index, lb_dist_enum_t nd, double s[3][3]) {
   }
 
   for (p = 0; p < lb->model.nvel; p++) {
+    int laddr = lb_data_addr(lb, index, nd, p);
+    if (laddr < 0) continue;
     for (ia = 0; ia < lb->model.ndim; ia++) {
       for (ib = 0; ib < lb->model.ndim; ib++) {
 	double f = 0.0;
 	double cs2 = lb->model.cs2;
 	double dab = (ia == ib);
-	f = lb->f[LB_ADDR(lb->nsite, lb->ndist, lb->nvel, index, nd, p)];
+	f = lb->f[laddr] + lb->param->fshift[p];
 	s[ia][ib] += f*(lb->model.cv[p][ia]*lb->model.cv[p][ib] - cs2*dab);
       }
     }
@@ -732,8 +995,13 @@ int lb_1st_moment_equilib_set(lb_t * lb, int index, double rho, double u[3]) {
       }
     }
 
-    lb->f[LB_ADDR(lb->nsite, lb->ndist, lb->nvel, index, LB_RHO, p)]
-      = rho*lb->model.wv[p]*(1.0 + rcs2*udotc + 0.5*rcs2*rcs2*sdotq);
+    {
+      int laddr = lb_data_addr(lb, index, LB_RHO, p);
+      if (laddr < 0) continue;
+      lb->f[laddr]
+	= rho*lb->model.wv[p]*(1.0 + rcs2*udotc + 0.5*rcs2*rcs2*sdotq)
+	- lb->param->fshift[p];
+    }
   }
 
   return 0;
@@ -805,8 +1073,8 @@ int lb_halo_enqueue_send(const lb_t * lb, lb_halo_t * h, int ireq) {
 	  int dot = mx*px + my*py + mz*pz;
 	  if (h->full || dot == mm) {
 	    int index = cs_index(lb->cs, ic, jc, kc);
-	    int laddr = LB_ADDR(lb->nsite, lb->ndist, lb->nvel, index, n, p);
-	    h->send[ireq][ih*h->count[ireq] + ib] = lb->f[laddr];
+	    int laddr = lb_data_addr(lb, index, n, p);
+	    h->send[ireq][ih*h->count[ireq] + ib] = (laddr < 0) ? 0.0 : lb->f[laddr];
 	    ib++;
 	  }
 	}
@@ -848,7 +1116,7 @@ int lb_halo_dequeue_recv(lb_t * lb, const lb_halo_t * h, int ireq) {
     int stry = strz*nz;
     int strx = stry*ny;
 
-    double * recv = h->recv[ireq];
+    lb_float_t * recv = h->recv[ireq];
 
     {
       int i = 1 + mx;
@@ -877,8 +1145,8 @@ int lb_halo_dequeue_recv(lb_t * lb, const lb_halo_t * h, int ireq) {
 
 	  if (h->full || dot == mm) {
 	    int index = cs_index(lb->cs, ic, jc, kc);
-	    int laddr = LB_ADDR(lb->nsite, lb->ndist, lb->nvel, index, n, p);
-	    lb->f[laddr] = recv[ih*h->count[ireq] + ib];
+	    int laddr = lb_data_addr(lb, index, n, p);
+	    if (laddr >= 0) lb->f[laddr] = recv[ih*h->count[ireq] + ib];
 	    ib++;
 	  }
 	}
@@ -1019,13 +1287,13 @@ int lb_halo_create(const lb_t * lb, lb_halo_t * h, lb_halo_enum_t scheme) {
     /* Allocate send buffer for send region */
     if (count > 0) {
       int scount = count*lb_halo_size(h->slim[p]);
-      h->send[p] = (double *) calloc(scount, sizeof(double));
+      h->send[p] = (lb_float_t *) calloc(scount, sizeof(lb_float_t));
       assert(h->send[p]);
     }
     /* Allocate recv buffer */
     if (count > 0) {
       int rcount = count*lb_halo_size(h->rlim[p]);
-      h->recv[p] = (double *) calloc(rcount, sizeof(double));
+      h->recv[p] = (lb_float_t *) calloc(rcount, sizeof(lb_float_t));
       assert(h->recv[p]);
     }
   }
@@ -1073,7 +1341,7 @@ int lb_halo_post(const lb_t * lb, lb_halo_t * h) {
 
       if (h->nbrrank[i][j][k] == h->nbrrank[1][1][1]) mcount = 0;
 
-      MPI_Irecv(h->recv[ireq], mcount, MPI_DOUBLE, h->nbrrank[i][j][k],
+      MPI_Irecv(h->recv[ireq], mcount, MPI_LB_FLOAT, h->nbrrank[i][j][k],
 		h->tagbase + ireq, h->comm, h->request + ireq);
     }
   }
@@ -1109,7 +1377,7 @@ int lb_halo_post(const lb_t * lb, lb_halo_t * h) {
       /* Short circuit messages to self. */
       if (h->nbrrank[i][j][k] == h->nbrrank[1][1][1]) mcount = 0;
 
-      MPI_Isend(h->send[ireq], mcount, MPI_DOUBLE, h->nbrrank[i][j][k],
+      MPI_Isend(h->send[ireq], mcount, MPI_LB_FLOAT, h->nbrrank[i][j][k],
 		h->tagbase + ireq, h->comm, h->request + 27 + ireq);
     }
   }
@@ -1150,6 +1418,216 @@ int lb_halo_wait(lb_t * lb, lb_halo_t * h) {
   return 0;
 }
 
+/*****************************************************************************
+ *
+ *  lb_halo_reverse
+ *
+ *  For in-place (AA) streaming, the odd time step writes
+ *  post-collision distributions from the edge of the local domain
+ *  into the halo region. These values are returned to the process
+ *  which owns the relevant sites, i.e., this is a forward halo
+ *  swap with the direction of communication reversed. Host only.
+ *
+ *  Requires the full halo (all velocities in each direction).
+ *
+ *****************************************************************************/
+
+__host__ int lb_halo_reverse(lb_t * lb) {
+
+  lb_halo_t * h = NULL;
+
+  assert(lb);
+
+  h = &lb->h;
+  assert(h->full);
+
+  TIMER_start(TIMER_LB_HALO_IRECV);
+
+  /* Recv from the +ve cv direction into the (otherwise) send buffer */
+
+  for (int ireq = 0; ireq < h->map.nvel; ireq++) {
+
+    h->request[ireq] = MPI_REQUEST_NULL;
+
+    if (h->count[ireq] > 0) {
+      int i = 1 + h->map.cv[ireq][X];
+      int j = 1 + h->map.cv[ireq][Y];
+      int k = 1 + h->map.cv[ireq][Z];
+      int mcount = h->count[ireq]*lb_halo_size(h->slim[ireq]);
+
+      if (h->nbrrank[i][j][k] == h->nbrrank[1][1][1]) mcount = 0;
+
+      MPI_Irecv(h->send[ireq], mcount, MPI_LB_FLOAT, h->nbrrank[i][j][k],
+		h->tagbase + 27 + ireq, h->comm, h->request + ireq);
+    }
+  }
+
+  TIMER_stop(TIMER_LB_HALO_IRECV);
+
+  TIMER_start(TIMER_LB_HALO_PACK);
+
+  #pragma omp parallel
+  {
+    for (int ireq = 0; ireq < h->map.nvel; ireq++) {
+      lb_halo_reverse_pack(lb, h, ireq);
+    }
+  }
+
+  TIMER_stop(TIMER_LB_HALO_PACK);
+
+  TIMER_start(TIMER_LB_HALO_ISEND);
+
+  for (int ireq = 0; ireq < h->map.nvel; ireq++) {
+
+    h->request[27+ireq] = MPI_REQUEST_NULL;
+
+    if (h->count[ireq] > 0) {
+      int i = 1 + h->map.cv[h->map.nvel-ireq][X];
+      int j = 1 + h->map.cv[h->map.nvel-ireq][Y];
+      int k = 1 + h->map.cv[h->map.nvel-ireq][Z];
+      int mcount = h->count[ireq]*lb_halo_size(h->rlim[ireq]);
+
+      if (h->nbrrank[i][j][k] == h->nbrrank[1][1][1]) mcount = 0;
+
+      MPI_Isend(h->recv[ireq], mcount, MPI_LB_FLOAT, h->nbrrank[i][j][k],
+		h->tagbase + 27 + ireq, h->comm, h->request + 27 + ireq);
+    }
+  }
+
+  TIMER_stop(TIMER_LB_HALO_ISEND);
+
+  TIMER_start(TIMER_LB_HALO_WAIT);
+  MPI_Waitall(2*h->map.nvel, h->request, MPI_STATUSES_IGNORE);
+  TIMER_stop(TIMER_LB_HALO_WAIT);
+
+  TIMER_start(TIMER_LB_HALO_UNPACK);
+
+  #pragma omp parallel
+  {
+    for (int ireq = 0; ireq < h->map.nvel; ireq++) {
+      lb_halo_reverse_unpack(lb, h, ireq);
+    }
+  }
+
+  TIMER_stop(TIMER_LB_HALO_UNPACK);
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  lb_halo_reverse_pack
+ *
+ *  Pack the halo region rlim[ireq] into the recv buffer.
+ *
+ *****************************************************************************/
+
+static int lb_halo_reverse_pack(const lb_t * lb, lb_halo_t * h, int ireq) {
+
+  assert(0 <= ireq && ireq < h->map.nvel);
+
+  if (h->count[ireq] > 0) {
+
+    int nx = 1 + h->rlim[ireq].imax - h->rlim[ireq].imin;
+    int ny = 1 + h->rlim[ireq].jmax - h->rlim[ireq].jmin;
+    int nz = 1 + h->rlim[ireq].kmax - h->rlim[ireq].kmin;
+
+    int strz = 1;
+    int stry = strz*nz;
+    int strx = stry*ny;
+
+    #pragma omp for nowait
+    for (int ih = 0; ih < nx*ny*nz; ih++) {
+      int ic = h->rlim[ireq].imin + ih/strx;
+      int jc = h->rlim[ireq].jmin + (ih % strx)/stry;
+      int kc = h->rlim[ireq].kmin + (ih % stry)/strz;
+      int index = cs_index(lb->cs, ic, jc, kc);
+      int ib = 0;
+
+      for (int n = 0; n < lb->ndist; n++) {
+	for (int p = 0; p < lb->nvel; p++) {
+	  int laddr = lb_data_addr(lb, index, n, p);
+	  h->recv[ireq][ih*h->count[ireq] + ib] = (laddr < 0) ? 0.0 : lb->f[laddr];
+	  ib++;
+	}
+      }
+      assert(ib == h->count[ireq]);
+    }
+  }
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  lb_halo_reverse_unpack
+ *
+ *  Unpack into the send region slim[ireq]. Only distributions which
+ *  were streamed out of the neighbouring process are relevant, i.e.,
+ *  those for which the site of origin x - c_p lies in the halo region
+ *  in direction cv[ireq]. Everything else is left untouched.
+ *
+ *****************************************************************************/
+
+static int lb_halo_reverse_unpack(lb_t * lb, const lb_halo_t * h, int ireq) {
+
+  assert(lb);
+  assert(h);
+  assert(0 <= ireq && ireq < h->map.nvel);
+
+  if (h->count[ireq] > 0) {
+
+    int8_t mx = h->map.cv[ireq][X];
+    int8_t my = h->map.cv[ireq][Y];
+    int8_t mz = h->map.cv[ireq][Z];
+
+    int nx = 1 + h->slim[ireq].imax - h->slim[ireq].imin;
+    int ny = 1 + h->slim[ireq].jmax - h->slim[ireq].jmin;
+    int nz = 1 + h->slim[ireq].kmax - h->slim[ireq].kmin;
+
+    int strz = 1;
+    int stry = strz*nz;
+    int strx = stry*ny;
+
+    lb_float_t * recv = h->send[ireq];
+
+    /* If Cartesian neighbour is self, just copy out of packed buffer. */
+    if (h->nbrrank[1+mx][1+my][1+mz] == h->nbrrank[1][1][1]) {
+      recv = h->recv[ireq];
+    }
+
+    #pragma omp for nowait
+    for (int ih = 0; ih < nx*ny*nz; ih++) {
+      int ic = h->slim[ireq].imin + ih/strx;
+      int jc = h->slim[ireq].jmin + (ih % strx)/stry;
+      int kc = h->slim[ireq].kmin + (ih % stry)/strz;
+      int index = cs_index(lb->cs, ic, jc, kc);
+      int ib = 0;
+
+      for (int n = 0; n < lb->ndist; n++) {
+	for (int p = 0; p < lb->nvel; p++) {
+	  /* Halo direction of the site of origin */
+	  int is = ic - lb->model.cv[p][X];
+	  int js = jc - lb->model.cv[p][Y];
+	  int ks = kc - lb->model.cv[p][Z];
+	  int dx = (is < 1) ? -1 : ((is > h->nlocal[X]) ? +1 : 0);
+	  int dy = (js < 1) ? -1 : ((js > h->nlocal[Y]) ? +1 : 0);
+	  int dz = (ks < 1) ? -1 : ((ks > h->nlocal[Z]) ? +1 : 0);
+
+	  if (dx == mx && dy == my && dz == mz) {
+	    int laddr = lb_data_addr(lb, index, n, p);
+	    if (laddr >= 0) lb->f[laddr] = recv[ih*h->count[ireq] + ib];
+	  }
+	  ib++;
+	}
+      }
+      assert(ib == h->count[ireq]);
+    }
+  }
+
+  return 0;
+}
+
 /*****************************************************************************
  *
  *  lb_halo_free
@@ -1179,20 +1657,23 @@ int lb_halo_free(lb_t * lb, lb_halo_t * h) {
  *
  *  Write output buffer independent of in-memory order.
  *
+ *  The binary record is the storage representation, i.e., in the
+ *  storage precision, and shifted if relevant (see lb_io_write()).
+ *
  *****************************************************************************/
 
 int lb_write_buf(const lb_t * lb, int index, char * buf) {
 
-  double data[NVELMAX] = {0};
+  lb_float_t data[NVELMAX] = {0};
 
   assert(lb);
   assert(buf);
 
   for (int n = 0; n < lb->ndist; n++) {
-    size_t sz = lb->model.nvel*sizeof(double);
+    size_t sz = lb->model.nvel*sizeof(lb_float_t);
     for (int p = 0; p < lb->model.nvel; p++) {
-      int laddr = LB_ADDR(lb->nsite, lb->ndist, lb->model.nvel, index, n, p);
-      data[p] = lb->f[laddr];
+      int laddr = lb_data_addr(lb, index, n, p);
+      data[p] = (laddr < 0) ? 0.0 : lb->f[laddr];
     }
     memcpy(buf + n*sz, data, sz);
   }
@@ -1208,17 +1689,17 @@ int lb_write_buf(const lb_t * lb, int index, char * buf) {
 
 int lb_read_buf(lb_t * lb, int index, const char * buf) {
 
-  double data[NVELMAX] = {0};
+  lb_float_t data[NVELMAX] = {0};
 
   assert(lb);
   assert(buf);
 
   for (int n = 0; n < lb->ndist; n++) {
-    size_t sz = lb->model.nvel*sizeof(double);
+    size_t sz = lb->model.nvel*sizeof(lb_float_t);
     memcpy(data, buf + n*sz, sz);
     for (int p = 0; p < lb->model.nvel; p++) {
-      int laddr = LB_ADDR(lb->nsite, lb->ndist, lb->model.nvel, index, n, p);
-      lb->f[laddr] = data[p];
+      int laddr = lb_data_addr(lb, index, n, p);
+      if (laddr >= 0) lb->f[laddr] = data[p];
     }
   }
 
@@ -1230,7 +1711,8 @@ int lb_read_buf(lb_t * lb, int index, const char * buf) {
  *  lb_write_buf_ascii
  *
  *  For ascii, we are going to put ndist distributions on a single line...
- *  This is merely cosmetic, and for appearances.
+ *  This is merely cosmetic, and for appearances. The ascii record
+ *  always holds the actual (unshifted) value.
  *
  *****************************************************************************/
 
@@ -1247,8 +1729,9 @@ int lb_write_buf_ascii(const lb_t * lb, int index, char * buf) {
     char tmp[BUFSIZ] = {0};
     int poffset = p*(lb->ndist*nbyte + 1); /* +1 for each newline */
     for (int n = 0; n < lb->ndist; n++) {
-      int laddr = LB_ADDR(lb->nsite, lb->ndist, lb->model.nvel, index, n, p);
-      int np = snprintf(tmp, nbyte + 1, " %22.15e", lb->f[laddr]);
+      int laddr = lb_data_addr(lb, index, n, p);
+      double f = (laddr < 0) ? 0.0 : lb->f[laddr] + lb->param->fshift[p];
+      int np = snprintf(tmp, nbyte + 1, " %22.15e", f);
       if (np != nbyte) ifail = 1;
       memcpy(buf + poffset + n*nbyte, tmp, nbyte*sizeof(char));
     }
@@ -1277,11 +1760,13 @@ int lb_read_buf_ascii(lb_t * lb, int index, const char * buf) {
   for (int p = 0; p < lb->model.nvel; p++) {
     int poffset = p*(lb->ndist*nbyte + 1); /* +1 for each newline */
     for (int n = 0; n < lb->ndist; n++) {
-      int laddr = LB_ADDR(lb->nsite, lb->ndist, lb->model.nvel, index, n, p);
+      int laddr = lb_data_addr(lb, index, n, p);
       char tmp[BUFSIZ] = {0};              /* Make sure we have a \0 */
+      double f = 0.0;
       memcpy(tmp, buf + poffset + n*nbyte, nbyte*sizeof(char));
-      int nr = sscanf(tmp, "%le", lb->f + laddr);
+      int nr = sscanf(tmp, "%le", &f);
       if (nr != 1) ifail = 1;
+      if (laddr >= 0) lb->f[laddr] = f - lb->param->fshift[p];
     }
   }
 
@@ -1374,10 +1859,18 @@ int lb_io_write(lb_t * lb, int timestep, io_event_t * event) {
   const io_metadata_t * meta = &lb->output;
 
   if (meta->iswriten == 0) {
-    /* No comments at the moment */
-    cJSON * comments = NULL;
-    ifail = io_metadata_write(meta, "dist", NULL, comments);
+    /* Record the storage representation */
+    cJSON * comments = cJSON_CreateObject();
+    cJSON_AddStringToObject(comments, "Precision",
+			    (sizeof(lb_float_t) == sizeof(float)) ?
+			    "float" : "double");
+    cJSON_AddBoolToObject(comments, "Shifted", lb->opts.shifted);
+    if (lb->opts.shifted) {
+      cJSON_AddNumberToObject(comments, "Shift rho0", lb->opts.rho0);
+    }
+    ifail = io_metadata_write(meta, "dist", "lb_data", comments);
     if (ifail == 0) lb->output.iswriten = 1;
+    cJSON_Delete(comments);
   }
 
   /* Implementation */
@@ -1386,7 +1879,14 @@ int lb_io_write(lb_t * lb, int timestep, io_event_t * event) {
     char filename[BUFSIZ] = {0};
 
     io_subfile_name(&meta->subfile, "dist", timestep, filename, BUFSIZ);
-    ifail = io_impl_create(meta, &io);
+
+    if (meta->options.asynchronous) {
+      /* Pack into the idle one of two buffers; completes later */
+      ifail = io_impl_async_buffer(&lb->iowrite, meta, &io);
+    }
+    else {
+      ifail = io_impl_create(meta, &io);
+    }
     assert(ifail == 0);
 
     if (ifail == 0) {
@@ -1395,13 +1895,19 @@ int lb_io_write(lb_t * lb, int timestep, io_event_t * event) {
       lb_io_aggr_pack(lb, io->aggr);
 
       io_event_record(event, IO_EVENT_WRITE);
-      io->impl->write(io, filename);
-
-      if (meta->options.report) {
-	pe_info(lb->pe, "MPIIO wrote to %s\n", filename);
+      if (meta->options.asynchronous) {
+	io_impl_async_write_begin(&lb->iowrite, filename);
+	if (meta->options.report) {
+	  pe_info(lb->pe, "MPIIO writing to %s (asynchronous)\n", filename);
+	}
+      }
+      else {
+	io->impl->write(io, filename);
+	if (meta->options.report) {
+	  pe_info(lb->pe, "MPIIO wrote to %s\n", filename);
+	}
+	io->impl->free(&io);
       }
-
-      io->impl->free(&io);
       io_event_report(event, meta, "dist");
     }
   }
@@ -17,6 +17,7 @@
 #ifndef LB_DATA_H
 #define LB_DATA_H
 
+#include <float.h>
 #include <stdint.h>
 
 #include "pe.h"
@@ -27,6 +28,7 @@
 #include "io_impl.h"
 #include "io_event.h"
 #include "halo_swap.h"
+#include "map.h"
 
 /* Residual compile-time switches scheduled for removal */
 #ifdef _D2Q9_
@@ -45,6 +47,20 @@ enum {NDIM = 3, NVEL = 27};
 #define NVELMAX 27
 #define LB_RECORD_LENGTH_ASCII 23
 
+/* Storage type for the distributions. The default is double; compile
+ * with -DLB_DATA_FLOAT for single precision storage. Moments and
+ * collisions are always computed in double precision. */
+
+#ifdef LB_DATA_FLOAT
+typedef float lb_float_t;
+#define MPI_LB_FLOAT MPI_FLOAT
+#define LB_FLOAT_EPSILON FLT_EPSILON
+#else
+typedef double lb_float_t;
+#define MPI_LB_FLOAT MPI_DOUBLE
+#define LB_FLOAT_EPSILON DBL_EPSILON
+#endif
+
 typedef struct lb_collide_param_s lb_collide_param_t;
 typedef struct lb_halo_s lb_halo_t;
 typedef struct lb_data_s lb_t;
@@ -64,6 +80,7 @@ struct lb_collide_param_s {
   double rna[27];                    /* reciprocal of normaliser[p] */
   double rtau[27];
   double wv[27];
+  double fshift[27];                 /* stored f is f - fshift[p] */
   double ma[27][27];
   double mi[27][27];
 };
@@ -84,8 +101,8 @@ struct lb_halo_s {
   int count[27];                  /* halo: item data count per direction */
   cs_limits_t slim[27];           /* halo: send data region (rectangular) */
   cs_limits_t rlim[27];           /* halo: recv data region (rectangular) */
-  double * send[27];              /* halo: send buffer per direction */
-  double * recv[27];              /* halo: recv buffer per direction */
+  lb_float_t * send[27];          /* halo: send buffer per direction */
+  lb_float_t * recv[27];          /* halo: recv buffer per direction */
   MPI_Request request[2*27];      /* halo: array of requests */
 
 };
@@ -112,9 +129,11 @@ struct lb_data_s {
   io_element_t binary;   /* Per site binary information. */
   io_metadata_t input;   /* Metadata for io implementation (input) */
   io_metadata_t output;  /* Ditto (for output) */
+  io_impl_async_t iowrite;  /* Asynchronous output buffers */
 
-  double * f;            /* Distributions */
-  double * fprime;       /* used in propagation only */
+  lb_float_t * f;        /* Distributions */
+  lb_float_t * fprime;   /* used in propagation only */
+  int fpending;          /* f is post-collision awaiting propagation */
 
   lb_collide_param_t * param;   /* Collision parameters REFACTOR THIS */
   lb_relaxation_enum_t nrelax;  /* Relaxation scheme */
@@ -123,6 +142,14 @@ struct lb_data_s {
   lb_data_options_t opts;       /* Copy of run time options */
   lb_halo_t h;                  /* halo information/buffers */
 
+  int nblock;                   /* Fluid list: number of SIMD blocks */
+  int * block;                  /* Fluid list: first index of each block */
+
+  int nslot;                    /* Sparse storage: number of sites stored */
+  int nfluid;                   /* Sparse storage: local (fluid) sites */
+  int * slot;                   /* Sparse storage: slot of site, or -1 */
+  int * nbr;                    /* Sparse storage: propagation source */
+
   lb_t * target;                /* copy of this structure on target */
 };
 
@@ -133,6 +160,31 @@ struct lb_data_s {
 #define LB_ADDR(nsites, ndist, nvel, index, n, p) \
   addr_rank2(nsites, ndist, nvel, index, n, p)
 
+/*****************************************************************************
+ *
+ *  lb_data_addr
+ *
+ *  Address in f of distribution n, velocity p at site index. With
+ *  sparse storage (see lb_data_sparse()), sites which are not stored
+ *  return -1.
+ *
+ *****************************************************************************/
+
+__host__ __device__
+static inline int lb_data_addr(const lb_t * lb, int index, int n, int p) {
+
+  int laddr = -1;
+
+  if (lb->slot == NULL) {
+    laddr = LB_ADDR(lb->nsite, lb->ndist, lb->nvel, index, n, p);
+  }
+  else if (lb->slot[index] >= 0) {
+    laddr = LB_ADDR(lb->nslot, lb->ndist, lb->nvel, lb->slot[index], n, p);
+  }
+
+  return laddr;
+}
+
 /* Number of hydrodynamic modes */
 enum {NHYDRO = 1 + NDIM + NDIM*(NDIM+1)/2};
 
@@ -155,6 +207,9 @@ __host__ int lb_memcpy(lb_t * lb, tdpMemcpyKind flag);
 __host__ int lb_collide_param_commit(lb_t * lb);
 __host__ int lb_halo(lb_t * lb);
 __host__ int lb_halo_swap(lb_t * lb, lb_halo_enum_t flag);
+__host__ int lb_halo_reverse(lb_t * lb);
+__host__ int lb_data_fluid_list(lb_t * lb, const map_t * map);
+__host__ int lb_data_sparse(lb_t * lb, const map_t * map);
 
 __host__ __device__ int lb_ndist(lb_t * lb, int * ndist);
 __host__ __device__ int lb_f(lb_t * lb, int index, int p, int n, double * f);
@@ -8,7 +8,7 @@
  *  Edinburgh Soft Matter and Statistical Physics Group and
  *  Edinburgh Parallel Computing Centre
  *
- *  (c) 2022 The University of Edinburgh
+ *  (c) 2022-2024 The University of Edinburgh
  *
  *  Contributing authors:
  *  Kevin Stratford (kevin@epcc.ed.ac.uk)
@@ -30,10 +30,20 @@ lb_data_options_t lb_data_options_default(void) {
   lb_data_options_t opts = {.ndim = 3, .nvel = 19, .ndist = 1,
                             .nrelax = LB_RELAXATION_M10,
 			    .halo   = LB_HALO_TARGET,
+			    .schedule = LB_SCHEDULE_SPLIT,
+			    .shifted  = 0,
+			    .rho0     = 1.0,
+			    .fluidlist = 0,
+			    .sparse    = 0,
 			    .reportimbalance = 0,
 			    .usefirsttouch   = 0,
                             .iodata = io_info_args_default()};
 
+#ifdef LB_DATA_FLOAT
+  /* Single precision storage uses the host halo */
+  opts.halo = LB_HALO_OPENMP_FULL;
+#endif
+
   return opts;
 }
 
@@ -71,5 +81,32 @@ int lb_data_options_valid(const lb_data_options_t * opts) {
 
   if (opts->ndist == 2 && opts->halo != LB_HALO_TARGET) valid = 0;
 
+#ifdef LB_DATA_FLOAT
+  /* The target halo (halo_swap_t) is double only */
+  if (opts->halo == LB_HALO_TARGET) valid = 0;
+#endif
+
+  /* The fused collision/propagation is single fluid only */
+  if (opts->ndist == 2 && opts->schedule != LB_SCHEDULE_SPLIT) valid = 0;
+
+  /* Shifted storage is for the single fluid distribution only */
+  if (opts->ndist == 2 && opts->shifted) valid = 0;
+
+  /* In-place (AA) streaming relies on a full halo */
+  if (opts->schedule == LB_SCHEDULE_AA &&
+      opts->halo == LB_HALO_OPENMP_REDUCED) valid = 0;
+
+  /* The fluid site list is for the split schedule only */
+  if (opts->fluidlist && opts->schedule != LB_SCHEDULE_SPLIT) valid = 0;
+
+  /* Sparse storage is single fluid, split schedule, host halo only */
+  if (opts->sparse && opts->ndist != 1) valid = 0;
+  if (opts->sparse && opts->schedule != LB_SCHEDULE_SPLIT) valid = 0;
+  if (opts->sparse && opts->halo == LB_HALO_TARGET) valid = 0;
+
+  /* Overlapped collision/halo uses the host (non-blocking) halo */
+  if (opts->schedule == LB_SCHEDULE_OVERLAP &&
+      opts->halo == LB_HALO_TARGET) valid = 0;
+
   return valid;
 }
@@ -5,7 +5,7 @@
  *  Edinburgh Soft Matter and Statistical Physics Group and
  *  Edinburgh Parallel Computing Centre
  *
- *  (c) 2022 The University of Edinburgh
+ *  (c) 2022-2024 The University of Edinburgh
  *
  *  Contributing authors:
  *  Kevin Stratford (kevin@epcc.ed.ac.uk)
@@ -26,6 +26,11 @@ typedef enum lb_halo_enum {LB_HALO_TARGET,
                            LB_HALO_OPENMP_FULL,
                            LB_HALO_OPENMP_REDUCED} lb_halo_enum_t;
 
+typedef enum lb_schedule_enum {LB_SCHEDULE_SPLIT,
+                               LB_SCHEDULE_FUSED,
+                               LB_SCHEDULE_AA,
+                               LB_SCHEDULE_OVERLAP} lb_schedule_enum_t;
+
 typedef struct lb_data_options_s lb_data_options_t;
 
 struct lb_data_options_s {
@@ -34,6 +39,11 @@ struct lb_data_options_s {
   int ndist;
   lb_relaxation_enum_t nrelax;
   lb_halo_enum_t halo;
+  lb_schedule_enum_t schedule;
+  int shifted;                      /* Store f_p - wv[p]*rho0 */
+  double rho0;                      /* Reference density if shifted */
+  int fluidlist;                    /* Collide/propagate fluid blocks only */
+  int sparse;                       /* Store fluid sites only */
   int reportimbalance;
   int usefirsttouch;
 
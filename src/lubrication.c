@@ -24,6 +24,7 @@
 #include "coords.h"
 #include "physics.h"
 #include "colloids.h"
+#include "colloid_pair_list.h"
 #include "lubrication.h"
 
 struct lubrication_s {
@@ -33,8 +34,15 @@ struct lubrication_s {
   double rch[LUBRICATION_SS_MAX];    /* Cut offs for different components */
   double rrch[LUBRICATION_SS_MAX];   /* Table of reciprocal cut offs */
   double rchmax;
+  int nranmax;                       /* Capacity of ran[] (pairs) */
+  double * ran;                      /* Random numbers per pair [2*n] */
 };
 
+static int lubrication_pair(const lubr_t * lubr, double a1, double a2,
+			    const double u1[3], const double u2[3],
+			    const double r12[3], const double ran[2],
+			    double f[3]);
+
 /*****************************************************************************
  *
  *  lubrication_create
@@ -70,6 +78,7 @@ int lubrication_free(lubr_t * obj) {
 
   assert(obj);
 
+  free(obj->ran);
   free(obj);
 
   return 0;
@@ -87,68 +96,69 @@ int lubrication_compute(colloids_info_t * cinfo, void * self) {
 
   lubr_t * obj = (lubr_t *) self;
 
-  int ic1, jc1, kc1, ic2, jc2, kc2;
-  int di[2], dj[2], dk[2];
-  int ncell[3];
-
-  double ran[2];  /* Random numbers for fluctuation dissipation correction */
-  double r12[3];
-  double f[3];
   double ltot[3];
+  double hminlocal = 0.0;
 
-  colloid_t * pc1;
-  colloid_t * pc2;
+  colloid_pair_list_t * plist = NULL;
 
   assert(cinfo);
   assert(obj);
 
   cs_ltot(obj->cs, ltot);
 
-  obj->hminlocal = ltot[X];
-  colloids_info_ncell(cinfo, ncell);
+  hminlocal = ltot[X];
 
-  for (ic1 = 1; ic1 <= ncell[X]; ic1++) {
-    colloids_info_climits(cinfo, X, ic1, di); 
-    for (jc1 = 1; jc1 <= ncell[Y]; jc1++) {
-      colloids_info_climits(cinfo, Y, jc1, dj);
-      for (kc1 = 1; kc1 <= ncell[Z]; kc1++) {
-        colloids_info_climits(cinfo, Z, kc1, dk);
+  /* Pairs from the shared Verlet list (see interact_pairwise()) */
 
-        colloids_info_cell_list_head(cinfo, ic1, jc1, kc1, &pc1);
-        for (; pc1; pc1 = pc1->next) {
+  plist = cinfo->plist;
+  assert(plist);
 
-          for (ic2 = di[0]; ic2 <= di[1]; ic2++) {
-            for (jc2 = dj[0]; jc2 <= dj[1]; jc2++) {
-              for (kc2 = dk[0]; kc2 <= dk[1]; kc2++) {
-   
-                colloids_info_cell_list_head(cinfo, ic2, jc2, kc2, &pc2);
-                for (; pc2; pc2 = pc2->next) {
+  if (plist->npair > obj->nranmax) {
+    int nmax = plist->npairmax;
+    double * tmp = (double *) realloc(obj->ran, 2*nmax*sizeof(double));
+    if (tmp == NULL) pe_fatal(obj->pe, "realloc(lubrication ran) failed\n");
+    obj->ran = tmp;
+    obj->nranmax = nmax;
+  }
 
-                  if (pc1->s.index >= pc2->s.index) continue;
+  /* Random numbers for fluctuation dissipation correction. These
+   * come from the state of pc1, so are drawn in pair order first.
+   * Only pairs which are in range draw, so that the sequence does
+   * not depend on the extent of the list. */
 
-                  cs_minimum_distance(obj->cs, pc1->s.r, pc2->s.r, r12);
-		  util_ranlcg_reap_gaussian(&pc1->s.rng, ran);
+  for (int n = 0; n < plist->npair; n++) {
 
-		  lubrication_single(obj, pc1->s.ah, pc2->s.ah, pc1->s.v,
-				     pc2->s.v, r12, ran, f);
+    colloid_t * pc1 = plist->pair[n].pc1;
+    colloid_t * pc2 = plist->pair[n].pc2;
+    double * ran = obj->ran + 2*n;
 
-		  pc1->force[X] += f[X];
-		  pc1->force[Y] += f[Y];
-		  pc1->force[Z] += f[Z];
+    ran[0] = 0.0;
+    ran[1] = 0.0;
+    if (modulus(plist->pair[n].r12) - pc1->s.ah - pc2->s.ah < obj->rchmax) {
+      util_ranlcg_reap_gaussian(&pc1->s.rng, ran);
+    }
+  }
 
-		  pc2->force[X] -= f[X];
-		  pc2->force[Y] -= f[Y];
-		  pc2->force[Z] -= f[Z];
+  /* The force on pc1 for each pair is stored and added afterwards. */
 
-		}
-	      }
-	    }
-	  }
-	}
-      }
-    }
+  #pragma omp parallel for reduction(min: hminlocal)
+  for (int n = 0; n < plist->npair; n++) {
+
+    colloid_t * pc1 = plist->pair[n].pc1;
+    colloid_t * pc2 = plist->pair[n].pc2;
+    const double * r12 = plist->pair[n].r12;
+    double hr = modulus(r12) - pc1->s.ah - pc2->s.ah;
+
+    if (hr < hminlocal) hminlocal = hr;
+
+    lubrication_pair(obj, pc1->s.ah, pc2->s.ah, pc1->s.v, pc2->s.v, r12,
+		     obj->ran + 2*n, plist->f12 + 3*n);
   }
 
+  colloid_pair_list_force_add(plist);
+
+  obj->hminlocal = hminlocal;
+
   return 0;
 }
 
@@ -240,6 +250,31 @@ int lubrication_rchmax(lubr_t * obj, double * rchmax) {
 int lubrication_single(lubr_t * lubr, double a1, double a2,
 		       const double u1[3], const double u2[3],
 		       const double r12[3], const double ran[2], double f[3]) {
+  double hr;       /* Reduced separation */
+
+  assert(lubr);
+
+  hr = modulus(r12) - a1 - a2;
+  if (hr < lubr->hminlocal) lubr->hminlocal = hr;
+
+  lubrication_pair(lubr, a1, a2, u1, u2, r12, ran, f);
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  lubrication_pair
+ *
+ *  As lubrication_single(), but does not update the minimum separation
+ *  (so may be called concurrently for different pairs).
+ *
+ *****************************************************************************/
+
+static int lubrication_pair(const lubr_t * lubr, double a1, double a2,
+			    const double u1[3], const double u2[3],
+			    const double r12[3], const double ran[2],
+			    double f[3]) {
   int ia;
   double h;        /* Separation */
   double hr;       /* Reduced separation */
@@ -261,7 +296,6 @@ int lubrication_single(lubr_t * lubr, double a1, double a2,
 
   h = modulus(r12);
   hr = h - a1 - a2;
-  if (hr < lubr->hminlocal) lubr->hminlocal = hr;
 
   if (hr < lubr->rch[LUBRICATION_SS_FNORM]) {
 
@@ -79,6 +79,7 @@
 #include "cahn_hilliard_stats.h"
 #include "leslie_ericksen.h"
 #include "blue_phase_beris_edwards.h"
+#include "blue_phase_fused.h"
 
 /* Colloids */
 #include "colloids_rt.h"
@@ -140,6 +141,7 @@ struct ludwig_s {
   field_grad_t * p_grad;    /* Gradients for p */
   field_grad_t * q_grad;    /* Gradients for q */
   psi_t * psi;              /* Electrokinetics */
+  nernst_planck_t * np;     /* Nernst Planck workspace */
   map_t * map;              /* Site map for fluid/solid status etc. */
   wall_t * wall;            /* Side walls / Porous media */
   noise_t * noise;          /* Generator for fluctuations */
@@ -153,6 +155,7 @@ struct ludwig_s {
   beris_edw_t * be;            /* Beris Edwards dynamics */
   pth_t * pth;                 /* Thermodynamic stress/force calculation */
   fe_lc_t * fe_lc;             /* LC free energy */
+  fe_lc_fused_t * lc_fused;    /* LC fused molecular field/force */
   fe_symm_t * fe_symm;         /* Symmetric free energy */
   fe_surf_t * fe_surf;         /* Surfactant (van der Graf etc) */
   fe_ternary_t * fe_ternary;   /* Ternary (Semprebon et al.) */
@@ -183,6 +186,9 @@ static int ludwig_report_momentum(ludwig_t * ludwig);
 static int ludwig_report_statistics(ludwig_t * ludwig, int itimestep);
 static int ludwig_colloids_update(ludwig_t * ludwig);
 static int ludwig_colloids_update_low_freq(ludwig_t * ludwig);
+static lb_schedule_enum_t ludwig_lb_schedule(ludwig_t * ludwig);
+static int ludwig_lb_sparse(ludwig_t * ludwig);
+static int ludwig_lc_fused(ludwig_t * ludwig);
 
 int ludwig_timekeeper_init(ludwig_t * ludwig);
 int free_energy_init_rt(ludwig_t * ludwig);
@@ -277,6 +283,22 @@ static int ludwig_rt(ludwig_t * ludwig) {
 		   &ludwig->lb->model);
   colloids_init_ewald_rt(pe, rt, cs, ludwig->collinfo, &ludwig->ewald);
 
+  /* The stress is not stored by the recompute method, so there is
+   * nothing available for the colloid or wall boundaries. */
+  if (ludwig->pth && ludwig->pth->method == FE_FORCE_METHOD_STRESS_RECOMPUTE) {
+    int ncolloid = 0;
+    int is_pm = 0;
+    colloids_info_ntotal(ludwig->collinfo, &ncolloid);
+    wall_is_pm(ludwig->wall, &is_pm);
+    if (ncolloid > 0 || wall_present(ludwig->wall) || is_pm) {
+      pe_info(pe, "stress_divergence_recompute is fluid only\n");
+      pe_fatal(pe, "Please use stress_divergence with colloids or walls\n");
+    }
+  }
+
+  /* Sparse distribution storage requires the final map */
+  if (ludwig->lb->opts.sparse) ludwig_lb_sparse(ludwig);
+
   bbl_create(pe, ludwig->cs, ludwig->lb, &ludwig->bbl);
   bbl_active_set(ludwig->bbl, ludwig->collinfo);
   {
@@ -370,6 +392,7 @@ static int ludwig_rt(ludwig_t * ludwig) {
   if (ludwig->q) {
     gradient_rt_init(pe, rt, "q", ludwig->q_grad, ludwig->map,
 		     ludwig->collinfo);
+    if (rt_switch(rt, "lc_fused_pipeline")) ludwig_lc_fused(ludwig);
   }
 
   stats_rheology_create(pe, cs, &ludwig->stat_rheo);
@@ -440,6 +463,7 @@ void ludwig_run(const char * inputfile) {
   double  uzero[3] = {0.0, 0.0, 0.0};
   int     im, multisteps;
   int	  flag;
+  lb_schedule_enum_t lb_schedule = LB_SCHEDULE_SPLIT;
 
   ludwig_t * ludwig = NULL;
   MPI_Comm comm;
@@ -508,6 +532,21 @@ void ludwig_run(const char * inputfile) {
   pe_info(ludwig->pe, "Initial conditions.\n");
   wall_is_pm(ludwig->wall, &is_porous_media);
 
+  lb_schedule = ludwig_lb_schedule(ludwig);
+
+  if (ludwig->hydro && ludwig->lb->opts.fluidlist) {
+    /* The map must be static thereafter, so no colloids */
+    if (ncolloid > 0) {
+      pe_info(ludwig->pe, "Fluid site list not available with colloids: "
+	      "all sites are visited.\n");
+    }
+    else {
+      lb_data_fluid_list(ludwig->lb, ludwig->map);
+      pe_info(ludwig->pe, "Fluid site list: %d SIMD blocks contain fluid\n",
+	      ludwig->lb->nblock);
+    }
+  }
+
   ludwig_report_statistics(ludwig, 0);
   ludwig_report_momentum(ludwig);
 
@@ -547,7 +586,7 @@ void ludwig_run(const char * inputfile) {
 
     if (im == 2) phi_lb_to_field(ludwig->phi, ludwig->lb);
 
-    if (ludwig->phi) {
+    if (ludwig->phi && (ludwig->phi_inflow || ludwig->phi_outflow)) {
 
       TIMER_start(TIMER_PHI_HALO);
       field_halo(ludwig->phi);
@@ -567,6 +606,10 @@ void ludwig_run(const char * inputfile) {
 
       field_grad_compute(ludwig->phi_grad);
     }
+    else if (ludwig->phi) {
+      /* Halo swap may be overlapped with the gradient computation */
+      field_grad_halo_compute(ludwig->phi_grad);
+    }
 
     if (ludwig->p) {
       field_halo(ludwig->p);
@@ -574,11 +617,14 @@ void ludwig_run(const char * inputfile) {
     }
 
     if (ludwig->q) {
-      TIMER_start(TIMER_PHI_HALO);
-      field_halo(ludwig->q);
-      TIMER_stop(TIMER_PHI_HALO);
-
-      field_grad_compute(ludwig->q_grad);
+      if (ludwig->lc_fused && !is_statistics_step() &&
+	  !fe_lc_fused_q_grad_required(ludwig->lc_fused)) {
+	/* Gradients are computed on the fly by the fused pass */
+	field_halo(ludwig->q);
+      }
+      else {
+	field_grad_halo_compute(ludwig->q_grad);
+      }
       fe_lc_redshift_compute(ludwig->cs, ludwig->fe_lc);
     }
     TIMER_stop(TIMER_PHI_GRADIENTS);
@@ -616,14 +662,22 @@ void ludwig_run(const char * inputfile) {
 
       /* Time splitting for high electrokinetic diffusions in Nernst Planck */
 
+      /* The charge densities stay on the target for the multistep loop;
+       * psi is unchanged, so its halo is required once only. */
+
       psi_multisteps(ludwig->psi, &multisteps);
 
       for (im = 0; im < multisteps; im++) {
 
 	TIMER_start(TIMER_HALO_LATTICE);
-	psi_halo_psi(ludwig->psi);
-	psi_halo_psijump(ludwig->psi);
-	psi_halo_rho(ludwig->psi);
+	if (im == 0) {
+	  psi_halo_psi(ludwig->psi);
+	  psi_halo_psijump(ludwig->psi);
+	  psi_halo_rho(ludwig->psi);
+	}
+	else {
+	  field_halo(ludwig->psi->rho);
+	}
 	TIMER_stop(TIMER_HALO_LATTICE);
 
 	/* Force calculation is only once per LB timestep */
@@ -650,12 +704,17 @@ void ludwig_run(const char * inputfile) {
 	}
 
 	TIMER_start(TIMER_ELECTRO_NPEQ);
-	nernst_planck_driver_d3qx(ludwig->psi, ludwig->fe, ludwig->hydro,
-				  ludwig->map, ludwig->collinfo);
+	if (im == 0) {
+	  nernst_planck_mu_compute(ludwig->np, ludwig->psi, ludwig->fe);
+	}
+	nernst_planck_step(ludwig->np, ludwig->psi, ludwig->hydro,
+			   ludwig->map);
 	TIMER_stop(TIMER_ELECTRO_NPEQ);
 
       }
 
+      field_memcpy(ludwig->psi->rho, tdpMemcpyDeviceToHost);
+
       TIMER_start(TIMER_HALO_LATTICE);
       psi_halo_psi(ludwig->psi);
       psi_halo_psijump(ludwig->psi);
@@ -704,10 +763,16 @@ void ludwig_run(const char * inputfile) {
 
 	  /* Force calculation as divergence of stress tensor */
 
-          phi_force_calculation(ludwig->pe, ludwig->cs, ludwig->le,
-				ludwig->wall,
-                                ludwig->pth, ludwig->fe, ludwig->map,
-                                ludwig->phi, ludwig->hydro);
+	  if (ludwig->lc_fused) {
+	    /* Also provides the molecular field for beris_edw_update() */
+	    fe_lc_fused_compute(ludwig->lc_fused, ludwig->hydro);
+	  }
+	  else {
+	    phi_force_calculation(ludwig->pe, ludwig->cs, ludwig->le,
+				  ludwig->wall,
+				  ludwig->pth, ludwig->fe, ludwig->map,
+				  ludwig->phi, ludwig->hydro);
+	  }
 
 	  /* Ternary free energy gradmu requires of momentum correction
 	     after force calculation */
@@ -802,7 +867,16 @@ void ludwig_run(const char * inputfile) {
 
       TIMER_start(TIMER_HALO_LATTICE);
 
-      lb_halo(ludwig->lb);
+      /* An odd AA step has streamed into the halo */
+      if (lb_schedule == LB_SCHEDULE_AA && ludwig->lb->fpending == 0) {
+	lb_halo_reverse(ludwig->lb);
+      }
+      else if (lb_schedule == LB_SCHEDULE_OVERLAP) {
+	/* Halo swap already completed in the collision */
+      }
+      else {
+	lb_halo(ludwig->lb);
+      }
 
       TIMER_stop(TIMER_HALO_LATTICE);
 
@@ -846,12 +920,31 @@ void ludwig_run(const char * inputfile) {
 
     if (ludwig->hydro) {
       TIMER_start(TIMER_PROPAGATE);
-      lb_propagation(ludwig->lb);
+      if (lb_schedule == LB_SCHEDULE_FUSED) {
+	lb_propagation_defer(ludwig->lb);
+      }
+      else if (lb_schedule == LB_SCHEDULE_SPLIT ||
+	       lb_schedule == LB_SCHEDULE_OVERLAP) {
+	lb_propagation(ludwig->lb);
+      }
+      /* LB_SCHEDULE_AA: propagation is part of the collision */
       TIMER_stop(TIMER_PROPAGATE);
     }
 
     TIMER_start(TIMER_DIAGNOSTIC_OUTPUT); /* Time diagnostics and i/o */
 
+    /* Any output or statistics involving the distributions require
+     * a deferred propagation to be completed. */
+
+    if (lb_schedule == LB_SCHEDULE_FUSED || lb_schedule == LB_SCHEDULE_AA) {
+      if (is_config_step() || is_measurement_step() ||
+	  is_shear_measurement_step() || is_statistics_step()) {
+	TIMER_start(TIMER_PROPAGATE);
+	lb_propagation_flush(ludwig->lb);
+	TIMER_stop(TIMER_PROPAGATE);
+      }
+    }
+
     /* Configuration dump */
 
     if (is_config_step()) {
@@ -965,6 +1058,7 @@ void ludwig_run(const char * inputfile) {
   /* Shut down cleanly. Give the timer statistics. Finalise PE. */
 
   if (ludwig->poisson) ludwig->poisson->impl->free(&ludwig->poisson);
+  if (ludwig->np) nernst_planck_free(ludwig->np);
   if (ludwig->psi) psi_free(&ludwig->psi);
 
   if (ludwig->stat_rheo) stats_rheology_free(ludwig->stat_rheo);
@@ -973,6 +1067,7 @@ void ludwig_run(const char * inputfile) {
 
   if (ludwig->phi_grad) field_grad_free(ludwig->phi_grad);
   if (ludwig->p_grad)   field_grad_free(ludwig->p_grad);
+  if (ludwig->lc_fused) fe_lc_fused_free(ludwig->lc_fused);
   if (ludwig->q_grad)   field_grad_free(ludwig->q_grad);
   if (ludwig->phi)      field_free(ludwig->phi);
   if (ludwig->p)        field_free(ludwig->p);
@@ -1021,6 +1116,201 @@ void ludwig_run(const char * inputfile) {
   return;
 }
 
+/*****************************************************************************
+ *
+ *  ludwig_lb_sparse
+ *
+ *  Allocate sparse storage for the distributions following the
+ *  map (see lb_data_sparse()). This is before any initial
+ *  conditions are set, or read from file.
+ *
+ *  The map must be static, and the only boundary condition at solid
+ *  sites must be stationary bounce-back: so no colloids, no moving
+ *  or slip walls, no Lees-Edwards planes and no open boundaries.
+ *  There is no fallback, as the dense storage has not been allocated.
+ *
+ *****************************************************************************/
+
+static int ludwig_lb_sparse(ludwig_t * ludwig) {
+
+  int ncolloid = 0;
+  int nplane = 0;
+  int available = 1;
+
+  assert(ludwig);
+  assert(ludwig->lb);
+  assert(ludwig->map);
+
+  colloids_info_ntotal(ludwig->collinfo, &ncolloid);
+  if (ludwig->le) nplane = lees_edw_nplane_total(ludwig->le);
+
+  if (ncolloid > 0) available = 0;
+  if (nplane > 0) available = 0;
+  if (ludwig->inflow || ludwig->outflow) available = 0;
+
+  if (ludwig->wall) {
+    wall_param_t param = {0};
+    wall_param(ludwig->wall, &param);
+    if (param.slip.active) available = 0;
+    for (int ia = 0; ia < 3; ia++) {
+      if (param.ubot[ia] != 0.0 || param.utop[ia] != 0.0) available = 0;
+    }
+  }
+
+  if (available == 0) {
+    pe_fatal(ludwig->pe, "Sparse storage (lb_sparse_storage) is not "
+	     "available with colloids, moving or slip walls, Lees Edwards "
+	     "planes, or open boundaries.\n");
+  }
+
+  map_halo(ludwig->map);
+  lb_data_sparse(ludwig->lb, ludwig->map);
+
+  {
+    int nlocal[3] = {0};
+    cs_nlocal(ludwig->cs, nlocal);
+    pe_info(ludwig->pe, "Sparse storage: %d of %d local sites stored "
+	    "(rank 0)\n", ludwig->lb->nfluid, nlocal[X]*nlocal[Y]*nlocal[Z]);
+  }
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  ludwig_lc_fused
+ *
+ *  Liquid crystal: compute the molecular field and the force on the
+ *  fluid in one tiled pass (see blue_phase_fused.c). The gradients
+ *  of Q_ab are then only computed if required for statistics (or
+ *  for active stress or redshift update).
+ *
+ *  Fluid only, 3d_7pt_fluid gradients, and the stress divergence.
+ *
+ *****************************************************************************/
+
+static int ludwig_lc_fused(ludwig_t * ludwig) {
+
+  int ncolloid = 0;
+  int nplane = 0;
+  int is_pm = 0;
+  int available = 1;
+  int ndevice = 0;
+  int tile[3] = {8, 8, 32};
+
+  assert(ludwig);
+  assert(ludwig->q_grad);
+
+  colloids_info_ntotal(ludwig->collinfo, &ncolloid);
+  if (ludwig->le) nplane = lees_edw_nplane_total(ludwig->le);
+  wall_is_pm(ludwig->wall, &is_pm);
+  tdpGetDeviceCount(&ndevice);
+
+  if (ludwig->fe == NULL || ludwig->fe->id != FE_LC) available = 0;
+  if (ludwig->pth == NULL ||
+      ludwig->pth->method != FE_FORCE_METHOD_STRESS_DIVERGENCE) available = 0;
+  if (ludwig->q_grad->d2 != grad_3d_7pt_fluid_d2) available = 0;
+  if (ncolloid > 0 || nplane > 0) available = 0;
+  if (wall_present(ludwig->wall) || is_pm) available = 0;
+  if (ndevice > 0) available = 0;
+
+  if (available == 0) {
+    pe_fatal(ludwig->pe, "The fused pipeline (lc_fused_pipeline) is only "
+	     "available for lc_blue_phase with 3d_7pt_fluid gradients, "
+	     "the stress divergence force method, no colloids, walls, "
+	     "or Lees Edwards planes, and host execution.\n");
+  }
+
+  rt_int_parameter_vector(ludwig->rt, "lc_fused_tile", tile);
+
+  fe_lc_fused_create(ludwig->pe, ludwig->cs, ludwig->fe_lc, ludwig->be,
+		     tile, &ludwig->lc_fused);
+
+  pe_info(ludwig->pe, "Fused LC pipeline:  on (tile %d %d %d)\n",
+	  tile[X], tile[Y], tile[Z]);
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  ludwig_lb_schedule
+ *
+ *  Return the collision/propagation schedule to be used. The fused
+ *  and in-place (AA) schedules are available only if requested and
+ *  if the configuration allows; otherwise LB_SCHEDULE_SPLIT.
+ *
+ *  The fused schedule defers propagation until the next collision,
+ *  and the AA schedule propagates only on alternate steps, so f is
+ *  not in the propagated state at the start of the step. They are
+ *  therefore only available if there are no stages which need the
+ *  propagated f, or an up-to-date post-collision halo between
+ *  collision and propagation: bounce-back on links for colloids or
+ *  walls, Lees-Edwards planes, and open boundaries.
+ *
+ *  As there is no fprime for AA, there is no fallback: it's an
+ *  error to request AA if it's not available.
+ *
+ *  The overlap schedule completes the halo swap as part of the
+ *  collision, but is otherwise the same as split. Only the
+ *  Lees-Edwards boundary conditions, which must be applied before
+ *  the halo swap, prevent its use.
+ *
+ *****************************************************************************/
+
+static lb_schedule_enum_t ludwig_lb_schedule(ludwig_t * ludwig) {
+
+  lb_schedule_enum_t schedule = LB_SCHEDULE_SPLIT;
+
+  assert(ludwig);
+
+  if (ludwig->hydro && ludwig->lb->opts.schedule != LB_SCHEDULE_SPLIT) {
+
+    int ncolloid = 0;
+    int is_pm = 0;
+    int nplane = 0;
+    int available = 1;
+
+    colloids_info_ntotal(ludwig->collinfo, &ncolloid);
+    wall_is_pm(ludwig->wall, &is_pm);
+    if (ludwig->le) nplane = lees_edw_nplane_total(ludwig->le);
+
+    if (ludwig->lb->ndist != 1) available = 0;
+    if (ncolloid > 0) available = 0;
+    if (wall_present(ludwig->wall) || is_pm) available = 0;
+    if (nplane > 0) available = 0;
+    if (ludwig->inflow || ludwig->outflow) available = 0;
+
+    if (ludwig->lb->opts.schedule == LB_SCHEDULE_OVERLAP) {
+      /* Propagated as for split; only LE planes need a second halo
+       * swap after the collision. */
+      available = (ludwig->lb->ndist == 1 && nplane == 0);
+    }
+
+    if (available) {
+      schedule = ludwig->lb->opts.schedule;
+    }
+    else if (ludwig->lb->opts.schedule == LB_SCHEDULE_OVERLAP) {
+      /* Collision must revert to the standard launch */
+      pe_info(ludwig->pe, "Overlapped collision/halo not available "
+	      "with Lees Edwards planes: using split schedule.\n");
+      ludwig->lb->opts.schedule = LB_SCHEDULE_SPLIT;
+    }
+    else if (ludwig->lb->opts.schedule == LB_SCHEDULE_AA) {
+      pe_fatal(ludwig->pe, "In-place (AA) streaming is not available "
+	       "with colloids, walls, Lees Edwards planes, or open "
+	       "boundaries. Please use lb_schedule split.\n");
+    }
+    else {
+      pe_info(ludwig->pe, "Fused collision/propagation not available "
+	      "with colloids, walls, Lees Edwards planes, or open "
+	      "boundaries: using split schedule.\n");
+    }
+  }
+
+  return schedule;
+}
+
 /*****************************************************************************
  *
  *  ludwig_report_momentum
@@ -1201,6 +1491,7 @@ int free_energy_init_rt(ludwig_t * ludwig) {
       switch (method) {
       case FE_FORCE_METHOD_NO_FORCE:
       case FE_FORCE_METHOD_STRESS_DIVERGENCE:
+      case FE_FORCE_METHOD_STRESS_RECOMPUTE:
       case FE_FORCE_METHOD_PHI_GRADMU:
       case FE_FORCE_METHOD_PHI_GRADMU_CORRECTION:
 	break;
@@ -1278,6 +1569,7 @@ int free_energy_init_rt(ludwig_t * ludwig) {
       switch (method) {
       case FE_FORCE_METHOD_NO_FORCE:
       case FE_FORCE_METHOD_STRESS_DIVERGENCE:
+      case FE_FORCE_METHOD_STRESS_RECOMPUTE:
       case FE_FORCE_METHOD_PHI_GRADMU:
       case FE_FORCE_METHOD_PHI_GRADMU_CORRECTION:
 	break;
@@ -1385,6 +1677,7 @@ int free_energy_init_rt(ludwig_t * ludwig) {
       /* The following are supported */
       switch (method) {
       case FE_FORCE_METHOD_STRESS_DIVERGENCE:
+      case FE_FORCE_METHOD_STRESS_RECOMPUTE:
       case FE_FORCE_METHOD_PHI_GRADMU:
       case FE_FORCE_METHOD_PHI_GRADMU_CORRECTION:
 	break;
@@ -1457,6 +1750,7 @@ int free_energy_init_rt(ludwig_t * ludwig) {
       /* The following are possible (if not tested) */
       switch (method) {
       case FE_FORCE_METHOD_STRESS_DIVERGENCE:
+      case FE_FORCE_METHOD_STRESS_RECOMPUTE:
       case FE_FORCE_METHOD_PHI_GRADMU:
       case FE_FORCE_METHOD_PHI_GRADMU_CORRECTION:
 	break;
@@ -1536,6 +1830,7 @@ int free_energy_init_rt(ludwig_t * ludwig) {
       /* The following are supported */
       switch (method) {
       case FE_FORCE_METHOD_STRESS_DIVERGENCE:
+      case FE_FORCE_METHOD_STRESS_RECOMPUTE:
       case FE_FORCE_METHOD_PHI_GRADMU:
       case FE_FORCE_METHOD_PHI_GRADMU_CORRECTION:
 	break;
@@ -1602,6 +1897,7 @@ int free_energy_init_rt(ludwig_t * ludwig) {
       /* The following are supported */
       switch (method) {
       case FE_FORCE_METHOD_STRESS_DIVERGENCE:
+      case FE_FORCE_METHOD_STRESS_RECOMPUTE:
 	break;
       case FE_FORCE_METHOD_RELAXATION_ANTI:
 	fe->super.use_stress_relaxation = 1;
@@ -1761,6 +2057,7 @@ int free_energy_init_rt(ludwig_t * ludwig) {
       /* The following are supported */
       switch (method) {
       case FE_FORCE_METHOD_STRESS_DIVERGENCE:
+      case FE_FORCE_METHOD_STRESS_RECOMPUTE:
 	break;
       case FE_FORCE_METHOD_RELAXATION_ANTI:
 	fe->super.use_stress_relaxation = 1;
@@ -1843,6 +2140,7 @@ int free_energy_init_rt(ludwig_t * ludwig) {
       psi_create(pe, cs, &opts, &ludwig->psi);
       psi_force_method_set(ludwig->psi, psi_method);
       psi_info(pe, ludwig->psi);
+      nernst_planck_create(pe, cs, ludwig->psi, &ludwig->np);
     }
 
     pe_info(pe, "Force calculation:      %s\n",
@@ -1927,6 +2225,7 @@ int free_energy_init_rt(ludwig_t * ludwig) {
       psi_create(pe, cs, &opts, &ludwig->psi);
       psi_info(pe, ludwig->psi);
       psi_bjerrum_length2(&opts, &lbjerrum2);
+      nernst_planck_create(pe, cs, ludwig->psi, &ludwig->np);
     }
     fe_electro_create(pe, ludwig->psi, &fe_elec);
 
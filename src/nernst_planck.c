@@ -57,7 +57,7 @@
  *  Edinbrugh Soft Matter and Statistical Physics Group and
  *  Edinburgh Parallel Computing Centre
  *
- *  (c) 2012-2023 The University of Edinburgh
+ *  (c) 2012-2024 The University of Edinburgh
  *
  *  Contributing authors:
  *  Kevin Stratford (kevin@epcc.ed.ac.uk)
@@ -66,16 +66,48 @@
  *****************************************************************************/
 
 #include <assert.h>
+#include <limits.h>
 #include <math.h>
 #include <stdlib.h>
 
 #include "pe.h"
 #include "coords.h"
+#include "kernel.h"
+#include "util.h"
 #include "advection.h"
 #include "advection_bcs.h"
 #include "nernst_planck.h"
 #include "psi_gradients.h"
 
+#define NP_NPOINTS_MAX 27  /* Largest stencil (d3q27) */
+
+struct nernst_planck_s {
+  pe_t * pe;                /* Parallel environment */
+  cs_t * cs;                /* Coordinate system */
+  int nk;                   /* Number of species */
+  int nsites;               /* Number of sites (including halo) */
+  int nflux;                /* Number of links per site (npoints - 1) */
+  double * mu;              /* Excess chemical potential (host) */
+  double * mu_d;            /* Excess chemical potential (target) */
+  double * flx_d;           /* Fluxes (target) */
+  double * maxacc_d;        /* Maximum relative change (target) */
+};
+
+/* Kernel parameters (passed by value) */
+
+typedef struct np_param_s np_param_t;
+
+struct np_param_s {
+  int nk;                   /* Number of species */
+  int nsites;               /* Number of sites */
+  int nflux;                /* Number of links per site */
+  int xs, ys, zs;           /* Strides */
+  int8_t cv[NP_NPOINTS_MAX][3];     /* Stencil vectors */
+  double rcs[4];                    /* 1/|c| indexed by c^2 */
+  double diffusivity[PSI_NKMAX];    /* Per species */
+  double dt;                        /* Multistep time step */
+};
+
 /* This needs an input switch to make it active. */
 int nernst_planck_fluxes_force_d3qx(psi_t * psi, fe_t * fe, hydro_t * hydro, 
 		map_t * map, colloids_info_t * cinfo, double ** flx);
@@ -87,20 +119,23 @@ static int nernst_planck_no_flux_condition(map_t * map, int nk, double * fx,
 					   double * fy, double * fz);
 static int nernst_planck_update(psi_t * psi, double * fe, double * fy,
 				double * fz);
-static int nernst_planck_fluxes_d3qx(psi_t * psi, fe_t * fe, hydro_t * hydro, 
-		map_t * map, colloids_info_t * cinfo, double ** flx);
-static int nernst_planck_update_d3qx(psi_t * psi, 
-				map_t * map, double ** flx);
 static double max_acc; 
 
-int np_advective_fluxes(psi_t * psi, hydro_t * hydro, double ** flux);
-int np_no_flux_boundary(psi_t * psi, map_t * map, double ** flux);
+__global__ void nernst_planck_flux_kernel_v(kernel_3d_v_t k3v,
+					    np_param_t np,
+					    field_t * rho, double * mu,
+					    hydro_t * hydro, map_t * map,
+					    double * flx);
+__global__ void nernst_planck_update_kernel_v(kernel_3d_v_t k3v,
+					      np_param_t np,
+					      field_t * rho, map_t * map,
+					      double * flx, double * maxacc);
 
 /*****************************************************************************
  *
  *  nernst_planck_driver
  *
- *  No hydrodynamics (use nernst_plancj_driver_d3qx instead).
+ *  No hydrodynamics (use nernst_planck_step() instead).
  *  Allows for a no-flux condition between solid and fluid sites.
  *
  *****************************************************************************/
@@ -336,163 +371,386 @@ static int nernst_planck_update(psi_t * psi, double * fx, double * fy,
 
 /*****************************************************************************
  *
- *  nernst_planck_driver_d3qx
- *
- *  The hydro object is allowed to be NULL, in which case there is
- *  no advection.
+ *  nernst_planck_create
  *
- *  The map object is allowed to be NULL, in which case no boundary
- *  condition corrections are attempted.
+ *  Workspace for the D3QX update, which runs on the target. This holds
+ *  the fluxes (one per stencil link per species) and a table of the
+ *  excess chemical potential (in units of kT) at each site.
  *
  *****************************************************************************/
 
-int nernst_planck_driver_d3qx(psi_t * psi, fe_t * fe, hydro_t * hydro, 
-			      map_t * map, colloids_info_t * cinfo) {
+int nernst_planck_create(pe_t * pe, cs_t * cs, psi_t * psi,
+			 nernst_planck_t ** pobj) {
 
-  int nk;              /* Number of electrolyte species */
-  int ia;
+  nernst_planck_t * obj = NULL;
 
-  double ** flx = NULL;
+  assert(pe);
+  assert(cs);
+  assert(psi);
+  assert(pobj);
 
-  psi_nk(psi, &nk);
+  obj = (nernst_planck_t *) calloc(1, sizeof(nernst_planck_t));
+  assert(obj);
+  if (obj == NULL) pe_fatal(pe, "calloc(nernst_planck_t) failed\n");
 
-  /* Allocate fluxes and initialise to zero */
-  flx = (double **) calloc((size_t) psi->nsites*nk, sizeof(double *));
-  assert(flx);
-  if (flx == NULL) pe_fatal(psi->pe, "calloc(flx) failed\n");
+  obj->pe = pe;
+  obj->cs = cs;
+  obj->nk = psi->nk;
+  obj->nsites = psi->nsites;
+  obj->nflux = psi->stencil->npoints - 1;
 
-  for (ia = 0; ia < psi->nsites*nk; ia++) {
-    int nflux = psi->stencil->npoints;
-    flx[ia] = (double *) calloc(nflux-1, sizeof(double));
-    assert(flx[ia]);
-    if (flx[ia] == NULL) pe_fatal(psi->pe, "calloc(flx[]) failed\n");
-  }
+  assert(obj->nk <= PSI_NKMAX);
+  assert(psi->stencil->npoints <= NP_NPOINTS_MAX);
 
-  /* Add advective fluxes */
-  if (hydro) np_advective_fluxes(psi, hydro, flx);
+  if (INT_MAX/(obj->nk*obj->nflux) < obj->nsites) {
+    pe_fatal(pe, "nernst_planck_create: failure in int32_t indexing\n");
+  }
 
-  /* Add diffusive fluxes */
-  nernst_planck_fluxes_d3qx(psi, fe, hydro, map, cinfo, flx);
-  
-  /* Apply no-flux BC */
-  if (map) np_no_flux_boundary(psi, map, flx);
+  {
+    size_t nmu  = (size_t) obj->nsites*obj->nk;
+    size_t nflx = nmu*obj->nflux;
 
-  /* Update charges */
-  nernst_planck_update_d3qx(psi, map, flx);
+    obj->mu = (double *) calloc(nmu, sizeof(double));
+    assert(obj->mu);
+    if (obj->mu == NULL) pe_fatal(pe, "calloc(nernst_planck_t mu) failed\n");
 
-  for (ia = 0; ia < psi->nsites*nk; ia++) {
-    free(flx[ia]);
+    tdpAssert(tdpMalloc((void **) &obj->mu_d, nmu*sizeof(double)));
+    tdpAssert(tdpMalloc((void **) &obj->flx_d, nflx*sizeof(double)));
+    tdpAssert(tdpMalloc((void **) &obj->maxacc_d, sizeof(double)));
   }
-  free(flx);
+
+  *pobj = obj;
 
   return 0;
 }
 
 /*****************************************************************************
  *
- *  nernst_planck_fluxes_d3qx
- *
- *  Compute diffusive fluxes.
- *
- *  We assume we can accumulate the diffusive and advective fluxes separately.
- *
- *  As we compute rho(n+1) = rho(n) - div.flux in the update routine,
- *  there is an extra minus sign in the fluxes here. This conincides
- *  with the sign of the advective fluxes, if present.
+ *  nernst_planck_free
  *
  *****************************************************************************/
 
-static int nernst_planck_fluxes_d3qx(psi_t * psi, fe_t * fe, hydro_t * hydro, 
-				     map_t * map, colloids_info_t * cinfo,
-				     double ** flx) {
+int nernst_planck_free(nernst_planck_t * np) {
 
-  int ic, jc, kc; 
-  int index0, index1;
-  int nlocal[3];
-  int n, nk; /* Number of charged species */
-  int c;
-  int status1;
+  assert(np);
 
-  double b0, b1;
-  double mu0, mu1;
-  double rho0, rho1;
-  double mu_s0, mu_s1;   /* Solvation chemical potential, from free energy */
-  
-  double eunit, reunit;
-  double dt;
+  tdpAssert(tdpFree(np->maxacc_d));
+  tdpAssert(tdpFree(np->flx_d));
+  tdpAssert(tdpFree(np->mu_d));
+  free(np->mu);
+  free(np);
 
-  colloid_t * pc = NULL;
+  return 0;
+}
 
-  double * __restrict__ psidata = psi->psi->data;
-  double * __restrict__ rhodata = psi->rho->data;
+/*****************************************************************************
+ *
+ *  nernst_planck_mu_compute
+ *
+ *  Tabulate the excess chemical potential
+ *
+ *    beta mu_k^ex = (1/e) mu_k^solv + valency_k psi
+ *
+ *  at all sites and copy to the target. Neither psi nor the solvation
+ *  term changes during the multistep loop, so this is required only
+ *  once per LB step (after the psi halo swap). The solvation
+ *  potential comes from the free energy on the host.
+ *
+ *****************************************************************************/
 
-  LB_RCS_TABLE(rcs);
+int nernst_planck_mu_compute(nernst_planck_t * np, psi_t * psi, fe_t * fe) {
 
+  int nk = 0;
+  int nsites = 0;
+  double eunit = 0.0;
+  double reunit = 0.0;
+
+  assert(np);
   assert(psi);
   assert(fe);
   assert(fe->func->mu_solv);
-  assert(flx);
 
-  cs_nlocal(psi->cs, nlocal);
+  nk = np->nk;
+  nsites = np->nsites;
 
   psi_unit_charge(psi, &eunit);
   reunit = 1.0/eunit;
 
-  psi_nk(psi, &nk);
-  psi_multistep_timestep(psi, &dt);
+  for (int index = 0; index < nsites; index++) {
+    double psi0 = psi->psi->data[addr_rank0(nsites, index)];
+    for (int n = 0; n < nk; n++) {
+      double mu_s = 0.0;
+      fe->func->mu_solv(fe, index, n, &mu_s);
+      np->mu[addr_rank1(nsites, nk, index, n)]
+	= reunit*mu_s + psi->valency[n]*psi0;
+    }
+  }
 
+  tdpAssert(tdpMemcpy(np->mu_d, np->mu, (size_t) nsites*nk*sizeof(double),
+		      tdpMemcpyHostToDevice));
 
-  for (ic = 1; ic <= nlocal[X]; ic++) {
-    for (jc = 1; jc <= nlocal[Y]; jc++) {
-      for (kc = 1; kc <= nlocal[Z]; kc++) {
+  return 0;
+}
 
-	index0 = cs_index(psi->cs, ic, jc, kc);
-        colloids_info_map(cinfo, index0, &pc);
+/*****************************************************************************
+ *
+ *  nernst_planck_step
+ *
+ *  One (multi)step of the D3QX update on the target: fluxes with the
+ *  no-flux condition at solid sites, then the Euler forward update.
+ *  The charge densities must be current on the target (including
+ *  halos), and remain on the target; mu must have been computed via
+ *  nernst_planck_mu_compute().
+ *
+ *  The hydro object is allowed to be NULL, in which case there is
+ *  no advection.
+ *
+ *****************************************************************************/
 
-	if (pc) {
-	  continue;
+int nernst_planck_step(nernst_planck_t * np, psi_t * psi, hydro_t * hydro,
+		       map_t * map) {
+
+  int nlocal[3] = {0};
+  double maxacc = 0.0;
+  hydro_t * hydrotarget = NULL;
+  np_param_t param = {0};
+
+  assert(np);
+  assert(psi);
+  assert(map);
+
+  cs_nlocal(np->cs, nlocal);
+  cs_strides(np->cs, &param.xs, &param.ys, &param.zs);
+
+  param.nk = np->nk;
+  param.nsites = np->nsites;
+  param.nflux = np->nflux;
+  psi_multistep_timestep(psi, &param.dt);
+
+  {
+    LB_RCS_TABLE(rcs);
+    stencil_t * s = psi->stencil;
+
+    for (int p = 0; p <= param.nflux; p++) {
+      param.cv[p][X] = s->cv[p][X];
+      param.cv[p][Y] = s->cv[p][Y];
+      param.cv[p][Z] = s->cv[p][Z];
+    }
+    for (int ic = 0; ic < 4; ic++) {
+      param.rcs[ic] = rcs[ic];
+    }
+    for (int n = 0; n < param.nk; n++) {
+      param.diffusivity[n] = psi->diffusivity[n];
+    }
+  }
+
+  if (hydro) hydrotarget = hydro->target;
+
+  tdpAssert(tdpMemcpy(np->maxacc_d, &maxacc, sizeof(double),
+		      tdpMemcpyHostToDevice));
+
+  {
+    dim3 nblk = {};
+    dim3 ntpb = {};
+    cs_limits_t lim = {1, nlocal[X], 1, nlocal[Y], 1, nlocal[Z]};
+    kernel_3d_v_t k3v = kernel_3d_v(np->cs, lim, NSIMDVL);
+
+    kernel_3d_launch_param(k3v.kiterations, &nblk, &ntpb);
+
+    tdpLaunchKernel(nernst_planck_flux_kernel_v, nblk, ntpb, 0, 0,
+		    k3v, param, psi->rho->target, np->mu_d, hydrotarget,
+		    map->target, np->flx_d);
+    tdpAssert(tdpPeekAtLastError());
+
+    tdpLaunchKernel(nernst_planck_update_kernel_v, nblk, ntpb, 0, 0,
+		    k3v, param, psi->rho->target, map->target, np->flx_d,
+		    np->maxacc_d);
+    tdpAssert(tdpPeekAtLastError());
+    tdpAssert(tdpDeviceSynchronize());
+  }
+
+  tdpAssert(tdpMemcpy(&maxacc, np->maxacc_d, sizeof(double),
+		      tdpMemcpyDeviceToHost));
+  nernst_planck_maxacc_set(maxacc);
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  nernst_planck_flux_kernel_v
+ *
+ *  Advective and diffusive fluxes on each link from fluid sites.
+ *
+ *  The advective flux is a 'centred difference' on the link. As we
+ *  compute rho(n+1) = rho(n) - div.flux in the update, there is an
+ *  extra minus sign in the diffusive fluxes.
+ *
+ *  The total flux (advective and diffusive) on a link with a solid
+ *  (wall or colloid) end is zero: this is the no normal flux condition
+ *  as applied previously by np_no_flux_boundary().
+ *
+ *****************************************************************************/
+
+__global__ void nernst_planck_flux_kernel_v(kernel_3d_v_t k3v,
+					    np_param_t np,
+					    field_t * rho, double * mu,
+					    hydro_t * hydro, map_t * map,
+					    double * flx) {
+  int kindex = 0;
+
+  assert(rho);
+  assert(mu);
+  assert(map);
+  assert(flx);
+
+  for_simt_parallel(kindex, k3v.kiterations, NSIMDVL) {
+
+    int iv = 0;
+    int index = k3v.kindex0 + kindex;
+    int ic[NSIMDVL], jc[NSIMDVL], kc[NSIMDVL];
+    int maskv[NSIMDVL];
+    double u0[3][NSIMDVL] = {0};
+
+    kernel_3d_v_coords(&k3v, kindex, ic, jc, kc);
+    kernel_3d_v_mask(&k3v, ic, jc, kc, maskv);
+
+    for_simd_v(iv, NSIMDVL) {
+      if (maskv[iv] && map->status[index + iv] != MAP_FLUID) maskv[iv] = 0;
+    }
+
+    if (hydro) {
+      for (int ia = 0; ia < 3; ia++) {
+	for_simd_v(iv, NSIMDVL) {
+	  if (maskv[iv]) {
+	    int iaddr = addr_rank1(hydro->nsite, NHDIM, index + iv, ia);
+	    u0[ia][iv] = hydro->u->data[iaddr];
+	  }
 	}
-	else {
-	  stencil_t * s = psi->stencil;
-	  assert(s);
+      }
+    }
 
-	  for (c = 1; c < s->npoints; c++) {
+    for (int p = 1; p <= np.nflux; p++) {
 
-	    int8_t cx  = s->cv[c][X];
-	    int8_t cy  = s->cv[c][Y];
-	    int8_t cz  = s->cv[c][Z];
-	    int8_t pcv = cx*cx + cy*cy + cz*cz;
+      int8_t cx = np.cv[p][X];
+      int8_t cy = np.cv[p][Y];
+      int8_t cz = np.cv[p][Z];
+      int di = cx*np.xs + cy*np.ys + cz*np.zs;
+      double rcs = np.rcs[cx*cx + cy*cy + cz*cz];
 
-	    index1 = cs_index(psi->cs, ic + cx, jc + cy, kc + cz);
-	    map_status(map, index1, &status1);
+      for_simd_v(iv, NSIMDVL) {
+	if (maskv[iv]) {
+	  int index0 = index + iv;
+	  int index1 = index0 + di;
+	  double mask = (map->status[index1] == MAP_FLUID);
+	  double u = 0.0;
 
-	    if (status1 == MAP_FLUID) {
+	  if (hydro) {
+	    double u1[3] = {0};
+	    for (int ia = 0; ia < 3; ia++) {
+	      int iaddr = addr_rank1(hydro->nsite, NHDIM, index1, ia);
+	      u1[ia] = hydro->u->data[iaddr];
+	    }
+	    u = 0.5*((u0[X][iv] + u1[X])*cx + (u0[Y][iv] + u1[Y])*cy
+		     + (u0[Z][iv] + u1[Z])*cz);
+	  }
 
-	      for (n = 0; n < nk; n++) {
+	  for (int n = 0; n < np.nk; n++) {
+	    double rho0 = rho->data[addr_rank1(np.nsites, np.nk, index0, n)];
+	    double rho1 = rho->data[addr_rank1(np.nsites, np.nk, index1, n)];
+	    double flux = 0.0;
 
-		fe->func->mu_solv(fe, index0, n, &mu_s0);
-		mu0 = reunit*mu_s0
-		  + psi->valency[n]*psidata[addr_rank0(psi->nsites, index0)];
-		rho0 = rhodata[addr_rank1(psi->nsites, nk, index0, n)];
+	    if (hydro) flux = u*0.5*(rho0 + rho1);
 
-		fe->func->mu_solv(fe, index1, n, &mu_s1);
-		mu1 = reunit*mu_s1
-		  + psi->valency[n]* psidata[addr_rank0(psi->nsites, index1)];
-		b0 = exp(mu0 - mu1);
-		b1 = exp(mu1 - mu0);
-		rho1 = rhodata[addr_rank1(psi->nsites, nk, index1, n)]*b1;
-
-		flx[addr_rank1(psi->nsites, nk, index0, n)][c - 1]
-		  -= psi->diffusivity[n]*0.5*(1.0 + b0)*(rho1 - rho0)*rcs[pcv];
-	      }
+	    if (mask) {
+	      double mu0 = mu[addr_rank1(np.nsites, np.nk, index0, n)];
+	      double mu1 = mu[addr_rank1(np.nsites, np.nk, index1, n)];
+	      double b0 = exp(mu0 - mu1);
+	      double b1 = exp(mu1 - mu0);
+	      flux -= np.diffusivity[n]*0.5*(1.0 + b0)*(rho1*b1 - rho0)*rcs;
 	    }
+
+	    flx[addr_rank2(np.nsites, np.nk, np.nflux, index0, n, p-1)]
+	      = flux*mask;
 	  }
-        }
+	}
       }
     }
+    /* Next sites */
   }
 
-  return 0;
+  return;
+}
+
+/*****************************************************************************
+ *
+ *  nernst_planck_update_kernel_v
+ *
+ *  Update the rho_k at fluid sites from the fluxes. Euler forward step.
+ *  The maximum relative change (see nernst_planck_maxacc_set()) is
+ *  accumulated in maxacc.
+ *
+ *****************************************************************************/
+
+__global__ void nernst_planck_update_kernel_v(kernel_3d_v_t k3v,
+					      np_param_t np,
+					      field_t * rho, map_t * map,
+					      double * flx, double * maxacc) {
+  int kindex = 0;
+  int tid = threadIdx.x;
+  __shared__ double bmax[TARGET_MAX_THREADS_PER_BLOCK];
+
+  assert(rho);
+  assert(map);
+  assert(flx);
+  assert(maxacc);
+
+  bmax[tid] = 0.0;
+
+  for_simt_parallel(kindex, k3v.kiterations, NSIMDVL) {
+
+    int iv = 0;
+    int index = k3v.kindex0 + kindex;
+    int ic[NSIMDVL], jc[NSIMDVL], kc[NSIMDVL];
+    int maskv[NSIMDVL];
+
+    kernel_3d_v_coords(&k3v, kindex, ic, jc, kc);
+    kernel_3d_v_mask(&k3v, ic, jc, kc, maskv);
+
+    for_simd_v(iv, NSIMDVL) {
+      if (maskv[iv] && map->status[index + iv] != MAP_FLUID) maskv[iv] = 0;
+    }
+
+    for_simd_v(iv, NSIMDVL) {
+      if (maskv[iv]) {
+	int index0 = index + iv;
+	for (int n = 0; n < np.nk; n++) {
+	  int iaddr = addr_rank1(np.nsites, np.nk, index0, n);
+	  double acc = 0.0;
+	  for (int p = 0; p < np.nflux; p++) {
+	    int iflx = addr_rank2(np.nsites, np.nk, np.nflux, index0, n, p);
+	    double f = flx[iflx];
+	    rho->data[iaddr] -= f*np.dt;
+	    acc += fabs(f*np.dt);
+	  }
+	  acc /= fabs(rho->data[iaddr]);
+	  if (bmax[tid] < acc) bmax[tid] = acc;
+	}
+      }
+    }
+  }
+
+  __syncthreads();
+
+  if (tid == 0) {
+    double bmaxacc = 0.0;
+    for (int it = 0; it < blockDim.x; it++) {
+      bmaxacc = dmax(bmaxacc, bmax[it]);
+    }
+    tdpAtomicMaxDouble(maxacc, bmaxacc);
+  }
+
+  return;
 }
 
 /*****************************************************************************
@@ -675,66 +933,6 @@ int nernst_planck_fluxes_force_d3qx(psi_t * psi, fe_t * fe, hydro_t * hydro,
   return 0;
 }
 
-/*****************************************************************************
- *
- *  nernst_planck_update_d3qx
- *
- *  Update the rho_k from the fluxes (D3QX stencil). Euler forward step.
- *
- *****************************************************************************/
-
-static int nernst_planck_update_d3qx(psi_t * psi, map_t * map, double ** flx) {
-
-  int ic, jc, kc, index;
-  int nsites;
-  int nlocal[3];
-  int n, nk;
-  int c;
-  int status;
-  double acc, maxacc=0.0;
-  double dt;
-
-  assert(psi);
-  assert(flx);
-
-  cs_nsites(psi->cs, &nsites);
-  cs_nlocal(psi->cs, nlocal);
-
-  psi_nk(psi, &nk);
-  psi_multistep_timestep(psi, &dt);
-
-  for (ic = 1; ic <= nlocal[X]; ic++) {
-    for (jc = 1; jc <= nlocal[Y]; jc++) {
-      for (kc = 1; kc <= nlocal[Z]; kc++) {
-
-	index = cs_index(psi->cs, ic, jc, kc);
-        map_status(map, index, &status);
-
-        if (status == MAP_FLUID) {
-	  stencil_t * s = psi->stencil;
-	  for (n = 0; n < nk; n++) {
-
-	    acc = 0.0;
-	    for (c = 1; c < s->npoints; c++) {
-	      psi->rho->data[addr_rank1(nsites, nk, index, n)]
-		-= flx[addr_rank1(nsites, nk, index, n)][c - 1] * dt;
-	      acc += fabs(flx[addr_rank1(nsites, nk, index, n)][c - 1] * dt);
-	    }
-
-	    acc /= fabs(psi->rho->data[addr_rank1(nsites, nk, index, n)]);
-	    if (maxacc < acc) maxacc = acc; 
-	  }
-	}
-
-      }
-    }
-  }
-
-  nernst_planck_maxacc_set(maxacc);
-
-  return 0;
-}
-
 /*****************************************************************************
  *
  *  nernst_planck_maxacc_set
@@ -821,125 +1019,3 @@ int nernst_planck_adjust_multistep(psi_t * psi) {
 
   return 0;
 } 
-
-/*****************************************************************************
- *
- *  np_advective_fluxes
- *
- *  'Centred difference' advective fluxes for the char densities rho.
- *
- *  Symmetric two-point stencil.
- *
- *****************************************************************************/
-
-int np_advective_fluxes(psi_t * psi, hydro_t * hydro, double ** flx) {
-
-  int nlocal[3] = {0};
-  cs_t * cs = NULL;
-  stencil_t * s = NULL;
-
-  double * __restrict__ rho = psi->rho->data;
-
-  assert(psi);
-  assert(hydro);
-  assert(flx);
-
-  cs = psi->cs;
-  s = psi->stencil;
-  assert(cs);
-  assert(s);
-
-  cs_nlocal(cs, nlocal);
-
-  for (int ic = 1; ic <= nlocal[X]; ic++) {
-    for (int jc = 1; jc <= nlocal[Y]; jc++) {
-      for (int kc = 1; kc <= nlocal[Z]; kc++) {
-
-	int index0 = cs_index(cs, ic, jc, kc);
-	double u0[3] = {0};
-	hydro_u(hydro, index0, u0);
-
-        for (int p = 1; p < s->npoints; p++) {
-
-	  int8_t cx = s->cv[p][X];
-	  int8_t cy = s->cv[p][Y];
-	  int8_t cz = s->cv[p][Z];
-	  int index1 = cs_index(cs, ic + cx, jc + cy, kc + cz);
-	  double u1[3] = {0};
-	  double u = 0.0;
-	  hydro_u(hydro, index1, u1);
-
-	  u = 0.5*((u0[X]+u1[X])*cx + (u0[Y]+u1[Y])*cy + (u0[Z]+u1[Z])*cz);
-
-	  for (int n = 0; n < psi->nk; n++) {
-	    double rho0 = rho[addr_rank1(psi->nsites, psi->nk, index0, n)];
-	    double rho1 = rho[addr_rank1(psi->nsites, psi->nk, index1, n)];
-	    double flux = u*0.5*(rho0 + rho1);
-	    flx[addr_rank1(psi->nsites, psi->nk, index0, n)][p-1] = flux;
-	  }
-	}
-	/* Next site */
-      }
-    }
-  }
-
-  return 0;
-}
-
-/*****************************************************************************
- *
- *  advective_bcs_no_flux_d3qx
- *
- *  Set normal fluxes at solid fluid interfaces to zero.
- *
- *****************************************************************************/
-
-int np_no_flux_boundary(psi_t * psi, map_t * map, double ** flx) {
-
-  int nlocal[3] = {0};
-  cs_t * cs = NULL;
-  stencil_t * s = NULL;
-
-  assert(psi);
-  assert(map);
-  assert(flx);
-
-  cs = psi->cs;
-  s  = psi->stencil;
-  assert(cs);
-  assert(s);
-
-  cs_nlocal(cs, nlocal);
-
-  for (int ic = 1; ic <= nlocal[X]; ic++) {
-    for (int jc = 1; jc <= nlocal[Y]; jc++) {
-      for (int kc = 1; kc <= nlocal[Z]; kc++) {
-
-	int index0 = cs_index(cs, ic, jc, kc);
-	int mask0  = 1;
-	int status = MAP_BOUNDARY;
-	map_status(map, index0, &status);
-	mask0 = (status == MAP_FLUID);
-
-	for (int p = 1; p < s->npoints; p++) {
-
-	  int8_t cx = s->cv[p][X];
-	  int8_t cy = s->cv[p][Y];
-	  int8_t cz = s->cv[p][Z];
-	  int index1 = cs_index(cs, ic + cx, jc + cy, kc + cz);
-	  int mask = 1;
-
-	  map_status(map, index1, &status);
-	  mask = (status == MAP_FLUID);
-	  mask = mask*mask0;
-
-	  for (int n = 0;  n < psi->nk; n++) {
-	    flx[addr_rank1(psi->nsites, psi->nk, index0, n)][p-1] *= mask;
-	  }
-	}
-      }
-    }
-  }
-
-  return 0;
-}
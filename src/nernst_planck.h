@@ -5,7 +5,7 @@
  *  Edinburgh Soft Matter and Statistical Physics Group and
  *  Edinburgh Parallel Computing Centre
  *
- *  (c) 2012-2022 The University of Edinburgh
+ *  (c) 2012-2024 The University of Edinburgh
  *
  *  Kevin Stratford (kevin@epcc.ed.ac.uk)
  *
@@ -20,9 +20,16 @@
 #include "map.h"
 #include "colloids.h"
 
+typedef struct nernst_planck_s nernst_planck_t;
+
+int nernst_planck_create(pe_t * pe, cs_t * cs, psi_t * psi,
+			 nernst_planck_t ** np);
+int nernst_planck_free(nernst_planck_t * np);
+int nernst_planck_mu_compute(nernst_planck_t * np, psi_t * psi, fe_t * fe);
+int nernst_planck_step(nernst_planck_t * np, psi_t * psi, hydro_t * hydro,
+		       map_t * map);
+
 int nernst_planck_driver(psi_t * psi, fe_t * fe, map_t * map);
-int nernst_planck_driver_d3qx(psi_t * psi, fe_t * fe, hydro_t * hydro,
-			      map_t * map, colloids_info_t * cinfo);
 int nernst_planck_adjust_multistep(psi_t * psi);
 
 int nernst_planck_maxacc(double * acc);
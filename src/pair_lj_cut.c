@@ -32,6 +32,7 @@
 #include "util.h"
 #include "coords.h"
 #include "colloids.h"
+#include "colloid_pair_list.h"
 #include "pair_lj_cut.h"
 
 struct pair_lj_cut_s {
@@ -149,32 +150,24 @@ int pair_lj_cut_compute(colloids_info_t * cinfo, void * self) {
 
   pair_lj_cut_t * obj = (pair_lj_cut_t *) self;
 
-  int ic1, jc1, kc1, ic2, jc2, kc2;
-  int di[2], dj[2], dk[2];
-  int ncell[3];
-
-  double r2;
-  double r;
   double rr;
   double rs;
   double vcut;
   double dvcut;
-  double r12[3];
-  double f, h;
   double ltot[3];
+  double vlocal = 0.0;
+  double rminlocal = 0.0;
+  double hminlocal = 0.0;
 
-  colloid_t * pc1;
-  colloid_t * pc2;
+  colloid_pair_list_t * plist = NULL;
 
   assert(cinfo);
   assert(self);
 
   cs_ltot(obj->cs, ltot);
-  colloids_info_ncell(cinfo, ncell);
 
-  obj->vlocal = 0.0;
-  obj->rminlocal = dmax(ltot[X], dmax(ltot[Y], ltot[Z]));
-  obj->hminlocal = obj->rminlocal;
+  rminlocal = dmax(ltot[X], dmax(ltot[Y], ltot[Z]));
+  hminlocal = rminlocal;
 
   rr = 1.0/obj->rc;
   rs = pow(obj->sigma*rr, 6);
@@ -182,62 +175,55 @@ int pair_lj_cut_compute(colloids_info_t * cinfo, void * self) {
   vcut = 4.0*obj->epsilon*(rs*rs - rs);
   dvcut = -24.0*rr*obj->epsilon*(2.0*rs*rs - rs);
 
-  for (ic1 = 1; ic1 <= ncell[X]; ic1++) {
-    colloids_info_climits(cinfo, X, ic1, di); 
-    for (jc1 = 1; jc1 <= ncell[Y]; jc1++) {
-      colloids_info_climits(cinfo, Y, jc1, dj);
-      for (kc1 = 1; kc1 <= ncell[Z]; kc1++) {
-        colloids_info_climits(cinfo, Z, kc1, dk);
-
-        colloids_info_cell_list_head(cinfo, ic1, jc1, kc1, &pc1);
-        for (; pc1; pc1 = pc1->next) {
+  /* Pairs from the shared Verlet list (see interact_pairwise()).
+   * The force on pc1 for each pair is stored and added afterwards. */
 
-          for (ic2 = di[0]; ic2 <= di[1]; ic2++) {
-            for (jc2 = dj[0]; jc2 <= dj[1]; jc2++) {
-              for (kc2 = dk[0]; kc2 <= dk[1]; kc2++) {
-   
-                colloids_info_cell_list_head(cinfo, ic2, jc2, kc2, &pc2);
-                for (; pc2; pc2 = pc2->next) {
+  plist = cinfo->plist;
+  assert(plist);
 
-		  if (pc1->s.index >= pc2->s.index) continue;
+  #pragma omp parallel for reduction(+: vlocal) \
+    reduction(min: rminlocal, hminlocal)
+  for (int n = 0; n < plist->npair; n++) {
 
-		  cs_minimum_distance(obj->cs, pc1->s.r, pc2->s.r, r12);
-		  r2 = r12[X]*r12[X] + r12[Y]*r12[Y] + r12[Z]*r12[Z];
+    colloid_t * pc1 = plist->pair[n].pc1;
+    colloid_t * pc2 = plist->pair[n].pc2;
+    const double * r12 = plist->pair[n].r12;
+    double * f12 = plist->f12 + 3*n;
+    double r, h, f, rrn, rsn;
 
-		  r = sqrt(r2);
+    f12[X] = 0.0;
+    f12[Y] = 0.0;
+    f12[Z] = 0.0;
 
-		  /* Record both rmin and hmin */
-		  if (r < obj->rminlocal) obj->rminlocal = r;
-		  h = r - pc1->s.ah -pc2->s.ah;
-		  if (h < obj->hminlocal) obj->hminlocal = h;
+    r = sqrt(r12[X]*r12[X] + r12[Y]*r12[Y] + r12[Z]*r12[Z]);
 
-		  if (r > obj->rc) continue;
+    /* Record both rmin and hmin */
+    if (r < rminlocal) rminlocal = r;
+    h = r - pc1->s.ah -pc2->s.ah;
+    if (h < hminlocal) hminlocal = h;
 
-		  rr = 1.0/r;
-		  rs = pow(obj->sigma*rr, 6);
+    if (r > obj->rc) continue;
 
-		  /* Potential, force */
+    rrn = 1.0/r;
+    rsn = pow(obj->sigma*rrn, 6);
 
-		  obj->vlocal += 4.0*obj->epsilon*(rs*rs - rs) - vcut
-		    - (r - obj->rc)*dvcut;
-		  f = -(-24.0*rr*obj->epsilon*(2.0*rs*rs - rs) - dvcut);
+    /* Potential, force */
 
-		  pc1->force[X] -= f*r12[X]*rr;
-		  pc1->force[Y] -= f*r12[Y]*rr;
-		  pc1->force[Z] -= f*r12[Z]*rr;
-		  pc2->force[X] += f*r12[X]*rr;
-		  pc2->force[Y] += f*r12[Y]*rr;
-		  pc2->force[Z] += f*r12[Z]*rr;
+    vlocal += 4.0*obj->epsilon*(rsn*rsn - rsn) - vcut
+      - (r - obj->rc)*dvcut;
+    f = -(-24.0*rrn*obj->epsilon*(2.0*rsn*rsn - rsn) - dvcut);
 
-		}
-	      }
-	    }
-	  }
-	}
-      }
-    }
+    f12[X] = -(f*r12[X]*rrn);
+    f12[Y] = -(f*r12[Y]*rrn);
+    f12[Z] = -(f*r12[Z]*rrn);
   }
 
+  colloid_pair_list_force_add(plist);
+
+  obj->vlocal = vlocal;
+  obj->rminlocal = rminlocal;
+  obj->hminlocal = hminlocal;
+
   return 0;
 }
 
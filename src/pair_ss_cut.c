@@ -39,6 +39,7 @@
 #include "coords.h"
 #include "physics.h"
 #include "colloids.h"
+#include "colloid_pair_list.h"
 #include "pair_ss_cut.h"
 
 struct pair_ss_cut_s {
@@ -166,90 +167,80 @@ int pair_ss_cut_compute(colloids_info_t * cinfo, void * obj) {
 
   pair_ss_cut_t * self = (pair_ss_cut_t *) obj;
 
-  int ic1, jc1, kc1, ic2, jc2, kc2;
-  int di[2], dj[2], dk[2];
-  int ncell[3];
-
-  double r;                             /* centre-centre sepration */
-  double h;                             /* surface-surface separation */
-  double rh;                            /* reciprocal h */
   double rsigma;                        /* reciproal sigma */
   double vcut;                          /* potential at cut off */
   double dvcut;                         /* derivative at cut off */
-  double r12[3];                        /* centre-centre min distance 1->2 */
-  double f;
   double ltot[3];
+  double vlocal = 0.0;
+  double rminlocal = 0.0;
+  double hminlocal = 0.0;
 
-  colloid_t * pc1;
-  colloid_t * pc2;
+  colloid_pair_list_t * plist = NULL;
 
   assert(cinfo);
   assert(self);
 
   cs_ltot(self->cs, ltot);
 
-  self->vlocal = 0.0;
-  self->hminlocal = dmax(ltot[X], dmax(ltot[Y], ltot[Z]));
-  self->rminlocal = self->hminlocal;
+  hminlocal = dmax(ltot[X], dmax(ltot[Y], ltot[Z]));
+  rminlocal = hminlocal;
 
   rsigma = 1.0/self->sigma;
   vcut = self->epsilon*pow(self->sigma/self->hc, self->nu);
   dvcut = -self->epsilon*self->nu*rsigma*pow(self->sigma/self->hc, self->nu+1);
 
-  colloids_info_ncell(cinfo, ncell);
-
-  for (ic1 = 1; ic1 <= ncell[X]; ic1++) {
-    colloids_info_climits(cinfo, X, ic1, di); 
-    for (jc1 = 1; jc1 <= ncell[Y]; jc1++) {
-      colloids_info_climits(cinfo, Y, jc1, dj);
-      for (kc1 = 1; kc1 <= ncell[Z]; kc1++) {
-        colloids_info_climits(cinfo, Z, kc1, dk);
-
-        colloids_info_cell_list_head(cinfo, ic1, jc1, kc1, &pc1);
-        for (; pc1; pc1 = pc1->next) {
-
-          for (ic2 = di[0]; ic2 <= di[1]; ic2++) {
-            for (jc2 = dj[0]; jc2 <= dj[1]; jc2++) {
-              for (kc2 = dk[0]; kc2 <= dk[1]; kc2++) {
-   
-		colloids_info_cell_list_head(cinfo, ic2, jc2, kc2, &pc2);
-                for (; pc2; pc2 = pc2->next) {
-
-                  if (pc1->s.index >= pc2->s.index) continue;
-
-		  cs_minimum_distance(self->cs, pc1->s.r, pc2->s.r, r12);
-		  r = sqrt(r12[X]*r12[X] + r12[Y]*r12[Y] + r12[Z]*r12[Z]);
-		  if (r < self->rminlocal) self->rminlocal = r;
-
-		  h = r - pc1->s.ah - pc2->s.ah;
-		  if (h < self->hminlocal) self->hminlocal = h;
-
-		  if (h > self->hc) continue;
-		  assert(h > 0.0);
-
-		  rh = 1.0/h;
-
-		  self->vlocal += self->epsilon*pow(rh*self->sigma, self->nu)
-		    - vcut - (h - self->hc)*dvcut;
-		  f = -(-self->epsilon*self->nu*rsigma
-			*pow(rh*self->sigma, self->nu+1) - dvcut);
-
-		  rh = 1.0/r;
-		  pc1->force[X] -= f*r12[X]*rh;
-		  pc1->force[Y] -= f*r12[Y]*rh;
-		  pc1->force[Z] -= f*r12[Z]*rh;
-		  pc2->force[X] += f*r12[X]*rh;
-		  pc2->force[Y] += f*r12[Y]*rh;
-		  pc2->force[Z] += f*r12[Z]*rh;
-		}
-	      }
-	    }
-	  }
-	}
-      }
-    }
+  /* Pairs from the shared Verlet list (see interact_pairwise()).
+   * The force on pc1 for each pair is stored and added afterwards. */
+
+  plist = cinfo->plist;
+  assert(plist);
+
+  #pragma omp parallel for reduction(+: vlocal) \
+    reduction(min: rminlocal, hminlocal)
+  for (int n = 0; n < plist->npair; n++) {
+
+    colloid_t * pc1 = plist->pair[n].pc1;
+    colloid_t * pc2 = plist->pair[n].pc2;
+    const double * r12 = plist->pair[n].r12;
+    double * f12 = plist->f12 + 3*n;
+
+    double r;                           /* centre-centre sepration */
+    double h;                           /* surface-surface separation */
+    double rh;                          /* reciprocal h */
+    double f;
+
+    f12[X] = 0.0;
+    f12[Y] = 0.0;
+    f12[Z] = 0.0;
+
+    r = sqrt(r12[X]*r12[X] + r12[Y]*r12[Y] + r12[Z]*r12[Z]);
+    if (r < rminlocal) rminlocal = r;
+
+    h = r - pc1->s.ah - pc2->s.ah;
+    if (h < hminlocal) hminlocal = h;
+
+    if (h > self->hc) continue;
+    assert(h > 0.0);
+
+    rh = 1.0/h;
+
+    vlocal += self->epsilon*pow(rh*self->sigma, self->nu)
+      - vcut - (h - self->hc)*dvcut;
+    f = -(-self->epsilon*self->nu*rsigma
+	  *pow(rh*self->sigma, self->nu+1) - dvcut);
+
+    rh = 1.0/r;
+    f12[X] = -(f*r12[X]*rh);
+    f12[Y] = -(f*r12[Y]*rh);
+    f12[Z] = -(f*r12[Z]*rh);
   }
 
+  colloid_pair_list_force_add(plist);
+
+  self->vlocal = vlocal;
+  self->rminlocal = rminlocal;
+  self->hminlocal = hminlocal;
+
   return 0;
 }
 
@@ -29,6 +29,7 @@
 #include "coords.h"
 #include "physics.h"
 #include "colloids.h"
+#include "colloid_pair_list.h"
 #include "pair_yukawa.h"
 
 struct pair_yukawa_s {
@@ -156,82 +157,71 @@ int pair_yukawa_compute(colloids_info_t * cinfo, void * self) {
 
   pair_yukawa_t * obj = (pair_yukawa_t *) self;
 
-  int ic1, jc1, kc1, ic2, jc2, kc2;
-  int di[2], dj[2], dk[2];
-  int ncell[3];
-
-  double r12[3];
-  double f;
-  double r, h, rr;
   double vcut;
   double dvcut;
   double ltot[3];
+  double vlocal = 0.0;
+  double rminlocal = 0.0;
+  double hminlocal = 0.0;
 
-  colloid_t * pc1;
-  colloid_t * pc2;
+  colloid_pair_list_t * plist = NULL;
 
   assert(cinfo);
   assert(obj);
 
   cs_ltot(obj->cs, ltot);
-  colloids_info_ncell(cinfo, ncell);
 
   vcut = obj->epsilon*exp(-obj->kappa*obj->rc)/obj->rc;
   dvcut = -vcut*(1.0/obj->rc + obj->kappa);
 
-  obj->vlocal = 0.0;
-  obj->rminlocal = ltot[X];
-  obj->hminlocal = ltot[X];
-
-  for (ic1 = 1; ic1 <= ncell[X]; ic1++) {
-    colloids_info_climits(cinfo, X, ic1, di); 
-    for (jc1 = 1; jc1 <= ncell[Y]; jc1++) {
-      colloids_info_climits(cinfo, Y, jc1, dj);
-      for (kc1 = 1; kc1 <= ncell[Z]; kc1++) {
-        colloids_info_climits(cinfo, Z, kc1, dk);
-
-        colloids_info_cell_list_head(cinfo, ic1, jc1, kc1, &pc1);
-        for (; pc1; pc1 = pc1->next) {
-
-          for (ic2 = di[0]; ic2 <= di[1]; ic2++) {
-            for (jc2 = dj[0]; jc2 <= dj[1]; jc2++) {
-              for (kc2 = dk[0]; kc2 <= dk[1]; kc2++) {
-   
-                colloids_info_cell_list_head(cinfo, ic2, jc2, kc2, &pc2);
-                for (; pc2; pc2 = pc2->next) {
-
-                  if (pc1->s.index >= pc2->s.index) continue;
-
-                  cs_minimum_distance(obj->cs, pc1->s.r, pc2->s.r, r12);
-		  r = sqrt(r12[X]*r12[X] + r12[Y]*r12[Y] + r12[Z]*r12[Z]);
-
-		  if (r < obj->rminlocal) obj->rminlocal = r;
-		  h = r - pc1->s.ah - pc2->s.ah;
-		  if (h < obj->hminlocal) obj->hminlocal = h;
-		  if (r >= obj->rc) continue;
-
-		  rr = 1.0/r;
-		  f = -(-obj->epsilon*exp(-obj->kappa*r)*rr*(rr + obj->kappa)
-			- dvcut);
-
-		  pc1->force[X] -= f*r12[X]*rr;
-		  pc1->force[Y] -= f*r12[Y]*rr;
-		  pc1->force[Z] -= f*r12[Z]*rr;
-		  pc2->force[X] += f*r12[X]*rr;
-		  pc2->force[Y] += f*r12[Y]*rr;
-		  pc2->force[Z] += f*r12[Z]*rr;
-
-		  obj->vlocal += obj->epsilon*exp(-obj->kappa*r)/r
-		    - vcut - (r - obj->rc)*dvcut;
-		}
-	      }
-	    }
-	  }
-	}
-      }
-    }
+  rminlocal = ltot[X];
+  hminlocal = ltot[X];
+
+  /* Pairs from the shared Verlet list (see interact_pairwise()).
+   * The force on pc1 for each pair is stored and added afterwards. */
+
+  plist = cinfo->plist;
+  assert(plist);
+
+  #pragma omp parallel for reduction(+: vlocal) \
+    reduction(min: rminlocal, hminlocal)
+  for (int n = 0; n < plist->npair; n++) {
+
+    colloid_t * pc1 = plist->pair[n].pc1;
+    colloid_t * pc2 = plist->pair[n].pc2;
+    const double * r12 = plist->pair[n].r12;
+    double * f12 = plist->f12 + 3*n;
+    double f, r, h, rr;
+
+    f12[X] = 0.0;
+    f12[Y] = 0.0;
+    f12[Z] = 0.0;
+
+    r = sqrt(r12[X]*r12[X] + r12[Y]*r12[Y] + r12[Z]*r12[Z]);
+
+    if (r < rminlocal) rminlocal = r;
+    h = r - pc1->s.ah - pc2->s.ah;
+    if (h < hminlocal) hminlocal = h;
+    if (r >= obj->rc) continue;
+
+    rr = 1.0/r;
+    f = -(-obj->epsilon*exp(-obj->kappa*r)*rr*(rr + obj->kappa)
+	  - dvcut);
+
+    f12[X] = -(f*r12[X]*rr);
+    f12[Y] = -(f*r12[Y]*rr);
+    f12[Z] = -(f*r12[Z]*rr);
+
+    vlocal += obj->epsilon*exp(-obj->kappa*r)/r
+      - vcut - (r - obj->rc)*dvcut;
   }
 
+  colloid_pair_list_force_add(plist);
+
+  obj->vlocal = vlocal;
+  obj->rminlocal = rminlocal;
+  obj->hminlocal = hminlocal;
+
   return 0;
 }
 
@@ -107,6 +107,13 @@ __host__ int phi_force_calculation(pe_t * pe, cs_t * cs, lees_edw_t * le,
 	pth_force_fluid_driver(pth, hydro);
       }
       break;
+    case FE_FORCE_METHOD_STRESS_RECOMPUTE:
+      /* Fluid only: the stress is not stored */
+      if (wall_present(wall) || is_pm) {
+	pe_fatal(pe, "stress_divergence_recompute: no walls or porous media\n");
+      }
+      pth_force_fluid_recompute_driver(pth, fe, hydro);
+      break;
     case FE_FORCE_METHOD_PHI_GRADMU:
 
       if (wall_present(wall) || is_pm) {
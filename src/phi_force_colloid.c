@@ -62,6 +62,7 @@
 #include "phi_force_stress.h"
 #include "phi_force_colloid.h"
 #include "timer.h"
+#include "util.h"
 
 int pth_force_driver(pth_t * pth, colloids_info_t * cinfo,
 		     hydro_t * hydro, map_t * map, wall_t * wall,
@@ -75,6 +76,19 @@ __global__ void pth_force_wall_kernel(kernel_3d_t k3d, pth_t * pth,
 
 __global__ void pth_force_fluid_kernel_v(kernel_3d_v_t k3v, pth_t * pth,
 					 hydro_t * hydro);
+__global__ void pth_force_fluid_recompute_kernel_v(kernel_3d_v_t k3v,
+						   int xs, int ys, int zs,
+						   fe_t * fe, hydro_t * hydro);
+
+static int pth_force_fluid_recompute_host(pth_t * pth, fe_t * fe,
+					  hydro_t * hydro);
+static int pth_force_fluid_recompute_tile(pth_t * pth, fe_t * fe,
+					  hydro_t * hydro,
+					  const cs_limits_t * lim,
+					  double * sbuf);
+
+/* Tile extent for the host recompute (clipped to the local domain) */
+static const int pth_recompute_tile_[3] = {8, 8, 64};
 
 /*****************************************************************************
  *
@@ -466,6 +480,347 @@ __global__ void pth_force_fluid_kernel_v(kernel_3d_v_t k3v, pth_t * pth,
   return;
 }
 
+/*****************************************************************************
+ *
+ *  pth_force_fluid_recompute_driver
+ *
+ *  Fluid only. As pth_force_fluid_driver(), but the stress is not
+ *  stored in pth->str.
+ *
+ *  On the host, the stress is computed tile-by-tile (plus one point
+ *  all round) into a small per-thread buffer and the divergence taken
+ *  from there, so there are (t_x + 2)(t_y + 2)(t_z + 2)/(t_x t_y t_z)
+ *  stress evaluations per site (about 1.7 for the default tile).
+ *
+ *  On a device, the kernel evaluates fe->func->stress_v() at the point
+ *  and at each of the six neighbours, i.e., seven evaluations per
+ *  site in place of one. This is only likely to be of benefit if
+ *  the stress is cheap compared with the memory traffic saved.
+ *
+ *****************************************************************************/
+
+__host__ int pth_force_fluid_recompute_driver(pth_t * pth, fe_t * fe,
+					      hydro_t * hydro) {
+  int ndevice = 0;
+  int nlocal[3] = {0};
+  int xs = 0;
+  int ys = 0;
+  int zs = 0;
+  fe_t * fe_target = NULL;
+
+  assert(pth);
+  assert(fe);
+  assert(fe->func->stress_v);
+  assert(hydro);
+
+  cs_nlocal(pth->cs, nlocal);
+  cs_strides(pth->cs, &xs, &ys, &zs);
+  tdpGetDeviceCount(&ndevice);
+
+  /* Any time-dependent parameters are committed here */
+  fe->func->target(fe, &fe_target);
+
+  TIMER_start(TIMER_PHI_FORCE_CALC);
+
+  if (ndevice == 0) {
+    pth_force_fluid_recompute_host(pth, fe, hydro);
+  }
+  else {
+    dim3 nblk = {};
+    dim3 ntpb = {};
+    cs_limits_t lim = {1, nlocal[X], 1, nlocal[Y], 1, nlocal[Z]};
+    kernel_3d_v_t k3v = kernel_3d_v(pth->cs, lim, NSIMDVL);
+
+    kernel_3d_launch_param(k3v.kiterations, &nblk, &ntpb);
+
+    tdpLaunchKernel(pth_force_fluid_recompute_kernel_v, nblk, ntpb, 0, 0,
+		    k3v, xs, ys, zs, fe_target, hydro->target);
+    tdpAssert(tdpPeekAtLastError());
+    tdpAssert(tdpDeviceSynchronize());
+  }
+
+  TIMER_stop(TIMER_PHI_FORCE_CALC);
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  pth_force_fluid_recompute_host
+ *
+ *  Tiles are shared between OpenMP threads; each thread has its own
+ *  stress buffer.
+ *
+ *****************************************************************************/
+
+static int pth_force_fluid_recompute_host(pth_t * pth, fe_t * fe,
+					  hydro_t * hydro) {
+  int nlocal[3] = {0};
+  int tile[3] = {0};
+  int ntile[3] = {0};
+  int ntiles = 0;
+
+  assert(pth);
+  assert(fe);
+  assert(hydro);
+
+  cs_nlocal(pth->cs, nlocal);
+
+  for (int ia = 0; ia < 3; ia++) {
+    tile[ia] = imin(pth_recompute_tile_[ia], nlocal[ia]);
+    ntile[ia] = (nlocal[ia] + tile[ia] - 1)/tile[ia];
+  }
+  ntiles = ntile[X]*ntile[Y]*ntile[Z];
+
+  #pragma omp parallel
+  {
+    /* Stress for one tile plus one point all round */
+    int nsbuf = (tile[X] + 2)*(tile[Y] + 2)*(tile[Z] + 2);
+    double * sbuf = (double *) malloc(9*nsbuf*sizeof(double));
+
+    assert(sbuf);
+    if (sbuf == NULL) pe_fatal(pth->pe, "malloc(recompute stress) failed\n");
+
+    #pragma omp for schedule(dynamic)
+    for (int it = 0; it < ntiles; it++) {
+      int itx = it/(ntile[Y]*ntile[Z]);
+      int ity = (it - itx*ntile[Y]*ntile[Z])/ntile[Z];
+      int itz = it - (itx*ntile[Y] + ity)*ntile[Z];
+      cs_limits_t lim = {
+	.imin = 1 + itx*tile[X], .imax = imin((itx + 1)*tile[X], nlocal[X]),
+	.jmin = 1 + ity*tile[Y], .jmax = imin((ity + 1)*tile[Y], nlocal[Y]),
+	.kmin = 1 + itz*tile[Z], .kmax = imin((itz + 1)*tile[Z], nlocal[Z])
+      };
+
+      pth_force_fluid_recompute_tile(pth, fe, hydro, &lim, sbuf);
+    }
+
+    free(sbuf);
+  }
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  pth_force_fluid_recompute_tile
+ *
+ *  One tile with interior lim. The stress buffer sbuf holds the
+ *  region lim extended by one point in each direction.
+ *
+ *  The stress is computed NSIMDVL sites at a time in the z-direction
+ *  (lanes beyond the end of the row are discarded); the first site
+ *  is moved back if necessary to stay within the lattice. The
+ *  arithmetic for the divergence is that of pth_force_fluid_kernel_v().
+ *
+ *****************************************************************************/
+
+static int pth_force_fluid_recompute_tile(pth_t * pth, fe_t * fe,
+					  hydro_t * hydro,
+					  const cs_limits_t * lim,
+					  double * sbuf) {
+  int xs = 0;
+  int ys = 0;
+  int zs = 0;
+  int nsites = pth->nsites;
+
+  cs_t * cs = pth->cs;
+
+  /* Buffer strides (x and y; z is unit stride) */
+  int bsy = lim->kmax - lim->kmin + 3;
+  int bsx = bsy*(lim->jmax - lim->jmin + 3);
+
+  assert(sbuf);
+
+  cs_strides(cs, &xs, &ys, &zs);
+  assert(zs == 1);
+  assert(nsites >= NSIMDVL);
+
+  for (int ic = lim->imin - 1; ic <= lim->imax + 1; ic++) {
+    for (int jc = lim->jmin - 1; jc <= lim->jmax + 1; jc++) {
+      for (int kc = lim->kmin - 1; kc <= lim->kmax + 1; kc += NSIMDVL) {
+
+	int index = cs_index(cs, ic, jc, kc);
+	int index0 = imin(index, nsites - NSIMDVL);
+	double s[3][3][NSIMDVL] = {0};
+
+	fe->func->stress_v(fe, index0, s);
+
+	for (int iv = index - index0; iv < NSIMDVL; iv++) {
+	  int k = kc + iv - (index - index0);
+	  int n = 0;
+	  if (k > lim->kmax + 1) break;
+	  n = (ic - lim->imin + 1)*bsx + (jc - lim->jmin + 1)*bsy
+	    + (k - lim->kmin + 1);
+	  for (int ia = 0; ia < 3; ia++) {
+	    for (int ib = 0; ib < 3; ib++) {
+	      sbuf[9*n + 3*ia + ib] = s[ia][ib][iv];
+	    }
+	  }
+	}
+      }
+    }
+  }
+
+  /* Force F_a = -d_b P_ab */
+
+  for (int ic = lim->imin; ic <= lim->imax; ic++) {
+    for (int jc = lim->jmin; jc <= lim->jmax; jc++) {
+      for (int kc = lim->kmin; kc <= lim->kmax; kc++) {
+
+	int index = cs_index(cs, ic, jc, kc);
+	int n = (ic - lim->imin + 1)*bsx + (jc - lim->jmin + 1)*bsy
+	      + (kc - lim->kmin + 1);
+	const double * p0 = sbuf + 9*n;
+	const double * p1 = NULL;
+	double force[3] = {0};
+
+	p1 = sbuf + 9*(n + bsx);
+	for (int ia = 0; ia < 3; ia++) {
+	  force[ia] = -0.5*(p1[3*ia + X] + p0[3*ia + X]);
+	}
+	p1 = sbuf + 9*(n - bsx);
+	for (int ia = 0; ia < 3; ia++) {
+	  force[ia] += 0.5*(p1[3*ia + X] + p0[3*ia + X]);
+	}
+	p1 = sbuf + 9*(n + bsy);
+	for (int ia = 0; ia < 3; ia++) {
+	  force[ia] -= 0.5*(p1[3*ia + Y] + p0[3*ia + Y]);
+	}
+	p1 = sbuf + 9*(n - bsy);
+	for (int ia = 0; ia < 3; ia++) {
+	  force[ia] += 0.5*(p1[3*ia + Y] + p0[3*ia + Y]);
+	}
+	p1 = sbuf + 9*(n + 1);
+	for (int ia = 0; ia < 3; ia++) {
+	  force[ia] -= 0.5*(p1[3*ia + Z] + p0[3*ia + Z]);
+	}
+	p1 = sbuf + 9*(n - 1);
+	for (int ia = 0; ia < 3; ia++) {
+	  force[ia] += 0.5*(p1[3*ia + Z] + p0[3*ia + Z]);
+	}
+
+	for (int ia = 0; ia < 3; ia++) {
+	  hydro->force->data[addr_rank1(hydro->nsite, NHDIM, index, ia)]
+	    += force[ia];
+	}
+      }
+    }
+  }
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  pth_force_fluid_recompute_kernel_v
+ *
+ *  Device version: seven stress evaluations per site. The arithmetic
+ *  is that of pth_force_fluid_kernel_v() so results are the same.
+ *
+ *****************************************************************************/
+
+__global__ void pth_force_fluid_recompute_kernel_v(kernel_3d_v_t k3v,
+						   int xs, int ys, int zs,
+						   fe_t * fe, hydro_t * hydro) {
+  int kindex = 0;
+
+  assert(fe);
+  assert(hydro);
+
+  for_simt_parallel(kindex, k3v.kiterations, NSIMDVL) {
+
+    int iv;
+    int ic[NSIMDVL];
+    int jc[NSIMDVL];
+    int kc[NSIMDVL];
+    int maskv[NSIMDVL];
+    double force[3][NSIMDVL];
+
+    int index = k3v.kindex0 + kindex;
+
+    kernel_3d_v_coords(&k3v, kindex, ic, jc, kc);
+    kernel_3d_v_mask(&k3v, ic, jc, kc, maskv);
+
+    {
+      double pth0[3][3][NSIMDVL] = {0};
+      fe->func->stress_v(fe, index, pth0);
+
+      /* +x, -x */
+      {
+	double pth1[3][3][NSIMDVL] = {0};
+	fe->func->stress_v(fe, index + xs, pth1);
+	for (int ia = 0; ia < 3; ia++) {
+	  for_simd_v(iv, NSIMDVL) {
+	    force[ia][iv] = -0.5*(pth1[ia][X][iv] + pth0[ia][X][iv]);
+	  }
+	}
+      }
+      {
+	double pth1[3][3][NSIMDVL] = {0};
+	fe->func->stress_v(fe, index - xs, pth1);
+	for (int ia = 0; ia < 3; ia++) {
+	  for_simd_v(iv, NSIMDVL) {
+	    force[ia][iv] += 0.5*(pth1[ia][X][iv] + pth0[ia][X][iv]);
+	  }
+	}
+      }
+
+      /* +y, -y */
+      {
+	double pth1[3][3][NSIMDVL] = {0};
+	fe->func->stress_v(fe, index + ys, pth1);
+	for (int ia = 0; ia < 3; ia++) {
+	  for_simd_v(iv, NSIMDVL) {
+	    force[ia][iv] -= 0.5*(pth1[ia][Y][iv] + pth0[ia][Y][iv]);
+	  }
+	}
+      }
+      {
+	double pth1[3][3][NSIMDVL] = {0};
+	fe->func->stress_v(fe, index - ys, pth1);
+	for (int ia = 0; ia < 3; ia++) {
+	  for_simd_v(iv, NSIMDVL) {
+	    force[ia][iv] += 0.5*(pth1[ia][Y][iv] + pth0[ia][Y][iv]);
+	  }
+	}
+      }
+
+      /* +z, -z */
+      {
+	double pth1[3][3][NSIMDVL] = {0};
+	fe->func->stress_v(fe, index + zs, pth1);
+	for (int ia = 0; ia < 3; ia++) {
+	  for_simd_v(iv, NSIMDVL) {
+	    force[ia][iv] -= 0.5*(pth1[ia][Z][iv] + pth0[ia][Z][iv]);
+	  }
+	}
+      }
+      {
+	double pth1[3][3][NSIMDVL] = {0};
+	fe->func->stress_v(fe, index - zs, pth1);
+	for (int ia = 0; ia < 3; ia++) {
+	  for_simd_v(iv, NSIMDVL) {
+	    force[ia][iv] += 0.5*(pth1[ia][Z][iv] + pth0[ia][Z][iv]);
+	  }
+	}
+      }
+    }
+
+    /* Store the force on lattice */
+
+    for (int ia = 0; ia < 3; ia++) {
+      for_simd_v(iv, NSIMDVL) {
+	hydro->force->data[addr_rank1(hydro->nsite, NHDIM, index+iv, ia)]
+	  += force[ia][iv]*maskv[iv];
+      }
+    }
+    /* Next site */
+  }
+
+  return;
+}
+
 
 /*****************************************************************************
  *
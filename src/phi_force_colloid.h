@@ -24,6 +24,8 @@
 #include "wall.h"
 
 __host__ int pth_force_fluid_driver(pth_t * pth, hydro_t * hydro);
+__host__ int pth_force_fluid_recompute_driver(pth_t * pth, fe_t * fe,
+					      hydro_t * hydro);
 __host__ int pth_force_fluid_wall_driver(pth_t * pth, hydro_t * hydro,
 					 map_t * map, wall_t * wall);
 __host__ int pth_force_colloid(pth_t * pth, fe_t * fe, colloids_info_t * cinfo,
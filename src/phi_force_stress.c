@@ -55,11 +55,15 @@ __host__ int pth_create(pe_t * pe, cs_t * cs, int method, pth_t ** pobj) {
   obj->method = method;
   cs_nsites(cs, &obj->nsites);
 
-  /* malloc() here in all cases on host (even if not required). */
-
-  obj->str = (double *) malloc(3*3*obj->nsites*sizeof(double));
-  assert(obj->str);
-  if (obj->str == NULL) pe_fatal(pe, "malloc(pth->str) failed\n");
+  /* malloc() here in all cases on host (even if not required), with
+   * the exception of the recompute method which never stores the
+   * stress. */
+
+  if (method != FE_FORCE_METHOD_STRESS_RECOMPUTE) {
+    obj->str = (double *) malloc(3*3*obj->nsites*sizeof(double));
+    assert(obj->str);
+    if (obj->str == NULL) pe_fatal(pe, "malloc(pth->str) failed\n");
+  }
 
   /* Allocate target memory, or alias */
 
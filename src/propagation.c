@@ -24,14 +24,22 @@
 #include "timer.h"
 
 __host__ int lb_propagation_driver(lb_t * lb);
-__host__ int lb_model_swapf(lb_t * lb);
+static int lb_propagation_aa_flush(lb_t * lb);
 
 __global__ void lb_propagation_kernel(kernel_3d_v_t k3v, lb_t * lb);
 __global__ void lb_propagation_kernel_novector(kernel_3d_t k3d, lb_t * lb);
+__global__ void lb_propagation_kernel_list(kernel_3d_v_t k3v, int nblock,
+					   lb_t * lb);
+__global__ void lb_propagation_kernel_sparse(int nfluid, lb_t * lb);
 
 static __constant__ cs_param_t coords;
 static __constant__ lb_collide_param_t lbp;
 
+static __device__
+void lb_propagation_block(const kernel_3d_v_t * k3v, int kindex,
+			  const lb_float_t * __restrict__ f,
+			  lb_float_t * __restrict__ fprime);
+
 /*****************************************************************************
  *
  *  lb_propagation
@@ -49,6 +57,121 @@ __host__ int lb_propagation(lb_t * lb) {
   return 0;
 }
 
+/*****************************************************************************
+ *
+ *  lb_propagation_defer
+ *
+ *  Record that f holds post-collision distributions (with an up-to-date
+ *  halo) which have not been propagated. The next lb_collide() will
+ *  then stream and collide in a single pass (LB_SCHEDULE_FUSED).
+ *
+ *  Anything wanting the propagated f in the meantime must call
+ *  lb_propagation_flush() first.
+ *
+ *****************************************************************************/
+
+__host__ int lb_propagation_defer(lb_t * lb) {
+
+  assert(lb);
+  assert(lb->ndist == 1);
+
+  lb->fpending = 1;
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  lb_propagation_flush
+ *
+ *  Complete any deferred propagation, so that f is the usual
+ *  post-propagation state. Otherwise a no-op.
+ *
+ *  For LB_SCHEDULE_AA, a pending propagation follows an even step
+ *  (and the halo swap), and is completed in place.
+ *
+ *****************************************************************************/
+
+__host__ int lb_propagation_flush(lb_t * lb) {
+
+  assert(lb);
+
+  if (lb->fpending) {
+    if (lb->opts.schedule == LB_SCHEDULE_AA) {
+      lb_propagation_aa_flush(lb);
+    }
+    else {
+      lb_propagation_driver(lb);
+    }
+    lb->fpending = 0;
+  }
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  lb_propagation_aa_flush
+ *
+ *  After an even AA step, the post-collision f_p(x) is stored in
+ *  slot -p at x. Propagation is then a swap of (x, p) with
+ *  (x - c_p, -p) for each p in one half of the velocity set.
+ *  The pairs are disjoint, so this is safe in place. Host only.
+ *
+ *****************************************************************************/
+
+static int lb_propagation_aa_flush(lb_t * lb) {
+
+  int nhalo = 0;
+  int nlocal[3] = {0};
+
+  assert(lb);
+  assert(lb->ndist == 1);
+
+  cs_nhalo(lb->cs, &nhalo);
+  cs_nlocal(lb->cs, nlocal);
+
+  TIMER_start(TIMER_PROP_KERNEL);
+
+  {
+    int nx = nlocal[X] + 2*nhalo;
+    int ny = nlocal[Y] + 2*nhalo;
+    int nz = nlocal[Z] + 2*nhalo;
+
+    #pragma omp parallel for
+    for (int ik = 0; ik < nx*ny*nz; ik++) {
+      int ic = 1 - nhalo + ik/(ny*nz);
+      int jc = 1 - nhalo + (ik % (ny*nz))/nz;
+      int kc = 1 - nhalo + ik % nz;
+      int index0 = cs_index(lb->cs, ic, jc, kc);
+
+      for (int p = 1; p <= lb->nvel/2; p++) {
+	int pbar = lb->nvel - p;
+	int is = ic - lb->model.cv[p][X];
+	int js = jc - lb->model.cv[p][Y];
+	int ks = kc - lb->model.cv[p][Z];
+
+	if (is < 1 - nhalo || is > nlocal[X] + nhalo) continue;
+	if (js < 1 - nhalo || js > nlocal[Y] + nhalo) continue;
+	if (ks < 1 - nhalo || ks > nlocal[Z] + nhalo) continue;
+
+	{
+	  int index1 = cs_index(lb->cs, is, js, ks);
+	  int a0 = LB_ADDR(lb->nsite, 1, lb->nvel, index0, LB_RHO, p);
+	  int a1 = LB_ADDR(lb->nsite, 1, lb->nvel, index1, LB_RHO, pbar);
+	  lb_float_t ftmp = lb->f[a0];
+	  lb->f[a0] = lb->f[a1];
+	  lb->f[a1] = ftmp;
+	}
+      }
+    }
+  }
+
+  TIMER_stop(TIMER_PROP_KERNEL);
+
+  return 0;
+}
+
 /*****************************************************************************
  *
  *  lb_propagation_driver
@@ -77,12 +200,25 @@ __host__ int lb_propagation_driver(lb_t * lb) {
     cs_limits_t lim = {1, nlocal[X], 1, nlocal[Y], 1, nlocal[Z]};
     kernel_3d_v_t k3v = kernel_3d_v(lb->cs, lim, NSIMDVL);
 
-    kernel_3d_launch_param(k3v.kiterations, &nblk, &ntpb);
-
     TIMER_start(TIMER_PROP_KERNEL);
 
-    tdpLaunchKernel(lb_propagation_kernel, nblk, ntpb, 0, 0,
-		    k3v, lb->target);
+    if (lb->slot) {
+      /* Sparse storage: local fluid sites via neighbour table */
+      kernel_launch_param(lb->nfluid, &nblk, &ntpb);
+      tdpLaunchKernel(lb_propagation_kernel_sparse, nblk, ntpb, 0, 0,
+		      lb->nfluid, lb->target);
+    }
+    else if (lb->block) {
+      /* Fluid blocks only */
+      kernel_3d_launch_param(lb->nblock, &nblk, &ntpb);
+      tdpLaunchKernel(lb_propagation_kernel_list, nblk, ntpb, 0, 0,
+		      k3v, lb->nblock, lb->target);
+    }
+    else {
+      kernel_3d_launch_param(k3v.kiterations, &nblk, &ntpb);
+      tdpLaunchKernel(lb_propagation_kernel, nblk, ntpb, 0, 0,
+		      k3v, lb->target);
+    }
     tdpAssert(tdpPeekAtLastError());
     tdpAssert(tdpDeviceSynchronize());
 
@@ -153,47 +289,108 @@ __global__ void lb_propagation_kernel_novector(kernel_3d_t k3d, lb_t * lb) {
 __global__ void lb_propagation_kernel(kernel_3d_v_t k3v, lb_t * lb) {
 
   int kindex = 0;
-  double * __restrict__ f;
-  double * __restrict__ fprime;
 
   assert(lb);
 
-  f = lb->f;
-  fprime = lb->fprime;
-
   for_simt_parallel(kindex, k3v.kiterations, NSIMDVL) {
+    lb_propagation_block(&k3v, kindex, lb->f, lb->fprime);
+  }
 
-    int iv;
-    int index0;
-    int ic[NSIMDVL];
-    int jc[NSIMDVL];
-    int kc[NSIMDVL];
-    int maskv[NSIMDVL];
-    int indexp[NSIMDVL];
+  return;
+}
 
-    kernel_3d_v_coords(&k3v, kindex, ic, jc, kc);
-    kernel_3d_v_mask(&k3v, ic, jc, kc, maskv);
+/*****************************************************************************
+ *
+ *  lb_propagation_kernel_list
+ *
+ *  As lb_propagation_kernel(), but only for the SIMD blocks in the
+ *  fluid list lb->block (see lb_data_fluid_list()).
+ *
+ *****************************************************************************/
 
-    index0 = k3v.kindex0 + kindex;
+__global__ void lb_propagation_kernel_list(kernel_3d_v_t k3v, int nblock,
+					   lb_t * lb) {
+  int ib = 0;
 
-    for (int n = 0; n < lbp.ndist; n++) {
-      for (int p = 0; p < NVEL; p++) {
+  assert(lb);
 
-	/* If this is a halo site, just copy, else pull from neighbour */
+  for_simt_parallel(ib, nblock, 1) {
+    int kindex = lb->block[ib] - k3v.kindex0;
+    lb_propagation_block(&k3v, kindex, lb->f, lb->fprime);
+  }
 
-	for_simd_v(iv, NSIMDVL) {
-	  indexp[iv] = index0 + iv - maskv[iv]*(lbp.cv[p][X]*coords.str[X] +
-						lbp.cv[p][Y]*coords.str[Y] +
-						lbp.cv[p][Z]*coords.str[Z]);
-	}
+  return;
+}
 
-	for_simd_v(iv, NSIMDVL) {
-	  fprime[LB_ADDR(lbp.nsite, lbp.ndist, NVEL, index0 + iv, n, p)]
-	    = f[LB_ADDR(lbp.nsite, lbp.ndist, NVEL, indexp[iv], n, p)];
-	}
+/*****************************************************************************
+ *
+ *  lb_propagation_kernel_sparse
+ *
+ *  Propagation for sparse storage (see lb_data_sparse()). The source
+ *  of each distribution at local fluid slot is is held in lb->nbr,
+ *  which includes bounce-back at solid neighbours.
+ *
+ *****************************************************************************/
+
+__global__ void lb_propagation_kernel_sparse(int nfluid, lb_t * lb) {
+
+  int is = 0;
+
+  assert(lb);
+  assert(lb->nbr);
+
+  for_simt_parallel(is, nfluid, 1) {
+    for (int p = 0; p < NVEL; p++) {
+      int naddr = addr_rank1(nfluid, NVEL, is, p);
+      lb->fprime[LB_ADDR(lb->nslot, 1, NVEL, is, LB_RHO, p)]
+	= lb->f[lb->nbr[naddr]];
+    }
+  }
+
+  return;
+}
+
+/*****************************************************************************
+ *
+ *  lb_propagation_block
+ *
+ *  Propagation (pull) for one SIMD block starting at kindex.
+ *
+ *****************************************************************************/
+
+static __device__
+void lb_propagation_block(const kernel_3d_v_t * k3v, int kindex,
+			  const lb_float_t * __restrict__ f,
+			  lb_float_t * __restrict__ fprime) {
+  int iv;
+  int index0;
+  int ic[NSIMDVL];
+  int jc[NSIMDVL];
+  int kc[NSIMDVL];
+  int maskv[NSIMDVL];
+  int indexp[NSIMDVL];
+
+  kernel_3d_v_coords(k3v, kindex, ic, jc, kc);
+  kernel_3d_v_mask(k3v, ic, jc, kc, maskv);
+
+  index0 = k3v->kindex0 + kindex;
+
+  for (int n = 0; n < lbp.ndist; n++) {
+    for (int p = 0; p < NVEL; p++) {
+
+      /* If this is a halo site, just copy, else pull from neighbour */
+
+      for_simd_v(iv, NSIMDVL) {
+	indexp[iv] = index0 + iv - maskv[iv]*(lbp.cv[p][X]*coords.str[X] +
+					      lbp.cv[p][Y]*coords.str[Y] +
+					      lbp.cv[p][Z]*coords.str[Z]);
+      }
+
+      for_simd_v(iv, NSIMDVL) {
+	fprime[LB_ADDR(lbp.nsite, lbp.ndist, NVEL, index0 + iv, n, p)]
+	  = f[LB_ADDR(lbp.nsite, lbp.ndist, NVEL, indexp[iv], n, p)];
       }
     }
-    /* Next sites */
   }
 
   return;
@@ -211,8 +408,8 @@ __global__ void lb_propagation_kernel(kernel_3d_v_t k3v, lb_t * lb) {
 __host__ int lb_model_swapf(lb_t * lb) {
 
   int ndevice;
-  double * tmp1;
-  double * tmp2;
+  lb_float_t * tmp1;
+  lb_float_t * tmp2;
 
   assert(lb);
   assert(lb->target);
@@ -225,14 +422,14 @@ __host__ int lb_model_swapf(lb_t * lb) {
     lb->fprime = tmp1;
   }
   else {
-    tdpAssert(tdpMemcpy(&tmp1, &lb->target->f, sizeof(double *),
+    tdpAssert(tdpMemcpy(&tmp1, &lb->target->f, sizeof(lb_float_t *),
 			tdpMemcpyDeviceToHost));
-    tdpAssert(tdpMemcpy(&tmp2, &lb->target->fprime, sizeof(double *),
+    tdpAssert(tdpMemcpy(&tmp2, &lb->target->fprime, sizeof(lb_float_t *),
 			tdpMemcpyDeviceToHost));
 
-    tdpAssert(tdpMemcpy(&lb->target->f, &tmp2, sizeof(double *),
+    tdpAssert(tdpMemcpy(&lb->target->f, &tmp2, sizeof(lb_float_t *),
 			tdpMemcpyHostToDevice));
-    tdpAssert(tdpMemcpy(&lb->target->fprime, &tmp1, sizeof(double *),
+    tdpAssert(tdpMemcpy(&lb->target->fprime, &tmp1, sizeof(lb_float_t *),
 			tdpMemcpyHostToDevice));
   }
 
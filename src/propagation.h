@@ -5,7 +5,7 @@
  *  Edinburgh Solft Matter and Statistical Physics Group and
  *  Edinburgh Parallel Computing Centre
  *
- *  (c) 2005-2017 The University of Edinburgh
+ *  (c) 2005-2024 The University of Edinburgh
  *
  *  Contributing authors:
  *    Kevin Stratford (kevin@epcc.ed.ac.uk)
@@ -19,5 +19,8 @@
 #include "lb_data.h"
 
 __host__ int lb_propagation(lb_t * lb);
+__host__ int lb_propagation_defer(lb_t * lb);
+__host__ int lb_propagation_flush(lb_t * lb);
+__host__ int lb_model_swapf(lb_t * lb);
 
 #endif
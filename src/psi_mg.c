@@ -0,0 +1,750 @@
+/*****************************************************************************
+ *
+ *  psi_mg.c
+ *
+ *  Geometric multigrid solution of the Poisson equation for the
+ *  potential and charge densities stored in the psi_t object.
+ *
+ *    nabla^2 \psi = - rho_elec / epsilon
+ *
+ *  or, for a spatially varying permittivity,
+ *
+ *    div [epsilon(r) grad psi(r) ] = -rho(r).
+ *
+ *  The finest level is the lattice itself with the same seven point
+ *  differencing as psi_sor.c. Coarser levels are obtained by halving
+ *  the local extent in each direction (coarse cell I covers fine
+ *  cells 2I-1 and 2I) for as long as the coarse extent remains even;
+ *  the operator is rediscretised with spacing h = 2^level.
+ *
+ *  A V-cycle uses the red/black sweep psi_sor_pass() of psi_sor.c as
+ *  smoother (with omega = 1, i.e., Gauss-Seidel, at all levels except
+ *  the coarsest), full-weighting restriction of the residual (average
+ *  of the eight fine cells), and trilinear prolongation of the
+ *  correction. The coarsest level is relaxed with SOR at a fixed
+ *  near-optimal omega.
+ *
+ *  The global residual is computed (with one reduction) once per
+ *  cycle, and is checked against the same absolute and relative
+ *  tolerances as the SOR solver. The maximum number of iterations
+ *  is interpreted as the maximum number of cycles.
+ *
+ *  For variable permittivity, epsilon is evaluated on the finest
+ *  level (halo included) at each solve and averaged onto the coarse
+ *  levels.
+ *
+ *  The correction on coarse levels is periodic; only the finest
+ *  level potential carries any jump from an external field.
+ *
+ *  Edinburgh Soft Matter and Statistical Physics Group and
+ *  Edinburgh Parallel Computing Centre
+ *
+ *  (c) 2024 The University of Edinburgh
+ *
+ *  Contributing Authors:
+ *    Kevin Stratford (kevin@epcc.ed.ac.uk)
+ *
+ *****************************************************************************/
+
+#include <assert.h>
+#include <math.h>
+#include <mpi.h>
+#include <stdlib.h>
+
+#include "pe.h"
+#include "coords.h"
+#include "psi_mg.h"
+#include "psi_sor.h"
+#include "util.h"
+
+#define PSI_MG_NLEVEL_MAX 16  /* Maximum number of levels */
+#define PSI_MG_NPRE        2  /* Pre-smoothing sweeps */
+#define PSI_MG_NPOST       2  /* Post-smoothing sweeps */
+
+struct psi_mg_level_s {
+  int nlocal[3];              /* Local extent at this level */
+  int nhalo;                  /* Halo width */
+  int nsites;                 /* Total sites including halo */
+  int str[3];                 /* Memory strides */
+  double rh2;                 /* 1/h^2 for spacing h */
+  double * u;                 /* Potential (finest) or correction */
+  double * f;                 /* Right-hand side */
+  double * r;                 /* Residual */
+  double * eps;               /* Permittivity (variable case only) */
+  double * buf;               /* Halo buffers (coarse levels only) */
+};
+
+typedef struct psi_mg_cycle_s psi_mg_cycle_t;
+
+struct psi_mg_cycle_s {
+  double epsilon;             /* Uniform permittivity */
+  double omega;               /* Coarsest level relaxation parameter */
+  int ncoarse;                /* Coarsest level sweeps */
+};
+
+static int psi_mg_initialise(psi_t * psi, int isvar, psi_solver_mg_t * mg);
+static int psi_mg_halo(psi_solver_mg_t * mg, int level, double * data);
+static int psi_mg_halo_u(psi_solver_mg_t * mg, int level);
+static int psi_mg_smooth(psi_solver_mg_t * mg, int level, double epsilon,
+			 double omega, int nsweep);
+static double psi_mg_residual(psi_solver_mg_t * mg, int level,
+			      double epsilon);
+static int psi_mg_restrict(psi_solver_mg_t * mg, int level, double * fine,
+			   double * coarse);
+static int psi_mg_prolong(psi_solver_mg_t * mg, int level);
+static int psi_mg_vcycle(psi_solver_mg_t * mg, int level,
+			 const psi_mg_cycle_t * cycle);
+static int psi_mg_solve(psi_solver_mg_t * mg, int its, const char * label);
+
+/* Function table */
+
+static psi_solver_vt_t vt_ = {
+  (psi_solver_free_ft)  psi_solver_mg_free,
+  (psi_solver_solve_ft) psi_solver_mg_solve
+};
+
+static psi_solver_vt_t vart_ = {
+  (psi_solver_free_ft)  psi_solver_mg_free,
+  (psi_solver_solve_ft) psi_solver_mg_var_epsilon_solve
+};
+
+/*****************************************************************************
+ *
+ *  psi_mg_index
+ *
+ *****************************************************************************/
+
+static inline int psi_mg_index(const psi_mg_level_t * l, int ic, int jc,
+			       int kc) {
+
+  return (l->str[X]*(l->nhalo + ic - 1) + l->str[Y]*(l->nhalo + jc - 1)
+	  + l->str[Z]*(l->nhalo + kc - 1));
+}
+
+/*****************************************************************************
+ *
+ *  psi_mg_grid
+ *
+ *  The level as seen by the SOR sweep and residual of psi_sor.c.
+ *
+ *****************************************************************************/
+
+static inline psi_sor_grid_t psi_mg_grid(const psi_mg_level_t * l,
+					 double epsilon) {
+  psi_sor_grid_t grid = {0};
+
+  grid.nlocal[X] = l->nlocal[X];
+  grid.nlocal[Y] = l->nlocal[Y];
+  grid.nlocal[Z] = l->nlocal[Z];
+  grid.nhalo     = l->nhalo;
+  grid.str[X]    = l->str[X];
+  grid.str[Y]    = l->str[Y];
+  grid.str[Z]    = l->str[Z];
+  grid.rh2       = l->rh2;
+  grid.epsilon   = epsilon;
+  grid.eps       = l->eps;
+  grid.f         = l->f;
+  grid.u         = l->u;
+
+  return grid;
+}
+
+/*****************************************************************************
+ *
+ *  psi_solver_mg_create
+ *
+ *****************************************************************************/
+
+int psi_solver_mg_create(psi_t * psi, psi_solver_mg_t ** mg) {
+
+  int ifail = 0;
+  psi_solver_mg_t * solver = NULL;
+
+  assert(psi);
+  assert(mg);
+
+  solver = (psi_solver_mg_t *) calloc(1, sizeof(psi_solver_mg_t));
+  if (solver == NULL) {
+    ifail = -1;
+  }
+  else {
+    solver->super.impl = &vt_;
+    solver->psi = psi;
+    ifail = psi_mg_initialise(psi, 0, solver);
+    if (ifail != 0) psi_solver_mg_free(&solver);
+  }
+
+  *mg = solver;
+
+  return ifail;
+}
+
+/*****************************************************************************
+ *
+ *  psi_solver_mg_var_epsilon_create
+ *
+ *****************************************************************************/
+
+int psi_solver_mg_var_epsilon_create(psi_t * psi, var_epsilon_t user,
+				     psi_solver_mg_t ** mg) {
+  int ifail = 0;
+  psi_solver_mg_t * solver = NULL;
+
+  assert(psi);
+  assert(mg);
+
+  solver = (psi_solver_mg_t *) calloc(1, sizeof(psi_solver_mg_t));
+  if (solver == NULL) {
+    ifail = -1;
+  }
+  else {
+    solver->super.impl = &vart_;
+    solver->psi = psi;
+    solver->fe = user.fe;
+    solver->epsilon = user.epsilon;
+    ifail = psi_mg_initialise(psi, 1, solver);
+    if (ifail != 0) psi_solver_mg_free(&solver);
+  }
+
+  *mg = solver;
+
+  return ifail;
+}
+
+/*****************************************************************************
+ *
+ *  psi_solver_mg_free
+ *
+ *****************************************************************************/
+
+int psi_solver_mg_free(psi_solver_mg_t ** mg) {
+
+  assert(mg);
+  assert(*mg);
+
+  if ((*mg)->level) {
+    for (int n = 0; n < (*mg)->nlevel; n++) {
+      psi_mg_level_t * l = (*mg)->level + n;
+      if (n > 0) free(l->u);
+      free(l->f);
+      free(l->r);
+      free(l->eps);
+      free(l->buf);
+    }
+    free((*mg)->level);
+  }
+
+  free(*mg);
+  *mg = NULL;
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  psi_mg_initialise
+ *
+ *  Set up the hierarchy. Coarsening stops when any local extent is
+ *  not a multiple of four (the red/black sweep needs an even extent
+ *  at every level), or at PSI_MG_NLEVEL_MAX levels.
+ *
+ *****************************************************************************/
+
+static int psi_mg_initialise(psi_t * psi, int isvar, psi_solver_mg_t * mg) {
+
+  int nlevel = 1;
+  int nlocal[3] = {0};
+  psi_mg_level_t * level = NULL;
+
+  assert(psi);
+  assert(mg);
+
+  cs_nlocal(psi->cs, nlocal);
+
+  while (nlevel < PSI_MG_NLEVEL_MAX) {
+    int nl[3] = {nlocal[X] >> (nlevel-1), nlocal[Y] >> (nlevel-1),
+		 nlocal[Z] >> (nlevel-1)};
+    if (nl[X] % 4 || nl[Y] % 4 || nl[Z] % 4) break;
+    nlevel += 1;
+  }
+
+  level = (psi_mg_level_t *) calloc(nlevel, sizeof(psi_mg_level_t));
+  if (level == NULL) return -1;
+
+  mg->nlevel = nlevel;
+  mg->level = level;
+
+  /* Finest level: the lattice itself. The potential is psi. */
+
+  cs_nhalo(psi->cs, &level[0].nhalo);
+  cs_nsites(psi->cs, &level[0].nsites);
+  cs_strides(psi->cs, level[0].str + X, level[0].str + Y, level[0].str + Z);
+
+  for (int ia = 0; ia < 3; ia++) {
+    level[0].nlocal[ia] = nlocal[ia];
+  }
+  level[0].rh2 = 1.0;
+  level[0].u = psi->psi->data;
+
+  /* Coarse levels have a halo of one */
+
+  for (int n = 1; n < nlevel; n++) {
+    psi_mg_level_t * l = level + n;
+    int nall[3] = {0};
+    int nplane = 0;
+    for (int ia = 0; ia < 3; ia++) {
+      l->nlocal[ia] = level[n-1].nlocal[ia]/2;
+      nall[ia] = l->nlocal[ia] + 2;
+    }
+    l->nhalo = 1;
+    l->nsites = nall[X]*nall[Y]*nall[Z];
+    l->str[X] = nall[Y]*nall[Z];
+    l->str[Y] = nall[Z];
+    l->str[Z] = 1;
+    l->rh2 = 0.25*level[n-1].rh2;
+
+    nplane = imax(nall[X]*nall[Y], imax(nall[X]*nall[Z], nall[Y]*nall[Z]));
+
+    l->u   = (double *) calloc(l->nsites, sizeof(double));
+    l->buf = (double *) calloc(4*nplane, sizeof(double));
+    if (l->u == NULL || l->buf == NULL) return -1;
+  }
+
+  for (int n = 0; n < nlevel; n++) {
+    psi_mg_level_t * l = level + n;
+    l->f = (double *) calloc(l->nsites, sizeof(double));
+    l->r = (double *) calloc(l->nsites, sizeof(double));
+    if (l->f == NULL || l->r == NULL) return -1;
+    if (isvar) {
+      l->eps = (double *) calloc(l->nsites, sizeof(double));
+      if (l->eps == NULL) return -1;
+    }
+  }
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  psi_mg_halo
+ *
+ *  Periodic halo swap for a coarse level field (halo width one).
+ *  The directions are taken in turn with the full extent (including
+ *  halo) in the other directions, so edges and corners are filled.
+ *
+ *****************************************************************************/
+
+static int psi_mg_halo(psi_solver_mg_t * mg, int level, double * data) {
+
+  const psi_mg_level_t * l = mg->level + level;
+  const int tagf = 1001;
+  const int tagb = 1002;
+
+  int cartsz[3] = {0};
+  MPI_Comm comm = MPI_COMM_NULL;
+
+  assert(level > 0);
+  assert(l->nhalo == 1);
+
+  cs_cartsz(mg->psi->cs, cartsz);
+  cs_cart_comm(mg->psi->cs, &comm);
+
+  for (int id = 0; id < 3; id++) {
+
+    /* The other two directions, and the plane size */
+    int i1 = (id + 1) % 3;
+    int i2 = (id + 2) % 3;
+    int n1 = l->nlocal[i1] + 2;
+    int n2 = l->nlocal[i2] + 2;
+    int nplane = n1*n2;
+    int nl = l->nlocal[id];
+
+    if (cartsz[id] == 1) {
+      for (int a = 0; a < n1; a++) {
+	for (int b = 0; b < n2; b++) {
+	  int c[3] = {0};
+	  int ilo, ihi;
+	  c[i1] = a; c[i2] = b;
+	  c[id] = 0;      ilo = psi_mg_index(l, c[X], c[Y], c[Z]);
+	  c[id] = nl;     ihi = psi_mg_index(l, c[X], c[Y], c[Z]);
+	  data[ilo] = data[ihi];
+	  c[id] = nl + 1; ihi = psi_mg_index(l, c[X], c[Y], c[Z]);
+	  c[id] = 1;      ilo = psi_mg_index(l, c[X], c[Y], c[Z]);
+	  data[ihi] = data[ilo];
+	}
+      }
+    }
+    else {
+      int pforw = cs_cart_neighb(mg->psi->cs, CS_FORW, id);
+      int pback = cs_cart_neighb(mg->psi->cs, CS_BACK, id);
+      double * sendf = l->buf;
+      double * sendb = l->buf + nplane;
+      double * recvf = l->buf + 2*nplane;
+      double * recvb = l->buf + 3*nplane;
+
+      for (int a = 0; a < n1; a++) {
+	for (int b = 0; b < n2; b++) {
+	  int c[3] = {0};
+	  c[i1] = a; c[i2] = b;
+	  c[id] = nl;
+	  sendf[a*n2 + b] = data[psi_mg_index(l, c[X], c[Y], c[Z])];
+	  c[id] = 1;
+	  sendb[a*n2 + b] = data[psi_mg_index(l, c[X], c[Y], c[Z])];
+	}
+      }
+
+      MPI_Sendrecv(sendf, nplane, MPI_DOUBLE, pforw, tagf,
+		   recvb, nplane, MPI_DOUBLE, pback, tagf, comm,
+		   MPI_STATUS_IGNORE);
+      MPI_Sendrecv(sendb, nplane, MPI_DOUBLE, pback, tagb,
+		   recvf, nplane, MPI_DOUBLE, pforw, tagb, comm,
+		   MPI_STATUS_IGNORE);
+
+      for (int a = 0; a < n1; a++) {
+	for (int b = 0; b < n2; b++) {
+	  int c[3] = {0};
+	  c[i1] = a; c[i2] = b;
+	  c[id] = 0;
+	  data[psi_mg_index(l, c[X], c[Y], c[Z])] = recvb[a*n2 + b];
+	  c[id] = nl + 1;
+	  data[psi_mg_index(l, c[X], c[Y], c[Z])] = recvf[a*n2 + b];
+	}
+      }
+    }
+  }
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  psi_mg_halo_u
+ *
+ *  The finest level is the potential itself, which has the jump
+ *  associated with any external field.
+ *
+ *****************************************************************************/
+
+static int psi_mg_halo_u(psi_solver_mg_t * mg, int level) {
+
+  if (level == 0) {
+    psi_halo_psi(mg->psi);
+    psi_halo_psijump(mg->psi);
+  }
+  else {
+    psi_mg_halo(mg, level, mg->level[level].u);
+  }
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  psi_mg_smooth
+ *
+ *  nsweep red/black sweeps of psi_sor_pass() at the given level.
+ *
+ *****************************************************************************/
+
+static int psi_mg_smooth(psi_solver_mg_t * mg, int level, double epsilon,
+			 double omega, int nsweep) {
+
+  psi_sor_grid_t grid = psi_mg_grid(mg->level + level, epsilon);
+
+  for (int n = 0; n < nsweep; n++) {
+    for (int pass = 0; pass < 2; pass++) {
+      double rsum = 0.0;
+      psi_sor_pass(&grid, pass, omega, &rsum);
+      psi_mg_halo_u(mg, level);
+    }
+  }
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  psi_mg_residual
+ *
+ *  r = f - Au at the given level. Returns the local sum of squares.
+ *
+ *****************************************************************************/
+
+static double psi_mg_residual(psi_solver_mg_t * mg, int level,
+			      double epsilon) {
+
+  psi_mg_level_t * l = mg->level + level;
+  psi_sor_grid_t grid = psi_mg_grid(l, epsilon);
+
+  return psi_sor_residual(&grid, l->r);
+}
+
+/*****************************************************************************
+ *
+ *  psi_mg_restrict
+ *
+ *  Average of the eight fine cells at level onto the coarse cell at
+ *  level + 1 (interior sites only).
+ *
+ *****************************************************************************/
+
+static int psi_mg_restrict(psi_solver_mg_t * mg, int level, double * fine,
+			   double * coarse) {
+
+  const psi_mg_level_t * lf = mg->level + level;
+  const psi_mg_level_t * lc = mg->level + level + 1;
+
+  #pragma omp parallel for
+  for (int ic = 1; ic <= lc->nlocal[X]; ic++) {
+    for (int jc = 1; jc <= lc->nlocal[Y]; jc++) {
+      for (int kc = 1; kc <= lc->nlocal[Z]; kc++) {
+	int if0 = psi_mg_index(lf, 2*ic - 1, 2*jc - 1, 2*kc - 1);
+	double sum = 0.0;
+	for (int di = 0; di < 2; di++) {
+	  for (int dj = 0; dj < 2; dj++) {
+	    for (int dk = 0; dk < 2; dk++) {
+	      sum += fine[if0 + di*lf->str[X] + dj*lf->str[Y] + dk*lf->str[Z]];
+	    }
+	  }
+	}
+	coarse[psi_mg_index(lc, ic, jc, kc)] = 0.125*sum;
+      }
+    }
+  }
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  psi_mg_prolong
+ *
+ *  Trilinear interpolation of the correction at level + 1 added to
+ *  the solution at level. The fine cell 2I-1 (2I) has weight 3/4
+ *  from coarse cell I and 1/4 from coarse cell I-1 (I+1) in each
+ *  direction. The coarse halo must be up-to-date.
+ *
+ *****************************************************************************/
+
+static int psi_mg_prolong(psi_solver_mg_t * mg, int level) {
+
+  psi_mg_level_t * lf = mg->level + level;
+  const psi_mg_level_t * lc = mg->level + level + 1;
+
+  #pragma omp parallel for
+  for (int ic = 1; ic <= lf->nlocal[X]; ic++) {
+    for (int jc = 1; jc <= lf->nlocal[Y]; jc++) {
+      for (int kc = 1; kc <= lf->nlocal[Z]; kc++) {
+
+	int c[3] = {(ic + 1)/2, (jc + 1)/2, (kc + 1)/2};
+	int d[3] = {(ic % 2) ? -1 : +1, (jc % 2) ? -1 : +1,
+		    (kc % 2) ? -1 : +1};
+	int ic0 = psi_mg_index(lc, c[X], c[Y], c[Z]);
+	double du = 0.0;
+
+	for (int a = 0; a < 2; a++) {
+	  double wx = (a == 0) ? 0.75 : 0.25;
+	  for (int b = 0; b < 2; b++) {
+	    double wy = (b == 0) ? 0.75 : 0.25;
+	    for (int e = 0; e < 2; e++) {
+	      double wz = (e == 0) ? 0.75 : 0.25;
+	      int index = ic0 + a*d[X]*lc->str[X] + b*d[Y]*lc->str[Y]
+		+ e*d[Z]*lc->str[Z];
+	      du += wx*wy*wz*lc->u[index];
+	    }
+	  }
+	}
+
+	lf->u[psi_mg_index(lf, ic, jc, kc)] += du;
+      }
+    }
+  }
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  psi_mg_vcycle
+ *
+ *  One V-cycle starting at level; the right-hand side at this level
+ *  must be set.
+ *
+ *****************************************************************************/
+
+static int psi_mg_vcycle(psi_solver_mg_t * mg, int level,
+			 const psi_mg_cycle_t * cycle) {
+
+  psi_mg_level_t * l = mg->level + level;
+
+  if (level == mg->nlevel - 1) {
+    /* Coarsest level */
+    psi_mg_smooth(mg, level, cycle->epsilon, cycle->omega, cycle->ncoarse);
+  }
+  else {
+    psi_mg_level_t * lc = l + 1;
+
+    psi_mg_smooth(mg, level, cycle->epsilon, 1.0, PSI_MG_NPRE);
+    psi_mg_residual(mg, level, cycle->epsilon);
+    psi_mg_restrict(mg, level, l->r, lc->f);
+
+    /* Coarse correction has zero initial guess */
+    for (int index = 0; index < lc->nsites; index++) {
+      lc->u[index] = 0.0;
+    }
+
+    psi_mg_vcycle(mg, level + 1, cycle);
+    psi_mg_prolong(mg, level);
+    psi_mg_halo_u(mg, level);
+    psi_mg_smooth(mg, level, cycle->epsilon, 1.0, PSI_MG_NPOST);
+  }
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  psi_solver_mg_solve
+ *
+ *  Uniform permittivity.
+ *
+ *****************************************************************************/
+
+int psi_solver_mg_solve(psi_solver_mg_t * mg, int its) {
+
+  assert(mg);
+  assert(mg->level[0].eps == NULL);
+
+  return psi_mg_solve(mg, its, "Multigrid");
+}
+
+/*****************************************************************************
+ *
+ *  psi_solver_mg_var_epsilon_solve
+ *
+ *  The permittivity is refreshed on all levels before the solve.
+ *
+ *****************************************************************************/
+
+int psi_solver_mg_var_epsilon_solve(psi_solver_mg_t * mg, int its) {
+
+  psi_mg_level_t * l0 = NULL;
+
+  assert(mg);
+  assert(mg->epsilon);
+
+  l0 = mg->level;
+
+  for (int ic = 0; ic <= l0->nlocal[X] + 1; ic++) {
+    for (int jc = 0; jc <= l0->nlocal[Y] + 1; jc++) {
+      for (int kc = 0; kc <= l0->nlocal[Z] + 1; kc++) {
+	int index = psi_mg_index(l0, ic, jc, kc);
+	mg->epsilon(mg->fe, index, l0->eps + index);
+      }
+    }
+  }
+
+  for (int n = 0; n < mg->nlevel - 1; n++) {
+    psi_mg_restrict(mg, n, mg->level[n].eps, mg->level[n+1].eps);
+    psi_mg_halo(mg, n + 1, mg->level[n+1].eps);
+  }
+
+  return psi_mg_solve(mg, its, "Multigrid (heterogeneous)");
+}
+
+/*****************************************************************************
+ *
+ *  psi_mg_solve
+ *
+ *  Driver: set the right-hand side and cycle until converged.
+ *
+ *****************************************************************************/
+
+static int psi_mg_solve(psi_solver_mg_t * mg, int its, const char * label) {
+
+  int niteration = 1000;       /* Maximum number of cycles */
+  double eunit, beta;
+  double rnorm[2] = {0};       /* Initial and current norm of residual */
+  double rnorm_local[2] = {0}; /* Local sums of squares */
+  psi_mg_cycle_t cycle = {0};
+  psi_mg_level_t * l0 = mg->level;
+
+  psi_t * psi = mg->psi;
+  MPI_Comm comm = MPI_COMM_NULL;
+
+  cs_cart_comm(psi->cs, &comm);
+  psi_maxits(psi, &niteration);
+  psi_epsilon(psi, &cycle.epsilon);
+  psi_beta(psi, &beta);
+  psi_unit_charge(psi, &eunit);
+
+  /* Coarsest level: SOR at the optimal omega for the Jacobi spectral
+   * radius of the coarsest (global) grid, with enough sweeps to
+   * reduce the error there by several orders of magnitude. */
+  {
+    int ntotal[3] = {0};
+    int nmax = 0;
+    double radius = 0.0;
+    cs_ntotal(psi->cs, ntotal);
+    nmax = imax(ntotal[X], imax(ntotal[Y], ntotal[Z])) >> (mg->nlevel - 1);
+    radius = 1.0 - 0.5*pow(4.0*atan(1.0)/nmax, 2);
+    cycle.omega = 2.0/(1.0 + sqrt(1.0 - radius*radius));
+    cycle.ncoarse = imax(4, 2*nmax);
+  }
+
+  /* Non-dimensional potential in Poisson eqn requires e/kT */
+
+  l0->u = psi->psi->data;
+
+  for (int ic = 1; ic <= l0->nlocal[X]; ic++) {
+    for (int jc = 1; jc <= l0->nlocal[Y]; jc++) {
+      for (int kc = 1; kc <= l0->nlocal[Z]; kc++) {
+	int index = psi_mg_index(l0, ic, jc, kc);
+	double rho_elec = 0.0;
+	psi_rho_elec(psi, index, &rho_elec);
+	l0->f[index] = -eunit*beta*rho_elec;
+	rnorm_local[0] += l0->f[index]*l0->f[index];
+      }
+    }
+  }
+
+  for (int n = 0; n < niteration; n++) {
+
+    rnorm_local[1] = psi_mg_residual(mg, 0, cycle.epsilon);
+    MPI_Allreduce(rnorm_local, rnorm, 2, MPI_DOUBLE, MPI_SUM, comm);
+    rnorm[0] = sqrt(rnorm[0]);
+    rnorm[1] = sqrt(rnorm[1]);
+
+    if (rnorm[1] < psi->solver.abstol) {
+      if (its % psi->solver.nfreq == 0) {
+	pe_info(psi->pe, "\n");
+	pe_info(psi->pe, "%s solver converged to absolute tolerance\n", label);
+	pe_info(psi->pe, "%s residual %14.7e at %d cycles\n", label,
+		rnorm[1], n);
+      }
+      break;
+    }
+
+    if (rnorm[1] < psi->solver.reltol*rnorm[0]) {
+      if (its % psi->solver.nfreq == 0) {
+	pe_info(psi->pe, "\n");
+	pe_info(psi->pe, "%s solver converged to relative tolerance\n", label);
+	pe_info(psi->pe, "%s residual %14.7e at %d cycles\n", label,
+		rnorm[1], n);
+      }
+      break;
+    }
+
+    if (n == niteration - 1) {
+      pe_info(psi->pe, "\n");
+      pe_info(psi->pe, "%s solver exceeded %d cycles\n", label, n + 1);
+      pe_info(psi->pe, "%s residual %le (initial) %le (final)\n\n", label,
+	      rnorm[0], rnorm[1]);
+      break;
+    }
+
+    psi_mg_vcycle(mg, 0, &cycle);
+  }
+
+  return 0;
+}
@@ -0,0 +1,40 @@
+/*****************************************************************************
+ *
+ *  psi_mg.h
+ *
+ *  Edinburgh Soft Matter and Statistical Physics Group and
+ *  Edinburgh Parallel Computing Centre
+ *
+ *  (c) 2024 The University of Edinburgh
+ *
+ *  Contributing Authors:
+ *    Kevin Stratford (kevin@epcc.ed.ac.uk)
+ *
+ *****************************************************************************/
+
+#ifndef LUDWIG_PSI_SOLVER_MG_H
+#define LUDWIG_PSI_SOLVER_MG_H
+
+#include "psi_solver.h"
+
+typedef struct psi_solver_mg_s psi_solver_mg_t;
+typedef struct psi_mg_level_s psi_mg_level_t;
+
+struct psi_solver_mg_s {
+  psi_solver_t super;                    /* superclass block */
+  psi_t * psi;                           /* Reference to psi structure */
+  fe_t * fe;                             /* abstract free energy */
+  var_epsilon_ft epsilon;                /* provides local epsilon */
+  int nlevel;                            /* Number of grid levels */
+  psi_mg_level_t * level;                /* Opaque level information */
+};
+
+int psi_solver_mg_create(psi_t * psi, psi_solver_mg_t ** mg);
+int psi_solver_mg_free(psi_solver_mg_t ** mg);
+int psi_solver_mg_solve(psi_solver_mg_t * mg, int ntimestep);
+
+int psi_solver_mg_var_epsilon_create(psi_t * psi, var_epsilon_t epsilon,
+				     psi_solver_mg_t ** mg);
+int psi_solver_mg_var_epsilon_solve(psi_solver_mg_t * mg, int ntimestep);
+
+#endif
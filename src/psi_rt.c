@@ -250,7 +250,7 @@ int psi_options_rt(pe_t * pe, cs_t * cs, rt_t * rt, psi_options_t * popts) {
 	if (isAvailable == 0) {
 	  pe_info(pe, "electrokinetics_solver_type:  petsc\n");
 	  pe_info(pe, "Petsc has not been compiled in this build\n");
-	  pe_info(pe, "Please use the `sor` solver.\n");
+	  pe_info(pe, "Please use the `sor` or `multigrid` solver.\n");
 	  pe_fatal(pe, "Please check the input and try again!\n");
 	}
       }
@@ -298,8 +298,9 @@ int psi_options_rt(pe_t * pe, cs_t * cs, rt_t * rt, psi_options_t * popts) {
     io_info_args_rt(rt, RT_FATAL, "psi", IO_INFO_READ_WRITE, &opts.psi.iodata);
     io_info_args_rt(rt, RT_FATAL, "psi", IO_INFO_READ_WRITE, &opts.rho.iodata);
 
-    if (opts.psi.iodata.input.mode != IO_MODE_MPIIO) {
-      pe_fatal(pe, "Electrokinetics i/o must use psi_io_mode mpiio\n");
+    if (opts.psi.iodata.input.mode != IO_MODE_MPIIO &&
+	opts.psi.iodata.input.mode != IO_MODE_NODE) {
+      pe_fatal(pe, "Electrokinetics i/o must use psi_io_mode mpiio/node\n");
     }
   }
 
@@ -8,7 +8,7 @@
  *  Edinburgh Soft Matter and Statistical Physics Group and
  *  Edinburgh Parallel Computing Centre
  *
- *  (c) 2023 The University of Edinburgh
+ *  (c) 2023-2024 The University of Edinburgh
  *
  *  Kevin Stratford (kevin@epcc.ed.ac.uk)
  *
@@ -17,6 +17,7 @@
 #include <assert.h>
 
 /* Available implementations ... */
+#include "psi_mg.h"
 #include "psi_petsc.h"
 #include "psi_sor.h"
 
@@ -55,6 +56,14 @@ int psi_solver_create(psi_t * psi, psi_solver_t ** solver) {
     }
     break;
 
+  case (PSI_POISSON_SOLVER_MULTIGRID):
+    {
+      psi_solver_mg_t * mg = NULL;
+      ifail = psi_solver_mg_create(psi, &mg);
+      if (ifail == 0) *solver = (psi_solver_t *) mg;
+    }
+    break;
+
   default:
     ifail = -1;
   }
@@ -96,6 +105,14 @@ int psi_solver_var_epsilon_create(psi_t * psi, var_epsilon_t user,
     }
     break;
 
+  case (PSI_POISSON_SOLVER_MULTIGRID):
+    {
+      psi_solver_mg_t * mg = NULL;
+      ifail = psi_solver_mg_var_epsilon_create(psi, user, &mg);
+      if (ifail == 0) *solver = (psi_solver_t *) mg;
+    }
+    break;
+
   default:
     ifail = -1;
   }
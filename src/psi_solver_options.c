@@ -11,7 +11,7 @@
  *  Edinburgh Soft Matter and Statistical Physics Group and
  *  Edinburgh Parallel Computing Centre
  *
- *  (c) 2023 The University of Edinburgh
+ *  (c) 2023-2024 The University of Edinburgh
  *
  *  Kevin Stratford (kevin@epcc.ed.ac.uk)
  *
@@ -61,6 +61,9 @@ const char * psi_poisson_solver_to_string(psi_poisson_solver_enum_t mytype) {
   case PSI_POISSON_SOLVER_NONE:
     str = "none";
     break;
+  case PSI_POISSON_SOLVER_MULTIGRID:
+    str = "multigrid";
+    break;
   default:
     str = "invalid";
   }
@@ -85,6 +88,7 @@ psi_poisson_solver_enum_t psi_poisson_solver_from_string(const char * str) {
   if (strcmp(value, "sor")   == 0) mytype = PSI_POISSON_SOLVER_SOR;
   if (strcmp(value, "petsc") == 0) mytype = PSI_POISSON_SOLVER_PETSC;
   if (strcmp(value, "none")  == 0) mytype = PSI_POISSON_SOLVER_NONE;
+  if (strcmp(value, "multigrid") == 0) mytype = PSI_POISSON_SOLVER_MULTIGRID;
 
   return mytype;
 }
@@ -7,7 +7,7 @@
  *  Edinburgh Soft Matter and Statistical Physics Group and
  *  Edinburgh Parallel Computing Centre
  *
- *  (c) 2023 The University of Edinburgh
+ *  (c) 2023-2024 The University of Edinburgh
  *
  *  Kevin Stratford (kevin@epcc.ed.ac.uk)
  *
@@ -25,7 +25,8 @@ typedef enum psi_poisson_solver_enum_s {
   PSI_POISSON_SOLVER_INVALID = 0,
   PSI_POISSON_SOLVER_SOR = 1,
   PSI_POISSON_SOLVER_PETSC = 2,
-  PSI_POISSON_SOLVER_NONE = 3
+  PSI_POISSON_SOLVER_NONE = 3,
+  PSI_POISSON_SOLVER_MULTIGRID = 4
 } psi_poisson_solver_enum_t;
 
 /* This is intended to be general; some components might not be relevant
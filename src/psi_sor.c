@@ -12,6 +12,9 @@
  *  where psi is the potential, rho_elec is the free charge density, and
  *  epsilon is a permeability.
  *
+ *  The red/black sweep and the residual of the seven point operator
+ *  are available for a general grid (psi_sor_pass(), psi_sor_residual())
+ *  so that they may be used as the smoother in psi_mg.c.
  *
  *  Edinburgh Soft Matter and Statistical Physics Group and
  *  Edinburgh Parallel Computing Centre
@@ -28,6 +31,7 @@
 #include <float.h>
 #include <math.h>
 #include <mpi.h>
+#include <stdlib.h>
 
 #include "pe.h"
 #include "coords.h"
@@ -46,6 +50,10 @@ static psi_solver_vt_t vart_ = {
   (psi_solver_solve_ft) psi_solver_sor_var_epsilon_solve
 };
 
+static int psi_sor_grid(psi_solver_sor_t * sor, double epsilon,
+			psi_sor_grid_t * grid);
+static double psi_sor_rhs(psi_solver_sor_t * sor);
+
 /*****************************************************************************
  *
  *  psi_solver_sor_create
@@ -86,6 +94,8 @@ int psi_solver_sor_free(psi_solver_sor_t ** sor) {
   assert(sor);
   assert(*sor);
 
+  free((*sor)->eps);
+  free((*sor)->rhs);
   free(*sor);
   *sor  = NULL;
 
@@ -134,34 +144,22 @@ int psi_solver_sor_solve(psi_solver_sor_t * sor, int its) {
   int niteration = 1000;       /* Maximum number of iterations */
   const int ncheck = 5;        /* Check global residual every n iterations */
   
-  int nhalo;
   int nlocal[3];
-  int nsites;
-  int xs, ys, zs;              /* Memory strides */
-  double rho_elec;             /* Right-hand side */
-  double residual;             /* Residual at given point */
   double rnorm[2];             /* Initial and current norm of residual */
   double rnorm_local[2];       /* Local values */
   double epsilon;              /* Uniform permittivity */
-  double dpsi;
   double omega;                /* Over-relaxation parameter 1 < omega < 2 */
   double radius;               /* Spectral radius of Jacobi iteration */
-  double eunit, beta;
   double ltot[3];
+  psi_sor_grid_t grid = {0};
 
   MPI_Comm comm;               /* Cartesian communicator */
 
   psi_t * psi = sor->psi;
-  double * __restrict__ psidata = psi->psi->data;
 
   cs_ltot(psi->cs, ltot);
-  cs_nhalo(psi->cs, &nhalo);
-  cs_nsites(psi->cs, &nsites);
   cs_nlocal(psi->cs, nlocal);
   cs_cart_comm(psi->cs, &comm);
-  cs_strides(psi->cs, &xs, &ys, &zs);
-
-  assert(nhalo >= 1);
 
   /* The red/black operation needs to be tested for odd numbers
    * of points in parallel. */
@@ -177,29 +175,8 @@ int psi_solver_sor_solve(psi_solver_sor_t * sor, int its) {
   psi_epsilon(psi, &epsilon);
   psi_maxits(psi, &niteration);
 
-  psi_beta(psi, &beta);
-  psi_unit_charge(psi, &eunit);
-
-  rnorm_local[0] = 0.0;
-
-  for (int ic = 1; ic <= nlocal[X]; ic++) {
-    for (int jc = 1; jc <= nlocal[Y]; jc++) {
-      for (int kc = 1; kc <= nlocal[Z]; kc++) {
-
-	int index = cs_index(psi->cs, ic, jc, kc);
-
-	psi_rho_elec(psi, index, &rho_elec);
-
-	/* Non-dimensional potential in Poisson eqn requires e/kT */
-	/* This is just the L2 norm of the right hand side. */
-
-	residual = eunit*beta*rho_elec;
-	rnorm_local[0] += residual*residual;
-      }
-    }
-  }
-
-  rnorm_local[0] = sqrt(rnorm_local[0]);
+  rnorm_local[0] = sqrt(psi_sor_rhs(sor));
+  psi_sor_grid(sor, epsilon, &grid);
 
   /* Iterate to solution */
 
@@ -213,35 +190,7 @@ int psi_solver_sor_solve(psi_solver_sor_t * sor, int its) {
 
     for (int pass = 0; pass < 2; pass++) {
 
-      for (int ic = 1; ic <= nlocal[X]; ic++) {
-	for (int jc = 1; jc <= nlocal[Y]; jc++) {
-	  int kst = 1 + (ic + jc + pass) % 2;
-	  for (int kc = kst; kc <= nlocal[Z]; kc += 2) {
-
-	    int index = cs_index(psi->cs, ic, jc, kc);
-
-	    psi_rho_elec(psi, index, &rho_elec);
-
-	    /* 6-point stencil of Laplacian */
-
-	    dpsi
-	      = psidata[addr_rank0(nsites, index + xs)]
-	      + psidata[addr_rank0(nsites, index - xs)]
-	      + psidata[addr_rank0(nsites, index + ys)]
-	      + psidata[addr_rank0(nsites, index - ys)]
-	      + psidata[addr_rank0(nsites, index + zs)]
-	      + psidata[addr_rank0(nsites, index - zs)]
-	      - 6.0*psidata[addr_rank0(nsites, index)];
-
-	    /* Non-dimensional potential in Poisson eqn requires e/kT */
-
-	    residual = epsilon*dpsi + eunit*beta*rho_elec;
-	    psidata[addr_rank0(nsites, index)]
-	      -= omega*residual / (-6.0*epsilon);
-	    rnorm_local[1] += residual*residual;
-	  }
-	}
-      }
+      psi_sor_pass(&grid, pass, omega, rnorm_local + 1);
 
       /* Recompute relaxation parameter and next pass */
 
@@ -264,7 +213,6 @@ int psi_solver_sor_solve(psi_solver_sor_t * sor, int its) {
       pe_t * pe = psi->pe;
 
       rnorm_local[1] = sqrt(rnorm_local[1]);
-
       MPI_Allreduce(rnorm_local, rnorm, 2, MPI_DOUBLE, MPI_SUM, comm);
 
       if (rnorm[1] < psi->solver.abstol) {
@@ -350,32 +298,24 @@ int psi_solver_sor_var_epsilon_solve(psi_solver_sor_t * sor, int its) {
 
   int nlocal[3];
   int nsites;
-  int xs, ys, zs;              /* Memory strides */
 
-  double rho_elec;             /* Right-hand side */
-  double residual;             /* Residual at given point */
   double rnorm[2];             /* Initial and current norm of residual */
   double rnorm_local[2];       /* Local values */
 
-  double depsi;                /* Differenced left-hand side */
-  double eps0, eps1;           /* Permittivity values */
-
   double omega;                /* Over-relaxation parameter 1 < omega < 2 */
   double radius;               /* Spectral radius of Jacobi iteration */
 
   double ltot[3];
-  double eunit, beta;
+  psi_sor_grid_t grid = {0};
 
   MPI_Comm comm;               /* Cartesian communicator */
 
   psi_t * psi = sor->psi;
-  double * __restrict__ psidata = psi->psi->data;
 
   cs_ltot(psi->cs, ltot);
   cs_nlocal(psi->cs, nlocal);
   cs_nsites(psi->cs, &nsites);
   cs_cart_comm(psi->cs, &comm);
-  cs_strides(psi->cs, &xs, &ys, &zs);
 
   /* The red/black operation needs to be tested for odd numbers
    * of points in parallel. */
@@ -389,28 +329,25 @@ int psi_solver_sor_var_epsilon_solve(psi_solver_sor_t * sor, int its) {
   radius = 1.0 - 0.5*pow(4.0*atan(1.0)/dmax(ltot[X],ltot[Z]), 2);
 
   psi_maxits(psi, &niteration);
-  psi_beta(psi, &beta);
-  psi_unit_charge(psi, &eunit);
 
+  /* The permittivity does not change during the solve: evaluate it
+   * once at all sites (including halo). */
 
-  /* Compute the initial norm of the right hand side. */
-
-  rnorm_local[0] = 0.0;
+  if (sor->eps == NULL) {
+    sor->eps = (double *) calloc(nsites, sizeof(double));
+    if (sor->eps == NULL) pe_fatal(psi->pe, "calloc(sor->eps) failed\n");
+  }
 
-  for (int ic = 1; ic <= nlocal[X]; ic++) {
-    for (int jc = 1; jc <= nlocal[Y]; jc++) {
-      for (int kc = 1; kc <= nlocal[Z]; kc++) {
+  for (int index = 0; index < nsites; index++) {
+    sor->epsilon(sor->fe, index, sor->eps + index);
+  }
 
-	int index = cs_index(psi->cs, ic, jc, kc);
-	psi_rho_elec(psi, index, &rho_elec);
+  /* Compute the initial norm of the right hand side. */
 
-	residual = eunit*beta*rho_elec;
-	rnorm_local[0] += residual*residual;
-      }
-    }
-  }
+  rnorm_local[0] = sqrt(psi_sor_rhs(sor));
 
-  rnorm_local[0] = sqrt(rnorm_local[0]);
+  psi_sor_grid(sor, 0.0, &grid);
+  grid.eps = sor->eps;
 
   /* Iterate to solution */
 
@@ -424,60 +361,7 @@ int psi_solver_sor_var_epsilon_solve(psi_solver_sor_t * sor, int its) {
 
     for (int pass = 0; pass < 2; pass++) {
 
-      for (int ic = 1; ic <= nlocal[X]; ic++) {
-	for (int jc = 1; jc <= nlocal[Y]; jc++) {
-	  int kst = 1 + (ic + jc + pass) % 2;
-	  for (int kc = kst; kc <= nlocal[Z]; kc += 2) {
-
-	    int index = cs_index(psi->cs, ic, jc, kc);
-	    depsi  = 0.0;
-
-	    psi_rho_elec(psi, index, &rho_elec);
-	    sor->epsilon(sor->fe, index, &eps0);
-
-	    /* Laplacian part of operator */
-
-	    depsi += eps0*(-6.0*psidata[addr_rank0(nsites, index)]
-			   + psidata[addr_rank0(nsites, index + xs)]
-			   + psidata[addr_rank0(nsites, index - xs)]
-			   + psidata[addr_rank0(nsites, index + ys)]
-			   + psidata[addr_rank0(nsites, index - ys)]
-			   + psidata[addr_rank0(nsites, index + zs)]
-			   + psidata[addr_rank0(nsites, index - zs)]);
-
-	    /* Additional terms in generalised Poisson equation */
-
-	    sor->epsilon(sor->fe, index + xs, &eps1);
-	    depsi += 0.25*eps1*(psidata[addr_rank0(nsites, index + xs)]
-			      - psidata[addr_rank0(nsites, index - xs)]);
-
-	    sor->epsilon(sor->fe, index - xs, &eps1);
-	    depsi -= 0.25*eps1*(psidata[addr_rank0(nsites, index + xs)]
-			      - psidata[addr_rank0(nsites, index - xs)]);
-
-	    sor->epsilon(sor->fe, index + ys, &eps1);
-	    depsi += 0.25*eps1*(psidata[addr_rank0(nsites, index + ys)]
-			      - psidata[addr_rank0(nsites, index - ys)]);
-
-	    sor->epsilon(sor->fe, index - ys, &eps1);
-	    depsi -= 0.25*eps1*(psidata[addr_rank0(nsites, index + ys)]
-			      - psidata[addr_rank0(nsites, index - ys)]);
-
-	    sor->epsilon(sor->fe, index + zs, &eps1);
-	    depsi += 0.25*eps1*(psidata[addr_rank0(nsites, index + zs)]
-			      - psidata[addr_rank0(nsites, index - zs)]);
-
-	    sor->epsilon(sor->fe, index - zs, &eps1);
-	    depsi -= 0.25*eps1*(psidata[addr_rank0(nsites, index + zs)]
-			      - psidata[addr_rank0(nsites, index - zs)]);
-
-	    /* Non-dimensional potential in Poisson eqn requires e/kT */
-	    residual = depsi + eunit*beta*rho_elec;
-	    psidata[addr_rank0(nsites,index)] -= omega*residual / (-6.0*eps0);
-	    rnorm_local[1] += residual*residual;
-	  }
-	}
-      }
+      psi_sor_pass(&grid, pass, omega, rnorm_local + 1);
 
       psi_halo_psi(psi);
       psi_halo_psijump(psi);
@@ -531,3 +415,213 @@ int psi_solver_sor_var_epsilon_solve(psi_solver_sor_t * sor, int its) {
 
   return 0;
 }
+
+/*****************************************************************************
+ *
+ *  psi_sor_grid
+ *
+ *  The lattice grid for the potential psi (unit spacing).
+ *
+ *****************************************************************************/
+
+static int psi_sor_grid(psi_solver_sor_t * sor, double epsilon,
+			psi_sor_grid_t * grid) {
+  psi_t * psi = sor->psi;
+
+  cs_nlocal(psi->cs, grid->nlocal);
+  cs_nhalo(psi->cs, &grid->nhalo);
+  cs_strides(psi->cs, grid->str + X, grid->str + Y, grid->str + Z);
+
+  assert(grid->nhalo >= 1);
+  assert(sor->rhs);
+
+  grid->rh2 = 1.0;
+  grid->epsilon = epsilon;
+  grid->eps = NULL;
+  grid->f = sor->rhs;
+  grid->u = psi->psi->data;
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  psi_sor_rhs
+ *
+ *  The right-hand side -e rho_elec/kT (the non-dimensional potential
+ *  requires e/kT) at each local site. Returns the local sum of squares
+ *  (the initial residual for a zero potential).
+ *
+ *****************************************************************************/
+
+static double psi_sor_rhs(psi_solver_sor_t * sor) {
+
+  int nlocal[3];
+  int nsites;
+  double eunit, beta;
+  double rsum = 0.0;
+  psi_t * psi = sor->psi;
+
+  cs_nlocal(psi->cs, nlocal);
+  cs_nsites(psi->cs, &nsites);
+  psi_beta(psi, &beta);
+  psi_unit_charge(psi, &eunit);
+
+  if (sor->rhs == NULL) {
+    sor->rhs = (double *) calloc(nsites, sizeof(double));
+    if (sor->rhs == NULL) pe_fatal(psi->pe, "calloc(sor->rhs) failed\n");
+  }
+
+  for (int ic = 1; ic <= nlocal[X]; ic++) {
+    for (int jc = 1; jc <= nlocal[Y]; jc++) {
+      for (int kc = 1; kc <= nlocal[Z]; kc++) {
+
+	int index = cs_index(psi->cs, ic, jc, kc);
+	double rho_elec = 0.0;
+
+	psi_rho_elec(psi, index, &rho_elec);
+	sor->rhs[index] = -eunit*beta*rho_elec;
+	rsum += sor->rhs[index]*sor->rhs[index];
+      }
+    }
+  }
+
+  return rsum;
+}
+
+/*****************************************************************************
+ *
+ *  psi_sor_index
+ *
+ *****************************************************************************/
+
+static inline int psi_sor_index(const psi_sor_grid_t * grid, int ic, int jc,
+				int kc) {
+
+  return grid->str[X]*(grid->nhalo + ic - 1)
+       + grid->str[Y]*(grid->nhalo + jc - 1)
+       + grid->str[Z]*(grid->nhalo + kc - 1);
+}
+
+/*****************************************************************************
+ *
+ *  psi_sor_operator
+ *
+ *  The seven point operator applied to u at index. For uniform
+ *  permittivity
+ *
+ *    epsilon [ u(i+1,j,k) - 2 u(i,j,k) + u(i-1,j,k) + ... ] / h^2
+ *
+ *  and otherwise, for div [epsilon grad u], there are additional
+ *  terms in the differences of epsilon.
+ *
+ *****************************************************************************/
+
+static inline double psi_sor_operator(const psi_sor_grid_t * grid,
+				      int index) {
+  const int xs = grid->str[X];
+  const int ys = grid->str[Y];
+  const int zs = grid->str[Z];
+  const double * u = grid->u;
+
+  if (grid->eps == NULL) {
+    double dpsi = u[index + xs] + u[index - xs]
+                + u[index + ys] + u[index - ys]
+                + u[index + zs] + u[index - zs]
+                - 6.0*u[index];
+    return grid->rh2*(grid->epsilon*dpsi);
+  }
+  else {
+    const double * eps = grid->eps;
+    double depsi = 0.0;
+
+    /* Laplacian part of operator */
+
+    depsi += eps[index]*(-6.0*u[index]
+			 + u[index + xs] + u[index - xs]
+			 + u[index + ys] + u[index - ys]
+			 + u[index + zs] + u[index - zs]);
+
+    /* Additional terms in generalised Poisson equation */
+
+    depsi += 0.25*eps[index + xs]*(u[index + xs] - u[index - xs]);
+    depsi -= 0.25*eps[index - xs]*(u[index + xs] - u[index - xs]);
+    depsi += 0.25*eps[index + ys]*(u[index + ys] - u[index - ys]);
+    depsi -= 0.25*eps[index - ys]*(u[index + ys] - u[index - ys]);
+    depsi += 0.25*eps[index + zs]*(u[index + zs] - u[index - zs]);
+    depsi -= 0.25*eps[index - zs]*(u[index + zs] - u[index - zs]);
+
+    return grid->rh2*depsi;
+  }
+}
+
+/*****************************************************************************
+ *
+ *  psi_sor_pass
+ *
+ *  One red (pass = 0) or black (pass = 1) pass of over-relaxation
+ *  with parameter omega (omega = 1 is Gauss-Seidel) at the local
+ *  sites of the grid. The sum of the squared residuals is added to
+ *  rsum. The caller is responsible for the halo swap.
+ *
+ *****************************************************************************/
+
+int psi_sor_pass(const psi_sor_grid_t * grid, int pass, double omega,
+		 double * rsum) {
+
+  double rs = 0.0;
+
+  assert(grid);
+  assert(rsum);
+  assert(pass == 0 || pass == 1);
+
+  #pragma omp parallel for reduction(+: rs)
+  for (int ic = 1; ic <= grid->nlocal[X]; ic++) {
+    for (int jc = 1; jc <= grid->nlocal[Y]; jc++) {
+      int kst = 1 + (ic + jc + pass) % 2;
+      for (int kc = kst; kc <= grid->nlocal[Z]; kc += 2) {
+
+	int index = psi_sor_index(grid, ic, jc, kc);
+	double eps0 = (grid->eps) ? grid->eps[index] : grid->epsilon;
+	double residual = psi_sor_operator(grid, index) - grid->f[index];
+
+	grid->u[index] -= omega*residual / (-6.0*grid->rh2*eps0);
+	rs += residual*residual;
+      }
+    }
+  }
+
+  *rsum += rs;
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  psi_sor_residual
+ *
+ *  r = f - Au at the local sites. Returns the local sum of squares.
+ *
+ *****************************************************************************/
+
+double psi_sor_residual(const psi_sor_grid_t * grid, double * r) {
+
+  double rsum = 0.0;
+
+  assert(grid);
+  assert(r);
+
+  #pragma omp parallel for reduction(+: rsum)
+  for (int ic = 1; ic <= grid->nlocal[X]; ic++) {
+    for (int jc = 1; jc <= grid->nlocal[Y]; jc++) {
+      for (int kc = 1; kc <= grid->nlocal[Z]; kc++) {
+	int index = psi_sor_index(grid, ic, jc, kc);
+	double residual = grid->f[index] - psi_sor_operator(grid, index);
+	r[index] = residual;
+	rsum += residual*residual;
+      }
+    }
+  }
+
+  return rsum;
+}
@@ -25,6 +25,23 @@ struct psi_solver_sor_s {
   psi_t * psi;                           /* Reference to psi structure */
   fe_t * fe;                             /* abstract free energy */
   var_epsilon_ft epsilon;                /* provides local epsilon */
+  double * rhs;                          /* Right-hand side workspace */
+  double * eps;                          /* Permittivity workspace */
+};
+
+/* A grid for the seven point red/black sweep (also used by psi_mg.c) */
+
+typedef struct psi_sor_grid_s psi_sor_grid_t;
+
+struct psi_sor_grid_s {
+  int nlocal[3];                         /* Local extent */
+  int nhalo;                             /* Halo width */
+  int str[3];                            /* Memory strides */
+  double rh2;                            /* 1/h^2 for spacing h */
+  double epsilon;                        /* Uniform permittivity ... */
+  const double * eps;                    /* ... unless eps is not NULL */
+  const double * f;                      /* Right-hand side */
+  double * u;                            /* Solution */
 };
 
 int psi_solver_sor_create(psi_t * psi, psi_solver_sor_t ** sor);
@@ -38,5 +55,9 @@ int psi_solver_sor_var_epsilon_create(psi_t * psi, var_epsilon_t epsilon,
 
 int psi_solver_sor_var_epsilon_solve(psi_solver_sor_t * sor, int ntimestep);
 
+int psi_sor_pass(const psi_sor_grid_t * grid, int pass, double omega,
+		 double * rsum);
+double psi_sor_residual(const psi_sor_grid_t * grid, double * r);
+
 
 #endif
@@ -312,7 +312,8 @@ __global__ void distribution_gm_kernel(kernel_3d_t k3d, lb_t * lb,
 
     if (status == MAP_FLUID) {
       for (int p = 1; p < lb->nvel; p++) {
-	double f = lb->f[LB_ADDR(lb->nsite,lb->ndist,lb->nvel,index,LB_RHO,p)];
+	double f = lb->f[lb_data_addr(lb, index, LB_RHO, p)]
+	         + lb->param->fshift[p];
 	double gxf = f*util_.cv[p][X];
 	double gyf = f*util_.cv[p][Y];
 	double gzf = f*util_.cv[p][Z];
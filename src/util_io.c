@@ -57,7 +57,7 @@ MPI_Datatype util_io_string_to_mpi_datatype(const char * str) {
     dt = MPI_UNSIGNED_LONG;
   }
   else if (strcmp(str, "MPI_FLOAT") == 0) {
-    dt = MPI_DOUBLE;
+    dt = MPI_FLOAT;
   }
   else if (strcmp(str, "MPI_DOUBLE") == 0) {
     dt = MPI_DOUBLE;
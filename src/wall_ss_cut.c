@@ -160,65 +160,83 @@ int wall_ss_cut_compute(colloids_info_t * cinfo, void * obj) {
   double forcewall[3] = {0};        /* force on the wall for accounting */
   double lmin[3];
   double ltot[3];
+  double vlocal = 0.0;
+  double hminlocal = 0.0;
+  double rminlocal = 0.0;
 
-  colloid_t * pc = NULL;
-  
   assert(cinfo);
   assert(self);
 
   cs_lmin(self->cs, lmin);
   cs_ltot(self->cs, ltot);
 
-  self->vlocal = 0.0;
-  self->hminlocal = dmax(ltot[X], dmax(ltot[Y], ltot[Z]));
-  self->rminlocal = self->hminlocal;
+  hminlocal = dmax(ltot[X], dmax(ltot[Y], ltot[Z]));
+  rminlocal = hminlocal;
 
-  colloids_info_local_head(cinfo, &pc);
+  /* Each colloid is independent: the local list is shared out between
+   * threads in turn. */
 
-  for (; pc; pc = pc->nextlocal) {
+  #pragma omp parallel reduction(+: vlocal, forcewall[:3]) \
+    reduction(min: hminlocal, rminlocal)
+  {
+    int nth = omp_get_num_threads();
+    int tid = omp_get_thread_num();
+    int count = 0;
+    colloid_t * pc = NULL;
 
-    for (int ia = 0; ia < 3; ia++) {
+    colloids_info_local_head(cinfo, &pc);
 
-      double f = 0.0;
-      double r = 0.0;                       /* wall-centre sepration */
-      double h = 0.0;                       /* wall-surface separation */
+    for (; pc; pc = pc->nextlocal, count++) {
 
-      if (self->wall->param->isboundary[ia] == 0) continue;
-	      
-      /* lower wall */
-      r = pc->s.r[ia] - lmin[ia];
-      h = r - pc->s.ah;
+      if (count % nth != tid) continue;
 
-      if (h < self->hminlocal) self->hminlocal = h;
-      if (r < self->rminlocal) self->rminlocal = r;
-	      
-      if (h < self->hc) {
-	double v = 0.0;
-	double fl = 0.0;
-	wall_ss_cut_single(self, h, &fl, &v);
-	self->vlocal += v;
-	f += fl;
-      }
-	      
-      /* upper wall */
-      r = lmin[ia] + ltot[ia] - pc->s.r[ia];
-      h = r - pc->s.ah;
-
-      if (r < self->rminlocal) self->rminlocal = r;
-      if (h < self->hminlocal) self->hminlocal = h;
-	      
-      if (h < self->hc) {
-	double v = 0.0;
-	double fu = 0.0;
-	wall_ss_cut_single(self, h, &fu, &v);
-	self->vlocal += v;
-	f -= fu;            /* upper wall gives -ve (repulsive) force */
+      for (int ia = 0; ia < 3; ia++) {
+
+	double f = 0.0;
+	double r = 0.0;                     /* wall-centre sepration */
+	double h = 0.0;                     /* wall-surface separation */
+
+	if (self->wall->param->isboundary[ia] == 0) continue;
+
+	/* lower wall */
+	r = pc->s.r[ia] - lmin[ia];
+	h = r - pc->s.ah;
+
+	if (h < hminlocal) hminlocal = h;
+	if (r < rminlocal) rminlocal = r;
+
+	if (h < self->hc) {
+	  double v = 0.0;
+	  double fl = 0.0;
+	  wall_ss_cut_single(self, h, &fl, &v);
+	  vlocal += v;
+	  f += fl;
+	}
+
+	/* upper wall */
+	r = lmin[ia] + ltot[ia] - pc->s.r[ia];
+	h = r - pc->s.ah;
+
+	if (r < rminlocal) rminlocal = r;
+	if (h < hminlocal) hminlocal = h;
+
+	if (h < self->hc) {
+	  double v = 0.0;
+	  double fu = 0.0;
+	  wall_ss_cut_single(self, h, &fu, &v);
+	  vlocal += v;
+	  f -= fu;          /* upper wall gives -ve (repulsive) force */
+	}
+	pc->force[ia] += f;
+	forcewall[ia] -= f;
       }
-      pc->force[ia] += f;
-      forcewall[ia] -= f;
     }
   }
 
+  self->vlocal = vlocal;
+  self->hminlocal = hminlocal;
+  self->rminlocal = rminlocal;
+
   wall_momentum_add(self->wall, forcewall);
 
   return 0;
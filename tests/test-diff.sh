@@ -137,6 +137,8 @@ sed -i~ '/Final cell list/d' test-diff-tmp.ref
 sed -i~ '/Final cell list/d' test-diff-tmp.log
 sed -i~ '/Final cell lengths/d' test-diff-tmp.ref
 sed -i~ '/Final cell lengths/d' test-diff-tmp.log
+sed -i~ '/Pair list skin/d' test-diff-tmp.ref
+sed -i~ '/Pair list skin/d' test-diff-tmp.log
 
 
 # Here we use the floating point diff to measure "success"
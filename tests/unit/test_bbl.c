@@ -0,0 +1,337 @@
+/*****************************************************************************
+ *
+ *  test_bbl.c
+ *
+ *  Bounce back on links: the 6x6 velocity update solve, and the
+ *  velocity update on the target.
+ *
+ *  Edinburgh Soft Matter and Statistical Physics Group and
+ *  Edinburgh Parallel Computing Centre
+ *
+ *  (c) 2024 The University of Edinburgh
+ *
+ *  Contributing authors:
+ *  Kevin Stratford (kevin@epcc.ed.ac.uk)
+ *
+ *****************************************************************************/
+
+#include <assert.h>
+#include <float.h>
+#include <math.h>
+
+#include "pe.h"
+#include "physics.h"
+#include "colloid_link_table.h"
+#include "bbl.h"
+#include "tests.h"
+
+#define TEST_BBL_NBATCH 32
+
+int test_bbl_6x6_gaussian_elimination(pe_t * pe);
+int test_bbl_6x6_gaussian_elimination_singular(pe_t * pe);
+int test_bbl_6x6_gaussian_elimination_target(pe_t * pe);
+int test_bbl_update_colloids_target(pe_t * pe);
+
+__host__ __device__ void test_bbl_6x6_problem(int n, double a[6][6],
+					      double x[6], double b[6]);
+__global__ void test_bbl_6x6_kernel(int nbatch, double * xb, int * iret);
+
+/*****************************************************************************
+ *
+ *  test_bbl_suite
+ *
+ *****************************************************************************/
+
+int test_bbl_suite(void) {
+
+  pe_t * pe = NULL;
+
+  pe_create(MPI_COMM_WORLD, PE_QUIET, &pe);
+
+  test_bbl_6x6_gaussian_elimination(pe);
+  test_bbl_6x6_gaussian_elimination_singular(pe);
+  test_bbl_6x6_gaussian_elimination_target(pe);
+  test_bbl_update_colloids_target(pe);
+
+  pe_info(pe, "PASS     ./unit/test_bbl\n");
+  pe_free(pe);
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  test_bbl_6x6_problem
+ *
+ *  A system with the structure of the sphere update: a symmetric
+ *  drag matrix plus mass (moment) on the diagonal, and a known
+ *  solution x. The rhs is b = Ax. Index n just varies the problem.
+ *
+ *****************************************************************************/
+
+__host__ __device__ void test_bbl_6x6_problem(int n, double a[6][6],
+					      double x[6], double b[6]) {
+
+  double mass = 10.0 + 1.0*n;
+  double moment = 0.4*mass;
+
+  for (int i = 0; i < 6; i++) {
+    x[i] = 0.01*(i + 1) - 0.002*n;
+    for (int j = 0; j < 6; j++) {
+      a[i][j] = 0.1/(1.0 + i + j + n);
+    }
+  }
+
+  for (int i = 0; i < 3; i++) {
+    a[i][i] += mass;
+    a[3+i][3+i] += moment;
+  }
+
+  for (int i = 0; i < 6; i++) {
+    b[i] = 0.0;
+    for (int j = 0; j < 6; j++) {
+      b[i] += a[i][j]*x[j];
+    }
+  }
+
+  return;
+}
+
+/*****************************************************************************
+ *
+ *  test_bbl_6x6_gaussian_elimination
+ *
+ *****************************************************************************/
+
+int test_bbl_6x6_gaussian_elimination(pe_t * pe) {
+
+  int ifail = 0;
+  double a[6][6] = {0};
+  double x[6] = {0};
+  double xb[6] = {0};
+
+  assert(pe);
+
+  test_bbl_6x6_problem(0, a, x, xb);
+
+  ifail = bbl_6x6_gaussian_elimination(a, xb);
+  assert(ifail == 0);
+
+  for (int i = 0; i < 6; i++) {
+    assert(fabs(xb[i] - x[i]) < DBL_EPSILON);
+    if (fabs(xb[i] - x[i]) >= DBL_EPSILON) ifail += 1;
+  }
+
+  return ifail;
+}
+
+/*****************************************************************************
+ *
+ *  test_bbl_6x6_gaussian_elimination_singular
+ *
+ *****************************************************************************/
+
+int test_bbl_6x6_gaussian_elimination_singular(pe_t * pe) {
+
+  int ifail = 0;
+  double a[6][6] = {0};
+  double xb[6] = {1.0, 1.0, 1.0, 1.0, 1.0, 1.0};
+
+  assert(pe);
+
+  /* Last row is zero */
+
+  for (int i = 0; i < 5; i++) {
+    a[i][i] = 1.0;
+  }
+
+  ifail = bbl_6x6_gaussian_elimination(a, xb);
+  assert(ifail == -1);
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  test_bbl_6x6_gaussian_elimination_target
+ *
+ *  A batch of solves in a kernel (as used for the sphere velocity
+ *  update) must agree with the same solves on the host (bitwise).
+ *
+ *****************************************************************************/
+
+int test_bbl_6x6_gaussian_elimination_target(pe_t * pe) {
+
+  int ifail = 0;
+  int ndevice = 0;
+  int iret[TEST_BBL_NBATCH] = {0};
+  double xb[6*TEST_BBL_NBATCH] = {0};
+
+  int * iret_d = iret;
+  double * xb_d = xb;
+
+  assert(pe);
+
+  tdpGetDeviceCount(&ndevice);
+
+  if (ndevice > 0) {
+    tdpAssert(tdpMalloc((void **) &iret_d, sizeof(iret)));
+    tdpAssert(tdpMalloc((void **) &xb_d, sizeof(xb)));
+  }
+
+  {
+    dim3 nblk = {};
+    dim3 ntpb = {};
+
+    kernel_launch_param(TEST_BBL_NBATCH, &nblk, &ntpb);
+    tdpLaunchKernel(test_bbl_6x6_kernel, nblk, ntpb, 0, 0,
+		    TEST_BBL_NBATCH, xb_d, iret_d);
+    tdpAssert(tdpPeekAtLastError());
+    tdpAssert(tdpDeviceSynchronize());
+  }
+
+  if (ndevice > 0) {
+    tdpAssert(tdpMemcpy(iret, iret_d, sizeof(iret), tdpMemcpyDeviceToHost));
+    tdpAssert(tdpMemcpy(xb, xb_d, sizeof(xb), tdpMemcpyDeviceToHost));
+    tdpFree(xb_d);
+    tdpFree(iret_d);
+  }
+
+  for (int n = 0; n < TEST_BBL_NBATCH; n++) {
+    double a[6][6] = {0};
+    double x[6] = {0};
+    double xhost[6] = {0};
+
+    test_bbl_6x6_problem(n, a, x, xhost);
+    bbl_6x6_gaussian_elimination(a, xhost);
+
+    assert(iret[n] == 0);
+    for (int i = 0; i < 6; i++) {
+      assert(fabs(xb[6*n + i] - xhost[i]) < DBL_EPSILON);
+      if (fabs(xb[6*n + i] - xhost[i]) >= DBL_EPSILON) ifail += 1;
+    }
+  }
+
+  return ifail;
+}
+
+/*****************************************************************************
+ *
+ *  test_bbl_6x6_kernel
+ *
+ *****************************************************************************/
+
+__global__ void test_bbl_6x6_kernel(int nbatch, double * xb, int * iret) {
+
+  int n = 0;
+
+  for_simt_parallel(n, nbatch, 1) {
+
+    double a[6][6] = {0};
+    double x[6] = {0};
+
+    test_bbl_6x6_problem(n, a, x, xb + 6*n);
+    iret[n] = bbl_6x6_gaussian_elimination(a, xb + 6*n);
+  }
+
+  return;
+}
+
+/*****************************************************************************
+ *
+ *  test_bbl_update_colloids_target
+ *
+ *  The sphere velocity update via the owner kernel must agree with
+ *  bbl_update_colloid_default() for a small set of colloids.
+ *
+ *****************************************************************************/
+
+int test_bbl_update_colloids_target(pe_t * pe) {
+
+  int ifail = 0;
+  int ncell[3] = {2, 2, 2};
+  double rho0 = 0.0;
+  double xb[3][6] = {0};
+  double r[3][3] = {{10.5, 12.0, 13.5},
+		    {30.2, 40.1, 50.3},
+		    {55.0,  8.0, 33.3}};
+
+  cs_t * cs = NULL;
+  physics_t * phys = NULL;
+  lb_t * lb = NULL;
+  wall_t * wall = NULL;
+  bbl_t * bbl = NULL;
+  colloids_info_t * cinfo = NULL;
+  colloid_t * pc[3] = {NULL};
+  lb_data_options_t opts = lb_data_options_default();
+
+  assert(pe);
+
+  cs_create(pe, &cs);
+  cs_init(cs);
+  physics_create(pe, &phys);
+  lb_data_create(pe, cs, &opts, &lb);
+  wall_create(pe, cs, NULL, lb, &wall);
+  bbl_create(pe, cs, lb, &bbl);
+
+  colloids_info_create(pe, cs, ncell, &cinfo);
+  colloids_info_rho0(cinfo, &rho0);
+
+  for (int n = 0; n < 3; n++) {
+    colloids_info_add_local(cinfo, 1 + n, r[n], pc + n);
+    if (pc[n] == NULL) continue;
+    pc[n]->s.bc = COLLOID_BC_BBL;
+    pc[n]->s.shape = COLLOID_SHAPE_SPHERE;
+    pc[n]->s.a0 = 2.3 + 0.5*n;
+    pc[n]->s.ah = pc[n]->s.a0;
+    pc[n]->s.m[X] = 1.0;
+    pc[n]->s.s[X] = 1.0;
+    for (int ia = 0; ia < 3; ia++) {
+      pc[n]->s.v[ia]   = 0.001*(ia + 1) - 0.0005*n;
+      pc[n]->s.w[ia]   = 0.0002*(ia - 1) + 0.0001*n;
+      pc[n]->f0[ia]    = 0.01*(n - ia);
+      pc[n]->t0[ia]    = 0.02*(ia + n);
+      pc[n]->force[ia] = 0.003*(1 + ia*n);
+      pc[n]->torque[ia] = -0.004*(ia + 1);
+      pc[n]->fc0[ia]   = 0.0001*ia;
+      pc[n]->tc0[ia]   = 0.0002*n;
+    }
+    for (int i = 0; i < 21; i++) {
+      pc[n]->zeta[i] = 0.1/(1.0 + i + n);
+    }
+  }
+
+  colloids_info_ntotal_set(cinfo);
+  colloid_link_table_build(cinfo->ltable, cinfo);
+
+  /* Reference (host) */
+
+  for (int n = 0; n < 3; n++) {
+    if (pc[n] == NULL) continue;
+    ifail = bbl_update_colloid_default(bbl, wall, pc[n], rho0, xb[n]);
+    assert(ifail == 0);
+  }
+
+  bbl_update_colloids_target(bbl, wall, cinfo);
+
+  for (int n = 0; n < 3; n++) {
+    if (pc[n] == NULL) continue;
+    for (int ia = 0; ia < 3; ia++) {
+      double dv = fabs(pc[n]->s.v[ia] - xb[n][ia]);
+      double dw = fabs(pc[n]->s.w[ia] - xb[n][3+ia]);
+      assert(dv <= DBL_EPSILON*fabs(xb[n][ia]));
+      assert(dw <= DBL_EPSILON*fabs(xb[n][3+ia]));
+      if (dv > DBL_EPSILON*fabs(xb[n][ia])) ifail += 1;
+      if (dw > DBL_EPSILON*fabs(xb[n][3+ia])) ifail += 1;
+    }
+  }
+
+  colloids_info_free(cinfo);
+  bbl_free(bbl);
+  wall_free(wall);
+  lb_free(lb);
+  physics_free(phys);
+  cs_free(cs);
+
+  return ifail;
+}
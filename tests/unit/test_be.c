@@ -21,13 +21,21 @@
 #include "pe.h"
 #include "coords.h"
 #include "leesedwards.h"
+#include "physics.h"
 #include "field.h"
 #include "field_grad.h"
+#include "gradient_3d_7pt_fluid.h"
+#include "map.h"
+#include "blue_phase.h"
 #include "blue_phase_beris_edwards.h"
 #include "tests.h"
 
 static int do_test_be_tmatrix(void);
 static int do_test_be1(void);
+static int do_test_be_relaxation(void);
+static int do_test_be_relaxation_run(pe_t * pe, cs_t * cs, lees_edw_t * le,
+				     double dt_q, double lambda, int nstep,
+				     double * amp);
 
 /*****************************************************************************
  *
@@ -41,6 +49,7 @@ int test_be_suite(void) {
 
   do_test_be1();
   do_test_be_tmatrix();
+  do_test_be_relaxation();
 
   return 0;
 }
@@ -66,6 +75,11 @@ static int do_test_be1(void) {
   beris_edw_create(pe, cs, le, &be);
   assert(be);
 
+  /* Relaxation parameters */
+  test_assert(beris_edw_relaxation_set(be, 0.0, 0.0) != 0);
+  test_assert(beris_edw_relaxation_set(be, 1.0, -1.0) != 0);
+  test_assert(beris_edw_relaxation_set(be, 10.0, 0.5) == 0);
+
   beris_edw_free(be);
 
   lees_edw_free(le);
@@ -108,3 +122,164 @@ static int do_test_be_tmatrix(void) {
 
   return 0;
 }
+
+/*****************************************************************************
+ *
+ *  do_test_be_relaxation
+ *
+ *  Relaxational dynamics only of a single (shortest wavelength) mode
+ *  Q_xy = A cos(pi x). With the bulk linear term absent (gamma = 3),
+ *  and no chirality, the amplitude is multiplied at each step by
+ *
+ *    g = 1 - 4 dt_q Gamma kappa / (1 + dt_q Gamma lambda)
+ *
+ *  to leading order in A. With Gamma kappa = 1, the explicit update
+ *  (g = -3) is unstable, while the semi-implicit one with lambda
+ *  = 6 kappa is not.
+ *
+ *****************************************************************************/
+
+static int do_test_be_relaxation(void) {
+
+  int ntotal[3] = {8, 8, 8};
+  double amp = 0.0;
+  double a0 = 0.01;
+  const double gk = 1.0;  /* Gamma kappa */
+
+  pe_t * pe = NULL;
+  cs_t * cs = NULL;
+  lees_edw_t * le = NULL;
+
+  pe_create(MPI_COMM_WORLD, PE_QUIET, &pe);
+  cs_create(pe, &cs);
+  cs_nhalo_set(cs, 2);
+  cs_ntotal_set(cs, ntotal);
+  cs_init(cs);
+  lees_edw_create(pe, cs, NULL, &le);
+
+  /* One step: amplitude factor g */
+  {
+    double dt_q = 10.0;
+    double g = 1.0 - 4.0*dt_q*gk/(1.0 + 6.0*dt_q*gk);
+    do_test_be_relaxation_run(pe, cs, le, dt_q, 6.0*0.01, 1, &amp);
+    test_assert(fabs(amp - g*a0)/a0 < 1.0e-3);
+  }
+
+  /* Explicit: growing; semi-implicit: decaying */
+  do_test_be_relaxation_run(pe, cs, le, 1.0, 0.0, 3, &amp);
+  test_assert(amp > a0);
+
+  do_test_be_relaxation_run(pe, cs, le, 10.0, 6.0*0.01, 10, &amp);
+  test_assert(amp < a0*pow(0.5, 10));
+
+  lees_edw_free(le);
+  cs_free(cs);
+  pe_free(pe);
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  do_test_be_relaxation_run
+ *
+ *  Run nstep Beris-Edwards updates without hydrodynamics starting
+ *  from Q_xy = 0.01 cos(pi x); return the maximum |Q_xy| at the end.
+ *
+ *****************************************************************************/
+
+static int do_test_be_relaxation_run(pe_t * pe, cs_t * cs, lees_edw_t * le,
+				     double dt_q, double lambda, int nstep,
+				     double * amp) {
+  int nhalo = 0;
+  int nlocal[3] = {0};
+  int noffset[3] = {0};
+  double ampmax = 0.0;
+
+  physics_t * phys = NULL;
+  field_t * fq = NULL;
+  field_grad_t * fqgrad = NULL;
+  fe_lc_t * fe = NULL;
+  beris_edw_t * be = NULL;
+  map_t * map = NULL;
+
+  assert(pe);
+  assert(cs);
+  assert(le);
+  assert(amp);
+
+  physics_create(pe, &phys);
+  cs_nhalo(cs, &nhalo);
+  cs_nlocal(cs, nlocal);
+  cs_nlocal_offset(cs, noffset);
+
+  {
+    field_options_t opts = field_options_ndata_nhalo(NQAB, nhalo);
+    field_create(pe, cs, le, "q", &opts, &fq);
+    field_grad_create(pe, fq, 2, &fqgrad);
+    field_grad_set(fqgrad, grad_3d_7pt_fluid_d2, NULL);
+  }
+
+  fe_lc_create(pe, cs, le, fq, fqgrad, &fe);
+
+  {
+    /* Gamma kappa = 1 (see above) */
+    fe_lc_param_t param = {.a0 = 0.01, .gamma = 3.0, .kappa0 = 0.01,
+			   .kappa1 = 0.01, .xi = 0.7, .redshift = 1.0,
+			   .rredshift = 1.0};
+    beris_edw_param_t be_param = {.xi = 0.7, .gamma = 100.0, .noise = 0};
+
+    fe_lc_param_set(fe, &param);
+    beris_edw_create(pe, cs, le, &be);
+    beris_edw_param_set(be, &be_param);
+    beris_edw_relaxation_set(be, dt_q, lambda);
+  }
+
+  {
+    map_options_t opts = map_options_default();
+    map_create(pe, cs, &opts, &map);
+  }
+
+  for (int ic = 1; ic <= nlocal[X]; ic++) {
+    for (int jc = 1; jc <= nlocal[Y]; jc++) {
+      for (int kc = 1; kc <= nlocal[Z]; kc++) {
+	int index = cs_index(cs, ic, jc, kc);
+	double s = 1.0 - 2.0*((noffset[X] + ic) % 2);
+	double q[NQAB] = {0.0, 0.01*s, 0.0, 0.0, 0.0};
+	for (int n = 0; n < NQAB; n++) {
+	  fq->data[addr_rank1(fq->nsites, NQAB, index, n)] = q[n];
+	}
+      }
+    }
+  }
+  field_memcpy(fq, tdpMemcpyHostToDevice);
+
+  for (int n = 0; n < nstep; n++) {
+    field_halo(fq);
+    field_grad_compute(fqgrad);
+    beris_edw_update(be, (fe_t *) fe, fq, fqgrad, NULL, NULL, map, NULL);
+  }
+
+  field_memcpy(fq, tdpMemcpyDeviceToHost);
+
+  for (int ic = 1; ic <= nlocal[X]; ic++) {
+    for (int jc = 1; jc <= nlocal[Y]; jc++) {
+      for (int kc = 1; kc <= nlocal[Z]; kc++) {
+	int index = cs_index(cs, ic, jc, kc);
+	int iaddr = addr_rank1(fq->nsites, NQAB, index, XY);
+	ampmax = fmax(ampmax, fabs(fq->data[iaddr]));
+      }
+    }
+  }
+
+  MPI_Allreduce(&ampmax, amp, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+
+  map_free(&map);
+  beris_edw_free(be);
+  fe_lc_free(fe);
+  field_grad_free(fqgrad);
+  field_free(fq);
+  physics_free(phys);
+
+  return 0;
+}
@@ -40,6 +40,7 @@ static int test_o8m_struct(pe_t * pe, cs_t * cs, lees_edw_t * le, fe_lc_t * fe,
 			   field_t * fq,
 			   field_grad_t * fqgrad);
 static int test_bp_nonfield(void);
+static int test_fe_lc_compact_v(fe_lc_t * fe);
 int test_fe_lc_dimensionless_field_strength(pe_t * pe);
 
 
@@ -84,6 +85,7 @@ int test_bp_suite(void) {
 
   test_o8m_struct(pe, cs, le, fe, fq, fqgrad);
   do_test_fe_lc_device1(pe, cs, fe);
+  test_fe_lc_compact_v(fe);
 
   fe_lc_free(fe);
   field_grad_free(fqgrad);
@@ -1049,3 +1051,120 @@ int test_fe_lc_dimensionless_field_strength(pe_t * pe) {
 
   return ifail;
 }
+
+/*****************************************************************************
+ *
+ *  test_fe_lc_compact_v
+ *
+ *  The compact (five component) kernels must agree with the expanded
+ *  ones to round-off. The parameters are set to exercise all terms,
+ *  including kappa0 != kappa1 and the electric field.
+ *
+ *  The parameters in fe are overwritten.
+ *
+ *****************************************************************************/
+
+static int test_fe_lc_compact_v(fe_lc_t * fe) {
+
+  int ifail = 0;
+  int iv = 0;
+
+  double q5[NQAB][NSIMDVL];
+  double dq5[NVECTOR][NQAB][NSIMDVL];
+  double dsq5[NQAB][NSIMDVL];
+  double h5[NQAB][NSIMDVL];
+  double s5[3][3][NSIMDVL];
+  double fed5[NSIMDVL];
+
+  double q[3][3][NSIMDVL];
+  double dq[3][3][3][NSIMDVL];
+  double dsq[3][3][NSIMDVL];
+  double h[3][3][NSIMDVL];
+  double s[3][3][NSIMDVL];
+  double fed[NSIMDVL];
+
+  fe_lc_param_t param = {
+    .a0 = 0.014384711,
+    .gamma = 3.1764706,
+    .kappa0 = 0.01,
+    .kappa1 = 0.02,
+    .q0 = 0.19635,
+    .xi = 0.7,
+    .redshift = 0.83,
+    .epsilon = 41.4,
+    .e0 = {0.01, -0.02, 0.03},
+    .coswt = 0.5
+  };
+
+  assert(fe);
+
+  fe_lc_param_set(fe, &param);
+
+  /* Arbitrary compact values, differing between lanes */
+
+  for_simd_v(iv, NSIMDVL) {
+    for (int n = 0; n < NQAB; n++) {
+      double x = 1.0 + n + 0.5*iv;
+      q5[n][iv]     = 0.1*sin(1.3*x);
+      dq5[X][n][iv] = 0.01*cos(0.7*x);
+      dq5[Y][n][iv] = 0.02*sin(2.1*x + 0.3);
+      dq5[Z][n][iv] = 0.01*cos(1.7*x - 0.2);
+      dsq5[n][iv]   = 0.003*sin(0.9*x + 1.0);
+    }
+  }
+
+  /* Expanded (full) values */
+
+  for_simd_v(iv, NSIMDVL) {
+    double a[3][3];
+    fe_lc_q5_tensor(q5, iv, a);
+    for (int ia = 0; ia < 3; ia++) {
+      for (int ib = 0; ib < 3; ib++) {
+	q[ia][ib][iv] = a[ia][ib];
+      }
+    }
+    fe_lc_q5_tensor(dsq5, iv, a);
+    for (int ia = 0; ia < 3; ia++) {
+      for (int ib = 0; ib < 3; ib++) {
+	dsq[ia][ib][iv] = a[ia][ib];
+      }
+    }
+    for (int ic = 0; ic < 3; ic++) {
+      fe_lc_q5_tensor(dq5[ic], iv, a);
+      for (int ia = 0; ia < 3; ia++) {
+	for (int ib = 0; ib < 3; ib++) {
+	  dq[ic][ia][ib][iv] = a[ia][ib];
+	}
+      }
+    }
+  }
+
+  fe_lc_compute_fed_v(fe, q, dq, fed);
+  fe_lc_compute_h_v(fe, q, dq, dsq, h);
+  fe_lc_compute_stress_v(fe, q, dq, h, s);
+
+  fe_lc_compute_fed5_v(fe, q5, dq5, fed5);
+  fe_lc_compute_h5_v(fe, q5, dq5, dsq5, h5);
+  fe_lc_compute_stress5_v(fe, q5, dq5, h5, s5);
+
+  for_simd_v(iv, NSIMDVL) {
+    double a[3][3];
+    if (fabs(fed5[iv] - fed[iv]) > TEST_DOUBLE_TOLERANCE) ifail += 1;
+    fe_lc_q5_tensor(h5, iv, a);
+    for (int ia = 0; ia < 3; ia++) {
+      for (int ib = 0; ib < 3; ib++) {
+	if (fabs(a[ia][ib] - h[ia][ib][iv]) > TEST_DOUBLE_TOLERANCE) ifail += 1;
+	if (fabs(s5[ia][ib][iv] - s[ia][ib][iv]) > TEST_DOUBLE_TOLERANCE) {
+	  ifail += 1;
+	}
+      }
+    }
+  }
+  assert(ifail == 0);
+
+  /* The stress must be non-trivial, and not symmetric */
+  assert(fabs(s[X][Y][0]) > TEST_FLOAT_TOLERANCE);
+  assert(fabs(s[X][Y][0] - s[Y][X][0]) > TEST_FLOAT_TOLERANCE);
+
+  return ifail;
+}
@@ -0,0 +1,306 @@
+/*****************************************************************************
+ *
+ *  test_blue_phase_fused.c
+ *
+ *  The fused molecular field/force computation must agree exactly
+ *  with the standard route (gradients, stress, divergence).
+ *
+ *  Edinburgh Soft Matter and Statistical Physics Group and
+ *  Edinburgh Parallel Computing Centre
+ *
+ *  (c) 2024 The University of Edinburgh
+ *
+ *  Contributing authors:
+ *  Kevin Stratford (kevin@epcc.ed.ac.uk)
+ *
+ *****************************************************************************/
+
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pe.h"
+#include "coords.h"
+#include "leesedwards.h"
+#include "physics.h"
+#include "field.h"
+#include "field_grad.h"
+#include "gradient_3d_7pt_fluid.h"
+#include "map.h"
+#include "hydro.h"
+#include "phi_force_stress.h"
+#include "phi_force_colloid.h"
+#include "blue_phase.h"
+#include "blue_phase_beris_edwards.h"
+#include "blue_phase_fused.h"
+#include "tests.h"
+
+static int test_fe_lc_fused_q_init(cs_t * cs, field_t * fq);
+static int test_fe_lc_fused_compute(pe_t * pe, cs_t * cs, lees_edw_t * le,
+				    const int tile[3]);
+
+/*****************************************************************************
+ *
+ *  test_fe_lc_fused_suite
+ *
+ *****************************************************************************/
+
+int test_fe_lc_fused_suite(void) {
+
+  int ndevice = 0;
+  pe_t * pe = NULL;
+
+  pe_create(MPI_COMM_WORLD, PE_QUIET, &pe);
+
+  tdpGetDeviceCount(&ndevice);
+
+  if (ndevice) {
+    pe_info(pe, "SKIP     ./unit/test_blue_phase_fused\n");
+  }
+  else {
+    int ntotal[3] = {16, 16, 16};
+    cs_t * cs = NULL;
+    lees_edw_t * le = NULL;
+
+    cs_create(pe, &cs);
+    cs_nhalo_set(cs, 2);
+    cs_ntotal_set(cs, ntotal);
+    cs_init(cs);
+    lees_edw_create(pe, cs, NULL, &le);
+
+    {
+      /* Tiles dividing the domain, not dividing, and larger than it */
+      int tile1[3] = {4, 4, 8};
+      int tile2[3] = {3, 5, 7};
+      int tile3[3] = {64, 64, 64};
+      test_fe_lc_fused_compute(pe, cs, le, tile1);
+      test_fe_lc_fused_compute(pe, cs, le, tile2);
+      test_fe_lc_fused_compute(pe, cs, le, tile3);
+    }
+
+    lees_edw_free(le);
+    cs_free(cs);
+    pe_info(pe, "PASS     ./unit/test_blue_phase_fused\n");
+  }
+
+  pe_free(pe);
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  test_fe_lc_fused_compute
+ *
+ *  Force via pth_stress_compute() and pth_force_fluid_driver(), and
+ *  one Beris-Edwards update (no hydrodynamics) must be the same when
+ *  the molecular field and force come from the fused computation.
+ *
+ *****************************************************************************/
+
+static int test_fe_lc_fused_compute(pe_t * pe, cs_t * cs, lees_edw_t * le,
+				    const int tile[3]) {
+  int ifail = 0;
+  int nsites = 0;
+  int nhalo = 0;
+
+  physics_t * phys = NULL;
+  field_t * fq = NULL;
+  field_grad_t * fqgrad = NULL;
+  fe_lc_t * fe = NULL;
+  beris_edw_t * be = NULL;
+  map_t * map = NULL;
+  pth_t * pth = NULL;
+  hydro_t * hydro0 = NULL;
+  hydro_t * hydro1 = NULL;
+  fe_lc_fused_t * fused = NULL;
+
+  double * q0 = NULL;
+
+  assert(pe);
+  assert(cs);
+  assert(le);
+
+  physics_create(pe, &phys);
+  cs_nsites(cs, &nsites);
+  cs_nhalo(cs, &nhalo);
+
+  {
+    field_options_t opts = field_options_ndata_nhalo(NQAB, nhalo);
+    field_create(pe, cs, le, "q", &opts, &fq);
+    field_grad_create(pe, fq, 2, &fqgrad);
+    field_grad_set(fqgrad, grad_3d_7pt_fluid_d2, NULL);
+  }
+
+  fe_lc_create(pe, cs, le, fq, fqgrad, &fe);
+
+  {
+    fe_lc_param_t param = {
+      .a0 = 0.014384711,
+      .gamma = 3.1764706,
+      .kappa0 = 0.01,
+      .kappa1 = 0.01,
+      .q0 = 0.19635,
+      .xi = 0.7,
+      .redshift = 1.0,
+      .rredshift = 1.0,
+      .epsilon = 0.5,
+      .e0 = {0.0, 0.0, 0.01}
+    };
+    fe_lc_param_set(fe, &param);
+  }
+
+  beris_edw_create(pe, cs, le, &be);
+  {
+    beris_edw_param_t param = {.xi = 0.7, .gamma = 0.3, .noise = 0};
+    beris_edw_param_set(be, &param);
+  }
+
+  {
+    map_options_t opts = map_options_default();
+    map_create(pe, cs, &opts, &map);
+  }
+
+  {
+    hydro_options_t opts = hydro_options_default();
+    hydro_create(pe, cs, le, &opts, &hydro0);
+    hydro_create(pe, cs, le, &opts, &hydro1);
+  }
+
+  pth_create(pe, cs, FE_FORCE_METHOD_STRESS_DIVERGENCE, &pth);
+
+  test_fe_lc_fused_q_init(cs, fq);
+  field_halo(fq);
+
+  q0 = (double *) malloc(NQAB*nsites*sizeof(double));
+  assert(q0);
+  memcpy(q0, fq->data, NQAB*nsites*sizeof(double));
+
+  /* Standard route */
+
+  field_grad_compute(fqgrad);
+  pth_stress_compute(pth, (fe_t *) fe);
+  pth_force_fluid_driver(pth, hydro0);
+  beris_edw_update(be, (fe_t *) fe, fq, fqgrad, NULL, NULL, map, NULL);
+
+  /* Fused route from the same q; the gradients are removed to make
+   * sure they are not used. */
+
+  {
+    double * q1 = (double *) malloc(NQAB*nsites*sizeof(double));
+    assert(q1);
+    memcpy(q1, fq->data, NQAB*nsites*sizeof(double));
+    memcpy(fq->data, q0, NQAB*nsites*sizeof(double));
+    memset(fqgrad->grad, 0, 3*NQAB*nsites*sizeof(double));
+    memset(fqgrad->delsq, 0, NQAB*nsites*sizeof(double));
+
+    fe_lc_fused_create(pe, cs, fe, be, tile, &fused);
+    fe_lc_fused_compute(fused, hydro1);
+    beris_edw_update(be, (fe_t *) fe, fq, fqgrad, NULL, NULL, map, NULL);
+    fe_lc_fused_free(fused);
+
+    /* Q_ab after the update (interior) and the force */
+
+    {
+      int nlocal[3] = {0};
+      cs_nlocal(cs, nlocal);
+
+      for (int ic = 1; ic <= nlocal[X]; ic++) {
+	for (int jc = 1; jc <= nlocal[Y]; jc++) {
+	  for (int kc = 1; kc <= nlocal[Z]; kc++) {
+	    int index = cs_index(cs, ic, jc, kc);
+	    for (int n = 0; n < NQAB; n++) {
+	      int iaddr = addr_rank1(fq->nsites, NQAB, index, n);
+	      if (fq->data[iaddr] != q1[iaddr]) ifail += 1;
+	    }
+	    for (int ia = 0; ia < 3; ia++) {
+	      int iaddr = addr_rank1(hydro0->nsite, NHDIM, index, ia);
+	      double f0 = hydro0->force->data[iaddr];
+	      double f1 = hydro1->force->data[iaddr];
+	      if (f1 != f0) ifail += 1;
+	    }
+	  }
+	}
+      }
+    }
+    assert(ifail == 0);
+    free(q1);
+  }
+
+  /* The force must be non-trivial for the comparison to mean much */
+  {
+    int nlocal[3] = {0};
+    double fabsmax = 0.0;
+    cs_nlocal(cs, nlocal);
+    for (int ic = 1; ic <= nlocal[X]; ic++) {
+      for (int jc = 1; jc <= nlocal[Y]; jc++) {
+	for (int kc = 1; kc <= nlocal[Z]; kc++) {
+	  int index = cs_index(cs, ic, jc, kc);
+	  for (int ia = 0; ia < 3; ia++) {
+	    int iaddr = addr_rank1(hydro1->nsite, NHDIM, index, ia);
+	    fabsmax = fmax(fabsmax, fabs(hydro1->force->data[iaddr]));
+	  }
+	}
+      }
+    }
+    assert(fabsmax > 0.0);
+  }
+
+  free(q0);
+  pth_free(pth);
+  hydro_free(hydro1);
+  hydro_free(hydro0);
+  map_free(&map);
+  beris_edw_free(be);
+  fe_lc_free(fe);
+  field_grad_free(fqgrad);
+  field_free(fq);
+  physics_free(phys);
+
+  return ifail;
+}
+
+/*****************************************************************************
+ *
+ *  test_fe_lc_fused_q_init
+ *
+ *  A smooth, but otherwise arbitrary, Q_ab at interior sites.
+ *
+ *****************************************************************************/
+
+static int test_fe_lc_fused_q_init(cs_t * cs, field_t * fq) {
+
+  int nlocal[3] = {0};
+  int noffset[3] = {0};
+  double ltot[3] = {0};
+  const double pi = 4.0*atan(1.0);
+
+  assert(cs);
+  assert(fq);
+
+  cs_nlocal(cs, nlocal);
+  cs_nlocal_offset(cs, noffset);
+  cs_ltot(cs, ltot);
+
+  for (int ic = 1; ic <= nlocal[X]; ic++) {
+    for (int jc = 1; jc <= nlocal[Y]; jc++) {
+      for (int kc = 1; kc <= nlocal[Z]; kc++) {
+	int index = cs_index(cs, ic, jc, kc);
+	double x = 2.0*pi*(noffset[X] + ic)/ltot[X];
+	double y = 2.0*pi*(noffset[Y] + jc)/ltot[Y];
+	double z = 2.0*pi*(noffset[Z] + kc)/ltot[Z];
+	double q[NQAB] = {0.1*cos(y) + 0.02*sin(z),
+			  0.05*sin(x + z),
+			  0.03*cos(x)*sin(y),
+			  -0.1*cos(y) + 0.04*sin(2.0*x),
+			  0.06*sin(y - z)};
+	for (int n = 0; n < NQAB; n++) {
+	  fq->data[addr_rank1(fq->nsites, NQAB, index, n)] = q[n];
+	}
+      }
+    }
+  }
+
+  return 0;
+}
@@ -18,12 +18,14 @@
 #include <float.h>
 #include <math.h>
 #include <stdio.h>
+#include <stdlib.h>
 
 #include "pe.h"
 #include "coords.h"
 #include "colloids_halo.h"
 #include "colloid_sums.h"
 #include "build.h"
+#include "colloid_link_table.h"
 #include "tests.h"
 #include "util.h"
 #include "util_ellipsoid.h"
@@ -33,6 +35,7 @@ int test_build_update_links(pe_t * pe, cs_t * cs);
 
 static int test_build_update_map_sph(pe_t * pe, cs_t * cs, double a0,
 				     const double r0[3]);
+static int test_build_update_map_delta(pe_t * pe, cs_t * cs);
 static int test_build_update_map_ell(pe_t * pe, cs_t * cs, const double abc[3],
 				     const double r0[3], const double q[4]);
 static int test_build_update_links_sph(pe_t * pe, cs_t * cs, double a0,
@@ -107,6 +110,9 @@ int test_build_update_map(pe_t * pe, cs_t * cs) {
     assert(ifail == 0);
   }
 
+  ifail = test_build_update_map_delta(pe, cs);
+  assert(ifail == 0);
+
   return ifail;
 }
 
@@ -200,6 +206,172 @@ static int test_build_update_map_sph(pe_t * pe, cs_t * cs, double a0,
   return ifail;
 }
 
+/*****************************************************************************
+ *
+ *  test_build_update_map_delta
+ *
+ *  Two spheres; the second update is incremental and one sphere moves.
+ *  The result must be the same as a full update.
+ *
+ *****************************************************************************/
+
+static int test_build_update_map_delta(pe_t * pe, cs_t * cs) {
+
+  int ifail = 0;
+  int ncell[3] = {8, 8, 8};
+  int nlocal[3] = {0};
+  int nhalo = 0;
+  double a0 = 2.3;
+  double r1[3] = {10.2, 10.0, 10.0};
+  double r2[3] = {20.0, 20.5, 20.0};
+  double dr[3] = {0.6, 0.3, 0.0};
+
+  map_options_t opts = map_options_default();
+  map_t * map = NULL;
+  colloid_t * pc1 = NULL;
+  colloid_t * pc2 = NULL;
+  colloids_info_t * cinfo = NULL;
+
+  map_create(pe, cs, &opts, &map);
+
+  colloids_info_create(pe, cs, ncell, &cinfo);
+  colloids_info_map_init(cinfo);
+
+  {
+    colloid_state_t s = {
+      .rebuild = 1,
+      .bc = COLLOID_BC_BBL,
+      .shape = COLLOID_SHAPE_SPHERE,
+      .a0 = a0
+    };
+    colloids_info_add_local(cinfo, 1, r1, &pc1);
+    colloids_info_add_local(cinfo, 2, r2, &pc2);
+    if (pc1) {
+      pc1->s = s;
+      pc1->s.index = 1;
+      pc1->s.r[X] = r1[X]; pc1->s.r[Y] = r1[Y]; pc1->s.r[Z] = r1[Z];
+    }
+    if (pc2) {
+      pc2->s = s;
+      pc2->s.index = 2;
+      pc2->s.r[X] = r2[X]; pc2->s.r[Y] = r2[Y]; pc2->s.r[Z] = r2[Z];
+    }
+  }
+
+  colloids_info_ntotal_set(cinfo);
+  colloids_halo_state(cinfo);
+
+  build_update_map(cs, cinfo, map);
+  assert(cinfo->map_isdelta == 0);
+
+  /* Move the first colloid (all copies) and update again */
+
+  {
+    colloid_t * pc = NULL;
+    colloids_info_all_head(cinfo, &pc);
+    for (; pc; pc = pc->nextall) {
+      if (pc->s.index != 1) continue;
+      pc->s.r[X] += dr[X];
+      pc->s.r[Y] += dr[Y];
+      pc->s.r[Z] += dr[Z];
+    }
+  }
+
+  build_update_map(cs, cinfo, map);
+  assert(cinfo->map_isdelta == 1);
+
+  /* Sites changed are associated with the first colloid only */
+
+  for (int n = 0; n < cinfo->nchanged; n++) {
+    colloid_t * pcold = NULL;
+    colloid_t * pcnew = NULL;
+    colloids_info_map_old(cinfo, cinfo->map_changed[n], &pcold);
+    colloids_info_map(cinfo, cinfo->map_changed[n], &pcnew);
+    if (pcold && pcold->s.index != 1) ifail += 1;
+    if (pcnew && pcnew->s.index != 1) ifail += 1;
+  }
+  assert(ifail == 0);
+
+  /* Compare with a full update. Colloid map and status must agree
+   * at every site. */
+
+  cs_nlocal(cs, nlocal);
+  cs_nhalo(cs, &nhalo);
+
+  {
+    int nsites = 0;
+    int * status = NULL;
+    colloid_t ** pcmap = NULL;
+
+    cs_nsites(cs, &nsites);
+    status = (int *) calloc(nsites, sizeof(int));
+    pcmap = (colloid_t **) calloc(nsites, sizeof(colloid_t *));
+    assert(status);
+    assert(pcmap);
+
+    for (int index = 0; index < nsites; index++) {
+      map_status(map, index, status + index);
+      colloids_info_map(cinfo, index, pcmap + index);
+    }
+
+    cinfo->map_nupdate = 0;
+    build_update_map(cs, cinfo, map);
+
+    for (int ic = 1 - nhalo; ic <= nlocal[X] + nhalo; ic++) {
+      for (int jc = 1 - nhalo; jc <= nlocal[Y] + nhalo; jc++) {
+	for (int kc = 1 - nhalo; kc <= nlocal[Z] + nhalo; kc++) {
+	  int index = cs_index(cs, ic, jc, kc);
+	  int st = -1;
+	  colloid_t * pc = NULL;
+	  map_status(map, index, &st);
+	  colloids_info_map(cinfo, index, &pc);
+	  if (st != status[index]) ifail += 1;
+	  if (pc != pcmap[index]) ifail += 1;
+	  if ((st == MAP_COLLOID) != (pc != NULL)) ifail += 1;
+	}
+      }
+    }
+    assert(ifail == 0);
+
+    free(pcmap);
+    free(status);
+  }
+
+  /* A small move which does not cross a lattice site boundary must
+   * leave the map alone, but the links must still be reset. */
+
+  {
+    colloid_t * pc = NULL;
+    colloids_info_all_head(cinfo, &pc);
+    for (; pc; pc = pc->nextall) {
+      if (pc->s.index != 1) continue;
+      pc->s.r[X] += 1.0e-3;
+      pc->s.r[Z] -= 1.0e-3;
+    }
+  }
+
+  build_update_map(cs, cinfo, map);
+  assert(cinfo->map_isdelta == 1);
+  assert(cinfo->nchanged == 0);
+
+  {
+    colloid_t * pc = NULL;
+    colloids_info_all_head(cinfo, &pc);
+    for (; pc; pc = pc->nextall) {
+      if (pc->s.index != 1) continue;
+      if (pc->build.relink != 1) ifail += 1;
+      if (pc->build.s.r[X] != pc->s.r[X]) ifail += 1;
+      if (pc->build.s.r[Z] != pc->s.r[Z]) ifail += 1;
+    }
+    assert(ifail == 0);
+  }
+
+  colloids_info_free(cinfo);
+  map_free(&map);
+
+  return ifail;
+}
+
 /*****************************************************************************
  *
  *  test_buld_update_map_ell
@@ -324,6 +496,34 @@ static int test_build_update_links_sph(pe_t * pe, cs_t * cs, double a0,
     if (nlink != (nvel - 1)) ifail = -1;
   }
 
+  {
+    /* The flat link table must agree with the linked lists */
+    colloid_link_table_t * ltable = cinfo->ltable;
+
+    for (int k = 0; k < ltable->nowner; k++) {
+      colloid_t * pc = ltable->pc[k];
+      colloid_link_t * link = pc->lnk;
+      int n = ltable->start[k];
+      for ( ; link; link = link->next) {
+	if (link->status == LINK_UNUSED) continue;
+	if (n >= ltable->start[k+1]) ifail = -1;
+	if (ltable->i[n] != link->i) ifail = -1;
+	if (ltable->j[n] != link->j) ifail = -1;
+	if (ltable->p[n] != link->p) ifail = -1;
+	if (ltable->status[n] != link->status) ifail = -1;
+	if (ltable->owner[n] != k) ifail = -1;
+	for (int ia = 0; ia < 3; ia++) {
+	  double rb = ltable->rb[addr_rank1(ltable->nlinkmax, 3, n, ia)];
+	  if (fabs(rb - link->rb[ia]) > DBL_EPSILON) ifail = -1;
+	}
+	n += 1;
+      }
+      if (n != ltable->start[k+1]) ifail = -1;
+    }
+    if (ltable->start[ltable->nowner] != ltable->nlink) ifail = -1;
+    assert(ifail == 0);
+  }
+
   lb_model_free(&lb);
   map_free(&map);
   colloids_info_free(cinfo);
@@ -0,0 +1,231 @@
+/*****************************************************************************
+ *
+ *  test_colloid_cell_table.c
+ *
+ *  Edinburgh Soft Matter and Statistical Physics Group and
+ *  Edinburgh Parallel Computing Centre
+ *
+ *  (c) 2024 The University of Edinburgh
+ *
+ *  Contributing authors:
+ *  Kevin Stratford (kevin@epcc.ed.ac.uk)
+ *
+ *****************************************************************************/
+
+#include <assert.h>
+#include <float.h>
+#include <math.h>
+
+#include "pe.h"
+#include "coords.h"
+#include "colloids.h"
+#include "colloid_cell_table.h"
+#include "tests.h"
+
+int test_colloid_cell_table_create(pe_t * pe);
+int test_colloid_cell_table_update(pe_t * pe, cs_t * cs);
+int test_colloid_cell_table_compare(colloids_info_t * cinfo,
+				    colloid_cell_table_t * ct);
+
+/*****************************************************************************
+ *
+ *  test_colloid_cell_table_suite
+ *
+ *****************************************************************************/
+
+int test_colloid_cell_table_suite(void) {
+
+  pe_t * pe = NULL;
+  cs_t * cs = NULL;
+
+  pe_create(MPI_COMM_WORLD, PE_QUIET, &pe);
+  cs_create(pe, &cs);
+  cs_init(cs);
+
+  test_colloid_cell_table_create(pe);
+  test_colloid_cell_table_update(pe, cs);
+
+  pe_info(pe, "PASS     ./unit/test_colloid_cell_table\n");
+  cs_free(cs);
+  pe_free(pe);
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  test_colloid_cell_table_create
+ *
+ *****************************************************************************/
+
+int test_colloid_cell_table_create(pe_t * pe) {
+
+  int ifail = 0;
+  colloid_cell_table_t * ct = NULL;
+
+  assert(pe);
+
+  ifail = colloid_cell_table_create(pe, 64, &ct);
+  assert(ifail == 0);
+  assert(ct);
+  assert(ct->ncells == 64);
+  assert(ct->nall == 0);
+  assert(ct->nbuild == 0);
+
+  colloid_cell_table_free(ct);
+
+  return ifail;
+}
+
+/*****************************************************************************
+ *
+ *  test_colloid_cell_table_update
+ *
+ *  Add some colloids (some to the same cell) and check the table
+ *  agrees with the linked lists; move one to a different cell
+ *  and check again. The table must only be rebuilt when required.
+ *
+ *****************************************************************************/
+
+int test_colloid_cell_table_update(pe_t * pe, cs_t * cs) {
+
+  int ifail = 0;
+  int ncell[3] = {4, 4, 4};
+  int nlocal = 0;
+  double lmin[3] = {0};
+  double lcell[3] = {0};
+
+  colloids_info_t * cinfo = NULL;
+  colloid_cell_table_t * ct = NULL;
+
+  assert(pe);
+  assert(cs);
+
+  cs_lmin(cs, lmin);
+  colloids_info_create(pe, cs, ncell, &cinfo);
+  colloids_info_lcell(cinfo, lcell);
+
+  /* Colloids 1-4 are in the same cell, but inserted out of order;
+   * 5-8 are spread along the diagonal. */
+
+  {
+    int order[4] = {3, 1, 4, 2};
+    for (int n = 0; n < 4; n++) {
+      double r[3] = {lmin[X] + 0.5*lcell[X] + 0.1*n,
+		     lmin[Y] + 0.5*lcell[Y],
+		     lmin[Z] + 0.5*lcell[Z]};
+      colloid_t * pc = NULL;
+      colloids_info_add_local(cinfo, order[n], r, &pc);
+      if (pc) pc->s.ah = 1.0 + 0.1*n;
+    }
+    for (int n = 0; n < 4; n++) {
+      double r[3] = {lmin[X] + (n + 0.5)*lcell[X],
+		     lmin[Y] + (n + 0.5)*lcell[Y],
+		     lmin[Z] + (n + 0.5)*lcell[Z]};
+      colloid_t * pc = NULL;
+      colloids_info_add_local(cinfo, 5 + n, r, &pc);
+      if (pc) pc->s.ah = 2.0;
+    }
+  }
+
+  colloids_info_cell_table(cinfo, &ct);
+  assert(ct == cinfo->ctable);
+  assert(ct->nbuild == 1);
+  ifail = test_colloid_cell_table_compare(cinfo, ct);
+  assert(ifail == 0);
+
+  /* Local count is from the table */
+  colloids_info_nlocal(cinfo, &nlocal);
+  assert(nlocal == ct->nall);
+
+  /* Order within a cell is that of the list (increasing index) */
+
+  if (pe_mpi_size(pe) == 1) {
+    assert(ct->nall == 8);
+    assert(ct->index[0] == 1);
+    assert(ct->index[1] == 2);
+    assert(ct->index[2] == 3);
+    assert(ct->index[3] == 4);
+    assert(ct->index[4] == 5);
+  }
+
+  /* No change: no rebuild */
+
+  colloids_info_cell_table(cinfo, &ct);
+  assert(ct->nbuild == 1);
+
+  /* A position change without a change of cell requires only an
+   * explicit refresh of the positions */
+
+  if (ct->nall > 0) {
+    ct->pc[0]->s.r[Z] += 0.25;
+    colloids_info_update_cell_list(cinfo);
+    colloids_info_cell_table(cinfo, &ct);
+    assert(ct->nbuild == 1);
+    colloid_cell_table_positions(ct);
+    assert(fabs(ct->r[3*0 + Z] - ct->pc[0]->s.r[Z]) < DBL_EPSILON);
+  }
+
+  /* A change of cell triggers a rebuild */
+
+  if (ct->nall > 0) {
+    ct->pc[0]->s.r[Y] += lcell[Y];
+    colloids_info_update_cell_list(cinfo);
+    colloids_info_cell_table(cinfo, &ct);
+    assert(ct->nbuild == 2);
+    ifail = test_colloid_cell_table_compare(cinfo, ct);
+    assert(ifail == 0);
+  }
+
+  /* The local list is built from the table */
+
+  colloids_info_list_local_build(cinfo);
+  {
+    int n = 0;
+    colloid_t * pc = NULL;
+    colloids_info_local_head(cinfo, &pc);
+    for (; pc; pc = pc->nextlocal) n += 1;
+    assert(n == nlocal);
+  }
+
+  colloids_info_free(cinfo);
+
+  return ifail;
+}
+
+/*****************************************************************************
+ *
+ *  test_colloid_cell_table_compare
+ *
+ *  Table must match the linked lists cell-by-cell.
+ *
+ *****************************************************************************/
+
+int test_colloid_cell_table_compare(colloids_info_t * cinfo,
+				    colloid_cell_table_t * ct) {
+  int ifail = 0;
+  int nall = 0;
+
+  assert(cinfo);
+  assert(ct);
+
+  for (int n = 0; n < cinfo->ncells; n++) {
+    int ip = ct->start[n];
+    if (ip != nall) ifail += 1;
+    for (colloid_t * pc = cinfo->clist[n]; pc; pc = pc->next) {
+      if (ct->pc[ip] != pc) ifail += 1;
+      if (ct->index[ip] != pc->s.index) ifail += 1;
+      if (ct->ah[ip] != pc->s.ah) ifail += 1;
+      for (int ia = 0; ia < 3; ia++) {
+	if (ct->r[3*ip + ia] != pc->s.r[ia]) ifail += 1;
+      }
+      ip += 1;
+      nall += 1;
+    }
+    if (ip != ct->start[n + 1]) ifail += 1;
+  }
+
+  if (nall != ct->nall) ifail += 1;
+
+  return ifail;
+}
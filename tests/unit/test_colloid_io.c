@@ -0,0 +1,314 @@
+/*****************************************************************************
+ *
+ *  test_colloid_io.c
+ *
+ *  Colloid checkpoint i/o; here mainly the collective MPI-IO path.
+ *
+ *  Edinburgh Soft Matter and Statistical Physics Group and
+ *  Edinburgh Parallel Computing Centre
+ *
+ *  (c) 2024 The University of Edinburgh
+ *
+ *  Contributing authors:
+ *  Kevin Stratford (kevin@epcc.ed.ac.uk)
+ *
+ *****************************************************************************/
+
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "pe.h"
+#include "coords.h"
+#include "colloids.h"
+#include "colloid_io.h"
+#include "util_json.h"
+#include "tests.h"
+
+#define TEST_COLLOID_IO_NTOTAL 64
+
+static int test_colloid_io_mpiio(pe_t * pe, cs_t * cs);
+static int test_colloid_io_mpiio_compat(pe_t * pe, cs_t * cs);
+static int test_colloid_io_state(int index, colloid_state_t * s);
+static int test_colloid_io_init(pe_t * pe, cs_t * cs,
+				colloids_info_t ** cinfo);
+static int test_colloid_io_compare(colloids_info_t * cref,
+				   colloids_info_t * cinfo);
+
+/*****************************************************************************
+ *
+ *  test_colloid_io_suite
+ *
+ *****************************************************************************/
+
+int test_colloid_io_suite(void) {
+
+  pe_t * pe = NULL;
+  cs_t * cs = NULL;
+
+  pe_create(MPI_COMM_WORLD, PE_QUIET, &pe);
+  cs_create(pe, &cs);
+  cs_init(cs);
+
+  test_colloid_io_mpiio(pe, cs);
+  test_colloid_io_mpiio_compat(pe, cs);
+
+  pe_info(pe, "PASS     ./unit/test_colloid_io\n");
+
+  cs_free(cs);
+  pe_free(pe);
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  test_colloid_io_mpiio
+ *
+ *  Write with mpiio and read back with mpiio; every colloid must
+ *  turn up on the correct rank with an identical state. The metadata
+ *  must record the total.
+ *
+ *****************************************************************************/
+
+static int test_colloid_io_mpiio(pe_t * pe, cs_t * cs) {
+
+  int ifail = 0;
+  int iogrid[3] = {1, 1, 1};
+  const char * stub = "test-colloid-io-mpiio";
+
+  colloids_info_t * cref = NULL;
+  colloids_info_t * cinfo = NULL;
+  colloid_io_t * cio = NULL;
+
+  assert(pe);
+  assert(cs);
+
+  test_colloid_io_init(pe, cs, &cref);
+
+  colloid_io_create(pe, cs, iogrid, cref, &cio);
+  colloid_io_format_output_mpiio_set(cio);
+  colloid_io_write(cio, stub);
+  colloid_io_free(cio);
+
+  {
+    int ncell[3] = {2, 2, 2};
+    colloids_info_create(pe, cs, ncell, &cinfo);
+  }
+
+  colloid_io_create(pe, cs, iogrid, cinfo, &cio);
+  colloid_io_format_input_mpiio_set(cio);
+  colloid_io_read(cio, stub);
+  colloid_io_free(cio);
+
+  ifail = test_colloid_io_compare(cref, cinfo);
+  assert(ifail == 0);
+
+  {
+    /* Metadata */
+    char filename[FILENAME_MAX] = {0};
+    snprintf(filename, FILENAME_MAX-1, "%s-metadata.001-001", stub);
+
+    if (pe_mpi_rank(pe) == 0) {
+      cJSON * json = NULL;
+      cJSON * jcio = NULL;
+      cJSON * jn = NULL;
+      cJSON * jsz = NULL;
+
+      ifail = util_json_from_file(filename, &json);
+      assert(ifail == 0);
+      jcio = cJSON_GetObjectItemCaseSensitive(json, "colloid_io");
+      jn = cJSON_GetObjectItemCaseSensitive(jcio, "Number of colloids");
+      jsz = cJSON_GetObjectItemCaseSensitive(jcio, "Record size (bytes)");
+      assert(cJSON_GetNumberValue(jn) == TEST_COLLOID_IO_NTOTAL);
+      assert(cJSON_GetNumberValue(jsz) == sizeof(colloid_state_t));
+      assert(cJSON_GetObjectItemCaseSensitive(json, "coords"));
+      cJSON_Delete(json);
+    }
+
+    MPI_Barrier(MPI_COMM_WORLD);
+    if (pe_mpi_rank(pe) == 0) remove(filename);
+    snprintf(filename, FILENAME_MAX-1, "%s.001-001", stub);
+    if (pe_mpi_rank(pe) == 0) remove(filename);
+  }
+
+  colloids_info_free(cinfo);
+  colloids_info_free(cref);
+
+  return ifail;
+}
+
+/*****************************************************************************
+ *
+ *  test_colloid_io_mpiio_compat
+ *
+ *  The mpiio file has the same layout as a single binary file, so
+ *  it must be readable via "binary_serial" input.
+ *
+ *****************************************************************************/
+
+static int test_colloid_io_mpiio_compat(pe_t * pe, cs_t * cs) {
+
+  int ifail = 0;
+  int iogrid[3] = {1, 1, 1};
+  const char * stub = "test-colloid-io-compat";
+
+  colloids_info_t * cref = NULL;
+  colloids_info_t * cinfo = NULL;
+  colloid_io_t * cio = NULL;
+
+  assert(pe);
+  assert(cs);
+
+  test_colloid_io_init(pe, cs, &cref);
+
+  colloid_io_create(pe, cs, iogrid, cref, &cio);
+  colloid_io_format_output_mpiio_set(cio);
+  colloid_io_write(cio, stub);
+  colloid_io_free(cio);
+
+  {
+    int ncell[3] = {2, 2, 2};
+    colloids_info_create(pe, cs, ncell, &cinfo);
+  }
+
+  colloid_io_create(pe, cs, iogrid, cinfo, &cio);
+  colloid_io_format_input_binary_set(cio);
+  colloid_io_format_input_serial_set(cio);
+  colloid_io_read(cio, stub);
+  colloid_io_free(cio);
+
+  ifail = test_colloid_io_compare(cref, cinfo);
+  assert(ifail == 0);
+
+  {
+    char filename[FILENAME_MAX] = {0};
+    MPI_Barrier(MPI_COMM_WORLD);
+    snprintf(filename, FILENAME_MAX-1, "%s-metadata.001-001", stub);
+    if (pe_mpi_rank(pe) == 0) remove(filename);
+    snprintf(filename, FILENAME_MAX-1, "%s.001-001", stub);
+    if (pe_mpi_rank(pe) == 0) remove(filename);
+  }
+
+  colloids_info_free(cinfo);
+  colloids_info_free(cref);
+
+  return ifail;
+}
+
+/*****************************************************************************
+ *
+ *  test_colloid_io_state
+ *
+ *  A reproducible state for the given index (which must be from 1 to
+ *  TEST_COLLOID_IO_NTOTAL) with positions spread throughout the system.
+ *
+ *****************************************************************************/
+
+static int test_colloid_io_state(int index, colloid_state_t * s) {
+
+  int n = index - 1;
+
+  assert(s);
+  assert(0 <= n && n < TEST_COLLOID_IO_NTOTAL);
+
+  *s = (colloid_state_t) {0};
+
+  s->index = index;
+  s->rebuild = 0;
+  s->shape = COLLOID_SHAPE_SPHERE;
+  s->bc = COLLOID_BC_BBL;
+  s->a0 = 1.25 + 0.01*n;
+  s->ah = s->a0;
+
+  /* 4 x 4 x 4 positions in the default 64^3 system */
+  s->r[X] = 1.0 + 16.0*(n % 4)        + 0.125*n;
+  s->r[Y] = 1.0 + 16.0*((n / 4) % 4)  + 0.25;
+  s->r[Z] = 1.0 + 16.0*(n / 16)       + 0.5;
+
+  s->v[X] = 0.001*n;
+  s->w[Z] = -0.002*n;
+  s->s[X] = 1.0;
+  s->m[Z] = 1.0;
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  test_colloid_io_init
+ *
+ *  Each rank adds the colloids which are local.
+ *
+ *****************************************************************************/
+
+static int test_colloid_io_init(pe_t * pe, cs_t * cs,
+				colloids_info_t ** cinfo) {
+
+  int ncell[3] = {2, 2, 2};
+
+  assert(pe);
+  assert(cs);
+  assert(cinfo);
+
+  colloids_info_create(pe, cs, ncell, cinfo);
+
+  for (int index = 1; index <= TEST_COLLOID_IO_NTOTAL; index++) {
+    colloid_state_t s = {0};
+    colloid_t * pc = NULL;
+    test_colloid_io_state(index, &s);
+    colloids_info_add_local(*cinfo, s.index, s.r, &pc);
+    if (pc) pc->s = s;
+  }
+
+  colloids_info_ntotal_set(*cinfo);
+  colloids_info_list_local_build(*cinfo);
+
+  {
+    int ntotal = 0;
+    colloids_info_ntotal(*cinfo, &ntotal);
+    assert(ntotal == TEST_COLLOID_IO_NTOTAL);
+  }
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  test_colloid_io_compare
+ *
+ *  Local colloids in cinfo must be the same (bitwise) as in cref,
+ *  apart from the rebuild flag which is set on reading.
+ *
+ *****************************************************************************/
+
+static int test_colloid_io_compare(colloids_info_t * cref,
+				   colloids_info_t * cinfo) {
+  int ifail = 0;
+  int nref = 0;
+  int nlocal = 0;
+  int ntotal = 0;
+  colloid_t * pc = NULL;
+
+  assert(cref);
+  assert(cinfo);
+
+  colloids_info_nlocal(cref, &nref);
+  colloids_info_nlocal(cinfo, &nlocal);
+  colloids_info_ntotal(cinfo, &ntotal);
+
+  if (nlocal != nref) ifail += 1;
+  if (ntotal != TEST_COLLOID_IO_NTOTAL) ifail += 1;
+
+  colloids_info_list_local_build(cinfo);
+  colloids_info_local_head(cinfo, &pc);
+
+  for (; pc; pc = pc->nextlocal) {
+    colloid_state_t s = {0};
+    test_colloid_io_state(pc->s.index, &s);
+    s.rebuild = 1; /* Always set on input */
+    if (memcmp(&s, &pc->s, sizeof(colloid_state_t)) != 0) ifail += 1;
+  }
+
+  return ifail;
+}
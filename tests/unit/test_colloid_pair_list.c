@@ -0,0 +1,312 @@
+/*****************************************************************************
+ *
+ *  test_colloid_pair_list.c
+ *
+ *  Edinburgh Soft Matter and Statistical Physics Group and
+ *  Edinburgh Parallel Computing Centre
+ *
+ *  (c) 2024 The University of Edinburgh
+ *
+ *  Contributing authors:
+ *  Kevin Stratford (kevin@epcc.ed.ac.uk)
+ *
+ *****************************************************************************/
+
+#include <assert.h>
+#include <float.h>
+#include <math.h>
+
+#include "pe.h"
+#include "coords.h"
+#include "colloids.h"
+#include "colloid_pair_list.h"
+#include "tests.h"
+
+int test_colloid_pair_list_create(pe_t * pe, cs_t * cs);
+int test_colloid_pair_list_update(pe_t * pe, cs_t * cs);
+int test_colloid_pair_list_force_add(pe_t * pe, cs_t * cs);
+
+/*****************************************************************************
+ *
+ *  test_colloid_pair_list_suite
+ *
+ *****************************************************************************/
+
+int test_colloid_pair_list_suite(void) {
+
+  pe_t * pe = NULL;
+  cs_t * cs = NULL;
+
+  pe_create(MPI_COMM_WORLD, PE_QUIET, &pe);
+  cs_create(pe, &cs);
+  cs_init(cs);
+
+  test_colloid_pair_list_create(pe, cs);
+  test_colloid_pair_list_update(pe, cs);
+  test_colloid_pair_list_force_add(pe, cs);
+
+  pe_info(pe, "PASS     ./unit/test_colloid_pair_list\n");
+  cs_free(cs);
+  pe_free(pe);
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  test_colloid_pair_list_create
+ *
+ *****************************************************************************/
+
+int test_colloid_pair_list_create(pe_t * pe, cs_t * cs) {
+
+  int ifail = 0;
+  colloid_pair_list_t * list = NULL;
+
+  assert(pe);
+  assert(cs);
+
+  ifail = colloid_pair_list_create(pe, cs, &list);
+  assert(ifail == 0);
+  assert(list);
+  assert(list->npair == 0);
+  assert(list->nbuild == 0);
+
+  ifail = colloid_pair_list_skin_set(list, 0.5);
+  assert(ifail == 0);
+  assert(fabs(list->skin - 0.5) < DBL_EPSILON);
+
+  ifail = colloid_pair_list_skin_set(list, -1.0);
+  assert(ifail != 0);
+  assert(fabs(list->skin - 0.5) < DBL_EPSILON);
+
+  /* The effective skin is limited by the cell width */
+  {
+    double lcell[3] = {4.0, 5.0, 6.0};
+    double skineff = -1.0;
+
+    colloid_pair_list_skin_effective(list, lcell, 3.0, &skineff);
+    assert(fabs(skineff - 0.5) < DBL_EPSILON);
+    colloid_pair_list_skin_effective(list, lcell, 3.75, &skineff);
+    assert(fabs(skineff - 0.25) < DBL_EPSILON);
+    colloid_pair_list_skin_effective(list, lcell, 4.5, &skineff);
+    assert(fabs(skineff - 0.0) < DBL_EPSILON);
+  }
+
+  colloid_pair_list_free(list);
+
+  return ifail;
+}
+
+/*****************************************************************************
+ *
+ *  test_colloid_pair_list_update
+ *
+ *  Two colloids in range of one another, and a third out of range.
+ *  Check the list is only rebuilt when required.
+ *
+ *****************************************************************************/
+
+int test_colloid_pair_list_update(pe_t * pe, cs_t * cs) {
+
+  int ncell[3] = {2, 2, 2};
+  double ah = 1.0;
+  double hc = 0.5;
+  double rc = 0.0;
+  double skin = 0.8;
+  double ltot[3] = {0};
+  double r1[3] = {0};
+  double r2[3] = {0};
+  double r3[3] = {0};
+  double r4[3] = {0};
+
+  colloids_info_t * cinfo = NULL;
+  colloid_pair_list_t * list = NULL;
+  colloid_t * pc1 = NULL;
+  colloid_t * pc2 = NULL;
+  colloid_t * pc3 = NULL;
+  colloid_t * pc4 = NULL;
+
+  assert(pe);
+  assert(cs);
+
+  /* Only meaningful if all the colloids are on one rank */
+  if (pe_mpi_size(pe) > 1) return 0;
+
+  cs_ltot(cs, ltot);
+  colloids_info_create(pe, cs, ncell, &cinfo);
+  assert(cinfo);
+
+  list = cinfo->plist;
+  assert(list);
+  colloid_pair_list_skin_set(list, skin);
+
+  r1[X] = 0.5*ltot[X]; r1[Y] = 0.5*ltot[Y]; r1[Z] = 0.5*ltot[Z];
+  r2[X] = r1[X] + 2.0*ah + 0.25; r2[Y] = r1[Y]; r2[Z] = r1[Z];
+  r3[X] = r1[X]; r3[Y] = r1[Y] + 10.0; r3[Z] = r1[Z];
+
+  colloids_info_add_local(cinfo, 1, r1, &pc1);
+  colloids_info_add_local(cinfo, 2, r2, &pc2);
+  colloids_info_add_local(cinfo, 3, r3, &pc3);
+  assert(pc1);
+  assert(pc2);
+  assert(pc3);
+  pc1->s.ah = ah;
+  pc2->s.ah = ah;
+  pc3->s.ah = ah;
+
+  /* First update must build; only the pair (1,2) is in range */
+
+  colloid_pair_list_update(list, cinfo, hc, rc, 0);
+  assert(list->nbuild == 1);
+  assert(list->npair == 1);
+  assert(list->pair[0].pc1 == pc1);
+  assert(list->pair[0].pc2 == pc2);
+  assert(fabs(list->pair[0].r12[X] - (2.0*ah + 0.25)) < DBL_EPSILON);
+
+  /* No movement: no rebuild */
+
+  colloid_pair_list_update(list, cinfo, hc, rc, 0);
+  assert(list->nbuild == 1);
+  assert(list->nupdate == 2);
+
+  /* A small movement (less than skin/2): separation is updated only */
+
+  pc2->s.r[X] += 0.25;
+  colloid_pair_list_update(list, cinfo, hc, rc, 0);
+  assert(list->nbuild == 1);
+  assert(fabs(list->pair[0].r12[X] - (2.0*ah + 0.5)) < FLT_EPSILON);
+
+  /* Further movement (more than skin/2 in total): rebuild */
+
+  pc2->s.r[X] += 0.25;
+  colloid_pair_list_update(list, cinfo, hc, rc, 0);
+  assert(list->nbuild == 2);
+  assert(list->npair == 1);
+
+  /* A full list contains all three pairs */
+
+  colloid_pair_list_update(list, cinfo, hc, rc, 1);
+  assert(list->nbuild == 3);
+  assert(list->npair == 3);
+
+  /* Back to restricted range; then a change in range */
+
+  colloid_pair_list_update(list, cinfo, hc, rc, 0);
+  assert(list->nbuild == 4);
+  assert(list->npair == 1);
+
+  colloid_pair_list_update(list, cinfo, hc, 10.0, 0);
+  assert(list->nbuild == 5);
+  assert(list->npair == 3);
+
+  /* A new colloid (out of range) changes the cell list: rebuild */
+
+  r4[X] = r1[X]; r4[Y] = r1[Y]; r4[Z] = r1[Z] - 20.0;
+  colloids_info_add_local(cinfo, 4, r4, &pc4);
+  assert(pc4);
+  pc4->s.ah = ah;
+
+  colloid_pair_list_update(list, cinfo, hc, 10.0, 0);
+  assert(list->nbuild == 6);
+  assert(list->npair == 3);
+
+  /* A small move to another local cell changes the cell list, but
+   * not the ownership: no rebuild */
+
+  {
+    unsigned int version = cinfo->clist_version;
+    double lcell[3] = {0};
+
+    colloids_info_lcell(cinfo, lcell);
+    pc4->s.r[Y] = r1[Y] - 20.0;
+    pc4->s.r[Z] = 0.5 + lcell[Z] - 0.05;
+    colloids_info_update_cell_list(cinfo);
+    colloid_pair_list_update(list, cinfo, hc, 10.0, 0);
+    assert(list->nbuild == 7);
+
+    pc4->s.r[Z] += 0.1;
+    colloids_info_update_cell_list(cinfo);
+    assert(cinfo->clist_version != version);
+    colloid_pair_list_update(list, cinfo, hc, 10.0, 0);
+    assert(list->nbuild == 7);
+
+    /* A small move from a local cell to a halo cell: rebuild */
+
+    pc4->s.r[Z] = 0.5 + ltot[Z] - 0.05;
+    colloid_pair_list_update(list, cinfo, hc, 10.0, 0);
+    assert(list->nbuild == 8);
+
+    pc4->s.r[Z] += 0.1;
+    colloids_info_update_cell_list(cinfo);
+    colloid_pair_list_update(list, cinfo, hc, 10.0, 0);
+    assert(list->nbuild == 9);
+  }
+
+  colloids_info_free(cinfo);
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  test_colloid_pair_list_force_add
+ *
+ *  Three colloids in a row; all pairs are in the list. The force
+ *  added must agree exactly with the serial loop over pairs.
+ *
+ *****************************************************************************/
+
+int test_colloid_pair_list_force_add(pe_t * pe, cs_t * cs) {
+
+  int ncell[3] = {2, 2, 2};
+  double ltot[3] = {0};
+  double fexpect[3][3] = {0};
+
+  colloids_info_t * cinfo = NULL;
+  colloid_pair_list_t * list = NULL;
+  colloid_t * pc[3] = {NULL};
+
+  assert(pe);
+  assert(cs);
+
+  if (pe_mpi_size(pe) > 1) return 0;
+
+  cs_ltot(cs, ltot);
+  colloids_info_create(pe, cs, ncell, &cinfo);
+  assert(cinfo);
+  list = cinfo->plist;
+
+  for (int ic = 0; ic < 3; ic++) {
+    double r[3] = {0.5*ltot[X] + 2.5*ic, 0.5*ltot[Y], 0.5*ltot[Z]};
+    colloids_info_add_local(cinfo, 1 + ic, r, pc + ic);
+    assert(pc[ic]);
+    pc[ic]->s.ah = 1.0;
+  }
+
+  colloid_pair_list_update(list, cinfo, 0.0, 6.0, 0);
+  assert(list->npair == 3);
+
+  /* Arbitrary pair forces; expected result from serial accumulation */
+
+  for (int n = 0; n < list->npair; n++) {
+    colloid_pair_t * p = list->pair + n;
+    for (int ia = 0; ia < 3; ia++) {
+      list->f12[3*n + ia] = 1.0/(1.0 + 3.0*n + ia);
+      fexpect[p->pc1->s.index - 1][ia] += list->f12[3*n + ia];
+      fexpect[p->pc2->s.index - 1][ia] -= list->f12[3*n + ia];
+    }
+  }
+
+  colloid_pair_list_force_add(list);
+
+  for (int ic = 0; ic < 3; ic++) {
+    assert(pc[ic]->force[X] == fexpect[ic][X]);
+    assert(pc[ic]->force[Y] == fexpect[ic][Y]);
+    assert(pc[ic]->force[Z] == fexpect[ic][Z]);
+  }
+
+  colloids_info_free(cinfo);
+
+  return 0;
+}
@@ -7,7 +7,7 @@
  *  Edinburgh Soft Matter and Statistical Physics Group and
  *  Edinburgh Parallel Computing Centre
  *
- *  (c) 2010-2020 The University of Edinburgh
+ *  (c) 2010-2024 The University of Edinburgh
  *
  *  Contributing authors:
  *  Kevin Stratford (kevin@epcc.ed.ac.uk)
@@ -34,6 +34,7 @@ static int test_colloid_sums_edge(pe_t * pe, cs_t * cs, int ncell[3],
 				  const double r0[3]);
 static int test_colloid_sums_move(pe_t * pe);
 static int test_colloid_sums_conservation(pe_t * pe);
+static int test_colloid_sums_batch(pe_t * pe);
 
 int test_colloid_sums_assert(const colloid_t * c1, const colloid_t * c2);
 
@@ -52,6 +53,7 @@ int test_colloid_sums_suite(void) {
   test_colloid_sums_1d(pe);
   test_colloid_sums_move(pe);
   test_colloid_sums_conservation(pe);
+  test_colloid_sums_batch(pe);
 
   pe_info(pe, "PASS     ./unit/test_colloid_sums\n");
   pe_free(pe);
@@ -492,3 +494,73 @@ int test_colloid_sums_conservation(pe_t * pe) {
 
   return 0;
 }
+
+/*****************************************************************************
+ *
+ *  test_colloid_sums_batch
+ *
+ *  Conservation and subgrid messages in the same exchange. All copies
+ *  should see the sum of both.
+ *
+ *****************************************************************************/
+
+static int test_colloid_sums_batch(pe_t * pe) {
+
+  int ntotal[3] = {64, 64, 64};
+  int ncell[3] = {8, 8, 8};
+  double r0[3] = {1.0, 1.0, 1.0};
+  colloid_sum_enum_t mtype[2] = {COLLOID_SUM_CONSERVATION,
+				 COLLOID_SUM_SUBGRID};
+
+  cs_t * cs = NULL;
+  colloid_t * pc = NULL;
+  colloids_info_t * cinfo = NULL;
+
+  assert(pe);
+
+  cs_create(pe, &cs);
+  cs_ntotal_set(cs, ntotal);
+  cs_init(cs);
+
+  colloids_info_create(pe, cs, ncell, &cinfo);
+  assert(cinfo);
+
+  /* A colloid in the corner has copies in all three directions */
+
+  colloids_info_add_local(cinfo, 1, r0, &pc);
+  colloids_halo_state(cinfo);
+
+  if (pc) {
+    pc->s.deltaphi = 1.0;
+    pc->dq[0]   = 10.0;
+    pc->dq[1]   = 100.0;
+    pc->fsub[X] = 2.0;
+    pc->fsub[Y] = 3.0;
+    pc->fsub[Z] = 4.0;
+  }
+
+  colloid_sums_halo_batch(cinfo, 2, mtype);
+
+  for (int ic = 0; ic <= ncell[X] + 1; ic++) {
+    for (int jc = 0; jc <= ncell[Y] + 1; jc++) {
+      for (int kc = 0; kc <= ncell[Z] + 1; kc++) {
+
+	colloids_info_cell_list_head(cinfo, ic, jc, kc, &pc);
+
+	for (; pc; pc = pc->next) {
+	  test_assert(fabs(pc->s.deltaphi - 1.0) < DBL_EPSILON);
+	  test_assert(fabs(pc->dq[0] - 10.0) < DBL_EPSILON);
+	  test_assert(fabs(pc->dq[1] - 100.0) < DBL_EPSILON);
+	  test_assert(fabs(pc->fsub[X] - 2.0) < DBL_EPSILON);
+	  test_assert(fabs(pc->fsub[Y] - 3.0) < DBL_EPSILON);
+	  test_assert(fabs(pc->fsub[Z] - 4.0) < DBL_EPSILON);
+	}
+      }
+    }
+  }
+
+  colloids_info_free(cinfo);
+  cs_free(cs);
+
+  return 0;
+}
@@ -7,7 +7,7 @@
  *  Edinburgh Soft Matter and Statistical Physics Group and
  *  Edinburgh Parallel Computing Centre
  *
- *  (c) 2010-2017 The University of Edinburgh
+ *  (c) 2010-2024 The University of Edinburgh
  *
  *  Contributing authors:
  *  Kevin Stratford (kevin@epcc.ed.ac.uk)
@@ -17,6 +17,7 @@
 #include <assert.h>
 #include <math.h>
 #include <float.h>
+#include <string.h>
 
 #include "pe.h"
 #include "coords.h"
@@ -27,6 +28,7 @@
 int test_colloids_halo111(pe_t * pe, cs_t * cs);
 int test_colloids_halo211(pe_t * pe, cs_t * cs);
 int test_colloids_halo_repeat(pe_t * pe, cs_t * cs);
+int test_colloids_halo_persistent(pe_t * pe);
 static void test_position(cs_t * cs, const double r1[3], const double r2[3]);
 
 /*****************************************************************************
@@ -49,6 +51,7 @@ int test_colloids_halo_suite(void) {
   test_colloids_halo111(pe, cs);
   test_colloids_halo211(pe, cs);
   test_colloids_halo_repeat(pe, cs);
+  test_colloids_halo_persistent(pe);
 
   pe_info(pe, "PASS     ./unit/test_colloids_halo\n");
   cs_free(cs);
@@ -410,6 +413,109 @@ int test_colloids_halo_repeat(pe_t * pe, cs_t * cs) {
   return 0;
 }
 
+/*****************************************************************************
+ *
+ *  test_colloids_halo_persistent
+ *
+ *  Two colloids are moved across the system with and without the
+ *  persistent lists; all copies must agree exactly at each step,
+ *  whether or not the cell list has changed.
+ *
+ *****************************************************************************/
+
+int test_colloids_halo_persistent(pe_t * pe) {
+
+  int ntotal[3] = {64, 64, 64};
+  int ncell[3] = {4, 4, 4};
+  int nstep = 100;
+  double r0[2][3] = {{56.55, 8.55, 3.0}, {3.5, 60.2, 33.3}};
+  double dx;
+
+  cs_t * cs = NULL;
+  colloids_info_t * cinfo[2] = {NULL};
+
+  assert(pe);
+
+  cs_create(pe, &cs);
+  cs_ntotal_set(cs, ntotal);
+  cs_init(cs);
+
+  dx = 1.0*ntotal[X]/nstep;
+
+  for (int p = 0; p < 2; p++) {
+    colloids_info_create(pe, cs, ncell, cinfo + p);
+    for (int n = 0; n < 2; n++) {
+      colloid_t * pc = NULL;
+      colloids_info_add_local(cinfo[p], 1 + n, r0[n], &pc);
+    }
+  }
+
+  colloids_halo_persistent_set(cinfo[1], 1);
+  assert(cinfo[0]->halo == NULL);
+  assert(cinfo[1]->halo);
+
+  for (int n = 0; n <= nstep; n++) {
+
+    for (int p = 0; p < 2; p++) {
+
+      /* Move all copies; then update the velocity of the owner only */
+
+      for (int ic = 0; ic <= ncell[X] + 1; ic++) {
+	for (int jc = 0; jc <= ncell[Y] + 1; jc++) {
+	  for (int kc = 0; kc <= ncell[Z] + 1; kc++) {
+	    colloid_t * pc = NULL;
+	    colloids_info_cell_list_head(cinfo[p], ic, jc, kc, &pc);
+	    for (; pc; pc = pc->next) {
+	      pc->s.r[X] += 0.5*dx;
+	      pc->s.r[Y] -= dx;
+	    }
+	  }
+	}
+      }
+
+      colloids_info_update_cell_list(cinfo[p]);
+
+      for (int ic = 1; ic <= ncell[X]; ic++) {
+	for (int jc = 1; jc <= ncell[Y]; jc++) {
+	  for (int kc = 1; kc <= ncell[Z]; kc++) {
+	    colloid_t * pc = NULL;
+	    colloids_info_cell_list_head(cinfo[p], ic, jc, kc, &pc);
+	    for (; pc; pc = pc->next) pc->s.v[Z] = 1.0*n + pc->s.index;
+	  }
+	}
+      }
+
+      colloids_halo_state(cinfo[p]);
+    }
+
+    /* Compare */
+
+    for (int ic = 0; ic <= ncell[X] + 1; ic++) {
+      for (int jc = 0; jc <= ncell[Y] + 1; jc++) {
+	for (int kc = 0; kc <= ncell[Z] + 1; kc++) {
+	  colloid_t * pc0 = NULL;
+	  colloid_t * pc1 = NULL;
+	  colloids_info_cell_list_head(cinfo[0], ic, jc, kc, &pc0);
+	  colloids_info_cell_list_head(cinfo[1], ic, jc, kc, &pc1);
+	  for (; pc0; pc0 = pc0->next, pc1 = pc1->next) {
+	    test_assert(pc1 != NULL);
+	    double vz = 1.0*n + pc1->s.index;
+	    test_assert(memcmp(&pc0->s, &pc1->s, sizeof(colloid_state_t)) == 0);
+	    test_assert(fabs(pc1->s.v[Z] - vz) < DBL_EPSILON);
+	  }
+	  test_assert(pc1 == NULL);
+	}
+      }
+    }
+  }
+
+  colloids_info_free(cinfo[1]);
+  colloids_info_free(cinfo[0]);
+  cs_free(cs);
+
+  return 0;
+}
+
 /*****************************************************************************
  *
  *  test_position
@@ -8,13 +8,14 @@
  *  Edinburgh Soft Matter and Statistical Physics Group and
  *  Edinburgh Parallel Computing Centre
  *
- *  (c) 2022 The University of Edinburgh
+ *  (c) 2022-2024 The University of Edinburgh
  *
  *  Kevin Stratford (kevin@epcc.ed.ac.uk)
  *
  *****************************************************************************/
 
 #include <assert.h>
+#include <stdlib.h>
 
 #include "pe.h"
 #include "cs_limits.h"
@@ -25,6 +26,7 @@ int test_cs_limits_ic(cs_limits_t lim);
 int test_cs_limits_jc(cs_limits_t lim);
 int test_cs_limits_kc(cs_limits_t lim);
 int test_cs_limits_index(cs_limits_t lim);
+int test_cs_limits_shell(cs_limits_t lim, int nw);
 
 /*****************************************************************************
  *
@@ -68,6 +70,10 @@ int test_cs_limits(int imin, int imax, int jmin, int jmax, int kmin, int kmax) {
   test_cs_limits_ic(lim);
   test_cs_limits_index(lim);
 
+  for (int nw = 0; nw <= 3; nw++) {
+    test_cs_limits_shell(lim, nw);
+  }
+
   return 0;
 }
 /*****************************************************************************
@@ -198,3 +204,57 @@ int test_cs_limits_index(cs_limits_t lim) {
 
   return ifail;
 }
+
+/*****************************************************************************
+ *
+ *  test_cs_limits_shell
+ *
+ *  The shell slabs and the interior must cover lim exactly once.
+ *
+ *****************************************************************************/
+
+int test_cs_limits_shell(cs_limits_t lim, int nw) {
+
+  int ifail = 0;
+  int nsites = cs_limits_size(lim);
+  int * count = (int *) calloc(nsites, sizeof(int));
+  cs_limits_t shell[6] = {0};
+  cs_limits_t interior = cs_limits_interior(lim, nw);
+
+  int nshell = cs_limits_shell(lim, nw, shell);
+
+  assert(count);
+  assert(0 <= nshell && nshell <= 6);
+
+  for (int n = 0; n < nshell; n++) {
+    /* Each slab is non-empty and within lim */
+    assert(shell[n].imin >= lim.imin && shell[n].imax <= lim.imax);
+    assert(shell[n].jmin >= lim.jmin && shell[n].jmax <= lim.jmax);
+    assert(shell[n].kmin >= lim.kmin && shell[n].kmax <= lim.kmax);
+    for (int ic = shell[n].imin; ic <= shell[n].imax; ic++) {
+      for (int jc = shell[n].jmin; jc <= shell[n].jmax; jc++) {
+	for (int kc = shell[n].kmin; kc <= shell[n].kmax; kc++) {
+	  count[cs_limits_index(lim, ic, jc, kc)] += 1;
+	}
+      }
+    }
+  }
+
+  /* Interior may be empty */
+  for (int ic = interior.imin; ic <= interior.imax; ic++) {
+    for (int jc = interior.jmin; jc <= interior.jmax; jc++) {
+      for (int kc = interior.kmin; kc <= interior.kmax; kc++) {
+	count[cs_limits_index(lim, ic, jc, kc)] += 1;
+      }
+    }
+  }
+
+  for (int n = 0; n < nsites; n++) {
+    assert(count[n] == 1);
+    if (count[n] != 1) ifail += 1;
+  }
+
+  free(count);
+
+  return ifail;
+}
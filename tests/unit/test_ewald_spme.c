@@ -0,0 +1,495 @@
+/*****************************************************************************
+ *
+ *  test_ewald_spme.c
+ *
+ *  Smooth particle mesh Ewald: B-splines, and comparison with the
+ *  direct Fourier space sum. The tests run on any number of ranks.
+ *
+ *  Edinburgh Soft Matter and Statistical Physics Group and
+ *  Edinburgh Parallel Computing Centre
+ *
+ *  (c) 2024 The University of Edinburgh
+ *
+ *  Contributing authors:
+ *  Kevin Stratford (kevin@epcc.ed.ac.uk)
+ *
+ *****************************************************************************/
+
+#include <assert.h>
+#include <float.h>
+#include <math.h>
+
+#include "pe.h"
+#include "coords.h"
+#include "colloids.h"
+#include "ewald.h"
+#include "ewald_spme.h"
+#include "tests.h"
+
+int test_ewald_spme_bspline(void);
+int test_ewald_spme_create(pe_t * pe, cs_t * cs);
+int test_ewald_spme_direct(pe_t * pe, cs_t * cs);
+int test_ewald_spme_gradient(pe_t * pe, cs_t * cs);
+int test_ewald_spme_decomposition(pe_t * pe, cs_t * cs);
+
+/*****************************************************************************
+ *
+ *  test_ewald_spme_suite
+ *
+ *****************************************************************************/
+
+int test_ewald_spme_suite(void) {
+
+  pe_t * pe = NULL;
+  cs_t * cs = NULL;
+
+  pe_create(MPI_COMM_WORLD, PE_QUIET, &pe);
+  cs_create(pe, &cs);
+  cs_init(cs);
+
+  test_ewald_spme_bspline();
+  test_ewald_spme_create(pe, cs);
+  test_ewald_spme_direct(pe, cs);
+  test_ewald_spme_gradient(pe, cs);
+  test_ewald_spme_decomposition(pe, cs);
+
+  pe_info(pe, "PASS     ./unit/test_ewald_spme\n");
+  cs_free(cs);
+  pe_free(pe);
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  test_ewald_spme_bspline
+ *
+ *  M_4 at integer arguments is 1/6, 4/6, 1/6, 0. For all orders the
+ *  weights sum to unity and the derivatives sum to zero.
+ *
+ *****************************************************************************/
+
+int test_ewald_spme_bspline(void) {
+
+  double m[EWALD_SPME_ORDER_MAX] = {0};
+  double dm[EWALD_SPME_ORDER_MAX] = {0};
+  double d2m[EWALD_SPME_ORDER_MAX] = {0};
+
+  ewald_spme_bspline(4, 0.0, m, dm, d2m);
+  assert(fabs(m[0] - 0.0)     < DBL_EPSILON);
+  assert(fabs(m[1] - 1.0/6.0) < DBL_EPSILON);
+  assert(fabs(m[2] - 4.0/6.0) < DBL_EPSILON);
+  assert(fabs(m[3] - 1.0/6.0) < DBL_EPSILON);
+
+  /* M_4'(x) at x = 1, 2, 3 is 1/2, 0, -1/2; M_4''(x) is 1, -2, 1 */
+
+  assert(fabs(dm[1] - 0.5) < DBL_EPSILON);
+  assert(fabs(dm[2] - 0.0) < DBL_EPSILON);
+  assert(fabs(dm[3] + 0.5) < DBL_EPSILON);
+  assert(fabs(d2m[1] - 1.0) < DBL_EPSILON);
+  assert(fabs(d2m[2] + 2.0) < DBL_EPSILON);
+  assert(fabs(d2m[3] - 1.0) < DBL_EPSILON);
+
+  for (int p = EWALD_SPME_ORDER_MIN; p <= EWALD_SPME_ORDER_MAX; p++) {
+    double w = 0.3;
+    double sm = 0.0;
+    double sdm = 0.0;
+    double sd2m = 0.0;
+    ewald_spme_bspline(p, w, m, dm, d2m);
+    for (int k = 0; k < p; k++) {
+      assert(m[k] >= 0.0);
+      sm += m[k];
+      sdm += dm[k];
+      sd2m += d2m[k];
+    }
+    assert(fabs(sm - 1.0) < FLT_EPSILON);
+    assert(fabs(sdm) < FLT_EPSILON);
+    assert(fabs(sd2m) < FLT_EPSILON);
+  }
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  test_ewald_spme_create
+ *
+ *****************************************************************************/
+
+int test_ewald_spme_create(pe_t * pe, cs_t * cs) {
+
+  int ifail = 0;
+  int order = 0;
+  int ngrid[3] = {16, 32, 8};
+  int nbad[3] = {16, 24, 8};
+  ewald_spme_t * spme = NULL;
+
+  assert(pe);
+  assert(cs);
+
+  ifail = ewald_spme_create(pe, cs, 6, nbad, 1.0, 0.1, &spme);
+  assert(ifail != 0);
+  assert(spme == NULL);
+
+  ifail = ewald_spme_create(pe, cs, EWALD_SPME_ORDER_MAX + 1, ngrid, 1.0,
+			    0.1, &spme);
+  assert(ifail != 0);
+  assert(spme == NULL);
+
+  ifail = ewald_spme_create(pe, cs, 6, ngrid, 1.0, 0.1, &spme);
+  assert(ifail == 0);
+  assert(spme);
+
+  ewald_spme_order(spme, &order);
+  assert(order == 6);
+  ewald_spme_ngrid(spme, nbad);
+  assert(nbad[X] == ngrid[X]);
+  assert(nbad[Y] == ngrid[Y]);
+  assert(nbad[Z] == ngrid[Z]);
+
+  ewald_spme_free(spme);
+
+  return ifail;
+}
+
+/*****************************************************************************
+ *
+ *  test_ewald_spme_colloids
+ *
+ *  Two dipoles in general orientations. On more than one rank, the
+ *  pointer is NULL on ranks not holding the colloid.
+ *
+ *****************************************************************************/
+
+static colloids_info_t * test_ewald_spme_colloids(pe_t * pe, cs_t * cs,
+						  colloid_t * pc[2]) {
+  int ncell[3] = {2, 2, 2};
+  double r1[3] = {3.0, 3.0, 3.0};
+  double r2[3] = {7.5, 12.2, 9.3};
+  double s1[3] = {0.0, 0.6, 0.8};
+  double s2[3] = {0.48, 0.6, -0.64};
+  colloids_info_t * cinfo = NULL;
+
+  colloids_info_create(pe, cs, ncell, &cinfo);
+  colloids_info_add_local(cinfo, 1, r1, pc + 0);
+  colloids_info_add_local(cinfo, 2, r2, pc + 1);
+  colloids_info_ntotal_set(cinfo);
+  colloids_info_list_local_build(cinfo);
+
+  for (int n = 0; n < 2; n++) {
+    if (pc[n] == NULL) continue;
+    for (int ia = 0; ia < 3; ia++) {
+      pc[n]->s.s[ia] = (n == 0) ? s1[ia] : s2[ia];
+    }
+    pc[n]->s.magnetic = 1;
+  }
+
+  return cinfo;
+}
+
+/*****************************************************************************
+ *
+ *  test_ewald_spme_direct
+ *
+ *  The particle mesh energy, force and torque should agree with the
+ *  direct Fourier space sum. The direct sum is truncated at kmax, so
+ *  the agreement is at the level of 1% for this cut off.
+ *
+ *****************************************************************************/
+
+int test_ewald_spme_direct(pe_t * pe, cs_t * cs) {
+
+  int ngrid[3] = {0};
+  double mu = 0.285;
+  double rc = 16.0;
+  double tol = 1.0e-02;
+  double edirect = 0.0;
+  double espme = 0.0;
+  double ereal, efourier, eself;
+  double f[2][3] = {0};
+  double t[2][3] = {0};
+  double fscale = 0.0;
+  double tscale = 0.0;
+
+  colloids_info_t * cinfo = NULL;
+  colloid_t * pc[2] = {NULL};
+  ewald_t * ewald = NULL;
+
+  assert(pe);
+  assert(cs);
+
+  cinfo = test_ewald_spme_colloids(pe, cs, pc);
+  ewald_create(pe, cs, mu, rc, cinfo, &ewald);
+  assert(ewald);
+
+  /* Direct */
+
+  ewald_fourier_space_energy(ewald, &edirect);
+  ewald_fourier_space_sum(ewald);
+
+  for (int n = 0; n < 2; n++) {
+    if (pc[n] == NULL) continue;
+    for (int ia = 0; ia < 3; ia++) {
+      f[n][ia] = pc[n]->force[ia];
+      t[n][ia] = pc[n]->torque[ia];
+      fscale = fmax(fscale, fabs(f[n][ia]));
+      tscale = fmax(tscale, fabs(t[n][ia]));
+      pc[n]->force[ia] = 0.0;
+      pc[n]->torque[ia] = 0.0;
+    }
+  }
+
+  {
+    MPI_Comm comm = MPI_COMM_NULL;
+    cs_cart_comm(cs, &comm);
+    MPI_Allreduce(MPI_IN_PLACE, &fscale, 1, MPI_DOUBLE, MPI_MAX, comm);
+    MPI_Allreduce(MPI_IN_PLACE, &tscale, 1, MPI_DOUBLE, MPI_MAX, comm);
+  }
+
+  /* Particle mesh (default mesh) */
+
+  {
+    int ifail = ewald_spme_set(ewald, EWALD_SPME_ORDER_DEFAULT, ngrid);
+    assert(ifail == 0);
+  }
+
+  ewald_fourier_space_energy(ewald, &espme);
+  assert(fabs(espme - edirect) < tol*fabs(edirect));
+
+  ewald_fourier_space_sum(ewald);
+  ewald_total_energy(ewald, &ereal, &efourier, &eself);
+  assert(fabs(efourier - espme) < DBL_EPSILON*fabs(espme));
+
+  for (int n = 0; n < 2; n++) {
+    if (pc[n] == NULL) continue;
+    for (int ia = 0; ia < 3; ia++) {
+      assert(fabs(pc[n]->force[ia] - f[n][ia]) < tol*fscale);
+      assert(fabs(pc[n]->torque[ia] - t[n][ia]) < tol*tscale);
+    }
+  }
+
+  /* A finer mesh and higher order converges to the same energy */
+
+  {
+    int nfine[3] = {64, 64, 64};
+    double efine = 0.0;
+    int ifail = ewald_spme_set(ewald, 10, nfine);
+    assert(ifail == 0);
+    ewald_fourier_space_energy(ewald, &efine);
+    assert(fabs(efine - espme) < 1.0e-04*fabs(efine));
+  }
+
+  ewald_free(ewald);
+  colloids_info_free(cinfo);
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  test_ewald_spme_gradient
+ *
+ *  The force and torque are the exact derivatives of the particle
+ *  mesh energy: check against finite differences.
+ *
+ *****************************************************************************/
+
+int test_ewald_spme_gradient(pe_t * pe, cs_t * cs) {
+
+  int ngrid[3] = {32, 32, 32};
+  double mu = 0.285;
+  double rc = 16.0;
+  double dr = 1.0e-04;
+  double tol = 1.0e-06;
+  double f[3] = {0};
+  double t[3] = {0};
+
+  colloids_info_t * cinfo = NULL;
+  colloid_t * pc[2] = {NULL};
+  ewald_t * ewald = NULL;
+
+  assert(pe);
+  assert(cs);
+
+  cinfo = test_ewald_spme_colloids(pe, cs, pc);
+  ewald_create(pe, cs, mu, rc, cinfo, &ewald);
+  assert(ewald);
+  ewald_spme_set(ewald, 4, ngrid);
+
+  ewald_fourier_space_sum(ewald);
+
+  /* The energy is collective; only the rank holding the colloid
+   * moves it, and checks the result. */
+
+  if (pc[1] == NULL) {
+    for (int ncall = 0; ncall < 12; ncall++) {
+      double e = 0.0;
+      ewald_fourier_space_energy(ewald, &e);
+    }
+    ewald_free(ewald);
+    colloids_info_free(cinfo);
+    return 0;
+  }
+
+  for (int ia = 0; ia < 3; ia++) {
+    f[ia] = pc[1]->force[ia];
+    t[ia] = pc[1]->torque[ia];
+  }
+
+  for (int ia = 0; ia < 3; ia++) {
+    double r0 = pc[1]->s.r[ia];
+    double s0[3] = {pc[1]->s.s[X], pc[1]->s.s[Y], pc[1]->s.s[Z]};
+    double ep = 0.0;
+    double em = 0.0;
+    double fd = 0.0;
+
+    /* Force: central difference in position */
+
+    pc[1]->s.r[ia] = r0 + dr;
+    ewald_fourier_space_energy(ewald, &ep);
+    pc[1]->s.r[ia] = r0 - dr;
+    ewald_fourier_space_energy(ewald, &em);
+    pc[1]->s.r[ia] = r0;
+
+    fd = -(ep - em)/(2.0*dr);
+    assert(fabs(f[ia] - fd) < tol*fabs(ep));
+
+    /* Torque: small rotation about axis ia, s -> s + dphi e_ia x s */
+
+    for (int sign = -1; sign <= 1; sign += 2) {
+      double e[3] = {0};
+      double es[3] = {0};
+      e[ia] = sign*dr;
+      es[X] = e[Y]*s0[Z] - e[Z]*s0[Y];
+      es[Y] = e[Z]*s0[X] - e[X]*s0[Z];
+      es[Z] = e[X]*s0[Y] - e[Y]*s0[X];
+      for (int ib = 0; ib < 3; ib++) {
+	pc[1]->s.s[ib] = s0[ib] + es[ib];
+      }
+      ewald_fourier_space_energy(ewald, (sign > 0) ? &ep : &em);
+    }
+    for (int ib = 0; ib < 3; ib++) {
+      pc[1]->s.s[ib] = s0[ib];
+    }
+
+    fd = -(ep - em)/(2.0*dr);
+    assert(fabs(t[ia] - fd) < tol*fabs(ep));
+  }
+
+  ewald_free(ewald);
+  colloids_info_free(cinfo);
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  test_ewald_spme_decomposition
+ *
+ *  One dipole in each octant of the system, plus one close to the
+ *  periodic boundary in x, so that on more than one rank the dipoles
+ *  and the ghost planes of the mesh are exchanged between ranks.
+ *  The energy, force, and torque are compared with the (truncated)
+ *  direct sum; the forces between well separated dipoles are small,
+ *  so the agreement is at the level of 2%.
+ *
+ *****************************************************************************/
+
+int test_ewald_spme_decomposition(pe_t * pe, cs_t * cs) {
+
+  int ncell[3] = {2, 2, 2};
+  int ngrid[3] = {0};
+  int ndipole = 9;
+  double mu = 0.285;
+  double rc = 16.0;
+  double tol = 2.0e-02;
+  double ltot[3] = {0};
+  double edirect = 0.0;
+  double espme = 0.0;
+  double fscale = 0.0;
+  double tscale = 0.0;
+  double f[9][3] = {0};
+  double t[9][3] = {0};
+  colloid_t * pc[9] = {NULL};
+  colloids_info_t * cinfo = NULL;
+  ewald_t * ewald = NULL;
+  MPI_Comm comm = MPI_COMM_NULL;
+
+  assert(pe);
+  assert(cs);
+
+  cs_ltot(cs, ltot);
+  cs_cart_comm(cs, &comm);
+  colloids_info_create(pe, cs, ncell, &cinfo);
+
+  for (int n = 0; n < ndipole; n++) {
+    /* Octants, and a ninth dipole at x = 1.2 */
+    double r[3] = {0};
+    double s[3] = {0};
+    double smod = 0.0;
+    r[X] = (n == 8) ? 1.2 : 0.25*ltot[X]*(1 + 2*((n >> 2) & 1)) + 0.3*n;
+    r[Y] = 0.25*ltot[Y]*(1 + 2*((n >> 1) & 1)) + 0.7;
+    r[Z] = 0.25*ltot[Z]*(1 + 2*(n & 1)) - 0.4*n;
+    s[X] = 1.0 + n;
+    s[Y] = 2.0 - n;
+    s[Z] = 0.5*n - 1.0;
+    smod = sqrt(s[X]*s[X] + s[Y]*s[Y] + s[Z]*s[Z]);
+    colloids_info_add_local(cinfo, 1 + n, r, pc + n);
+    if (pc[n] == NULL) continue;
+    for (int ia = 0; ia < 3; ia++) {
+      pc[n]->s.s[ia] = s[ia]/smod;
+    }
+    pc[n]->s.magnetic = 1;
+  }
+
+  colloids_info_ntotal_set(cinfo);
+  colloids_info_list_local_build(cinfo);
+
+  ewald_create(pe, cs, mu, rc, cinfo, &ewald);
+  assert(ewald);
+
+  /* Direct */
+
+  ewald_fourier_space_energy(ewald, &edirect);
+  ewald_fourier_space_sum(ewald);
+
+  for (int n = 0; n < ndipole; n++) {
+    if (pc[n] == NULL) continue;
+    for (int ia = 0; ia < 3; ia++) {
+      f[n][ia] = pc[n]->force[ia];
+      t[n][ia] = pc[n]->torque[ia];
+      fscale = fmax(fscale, fabs(f[n][ia]));
+      tscale = fmax(tscale, fabs(t[n][ia]));
+      pc[n]->force[ia] = 0.0;
+      pc[n]->torque[ia] = 0.0;
+    }
+  }
+
+  MPI_Allreduce(MPI_IN_PLACE, &fscale, 1, MPI_DOUBLE, MPI_MAX, comm);
+  MPI_Allreduce(MPI_IN_PLACE, &tscale, 1, MPI_DOUBLE, MPI_MAX, comm);
+
+  /* Particle mesh */
+
+  {
+    int ifail = ewald_spme_set(ewald, EWALD_SPME_ORDER_DEFAULT, ngrid);
+    assert(ifail == 0);
+  }
+
+  ewald_fourier_space_energy(ewald, &espme);
+  assert(fabs(espme - edirect) < tol*fabs(edirect));
+
+  ewald_fourier_space_sum(ewald);
+
+  for (int n = 0; n < ndipole; n++) {
+    if (pc[n] == NULL) continue;
+    for (int ia = 0; ia < 3; ia++) {
+      assert(fabs(pc[n]->force[ia] - f[n][ia]) < tol*fscale);
+      assert(fabs(pc[n]->torque[ia] - t[n][ia]) < tol*tscale);
+    }
+  }
+
+  ewald_free(ewald);
+  colloids_info_free(cinfo);
+
+  return 0;
+}
@@ -33,7 +33,7 @@ int test_fe_force_method_suite(void) {
   pe_create(MPI_COMM_WORLD, PE_QUIET, &pe);
 
   /* If the implementation has changed, the tests need to change. */
-  assert(FE_FORCE_METHOD_MAX == 7);
+  assert(FE_FORCE_METHOD_MAX == 8);
 
   test_fe_force_method_default();
   test_fe_force_method_to_enum();
@@ -91,6 +91,10 @@ int test_fe_force_method_to_enum(void) {
   assert(method == FE_FORCE_METHOD_RELAXATION_ANTI);
   if (method != FE_FORCE_METHOD_RELAXATION_ANTI) ifail = -1;
 
+  method = fe_force_method_to_enum("stress_divergence_recompute");
+  assert(method == FE_FORCE_METHOD_STRESS_RECOMPUTE);
+  if (method != FE_FORCE_METHOD_STRESS_RECOMPUTE) ifail = -1;
+
   return ifail;
 }
 
@@ -147,5 +151,12 @@ int test_fe_force_method_to_string(void) {
     assert(ifail == 0);
   }
 
+  {
+    fe_force_method_enum_t method = FE_FORCE_METHOD_STRESS_RECOMPUTE;
+    const char * s = fe_force_method_to_string(method);
+    ifail = strcmp(s, "stress_divergence_recompute");
+    assert(ifail == 0);
+  }
+
   return ifail;
 }
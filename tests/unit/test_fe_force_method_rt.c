@@ -37,6 +37,7 @@ int test_fe_force_method_rt_suite(void) {
   test_fe_force_method_rt(pe, FE_FORCE_METHOD_PHI_GRADMU_CORRECTION);
   test_fe_force_method_rt(pe, FE_FORCE_METHOD_RELAXATION_SYMM);
   test_fe_force_method_rt(pe, FE_FORCE_METHOD_RELAXATION_ANTI);
+  test_fe_force_method_rt(pe, FE_FORCE_METHOD_STRESS_RECOMPUTE);
 
   test_fe_force_method_rt_messages(pe);
 
@@ -122,6 +123,16 @@ int test_fe_force_method_rt(pe_t * pe, fe_force_method_enum_t method) {
       if (iret != 1) ifail += 1;
     }
     break;
+  case (FE_FORCE_METHOD_STRESS_RECOMPUTE):
+    rt_add_key_value(rt, "fe_force_method", "stress_divergence_recompute");
+    {
+      fe_force_method_enum_t imethod = FE_FORCE_METHOD_INVALID;
+      int iret = fe_force_method_rt(rt, RT_NONE, &imethod);
+      assert(iret == 1);
+      assert(imethod == FE_FORCE_METHOD_STRESS_RECOMPUTE);
+      if (iret != 1) ifail += 1;
+    }
+    break;
   default:
     /* Nothing. */
     ;
@@ -8,7 +8,7 @@
  *  Edinburgh Soft Matter and Statistical Physics Group and
  *  Edinburgh Parallel Computing Centre
  *
- *  (c) 2012-2021 The University of Edinburgh
+ *  (c) 2012-2024 The University of Edinburgh
  *
  *  Contributing authors:
  *  Kevin Stratford (kevin@epcc.ed.ac.uk)
@@ -25,6 +25,8 @@
 #include "coords.h"
 #include "leesedwards.h"
 #include "field_grad.h"
+#include "gradient_3d_7pt_fluid.h"
+#include "gradient_3d_27pt_fluid.h"
 #include "tests.h"
 
 enum encode {ENCODE_GRAD = 1, ENCODE_DELSQ, ENCODE_GRAD4, ENCODE_DELSQ4,
@@ -34,6 +36,7 @@ static int do_test1(pe_t * pe);
 static int do_test3(pe_t * pe);
 static int do_test5(pe_t * pe);
 static int do_test_dab(pe_t * pe);
+static int do_test_halo_compute(pe_t * pe, grad_ft d2);
 static int test_d2(field_grad_t * fgrad);
 static int test_d4(field_grad_t * fgrad);
 
@@ -56,6 +59,8 @@ int test_field_grad_suite(void) {
   do_test3(pe);
   do_test5(pe);
   do_test_dab(pe);
+  do_test_halo_compute(pe, grad_3d_7pt_fluid_d2);
+  do_test_halo_compute(pe, grad_3d_27pt_fluid_d2);
 
   pe_info(pe, "PASS     ./unit/test_field_grad\n");
   pe_free(pe);
@@ -393,3 +398,94 @@ static int test_dab(field_grad_t * fg) {
 
   return 0;
 }
+
+/*****************************************************************************
+ *
+ *  do_test_halo_compute
+ *
+ *  The overlapped halo swap and gradient computation must agree
+ *  with the standard halo swap followed by the computation.
+ *
+ *****************************************************************************/
+
+static int do_test_halo_compute(pe_t * pe, grad_ft d2) {
+
+  int nf = 5;
+  int nhalo = 2;
+  int nlocal[3] = {0};
+  int noffset[3] = {0};
+
+  cs_t * cs = NULL;
+  lees_edw_t * le = NULL;
+  field_t * field = NULL;
+  field_grad_t * gref = NULL;
+  field_grad_t * gover = NULL;
+  field_options_t opts = field_options_ndata_nhalo(nf, nhalo);
+
+  assert(pe);
+  assert(d2);
+
+  cs_create(pe, &cs);
+  cs_nhalo_set(cs, nhalo);
+  cs_init(cs);
+  cs_nlocal(cs, nlocal);
+  cs_nlocal_offset(cs, noffset);
+  lees_edw_create(pe, cs, NULL, &le);
+
+  field_create(pe, cs, le, "q", &opts, &field);
+  field_grad_create(pe, field, 2, &gref);
+  field_grad_create(pe, field, 2, &gover);
+  field_grad_set(gref, d2, NULL);
+  field_grad_set(gover, d2, NULL);
+  field_grad_overlap_set(gover, 1);
+
+  /* Some non-trivial data in the domain proper, but not the halo */
+
+  for (int ic = 1; ic <= nlocal[X]; ic++) {
+    for (int jc = 1; jc <= nlocal[Y]; jc++) {
+      for (int kc = 1; kc <= nlocal[Z]; kc++) {
+	int index = cs_index(cs, ic, jc, kc);
+	int ig = noffset[X] + ic;
+	int jg = noffset[Y] + jc;
+	int kg = noffset[Z] + kc;
+	for (int n = 0; n < nf; n++) {
+	  double q = 1.0*((ig*ig + 3*jg + 5*kg*kg + 7*n) % 13);
+	  field->data[addr_rank1(field->nsites, nf, index, n)] = q;
+	}
+      }
+    }
+  }
+
+  field_memcpy(field, tdpMemcpyHostToDevice);
+  field_grad_halo_compute(gover);
+
+  field_halo(field);
+  field_grad_compute(gref);
+
+  field_grad_memcpy(gref, tdpMemcpyDeviceToHost);
+  field_grad_memcpy(gover, tdpMemcpyDeviceToHost);
+
+  for (int ic = 1; ic <= nlocal[X]; ic++) {
+    for (int jc = 1; jc <= nlocal[Y]; jc++) {
+      for (int kc = 1; kc <= nlocal[Z]; kc++) {
+	int index = cs_index(cs, ic, jc, kc);
+	for (int n = 0; n < nf; n++) {
+	  int iaddr = addr_rank1(gref->nsite, nf, index, n);
+	  assert(fabs(gref->delsq[iaddr] - gover->delsq[iaddr]) < DBL_EPSILON);
+	  for (int ia = 0; ia < 3; ia++) {
+	    int gaddr = addr_rank2(gref->nsite, nf, 3, index, n, ia);
+	    assert(fabs(gref->grad[gaddr] - gover->grad[gaddr]) < DBL_EPSILON);
+	  }
+	}
+      }
+    }
+  }
+
+  field_grad_free(gover);
+  field_grad_free(gref);
+  field_free(field);
+  lees_edw_free(le);
+  cs_free(cs);
+
+  return 0;
+}
@@ -0,0 +1,218 @@
+/*****************************************************************************
+ *
+ *  test_io_compress.c
+ *
+ *
+ *  Edinburgh Soft Matter and Statistical Physics Group and
+ *  Edinburgh Parallel Computing Centre
+ *
+ *  (c) 2024 The University of Edinburgh
+ *
+ *  Kevin Stratford (kevin@epcc.ed.ac.uk)
+ *
+ *****************************************************************************/
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pe.h"
+#include "io_compress.h"
+
+int test_io_compress_bound(void);
+int test_io_compress_rle(void);
+int test_io_compress_shuffle(void);
+int test_io_decompress_corrupt(void);
+
+/*****************************************************************************
+ *
+ *  test_io_compress_suite
+ *
+ *****************************************************************************/
+
+int test_io_compress_suite(void) {
+
+  pe_t * pe = NULL;
+
+  pe_create(MPI_COMM_WORLD, PE_QUIET, &pe);
+
+  test_io_compress_bound();
+  test_io_compress_rle();
+  test_io_compress_shuffle();
+  test_io_decompress_corrupt();
+
+  pe_info(pe, "%-9s %s\n", "PASS", __FILE__);
+  pe_free(pe);
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  test_io_compress_bound
+ *
+ *  Incompressible (no repeats) input must fit in the bound.
+ *
+ *****************************************************************************/
+
+int test_io_compress_bound(void) {
+
+  int ifail = 0;
+  size_t n = 1000;
+  size_t nz = 0;
+  size_t bound = io_compress_bound(n);
+  char * src = (char *) malloc(n*sizeof(char));
+  char * dst = (char *) malloc(bound*sizeof(char));
+  char * chk = (char *) malloc(n*sizeof(char));
+
+  assert(src && dst && chk);
+
+  for (size_t i = 0; i < n; i++) {
+    src[i] = (char) (i % 2);
+  }
+
+  ifail = io_compress(1, 1, src, n, dst, &nz);
+  assert(ifail == 0);
+  assert(nz <= bound);
+  assert(nz == n + 8);             /* 8 literal runs of 128 bytes or fewer */
+
+  ifail = io_decompress(1, dst, nz, chk, n);
+  assert(ifail == 0);
+  assert(memcmp(src, chk, n) == 0);
+
+  /* Zero length */
+  ifail = io_compress(1, 1, src, 0, dst, &nz);
+  assert(ifail == 0);
+  assert(nz == 0);
+
+  free(chk);
+  free(dst);
+  free(src);
+
+  return ifail;
+}
+
+/*****************************************************************************
+ *
+ *  test_io_compress_rle
+ *
+ *  Runs of various lengths either side of the maximum.
+ *
+ *****************************************************************************/
+
+int test_io_compress_rle(void) {
+
+  int ifail = 0;
+  int nrun[6] = {1, 2, 3, 129, 130, 300};
+
+  for (int ir = 0; ir < 6; ir++) {
+    size_t n = nrun[ir] + 2;
+    size_t nz = 0;
+    char * src = (char *) malloc(n*sizeof(char));
+    char * dst = (char *) malloc(io_compress_bound(n)*sizeof(char));
+    char * chk = (char *) malloc(n*sizeof(char));
+
+    assert(src && dst && chk);
+
+    src[0] = 'a';
+    memset(src + 1, 'b', nrun[ir]);
+    src[n-1] = 'c';
+
+    ifail = io_compress(1, 1, src, n, dst, &nz);
+    assert(ifail == 0);
+    assert(nz <= io_compress_bound(n));
+    if (nrun[ir] >= 129) assert(nz < n);
+
+    ifail = io_decompress(1, dst, nz, chk, n);
+    assert(ifail == 0);
+    assert(memcmp(src, chk, n) == 0);
+
+    free(chk);
+    free(dst);
+    free(src);
+  }
+
+  return ifail;
+}
+
+/*****************************************************************************
+ *
+ *  test_io_compress_shuffle
+ *
+ *  Smoothly varying double precision data should compress with the
+ *  byte shuffle (level 2); the trailing byte is not part of an element.
+ *
+ *****************************************************************************/
+
+int test_io_compress_shuffle(void) {
+
+  int ifail = 0;
+  int ndata = 1024;
+  size_t n = ndata*sizeof(double) + 1;
+  size_t nz = 0;
+  char * src = (char *) malloc(n*sizeof(char));
+  char * dst = (char *) malloc(io_compress_bound(n)*sizeof(char));
+  char * chk = (char *) malloc(n*sizeof(char));
+
+  assert(src && dst && chk);
+
+  for (int i = 0; i < ndata; i++) {
+    double f = 1.0/9.0;
+    memcpy(src + i*sizeof(double), &f, sizeof(double));
+  }
+  src[n-1] = 'x';
+
+  ifail = io_compress(2, sizeof(double), src, n, dst, &nz);
+  assert(ifail == 0);
+  assert(nz < n/16);
+
+  ifail = io_decompress(sizeof(double), dst, nz, chk, n);
+  assert(ifail == 0);
+  assert(memcmp(src, chk, n) == 0);
+
+  free(chk);
+  free(dst);
+  free(src);
+
+  return ifail;
+}
+
+/*****************************************************************************
+ *
+ *  test_io_decompress_corrupt
+ *
+ *  Inconsistent compressed data/size must be reported.
+ *
+ *****************************************************************************/
+
+int test_io_decompress_corrupt(void) {
+
+  int ifail = 0;
+  char chk[8] = {0};
+
+  {
+    /* Literal run of 4 bytes, but only 2 present */
+    char src[3] = {3, 'a', 'b'};
+    ifail = io_decompress(1, src, 3, chk, 8);
+    assert(ifail != 0);
+  }
+
+  {
+    /* Repeat of 10 bytes exceeds expected size 8 */
+    char src[2] = {(char) 136, 'a'};
+    ifail = io_decompress(1, src, 2, chk, 8);
+    assert(ifail != 0);
+  }
+
+  {
+    /* Valid stream, but too short for expected size */
+    char src[2] = {(char) 130, 'a'};
+    ifail = io_decompress(1, src, 2, chk, 8);
+    assert(ifail != 0);
+    ifail = io_decompress(1, src, 2, chk, 4);
+    assert(ifail == 0);
+    assert(chk[0] == 'a' && chk[3] == 'a');
+  }
+
+  return ifail;
+}
@@ -34,6 +34,10 @@ int test_io_impl_mpio_write_begin(io_impl_mpio_t ** io,
 				  const io_metadata_t * meta,
 				  const char * filename);
 int test_io_impl_mpio_write_end(io_impl_mpio_t ** io);
+int test_io_impl_async(cs_t * cs, const io_metadata_t * metadata,
+		       const char * file0, const char * file1);
+int test_io_impl_mpio_zlevels(cs_t * cs, const io_element_t * element);
+int test_io_impl_mpio_zdecomposition(pe_t * pe, const io_element_t * element);
 
 static int test_buf_pack_asc(cs_t * cs, io_aggregator_t * buf);
 static int test_buf_pack_bin(cs_t * cs, io_aggregator_t * buf);
@@ -113,12 +117,71 @@ int test_io_impl_mpio_suite(void) {
     test_io_impl_mpio_write(cs, &metadata, filename);
     test_io_impl_mpio_read(cs, &metadata, filename);
 
+    /* Double-buffered asynchronous writes */
+    {
+      const char * file0 = "io-impl-async-bin-0.dat";
+      const char * file1 = "io-impl-async-bin-1.dat";
+      test_io_impl_async(cs, &metadata, file0, file1);
+      MPI_Barrier(MPI_COMM_WORLD);
+      if (pe_mpi_rank(pe) == 0) remove(file0);
+      if (pe_mpi_rank(pe) == 0) remove(file1);
+    }
+
+    io_metadata_finalise(&metadata);
+
+    MPI_Barrier(MPI_COMM_WORLD);
+    if (pe_mpi_rank(pe) == 0) remove(filename);
+  }
+
+  /* Compressed blocks: level 1 (ASCII) and level 2 (binary, shuffle) */
+  {
+    io_options_t opts = io_options_with_format(mode, IO_RECORD_ASCII);
+    io_metadata_t metadata = {0};
+    const char * filename = "io-impl-mpio-z1-asc.dat";
+
+    opts.compression_levl = 1;
+    io_metadata_initialise(cs, &opts, &element_asc, &metadata);
+
+    test_io_impl_mpio_write(cs, &metadata, filename);
+    test_io_impl_mpio_read(cs, &metadata, filename);
+
     io_metadata_finalise(&metadata);
 
     MPI_Barrier(MPI_COMM_WORLD);
     if (pe_mpi_rank(pe) == 0) remove(filename);
   }
 
+  {
+    io_options_t opts = io_options_with_format(mode, IO_RECORD_BINARY);
+    io_metadata_t metadata = {0};
+    const char * filename = "io-impl-mpio-z2-bin.dat";
+
+    opts.compression_levl = 2;
+    io_metadata_initialise(cs, &opts, &element_bin, &metadata);
+
+    test_io_impl_mpio_write(cs, &metadata, filename);
+    test_io_impl_mpio_read(cs, &metadata, filename);
+
+    /* Asynchronous writes of compressed blocks */
+    {
+      const char * file0 = "io-impl-async-z2-bin-0.dat";
+      const char * file1 = "io-impl-async-z2-bin-1.dat";
+      test_io_impl_async(cs, &metadata, file0, file1);
+      MPI_Barrier(MPI_COMM_WORLD);
+      if (pe_mpi_rank(pe) == 0) remove(file0);
+      if (pe_mpi_rank(pe) == 0) remove(file1);
+    }
+
+    io_metadata_finalise(&metadata);
+
+    MPI_Barrier(MPI_COMM_WORLD);
+    if (pe_mpi_rank(pe) == 0) remove(filename);
+  }
+
+  /* Compression is a property of the file, not the current options */
+  test_io_impl_mpio_zlevels(cs, &element_bin);
+  test_io_impl_mpio_zdecomposition(pe, &element_bin);
+
   /* Multiple file iogrid = {2, 1, 1} */
 
   if (pe_mpi_size(pe) > 1) {
@@ -347,6 +410,169 @@ int test_io_impl_mpio_write_end(io_impl_mpio_t ** io) {
   return 0;
 }
 
+/*****************************************************************************
+ *
+ *  test_io_impl_async
+ *
+ *  Three writes via the two asynchronous buffers (file0, file1, file0);
+ *  at most one write is in progress. Read back to check.
+ *
+ *****************************************************************************/
+
+int test_io_impl_async(cs_t * cs, const io_metadata_t * meta,
+		       const char * file0, const char * file1) {
+
+  io_impl_async_t async = {0};
+  const char * file[3] = {file0, file1, file0};
+
+  assert(cs);
+  assert(meta);
+
+  for (int n = 0; n < 3; n++) {
+    io_impl_t * io = NULL;
+    int ifail = io_impl_async_buffer(&async, meta, &io);
+    assert(ifail == 0);
+    assert(io == async.io[n % 2]);
+    if (meta->element.datatype == MPI_CHAR) test_buf_pack_asc(cs, io->aggr);
+    if (meta->element.datatype == MPI_INT64_T) test_buf_pack_bin(cs, io->aggr);
+    ifail = io_impl_async_write_begin(&async, file[n]);
+    assert(ifail == 0);
+    assert(async.pending == 1);
+    assert(async.ibuf == (n + 1) % 2);
+  }
+
+  io_impl_async_write_end(&async);
+  assert(async.pending == 0);
+
+  io_impl_async_free(&async);
+  assert(async.io[0] == NULL);
+  assert(async.io[1] == NULL);
+
+  test_io_impl_mpio_read(cs, meta, file0);
+  test_io_impl_mpio_read(cs, meta, file1);
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  test_io_impl_mpio_zlevels
+ *
+ *  Write with one compression level and read with another: the
+ *  reader must take the format from the file.
+ *
+ *****************************************************************************/
+
+int test_io_impl_mpio_zlevels(cs_t * cs, const io_element_t * element) {
+
+  int ifail = 0;
+  int levels[3][2] = {{2, 0}, {0, 2}, {1, 2}};  /* {write, read} */
+  const char * filename = "io-impl-mpio-zlevel.dat";
+
+  assert(cs);
+  assert(element);
+
+  for (int it = 0; it < 3; it++) {
+    io_options_t wopts = io_options_with_format(IO_MODE_MPIIO,
+						IO_RECORD_BINARY);
+    io_options_t ropts = wopts;
+    io_metadata_t wmeta = {0};
+    io_metadata_t rmeta = {0};
+    io_impl_mpio_t io = {0};
+
+    wopts.compression_levl = levels[it][0];
+    ropts.compression_levl = levels[it][1];
+    io_metadata_initialise(cs, &wopts, element, &wmeta);
+    io_metadata_initialise(cs, &ropts, element, &rmeta);
+
+    test_io_impl_mpio_write(cs, &wmeta, filename);
+
+    io_impl_mpio_initialise(&rmeta, &io);
+    ifail = io_impl_mpio_read(&io, filename);
+    assert(ifail == 0);
+    ifail = test_buf_unpack_bin(cs, io.super.aggr);
+    assert(ifail == 0);
+    io_impl_mpio_finalise(&io);
+
+    io_metadata_finalise(&rmeta);
+    io_metadata_finalise(&wmeta);
+
+    MPI_Barrier(MPI_COMM_WORLD);
+    if (cs_cart_rank(cs) == 0) remove(filename);
+  }
+
+  return ifail;
+}
+
+/*****************************************************************************
+ *
+ *  test_io_impl_mpio_zdecomposition
+ *
+ *  A compressed file read with a different decomposition must fail
+ *  on all ranks (even if the local buffer sizes happen to agree).
+ *
+ *****************************************************************************/
+
+int test_io_impl_mpio_zdecomposition(pe_t * pe, const io_element_t * element) {
+
+  int ifail = 0;
+  int ntotal[3] = {16, 16, 16};
+  const char * filename = "io-impl-mpio-zdecomp.dat";
+
+  cs_t * csw = NULL;
+  cs_t * csr = NULL;
+
+  assert(pe);
+  assert(element);
+
+  if (pe_mpi_size(pe) == 1) return 0;
+
+  {
+    int wgrid[3] = {pe_mpi_size(pe), 1, 1};
+    int rgrid[3] = {1, pe_mpi_size(pe), 1};
+
+    cs_create(pe, &csw);
+    cs_ntotal_set(csw, ntotal);
+    cs_decomposition_set(csw, wgrid);
+    cs_init(csw);
+
+    cs_create(pe, &csr);
+    cs_ntotal_set(csr, ntotal);
+    cs_decomposition_set(csr, rgrid);
+    cs_init(csr);
+  }
+
+  {
+    io_options_t opts = io_options_with_format(IO_MODE_MPIIO,
+					       IO_RECORD_BINARY);
+    io_metadata_t wmeta = {0};
+    io_metadata_t rmeta = {0};
+    io_impl_mpio_t io = {0};
+
+    opts.compression_levl = 2;
+    io_metadata_initialise(csw, &opts, element, &wmeta);
+    io_metadata_initialise(csr, &opts, element, &rmeta);
+
+    test_io_impl_mpio_write(csw, &wmeta, filename);
+
+    io_impl_mpio_initialise(&rmeta, &io);
+    ifail = io_impl_mpio_read(&io, filename);
+    assert(ifail != 0);
+    io_impl_mpio_finalise(&io);
+
+    io_metadata_finalise(&rmeta);
+    io_metadata_finalise(&wmeta);
+
+    MPI_Barrier(MPI_COMM_WORLD);
+    if (pe_mpi_rank(pe) == 0) remove(filename);
+  }
+
+  cs_free(csr);
+  cs_free(csw);
+
+  return (ifail != 0) ? 0 : -1;
+}
+
 /*****************************************************************************
  *
  *  test_unique_value
@@ -0,0 +1,284 @@
+/*****************************************************************************
+ *
+ *  test_io_impl_node.c
+ *
+ *  The node-aggregated implementation (with a mock aggregator).
+ *
+ *
+ *  Edinburgh Soft Matter and Statistical Physics Group and
+ *  Edinburgh Parallel Computing Centre
+ *
+ *  (c) 2024 The University of Edinburgh
+ *
+ *  Contributing authors:
+ *  Kevin Stratford (kevin@epcc.ed.ac.uk)
+ *
+ *****************************************************************************/
+
+#include <assert.h>
+#include <inttypes.h>
+#include <string.h>
+
+#include "pe.h"
+#include "coords.h"
+#include "io_impl_mpio.h"
+#include "io_impl_node.h"
+
+int test_io_impl_node_create(const io_metadata_t * meta);
+int test_io_impl_node_write_read(cs_t * cs, const io_metadata_t * meta,
+				 const char * filename);
+int test_io_impl_node_mpio_read(cs_t * cs, const io_metadata_t * meta,
+				const char * filename);
+
+static int test_buf_pack(cs_t * cs, io_aggregator_t * aggr);
+static int test_buf_unpack(cs_t * cs, const io_aggregator_t * aggr);
+
+/*****************************************************************************
+ *
+ *  test_io_impl_node_suite
+ *
+ *****************************************************************************/
+
+int test_io_impl_node_suite(void) {
+
+  int ntotal[3] = {16, 8, 4};
+
+  pe_t * pe = NULL;
+  cs_t * cs = NULL;
+
+  io_element_t element = {.datatype = MPI_INT64_T,
+                          .datasize = sizeof(int64_t),
+                          .count    = 1,
+                          .endian   = io_endianness()};
+
+  pe_create(MPI_COMM_WORLD, PE_QUIET, &pe);
+
+  cs_create(pe, &cs);
+  cs_ntotal_set(cs, ntotal);
+  cs_init(cs);
+
+  /* Per node (iogroup = 0), and groups of 1, 2 ranks */
+
+  for (int iogroup = 0; iogroup <= 2; iogroup++) {
+    io_options_t opts = io_options_with_mode(IO_MODE_NODE);
+    io_metadata_t metadata = {0};
+    const char * filename = "io-impl-node-bin.dat";
+
+    opts.iogroup = iogroup;
+    io_metadata_initialise(cs, &opts, &element, &metadata);
+
+    test_io_impl_node_create(&metadata);
+    test_io_impl_node_write_read(cs, &metadata, filename);
+    test_io_impl_node_mpio_read(cs, &metadata, filename);
+
+    io_metadata_finalise(&metadata);
+
+    MPI_Barrier(MPI_COMM_WORLD);
+    if (pe_mpi_rank(pe) == 0) remove(filename);
+  }
+
+  pe_info(pe, "%-9s %s\n", "PASS", __FILE__);
+  cs_free(cs);
+  pe_free(pe);
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  test_io_impl_node_create
+ *
+ *****************************************************************************/
+
+int test_io_impl_node_create(const io_metadata_t * meta) {
+
+  int ifail = 0;
+  int noderank = -1;
+  io_impl_t * io = NULL;
+
+  assert(meta);
+
+  /* Via the factory method */
+  ifail = io_impl_create(meta, &io);
+  assert(ifail == 0);
+  assert(io);
+  assert(io->impl->write_begin == NULL);
+  assert(io->impl->write_end   == NULL);
+
+  MPI_Comm_rank(meta->node, &noderank);
+
+  {
+    io_impl_node_t * node = (io_impl_node_t *) io;
+    assert(node->metadata == meta);
+
+    if (noderank == 0) {
+      /* Writer: there must be at least one run, and not more than
+       * the number of z-lines. */
+      int nlocal[3] = {0};
+      cs_nlocal(meta->cs, nlocal);
+      assert(node->gbuf);
+      assert(node->fbuf);
+      assert(node->nrun >= 1);
+      assert(node->nrun <= node->nline);
+      assert(node->nline >= nlocal[X]*nlocal[Y]);
+    }
+    else {
+      assert(node->gbuf == NULL);
+    }
+  }
+
+  io->impl->free(&io);
+  assert(io == NULL);
+
+  return ifail;
+}
+
+/*****************************************************************************
+ *
+ *  test_io_impl_node_write_read
+ *
+ *****************************************************************************/
+
+int test_io_impl_node_write_read(cs_t * cs, const io_metadata_t * meta,
+				 const char * filename) {
+  int ifail = 0;
+
+  assert(cs);
+  assert(meta);
+  assert(filename);
+
+  {
+    io_impl_node_t * io = NULL;
+    io_impl_node_create(meta, &io);
+    test_buf_pack(cs, io->super.aggr);
+    ifail = io_impl_node_write(io, filename);
+    assert(ifail == 0);
+    io_impl_node_free(&io);
+  }
+
+  {
+    io_impl_node_t * io = NULL;
+    io_impl_node_create(meta, &io);
+    ifail = io_impl_node_read(io, filename);
+    assert(ifail == 0);
+    ifail = test_buf_unpack(cs, io->super.aggr);
+    io_impl_node_free(&io);
+  }
+
+  return ifail;
+}
+
+/*****************************************************************************
+ *
+ *  test_io_impl_node_mpio_read
+ *
+ *  The file format is the same as IO_MODE_MPIIO, so read it that way.
+ *
+ *****************************************************************************/
+
+int test_io_impl_node_mpio_read(cs_t * cs, const io_metadata_t * meta,
+				const char * filename) {
+  int ifail = 0;
+  io_options_t opts = io_options_with_mode(IO_MODE_MPIIO);
+  io_metadata_t mpiometa = {0};
+  io_impl_mpio_t io = {0};
+
+  assert(cs);
+  assert(meta);
+
+  io_metadata_initialise(cs, &opts, &meta->element, &mpiometa);
+  io_impl_mpio_initialise(&mpiometa, &io);
+
+  ifail = io_impl_mpio_read(&io, filename);
+  assert(ifail == 0);
+  ifail = test_buf_unpack(cs, io.super.aggr);
+
+  io_impl_mpio_finalise(&io);
+  io_metadata_finalise(&mpiometa);
+
+  return ifail;
+}
+
+/*****************************************************************************
+ *
+ *  test_unique_value
+ *
+ *****************************************************************************/
+
+static int64_t test_unique_value(cs_t * cs, int ic, int jc, int kc) {
+
+  int ntotal[3] = {0};
+  int offset[3] = {0};
+
+  cs_ntotal(cs, ntotal);
+  cs_nlocal_offset(cs, offset);
+
+  {
+    int64_t ix = offset[X] + ic - 1;
+    int64_t iy = offset[Y] + jc - 1;
+    int64_t iz = offset[Z] + kc - 1;
+    return (ix*ntotal[Y] + iy)*ntotal[Z] + iz;
+  }
+}
+
+/*****************************************************************************
+ *
+ *  test_buf_pack
+ *
+ *****************************************************************************/
+
+static int test_buf_pack(cs_t * cs, io_aggregator_t * aggr) {
+
+  int ib = 0;
+  int nlocal[3] = {0};
+
+  assert(cs);
+  assert(aggr->buf);
+
+  cs_nlocal(cs, nlocal);
+
+  for (int ic = 1; ic <= nlocal[X]; ic++) {
+    for (int jc = 1; jc <= nlocal[Y]; jc++) {
+      for (int kc = 1; kc <= nlocal[Z]; kc++) {
+	int64_t ival = test_unique_value(cs, ic, jc, kc);
+	memcpy(aggr->buf + ib*sizeof(int64_t), &ival, sizeof(int64_t));
+	ib += 1;
+      }
+    }
+  }
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  test_buf_unpack
+ *
+ *****************************************************************************/
+
+static int test_buf_unpack(cs_t * cs, const io_aggregator_t * aggr) {
+
+  int ifail = 0;
+  int ib = 0;
+  int nlocal[3] = {0};
+
+  assert(cs);
+  assert(aggr->buf);
+
+  cs_nlocal(cs, nlocal);
+
+  for (int ic = 1; ic <= nlocal[X]; ic++) {
+    for (int jc = 1; jc <= nlocal[Y]; jc++) {
+      for (int kc = 1; kc <= nlocal[Z]; kc++) {
+	int64_t ival = test_unique_value(cs, ic, jc, kc);
+	int64_t iread = -1;
+	memcpy(&iread, aggr->buf + ib*sizeof(int64_t), sizeof(int64_t));
+	assert(iread == ival);
+	if (iread != ival) ifail += 1;
+	ib += 1;
+      }
+    }
+  }
+
+  return ifail;
+}
@@ -24,6 +24,7 @@ int test_io_metadata_create(cs_t * cs);
 int test_io_metadata_to_json(cs_t * cs);
 int test_io_metadata_write(cs_t * cs, int keep);
 int test_io_metadata_from_file(pe_t * pe);
+int test_io_metadata_node_compression(cs_t * cs);
 
 /*****************************************************************************
  *
@@ -44,6 +45,7 @@ int test_io_metadata_suite(void) {
   test_io_metadata_initialise(cs);
   test_io_metadata_create(cs);
   test_io_metadata_to_json(cs);
+  test_io_metadata_node_compression(cs);
   test_io_metadata_write(cs, 0);
 
   test_io_metadata_write(cs, 1);
@@ -192,6 +194,55 @@ int test_io_metadata_to_json(cs_t * cs) {
   return ifail;
 }
 
+/*****************************************************************************
+ *
+ *  test_io_metadata_node_compression
+ *
+ *  IO_MODE_NODE does not compress, so the level must be recorded as
+ *  zero (including in the json written to the metadata file).
+ *
+ *****************************************************************************/
+
+int test_io_metadata_node_compression(cs_t * cs) {
+
+  int ifail = 0;
+  io_metadata_t metadata = {0};
+  io_element_t  element  = {0};
+  io_options_t  options  = io_options_with_mode(IO_MODE_NODE);
+
+  assert(cs);
+
+  options.compression_levl = 3;
+  ifail = io_metadata_initialise(cs, &options, &element, &metadata);
+  assert(ifail == 0);
+  assert(metadata.options.compression_levl == 0);
+
+  {
+    cJSON * json = NULL;
+    cJSON * opts = NULL;
+    cJSON * level = NULL;
+
+    io_metadata_to_json(&metadata, &json);
+    opts = cJSON_GetObjectItemCaseSensitive(json, "io_options");
+    level = cJSON_GetObjectItemCaseSensitive(opts, "Compression level");
+    if (level == NULL || cJSON_GetNumberValue(level) != 0) ifail = -1;
+    assert(ifail == 0);
+    cJSON_Delete(json);
+  }
+
+  io_metadata_finalise(&metadata);
+
+  /* MPIIO retains the requested level */
+
+  options = io_options_with_mode(IO_MODE_MPIIO);
+  options.compression_levl = 3;
+  io_metadata_initialise(cs, &options, &element, &metadata);
+  assert(metadata.options.compression_levl == 3);
+  io_metadata_finalise(&metadata);
+
+  return ifail;
+}
+
 /*****************************************************************************
  *
  *  test_io_metadata_write
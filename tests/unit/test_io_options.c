@@ -85,6 +85,9 @@ __host__ int test_io_options_mode_valid(void) {
   isvalid = io_options_mode_valid(mode3);
   assert(isvalid == 1);
 
+  isvalid = io_options_mode_valid(IO_MODE_NODE);
+  assert(isvalid == 1);
+
   isvalid = io_options_mode_valid(mode9);
   assert(isvalid == 0);
 
@@ -156,7 +159,7 @@ __host__ int test_io_options_default(void) {
   io_options_t opts = io_options_default();
 
   /* If entries are changed in the struct, the tests should be updated... */
-  assert(sizeof(io_options_t) == 36);
+  assert(sizeof(io_options_t) == 40);
 
   assert(io_options_mode_valid(opts.mode));
   assert(io_options_record_format_valid(opts.iorformat));
@@ -166,6 +169,7 @@ __host__ int test_io_options_default(void) {
   assert(opts.report == 0);
   assert(opts.asynchronous == 0);
   assert(opts.compression_levl == 0);
+  assert(opts.iogroup == 0);
   assert(opts.iogrid[0] == 1);
   assert(opts.iogrid[1] == 1);
   assert(opts.iogrid[2] == 1);
@@ -198,6 +202,17 @@ __host__ int test_io_options_with_mode(void) {
     ifail = options.asynchronous;
   }
 
+  {
+    /* IO_MODE_NODE */
+    io_options_t options = io_options_with_mode(IO_MODE_NODE);
+    assert(options.mode              == IO_MODE_NODE);
+    assert(options.iorformat         == IO_RECORD_BINARY);
+    assert(options.metadata_version  == IO_METADATA_V2);
+    assert(options.iogroup           == 0);
+    assert(io_options_valid(&options));
+    ifail = options.asynchronous;
+  }
+
   return ifail;
 }
 
@@ -274,6 +289,12 @@ __host__ int test_io_mode_to_string(void) {
     assert(ifail == 0);
   }
 
+  {
+    const char * str = io_mode_to_string(IO_MODE_NODE);
+    ifail = strcmp(str, "node");
+    assert(ifail == 0);
+  }
+
   return ifail;
 }
 
@@ -293,6 +314,12 @@ __host__ int test_io_mode_from_string(void) {
     assert(ifail == 0);
   }
 
+  {
+    io_mode_enum_t mode = io_mode_from_string("node");
+    if (mode != IO_MODE_NODE) ifail = -1;
+    assert(ifail == 0);
+  }
+
   return ifail;
 }
 
@@ -373,6 +400,7 @@ __host__ int test_io_options_to_json(void) {
     assert(check.report == opts.report);
     assert(check.asynchronous == opts.asynchronous);
     assert(check.compression_levl == opts.compression_levl);
+    assert(check.iogroup == opts.iogroup);
     assert(check.iogrid[0] == 1);
     assert(check.iogrid[1] == 1);
     assert(check.iogrid[2] == 1);
@@ -215,6 +215,10 @@ __host__ int test_io_options_rt(pe_t * pe) {
 
   /* "mpiio" */
   rt_add_key_value(rt, "vel_io_mode", "mpiio");
+  rt_add_key_value(rt, "dist_io_asynchronous", "yes");
+  rt_add_key_value(rt, "dist_io_compression", "1");
+  rt_add_key_value(rt, "phi_io_mode", "node");
+  rt_add_key_value(rt, "phi_io_group", "4");
 
   {
     io_options_t opts = io_options_with_mode(IO_MODE_MPIIO);
@@ -223,6 +227,22 @@ __host__ int test_io_options_rt(pe_t * pe) {
     assert(opts.iorformat        == IO_RECORD_BINARY);
     assert(opts.metadata_version == IO_METADATA_V2);
     assert(opts.report           == 1);
+    assert(opts.asynchronous     == 0);
+    assert(opts.compression_levl == 0);
+  }
+
+  {
+    io_options_t opts = io_options_with_mode(IO_MODE_MPIIO);
+    io_options_rt(rt, RT_FATAL, "dist", &opts);
+    assert(opts.asynchronous     == 1);
+    assert(opts.compression_levl == 1);
+  }
+
+  {
+    io_options_t opts = io_options_default();
+    io_options_rt(rt, RT_FATAL, "phi", &opts);
+    assert(opts.mode             == IO_MODE_NODE);
+    assert(opts.iogroup          == 4);
   }
 
   rt_free(rt);
@@ -263,8 +263,8 @@ __host__ int test_lb_bc_inflow_rhou_impose(pe_t * pe, cs_t * cs, int nvel) {
 	    {
 	      double ux = inflow->options.u0[X];
 	      double fp = lb->model.wv[p]*rho0*(1.0 + 3.0*ux + 3.0*ux*ux);
-	      assert(fabs(f - fp) < DBL_EPSILON);
-	      ierr += (fabs(f - fp) > DBL_EPSILON);
+	      assert(fabs(f - fp) < LB_FLOAT_EPSILON);
+	      ierr += (fabs(f - fp) > LB_FLOAT_EPSILON);
 	    }
 	  }
 	}
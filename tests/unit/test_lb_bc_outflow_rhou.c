@@ -240,8 +240,8 @@ __host__ int test_lb_bc_outflow_rhou_impose(pe_t * pe, cs_t * cs, int nvel) {
 	      double ux   = u0[X];
 	      double rho0 = outflow->options.rho0;
 	      double fp   = lb->model.wv[p]*rho0*(1.0 - 3.0*ux + 3.0*ux*ux);
-	      assert(fabs(f - fp) < DBL_EPSILON);
-	      if (fabs(f - fp) > DBL_EPSILON) ierr += 1;
+	      assert(fabs(f - fp) < LB_FLOAT_EPSILON);
+	      if (fabs(f - fp) > LB_FLOAT_EPSILON) ierr += 1;
 	    }
 	  }
 	}
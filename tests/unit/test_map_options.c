@@ -40,7 +40,7 @@ int test_map_options_suite(void) {
   test_map_options_valid();
 
   /* Change of object size suggests tests should be updated. */
-  assert(sizeof(map_options_t) == 104);
+  assert(sizeof(map_options_t) == 112);
 
   pe_info(pe, "%-9s %s\n", "PASS", __FILE__);
 
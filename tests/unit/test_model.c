@@ -10,7 +10,7 @@
  *  Edinburgh Soft Matter and Statistical Physics Group
  *  Edinburgh Parallel Computing Centre
  *
- *  (c) 2010-2022 The University of Edinburgh
+ *  (c) 2010-2024 The University of Edinburgh
  *
  *  Contributing authors:
  *  Kevin Stratford (kevin@epcc.ed.ac.uk)
@@ -32,6 +32,7 @@
 static void test_model_velocity_set(void);
 
 int do_test_model_distributions(pe_t * pe, cs_t * cs);
+int do_test_model_distributions_shifted(pe_t * pe, cs_t * cs);
 int do_test_model_halo_swap(pe_t * pe, cs_t * cs);
 int do_test_model_reduced_halo_swap(pe_t * pe, cs_t * cs);
 int do_test_lb_model_io(pe_t * pe, cs_t * cs);
@@ -43,6 +44,14 @@ int test_lb_io_aggr_pack(pe_t * pe, cs_t * cs, const lb_data_options_t * opts);
 
 static  int test_model_is_domain(cs_t * cs, int ic, int jc, int kc);
 
+/* Two distributions require double precision storage */
+
+#ifdef LB_DATA_FLOAT
+#define TEST_MODEL_NDIST 1
+#else
+#define TEST_MODEL_NDIST 2
+#endif
+
 
 /* Utility to return a unique value for global (ic,jc,kc,p) */
 /* This allows e.g., tests to check distribution values in parallel
@@ -347,6 +356,7 @@ int test_model_suite(void) {
   /* Now test actual distributions */
 
   do_test_model_distributions(pe, cs);
+  do_test_model_distributions_shifted(pe, cs);
   do_test_model_halo_swap(pe, cs);
   do_test_model_reduced_halo_swap(pe, cs);
 
@@ -389,7 +399,7 @@ int do_test_model_distributions(pe_t * pe, cs_t * cs) {
 
   int i, n, p;
   int index = 1;
-  int ndist = 2;
+  int ndist = TEST_MODEL_NDIST;
   double fvalue, fvalue_expected;
   double u[3];
 
@@ -414,21 +424,21 @@ int do_test_model_distributions(pe_t * pe, cs_t * cs) {
       fvalue_expected = 0.01*n + lb->model.wv[p];
       lb_f_set(lb, index, p, n, fvalue_expected);
       lb_f(lb, index, p, n, &fvalue);
-      assert(fabs(fvalue - fvalue_expected) < DBL_EPSILON);
+      assert(fabs(fvalue - fvalue_expected) < LB_FLOAT_EPSILON);
     }
 
     /* Check zeroth moment... */
 
     fvalue_expected = 0.01*n*lb->model.nvel + 1.0;
     lb_0th_moment(lb, index, (lb_dist_enum_t) n, &fvalue);
-    assert(fabs(fvalue - fvalue_expected) <= DBL_EPSILON);
+    assert(fabs(fvalue - fvalue_expected) <= LB_FLOAT_EPSILON);
 
     /* Check first moment... */
 
     lb_1st_moment(lb, index, (n == 0) ? LB_RHO : LB_PHI, u);
 
     for (i = 0; i < lb->model.ndim; i++) {
-      assert(fabs(u[i] - 0.0) < DBL_EPSILON);
+      assert(fabs(u[i] - 0.0) < LB_FLOAT_EPSILON);
     }
   }
 
@@ -437,6 +447,109 @@ int do_test_model_distributions(pe_t * pe, cs_t * cs) {
   return 0;
 }
 
+/*****************************************************************************
+ *
+ *  do_test_model_distributions_shifted
+ *
+ *  Shifted storage: the interface sees f, the stored value is
+ *  f - wv[p]*rho0; the binary i/o record is the stored value.
+ *
+ *****************************************************************************/
+
+int do_test_model_distributions_shifted(pe_t * pe, cs_t * cs) {
+
+  int index = cs_index(cs, 1, 1, 1);
+  double rho0 = 2.0;
+  double tol = DBL_EPSILON;
+
+  lb_data_options_t options = lb_data_options_ndim_nvel_ndist(NDIM, NVEL, 1);
+  lb_t * lb = NULL;
+
+  assert(pe);
+  assert(cs);
+
+  if (sizeof(lb_float_t) == sizeof(float)) tol = FLT_EPSILON;
+
+  options.shifted = 1;
+  options.rho0    = rho0;
+  assert(lb_data_options_valid(&options));
+
+  lb_data_create(pe, cs, &options, &lb);
+  assert(lb);
+
+  for (int p = 0; p < lb->model.nvel; p++) {
+    double fref = rho0*lb->model.wv[p]*(1.0 + 0.001*p);
+    double f = 0.0;
+    int laddr = LB_ADDR(lb->nsite, 1, lb->nvel, index, LB_RHO, p);
+
+    lb_f_set(lb, index, p, LB_RHO, fref);
+    lb_f(lb, index, p, LB_RHO, &f);
+    assert(fabs(f - fref) < tol);
+    assert(fabs(lb->f[laddr] - 0.001*p*rho0*lb->model.wv[p]) < tol);
+  }
+
+  {
+    /* Mass is recovered (sum_p wv[p] = 1) */
+    double rho = 0.0;
+    double rhoref = 0.0;
+    for (int p = 0; p < lb->model.nvel; p++) {
+      rhoref += rho0*lb->model.wv[p]*(1.0 + 0.001*p);
+    }
+    lb_0th_moment(lb, index, LB_RHO, &rho);
+    assert(fabs(rho - rhoref) < tol);
+  }
+
+  {
+    /* Binary record holds the storage representation */
+    char buf[BUFSIZ] = {0};
+    lb_float_t data[NVELMAX] = {0};
+    int index1 = cs_index(cs, 2, 2, 2);
+
+    lb_write_buf(lb, index, buf);
+    memcpy(data, buf, lb->model.nvel*sizeof(lb_float_t));
+    for (int p = 0; p < lb->model.nvel; p++) {
+      int laddr = LB_ADDR(lb->nsite, 1, lb->nvel, index, LB_RHO, p);
+      assert(fabs(data[p] - lb->f[laddr]) < tol);
+    }
+
+    lb_read_buf(lb, index1, buf);
+    for (int p = 0; p < lb->model.nvel; p++) {
+      double f0 = 0.0;
+      double f1 = 0.0;
+      lb_f(lb, index,  p, LB_RHO, &f0);
+      lb_f(lb, index1, p, LB_RHO, &f1);
+      assert(fabs(f1 - f0) < tol);
+    }
+  }
+
+  {
+    /* ASCII record holds the actual value */
+    char buf[BUFSIZ] = {0};
+    int index1 = cs_index(cs, 3, 3, 3);
+    int ifail = 0;
+
+    ifail = lb_write_buf_ascii(lb, index, buf);
+    assert(ifail == 0);
+    ifail = lb_read_buf_ascii(lb, index1, buf);
+    assert(ifail == 0);
+    for (int p = 0; p < lb->model.nvel; p++) {
+      double f0 = 0.0;
+      double f1 = 0.0;
+      lb_f(lb, index,  p, LB_RHO, &f0);
+      lb_f(lb, index1, p, LB_RHO, &f1);
+      assert(fabs(f1 - f0) < FLT_EPSILON);
+    }
+  }
+
+  /* Not available for two distributions */
+  options.ndist = 2;
+  assert(lb_data_options_valid(&options) == 0);
+
+  lb_free(lb);
+
+  return 0;
+}
+
 /*****************************************************************************
  *
  *  do_test_model_halo_swap
@@ -448,7 +561,7 @@ int do_test_model_distributions(pe_t * pe, cs_t * cs) {
 int do_test_model_halo_swap(pe_t * pe, cs_t * cs) {
 
   int i, j, k, p;
-  int n, ndist = 2;
+  int n, ndist = TEST_MODEL_NDIST;
   int index, nlocal[3];
   const int nextra = 1;  /* Distribution halo width always 1 */
   double f_expect;
@@ -701,6 +814,7 @@ int test_lb_data_write(pe_t * pe, cs_t * cs) {
     test_lb_io_aggr_pack(pe, cs, &opts);
   }
 
+#ifndef LB_DATA_FLOAT
   {
     /* As D3Q19 is typically what was used for ndist = 2, here it is ... */
     lb_data_options_t opts = lb_data_options_ndim_nvel_ndist(3, 19, 2);
@@ -708,6 +822,7 @@ int test_lb_data_write(pe_t * pe, cs_t * cs) {
     test_lb_write_buf_ascii(pe, cs, &opts);
     test_lb_io_aggr_pack(pe, cs, &opts);
   }
+#endif
 
   {
     lb_data_options_t opts = lb_data_options_ndim_nvel_ndist(3, 27, 1);
@@ -869,8 +984,8 @@ int test_lb_io_aggr_pack(pe_t * pe, cs_t * cs, const lb_data_options_t *opts) {
   assert(lb->ascii.datatype == MPI_CHAR);
   assert(lb->ascii.datasize == sizeof(char));
   assert(lb->ascii.count    == lb->nvel*(1 + lb->ndist*LB_RECORD_LENGTH_ASCII));
-  assert(lb->binary.datatype == MPI_DOUBLE);
-  assert(lb->binary.datasize == sizeof(double));
+  assert(lb->binary.datatype == MPI_LB_FLOAT);
+  assert(lb->binary.datasize == sizeof(lb_float_t));
   assert(lb->binary.count    == lb->nvel*lb->ndist);
 
   /* ASCII */
@@ -886,7 +1001,7 @@ int test_lb_io_aggr_pack(pe_t * pe, cs_t * cs, const lb_data_options_t *opts) {
     lb_io_aggr_pack(lb, &aggr);
 
     /* Clear the ditributions, unpack, and check */
-    memset(lb->f, 0, sizeof(double)*lb->nvel*lb->ndist*lb->nsite);
+    memset(lb->f, 0, sizeof(lb_float_t)*lb->nvel*lb->ndist*lb->nsite);
 
     lb_io_aggr_unpack(lb, &aggr);
     util_lb_data_check_no_halo(lb);
@@ -906,7 +1021,7 @@ int test_lb_io_aggr_pack(pe_t * pe, cs_t * cs, const lb_data_options_t *opts) {
     lb_io_aggr_pack(lb, &aggr);
 
     /* Clear the ditributions, unpack, and check */
-    memset(lb->f, 0, sizeof(double)*lb->nvel*lb->ndist*lb->nsite);
+    memset(lb->f, 0, sizeof(lb_float_t)*lb->nvel*lb->ndist*lb->nsite);
 
     lb_io_aggr_unpack(lb, &aggr);
     util_lb_data_check_no_halo(lb);
@@ -7,7 +7,7 @@
  *  Edinburgh Soft Matter and Statistical Physics Group and
  *  Edinburgh Parallel Computing Centre
  *
- *  (c) 2012-2023 The University of Edinburgh
+ *  (c) 2012-2024 The University of Edinburgh
  *
  *  Contributing authors:
  *  Kevin Stratford (kevin@epcc.ed.ac.uk)
@@ -24,11 +24,13 @@
 #include "coords.h"
 #include "physics.h"
 #include "map.h"
+#include "hydro.h"
 #include "psi_sor.h"
 #include "fe_electro.h"
 #include "nernst_planck.h"
 
 static int test_nernst_planck_driver(pe_t * pe);
+static int test_nernst_planck_step(pe_t * pe);
 
 /*****************************************************************************
  *
@@ -43,6 +45,7 @@ int test_nernst_planck_suite(void) {
   pe_create(MPI_COMM_WORLD, PE_QUIET, &pe);
 
   test_nernst_planck_driver(pe);
+  test_nernst_planck_step(pe);
 
   pe_info(pe, "PASS     ./unit/test_nernst_planck\n");
   pe_free(pe);
@@ -263,3 +266,214 @@ static int test_nernst_planck_driver(pe_t * pe) {
 
   return 0;
 }
+
+/*****************************************************************************
+ *
+ *  test_nernst_planck_step
+ *
+ *  With the 7-point stencil, the D3QX update on the target must agree
+ *  with a simple host reference (to round-off). There is a wall at
+ *  x = 1 and a single colloid site, and a non-uniform velocity: the
+ *  total flux, including the advective part, is zero on any link with
+ *  a solid end. Charge is conserved.
+ *
+ *****************************************************************************/
+
+static int test_nernst_planck_step(pe_t * pe) {
+
+  int nhalo = 1;
+  int ntotal[3] = {8, 8, 8};
+  int nlocal[3] = {0};
+  int noffset[3] = {0};
+  int nsites = 0;
+  double ltot[3] = {0};
+  double sum[2][2] = {0};      /* Total charge [before/after][species] */
+  const double pi = 4.0*atan(1.0);
+
+  cs_t * cs = NULL;
+  map_t * map = NULL;
+  psi_t * psi = NULL;
+  hydro_t * hydro = NULL;
+  physics_t * phys = NULL;
+  fe_electro_t * fe = NULL;
+  nernst_planck_t * np = NULL;
+  double * rho0 = NULL;
+  double * rho1 = NULL;
+
+  map_options_t mapopts = map_options_default();
+  psi_options_t opts = psi_options_default(nhalo);
+  hydro_options_t hopts = hydro_options_default();
+
+  assert(pe);
+
+  physics_create(pe, &phys);
+
+  cs_create(pe, &cs);
+  cs_nhalo_set(cs, nhalo);
+  cs_ntotal_set(cs, ntotal);
+  cs_init(cs);
+  cs_ltot(cs, ltot);
+  cs_nlocal(cs, nlocal);
+  cs_nlocal_offset(cs, noffset);
+  cs_nsites(cs, &nsites);
+
+  map_create(pe, cs, &mapopts, &map);
+
+  opts.beta = 3.0e4;
+  opts.epsilon1 = 3.3e3;
+  opts.epsilon2 = 3.3e3;
+  opts.solver.nstencil = 7;
+  psi_create(pe, cs, &opts, &psi);
+  fe_electro_create(pe, psi, &fe);
+  hydro_create(pe, cs, NULL, &hopts, &hydro);
+
+  /* Smooth, but otherwise arbitrary, rho_k, psi and u; wall at x = 1,
+   * and a colloid site at (4,4,4) */
+
+  for (int ic = 1; ic <= nlocal[X]; ic++) {
+    for (int jc = 1; jc <= nlocal[Y]; jc++) {
+      for (int kc = 1; kc <= nlocal[Z]; kc++) {
+	int index = cs_index(cs, ic, jc, kc);
+	double x = 2.0*pi*(noffset[X] + ic)/ltot[X];
+	double y = 2.0*pi*(noffset[Y] + jc)/ltot[Y];
+	double z = 2.0*pi*(noffset[Z] + kc)/ltot[Z];
+	psi_psi_set(psi, index, 0.01*cos(x)*sin(y) + 0.02*sin(z));
+	psi_rho_set(psi, index, 0, 1.0e-3*(1.0 + 0.5*sin(x + y)));
+	psi_rho_set(psi, index, 1, 1.0e-3*(1.0 + 0.3*cos(y - z)));
+	{
+	  double u[3] = {0.01*sin(y), 0.02*cos(x + z), 0.01*sin(x)};
+	  hydro_u_set(hydro, index, u);
+	}
+	if (noffset[X] + ic == 1) map_status_set(map, index, MAP_BOUNDARY);
+	if (noffset[X] + ic == 4 && noffset[Y] + jc == 4 &&
+	    noffset[Z] + kc == 4) {
+	  map_status_set(map, index, MAP_COLLOID);
+	}
+      }
+    }
+  }
+
+  map_halo(map);
+  psi_halo_psi(psi);
+  psi_halo_rho(psi);
+  hydro_u_halo(hydro);
+
+  rho0 = (double *) malloc(2*nsites*sizeof(double));
+  rho1 = (double *) malloc(2*nsites*sizeof(double));
+  assert(rho0);
+  assert(rho1);
+
+  for (int ia = 0; ia < 2*nsites; ia++) {
+    rho0[ia] = psi->rho->data[ia];
+    rho1[ia] = psi->rho->data[ia];
+  }
+
+  /* Reference: six links of unit length between fluid sites. The
+   * advective flux is the centred difference on the link. */
+
+  {
+    double dt = 0.0;
+    double eunit = 0.0;
+    psi_multistep_timestep(psi, &dt);
+    psi_unit_charge(psi, &eunit);
+
+    for (int ic = 1; ic <= nlocal[X]; ic++) {
+      for (int jc = 1; jc <= nlocal[Y]; jc++) {
+	for (int kc = 1; kc <= nlocal[Z]; kc++) {
+	  int index0 = cs_index(cs, ic, jc, kc);
+	  int status0 = MAP_BOUNDARY;
+	  map_status(map, index0, &status0);
+	  if (status0 != MAP_FLUID) continue;
+	  for (int p = 1; p < psi->stencil->npoints; p++) {
+	    int8_t ** cv = psi->stencil->cv;
+	    int index1 = cs_index(cs, ic + cv[p][X], jc + cv[p][Y],
+				  kc + cv[p][Z]);
+	    int status1 = MAP_BOUNDARY;
+	    map_status(map, index1, &status1);
+	    if (status1 != MAP_FLUID) continue;
+	    double u0[3] = {0};
+	    double u1[3] = {0};
+	    double u = 0.0;
+	    hydro_u(hydro, index0, u0);
+	    hydro_u(hydro, index1, u1);
+	    u = 0.5*((u0[X] + u1[X])*cv[p][X] + (u0[Y] + u1[Y])*cv[p][Y]
+		     + (u0[Z] + u1[Z])*cv[p][Z]);
+	    for (int n = 0; n < 2; n++) {
+	      double mu0 = 0.0;
+	      double mu1 = 0.0;
+	      fe_electro_mu_solv(fe, index0, n, &mu0);
+	      fe_electro_mu_solv(fe, index1, n, &mu1);
+	      mu0 = mu0/eunit + psi->valency[n]*psi->psi->data[index0];
+	      mu1 = mu1/eunit + psi->valency[n]*psi->psi->data[index1];
+	      double r0 = rho0[addr_rank1(nsites, 2, index0, n)];
+	      double r1 = rho0[addr_rank1(nsites, 2, index1, n)];
+	      double flux = u*0.5*(r0 + r1);
+	      flux -= psi->diffusivity[n]*0.5*(1.0 + exp(mu0 - mu1))
+		*(r1*exp(mu1 - mu0) - r0);
+	      rho1[addr_rank1(nsites, 2, index0, n)] -= flux*dt;
+	    }
+	  }
+	}
+      }
+    }
+  }
+
+  /* One step on the target */
+
+  nernst_planck_create(pe, cs, psi, &np);
+  map_memcpy(map, tdpMemcpyHostToDevice);
+  hydro_memcpy(hydro, tdpMemcpyHostToDevice);
+  field_memcpy(psi->rho, tdpMemcpyHostToDevice);
+  nernst_planck_mu_compute(np, psi, (fe_t *) fe);
+  nernst_planck_step(np, psi, hydro, map);
+  field_memcpy(psi->rho, tdpMemcpyDeviceToHost);
+  nernst_planck_free(np);
+
+  {
+    int ifail = 0;
+    double maxacc = 0.0;
+
+    for (int ic = 1; ic <= nlocal[X]; ic++) {
+      for (int jc = 1; jc <= nlocal[Y]; jc++) {
+	for (int kc = 1; kc <= nlocal[Z]; kc++) {
+	  int index = cs_index(cs, ic, jc, kc);
+	  int status = MAP_BOUNDARY;
+	  map_status(map, index, &status);
+	  if (status != MAP_FLUID) continue;
+	  for (int n = 0; n < 2; n++) {
+	    int iaddr = addr_rank1(nsites, 2, index, n);
+	    double rho = psi->rho->data[iaddr];
+	    if (fabs(rho - rho1[iaddr]) > 100.0*DBL_EPSILON*rho) ifail += 1;
+	    sum[0][n] += rho0[iaddr];
+	    sum[1][n] += rho;
+	  }
+	}
+      }
+    }
+    assert(ifail == 0);
+
+    nernst_planck_maxacc(&maxacc);
+    assert(maxacc > 0.0);
+  }
+
+  {
+    double sum_total[2][2] = {0};
+    MPI_Comm comm = MPI_COMM_NULL;
+    cs_cart_comm(cs, &comm);
+    MPI_Allreduce(sum, sum_total, 4, MPI_DOUBLE, MPI_SUM, comm);
+    for (int n = 0; n < 2; n++) {
+      assert(fabs(sum_total[1][n] - sum_total[0][n]) < FLT_EPSILON*1.0e-3);
+    }
+  }
+
+  free(rho1);
+  free(rho0);
+  hydro_free(hydro);
+  map_free(&map);
+  fe_electro_free(fe);
+  psi_free(&psi);
+  cs_free(cs);
+  physics_free(phys);
+
+  return 0;
+}
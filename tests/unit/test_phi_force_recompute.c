@@ -0,0 +1,194 @@
+/*****************************************************************************
+ *
+ *  test_phi_force_recompute.c
+ *
+ *  The stress divergence with the stress recomputed at each face must
+ *  agree exactly with the stored-stress version.
+ *
+ *  Edinburgh Soft Matter and Statistical Physics Group and
+ *  Edinburgh Parallel Computing Centre
+ *
+ *  (c) 2024 The University of Edinburgh
+ *
+ *  Contributing authors:
+ *  Kevin Stratford (kevin@epcc.ed.ac.uk)
+ *
+ *****************************************************************************/
+
+#include <assert.h>
+#include <math.h>
+
+#include "pe.h"
+#include "coords.h"
+#include "leesedwards.h"
+#include "physics.h"
+#include "field.h"
+#include "field_grad.h"
+#include "gradient_3d_7pt_fluid.h"
+#include "hydro.h"
+#include "phi_force_stress.h"
+#include "phi_force_colloid.h"
+#include "blue_phase.h"
+#include "tests.h"
+
+static int test_pth_force_recompute_lc(pe_t * pe, cs_t * cs, lees_edw_t * le);
+
+/*****************************************************************************
+ *
+ *  test_phi_force_recompute_suite
+ *
+ *****************************************************************************/
+
+int test_phi_force_recompute_suite(void) {
+
+  int ntotal[3] = {16, 16, 16};
+  pe_t * pe = NULL;
+  cs_t * cs = NULL;
+  lees_edw_t * le = NULL;
+
+  pe_create(MPI_COMM_WORLD, PE_QUIET, &pe);
+
+  cs_create(pe, &cs);
+  cs_nhalo_set(cs, 2);
+  cs_ntotal_set(cs, ntotal);
+  cs_init(cs);
+  lees_edw_create(pe, cs, NULL, &le);
+
+  test_pth_force_recompute_lc(pe, cs, le);
+
+  lees_edw_free(le);
+  cs_free(cs);
+
+  pe_info(pe, "PASS     ./unit/test_phi_force_recompute\n");
+  pe_free(pe);
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  test_pth_force_recompute_lc
+ *
+ *  Liquid crystal: pth_stress_compute() and pth_force_fluid_driver()
+ *  against pth_force_fluid_recompute_driver().
+ *
+ *****************************************************************************/
+
+static int test_pth_force_recompute_lc(pe_t * pe, cs_t * cs, lees_edw_t * le) {
+
+  int ifail = 0;
+  int nhalo = 0;
+  int nlocal[3] = {0};
+  int noffset[3] = {0};
+  double ltot[3] = {0};
+  double fabsmax = 0.0;
+  const double pi = 4.0*atan(1.0);
+
+  physics_t * phys = NULL;
+  field_t * fq = NULL;
+  field_grad_t * fqgrad = NULL;
+  fe_lc_t * fe = NULL;
+  pth_t * pth0 = NULL;
+  pth_t * pth1 = NULL;
+  hydro_t * hydro0 = NULL;
+  hydro_t * hydro1 = NULL;
+
+  assert(pe);
+  assert(cs);
+  assert(le);
+
+  physics_create(pe, &phys);
+  cs_nhalo(cs, &nhalo);
+  cs_nlocal(cs, nlocal);
+  cs_nlocal_offset(cs, noffset);
+  cs_ltot(cs, ltot);
+
+  {
+    field_options_t opts = field_options_ndata_nhalo(NQAB, nhalo);
+    field_create(pe, cs, le, "q", &opts, &fq);
+    field_grad_create(pe, fq, 2, &fqgrad);
+    field_grad_set(fqgrad, grad_3d_7pt_fluid_d2, NULL);
+  }
+
+  fe_lc_create(pe, cs, le, fq, fqgrad, &fe);
+
+  {
+    fe_lc_param_t param = {
+      .a0 = 0.014384711,
+      .gamma = 3.1764706,
+      .kappa0 = 0.01,
+      .kappa1 = 0.01,
+      .q0 = 0.19635,
+      .xi = 0.7,
+      .redshift = 1.0,
+      .rredshift = 1.0
+    };
+    fe_lc_param_set(fe, &param);
+  }
+
+  {
+    hydro_options_t opts = hydro_options_default();
+    hydro_create(pe, cs, le, &opts, &hydro0);
+    hydro_create(pe, cs, le, &opts, &hydro1);
+  }
+
+  pth_create(pe, cs, FE_FORCE_METHOD_STRESS_DIVERGENCE, &pth0);
+  pth_create(pe, cs, FE_FORCE_METHOD_STRESS_RECOMPUTE, &pth1);
+  assert(pth1->str == NULL);
+
+  /* A smooth Q_ab */
+
+  for (int ic = 1; ic <= nlocal[X]; ic++) {
+    for (int jc = 1; jc <= nlocal[Y]; jc++) {
+      for (int kc = 1; kc <= nlocal[Z]; kc++) {
+	int index = cs_index(cs, ic, jc, kc);
+	double x = 2.0*pi*(noffset[X] + ic)/ltot[X];
+	double y = 2.0*pi*(noffset[Y] + jc)/ltot[Y];
+	double z = 2.0*pi*(noffset[Z] + kc)/ltot[Z];
+	double q[NQAB] = {0.1*cos(y), 0.05*sin(x + z), 0.03*cos(x)*sin(y),
+			  -0.1*cos(y) + 0.04*sin(2.0*x), 0.06*sin(y - z)};
+	for (int n = 0; n < NQAB; n++) {
+	  fq->data[addr_rank1(fq->nsites, NQAB, index, n)] = q[n];
+	}
+      }
+    }
+  }
+
+  field_memcpy(fq, tdpMemcpyHostToDevice);
+  field_halo(fq);
+  field_grad_compute(fqgrad);
+
+  pth_stress_compute(pth0, (fe_t *) fe);
+  pth_force_fluid_driver(pth0, hydro0);
+  pth_force_fluid_recompute_driver(pth1, (fe_t *) fe, hydro1);
+  hydro_memcpy(hydro0, tdpMemcpyDeviceToHost);
+  hydro_memcpy(hydro1, tdpMemcpyDeviceToHost);
+
+  for (int ic = 1; ic <= nlocal[X]; ic++) {
+    for (int jc = 1; jc <= nlocal[Y]; jc++) {
+      for (int kc = 1; kc <= nlocal[Z]; kc++) {
+	int index = cs_index(cs, ic, jc, kc);
+	for (int ia = 0; ia < 3; ia++) {
+	  int iaddr = addr_rank1(hydro0->nsite, NHDIM, index, ia);
+	  double f0 = hydro0->force->data[iaddr];
+	  double f1 = hydro1->force->data[iaddr];
+	  if (f1 != f0) ifail += 1;
+	  fabsmax = fmax(fabsmax, fabs(f0));
+	}
+      }
+    }
+  }
+  assert(ifail == 0);
+  assert(fabsmax > 0.0);
+
+  pth_free(pth1);
+  pth_free(pth0);
+  hydro_free(hydro1);
+  hydro_free(hydro0);
+  fe_lc_free(fe);
+  field_grad_free(fqgrad);
+  field_free(fq);
+  physics_free(phys);
+
+  return ifail;
+}
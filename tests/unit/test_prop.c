@@ -7,7 +7,7 @@
  *  Edinburgh Soft Matter and Statistical Physics Group and
  *  Edinburgh Parallel Computing Centre
  *
- *  (c) 2010-2022 Ths University of Edinburgh
+ *  (c) 2010-2024 The University of Edinburgh
  *
  *  Contributing authors: 
  *  Kevin Stratford (kevin@epcc.ed.ac.uk)
@@ -22,6 +22,8 @@
 #include "coords.h"
 #include "kernel.h"
 #include "memory.h"
+#include "physics.h"
+#include "collision.h"
 #include "propagation.h"
 #include "tests.h"
 
@@ -29,6 +31,11 @@ __host__ int do_test_velocity(pe_t * pe, cs_t * cs, int ndist,
 			      lb_halo_enum_t halo);
 __host__ int do_test_source_destination(pe_t * pe, cs_t * cs, int ndist,
 					lb_halo_enum_t halo);
+__host__ int do_test_propagation_defer(pe_t * pe, cs_t * cs);
+__host__ int do_test_propagation_aa(pe_t * pe, cs_t * cs, int nstep);
+__host__ int do_test_propagation_overlap(pe_t * pe, cs_t * cs, int nstep);
+__host__ int do_test_fluid_list(pe_t * pe, cs_t * cs);
+__host__ int do_test_sparse(pe_t * pe, cs_t * cs, int nstep);
 
 /*****************************************************************************
  *
@@ -48,20 +55,35 @@ int test_lb_prop_suite(void) {
 
   tdpGetDeviceCount(&ndevice);
 
+  /* The target halo is double only (and required for ndist = 2) */
+
+#ifndef LB_DATA_FLOAT
   do_test_velocity(pe, cs, 1, LB_HALO_TARGET);
   do_test_velocity(pe, cs, 2, LB_HALO_TARGET);
+#endif
   if (ndevice == 0) {
     do_test_velocity(pe, cs, 1, LB_HALO_OPENMP_FULL);
     do_test_velocity(pe, cs, 1, LB_HALO_OPENMP_REDUCED);
   }
 
+#ifndef LB_DATA_FLOAT
   do_test_source_destination(pe, cs, 1, LB_HALO_TARGET);
   do_test_source_destination(pe, cs, 2, LB_HALO_TARGET);
+#endif
   if (ndevice == 0) {
     do_test_source_destination(pe, cs, 1, LB_HALO_OPENMP_FULL);
     do_test_source_destination(pe, cs, 1, LB_HALO_OPENMP_REDUCED);
   }
 
+  do_test_propagation_defer(pe, cs);
+  if (ndevice == 0) {
+    do_test_propagation_aa(pe, cs, 3);
+    do_test_propagation_aa(pe, cs, 4);
+    do_test_propagation_overlap(pe, cs, 2);
+  }
+  do_test_fluid_list(pe, cs);
+  if (ndevice == 0) do_test_sparse(pe, cs, 2);
+
   pe_info(pe, "PASS     ./unit/test_prop\n");
   cs_free(cs);
   pe_free(pe);
@@ -260,3 +282,605 @@ int do_test_source_destination(pe_t * pe, cs_t * cs, int ndist,
 
   return 0;
 }
+
+/*****************************************************************************
+ *
+ *  do_test_propagation_defer
+ *
+ *  The fused schedule (deferred propagation followed by a combined
+ *  stream and collide) must reproduce the split schedule. There
+ *  is one solid site which is propagated, but not collided.
+ *
+ *****************************************************************************/
+
+int do_test_propagation_defer(pe_t * pe, cs_t * cs) {
+
+  int nstep = 3;
+  int nlocal[3] = {0};
+  double fbody[3] = {1.0e-05, 2.0e-05, 3.0e-05};
+
+  lb_data_options_t options = lb_data_options_default();
+  hydro_options_t hopts = hydro_options_default();
+  map_options_t mopts = map_options_default();
+
+  physics_t * phys = NULL;
+  lees_edw_t * le = NULL;
+  hydro_t * hydro = NULL;
+  map_t * map = NULL;
+  lb_t * lbsplit = NULL;
+  lb_t * lbfused = NULL;
+
+  assert(pe);
+  assert(cs);
+
+  physics_create(pe, &phys);
+  physics_eta_shear_set(phys, 0.1);
+  physics_fbody_set(phys, fbody);
+
+  lees_edw_create(pe, cs, NULL, &le);
+  hydro_create(pe, cs, le, &hopts, &hydro);
+  map_create(pe, cs, &mopts, &map);
+
+  options.ndim = NDIM;
+  options.nvel = NVEL;
+  options.ndist = 1;
+
+  lb_data_create(pe, cs, &options, &lbsplit);
+  lb_data_create(pe, cs, &options, &lbfused);
+  lb_collision_relaxation_times_set(lbsplit);
+  lb_collision_relaxation_times_set(lbfused);
+
+  cs_nlocal(cs, nlocal);
+
+  /* Initial state with some variation across the lattice */
+
+  for (int ic = 1; ic <= nlocal[X]; ic++) {
+    for (int jc = 1; jc <= nlocal[Y]; jc++) {
+      for (int kc = 1; kc <= nlocal[Z]; kc++) {
+	int index = cs_index(cs, ic, jc, kc);
+	for (int p = 0; p < NVEL; p++) {
+	  double f = lbsplit->model.wv[p]*(1.0 + 0.01*((ic + 2*jc + 3*kc) % 7));
+	  lb_f_set(lbsplit, index, p, 0, f);
+	  lb_f_set(lbfused, index, p, 0, f);
+	}
+      }
+    }
+  }
+
+  map_status_set(map, cs_index(cs, 2, 2, 2), MAP_BOUNDARY);
+  map_memcpy(map, tdpMemcpyHostToDevice);
+  map_halo(map);
+
+  lb_memcpy(lbsplit, tdpMemcpyHostToDevice);
+  lb_memcpy(lbfused, tdpMemcpyHostToDevice);
+
+  for (int n = 0; n < nstep; n++) {
+    lb_collide(lbsplit, hydro, map, NULL, NULL, NULL);
+    lb_halo(lbsplit);
+    lb_propagation(lbsplit);
+
+    lb_collide(lbfused, hydro, map, NULL, NULL, NULL);
+    lb_halo(lbfused);
+    lb_propagation_defer(lbfused);
+    assert(lbfused->fpending == 1);
+  }
+
+  lb_propagation_flush(lbfused);
+  assert(lbfused->fpending == 0);
+
+  lb_memcpy(lbsplit, tdpMemcpyDeviceToHost);
+  lb_memcpy(lbfused, tdpMemcpyDeviceToHost);
+
+  for (int ic = 1; ic <= nlocal[X]; ic++) {
+    for (int jc = 1; jc <= nlocal[Y]; jc++) {
+      for (int kc = 1; kc <= nlocal[Z]; kc++) {
+	int index = cs_index(cs, ic, jc, kc);
+	for (int p = 0; p < NVEL; p++) {
+	  double fs = 0.0;
+	  double ff = 0.0;
+	  lb_f(lbsplit, index, p, 0, &fs);
+	  lb_f(lbfused, index, p, 0, &ff);
+	  assert(fabs(fs - ff) < DBL_EPSILON);
+	}
+      }
+    }
+  }
+
+  lb_free(lbfused);
+  lb_free(lbsplit);
+  map_free(&map);
+  hydro_free(hydro);
+  lees_edw_free(le);
+  physics_free(phys);
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  do_test_propagation_aa
+ *
+ *  The in-place (AA) schedule must reproduce the split schedule.
+ *  An odd number of steps ends with a pending propagation (after
+ *  an even step) which must be flushed; an even number of steps
+ *  ends after the reverse halo swap.
+ *
+ *****************************************************************************/
+
+int do_test_propagation_aa(pe_t * pe, cs_t * cs, int nstep) {
+
+  int nlocal[3] = {0};
+  double fbody[3] = {1.0e-05, 2.0e-05, 3.0e-05};
+
+  lb_data_options_t options = lb_data_options_default();
+  hydro_options_t hopts = hydro_options_default();
+  map_options_t mopts = map_options_default();
+
+  physics_t * phys = NULL;
+  lees_edw_t * le = NULL;
+  hydro_t * hydro = NULL;
+  map_t * map = NULL;
+  lb_t * lbsplit = NULL;
+  lb_t * lbaa = NULL;
+
+  assert(pe);
+  assert(cs);
+
+  physics_create(pe, &phys);
+  physics_eta_shear_set(phys, 0.1);
+  physics_fbody_set(phys, fbody);
+
+  lees_edw_create(pe, cs, NULL, &le);
+  hydro_create(pe, cs, le, &hopts, &hydro);
+  map_create(pe, cs, &mopts, &map);
+
+  options.ndim = NDIM;
+  options.nvel = NVEL;
+  options.ndist = 1;
+
+  lb_data_create(pe, cs, &options, &lbsplit);
+
+  options.schedule = LB_SCHEDULE_AA;
+  lb_data_create(pe, cs, &options, &lbaa);
+  assert(lbaa->fprime == NULL);
+
+  lb_collision_relaxation_times_set(lbsplit);
+  lb_collision_relaxation_times_set(lbaa);
+
+  cs_nlocal(cs, nlocal);
+
+  for (int ic = 1; ic <= nlocal[X]; ic++) {
+    for (int jc = 1; jc <= nlocal[Y]; jc++) {
+      for (int kc = 1; kc <= nlocal[Z]; kc++) {
+	int index = cs_index(cs, ic, jc, kc);
+	for (int p = 0; p < NVEL; p++) {
+	  double f = lbsplit->model.wv[p]*(1.0 + 0.01*((ic + 2*jc + 3*kc) % 7));
+	  lb_f_set(lbsplit, index, p, 0, f);
+	  lb_f_set(lbaa, index, p, 0, f);
+	}
+      }
+    }
+  }
+
+  map_status_set(map, cs_index(cs, 2, 2, 2), MAP_BOUNDARY);
+  map_memcpy(map, tdpMemcpyHostToDevice);
+  map_halo(map);
+
+  for (int n = 0; n < nstep; n++) {
+    lb_collide(lbsplit, hydro, map, NULL, NULL, NULL);
+    lb_halo(lbsplit);
+    lb_propagation(lbsplit);
+
+    lb_collide(lbaa, hydro, map, NULL, NULL, NULL);
+    if (lbaa->fpending) {
+      lb_halo(lbaa);
+    }
+    else {
+      lb_halo_reverse(lbaa);
+    }
+  }
+
+  assert(lbaa->fpending == (nstep % 2));
+  lb_propagation_flush(lbaa);
+  assert(lbaa->fpending == 0);
+
+  for (int ic = 1; ic <= nlocal[X]; ic++) {
+    for (int jc = 1; jc <= nlocal[Y]; jc++) {
+      for (int kc = 1; kc <= nlocal[Z]; kc++) {
+	int index = cs_index(cs, ic, jc, kc);
+	for (int p = 0; p < NVEL; p++) {
+	  double fs = 0.0;
+	  double fa = 0.0;
+	  lb_f(lbsplit, index, p, 0, &fs);
+	  lb_f(lbaa, index, p, 0, &fa);
+	  assert(fabs(fs - fa) < DBL_EPSILON);
+	}
+      }
+    }
+  }
+
+  lb_free(lbaa);
+  lb_free(lbsplit);
+  map_free(&map);
+  hydro_free(hydro);
+  lees_edw_free(le);
+  physics_free(phys);
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  do_test_propagation_overlap
+ *
+ *  Collision with the halo swap overlapped must reproduce the split
+ *  schedule (the halo swap is complete on return from the collision).
+ *
+ *****************************************************************************/
+
+int do_test_propagation_overlap(pe_t * pe, cs_t * cs, int nstep) {
+
+  int nlocal[3] = {0};
+  double fbody[3] = {1.0e-05, 2.0e-05, 3.0e-05};
+
+  lb_data_options_t options = lb_data_options_default();
+  hydro_options_t hopts = hydro_options_default();
+  map_options_t mopts = map_options_default();
+
+  physics_t * phys = NULL;
+  lees_edw_t * le = NULL;
+  hydro_t * hydro = NULL;
+  map_t * map = NULL;
+  lb_t * lbsplit = NULL;
+  lb_t * lbover = NULL;
+
+  assert(pe);
+  assert(cs);
+
+  physics_create(pe, &phys);
+  physics_eta_shear_set(phys, 0.1);
+  physics_fbody_set(phys, fbody);
+
+  lees_edw_create(pe, cs, NULL, &le);
+  hydro_create(pe, cs, le, &hopts, &hydro);
+  map_create(pe, cs, &mopts, &map);
+
+  options.ndim = NDIM;
+  options.nvel = NVEL;
+  options.ndist = 1;
+  options.halo = LB_HALO_OPENMP_FULL;
+
+  lb_data_create(pe, cs, &options, &lbsplit);
+
+  options.schedule = LB_SCHEDULE_OVERLAP;
+  assert(lb_data_options_valid(&options));
+  lb_data_create(pe, cs, &options, &lbover);
+
+  lb_collision_relaxation_times_set(lbsplit);
+  lb_collision_relaxation_times_set(lbover);
+
+  cs_nlocal(cs, nlocal);
+
+  for (int ic = 1; ic <= nlocal[X]; ic++) {
+    for (int jc = 1; jc <= nlocal[Y]; jc++) {
+      for (int kc = 1; kc <= nlocal[Z]; kc++) {
+	int index = cs_index(cs, ic, jc, kc);
+	for (int p = 0; p < NVEL; p++) {
+	  double f = lbsplit->model.wv[p]*(1.0 + 0.01*((ic + 2*jc + 3*kc) % 7));
+	  lb_f_set(lbsplit, index, p, 0, f);
+	  lb_f_set(lbover, index, p, 0, f);
+	}
+      }
+    }
+  }
+
+  map_status_set(map, cs_index(cs, 1, 2, 2), MAP_BOUNDARY);
+  map_memcpy(map, tdpMemcpyHostToDevice);
+  map_halo(map);
+
+  for (int n = 0; n < nstep; n++) {
+    lb_collide(lbsplit, hydro, map, NULL, NULL, NULL);
+    lb_halo(lbsplit);
+    lb_propagation(lbsplit);
+
+    lb_collide(lbover, hydro, map, NULL, NULL, NULL);
+    lb_propagation(lbover);
+  }
+
+  for (int ic = 1; ic <= nlocal[X]; ic++) {
+    for (int jc = 1; jc <= nlocal[Y]; jc++) {
+      for (int kc = 1; kc <= nlocal[Z]; kc++) {
+	int index = cs_index(cs, ic, jc, kc);
+	for (int p = 0; p < NVEL; p++) {
+	  double fs = 0.0;
+	  double fo = 0.0;
+	  lb_f(lbsplit, index, p, 0, &fs);
+	  lb_f(lbover, index, p, 0, &fo);
+	  assert(fabs(fs - fo) < DBL_EPSILON);
+	}
+      }
+    }
+  }
+
+  lb_free(lbover);
+  lb_free(lbsplit);
+  map_free(&map);
+  hydro_free(hydro);
+  lees_edw_free(le);
+  physics_free(phys);
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  do_test_fluid_list
+ *
+ *  Collision and propagation restricted to blocks containing fluid
+ *  must agree with the full update at fluid sites. A single step is
+ *  used as there is no bounce-back at the solid sites here.
+ *
+ *****************************************************************************/
+
+int do_test_fluid_list(pe_t * pe, cs_t * cs) {
+
+  int nlocal[3] = {0};
+  double fbody[3] = {1.0e-05, 2.0e-05, 3.0e-05};
+
+  lb_data_options_t options = lb_data_options_default();
+  hydro_options_t hopts = hydro_options_default();
+  map_options_t mopts = map_options_default();
+
+  physics_t * phys = NULL;
+  lees_edw_t * le = NULL;
+  hydro_t * hydro = NULL;
+  map_t * map = NULL;
+  lb_t * lbfull = NULL;
+  lb_t * lblist = NULL;
+
+  assert(pe);
+  assert(cs);
+
+  physics_create(pe, &phys);
+  physics_eta_shear_set(phys, 0.1);
+  physics_fbody_set(phys, fbody);
+
+  lees_edw_create(pe, cs, NULL, &le);
+  hydro_create(pe, cs, le, &hopts, &hydro);
+  map_create(pe, cs, &mopts, &map);
+
+  options.ndim = NDIM;
+  options.nvel = NVEL;
+  options.ndist = 1;
+
+  lb_data_create(pe, cs, &options, &lbfull);
+
+  options.fluidlist = 1;
+  assert(lb_data_options_valid(&options));
+  lb_data_create(pe, cs, &options, &lblist);
+
+  lb_collision_relaxation_times_set(lbfull);
+  lb_collision_relaxation_times_set(lblist);
+
+  cs_nlocal(cs, nlocal);
+
+  /* Solid x-planes ic = 2, 3, 4 and some isolated solid sites */
+
+  for (int ic = 1; ic <= nlocal[X]; ic++) {
+    for (int jc = 1; jc <= nlocal[Y]; jc++) {
+      for (int kc = 1; kc <= nlocal[Z]; kc++) {
+	int index = cs_index(cs, ic, jc, kc);
+	int solid = (2 <= ic && ic <= 4) || ((ic + jc + kc) % 5 == 0);
+	if (solid) map_status_set(map, index, MAP_BOUNDARY);
+	for (int p = 0; p < NVEL; p++) {
+	  double f = lbfull->model.wv[p]*(1.0 + 0.01*((ic + 2*jc + 3*kc) % 7));
+	  lb_f_set(lbfull, index, p, 0, f);
+	  lb_f_set(lblist, index, p, 0, f);
+	}
+      }
+    }
+  }
+
+  map_memcpy(map, tdpMemcpyHostToDevice);
+  map_halo(map);
+
+  lb_data_fluid_list(lblist, map);
+  assert(lblist->block);
+  assert(0 < lblist->nblock);
+  assert(lblist->nblock < nlocal[X]*(nlocal[Y] + 2)*(nlocal[Z] + 2)/NSIMDVL);
+
+  lb_memcpy(lbfull, tdpMemcpyHostToDevice);
+  lb_memcpy(lblist, tdpMemcpyHostToDevice);
+
+  lb_collide(lbfull, hydro, map, NULL, NULL, NULL);
+  lb_halo(lbfull);
+  lb_propagation(lbfull);
+
+  lb_collide(lblist, hydro, map, NULL, NULL, NULL);
+  lb_halo(lblist);
+  lb_propagation(lblist);
+
+  lb_memcpy(lbfull, tdpMemcpyDeviceToHost);
+  lb_memcpy(lblist, tdpMemcpyDeviceToHost);
+
+  for (int ic = 1; ic <= nlocal[X]; ic++) {
+    for (int jc = 1; jc <= nlocal[Y]; jc++) {
+      for (int kc = 1; kc <= nlocal[Z]; kc++) {
+	int index = cs_index(cs, ic, jc, kc);
+	int status = MAP_FLUID;
+	map_status(map, index, &status);
+	if (status != MAP_FLUID) continue;
+	for (int p = 0; p < NVEL; p++) {
+	  double ff = 0.0;
+	  double fl = 0.0;
+	  lb_f(lbfull, index, p, 0, &ff);
+	  lb_f(lblist, index, p, 0, &fl);
+	  assert(fabs(ff - fl) < DBL_EPSILON);
+	}
+      }
+    }
+  }
+
+  lb_free(lblist);
+  lb_free(lbfull);
+  map_free(&map);
+  hydro_free(hydro);
+  lees_edw_free(le);
+  physics_free(phys);
+
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ *  do_test_sparse
+ *
+ *  Sparse storage must agree at fluid sites with the dense storage,
+ *  where the bounce-back at solid sites is applied explicitly
+ *  between collision and propagation (as wall_bbl() would).
+ *
+ *****************************************************************************/
+
+int do_test_sparse(pe_t * pe, cs_t * cs, int nstep) {
+
+  int nlocal[3] = {0};
+  int nfluid = 0;
+  double fbody[3] = {1.0e-05, 2.0e-05, 3.0e-05};
+
+  lb_data_options_t options = lb_data_options_default();
+  hydro_options_t hopts = hydro_options_default();
+  map_options_t mopts = map_options_default();
+
+  physics_t * phys = NULL;
+  lees_edw_t * le = NULL;
+  hydro_t * hydro = NULL;
+  map_t * map = NULL;
+  lb_t * lbfull = NULL;
+  lb_t * lbsprs = NULL;
+
+  assert(pe);
+  assert(cs);
+
+  physics_create(pe, &phys);
+  physics_eta_shear_set(phys, 0.1);
+  physics_fbody_set(phys, fbody);
+
+  lees_edw_create(pe, cs, NULL, &le);
+  hydro_create(pe, cs, le, &hopts, &hydro);
+  map_create(pe, cs, &mopts, &map);
+
+  options.ndim = NDIM;
+  options.nvel = NVEL;
+  options.ndist = 1;
+  options.halo = LB_HALO_OPENMP_FULL;
+
+  lb_data_create(pe, cs, &options, &lbfull);
+
+  options.sparse = 1;
+  assert(lb_data_options_valid(&options));
+  lb_data_create(pe, cs, &options, &lbsprs);
+  assert(lbsprs->f == NULL);
+
+  lb_collision_relaxation_times_set(lbfull);
+  lb_collision_relaxation_times_set(lbsprs);
+
+  cs_nlocal(cs, nlocal);
+
+  /* Solid x-planes ic = 2, 3, 4 and some isolated solid sites */
+
+  for (int ic = 1; ic <= nlocal[X]; ic++) {
+    for (int jc = 1; jc <= nlocal[Y]; jc++) {
+      for (int kc = 1; kc <= nlocal[Z]; kc++) {
+	int index = cs_index(cs, ic, jc, kc);
+	int solid = (2 <= ic && ic <= 4) || ((ic + jc + kc) % 5 == 0);
+	if (solid) map_status_set(map, index, MAP_BOUNDARY);
+	if (!solid) nfluid += 1;
+      }
+    }
+  }
+
+  map_halo(map);
+  lb_data_sparse(lbsprs, map);
+  assert(lbsprs->nfluid == nfluid);
+  assert(lbsprs->nslot >= nfluid);
+
+  for (int ic = 1; ic <= nlocal[X]; ic++) {
+    for (int jc = 1; jc <= nlocal[Y]; jc++) {
+      for (int kc = 1; kc <= nlocal[Z]; kc++) {
+	int index = cs_index(cs, ic, jc, kc);
+	for (int p = 0; p < NVEL; p++) {
+	  double f = lbfull->model.wv[p]*(1.0 + 0.01*((ic + 2*jc + 3*kc) % 7));
+	  lb_f_set(lbfull, index, p, 0, f);
+	  lb_f_set(lbsprs, index, p, 0, f);
+	}
+      }
+    }
+  }
+
+  for (int n = 0; n < nstep; n++) {
+
+    lb_collide(lbfull, hydro, map, NULL, NULL, NULL);
+    lb_halo(lbfull);
+
+    /* Bounce-back: f_p(j) = f_pbar(i) for fluid i, solid j = i - c_p */
+    for (int ic = 1; ic <= nlocal[X]; ic++) {
+      for (int jc = 1; jc <= nlocal[Y]; jc++) {
+	for (int kc = 1; kc <= nlocal[Z]; kc++) {
+	  int index = cs_index(cs, ic, jc, kc);
+	  int status = MAP_FLUID;
+	  map_status(map, index, &status);
+	  if (status != MAP_FLUID) continue;
+	  for (int p = 1; p < NVEL; p++) {
+	    int indexj = cs_index(cs, ic - lbfull->model.cv[p][X],
+				  jc - lbfull->model.cv[p][Y],
+				  kc - lbfull->model.cv[p][Z]);
+	    map_status(map, indexj, &status);
+	    if (status != MAP_FLUID) {
+	      double f = 0.0;
+	      lb_f(lbfull, index, NVEL - p, 0, &f);
+	      lb_f_set(lbfull, indexj, p, 0, f);
+	    }
+	  }
+	}
+      }
+    }
+    lb_propagation(lbfull);
+
+    lb_collide(lbsprs, hydro, map, NULL, NULL, NULL);
+    lb_halo(lbsprs);
+    lb_propagation(lbsprs);
+  }
+
+  for (int ic = 1; ic <= nlocal[X]; ic++) {
+    for (int jc = 1; jc <= nlocal[Y]; jc++) {
+      for (int kc = 1; kc <= nlocal[Z]; kc++) {
+	int index = cs_index(cs, ic, jc, kc);
+	int status = MAP_FLUID;
+	map_status(map, index, &status);
+	for (int p = 0; p < NVEL; p++) {
+	  double ff = 0.0;
+	  double fs = 0.0;
+	  lb_f(lbfull, index, p, 0, &ff);
+	  lb_f(lbsprs, index, p, 0, &fs);
+	  if (status == MAP_FLUID) {
+	    assert(fabs(ff - fs) < DBL_EPSILON);
+	  }
+	  else {
+	    /* Not stored */
+	    assert(lb_data_addr(lbsprs, index, 0, p) == -1);
+	    assert(fabs(fs) < DBL_EPSILON);
+	  }
+	}
+      }
+    }
+  }
+
+  lb_free(lbsprs);
+  lb_free(lbfull);
+  map_free(&map);
+  hydro_free(hydro);
+  lees_edw_free(le);
+  physics_free(phys);
+
+  return 0;
+}
@@ -88,6 +88,13 @@ int test_psi_poisson_solver_to_string(void) {
     assert(ifail == 0);
   }
 
+  {
+    psi_poisson_solver_enum_t mg = PSI_POISSON_SOLVER_MULTIGRID;
+    const char * str = psi_poisson_solver_to_string(mg);
+    ifail += strcmp(str, "multigrid");
+    assert(ifail == 0);
+  }
+
   {
     const char * str = psi_poisson_solver_to_string(PSI_POISSON_SOLVER_INVALID);
     ifail += strcmp(str, "invalid");
@@ -124,6 +131,12 @@ int test_psi_poisson_solver_from_string(void) {
     if (ps != PSI_POISSON_SOLVER_NONE) ifail += 1;
   }
 
+  {
+    psi_poisson_solver_enum_t ps = psi_poisson_solver_from_string("Multigrid");
+    if (ps != PSI_POISSON_SOLVER_MULTIGRID) ifail += 1;
+    assert(ifail == 0);
+  }
+
   {
     /* Sample rubbish */
     psi_poisson_solver_enum_t ps = psi_poisson_solver_from_string("RUBBISH");
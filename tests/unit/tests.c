@@ -58,6 +58,7 @@ __host__ int tests_create(int argc, char ** argv) {
 
   /* i/o infrastructure */
   test_io_aggregator_suite();
+  test_io_compress_suite();
   test_io_element_suite();
   test_io_options_suite();
   test_io_options_rt_suite();
@@ -66,6 +67,7 @@ __host__ int tests_create(int argc, char ** argv) {
   test_io_subfile_suite();
   test_io_metadata_suite();
   test_io_impl_mpio_suite();
+  test_io_impl_node_suite();
 
   /* Kernel helpers */
   test_kernel_3d_suite();
@@ -75,16 +77,22 @@ __host__ int tests_create(int argc, char ** argv) {
   test_angle_cosine_suite();
   test_assumptions_suite();
   test_be_suite();
+  test_bbl_suite();
   test_bond_fene_suite();
   test_bonds_suite();
   test_bp_suite();
+  test_fe_lc_fused_suite();
   test_build_suite();
   test_ch_suite();
   test_colloid_suite();
+  test_colloid_cell_table_suite();
+  test_colloid_io_suite();
+  test_colloid_pair_list_suite();
   test_colloid_sums_suite();
   test_colloids_info_suite();
   test_colloids_halo_suite();
   test_ewald_suite();
+  test_ewald_spme_suite();
   test_fe_null_suite();
   test_fe_electro_suite();
   test_fe_electro_symm_suite();
@@ -130,6 +138,7 @@ __host__ int tests_create(int argc, char ** argv) {
   test_phi_bc_outflow_opts_suite();
   test_phi_bc_outflow_free_suite();
   test_phi_ch_suite();
+  test_phi_force_recompute_suite();
   test_polar_active_suite();
 
   test_psi_solver_options_suite(argc, argv);
@@ -137,6 +146,7 @@ __host__ int tests_create(int argc, char ** argv) {
   test_psi_suite();
   test_psi_solver_petsc_suite();
   test_psi_sor_suite();
+  test_psi_mg_suite();
   test_nernst_planck_suite();
   test_lb_prop_suite();
   test_random_suite();
@@ -29,18 +29,24 @@ __host__ __device__ void test_assert_info(const int lvalue, int line,
 int test_angle_cosine_suite(void);
 int test_assumptions_suite(void);
 int test_be_suite(void);
+int test_bbl_suite(void);
 int test_bp_suite(void);
+int test_fe_lc_fused_suite(void);
 int test_bond_fene_suite(void);
 int test_bonds_suite(void);
 int test_build_suite(void);
 int test_ch_suite(void);
 int test_colloid_sums_suite(void);
 int test_colloid_suite(void);
+int test_colloid_cell_table_suite(void);
+int test_colloid_io_suite(void);
+int test_colloid_pair_list_suite(void);
 int test_colloids_info_suite(void);
 int test_colloids_halo_suite(void);
 int test_coords_suite(void);
 int test_cs_limits_suite(void);
 int test_ewald_suite(void);
+int test_ewald_spme_suite(void);
 int test_fe_null_suite(void);
 int test_fe_electro_suite(void);
 int test_fe_electro_symm_suite(void);
@@ -58,6 +64,7 @@ int test_hydro_options_suite(void);
 int test_hydro_suite(void);
 int test_interaction_suite(void);
 int test_io_aggregator_suite(void);
+int test_io_compress_suite(void);
 int test_io_element_suite(void);
 int test_io_info_args_suite(void);
 int test_io_info_args_rt_suite(void);
@@ -66,6 +73,7 @@ int test_io_options_rt_suite(void);
 int test_io_subfile_suite(void);
 int test_io_metadata_suite(void);
 int test_io_impl_mpio_suite(void);
+int test_io_impl_node_suite(void);
 
 int test_lb_d2q9_suite(void);
 int test_lb_d3q15_suite(void);
@@ -97,6 +105,7 @@ int test_pair_ss_cut_ij_suite(void);
 int test_pair_yukawa_suite(void);
 int test_pe_suite(void);
 int test_phi_ch_suite(void);
+int test_phi_force_recompute_suite(void);
 int test_polar_active_suite(void);
 int test_lb_prop_suite(void);
 int test_phi_bc_inflow_opts_suite(void);
@@ -108,6 +117,7 @@ int test_psi_options_suite(void);
 int test_psi_suite(void);
 int test_psi_solver_petsc_suite(void);
 int test_psi_sor_suite(void);
+int test_psi_mg_suite(void);
 int test_random_suite(void);
 int test_rt_suite(void);
 int test_stencil_d3q7_suite(void);